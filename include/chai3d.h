@@ -113,6 +113,7 @@
 //! \brief      Implements material and texture properties.
 //---------------------------------------------------------------------------
 #include "materials/CGenericTexture.h"
+#include "materials/CHapticTextureField.h"
 #include "materials/CMaterial.h"
 #include "materials/CNormalMap.h"
 #include "materials/CTexture1d.h"
@@ -156,7 +157,11 @@
 //! \defgroup   world  World
 //! \brief      Implements a collection of 3D objects.
 //---------------------------------------------------------------------------
+#include "world/CConvexHull.h"
+#include "world/CConvexObject.h"
+#include "world/CDistanceFieldObject.h"
 #include "world/CGenericObject.h"
+#include "world/CHapticScene.h"
 #include "world/CMesh.h"
 #include "world/CMultiMesh.h"
 #include "world/CMultiPoint.h"
@@ -167,6 +172,8 @@
 #include "world/CShapeLine.h"
 #include "world/CShapeSphere.h"
 #include "world/CShapeTorus.h"
+#include "world/CSignedDistanceField.h"
+#include "world/CVoxelDistanceField.h"
 #include "world/CVoxelObject.h"
 #include "world/CWorld.h"
 
@@ -210,6 +217,7 @@
 #include "effects/CEffectStickSlip.h"
 #include "effects/CEffectViscosity.h"
 #include "effects/CEffectVibration.h"
+#include "effects/CEffectTable.h"
 
 
 //---------------------------------------------------------------------------
@@ -261,8 +269,10 @@
 //! \defgroup   system  System
 //! \brief      Implements general capabilities that are OS dependent.
 //---------------------------------------------------------------------------
+#include "system/CArena.h"
 #include "system/CGenericType.h"
 #include "system/CGlobals.h"
+#include "system/CMappedFile.h"
 #include "system/CMutex.h"
 #include "system/CString.h"
 #include "system/CThread.h"
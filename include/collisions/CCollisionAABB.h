@@ -50,7 +50,9 @@
 #include "math/CMaths.h"
 #include "collisions/CGenericCollision.h"
 #include "collisions/CCollisionAABBTree.h"
+#include "system/CMappedFile.h"
 //------------------------------------------------------------------------------
+#include <string>
 #include <vector>
 //------------------------------------------------------------------------------
 
@@ -133,6 +135,44 @@ public:
     void initialize(const cGenericArrayPtr a_elements,
                     const double a_radius = 0.0);
 
+    //! This method loads a collision tree previously saved for the same elements and radius.
+    bool loadFromFile(const cGenericArrayPtr a_elements,
+                      const double a_radius,
+                      const std::string& a_filename)
+    {
+        return (loadFromFile(a_elements, a_radius, a_filename, computeHash(a_elements, a_radius)));
+    }
+
+    //! This method loads a collision tree previously saved for the same elements and radius, whose hash (see \ref computeHash()) is already known.
+    bool loadFromFile(const cGenericArrayPtr a_elements,
+                      const double a_radius,
+                      const std::string& a_filename,
+                      const unsigned long long a_hash);
+
+    //! This method saves the collision tree to a file.
+    bool saveToFile(const std::string& a_filename)
+    {
+        return (saveToFile(a_filename, computeHash(m_elements, m_radius)));
+    }
+
+    //! This method saves the collision tree to a file, given the hash (see \ref computeHash()) of its elements and radius.
+    bool saveToFile(const std::string& a_filename,
+                    const unsigned long long a_hash);
+
+    //! This method returns __true__ if the collision tree is mapped from a file.
+    bool isMapped() const { return (m_mappedFile != nullptr); }
+
+
+    //--------------------------------------------------------------------------
+    // PUBLIC STATIC METHODS:
+    //--------------------------------------------------------------------------
+
+public:
+
+    //! This method computes a hash of the geometry of a collection of elements and of a radius.
+    static unsigned long long computeHash(const cGenericArrayPtr a_elements,
+                                          const double a_radius);
+
 
     //--------------------------------------------------------------------------
     // PROTECTED METHODS:
@@ -159,9 +199,18 @@ protected:
     //! Pointer to the list of elements in the object.
     cGenericArrayPtr m_elements;
 
-    //! List of nodes.
+    //! List of nodes built by initialize().
     std::vector<cCollisionAABBNode> m_nodes;
 
+    //! Nodes of the tree, either owned by \ref m_nodes or mapped from a file.
+    cCollisionAABBNode* m_treeNodes;
+
+    //! Number of nodes of the tree.
+    int m_numNodes;
+
+    //! File from which the tree is mapped, if any.
+    cMappedFilePtr m_mappedFile;
+
     //! Index number of root node.
     int m_rootIndex;
 
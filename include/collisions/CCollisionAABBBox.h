@@ -99,8 +99,8 @@ public:
         setValue(a_min, a_max); 
     }
 
-    //! Destructor of cCollisionAABBBox.
-    virtual ~cCollisionAABBBox() {};
+    //! Destructor of cCollisionAABBBox. Boxes are plain data so that collision trees can be stored on disk and mapped back in memory.
+    ~cCollisionAABBBox() = default;
 
 
     //--------------------------------------------------------------------------
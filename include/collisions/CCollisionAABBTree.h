@@ -94,8 +94,8 @@ public:
     //! Constructor of cCollisionAABBNode.
     cCollisionAABBNode();
 
-    //! Destructor of cCollisionAABBNode.
-    virtual ~cCollisionAABBNode() {}
+    //! Destructor of cCollisionAABBNode. Nodes are plain data so that collision trees can be stored on disk and mapped back in memory.
+    ~cCollisionAABBNode() = default;
     
     
     //--------------------------------------------------------------------------
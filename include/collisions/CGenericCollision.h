@@ -47,6 +47,7 @@
 #define CGenericCollisionH
 //------------------------------------------------------------------------------
 #include "collisions/CCollisionBasics.h"
+#include "system/CArena.h"
 //------------------------------------------------------------------------------
 
 //------------------------------------------------------------------------------
@@ -98,7 +99,7 @@ namespace chai3d {
     between objects themselves.\n\n
 */
 //==============================================================================
-class cGenericCollision
+class cGenericCollision : public cArenaObject
 {
 
     //--------------------------------------------------------------------------
@@ -101,6 +101,9 @@ public:
                       const unsigned int& a_toolID,
                       cVector3d& a_reactionForce);
 
+    //! This method returns the distance from the surface of the object beyond which this effect produces no force: the magnet distance of the material.
+    double getInfluenceDistance() const;
+
     //! This method enables or disables the magnetic effect when the tool is located inside the object.
     void setEnabledInside(const bool a_enabled) { m_enabledInside = a_enabled; }
 
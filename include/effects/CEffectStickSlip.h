@@ -124,6 +124,9 @@ public:
                       const unsigned int& a_toolID,
                       cVector3d& a_reactionForce);
 
+    //! This method returns the distance from the surface of the object beyond which this effect produces no force: it acts inside of the object only.
+    double getInfluenceDistance() const { return (0.0); }
+
 
     //--------------------------------------------------------------------------
     // MEMBERS:
@@ -100,6 +100,9 @@ public:
                       const cVector3d& a_toolVel,
                       const unsigned int& a_toolID,
                       cVector3d& a_reactionForce);
+
+    //! This method returns the distance from the surface of the object beyond which this effect produces no force: it acts inside of the object only.
+    double getInfluenceDistance() const { return (0.0); }
 };
 
 //------------------------------------------------------------------------------
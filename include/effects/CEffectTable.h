@@ -0,0 +1,268 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2003-2016, CHAI3D.
+    (www.chai3d.org)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of CHAI3D nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE. 
+
+    \author    <http://www.chai3d.org>
+    \version   3.2.0 $Rev: 1869 $
+*/
+//==============================================================================
+//------------------------------------------------------------------------------
+#ifndef CEffectTableH
+#define CEffectTableH
+//------------------------------------------------------------------------------
+#include "math/CVector3d.h"
+#include <vector>
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+namespace chai3d {
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+class cGenericObject;
+class cShapeSphere;
+class cInteractionRecorder;
+//------------------------------------------------------------------------------
+
+//==============================================================================
+/*!
+    \file       CEffectTable.h
+
+    \brief
+    Implements a table of haptic effects evaluated in batches.
+*/
+//==============================================================================
+
+//==============================================================================
+/*!
+    \class      cEffectTable
+    \ingroup    effects
+
+    \brief
+    This class evaluates the haptic effects of many simple objects in batches.
+
+    \details
+    Effects are normally evaluated one object at a time, by traversing the
+    scene graph and calling each effect through its virtual computeForce()
+    method. When a scene contains many identical primitives, most of the
+    time goes to following pointers. \n\n
+
+    compile() collects the spheres (\ref cShapeSphere) of a scene graph whose
+    effects are all surface, viscosity or magnet effects, and copies them by
+    effect type into contiguous arrays (positions, radii and material
+    parameters). computeForces() then evaluates each type in a single loop,
+    two objects at a time with SSE2, and skips the blocks of objects that
+    are out of reach of the tool. Compiled objects are no longer evaluated
+    by cGenericObject::computeInteractions(). \n\n
+
+    The positions of the objects and whether they are enabled are read by
+    cGenericObject::computeGlobalPositions(), which must be called at each
+    haptic iteration. The effects and materials are copied by compile(),
+    which must be called again after they change, or after objects are
+    added to or removed from the scene graph.
+*/
+//==============================================================================
+class cEffectTable
+{
+    //--------------------------------------------------------------------------
+    // CONSTRUCTOR & DESTRUCTOR:
+    //--------------------------------------------------------------------------
+
+public:
+
+    //! Constructor of cEffectTable.
+    cEffectTable();
+
+    //! Destructor of cEffectTable.
+    virtual ~cEffectTable();
+
+
+    //--------------------------------------------------------------------------
+    // PUBLIC METHODS:
+    //--------------------------------------------------------------------------
+
+public:
+
+    //! This method collects the objects of a scene graph whose effects can be evaluated in batches.
+    void compile(cGenericObject* a_root);
+
+    //! This method releases all objects, whose effects are then evaluated one object at a time again.
+    void clear();
+
+    //! This method removes an object from the table.
+    void release(cGenericObject* a_object);
+
+    //! This method reads the global position and the state of an object of the table.
+    void updateObject(const int a_index);
+
+    //! This method returns the number of objects in the table.
+    int getNumObjects() const { return ((int)(m_objects.size())); }
+
+    //! This method returns the number of effects in the table.
+    int getNumEffects() const;
+
+    //! This method computes the force of all effects of the table for a tool given in world coordinates.
+    cVector3d computeForces(const cVector3d& a_toolPos,
+                            const cVector3d& a_toolVel,
+                            const unsigned int a_IDN,
+                            cInteractionRecorder& a_interactions);
+
+
+    //--------------------------------------------------------------------------
+    // PROTECTED TYPES:
+    //--------------------------------------------------------------------------
+
+protected:
+
+    //! Effect types evaluated by the table.
+    enum cEffectType
+    {
+        C_EFFECT_TABLE_SURFACE,
+        C_EFFECT_TABLE_VISCOSITY,
+        C_EFFECT_TABLE_MAGNET,
+        C_EFFECT_TABLE_NUM_TYPES
+    };
+
+    //! Effects of one type, stored as a structure of arrays, by blocks of nearby objects.
+    struct cEffectBatch
+    {
+        //! Index of the object of each effect in the table.
+        std::vector<int> m_object;
+
+        //! Center of the objects, in world coordinates.
+        std::vector<double> m_posX;
+        std::vector<double> m_posY;
+        std::vector<double> m_posZ;
+
+        //! Radius of the objects, negative if the object is disabled.
+        std::vector<double> m_radius;
+
+        //! Distance from the center beyond which the effects produce no force, -C_LARGE if the object is disabled.
+        std::vector<double> m_reach;
+
+        //! Stiffness of the surface effects.
+        std::vector<double> m_stiffness;
+
+        //! Viscosity of the viscosity effects.
+        std::vector<double> m_viscosity;
+
+        //! Distance beyond which the magnets produce no force, negative if they never do.
+        std::vector<double> m_magnetMaxDistance;
+
+        //! Distance at which the magnets reach their maximum force.
+        std::vector<double> m_magnetKnee;
+
+        //! Stiffness of the magnets below and above their knee.
+        std::vector<double> m_magnetStiffness;
+        std::vector<double> m_magnetSlope;
+
+        //! Nonzero if the magnet also acts inside of the object.
+        std::vector<double> m_magnetInside;
+
+        //! Bounds of each block, grown by the reach of the effects.
+        std::vector<cVector3d> m_blockMin;
+        std::vector<cVector3d> m_blockMax;
+
+        //! Nonzero if the bounds of the block were grown since they were last computed.
+        std::vector<char> m_blockGrown;
+    };
+
+
+    //--------------------------------------------------------------------------
+    // PROTECTED METHODS:
+    //--------------------------------------------------------------------------
+
+protected:
+
+    //! This method adds an object and its children to the table.
+    void collect(cGenericObject* a_object);
+
+    //! This method computes the bounds of a block of a batch from the positions of its objects.
+    void updateBlock(cEffectBatch& a_batch,
+                     const int a_block);
+
+    //! This method returns __true__ if a tool position is within the bounds of a block of a batch.
+    bool isBlockInReach(cEffectBatch& a_batch,
+                        const int a_block,
+                        const cVector3d& a_toolPos);
+
+    //! This method evaluates the surface effects and adds their force.
+    void computeSurfaces(const cVector3d& a_toolPos, double a_force[3]);
+
+    //! This method evaluates the viscosity effects and adds their force.
+    void computeViscosities(const cVector3d& a_toolPos,
+                            const cVector3d& a_toolVel,
+                            double a_force[3]);
+
+    //! This method evaluates the magnet effects and adds their force.
+    void computeMagnets(const cVector3d& a_toolPos, double a_force[3]);
+
+    //! This method adds the force of an effect to its object, which reports an interaction.
+    void addEvent(const int a_object, const double a_force[3]);
+
+
+    //--------------------------------------------------------------------------
+    // PROTECTED MEMBERS:
+    //--------------------------------------------------------------------------
+
+protected:
+
+    //! Compiled objects.
+    std::vector<cShapeSphere*> m_objects;
+
+    //! Effects by type.
+    cEffectBatch m_batches[C_EFFECT_TABLE_NUM_TYPES];
+
+    //! Index of the effects of each object in each batch, or -1.
+    std::vector<int> m_slots;
+
+    //! Force of the objects that report an interaction, in world coordinates.
+    std::vector<cVector3d> m_eventForces;
+
+    //! If __true__, the object reports an interaction.
+    std::vector<bool> m_eventObjects;
+
+    //! Objects that report an interaction.
+    std::vector<int> m_events;
+};
+
+//------------------------------------------------------------------------------
+} // namespace chai3d
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+#endif
+//------------------------------------------------------------------------------
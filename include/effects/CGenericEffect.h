@@ -46,6 +46,7 @@
 #define CGenericEffectH
 //------------------------------------------------------------------------------
 #include "math/CVector3d.h"
+#include "system/CArena.h"
 //------------------------------------------------------------------------------
 
 //------------------------------------------------------------------------------
@@ -111,10 +112,15 @@ const int C_EFFECT_MAX_IDN = 16;
     and added to the virtual tool. \n\n
 
     Finally, after traversing each object in the scenegraph, the resulting 
-    force (sum of all interaction forces) is sent to the haptic device.
+    force (sum of all interaction forces) is sent to the haptic device. \n\n
+
+    Each effect declares with getInfluenceDistance() how far from the surface
+    of the object it may produce a force, so that objects far from the tool
+    can be skipped (see cGenericObject::setInteractionCullingEnabled()).
+    Effects that do not declare it are assumed to act anywhere.
 */
 //==============================================================================
-class cGenericEffect
+class cGenericEffect : public cArenaObject
 {
     //--------------------------------------------------------------------------
     // CONSTRUCTOR & DESTRUCTOR:
@@ -145,6 +151,9 @@ public:
                                   return (false);
                               }
 
+    //! This method returns the distance from the surface of the object beyond which this effect produces no force.
+    virtual double getInfluenceDistance() const { return (C_LARGE); }
+
     //! This method enables or disables this effect.
     inline void setEnabled(bool a_enabled) { m_enabled = a_enabled; }
 
@@ -93,6 +93,18 @@ bool cSaveFileOBJ(cMultiMesh* a_object, const std::string& a_filename);
 extern bool g_objLoaderShouldGenerateExtraVertices;
 
 
+//------------------------------------------------------------------------------
+/*!
+    Clients can use this to select the original single threaded OBJ parser
+    (\ref cOBJModel) instead of the parallel one. Both create the same meshes;
+    the parallel parser also supports negative (relative) face indices and
+    faces with texture coordinates but no normals (v/t). \n
+    If __false__ (default), the parallel parser is used.
+*/
+//------------------------------------------------------------------------------
+extern bool g_objLoaderUseLegacyParser;
+
+
 //------------------------------------------------------------------------------
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
 //------------------------------------------------------------------------------
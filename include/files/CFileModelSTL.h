@@ -76,6 +76,19 @@ bool cSaveFileSTL(cMultiMesh* a_object, const std::string& a_filename);
 
 //@}
 
+
+//------------------------------------------------------------------------------
+/*!
+    Clients can use this to tell the STL file loader how to weld the vertices
+    of adjacent triangles. \n
+    If __0__ (default), vertices with identical coordinates are merged. If
+    positive, vertices closer than this distance along each axis are merged.
+    If negative, vertices are not welded and each triangle has three
+    _distinct_ vertices.
+*/
+//------------------------------------------------------------------------------
+extern double g_stlLoaderWeldingEpsilon;
+
 //------------------------------------------------------------------------------
 } // namespace chai3d
 //------------------------------------------------------------------------------
@@ -260,6 +260,18 @@ protected:
     //! Radius of the proxy.
     double m_radius;
 
+    //! Object whose haptic texture field was sampled at the last contact.
+    cGenericObject* m_textureObject;
+
+    //! Texture coordinate of the last haptic texture field sample.
+    cVector3d m_textureTexCoord;
+
+    //! Filtered number of texels travelled per sample on the haptic texture field.
+    double m_textureSpeed;
+
+    //! If __true__, the haptic texture field was sampled during the previous update.
+    bool m_textureContact;
+
 
     //----------------------------------------------------------------------
     // PROTECTED MEMBERS - PROXY ALGORITHM
@@ -147,6 +147,9 @@ public:
     //! This method returns the number of vertices per element.
     virtual unsigned int getNumVerticesPerElement() { return (1); }
 
+    //! This method returns the number of elements that are not allocated and can be reused.
+    unsigned int getNumFreeElements() const { return (unsigned int)(m_freeElements.size()); }
+
     //! This method removes non used elements. This compresses the array.
     void compress();
 
@@ -255,8 +258,8 @@ public:
 
 protected:
 
-    //! List of free elements.
-    std::list<unsigned int> m_freeElements;
+    //! List of free elements. The most recently removed element is reused first.
+    std::vector<unsigned int> m_freeElements;
 };
 
 //------------------------------------------------------------------------------
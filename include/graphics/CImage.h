@@ -183,6 +183,12 @@ public:
         const GLenum a_format,
         const GLenum a_type);
 
+    //! This method returns a number that changes each time the image data is modified by the methods of this class.
+    inline unsigned long getModificationCount() const { return (m_modificationCount); }
+
+    //! This method records a modification of the image data, to be called after writing through \ref getData().
+    inline void markAsModified() { m_modificationCount++; }
+
 
     //--------------------------------------------------------------------------
     // PUBLIC METHODS - MANIPULATING PIXELS:
@@ -465,6 +471,9 @@ protected:
 
     //! If __true__, then this object actually performed the memory allocation for this object.
     bool m_responsibleForMemoryAllocation;
+
+    //! Number of modifications of the image data.
+    unsigned long m_modificationCount;
 };
 
 //------------------------------------------------------------------------------
@@ -164,9 +164,6 @@ public:
     //! This method copies point data and return new point array.
     cPointArrayPtr copy();
 
-    //! This method compresses the array by removing non used points.
-    void compress();
-
 
     //--------------------------------------------------------------------------
     /*!
@@ -184,9 +181,9 @@ public:
         // check if there is an available slot on the free point list
         if (m_freeElements.size() > 0)
         {
-            index = m_freeElements.front();
+            index = m_freeElements.back();
             m_allocated[index] = true;
-            m_freeElements.pop_front();
+            m_freeElements.pop_back();
             setVertex(index, a_vertexIndex0);
         }
         else
@@ -163,9 +163,6 @@ public:
     //! This method create a copy of all segment data and returns a new segment array.
     cSegmentArrayPtr copy();
 
-    //! This method compresses the array by removing non used segments.
-    void compress();
-
 
     //--------------------------------------------------------------------------
     /*!
@@ -185,9 +182,9 @@ public:
         // check if there is an available slot on the free segment list
         if (m_freeElements.size() > 0)
         {
-            index = m_freeElements.front();
+            index = m_freeElements.back();
             m_allocated[index] = true;
-            m_freeElements.pop_front();
+            m_freeElements.pop_back();
             setVertices(index, a_vertexIndex0, a_vertexIndex1);
         }
         else
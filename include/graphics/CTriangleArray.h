@@ -164,9 +164,6 @@ public:
     //! This method copies all triangle data and returns a new triangle array.
     cTriangleArrayPtr copy();
 
-    //! This method removes all non allocated triangles.
-    void compress();
-
 
     //--------------------------------------------------------------------------
     /*!
@@ -188,9 +185,9 @@ public:
         // check if there is an available slot on the free triangle list
         if (m_freeElements.size() > 0)
         {
-            index = m_freeElements.front();
+            index = m_freeElements.back();
             m_allocated[index] = true;
-            m_freeElements.pop_front();
+            m_freeElements.pop_back();
             setVertices(index, a_vertexIndex0, a_vertexIndex1, a_vertexIndex2);
         }
         else
@@ -547,8 +544,8 @@ public:
                 cVector3d B0 = cProjectPointOnPlane(B, cVector3d(0, 0, 0), N0);
                 T0.normalize();
                 B0.normalize();
-                m_vertices->m_tangent[index0] = T0;
-                m_vertices->m_bitangent[index0] = B0;
+                m_vertices->setTangent(index0, T0);
+                m_vertices->setBitangent(index0, B0);
 
                 // compute tangent and bi-tangent vector for vertex 1
                 cVector3d N1 = m_vertices->getNormal(index1);
@@ -556,8 +553,8 @@ public:
                 cVector3d B1 = cProjectPointOnPlane(B, cVector3d(0, 0, 0), N1);
                 T1.normalize();
                 B1.normalize();
-                m_vertices->m_tangent[index1] = T1;
-                m_vertices->m_bitangent[index1] = B1;
+                m_vertices->setTangent(index1, T1);
+                m_vertices->setBitangent(index1, B1);
 
                 // compute tangent and bi-tangent vector for vertex 2
                 cVector3d N2 = m_vertices->getNormal(index2);
@@ -565,8 +562,8 @@ public:
                 cVector3d B2 = cProjectPointOnPlane(B, cVector3d(0, 0, 0), N2);
                 T2.normalize();
                 B2.normalize();
-                m_vertices->m_tangent[index2] = T2;
-                m_vertices->m_bitangent[index2] = B2;
+                m_vertices->setTangent(index2, T2);
+                m_vertices->setBitangent(index2, B2);
 
                 // mark for update
                 m_vertices->m_flagTangentData = true;
@@ -66,6 +66,16 @@ namespace chai3d {
 //==============================================================================
 
 
+//------------------------------------------------------------------------------
+//! This function converts a normal component to a signed 16 bit integer.
+inline short cQuantizeNormal(const double& a_value)
+{
+    double value = (a_value > 1.0) ? 1.0 : ((a_value < -1.0) ? -1.0 : a_value);
+    return ((short)((value >= 0.0) ? (value * 32767.0 + 0.5) : (value * 32767.0 - 0.5)));
+}
+//------------------------------------------------------------------------------
+
+
 //==============================================================================
 /*!
     \struct     cVertexArrayOptions
@@ -156,6 +166,8 @@ public:
         m_useTangentData    = a_options.m_useTangentData;
         m_useBitangentData  = a_options.m_useBitangentData;
         m_useUserData       = a_options.m_useUserData;
+        m_compactStorage    = false;
+        m_quantizedNormals  = false;
         m_flagPositionData  = false;
         m_flagNormalData    = false;
         m_flagTexCoordData  = false;
@@ -232,6 +244,9 @@ public:
         m_tangent.clear();
         m_bitangent.clear();
         m_userData.clear();
+        m_compactLocalPos.clear();
+        m_compactNormal.clear();
+        m_quantizedNormal.clear();
         m_numVertices = 0;
         m_flagBufferResize = true;
     }
@@ -260,6 +275,9 @@ public:
         vertexArray->m_tangent = m_tangent;
         vertexArray->m_bitangent = m_bitangent;
         vertexArray->m_userData = m_userData;
+        vertexArray->m_compactLocalPos = m_compactLocalPos;
+        vertexArray->m_compactNormal = m_compactNormal;
+        vertexArray->m_quantizedNormal = m_quantizedNormal;
 
         // copy data
         vertexArray->m_useNormalData = m_useNormalData;
@@ -268,6 +286,8 @@ public:
         vertexArray->m_useTangentData = m_useTangentData;
         vertexArray->m_useBitangentData = m_useBitangentData;
         vertexArray->m_useUserData = m_useUserData;
+        vertexArray->m_compactStorage = m_compactStorage;
+        vertexArray->m_quantizedNormals = m_quantizedNormals;
         vertexArray->m_numVertices = m_numVertices;
 
         // return new vertex array
@@ -328,7 +348,17 @@ public:
                             const double& a_y, 
                             const double& a_z)
     {
-        m_localPos[a_vertexIndex].set(a_x, a_y, a_z);
+        if (m_compactStorage)
+        {
+            float* pos = &m_compactLocalPos[3 * a_vertexIndex];
+            pos[0] = (float)a_x;
+            pos[1] = (float)a_y;
+            pos[2] = (float)a_z;
+        }
+        else
+        {
+            m_localPos[a_vertexIndex].set(a_x, a_y, a_z);
+        }
         m_flagPositionData = true;
     }
 
@@ -344,8 +374,7 @@ public:
     inline void setLocalPos(const unsigned int a_vertexIndex,
                             const cVector3d& a_pos)
     {
-        m_localPos[a_vertexIndex] = a_pos;
-        m_flagPositionData = true;
+        setLocalPos(a_vertexIndex, a_pos(0), a_pos(1), a_pos(2));
     }
 
 
@@ -361,8 +390,15 @@ public:
     inline void translate(const unsigned int a_vertexIndex,
                           const cVector3d& a_translation)
     {
-        m_localPos[a_vertexIndex].add(a_translation);
-        m_flagPositionData = true;
+        if (m_compactStorage)
+        {
+            setLocalPos(a_vertexIndex, getLocalPos(a_vertexIndex) + a_translation);
+        }
+        else
+        {
+            m_localPos[a_vertexIndex].add(a_translation);
+            m_flagPositionData = true;
+        }
     }
 
 
@@ -376,6 +412,11 @@ public:
     //--------------------------------------------------------------------------
     inline cVector3d getLocalPos(const unsigned int a_vertexIndex) const 
     { 
+        if (m_compactStorage)
+        {
+            const float* pos = &m_compactLocalPos[3 * a_vertexIndex];
+            return (cVector3d(pos[0], pos[1], pos[2]));
+        }
         return (m_localPos[a_vertexIndex]); 
     }
 
@@ -384,7 +425,8 @@ public:
     /*!
         This method returns the global position of a selected vertex. This value 
         is only correct if the computeGlobalPositions() method has been called 
-        previously.
+        previously. In compact storage, global positions are only allocated
+        by this call, and zero is returned before.
 
         \param  a_vertexIndex  Vertex index number.
         \return Global position of vertex in world coordinates.
@@ -392,6 +434,10 @@ public:
     //--------------------------------------------------------------------------
     inline cVector3d getGlobalPos(const unsigned int a_vertexIndex) const 
     { 
+        if (a_vertexIndex >= m_globalPos.size())
+        {
+            return (cVector3d(0.0, 0.0, 0.0));
+        }
         return (m_globalPos[a_vertexIndex]); 
     }
 
@@ -407,11 +453,7 @@ public:
     inline void setNormal(const unsigned int a_vertexIndex,
                           const cVector3d& a_normal)
     {
-        if (m_useNormalData)
-        {
-            m_normal[a_vertexIndex] = a_normal;
-            m_flagNormalData = true;
-        }
+        setNormal(a_vertexIndex, a_normal(0), a_normal(1), a_normal(2));
     }
 
 
@@ -432,7 +474,24 @@ public:
     {
         if (m_useNormalData)
         {
-            m_normal[a_vertexIndex].set(a_x, a_y, a_z);
+            if (m_quantizedNormals)
+            {
+                short* normal = &m_quantizedNormal[3 * a_vertexIndex];
+                normal[0] = cQuantizeNormal(a_x);
+                normal[1] = cQuantizeNormal(a_y);
+                normal[2] = cQuantizeNormal(a_z);
+            }
+            else if (m_compactStorage)
+            {
+                float* normal = &m_compactNormal[3 * a_vertexIndex];
+                normal[0] = (float)a_x;
+                normal[1] = (float)a_y;
+                normal[2] = (float)a_z;
+            }
+            else
+            {
+                m_normal[a_vertexIndex].set(a_x, a_y, a_z);
+            }
             m_flagNormalData = true;
         }
     }
@@ -448,6 +507,16 @@ public:
     //--------------------------------------------------------------------------
     inline cVector3d getNormal(const unsigned int a_vertexIndex) const
     {
+        if (m_quantizedNormals)
+        {
+            const short* normal = &m_quantizedNormal[3 * a_vertexIndex];
+            return (cVector3d(normal[0] / 32767.0, normal[1] / 32767.0, normal[2] / 32767.0));
+        }
+        else if (m_compactStorage)
+        {
+            const float* normal = &m_compactNormal[3 * a_vertexIndex];
+            return (cVector3d(normal[0], normal[1], normal[2]));
+        }
         return (m_normal[a_vertexIndex]);
     }
 
@@ -463,11 +532,7 @@ public:
     inline void setTexCoord(const unsigned int a_vertexIndex,
                             const cVector3d& a_texCoord)
     {
-        if (m_useTexCoordData)
-        {
-            m_texCoord[a_vertexIndex] = a_texCoord;
-            m_flagTexCoordData = true;
-        }
+        setTexCoord(a_vertexIndex, a_texCoord(0), a_texCoord(1), a_texCoord(2));
     }
 
 
@@ -489,6 +554,7 @@ public:
     {
         if (m_useTexCoordData)
         {
+            allocateAttribute(m_texCoord, cVector3d(0.0, 0.0, 0.0));
             m_texCoord[a_vertexIndex].set(a_tx, a_ty,a_tz);
             m_flagTexCoordData = true;
         }
@@ -505,6 +571,10 @@ public:
     //--------------------------------------------------------------------------
     inline cVector3d getTexCoord(const unsigned int a_vertexIndex) const 
     { 
+        if (m_texCoord.empty())
+        {
+            return (cVector3d(0.0, 0.0, 0.0));
+        }
         return (m_texCoord[a_vertexIndex]);
     }
 
@@ -522,6 +592,7 @@ public:
     { 
         if (m_useColorData)
         {
+            allocateAttribute(m_color, cColorf(0.0, 0.0, 0.0, 1.0));
             m_color[a_vertexIndex] = a_color;
             m_flagColorData = true;
         }
@@ -548,6 +619,7 @@ public:
     {
         if (m_useColorData)
         {
+            allocateAttribute(m_color, cColorf(0.0, 0.0, 0.0, 1.0));
             m_color[a_vertexIndex].set(a_red, a_green, a_blue, a_alpha);
             m_flagColorData = true;
         }
@@ -565,11 +637,7 @@ public:
     inline void setColor(const unsigned int a_vertexIndex,
                          const cColorb& a_color)
     {
-        if (m_useColorData)
-        {
-            m_color[a_vertexIndex] = a_color.getColorf();
-            m_flagColorData = true;
-        }
+        setColor(a_vertexIndex, a_color.getColorf());
     }
 
 
@@ -583,6 +651,10 @@ public:
     //--------------------------------------------------------------------------
     inline cColorf getColor(const unsigned int a_vertexIndex) const
     {
+        if (m_color.empty())
+        {
+            return (cColorf(0.0, 0.0, 0.0, 1.0));
+        }
         return (m_color[a_vertexIndex]);
     }
 
@@ -598,11 +670,7 @@ public:
     inline void setTangent(const unsigned int a_vertexIndex,
         const cVector3d& a_tangent)
     {
-        if (m_useTangentData)
-        {
-            m_tangent[a_vertexIndex] = a_tangent;
-            m_flagTangentData = true;
-        }
+        setTangent(a_vertexIndex, a_tangent(0), a_tangent(1), a_tangent(2));
     }
 
 
@@ -623,6 +691,7 @@ public:
     {
         if (m_useTangentData)
         {
+            allocateAttribute(m_tangent, cVector3d(1.0, 0.0, 0.0));
             m_tangent[a_vertexIndex].set(a_x, a_y, a_z);
             m_flagTangentData = true;
         }
@@ -639,6 +708,10 @@ public:
     //--------------------------------------------------------------------------
     inline cVector3d getTangent(const unsigned int a_vertexIndex) const
     {
+        if (m_tangent.empty())
+        {
+            return (cVector3d(1.0, 0.0, 0.0));
+        }
         return (m_tangent[a_vertexIndex]);
     }
 
@@ -654,11 +727,7 @@ public:
     inline void setBitangent(const unsigned int a_vertexIndex,
         const cVector3d& a_bitangent)
     {
-        if (m_useBitangentData)
-        {
-            m_bitangent[a_vertexIndex] = a_bitangent;
-            m_flagBitangentData = true;
-        }
+        setBitangent(a_vertexIndex, a_bitangent(0), a_bitangent(1), a_bitangent(2));
     }
 
 
@@ -679,6 +748,7 @@ public:
     {
         if (m_useBitangentData)
         {
+            allocateAttribute(m_bitangent, cVector3d(0.0, 1.0, 0.0));
             m_bitangent[a_vertexIndex].set(a_x, a_y, a_z);
             m_flagBitangentData = true;
         }
@@ -695,6 +765,10 @@ public:
     //--------------------------------------------------------------------------
     inline cVector3d getBitangent(const unsigned int a_vertexIndex) const
     {
+        if (m_bitangent.empty())
+        {
+            return (cVector3d(0.0, 1.0, 0.0));
+        }
         return (m_bitangent[a_vertexIndex]);
     }
 
@@ -712,6 +786,7 @@ public:
     { 
         if (m_useUserData)
         {
+            allocateAttribute(m_userData, 0);
             m_userData[a_vertexIndex] = a_userData;
             m_flagUserData = true;
         }
@@ -728,6 +803,10 @@ public:
     //--------------------------------------------------------------------------
     inline int getUserData(const unsigned int a_vertexIndex) const
     {
+        if (m_userData.empty())
+        {
+            return (0);
+        }
         return (m_userData[a_vertexIndex]);
     }
 
@@ -746,11 +825,41 @@ public:
                                       const cVector3d& a_globalPos, 
                                       const cMatrix3d& a_globalRot)
     {
-        a_globalRot.mulr(m_localPos[a_vertexIndex], m_globalPos[a_vertexIndex]);
+        if (m_globalPos.size() != m_numVertices)
+        {
+            m_globalPos.resize(m_numVertices);
+        }
+        a_globalRot.mulr(getLocalPos(a_vertexIndex), m_globalPos[a_vertexIndex]);
         m_globalPos[a_vertexIndex].add(a_globalPos);
     }
 
 
+    //! This method computes the global position of all vertices given the global position and rotation of the parent object.
+    void computeGlobalPositions(const cVector3d& a_globalPos,
+                                const cMatrix3d& a_globalRot);
+
+    //! This method transforms the local position of all vertices by a matrix followed by a translation.
+    void transformLocalPositions(const cMatrix3d& a_rot,
+                                 const cVector3d& a_translation);
+
+    //! This method stores positions and normals in single precision, and allocates other data only when it is set.
+    void setCompactStorage(const bool a_compactStorage,
+                           const bool a_quantizeNormals = false);
+
+    //! This method returns __true__ if positions and normals are stored in single precision.
+    inline bool getCompactStorage() const { return (m_compactStorage); }
+
+    //! This method returns __true__ if normals are quantized to 16 bits per component.
+    inline bool getQuantizedNormals() const { return (m_quantizedNormals); }
+
+    //! This method returns the number of bytes allocated for vertex data.
+    size_t getMemoryUsage() const;
+
+    //! This method removes the vertices that are not used and returns the new index of each vertex.
+    unsigned int compress(const std::vector<bool>& a_used,
+                          std::vector<int>& a_newIndices);
+
+
     //--------------------------------------------------------------------------
     /*!
         This method returns the number of vertices allocated in this array.
@@ -887,40 +996,57 @@ public:
             glGenBuffers(1, &m_bitangentBuffer);
         }
 
+        // positions and normals in double or single precision
+        const GLvoid* positionData = m_compactStorage ? (const GLvoid*)m_compactLocalPos.data() : (const GLvoid*)m_localPos.data();
+        const GLsizeiptr positionSize = m_numVertices * (m_compactStorage ? 3 * sizeof(float) : sizeof(cVector3d));
+        const GLenum positionType = m_compactStorage ? GL_FLOAT : GL_DOUBLE;
+
+        const GLvoid* normalData = m_quantizedNormals ? (const GLvoid*)m_quantizedNormal.data() : 
+                                   (m_compactStorage ? (const GLvoid*)m_compactNormal.data() : (const GLvoid*)m_normal.data());
+        const GLsizeiptr normalSize = m_numVertices * (m_quantizedNormals ? 3 * sizeof(short) :
+                                                       (m_compactStorage ? 3 * sizeof(float) : sizeof(cVector3d)));
+        const GLenum normalType = m_quantizedNormals ? GL_SHORT : (m_compactStorage ? GL_FLOAT : GL_DOUBLE);
+
+        // attributes that are allocated (compact storage allocates them when they are set)
+        const bool useTexCoordData = m_useTexCoordData && !m_texCoord.empty();
+        const bool useColorData = m_useColorData && !m_color.empty();
+        const bool useTangentData = m_useTangentData && !m_tangent.empty();
+        const bool useBitangentData = m_useBitangentData && !m_bitangent.empty();
+
         // resize buffers
         if (m_flagBufferResize)
         {
             if (true)
             {
                 glBindBuffer(GL_ARRAY_BUFFER, m_positionBuffer);
-                glBufferData(GL_ARRAY_BUFFER, m_numVertices * sizeof(cVector3d), &(m_localPos[0]), GL_STATIC_DRAW);
+                glBufferData(GL_ARRAY_BUFFER, positionSize, positionData, GL_STATIC_DRAW);
             }
 
             if (m_useNormalData)
             {
                 glBindBuffer(GL_ARRAY_BUFFER, m_normalBuffer);
-                glBufferData(GL_ARRAY_BUFFER, m_numVertices * sizeof(cVector3d), &(m_normal[0]), GL_STATIC_DRAW);
+                glBufferData(GL_ARRAY_BUFFER, normalSize, normalData, GL_STATIC_DRAW);
             }
 
-            if (m_useTexCoordData)
+            if (useTexCoordData)
             {
                 glBindBuffer(GL_ARRAY_BUFFER, m_texCoordBuffer);
                 glBufferData(GL_ARRAY_BUFFER, m_numVertices * sizeof(cVector3d), &(m_texCoord[0]), GL_STATIC_DRAW);
             }
 
-            if (m_useColorData)
+            if (useColorData)
             {
                 glBindBuffer(GL_ARRAY_BUFFER, m_colorBuffer);
                 glBufferData(GL_ARRAY_BUFFER, m_numVertices * sizeof(cColorf), &(m_color[0]), GL_STATIC_DRAW);
             }
 
-            if (m_useTangentData)
+            if (useTangentData)
             {
                 glBindBuffer(GL_ARRAY_BUFFER, m_tangentBuffer);
                 glBufferData(GL_ARRAY_BUFFER, m_numVertices * sizeof(cVector3d), &(m_tangent[0]), GL_STATIC_DRAW);
             }
         
-            if (m_useBitangentData)
+            if (useBitangentData)
             {
                 glBindBuffer(GL_ARRAY_BUFFER, m_bitangentBuffer);
                 glBufferData(GL_ARRAY_BUFFER, m_numVertices * sizeof(cVector3d), &(m_bitangent[0]), GL_STATIC_DRAW);
@@ -933,13 +1059,13 @@ public:
         if (m_flagPositionData)
         {
             glBindBuffer(GL_ARRAY_BUFFER, m_positionBuffer);
-            glBufferSubData(GL_ARRAY_BUFFER, 0, m_numVertices * sizeof(cVector3d), &(m_localPos[0]));
+            glBufferSubData(GL_ARRAY_BUFFER, 0, positionSize, positionData);
             m_flagPositionData = false;
         }
         if (m_flagNormalData)
         {
             glBindBuffer(GL_ARRAY_BUFFER, m_normalBuffer);
-            glBufferSubData(GL_ARRAY_BUFFER, 0, m_numVertices * sizeof(cVector3d), &(m_normal[0]));
+            glBufferSubData(GL_ARRAY_BUFFER, 0, normalSize, normalData);
             m_flagNormalData = false;
         }
         if (m_flagTexCoordData)
@@ -971,22 +1097,22 @@ public:
         {
             glBindBuffer(GL_ARRAY_BUFFER, m_positionBuffer);
             glEnableVertexAttribArray(C_VB_POSITION);
-            glVertexAttribPointer(C_VB_POSITION, 3, GL_DOUBLE, GL_FALSE, 0, 0);
-            glVertexPointer(3, GL_DOUBLE, 0, 0);
+            glVertexAttribPointer(C_VB_POSITION, 3, positionType, GL_FALSE, 0, 0);
+            glVertexPointer(3, positionType, 0, 0);
         }
         
         if (m_useNormalData)
         {
             glBindBuffer(GL_ARRAY_BUFFER, m_normalBuffer);
             glEnableVertexAttribArray(C_VB_NORMAL);
-            glVertexAttribPointer(C_VB_NORMAL, 3, GL_DOUBLE, GL_FALSE, 0, 0);
+            glVertexAttribPointer(C_VB_NORMAL, 3, normalType, m_quantizedNormals ? GL_TRUE : GL_FALSE, 0, 0);
         }
         else
         {
             glDisableVertexAttribArray(C_VB_NORMAL);
         }
 
-        if (m_useTexCoordData)
+        if (useTexCoordData)
         {
             glBindBuffer(GL_ARRAY_BUFFER, m_texCoordBuffer);
             glEnableVertexAttribArray(C_VB_TEXCOORD);
@@ -997,7 +1123,7 @@ public:
             glDisableVertexAttribArray(C_VB_TEXCOORD);
         }
 
-        if (m_useColorData)
+        if (useColorData)
         {
             glBindBuffer(GL_ARRAY_BUFFER, m_colorBuffer);
             glEnableVertexAttribArray(C_VB_COLOR);
@@ -1008,7 +1134,7 @@ public:
             glDisableVertexAttribArray(C_VB_COLOR);
         }
 
-        if (m_useTangentData)
+        if (useTangentData)
         {
             glBindBuffer(GL_ARRAY_BUFFER, m_tangentBuffer);
             glEnableVertexAttribArray(C_VB_TANGENT);
@@ -1019,7 +1145,7 @@ public:
             glDisableVertexAttribArray(C_VB_TANGENT);
         }
 
-        if (m_useBitangentData)
+        if (useBitangentData)
         {
             glBindBuffer(GL_ARRAY_BUFFER, m_bitangentBuffer);
             glEnableVertexAttribArray(C_VB_BITANGENT);
@@ -1078,13 +1204,30 @@ public:
         m_numVertices = m_numVertices + a_numberOfVertices;
 
         // update position data allocation
-        cVector3d pos(0.0, 0.0, 0.0);
-        m_localPos.resize(m_numVertices, pos);
-        m_globalPos.resize(m_numVertices, pos);
+        if (m_compactStorage)
+        {
+            m_compactLocalPos.resize(3 * m_numVertices, 0.0f);
+        }
+        else
+        {
+            cVector3d pos(0.0, 0.0, 0.0);
+            m_localPos.resize(m_numVertices, pos);
+            m_globalPos.resize(m_numVertices, pos);
+        }
 
         // update normal data allocation
         m_useNormalData = a_useNormalData;
-        if (m_useNormalData)
+        if (m_useNormalData && m_quantizedNormals)
+        {
+            allocatePacked(m_quantizedNormal, (short)32767, (short)0, (short)0);
+            m_flagNormalData = true;
+        }
+        else if (m_useNormalData && m_compactStorage)
+        {
+            allocatePacked(m_compactNormal, 1.0f, 0.0f, 0.0f);
+            m_flagNormalData = true;
+        }
+        else if (m_useNormalData)
         {
             cVector3d normal(1.0, 0.0, 0.0);
             if ((a_numberOfVertices > 1) || (a_numberOfVertices == 0))
@@ -1100,11 +1243,13 @@ public:
         else
         {
             m_normal.clear();
+            m_compactNormal.clear();
+            m_quantizedNormal.clear();
         }
 
         // texture coordinate data allocation
         m_useTexCoordData = a_useTexCoordData;
-        if (m_useTexCoordData)
+        if (m_useTexCoordData && (!m_compactStorage || !m_texCoord.empty()))
         {
             cVector3d texCoord(0.0, 0.0, 0.0);
             if ((a_numberOfVertices > 1) || (a_numberOfVertices == 0))
@@ -1117,14 +1262,14 @@ public:
             }
             m_flagTexCoordData = true;
         }
-        else
+        else if (!m_useTexCoordData)
         {
             m_texCoord.clear();
         }
 
         // update color data allocation
         m_useColorData = a_useColorData;
-        if (m_useColorData)
+        if (m_useColorData && (!m_compactStorage || !m_color.empty()))
         {
             cColorf color(0.0, 0.0, 0.0, 1.0);
             if ((a_numberOfVertices > 1) || (a_numberOfVertices == 0))
@@ -1137,14 +1282,14 @@ public:
             }
             m_flagColorData = true;
         }
-        else
+        else if (!m_useColorData)
         {
             m_color.clear();
         }
 
         // update tangent data allocation
         m_useTangentData = a_useTangentData;
-        if (m_useTangentData)
+        if (m_useTangentData && (!m_compactStorage || !m_tangent.empty()))
         {
             cVector3d tangent(1.0, 0.0, 0.0);
             if ((a_numberOfVertices > 1) || (a_numberOfVertices == 0))
@@ -1157,14 +1302,14 @@ public:
             }
             m_flagTangentData = true;
         }
-        else
+        else if (!m_useTangentData)
         {
             m_tangent.clear();
         }
 
         // update bitangent data allocation
         m_useBitangentData = a_useBitangentData;
-        if (m_useBitangentData)
+        if (m_useBitangentData && (!m_compactStorage || !m_bitangent.empty()))
         {
             cVector3d bitangent(0.0, 1.0, 0.0);
             if ((a_numberOfVertices > 1) || (a_numberOfVertices == 0))
@@ -1177,14 +1322,14 @@ public:
             }
             m_flagBitangentData = true;
         }
-        else
+        else if (!m_useBitangentData)
         {
             m_bitangent.clear();
         }
 
         // update user data allocation
         m_useUserData = a_useUserData;
-        if (m_useUserData)
+        if (m_useUserData && (!m_compactStorage || !m_userData.empty()))
         {
             int data = 0;
             if ((a_numberOfVertices > 1) || (a_numberOfVertices == 0))
@@ -1197,7 +1342,7 @@ public:
             }
             m_flagUserData = true;
         }
-        else
+        else if (!m_useUserData)
         {
             m_userData.clear();
         }
@@ -1207,6 +1352,50 @@ public:
     }
 
 
+    //--------------------------------------------------------------------------
+    /*!
+        This method allocates an attribute for all vertices the first time it
+        is set, when this array uses compact storage.
+
+        \param  a_data   Attribute data.
+        \param  a_value  Value of the vertices that were not set.
+    */
+    //--------------------------------------------------------------------------
+    template <typename T>
+    inline void allocateAttribute(std::vector<T>& a_data, const T& a_value)
+    {
+        if (a_data.size() < m_numVertices)
+        {
+            a_data.resize(m_numVertices, a_value);
+            m_flagBufferResize = true;
+        }
+    }
+
+
+    //--------------------------------------------------------------------------
+    /*!
+        This method allocates the three components of new vertices in compact
+        storage.
+
+        \param  a_data  Packed data, three components per vertex.
+        \param  a_x     First component of new vertices.
+        \param  a_y     Second component of new vertices.
+        \param  a_z     Third component of new vertices.
+    */
+    //--------------------------------------------------------------------------
+    template <typename T>
+    inline void allocatePacked(std::vector<T>& a_data, const T& a_x, const T& a_y, const T& a_z)
+    {
+        a_data.reserve(3 * m_numVertices);
+        while (a_data.size() < 3 * m_numVertices)
+        {
+            a_data.push_back(a_x);
+            a_data.push_back(a_y);
+            a_data.push_back(a_z);
+        }
+    }
+
+
     //--------------------------------------------------------------------------
     // PUBLIC MEMBERS:
     //--------------------------------------------------------------------------
@@ -1237,6 +1426,15 @@ public:
     //! User data of vertices.
     std::vector<int> m_userData;
 
+    //! Local position of vertices in compact storage, three components per vertex.
+    std::vector<float> m_compactLocalPos;
+
+    //! Surface normal of vertices in compact storage, three components per vertex.
+    std::vector<float> m_compactNormal;
+
+    //! Surface normal of vertices in compact storage, quantized to 16 bits per component.
+    std::vector<short> m_quantizedNormal;
+
 
     //--------------------------------------------------------------------------
     // PROTECTED MEMBERS:
@@ -1265,6 +1463,12 @@ protected:
     //! If __true__ then surface bitangent data will be allocated for each new vertex.
     bool m_useUserData;
 
+    //! If __true__ then positions and normals are stored in single precision.
+    bool m_compactStorage;
+
+    //! If __true__ then normals are quantized to 16 bits per component.
+    bool m_quantizedNormals;
+
 
     //--------------------------------------------------------------------------
     // PUBLIC MEMBERS:
@@ -0,0 +1,199 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2003-2016, CHAI3D.
+    (www.chai3d.org)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of CHAI3D nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE. 
+
+    \author    <http://www.chai3d.org>
+    \version   3.2.0 $Rev: 1869 $
+*/
+//==============================================================================
+
+//------------------------------------------------------------------------------
+#ifndef CHapticTextureFieldH
+#define CHapticTextureFieldH
+//------------------------------------------------------------------------------
+#include "graphics/CImage.h"
+#include <vector>
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+namespace chai3d {
+//------------------------------------------------------------------------------
+
+//==============================================================================
+/*!
+    \file       CHapticTextureField.h
+    \ingroup    materials
+
+    \brief
+    Implements a precomputed field for haptic texture rendering.
+*/
+//==============================================================================
+
+//------------------------------------------------------------------------------
+class cHapticTextureField;
+typedef std::shared_ptr<cHapticTextureField> cHapticTextureFieldPtr;
+//------------------------------------------------------------------------------
+
+//! Width and height (in texels) of the square tiles of a haptic texture field (a power of 2).
+const unsigned int C_HAPTIC_TEXTURE_TILE_SIZE = 8;
+
+//==============================================================================
+/*!
+    \class      cHapticTextureField
+    \ingroup    materials
+
+    \brief
+    This class implements a precomputed field for haptic texture rendering.
+
+    \details
+    A haptic texture field stores, for each texel of a normal map, the
+    decoded surface gradient (x, y, z) and the height of the surface as four
+    floats, so that the haptic loop can sample them with a single bilinear
+    fetch instead of reading and converting image pixels. \n
+
+    Texels are stored in square tiles of \ref C_HAPTIC_TEXTURE_TILE_SIZE
+    texels aligned on cache lines, so that the texels read by neighbouring
+    contacts are close in memory. \n
+
+    The field can hold several mipmap levels. Each level halves the size of
+    the previous one by averaging 2x2 texels; coarser levels are used when
+    the contact moves quickly across the texture, to avoid aliasing.
+*/
+//==============================================================================
+class cHapticTextureField
+{
+    //--------------------------------------------------------------------------
+    // CONSTRUCTOR & DESTRUCTOR:
+    //--------------------------------------------------------------------------
+
+public:
+
+    //! Constructor of cHapticTextureField.
+    cHapticTextureField();
+
+    //! Destructor of cHapticTextureField.
+    virtual ~cHapticTextureField() {}
+
+    //! Shared cHapticTextureField allocator.
+    static cHapticTextureFieldPtr create() { return (std::make_shared<cHapticTextureField>()); }
+
+
+    //--------------------------------------------------------------------------
+    // PUBLIC METHODS:
+    //--------------------------------------------------------------------------
+
+public:
+
+    //! This method creates the field from a normal map image and an optional height image.
+    bool createField(cImagePtr a_normalImage, cImagePtr a_heightImage = nullptr, const int a_numLevels = 1);
+
+    //! This method returns __true__ if the field contains data.
+    bool isEmpty() const { return (m_levels.empty()); }
+
+    //! This method returns the number of mipmap levels.
+    int getNumLevels() const { return ((int)m_levels.size()); }
+
+    //! This method returns the width (in texels) of a mipmap level.
+    int getWidth(const int a_level = 0) const { return (m_levels[a_level].m_width); }
+
+    //! This method returns the height (in texels) of a mipmap level.
+    int getHeight(const int a_level = 0) const { return (m_levels[a_level].m_height); }
+
+    //! This method returns the mipmap level to use when a contact moves across __a_texels__ texels per sample.
+    double getLevel(const double a_texels) const;
+
+    //! This method samples the gradient (x, y, z) and height of the field at a texture coordinate.
+    void sample(const double a_u, const double a_v, const double a_level, double a_value[4]) const;
+
+
+    //--------------------------------------------------------------------------
+    // PROTECTED MEMBERS:
+    //--------------------------------------------------------------------------
+
+protected:
+
+    //! Mipmap level of the field.
+    struct cLevel
+    {
+        //! Width in texels.
+        int m_width;
+
+        //! Height in texels.
+        int m_height;
+
+        //! Number of tiles along the X axis.
+        unsigned int m_numTilesX;
+
+        //! Index of the first texel of the level in __m_texels__.
+        size_t m_offset;
+    };
+
+    //! Mipmap levels, from the finest to the coarsest.
+    std::vector<cLevel> m_levels;
+
+    //! Texel data (4 floats per texel) of all levels, with room for cache line alignment.
+    std::vector<float> m_data;
+
+    //! First texel of the field, aligned on a cache line.
+    float* m_texels;
+
+
+    //--------------------------------------------------------------------------
+    // PROTECTED METHODS:
+    //--------------------------------------------------------------------------
+
+protected:
+
+    //! This method returns the address of a texel of a mipmap level.
+    inline float* getTexel(const cLevel& a_level, const unsigned int a_x, const unsigned int a_y) const
+    {
+        const unsigned int size = C_HAPTIC_TEXTURE_TILE_SIZE;
+        const size_t tile = (a_y / size) * a_level.m_numTilesX + (a_x / size);
+        const size_t texel = (a_y % size) * size + (a_x % size);
+        return (m_texels + 4 * (a_level.m_offset + tile * size * size + texel));
+    }
+
+    //! This method samples one mipmap level with bilinear interpolation.
+    void sampleLevel(const cLevel& a_level, const double a_u, const double a_v, float a_value[4]) const;
+};
+
+//------------------------------------------------------------------------------
+} // namespace chai3d
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+#endif
+//------------------------------------------------------------------------------
@@ -46,6 +46,7 @@
 #define CMormalMapH
 //------------------------------------------------------------------------------
 #include "materials/CTexture2d.h"
+#include "materials/CHapticTextureField.h"
 //------------------------------------------------------------------------------
 
 //------------------------------------------------------------------------------
@@ -114,6 +115,19 @@ public:
 
     //! This method flips normals along U and/or V axis.
     void flip(const bool a_flipU, const bool a_flipV);
+
+    //! This method precomputes the haptic texture field from the normal map.
+    bool createHapticField(cImagePtr a_heightImage = nullptr, const int a_numLevels = 1);
+
+
+    //--------------------------------------------------------------------------
+    // PUBLIC MEMBERS:
+    //--------------------------------------------------------------------------
+
+public:
+
+    //! Precomputed field used for haptic texture rendering, or __nullptr__ to sample the normal map image.
+    cHapticTextureFieldPtr m_hapticField;
 };
 
 //------------------------------------------------------------------------------
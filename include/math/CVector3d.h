@@ -143,6 +143,29 @@ public:
     }
 
 
+    //--------------------------------------------------------------------------
+    /*!
+        \brief
+        Assignment operator of cVector3d.
+
+        \details
+        This operator copies the vector passed by argument. It is declared
+        together with the copy constructor above.
+
+        \param  a_vector  Vector.
+
+        \return Reference to this vector.
+    */
+    //--------------------------------------------------------------------------
+    cVector3d& operator= (const cVector3d &a_vector)
+    {
+        (*this)(0) = a_vector(0);
+        (*this)(1) = a_vector(1);
+        (*this)(2) = a_vector(2);
+        return (*this);
+    }
+
+
 #ifdef C_USE_EIGEN
 
     //--------------------------------------------------------------------------
@@ -0,0 +1,312 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2003-2016, CHAI3D.
+    (www.chai3d.org)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of CHAI3D nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE. 
+
+    \author    <http://www.chai3d.org>
+    \version   3.2.0 $Rev: 1869 $
+*/
+//==============================================================================
+
+//------------------------------------------------------------------------------
+#ifndef CArenaH
+#define CArenaH
+//------------------------------------------------------------------------------
+#include "system/CMutex.h"
+//------------------------------------------------------------------------------
+#include <atomic>
+#include <cstddef>
+#include <map>
+#include <utility>
+#include <vector>
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+namespace chai3d {
+//------------------------------------------------------------------------------
+
+//==============================================================================
+/*!
+    \file       CArena.h
+    \ingroup    system
+
+    \brief
+    Implements pool allocation of scene objects.
+*/
+//==============================================================================
+
+//------------------------------------------------------------------------------
+class cArena;
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+// GENERAL CONSTANTS
+//------------------------------------------------------------------------------
+
+//! Number of bytes stored in front of each object to find the pool it belongs to.
+const size_t C_ARENA_HEADER_SIZE = 16;
+
+//! Minimum number of bytes of the memory blocks allocated by an arena.
+const size_t C_ARENA_BLOCK_SIZE = 65536;
+
+//------------------------------------------------------------------------------
+
+
+//==============================================================================
+/*!
+    \class      cArenaObject
+    \ingroup    system
+
+    \brief
+    This class implements the allocation of objects that can be created
+    in an arena.
+
+    \details
+    cArenaObject replaces the __new__ and __delete__ operators of the classes
+    that derive from it. Objects created with __new__ are allocated on the
+    heap, objects created with \ref cArena::create() are allocated from an
+    arena. In both cases they are deleted with __delete__.\n
+
+    The arena of an object is known from the start of its constructor, so
+    the effects and collision detectors that a constructor creates come
+    from the same arena.
+*/
+//==============================================================================
+class cArenaObject
+{
+    //--------------------------------------------------------------------------
+    // CONSTRUCTOR & DESTRUCTOR:
+    //--------------------------------------------------------------------------
+
+public:
+
+    //! Constructor of cArenaObject.
+    cArenaObject();
+
+    //! Copy constructor of cArenaObject. The copy is not allocated from the arena of the original.
+    cArenaObject(const cArenaObject& a_object);
+
+    //! Assignment operator of cArenaObject. The arena is left unchanged.
+    cArenaObject& operator=(const cArenaObject& /*a_object*/) { return (*this); }
+
+
+    //--------------------------------------------------------------------------
+    // PUBLIC METHODS:
+    //--------------------------------------------------------------------------
+
+public:
+
+    //! This operator allocates an object on the heap.
+    static void* operator new(size_t a_size);
+
+    //! This operator allocates an object from an arena, or on the heap if the arena is NULL.
+    static void* operator new(size_t a_size, cArena* a_arena);
+
+    //! This operator releases the memory of an object, on the heap or in its arena.
+    static void operator delete(void* a_object);
+
+    //! This operator releases the memory of an object whose constructor failed.
+    static void operator delete(void* a_object, cArena* a_arena);
+
+    //! This method returns the arena from which this object was allocated, or NULL.
+    cArena* getArena() const { return (m_arena); }
+
+
+    //--------------------------------------------------------------------------
+    // PROTECTED MEMBERS:
+    //--------------------------------------------------------------------------
+
+protected:
+
+    //! Arena from which this object was allocated. Objects it owns are allocated from the same arena.
+    cArena* m_arena;
+
+    friend class cArena;
+};
+
+
+//==============================================================================
+/*!
+    \class      cArena
+    \ingroup    system
+
+    \brief
+    This class implements an arena for scene objects, effects and collision
+    detectors.
+
+    \details
+    An arena allocates objects in pools, one for each object size, so that
+    objects of the same kind are stored next to each other. Each pool
+    allocates large memory blocks and reuses the slots of deleted objects
+    before allocating a new block.\n
+
+    Objects are created with \ref create() and deleted with __delete__ as
+    usual. The owner of an arena calls \ref release() instead of deleting
+    it: the memory blocks are freed at once when the last object of the
+    arena is deleted. Objects deleted after the release do not return
+    their slot to its pool and do not take the mutex, so that a world
+    tears down its objects at the cost of their destructors. The
+    destructors still run, because scene objects own memory outside the
+    arena (vertex arrays, materials, textures). An arena can be used by
+    several threads.
+*/
+//==============================================================================
+class cArena
+{
+    //--------------------------------------------------------------------------
+    // CONSTRUCTOR & DESTRUCTOR:
+    //--------------------------------------------------------------------------
+
+public:
+
+    //! Constructor of cArena.
+    cArena();
+
+protected:
+
+    //! Destructor of cArena. Arenas are destroyed by \ref release().
+    ~cArena();
+
+
+    //--------------------------------------------------------------------------
+    // PUBLIC METHODS:
+    //--------------------------------------------------------------------------
+
+public:
+
+    //--------------------------------------------------------------------------
+    /*!
+        This method creates an object in an arena. If the arena is NULL, the
+        object is allocated on the heap.
+
+        \param  a_arena  Arena, or NULL.
+        \param  a_args   Arguments of the constructor of the object.
+
+        \return Pointer to new object.
+    */
+    //--------------------------------------------------------------------------
+    template <class T, class... Args>
+    static T* create(cArena* a_arena, Args&&... a_args)
+    {
+        return (new (a_arena) T(std::forward<Args>(a_args)...));
+    }
+
+    //! This method releases the arena. Its memory is freed once all its objects are deleted.
+    void release();
+
+    //! This method returns the number of objects of the arena that are not deleted.
+    unsigned int getNumObjects();
+
+    //! This method returns the number of bytes allocated by the arena.
+    size_t getMemoryUsage();
+
+    //! This method allocates memory for an object of a given size in an arena, or on the heap.
+    static void* allocate(cArena* a_arena, const size_t a_size);
+
+    //! This method releases the memory of an object allocated by \ref allocate().
+    static void deallocate(void* a_object);
+
+
+    //--------------------------------------------------------------------------
+    // PROTECTED TYPES:
+    //--------------------------------------------------------------------------
+
+protected:
+
+    //! Objects of the same size.
+    struct cArenaPool
+    {
+        //! Arena of the pool.
+        cArena* m_arena;
+
+        //! Size of a slot, header included.
+        size_t m_slotSize;
+
+        //! Memory blocks.
+        std::vector<char*> m_blocks;
+
+        //! Next slot that was never used in the last block.
+        char* m_next;
+
+        //! End of the last block.
+        char* m_end;
+
+        //! Slots of deleted objects, linked through their first bytes.
+        void* m_freeSlots;
+    };
+
+
+    //--------------------------------------------------------------------------
+    // PROTECTED METHODS:
+    //--------------------------------------------------------------------------
+
+protected:
+
+    //! This method returns a slot of a given size and the pool it belongs to.
+    char* allocateSlot(const size_t a_size, cArenaPool*& a_pool);
+
+    //! This method returns a slot to its pool.
+    void deallocateSlot(cArenaPool* a_pool, char* a_slot);
+
+
+    //--------------------------------------------------------------------------
+    // PROTECTED MEMBERS:
+    //--------------------------------------------------------------------------
+
+protected:
+
+    //! Pools, by slot size.
+    std::map<size_t, cArenaPool*> m_pools;
+
+    //! Mutex that protects the pools.
+    cMutex m_mutex;
+
+    //! Number of objects that are not deleted, plus one until the arena is released.
+    std::atomic<unsigned int> m_numReferences;
+
+    //! Number of bytes of all memory blocks.
+    size_t m_numBytes;
+
+    //! If __true__, the arena is destroyed when its last object is deleted, and slots are not reused.
+    std::atomic<bool> m_released;
+};
+
+//------------------------------------------------------------------------------
+} // namespace chai3d
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+#endif
+//------------------------------------------------------------------------------
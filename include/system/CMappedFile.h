@@ -0,0 +1,153 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2003-2016, CHAI3D.
+    (www.chai3d.org)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of CHAI3D nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE. 
+
+    \author    <http://www.chai3d.org>
+    \version   3.2.0 $Rev: 1869 $
+*/
+//==============================================================================
+
+//------------------------------------------------------------------------------
+#ifndef CMappedFileH
+#define CMappedFileH
+//------------------------------------------------------------------------------
+#include "system/CGlobals.h"
+#include "math/CConstants.h"
+#include <string>
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+namespace chai3d {
+//------------------------------------------------------------------------------
+
+//==============================================================================
+/*!
+    \file       CMappedFile.h
+    \ingroup    system
+
+    \brief
+    Implements read-only memory mapped files.
+*/
+//==============================================================================
+
+//------------------------------------------------------------------------------
+class cMappedFile;
+typedef std::shared_ptr<cMappedFile> cMappedFilePtr;
+//------------------------------------------------------------------------------
+
+//==============================================================================
+/*!
+    \class      cMappedFile
+    \ingroup    system
+
+    \brief
+    This class maps the content of a file in memory.
+
+    \details
+    The file is mapped copy-on-write: its content can be used in place
+    without reading it, pages are loaded by the operating system when they
+    are first accessed and are shared between processes mapping the same
+    file. Writes to the mapped memory are private and never reach the file.
+*/
+//==============================================================================
+class cMappedFile
+{
+    //--------------------------------------------------------------------------
+    // CONSTRUCTOR & DESTRUCTOR:
+    //--------------------------------------------------------------------------
+
+public:
+
+    //! Constructor of cMappedFile.
+    cMappedFile();
+
+    //! Destructor of cMappedFile.
+    virtual ~cMappedFile();
+
+    //! Shared cMappedFile allocator.
+    static cMappedFilePtr create() { return (std::make_shared<cMappedFile>()); }
+
+
+    //--------------------------------------------------------------------------
+    // PUBLIC METHODS:
+    //--------------------------------------------------------------------------
+
+public:
+
+    //! This method maps a file in memory.
+    bool open(const std::string& a_filename);
+
+    //! This method unmaps the file.
+    void close();
+
+    //! This method returns __true__ if a file is mapped.
+    bool isOpen() const { return (m_data != nullptr); }
+
+    //! This method returns a pointer to the content of the file.
+    unsigned char* getData() const { return (m_data); }
+
+    //! This method returns the size of the file in bytes.
+    size_t getSize() const { return (m_size); }
+
+
+    //--------------------------------------------------------------------------
+    // PROTECTED MEMBERS:
+    //--------------------------------------------------------------------------
+
+protected:
+
+    //! Mapped memory.
+    unsigned char* m_data;
+
+    //! Size of the mapped memory.
+    size_t m_size;
+
+#if defined(WIN32) | defined(WIN64)
+    //! File handle.
+    HANDLE m_file;
+
+    //! File mapping handle.
+    HANDLE m_mapping;
+#endif
+};
+
+//------------------------------------------------------------------------------
+} // namespace chai3d
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+#endif
+//------------------------------------------------------------------------------
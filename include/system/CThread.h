@@ -48,6 +48,8 @@
 //------------------------------------------------------------------------------
 #include "system/CGlobals.h"
 //------------------------------------------------------------------------------
+#include <functional>
+//------------------------------------------------------------------------------
 
 //------------------------------------------------------------------------------
 namespace chai3d {
@@ -157,6 +159,17 @@ protected:
     CThreadPriority m_priorityLevel;
 };
 
+
+//------------------------------------------------------------------------------
+// GENERAL UTILITY FUNCTIONS:
+//------------------------------------------------------------------------------
+
+//! This function returns the number of threads that can run concurrently (at least 1).
+unsigned int cGetNumHardwareThreads();
+
+//! This function runs __a_numTasks__ tasks on a persistent pool of threads and waits until all of them are done.
+void cParallelFor(const unsigned int a_numTasks, const std::function<void(unsigned int)>& a_task);
+
 //------------------------------------------------------------------------------
 } // namespace chai3d
 //------------------------------------------------------------------------------
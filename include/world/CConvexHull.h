@@ -0,0 +1,272 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2003-2016, CHAI3D.
+    (www.chai3d.org)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of CHAI3D nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE. 
+
+    \author    <http://www.chai3d.org>
+    \version   3.2.0 $Rev: 1869 $
+*/
+//==============================================================================
+//------------------------------------------------------------------------------
+#ifndef CConvexHullH
+#define CConvexHullH
+//------------------------------------------------------------------------------
+#include "graphics/CTriangleArray.h"
+#include "math/CVector3d.h"
+#include <memory>
+#include <vector>
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+namespace chai3d {
+//------------------------------------------------------------------------------
+
+//==============================================================================
+/*!
+    \file       CConvexHull.h
+    \ingroup    world
+
+    \brief
+    Implements a convex polyhedron queried through its support function.
+*/
+//==============================================================================
+
+//------------------------------------------------------------------------------
+class cConvexHull;
+typedef std::shared_ptr<cConvexHull> cConvexHullPtr;
+//------------------------------------------------------------------------------
+
+//==============================================================================
+/*!
+    \struct     cConvexHullCache
+    \ingroup    world
+
+    \brief
+    This structure keeps the result of a query on a convex hull, to start the
+    next query from it.
+
+    \details
+    Successive queries of a haptic loop are close to each other: starting the
+    search from the last simplex and support vertex usually ends it in one or
+    two iterations.
+*/
+//==============================================================================
+struct cConvexHullCache
+{
+    //! Constructor of cConvexHullCache.
+    cConvexHullCache() : m_simplexSize(0), m_supportVertex(0) {}
+
+    //! Vertices of the simplex found by the last distance query.
+    int m_simplex[4];
+
+    //! Number of vertices in m_simplex.
+    int m_simplexSize;
+
+    //! Vertex from which support queries start climbing.
+    int m_supportVertex;
+};
+
+//==============================================================================
+/*!
+    \class      cConvexHull
+    \ingroup    world
+
+    \brief
+    This class implements a convex polyhedron queried through its support
+    function.
+
+    \details
+    The hull of a point cloud is computed by quickhull: the cloud is split
+    in parts whose hulls are computed in parallel, then the hull of their
+    vertices is computed. \n
+
+    Queries only use the support function (the vertex furthest in a
+    direction), found by climbing the edges of the hull from the vertex of
+    the previous query, so that their cost hardly depends on the number of
+    vertices. Distances are computed by GJK (Gilbert-Johnson-Keerthi),
+    penetrations by EPA (expanding polytope algorithm) and swept spheres by
+    the GJK ray cast of van den Bergen.
+*/
+//==============================================================================
+class cConvexHull
+{
+    //--------------------------------------------------------------------------
+    // CONSTRUCTOR & DESTRUCTOR:
+    //--------------------------------------------------------------------------
+
+public:
+
+    //! Constructor of cConvexHull.
+    cConvexHull();
+
+    //! Destructor of cConvexHull.
+    virtual ~cConvexHull() {}
+
+    //! Shared cConvexHull allocator.
+    static cConvexHullPtr create() { return (std::make_shared<cConvexHull>()); }
+
+
+    //--------------------------------------------------------------------------
+    // PUBLIC METHODS - CONSTRUCTION:
+    //--------------------------------------------------------------------------
+
+public:
+
+    //! This method computes the hull of a point cloud.
+    bool createFromPoints(const std::vector<cVector3d>& a_points);
+
+    //! This method computes the hull of the vertices of triangles.
+    bool createFromTriangles(const cTriangleArrayPtr a_triangles);
+
+    //! This method returns __true__ if triangles lie on the hull and cover it, i.e. if they form a convex mesh.
+    bool isHullOf(const cTriangleArrayPtr a_triangles, const double a_tolerance) const;
+
+    //! This method scales the hull about the origin of its frame.
+    void scale(const cVector3d& a_scaleFactors);
+
+    //! This method returns __true__ if the hull is empty.
+    bool isEmpty() const { return (m_vertices.empty()); }
+
+
+    //--------------------------------------------------------------------------
+    // PUBLIC METHODS - GEOMETRY:
+    //--------------------------------------------------------------------------
+
+public:
+
+    //! This method returns the number of vertices.
+    unsigned int getNumVertices() const { return ((unsigned int)m_vertices.size()); }
+
+    //! This method returns the position of a vertex.
+    const cVector3d& getVertex(const unsigned int a_index) const { return (m_vertices[a_index]); }
+
+    //! This method returns the number of triangles.
+    unsigned int getNumTriangles() const { return ((unsigned int)m_faceNormals.size()); }
+
+    //! This method returns a vertex (0, 1 or 2) of a triangle, counterclockwise seen from outside.
+    unsigned int getTriangleVertex(const unsigned int a_triangle, const unsigned int a_vertex) const { return (m_triangles[3 * a_triangle + a_vertex]); }
+
+    //! This method returns the outward normal of a triangle.
+    const cVector3d& getTriangleNormal(const unsigned int a_triangle) const { return (m_faceNormals[a_triangle]); }
+
+    //! This method returns the minimum corner of the bounding box.
+    const cVector3d& getBoundaryMin() const { return (m_boundaryMin); }
+
+    //! This method returns the maximum corner of the bounding box.
+    const cVector3d& getBoundaryMax() const { return (m_boundaryMax); }
+
+    //! This method returns the distance under which two points of the hull are not told apart.
+    double getTolerance() const { return (m_tolerance); }
+
+
+    //--------------------------------------------------------------------------
+    // PUBLIC METHODS - QUERIES:
+    //--------------------------------------------------------------------------
+
+public:
+
+    //! This method returns the vertex furthest in a direction, climbing from the vertex of the cache.
+    int getSupportVertex(const cVector3d& a_direction, cConvexHullCache& a_cache) const;
+
+    //! This method computes the distance from a point to the hull, zero inside (GJK).
+    double computeDistance(const cVector3d& a_point,
+        cVector3d& a_nearestPoint,
+        cConvexHullCache& a_cache) const;
+
+    //! This method computes how deep a point is inside the hull, and the direction to leave it (EPA).
+    double computePenetration(const cVector3d& a_point,
+        cVector3d& a_normal,
+        cConvexHullCache& a_cache) const;
+
+    //! This method computes the first contact of a sphere moving along a segment (GJK ray cast).
+    bool computeSweptSphere(const cVector3d& a_segmentPointA,
+        const cVector3d& a_segmentPointB,
+        const double a_radius,
+        double& a_fraction,
+        cVector3d& a_normal,
+        cConvexHullCache& a_cache) const;
+
+
+    //--------------------------------------------------------------------------
+    // PROTECTED MEMBERS:
+    //--------------------------------------------------------------------------
+
+protected:
+
+    //! Vertices of the hull.
+    std::vector<cVector3d> m_vertices;
+
+    //! Vertices of the triangles, 3 per triangle, counterclockwise seen from outside.
+    std::vector<unsigned int> m_triangles;
+
+    //! Outward normal of each triangle.
+    std::vector<cVector3d> m_faceNormals;
+
+    //! Distance from the origin to the plane of each triangle, along its normal.
+    std::vector<double> m_faceOffsets;
+
+    //! Start of the neighbours of each vertex in m_neighbours, plus the end of the last one.
+    std::vector<unsigned int> m_neighbourOffsets;
+
+    //! Vertices joined to each vertex by an edge.
+    std::vector<unsigned int> m_neighbours;
+
+    //! Minimum corner of the bounding box.
+    cVector3d m_boundaryMin;
+
+    //! Maximum corner of the bounding box.
+    cVector3d m_boundaryMax;
+
+    //! Distance under which two points of the hull are not told apart.
+    double m_tolerance;
+
+
+    //--------------------------------------------------------------------------
+    // PROTECTED METHODS:
+    //--------------------------------------------------------------------------
+
+protected:
+
+    //! This method computes the planes, edges and bounding box of the triangles.
+    void updateGeometry();
+};
+
+//------------------------------------------------------------------------------
+} // namespace chai3d
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+#endif
+//------------------------------------------------------------------------------
@@ -0,0 +1,176 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2003-2016, CHAI3D.
+    (www.chai3d.org)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of CHAI3D nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE. 
+
+    \author    <http://www.chai3d.org>
+    \version   3.2.0 $Rev: 1869 $
+*/
+//==============================================================================
+//------------------------------------------------------------------------------
+#ifndef CConvexObjectH
+#define CConvexObjectH
+//------------------------------------------------------------------------------
+#include "world/CGenericObject.h"
+#include "world/CConvexHull.h"
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+namespace chai3d {
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+class cMesh;
+//------------------------------------------------------------------------------
+
+//==============================================================================
+/*!
+    \file       CConvexObject.h
+    \ingroup    world
+
+    \brief
+    Implementation of a convex polyhedral object.
+*/
+//==============================================================================
+
+//==============================================================================
+/*!
+    \class      cConvexObject
+    \ingroup    world
+
+    \brief
+    This class implements a rigid convex polyhedron, such as the convex hull
+    of a mesh.
+
+    \details
+    Collisions with a segment are computed by casting the collision sphere of
+    the tool along the segment against the hull (GJK ray cast), and the
+    tool-object interaction used by force effects by GJK and EPA. These
+    queries only use the support function of the hull, which climbs from
+    the vertex found by the previous query: in a haptic loop, their cost
+    hardly depends on the number of vertices, unlike a collision tree of
+    the triangles of a mesh. \n
+
+    The collision radius of the tool can be of any size. Scaling the object
+    scales a copy of the hull.
+*/
+//==============================================================================
+class cConvexObject : public cGenericObject
+{
+    //--------------------------------------------------------------------------
+    // CONSTRUCTOR & DESTRUCTOR:
+    //--------------------------------------------------------------------------
+
+public:
+
+    //! Constructor of cConvexObject.
+    cConvexObject(cMaterialPtr a_material = cMaterialPtr());
+
+    //! Destructor of cConvexObject.
+    virtual ~cConvexObject() {}
+
+
+    //--------------------------------------------------------------------------
+    // PUBLIC METHODS:
+    //--------------------------------------------------------------------------
+
+public:
+
+    //! This method sets the hull of this object to the convex hull of a point cloud.
+    bool createFromPoints(const std::vector<cVector3d>& a_points);
+
+    //! This method sets the hull of this object to the convex hull of the vertices of a mesh.
+    bool createFromMesh(cMesh* a_mesh);
+
+    //! This method sets the convex hull of this object.
+    void setConvexHull(cConvexHullPtr a_convexHull);
+
+    //! This method returns the convex hull of this object.
+    cConvexHullPtr getConvexHull() const { return (m_convexHull); }
+
+    //! This method scales this object by using different factors along X, Y and Z axes.
+    void scaleXYZ(const double a_scaleX, const double a_scaleY, const double a_scaleZ);
+
+    //! This method renders this object graphically using OpenGL.
+    virtual void render(cRenderOptions& a_options);
+
+
+    //--------------------------------------------------------------------------
+    // PROTECTED METHODS:
+    //--------------------------------------------------------------------------
+
+protected:
+
+    //! This method updates the boundary box of this object.
+    virtual void updateBoundaryBox();
+
+    //! This method scales the size of this object with given scale factor.
+    virtual void scaleObject(const double& a_scaleFactor) { scaleXYZ(a_scaleFactor, a_scaleFactor, a_scaleFactor); }
+
+    //! This method updates the geometric relationship between the tool and the current object.
+    virtual void computeLocalInteraction(const cVector3d& a_toolPos,
+        const cVector3d& a_toolVel,
+        const unsigned int a_IDN);
+
+    //! This method returns __true__: the tool is inside of the hull within its boundary box only.
+    virtual bool hasBoundedInteraction() const { return (true); }
+
+    //! This method computes collisions between a segment and this object.
+    virtual bool computeOtherCollisionDetection(cVector3d& a_segmentPointA,
+        cVector3d& a_segmentPointB,
+        cCollisionRecorder& a_recorder,
+        cCollisionSettings& a_settings);
+
+
+    //--------------------------------------------------------------------------
+    // PROTECTED MEMBERS:
+    //--------------------------------------------------------------------------
+
+protected:
+
+    //! Convex hull, in the frame of the object.
+    cConvexHullPtr m_convexHull;
+
+    //! Result of the last query on the hull, from which the next one starts.
+    cConvexHullCache m_cache;
+};
+
+//------------------------------------------------------------------------------
+} // namespace chai3d
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+#endif
+//------------------------------------------------------------------------------
@@ -0,0 +1,170 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2003-2016, CHAI3D.
+    (www.chai3d.org)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of CHAI3D nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE. 
+
+    \author    <http://www.chai3d.org>
+    \version   3.2.0 $Rev: 1869 $
+*/
+//==============================================================================
+
+//------------------------------------------------------------------------------
+#ifndef CDistanceFieldObjectH
+#define CDistanceFieldObjectH
+//------------------------------------------------------------------------------
+#include "world/CGenericObject.h"
+#include "world/CSignedDistanceField.h"
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+namespace chai3d {
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+class cMesh;
+//------------------------------------------------------------------------------
+
+//==============================================================================
+/*!
+    \file       CDistanceFieldObject.h
+    \ingroup    world
+
+    \brief
+    Implementation of an object described by a signed distance field.
+*/
+//==============================================================================
+
+//==============================================================================
+/*!
+    \class      cDistanceFieldObject
+    \ingroup    world
+
+    \brief
+    This class implements a rigid object whose surface is the zero level of
+    a signed distance field.
+
+    \details
+    Collisions with a segment are found by marching along the segment with
+    steps bounded by the distance to the surface, and the normal is the
+    gradient of the field. The cost of a query does not depend on the number
+    of triangles the field was baked from, which makes the object suited to
+    large static meshes rendered with the finger-proxy algorithm. The
+    tool-object interaction used by force effects (penetration, nearest
+    surface point and normal) is answered by a single lookup. \n
+
+    The collision radius of the tool is limited to the band of the field
+    minus one cell: fields must be baked with a band larger than the radius
+    of the tools touching them. Scaling the object scales a copy of the
+    field. The object is not rendered.
+*/
+//==============================================================================
+class cDistanceFieldObject : public cGenericObject
+{
+    //--------------------------------------------------------------------------
+    // CONSTRUCTOR & DESTRUCTOR:
+    //--------------------------------------------------------------------------
+
+public:
+
+    //! Constructor of cDistanceFieldObject.
+    cDistanceFieldObject(cMaterialPtr a_material = cMaterialPtr());
+
+    //! Destructor of cDistanceFieldObject.
+    virtual ~cDistanceFieldObject() {}
+
+
+    //--------------------------------------------------------------------------
+    // PUBLIC METHODS:
+    //--------------------------------------------------------------------------
+
+public:
+
+    //! This method bakes the field from the triangles of a mesh, reusing a field cached on disk if available.
+    bool createFromMesh(cMesh* a_mesh,
+        const double a_cellSize,
+        const double a_bandWidth,
+        const std::string& a_cacheDirectory = "");
+
+    //! This method sets the signed distance field of this object.
+    void setDistanceField(cSignedDistanceFieldPtr a_field);
+
+    //! This method returns the signed distance field of this object.
+    cSignedDistanceFieldPtr getDistanceField() const { return (m_distanceField); }
+
+
+    //--------------------------------------------------------------------------
+    // PROTECTED METHODS:
+    //--------------------------------------------------------------------------
+
+protected:
+
+    //! This method updates the boundary box of this object.
+    virtual void updateBoundaryBox();
+
+    //! This method scales the size of this object with given scale factor.
+    virtual void scaleObject(const double& a_scaleFactor);
+
+    //! This method updates the geometric relationship between the tool and the current object.
+    virtual void computeLocalInteraction(const cVector3d& a_toolPos,
+        const cVector3d& a_toolVel,
+        const unsigned int a_IDN);
+
+    //! This method returns __true__: the tool is inside of the field within its boundary box only.
+    virtual bool hasBoundedInteraction() const { return (true); }
+
+    //! This method computes collisions between a segment and this object.
+    virtual bool computeOtherCollisionDetection(cVector3d& a_segmentPointA,
+        cVector3d& a_segmentPointB,
+        cCollisionRecorder& a_recorder,
+        cCollisionSettings& a_settings);
+
+
+    //--------------------------------------------------------------------------
+    // PROTECTED MEMBERS:
+    //--------------------------------------------------------------------------
+
+protected:
+
+    //! Signed distance field, in the frame of the object.
+    cSignedDistanceFieldPtr m_distanceField;
+};
+
+//------------------------------------------------------------------------------
+} // namespace chai3d
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+#endif
+//------------------------------------------------------------------------------
@@ -57,6 +57,7 @@
 #include "materials/CNormalMap.h"
 #include "math/CMaths.h"
 #include "math/CTransform.h"
+#include "system/CArena.h"
 #include "system/CGenericType.h"
 //------------------------------------------------------------------------------
 #include <vector>
@@ -69,7 +70,9 @@ namespace chai3d {
 
 //------------------------------------------------------------------------------
 class cGenericCollision;
+class cEffectTable;
 class cGenericForceAlgorithm;
+class cHapticScene;
 class cMultiMesh;
 class cShaderProgram;
 class cInteractionRecorder;
@@ -109,9 +112,11 @@ typedef std::shared_ptr<cShaderProgram> cShaderProgramPtr;
     the scene graph.
 */
 //==============================================================================
-class cGenericObject : public cGenericType
+class cGenericObject : public cGenericType, public cArenaObject
 {
     friend class cMultiMesh;
+    friend class cEffectTable;
+    friend class cHapticScene;
 
     //--------------------------------------------------------------------------
     // CONSTRUCTOR & DESTRUCTOR:
@@ -372,6 +377,9 @@ public:
     //! This method deletes any current viscous haptic effect.
     bool deleteEffectViscosity();
 
+    //! This method returns __true__ if the effects of this object are evaluated by an effect table (see cEffectTable).
+    inline bool getEffectsCompiled() const { return (m_effectTable != NULL); }
+
 
     //-----------------------------------------------------------------------
     // PUBLIC METHODS - HAPTIC PROPERTIES:
@@ -393,6 +401,15 @@ public:
         double a_dynamicFriction,
         const bool a_affectChildren = true);
 
+    //! This method enables or disables skipping this object and its children when the tool is beyond the reach of their effects, optionally propagating the change to children.
+    virtual void setInteractionCullingEnabled(const bool a_enabled, const bool a_affectChildren = true);
+
+    //! This method returns __true__ if this object is skipped when the tool is beyond the reach of its effects.
+    inline bool getInteractionCullingEnabled() const { return (m_interactionCullingEnabled); }
+
+    //! This method returns the box, in the reference frame of the parent, outside of which this object and its children produce no interaction, and __false__ if there is none.
+    bool getInteractionBoundary(cVector3d& a_boundaryMin, cVector3d& a_boundaryMax) const;
+
 
     //-----------------------------------------------------------------------
     // PUBLIC METHODS - GRAPHIC PROPERTIES:
@@ -884,6 +901,36 @@ protected:
     //! List of haptic effects programmed for this object.
     std::vector<cGenericEffect*> m_effects;
 
+    //! Effect table that evaluates the effects of this object, or NULL.
+    cEffectTable* m_effectTable;
+
+    //! Index of this object in its effect table.
+    int m_effectTableIndex;
+
+    //! Compiled haptic scene that this object belongs to, or NULL.
+    cHapticScene* m_hapticScene;
+
+    //! If __true__, this object is skipped when the tool is outside of its interaction boundary.
+    bool m_interactionCullingEnabled;
+
+    //! If __true__, the interaction boundary is known, and interactions outside of it can be skipped.
+    bool m_interactionBounded;
+
+    //! If __true__, neither this object nor its children produce interactions.
+    bool m_interactionBoundaryEmpty;
+
+    //! Minimum corner of the interaction boundary, in the reference frame of the parent.
+    cVector3d m_interactionBoundaryMin;
+
+    //! Maximum corner of the interaction boundary, in the reference frame of the parent.
+    cVector3d m_interactionBoundaryMax;
+
+    //! If __true__, the tool of each force algorithm (IDN) was within the interaction boundary at its last haptic iteration.
+    bool m_interactionNear[C_EFFECT_MAX_IDN];
+
+    //! Number of proxy contacts with this object and its children.
+    int m_interactionContacts;
+
     //-----------------------------------------------------------------------
     // PROTECTED VIRTUAL METHODS:
     //-----------------------------------------------------------------------
@@ -907,6 +954,12 @@ protected:
         const cVector3d& a_toolVel,
         const unsigned int a_IDN);
 
+    //! This method returns __true__ if computeLocalInteraction() locates the tool inside of this object only within its boundary box.
+    virtual bool hasBoundedInteraction() const { return (false); }
+
+    //! This method updates the interaction boundary of this object from its effects and from the boundaries of its children.
+    virtual void updateInteractionBoundary();
+
     //! This method computes any additional interactions between the object and the tools.
     virtual cVector3d computeOtherInteractions(const cVector3d& a_toolPos,
         const cVector3d& a_toolVel,
@@ -926,6 +979,24 @@ protected:
 
 protected:
 
+    //! This method starts the interaction boundary, in the reference frame of this object, with the reach of its effects.
+    void initInteractionBoundary();
+
+    //! This method extends the interaction boundary with the one of a child.
+    void addInteractionBoundary(const cGenericObject* a_child);
+
+    //! This method converts the interaction boundary to the reference frame of the parent.
+    void transformInteractionBoundary();
+
+    //! This method tells the compiled haptic scene of this object, if any, that the scene graph changed.
+    void invalidateHapticScene();
+
+    //! This method computes the forces of the effects of this object for a tool located by computeLocalInteraction().
+    cVector3d computeEffectForces(const cVector3d& a_toolPos,
+        const cVector3d& a_toolVel,
+        const unsigned int a_IDN,
+        cInteractionRecorder& a_interactions);
+
     //! This method copies all properties of the current generic object to another.
     void copyGenericObjectProperties(cGenericObject* a_objDest,
         const bool a_duplicateMaterialData,
@@ -964,6 +1035,12 @@ public:
     //! This method adjusts the collision segment to handle objects in motion.
     virtual void adjustCollisionSegment(cVector3d& a_segmentPointA, cVector3d& a_segmentPointAadjusted);
 
+    //! This method returns __true__ if interactions with this object and its children can be skipped for a tool position given in the reference frame of the parent.
+    bool isInteractionCulled(const cVector3d& a_toolPos, const unsigned int a_IDN);
+
+    //! This method records the start or the end of a proxy contact with this object, which is then never skipped.
+    void setInteractionContact(const bool a_contact);
+
     //! This method computes all haptic interaction between a tool and this object using the haptic effects.
     virtual cVector3d computeInteractions(const cVector3d& a_toolPos,
         const cVector3d& a_toolVel,
@@ -0,0 +1,209 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2003-2016, CHAI3D.
+    (www.chai3d.org)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of CHAI3D nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE. 
+
+    \author    <http://www.chai3d.org>
+    \version   3.2.0 $Rev: 1869 $
+*/
+//==============================================================================
+//------------------------------------------------------------------------------
+#ifndef CHapticSceneH
+#define CHapticSceneH
+//------------------------------------------------------------------------------
+#include "math/CVector3d.h"
+#include <vector>
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+namespace chai3d {
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+class cGenericObject;
+class cWorld;
+class cCollisionRecorder;
+struct cCollisionSettings;
+//------------------------------------------------------------------------------
+
+//==============================================================================
+/*!
+    \file       CHapticScene.h
+
+    \brief
+    Implements a flat representation of a scene graph for collision detection.
+*/
+//==============================================================================
+
+//==============================================================================
+/*!
+    \class      cHapticScene
+    \ingroup    world
+
+    \brief
+    This class computes the collisions of a segment with a scene graph
+    flattened into arrays.
+
+    \details
+    cGenericObject::computeCollisionDetection() descends the scene graph
+    recursively, with several virtual calls and a vector of children per
+    object. \n\n
+
+    compile() stores the objects of a world in depth-first order, with the
+    index of their parent and the end of their subtree, and the type of
+    each object. computeCollisionDetection() is then a loop over these
+    arrays, which calls the methods of spheres, boxes and voxel objects
+    directly instead of through their virtual table, and which jumps over
+    the subtrees of ghost objects. Objects of other types (multi meshes,
+    tools, other shapes) are traversed by their own methods, with their
+    children. The collisions are the same as the ones of the recursive
+    traversal, in the same order. \n\n
+
+    Positions, rotations and states are read from the objects, so that they
+    can change at any time. Adding or removing children invalidates the
+    scene, which is compiled again before its next traversal. \n\n
+
+    Positions and interactions are computed by the recursive traversals,
+    which measured as fast as flat ones (see benchmark-scene).
+*/
+//==============================================================================
+class cHapticScene
+{
+    //--------------------------------------------------------------------------
+    // CONSTRUCTOR & DESTRUCTOR:
+    //--------------------------------------------------------------------------
+
+public:
+
+    //! Constructor of cHapticScene.
+    cHapticScene();
+
+    //! Destructor of cHapticScene.
+    virtual ~cHapticScene();
+
+
+    //--------------------------------------------------------------------------
+    // PUBLIC METHODS:
+    //--------------------------------------------------------------------------
+
+public:
+
+    //! This method flattens the scene graph of a world.
+    void compile(cWorld* a_world);
+
+    //! This method releases the objects of the scene.
+    void clear();
+
+    //! This method releases the objects of the scene, which is compiled again before its next traversal.
+    void invalidate();
+
+    //! This method returns __true__ if the scene must be compiled again before its next traversal.
+    bool isInvalid() const { return ((m_world != NULL) && m_objects.empty()); }
+
+    //! This method returns the number of objects in the scene, compiling it if needed.
+    int getNumObjects();
+
+    //! This method computes the collisions between a segment and the objects, as cWorld::computeCollisionDetection() does.
+    bool computeCollisionDetection(const cVector3d& a_segmentPointA,
+                                   const cVector3d& a_segmentPointB,
+                                   cCollisionRecorder& a_recorder,
+                                   cCollisionSettings& a_settings);
+
+
+    //--------------------------------------------------------------------------
+    // PROTECTED TYPES:
+    //--------------------------------------------------------------------------
+
+protected:
+
+    //! Types of objects traversed by the scene.
+    enum cHapticSceneNode
+    {
+        C_HAPTIC_SCENE_ROOT,
+        C_HAPTIC_SCENE_GROUP,
+        C_HAPTIC_SCENE_SPHERE,
+        C_HAPTIC_SCENE_BOX,
+        C_HAPTIC_SCENE_MESH,
+        C_HAPTIC_SCENE_VOXEL,
+        C_HAPTIC_SCENE_OTHER
+    };
+
+
+    //--------------------------------------------------------------------------
+    // PROTECTED METHODS:
+    //--------------------------------------------------------------------------
+
+protected:
+
+    //! This method adds an object and, unless its type is unknown, its descendants.
+    void flatten(cGenericObject* a_object, const int a_parent);
+
+    //! This method compiles the scene again if it was invalidated.
+    void update();
+
+
+    //--------------------------------------------------------------------------
+    // PROTECTED MEMBERS:
+    //--------------------------------------------------------------------------
+
+protected:
+
+    //! World compiled by the scene.
+    cWorld* m_world;
+
+    //! Objects in depth-first order. The world comes first.
+    std::vector<cGenericObject*> m_objects;
+
+    //! Index of the parent of each object.
+    std::vector<int> m_parents;
+
+    //! Index following the last descendant of each object.
+    std::vector<int> m_ends;
+
+    //! Type of each object.
+    std::vector<unsigned char> m_types;
+
+    //! Collision segment in the reference frame of each object.
+    std::vector<cVector3d> m_segmentPointsA;
+    std::vector<cVector3d> m_segmentPointsB;
+};
+
+//------------------------------------------------------------------------------
+} // namespace chai3d
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+#endif
+//------------------------------------------------------------------------------
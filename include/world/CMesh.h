@@ -56,6 +56,7 @@
 #include "materials/CTexture2d.h"
 #include "graphics/CColor.h"
 //------------------------------------------------------------------------------
+#include <string>
 #include <vector>
 #include <list>
 //------------------------------------------------------------------------------
@@ -217,6 +218,9 @@ public:
     //! This method returns the number of stored triangles.
     unsigned int getNumTriangles();
 
+    //! This method removes unused triangles and vertices, renumbers the remaining ones and updates the collision detector.
+    void compress(const bool a_updateCollisionDetector = true);
+
     //! This method clears all triangles and vertices of mesh.
     void clear();
 
@@ -299,6 +303,10 @@ public:
     //! This method builds an AABB collision detector for this mesh.
     virtual void createAABBCollisionDetector(const double a_radius);
 
+    //! This method builds an AABB collision detector for this mesh, reusing a tree saved in a cache directory if available.
+    virtual void createAABBCollisionDetector(const double a_radius,
+                                             const std::string& a_cacheDirectory);
+
 
     //--------------------------------------------------------------------------
     // PUBLIC METHODS - GEOMETRY:
@@ -359,6 +367,9 @@ protected:
         const cVector3d& a_toolVel,
         const unsigned int a_IDN);
 
+    //! This method returns __true__: the tool is inside of a mesh only while the proxy touches it.
+    virtual bool hasBoundedInteraction() const { return (true); }
+
 
     //--------------------------------------------------------------------------
     // PROTECTED MEMBERS - DISPLAY PROPERTIES:
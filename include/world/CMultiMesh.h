@@ -128,6 +128,10 @@ public:
                              double a_dynamicFriction, 
                              const bool a_affectChildren = false);
 
+    //! This method enables or disables skipping this object when the tool is beyond the reach of its effects, optionally propagating the change to children.
+    virtual void setInteractionCullingEnabled(const bool a_enabled, 
+                                              const bool a_affectChildren = true);
+
 
     //-----------------------------------------------------------------------
     // PUBLIC METHODS - GRAPHIC PROPERTIES:
@@ -254,6 +258,10 @@ public:
     //! Set up an AABB collision detector for this mesh.
     virtual void createAABBCollisionDetector(const double a_radius);
 
+    //! Set up an AABB collision detector for this mesh, reusing trees saved in a cache directory if available.
+    virtual void createAABBCollisionDetector(const double a_radius,
+                                             const std::string& a_cacheDirectory);
+
 
     //-----------------------------------------------------------------------
     // PUBLIC VIRTUAL METHODS - INTERACTIONS
@@ -336,6 +344,9 @@ public:
     //! This method returns the the number of stored triangles.
     unsigned int getNumTriangles() const;
 
+    //! This method removes unused triangles and vertices from all meshes and updates their collision detectors.
+    void compress(const bool a_updateCollisionDetector = true);
+
     //! This method clears all triangles and vertices of multi-mesh.
     void clear();
 
@@ -435,6 +446,9 @@ protected:
     //! This method updates the boundary box of this object.
     virtual void updateBoundaryBox();
 
+    //! This method updates the interaction boundary of this object from its effects, its meshes and its children.
+    virtual void updateInteractionBoundary();
+
     //! This method copies all properties of this multi-mesh object to another.
     void copyMultiMeshProperties(cMultiMesh* a_obj,
         const bool a_duplicateMaterialData,
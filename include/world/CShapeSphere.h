@@ -85,6 +85,8 @@ namespace chai3d {
 //==============================================================================
 class cShapeSphere : public cGenericObject
 {
+    friend class cHapticScene;
+
     //--------------------------------------------------------------------------
     // CONSTRUCTOR & DESTRUCTOR:
     //--------------------------------------------------------------------------
@@ -138,6 +140,9 @@ protected:
         const cVector3d& a_toolVel,
         const unsigned int a_IDN);
 
+    //! This method returns __true__: the tool is inside of the sphere within its boundary box only.
+    virtual bool hasBoundedInteraction() const { return (true); }
+
     //! This method computes collisions between a segment and this object.
     virtual bool computeOtherCollisionDetection(cVector3d& a_segmentPointA,
         cVector3d& a_segmentPointB,
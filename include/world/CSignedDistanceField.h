@@ -0,0 +1,252 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2003-2016, CHAI3D.
+    (www.chai3d.org)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of CHAI3D nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE. 
+
+    \author    <http://www.chai3d.org>
+    \version   3.2.0 $Rev: 1869 $
+*/
+//==============================================================================
+
+//------------------------------------------------------------------------------
+#ifndef CSignedDistanceFieldH
+#define CSignedDistanceFieldH
+//------------------------------------------------------------------------------
+#include "graphics/CTriangleArray.h"
+#include "math/CVector3d.h"
+#include <memory>
+#include <string>
+#include <vector>
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+namespace chai3d {
+//------------------------------------------------------------------------------
+
+//==============================================================================
+/*!
+    \file       CSignedDistanceField.h
+    \ingroup    world
+
+    \brief
+    Implements a sparse narrow-band signed distance field.
+*/
+//==============================================================================
+
+//------------------------------------------------------------------------------
+class cSignedDistanceField;
+typedef std::shared_ptr<cSignedDistanceField> cSignedDistanceFieldPtr;
+//------------------------------------------------------------------------------
+
+//! Width (in cells) of the cubic bricks of a signed distance field.
+const int C_SDF_BRICK_SIZE = 8;
+
+//==============================================================================
+/*!
+    \class      cSignedDistanceField
+    \ingroup    world
+
+    \brief
+    This class implements a sparse narrow-band signed distance field.
+
+    \details
+    The field samples the signed distance to a closed surface (negative
+    inside) on a regular grid of nodes. Distances are only stored within
+    \ref getBandWidth() of the surface and are clamped to the band elsewhere. \n
+
+    The grid is divided in cubic bricks of \ref C_SDF_BRICK_SIZE cells. Bricks
+    crossed by the band store all their nodes, including the ones shared with
+    the next bricks, so that a lookup never reads more than one brick. Bricks
+    entirely outside or inside of the band store nothing. \n
+
+    Lookups interpolate the 8 nodes around a point (trilinear interpolation)
+    and cost the same for any surface: the triangle count of a mesh only
+    matters when the field is created. Points outside of the grid get the
+    distance to the grid plus the distance at the nearest grid point.
+*/
+//==============================================================================
+class cSignedDistanceField
+{
+    //--------------------------------------------------------------------------
+    // CONSTRUCTOR & DESTRUCTOR:
+    //--------------------------------------------------------------------------
+
+public:
+
+    //! Constructor of cSignedDistanceField.
+    cSignedDistanceField();
+
+    //! Destructor of cSignedDistanceField.
+    virtual ~cSignedDistanceField() {}
+
+    //! Shared cSignedDistanceField allocator.
+    static cSignedDistanceFieldPtr create() { return (std::make_shared<cSignedDistanceField>()); }
+
+
+    //--------------------------------------------------------------------------
+    // PUBLIC METHODS:
+    //--------------------------------------------------------------------------
+
+public:
+
+    //! This method creates the field from a closed triangle mesh.
+    bool createFromTriangles(const cTriangleArrayPtr a_triangles,
+        const double a_cellSize,
+        const double a_bandWidth);
+
+    //! This method creates the field from a grid of distance samples.
+    bool createFromGrid(const float* a_values,
+        const int a_numNodesX,
+        const int a_numNodesY,
+        const int a_numNodesZ,
+        const cVector3d& a_origin,
+        const double a_cellSize,
+        const double a_bandWidth);
+
+    //! This method loads a field previously saved for the same hash.
+    bool loadFromFile(const std::string& a_filename, const unsigned long long a_hash);
+
+    //! This method saves the field to a file.
+    bool saveToFile(const std::string& a_filename, const unsigned long long a_hash) const;
+
+    //! This method computes a hash of triangles and field parameters, for cache files.
+    static unsigned long long computeHash(const cTriangleArrayPtr a_triangles,
+        const double a_cellSize,
+        const double a_bandWidth);
+
+    //! This method scales the field, and the surface it describes, about the origin of its frame.
+    void scale(const double a_scaleFactor);
+
+    //! This method returns __true__ if the field contains data.
+    bool isEmpty() const { return (m_brickIndex.empty()); }
+
+    //! This method returns the signed distance at a point.
+    double getDistance(const cVector3d& a_point) const;
+
+    //! This method returns the signed distance and its gradient at a point.
+    double getDistance(const cVector3d& a_point, cVector3d& a_gradient) const;
+
+    //! This method returns the position of the first node of the grid.
+    const cVector3d& getOrigin() const { return (m_origin); }
+
+    //! This method returns the position of the last node of the grid.
+    cVector3d getEnd() const;
+
+    //! This method returns the distance between two neighbour nodes.
+    double getCellSize() const { return (m_cellSize); }
+
+    //! This method returns the distance from the surface beyond which values are clamped.
+    double getBandWidth() const { return (m_bandWidth); }
+
+    //! This method returns the number of cells along an axis.
+    int getNumCells(const int a_axis) const { return (m_numCells[a_axis]); }
+
+    //! This method returns the number of bricks that store their nodes.
+    int getNumStoredBricks() const { return ((int)(m_values.size() / C_SDF_BRICK_NODES)); }
+
+    //! This method returns the memory used by the field in bytes.
+    size_t getMemorySize() const { return (m_brickIndex.size() * sizeof(int) + m_values.size() * sizeof(float)); }
+
+
+    //--------------------------------------------------------------------------
+    // PROTECTED CONSTANTS:
+    //--------------------------------------------------------------------------
+
+protected:
+
+    //! Nodes along an edge of a brick.
+    static const int C_SDF_BRICK_WIDTH = C_SDF_BRICK_SIZE + 1;
+
+    //! Nodes stored by a brick.
+    static const int C_SDF_BRICK_NODES = C_SDF_BRICK_WIDTH * C_SDF_BRICK_WIDTH * C_SDF_BRICK_WIDTH;
+
+    //! Brick index of bricks outside of the band, on the outer side.
+    static const int C_SDF_BRICK_OUTSIDE = -1;
+
+    //! Brick index of bricks outside of the band, on the inner side.
+    static const int C_SDF_BRICK_INSIDE = -2;
+
+
+    //--------------------------------------------------------------------------
+    // PROTECTED MEMBERS:
+    //--------------------------------------------------------------------------
+
+protected:
+
+    //! Position of the first node.
+    cVector3d m_origin;
+
+    //! Distance between two neighbour nodes.
+    double m_cellSize;
+
+    //! Distance from the surface beyond which values are clamped.
+    double m_bandWidth;
+
+    //! Number of cells along each axis, a multiple of the brick size.
+    int m_numCells[3];
+
+    //! Number of bricks along each axis.
+    int m_numBricks[3];
+
+    //! Offset of each brick in m_values (in bricks), or C_SDF_BRICK_OUTSIDE / C_SDF_BRICK_INSIDE, X first.
+    std::vector<int> m_brickIndex;
+
+    //! Nodes of the stored bricks, X first within a brick.
+    std::vector<float> m_values;
+
+
+    //--------------------------------------------------------------------------
+    // PROTECTED METHODS:
+    //--------------------------------------------------------------------------
+
+protected:
+
+    //! This method sets the position and size of the grid.
+    bool allocateGrid(const cVector3d& a_origin, const double a_numCells[3], const double a_cellSize, const double a_bandWidth);
+
+    //! This method stores the nodes of the bricks computed by a callback, in parallel.
+    template <typename T> void fillBricks(T a_brickNodes);
+
+    //! This method interpolates the field inside of the grid.
+    double interpolate(const cVector3d& a_point, cVector3d* a_gradient) const;
+};
+
+//------------------------------------------------------------------------------
+} // namespace chai3d
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+#endif
+//------------------------------------------------------------------------------
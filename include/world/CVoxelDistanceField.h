@@ -0,0 +1,207 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2003-2016, CHAI3D.
+    (www.chai3d.org)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of CHAI3D nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE. 
+
+    \author    <http://www.chai3d.org>
+    \version   3.2.0 $Rev: 1869 $
+*/
+//==============================================================================
+
+//------------------------------------------------------------------------------
+#ifndef CVoxelDistanceFieldH
+#define CVoxelDistanceFieldH
+//------------------------------------------------------------------------------
+#include "graphics/CImage.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+namespace chai3d {
+//------------------------------------------------------------------------------
+
+//==============================================================================
+/*!
+    \file       CVoxelDistanceField.h
+    \ingroup    world
+
+    \brief
+    Implements a brick map and coarse distance field of a volume.
+*/
+//==============================================================================
+
+//------------------------------------------------------------------------------
+class cVoxelDistanceField;
+typedef std::shared_ptr<cVoxelDistanceField> cVoxelDistanceFieldPtr;
+//------------------------------------------------------------------------------
+
+//! Default width (in voxels) of the cubic bricks of a voxel distance field.
+const int C_VOXEL_BRICK_SIZE = 8;
+
+//==============================================================================
+/*!
+    \class      cVoxelDistanceField
+    \ingroup    world
+
+    \brief
+    This class implements a brick map and a coarse signed distance field
+    of a volume.
+
+    \details
+    The volume is divided in cubic bricks of voxels. A brick is occupied if
+    at least one of its voxels reaches the isosurface value, and full if all
+    of them do. For each brick the field stores the signed Chebyshev distance
+    (in bricks) to the surface: the distance to the nearest occupied brick
+    for empty bricks, minus the distance to the nearest brick that is not
+    full for full bricks, and 0 for bricks crossed by the surface. \n
+
+    Collision queries use it to skip the empty space around the tool in
+    constant time: no voxel within \ref getFreeRadius() voxels of an empty
+    voxel is occupied. Voxels outside of the volume count as empty. \n
+
+    The field is a snapshot of the image: it must be created again after
+    the voxels or the isosurface value change. \ref isValidFor() detects
+    both, as long as the voxels are modified with the methods of the image
+    (or cImage::markAsModified() is called after writing to its data).
+*/
+//==============================================================================
+class cVoxelDistanceField
+{
+    //--------------------------------------------------------------------------
+    // CONSTRUCTOR & DESTRUCTOR:
+    //--------------------------------------------------------------------------
+
+public:
+
+    //! Constructor of cVoxelDistanceField.
+    cVoxelDistanceField();
+
+    //! Destructor of cVoxelDistanceField.
+    virtual ~cVoxelDistanceField() {}
+
+    //! Shared cVoxelDistanceField allocator.
+    static cVoxelDistanceFieldPtr create() { return (std::make_shared<cVoxelDistanceField>()); }
+
+
+    //--------------------------------------------------------------------------
+    // PUBLIC METHODS:
+    //--------------------------------------------------------------------------
+
+public:
+
+    //! This method creates the field from the alpha channel of a volume image.
+    bool createField(cImagePtr a_image, const float a_isosurfaceValue, const int a_brickSize = C_VOXEL_BRICK_SIZE);
+
+    //! This method returns __true__ if the field contains data.
+    bool isEmpty() const { return (m_distance.empty()); }
+
+    //! This method returns __true__ if the field was created from this image, unmodified since, and this isosurface value.
+    bool isValidFor(cImagePtr a_image, const float a_isosurfaceValue) const;
+
+    //! This method returns the width (in voxels) of the bricks.
+    int getBrickSize() const { return (m_brickSize); }
+
+    //! This method returns the number of bricks along an axis.
+    int getNumBricks(const int a_axis) const { return (m_numBricks[a_axis]); }
+
+    //! This method returns the number of bricks that contain at least one occupied voxel.
+    int getNumOccupiedBricks() const { return (m_numOccupiedBricks); }
+
+    //! This method returns the signed distance (in bricks) from a brick to the surface.
+    inline int getBrickDistance(const int a_x, const int a_y, const int a_z) const
+    {
+        return (m_distance[((size_t)a_z * m_numBricks[1] + a_y) * m_numBricks[0] + a_x]);
+    }
+
+    //! This method returns the signed distance (in voxels) from a voxel to the surface, rounded towards 0.
+    int getVoxelDistance(const int a_x, const int a_y, const int a_z) const;
+
+    //! This method returns a radius (in voxels) around a voxel in which no voxel is occupied, or 0.
+    int getFreeRadius(const int a_x, const int a_y, const int a_z) const;
+
+    //! This method returns __true__ if no voxel of a box of voxels (bounds included) is occupied.
+    bool isRegionEmpty(const int a_min[3], const int a_max[3]) const;
+
+
+    //--------------------------------------------------------------------------
+    // PROTECTED MEMBERS:
+    //--------------------------------------------------------------------------
+
+protected:
+
+    //! Size of the volume in voxels.
+    int m_size[3];
+
+    //! Number of bricks along each axis.
+    int m_numBricks[3];
+
+    //! Width of the bricks in voxels.
+    int m_brickSize;
+
+    //! Isosurface value used to create the field.
+    float m_isosurfaceValue;
+
+    //! Image from which the field was created.
+    std::weak_ptr<cImage> m_image;
+
+    //! Modification count of the image when the field was created.
+    unsigned long m_imageModificationCount;
+
+    //! Number of occupied bricks.
+    int m_numOccupiedBricks;
+
+    //! Signed distance of each brick, X first.
+    std::vector<int16_t> m_distance;
+
+
+    //--------------------------------------------------------------------------
+    // PROTECTED METHODS:
+    //--------------------------------------------------------------------------
+
+protected:
+
+    //! This method computes the Chebyshev distance (in bricks) of each brick to the nearest source brick.
+    void computeDistance(std::vector<int>& a_distance) const;
+};
+
+//------------------------------------------------------------------------------
+} // namespace chai3d
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+#endif
+//------------------------------------------------------------------------------
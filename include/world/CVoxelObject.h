@@ -48,6 +48,7 @@
 //------------------------------------------------------------------------------
 #include "world/CMesh.h"
 #include "world/CMultiMesh.h"
+#include "world/CVoxelDistanceField.h"
 //------------------------------------------------------------------------------
 
 //------------------------------------------------------------------------------
@@ -106,6 +107,8 @@ struct cVoxelCoordList
 //==============================================================================
 class cVoxelObject : public cMesh
 {
+    friend class cHapticScene;
+
     //--------------------------------------------------------------------------
     // CONSTRUCTOR & DESTRUCTOR:
     //--------------------------------------------------------------------------
@@ -199,6 +202,28 @@ public:
     bool getUseColorMap() const { return m_useColorMap; }
 
 
+    //--------------------------------------------------------------------------
+    // PUBLIC METHODS - HAPTIC ACCELERATION:
+    //--------------------------------------------------------------------------
+
+public:
+
+    //! This method builds the distance field used to skip empty space in collision queries.
+    bool buildDistanceField(const int a_brickSize = C_VOXEL_BRICK_SIZE);
+
+    //! This method deletes the distance field.
+    void clearDistanceField() { m_distanceField = nullptr; }
+
+    //! This method returns the distance field, or __nullptr__ if it was not built.
+    cVoxelDistanceFieldPtr getDistanceField() const { return (m_distanceField); }
+
+    //! This method returns __true__ if the distance field was built from the current image, unmodified since, and isosurface value.
+    bool isDistanceFieldValid() const;
+
+    //! This method computes a lower bound of the signed distance from a point (in local coordinates) to the isosurface.
+    bool computeSurfaceDistance(const cVector3d& a_localPos, double& a_distance) const;
+
+
     //--------------------------------------------------------------------------
     // PUBLIC METHODS - POLYGONIZATION:
     //--------------------------------------------------------------------------
@@ -292,6 +317,9 @@ protected:
     //! List of points.
     std::vector<cVoxelCoordList> m_voxelCoordList;
 
+    //! Brick map and coarse distance field of the volume, used by collision detection.
+    cVoxelDistanceFieldPtr m_distanceField;
+
 
     //--------------------------------------------------------------------------
     // PROTECTED MEMBERS - SHADERS:
@@ -154,6 +154,40 @@ public:
                                          const cVector3d& a_toolVel,
                                          const unsigned int a_IDN);
 
+    //! This method computes all haptic interactions between a tool and the objects of this world, including the compiled effects.
+    virtual cVector3d computeInteractions(const cVector3d& a_toolPos,
+                                          const cVector3d& a_toolVel,
+                                          const unsigned int a_IDN,
+                                          cInteractionRecorder& a_interactions);
+
+    //! This method compiles the effects of the objects of this world that can be evaluated in batches.
+    void compileEffects();
+
+    //! This method releases the compiled effects, which are then evaluated one object at a time again.
+    void clearCompiledEffects();
+
+    //! This method returns the table of compiled effects, or NULL.
+    cEffectTable* getCompiledEffects() const { return (m_compiledEffects); }
+
+    //! This method flattens the scene graph of this world, which is then traversed as arrays by collision detection.
+    void compileScene();
+
+    //! This method releases the compiled scene, which is then traversed recursively again.
+    void clearCompiledScene();
+
+    //! This method returns the compiled scene, or NULL.
+    cHapticScene* getCompiledScene() const { return (m_compiledScene); }
+
+
+    //--------------------------------------------------------------------------
+    // PUBLIC METHODS - MEMORY:
+    //--------------------------------------------------------------------------
+
+public:
+
+    //! This method returns the arena in which objects of this world can be created with cArena::create().
+    cArena* getObjectArena() const { return (m_objectArena); }
+
 
     //-----------------------------------------------------------------------
     // PUBLIC METHODS - SHADOW CASTING:
@@ -240,6 +274,15 @@ protected:
 
     //! If __true__ then shadow maps are used.
     bool m_useShadowCasting;
+
+    //! Table of compiled effects, or NULL.
+    cEffectTable* m_compiledEffects;
+
+    //! Compiled haptic scene, or NULL.
+    cHapticScene* m_compiledScene;
+
+    //! Arena of the objects of this world. It is released with the world.
+    cArena* m_objectArena;
 };
 
 //------------------------------------------------------------------------------
@@ -0,0 +1,961 @@
+// This file is part of HPGE, an Haptic Plugin for Game Engines
+// -----------------------------------------
+
+// Software License Agreement (BSD License)
+// Copyright (c) 2017-2023,
+// Copyright © 2017-2019 Gabriel Baud-Bovy (gbaudbovy <at> gmail.com)
+// Copyright © 2017-2023 Nicolò Balzarotti (nicolo.balzarotti <at> iit.it)
+// Istituto Italiano di Tecnologia (IIT), All rights reserved.
+//
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+
+// 3. Neither the name of HPGE, Istituto Italiano di Tecnologia nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Client shim: implements the HPGE API by forwarding the calls to an
+// HPGE server (hpge-server.cc) through shared memory, see
+// protocol.h. Calls that do not return data are enqueued and return
+// SUCCESS without waiting for the server (their errors are reported
+// by `last_async_error`); the tool state is read from the state
+// block without a round trip. Hooks cannot cross processes and are
+// not available.
+
+#include "protocol.h"
+#include "hpge-client.h"
+#include "HPGE.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace HPGE {
+  using namespace server;
+
+  namespace {
+    struct Mapping {
+      Header * header;
+      size_t size;
+    };
+
+    // The segment of the server, or nullptr. Read without locking by
+    // the tool state functions
+    std::atomic<Header *> segment {nullptr};
+    // Writers of the command ring, guarded by `client_mutex`
+    std::mutex client_mutex;
+    Mapping mapping {nullptr, 0};
+    // Segments of servers that exited, unmapped by `disconnect_server`
+    std::vector<Mapping> lost;
+    uint64_t sequence {0};
+    Writer command;
+    std::vector<char> reply;
+    std::atomic<int> asyncError {SUCCESS};
+
+    bool processAlive (const uint64_t pid) {
+      return kill ((pid_t) pid, 0) == 0 || errno != ESRCH;
+    }
+
+    // The caller holds `client_mutex`
+    void dropServer (void) {
+      if (mapping.header == nullptr) { return; }
+      segment.store (nullptr);
+      lost.push_back (mapping);
+      mapping = {nullptr, 0};
+    }
+
+    // The caller holds `client_mutex`
+    int connectTo (const char * name) {
+      if (name == nullptr) { name = std::getenv ("HPGE_SERVER"); }
+      if (name == nullptr || name [0] == '\0') { name = "hpge"; }
+      std::string path = name [0] == '/' ? name : std::string ("/") + name;
+
+      int fd = shm_open (path.c_str (), O_RDWR, 0);
+      if (fd < 0) { return SERVER_NOT_RUNNING; }
+      struct stat info;
+      if (fstat (fd, &info) != 0 || (size_t) info.st_size < COMMANDS_OFFSET) {
+	close (fd);
+	return SERVER_NOT_RUNNING;
+      }
+      size_t size = (size_t) info.st_size;
+      void * memory = mmap (nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      close (fd);
+      if (memory == MAP_FAILED) { return SERVER_NOT_RUNNING; }
+
+      Header * header = static_cast<Header *> (memory);
+      if (__atomic_load_n (&header -> magic, __ATOMIC_ACQUIRE) != HPGE_SERVER_MAGIC ||
+	  header -> version != HPGE_SERVER_VERSION ||
+	  segmentSize (header -> command_capacity) > size ||
+	  ! processAlive (header -> server_pid)) {
+	munmap (memory, size);
+	return SERVER_NOT_RUNNING;
+      }
+
+      // One client at a time; the one of a process that exited is
+      // replaced
+      uint64_t self = (uint64_t) getpid ();
+      uint64_t previous = __atomic_load_n (&header -> client_pid, __ATOMIC_ACQUIRE);
+      if (previous != self &&
+	  ((previous != 0 && processAlive (previous)) ||
+	   ! __atomic_compare_exchange_n (&header -> client_pid, &previous, self, false,
+					  __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))) {
+	munmap (memory, size);
+	return SERVER_BUSY;
+      }
+
+      dropServer ();
+      mapping = {header, size};
+      // sequence numbers of different clients never match
+      sequence = self << 32;
+      segment.store (header);
+      return SUCCESS;
+    }
+
+    // Builds a command and sends it, holding `client_mutex`
+    class Call {
+    public:
+      Call (const Command c) : lock (client_mutex) {
+	status = mapping.header != nullptr ? SUCCESS : connectTo (nullptr);
+	command.begin (c, ++sequence);
+      }
+
+      Writer & args (void) { return command; }
+
+      // Enqueues the command
+      int post (void) {
+	if (status != SUCCESS) { return retErr ((ErrorMsg) status); }
+	Header * header = mapping.header;
+	size_t size = command.end ();
+	// Commands are not split. A record is contiguous, so one larger
+	// than half the ring may never fit after the padding at its end
+	if (size > header -> command_capacity / 2) { return retErr (COMMAND_TOO_LARGE); }
+	int waited = 0;
+	while (! pushCommand (header, command.bytes (), size)) {
+	  // the ring is full: wait for the server
+	  if (++waited % 1000 == 0 && ! processAlive (header -> server_pid)) {
+	    dropServer ();
+	    status = SERVER_NOT_RUNNING;
+	    return retErr (SERVER_NOT_RUNNING);
+	  }
+	  std::this_thread::sleep_for (std::chrono::microseconds (50));
+	}
+	int pending = __atomic_exchange_n (&header -> async_error, (int32_t) SUCCESS,
+					   __ATOMIC_ACQ_REL);
+	if (pending != SUCCESS) { asyncError.store (pending); }
+	return retErr (SUCCESS);
+      }
+
+      // Enqueues the command and waits for the reply. Returns false if
+      // the server is not running
+      bool call (Reader * out) {
+	if (post () != SUCCESS) { return false; }
+	Header * header = mapping.header;
+	uint64_t expected = sequence;
+	int waited = 0;
+	while (__atomic_load_n (&header -> reply_sequence, __ATOMIC_ACQUIRE) != expected) {
+	  if (++waited < 1000) {
+	    std::this_thread::yield ();
+	    continue;
+	  }
+	  if (waited % 1000 == 0 && ! processAlive (header -> server_pid)) {
+	    dropServer ();
+	    status = SERVER_NOT_RUNNING;
+	    retErr (SERVER_NOT_RUNNING);
+	    return false;
+	  }
+	  std::this_thread::sleep_for (std::chrono::microseconds (50));
+	}
+	reply.assign (header -> reply, header -> reply + header -> reply_size);
+	* out = Reader (reply.data () + sizeof (Record),
+			reply.size () - sizeof (Record));
+	return true;
+      }
+
+      // Sends the command and returns the int result (or `failed`)
+      int result (const int failed) {
+	Reader in (nullptr, 0);
+	if (! call (&in)) { return failed; }
+	return in.get<int32_t> ();
+      }
+      // The same, recording the result as the last error
+      int error (void) {
+	Reader in (nullptr, 0);
+	if (! call (&in)) { return status; }
+	return retErr ((ErrorMsg) in.get<int32_t> ());
+      }
+
+    private:
+      std::lock_guard<std::mutex> lock;
+      int status;
+    };
+
+    // Copies the latest tool state. Returns NOT_INITD if the device
+    // is not initialized
+    int readState (State * state) {
+      Header * header = segment.load ();
+      if (header == nullptr) {
+	std::lock_guard<std::mutex> lock (client_mutex);
+	if (mapping.header == nullptr && connectTo (nullptr) != SUCCESS) {
+	  return SERVER_NOT_RUNNING;
+	}
+	header = mapping.header;
+      }
+      if (! __atomic_load_n (&header -> initialized, __ATOMIC_ACQUIRE)) { return NOT_INITD; }
+      for (int attempt = 0; attempt < 1000; ++attempt) {
+	uint64_t before = __atomic_load_n (&header -> state_sequence, __ATOMIC_ACQUIRE);
+	if (before & 1) { continue; }
+	std::memcpy (state, &header -> state, sizeof (State));
+	__atomic_thread_fence (__ATOMIC_ACQUIRE);
+	if (__atomic_load_n (&header -> state_sequence, __ATOMIC_RELAXED) == before) {
+	  return SUCCESS;
+	}
+      }
+      return GENERIC_FAIL;
+    }
+
+    // Copies a field of the tool state (zeros on failure)
+    template <size_t N>
+    int copyState (double (State::* field) [N], double * out) {
+      State state;
+      int res = readState (&state);
+      for (size_t i = 0; i < N; ++i) { out [i] = res == SUCCESS ? (state.*field) [i] : 0.0; }
+      return retErr ((ErrorMsg) res);
+    }
+  }
+
+  extern "C" {
+    int connect_server (const char * name) {
+      std::lock_guard<std::mutex> lock (client_mutex);
+      return retErr ((ErrorMsg) connectTo (name));
+    }
+
+    int disconnect_server (void) {
+      std::lock_guard<std::mutex> lock (client_mutex);
+      if (mapping.header == nullptr) { return retErr (SERVER_NOT_RUNNING); }
+      uint64_t self = (uint64_t) getpid ();
+      __atomic_compare_exchange_n (&mapping.header -> client_pid, &self, (uint64_t) 0,
+				   false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED);
+      dropServer ();
+      for (auto & m : lost) { munmap (m.header, m.size); }
+      lost.clear ();
+      return retErr (SUCCESS);
+    }
+
+    int last_async_error (void) {
+      Header * header = segment.load ();
+      if (header != nullptr) {
+	int pending = __atomic_exchange_n (&header -> async_error, (int32_t) SUCCESS,
+					   __ATOMIC_ACQ_REL);
+	if (pending != SUCCESS) { asyncError.store (pending); }
+      }
+      return asyncError.exchange (SUCCESS);
+    }
+
+    // Device and loop
+
+    int count_devices (void) {
+      Call c (CMD_COUNT_DEVICES);
+      return c.result (0);
+    }
+
+    int get_device_name (const int device, int buffer_size, char * name) {
+      Call c (CMD_GET_DEVICE_NAME);
+      c.args ().put<int32_t> (device);
+      Reader in (nullptr, 0);
+      if (! c.call (&in)) { return SERVER_NOT_RUNNING; }
+      int res = in.get<int32_t> ();
+      const char * text = in.getString ();
+      if (res == SUCCESS) {
+	size_t length = text == nullptr ? 0 : std::strlen (text);
+	if ((int) length + 1 > buffer_size) { return retErr (BUFFER_TOO_SMALL); }
+	std::memcpy (name, text, length);
+	name [length] = '\0';
+      }
+      return retErr ((ErrorMsg) res);
+    }
+
+    int get_device_specs (const int device, DeviceSpecs * specs) {
+      if (specs == nullptr) { return retErr (INVALID_PARAMS); }
+      Call c (CMD_GET_DEVICE_SPECS);
+      c.args ().put<int32_t> (device);
+      Reader in (nullptr, 0);
+      if (! c.call (&in)) { return SERVER_NOT_RUNNING; }
+      int res = in.get<int32_t> ();
+      size_t n;
+      const DeviceSpecs * received = in.getArray<DeviceSpecs> (&n);
+      if (res == SUCCESS && n == 1) { *specs = *received; }
+      return retErr ((ErrorMsg) res);
+    }
+
+    int rescan_devices (void) { return Call (CMD_RESCAN_DEVICES).result (-1); }
+
+    int get_device_list_version (void) {
+      return Call (CMD_GET_DEVICE_LIST_VERSION).result (0);
+    }
+
+    int start_device_scanner (const int period_ms) {
+      Call c (CMD_START_DEVICE_SCANNER);
+      c.args ().put<int32_t> (period_ms);
+      return c.error ();
+    }
+
+    int stop_device_scanner (void) {
+      return Call (CMD_STOP_DEVICE_SCANNER).error ();
+    }
+
+    int initialize (const int deviceId, const double hapticScale, const double radius) {
+      Call c (CMD_INITIALIZE);
+      c.args ().put<int32_t> (deviceId);
+      c.args ().put<double> (hapticScale);
+      c.args ().put<double> (radius);
+      return c.error ();
+    }
+
+    int deinitialize (void) { return Call (CMD_DEINITIALIZE).error (); }
+    int start (void) { return Call (CMD_START).error (); }
+    int stop (void) { return Call (CMD_STOP).error (); }
+
+    double get_loop_frequency (void) {
+      Header * header = segment.load ();
+      if (header == nullptr || ! __atomic_load_n (&header -> running, __ATOMIC_ACQUIRE)) {
+	return -1.0;
+      }
+      double frequency;
+      __atomic_load (&header -> loop_frequency, &frequency, __ATOMIC_RELAXED);
+      return frequency;
+    }
+
+    int get_loops (void) {
+      Header * header = segment.load ();
+      State state;
+      if (header == nullptr || ! __atomic_load_n (&header -> running, __ATOMIC_ACQUIRE) ||
+	  readState (&state) != SUCCESS) {
+	return -1;
+      }
+      return (int) state.tick;
+    }
+
+    long get_log_frame (void) {
+      Call c (CMD_GET_LOG_FRAME);
+      Reader in (nullptr, 0);
+      if (! c.call (&in)) { return -1; }
+      return (long) in.get<int64_t> ();
+    }
+
+    int is_initialized (void) {
+      Header * header = segment.load ();
+      if (header == nullptr) { return retErr (SERVER_NOT_RUNNING); }
+      return retErr (__atomic_load_n (&header -> initialized, __ATOMIC_ACQUIRE) ?
+		     SUCCESS : NOT_INITD);
+    }
+
+    int is_running (void) {
+      Header * header = segment.load ();
+      if (header == nullptr) { return retErr (SERVER_NOT_RUNNING); }
+      return retErr (__atomic_load_n (&header -> running, __ATOMIC_ACQUIRE) ?
+		     SUCCESS : NOT_RUNNING);
+    }
+
+    // Hooks run in the haptic thread of the server
+    void set_hook (const int, void (*) (const double [3], const double [3], double [3])) {
+      retErr (NOT_IMPLEMENTED);
+    }
+    int remove_hook (void) { return retErr (NOT_IMPLEMENTED); }
+    int add_chain_hook (ChainHookPtr, void *, const double) {
+      retErr (NOT_IMPLEMENTED);
+      return -1;
+    }
+    int remove_chain_hook (const int) { return retErr (NOT_IMPLEMENTED); }
+    int get_chain_hook_stats (const int, unsigned long long *, unsigned long long *,
+			      unsigned long long *, double *) {
+      return retErr (NOT_IMPLEMENTED);
+    }
+
+    // Logging and telemetry, written by the server
+
+    int init_logging (const int device_coordinates, const int position,
+		      const int velocity, const int force,
+		      const int interaction_forces,
+		      const int object_number, const int * objects) {
+      Call c (CMD_INIT_LOGGING);
+      c.args ().put<int32_t> (device_coordinates);
+      c.args ().put<int32_t> (position);
+      c.args ().put<int32_t> (velocity);
+      c.args ().put<int32_t> (force);
+      c.args ().put<int32_t> (interaction_forces);
+      c.args ().putArray<int32_t> (objects, object_number > 0 ? object_number : 0);
+      return c.error ();
+    }
+
+    int start_logging (const int sampling_rate) {
+      Call c (CMD_START_LOGGING);
+      c.args ().put<int32_t> (sampling_rate);
+      return c.error ();
+    }
+
+    int stop_logging_and_save (const char * filename) {
+      Call c (CMD_STOP_LOGGING_AND_SAVE);
+      c.args ().putString (filename);
+      return c.error ();
+    }
+
+    int stop_logging_and_get (SavedData *) { return retErr (NOT_IMPLEMENTED); }
+
+    int is_logging (void) { return Call (CMD_IS_LOGGING).result (0); }
+
+    void tick (void) { Call (CMD_TICK).post (); }
+
+    void log_annotate (char * text) {
+      Call c (CMD_LOG_ANNOTATE);
+      c.args ().putString (text);
+      c.post ();
+    }
+
+    int enable_telemetry (const char * name, const int capacity) {
+      Call c (CMD_ENABLE_TELEMETRY);
+      c.args ().putString (name);
+      c.args ().put<int32_t> (capacity);
+      return c.error ();
+    }
+
+    int disable_telemetry (void) { return Call (CMD_DISABLE_TELEMETRY).error (); }
+
+    // Force field and guidance
+
+    int force_field_add_term (const int type, const double vector [3], const double gain) {
+      Call c (CMD_FORCE_FIELD_ADD_TERM);
+      c.args ().put<int32_t> (type);
+      c.args ().putArray (vector, 3);
+      c.args ().put<double> (gain);
+      return c.result (-1);
+    }
+
+    int force_field_set_term (const int term, const double vector [3], const double gain) {
+      Call c (CMD_FORCE_FIELD_SET_TERM);
+      c.args ().put<int32_t> (term);
+      c.args ().putArray (vector, 3);
+      c.args ().put<double> (gain);
+      return c.post ();
+    }
+
+    int force_field_set_time_function (const int term, const double offset,
+				       const double amplitude, const double frequency,
+				       const double phase) {
+      Call c (CMD_FORCE_FIELD_SET_TIME_FUNCTION);
+      c.args ().put<int32_t> (term);
+      c.args ().put<double> (offset);
+      c.args ().put<double> (amplitude);
+      c.args ().put<double> (frequency);
+      c.args ().put<double> (phase);
+      return c.post ();
+    }
+
+    int force_field_set_region (const int term, const int shape, const double center [3],
+				const double size [3], const int inside) {
+      Call c (CMD_FORCE_FIELD_SET_REGION);
+      c.args ().put<int32_t> (term);
+      c.args ().put<int32_t> (shape);
+      c.args ().putArray (center, 3);
+      c.args ().putArray (size, 3);
+      c.args ().put<int32_t> (inside);
+      return c.post ();
+    }
+
+    int force_field_set_button_condition (const int term, const int mask, const int pressed) {
+      Call c (CMD_FORCE_FIELD_SET_BUTTON_CONDITION);
+      c.args ().put<int32_t> (term);
+      c.args ().put<int32_t> (mask);
+      c.args ().put<int32_t> (pressed);
+      return c.post ();
+    }
+
+    int force_field_clear (void) { return Call (CMD_FORCE_FIELD_CLEAR).post (); }
+
+    void force_field_use_proxy (const int proxy) {
+      Call c (CMD_FORCE_FIELD_USE_PROXY);
+      c.args ().put<int32_t> (proxy);
+      c.post ();
+    }
+
+    int create_guidance_constraint (const int type) {
+      Call c (CMD_CREATE_GUIDANCE_CONSTRAINT);
+      c.args ().put<int32_t> (type);
+      return c.result (-1);
+    }
+
+    int remove_guidance_constraint (const int constraintId) {
+      Call c (CMD_REMOVE_GUIDANCE_CONSTRAINT);
+      c.args ().put<int32_t> (constraintId);
+      return c.post ();
+    }
+
+    int set_guidance_constraint_gains (const int constraintId, const double stiffness,
+				       const double damping, const double saturation) {
+      Call c (CMD_SET_GUIDANCE_CONSTRAINT_GAINS);
+      c.args ().put<int32_t> (constraintId);
+      c.args ().put<double> (stiffness);
+      c.args ().put<double> (damping);
+      c.args ().put<double> (saturation);
+      return c.post ();
+    }
+
+    int set_guidance_constraint_geometry (const int constraintId, const double origin [3],
+					  const double direction [3], const double angle) {
+      Call c (CMD_SET_GUIDANCE_CONSTRAINT_GEOMETRY);
+      c.args ().put<int32_t> (constraintId);
+      c.args ().putArray (origin, 3);
+      c.args ().putArray (direction, 3);
+      c.args ().put<double> (angle);
+      return c.post ();
+    }
+
+    int set_guidance_constraint_path (const int constraintId, const double points [],
+				      const int num_points) {
+      Call c (CMD_SET_GUIDANCE_CONSTRAINT_PATH);
+      c.args ().put<int32_t> (constraintId);
+      c.args ().putArray (points, num_points > 0 ? 3 * (size_t) num_points : 0);
+      return c.post ();
+    }
+
+    // Simulation settings
+
+    int enable_dynamic_objects (void) { return Call (CMD_ENABLE_DYNAMIC_OBJECTS).post (); }
+    int disable_dynamic_objects (void) { return Call (CMD_DISABLE_DYNAMIC_OBJECTS).post (); }
+    void enable_wait_for_small_forces (void) { Call (CMD_ENABLE_WAIT_FOR_SMALL_FORCES).post (); }
+    void disable_wait_for_small_forces (void) { Call (CMD_DISABLE_WAIT_FOR_SMALL_FORCES).post (); }
+    void enable_rise_forces (void) { Call (CMD_ENABLE_RISE_FORCES).post (); }
+    void disable_rise_forces (void) { Call (CMD_DISABLE_RISE_FORCES).post (); }
+
+    // World properties
+
+    void set_world_rotation_eulerXYZ (const double x, const double y, const double z) {
+      Call c (CMD_SET_WORLD_ROTATION_EULER_XYZ);
+      c.args ().put<double> (x);
+      c.args ().put<double> (y);
+      c.args ().put<double> (z);
+      c.post ();
+    }
+
+    void set_world_rotation_quaternion (const double w, const double x,
+					const double y, const double z) {
+      Call c (CMD_SET_WORLD_ROTATION_QUATERNION);
+      c.args ().put<double> (w);
+      c.args ().put<double> (x);
+      c.args ().put<double> (y);
+      c.args ().put<double> (z);
+      c.post ();
+    }
+
+    int set_world_mirror (const int x, const int y, const int z) {
+      Call c (CMD_SET_WORLD_MIRROR);
+      c.args ().put<int32_t> (x);
+      c.args ().put<int32_t> (y);
+      c.args ().put<int32_t> (z);
+      return c.post ();
+    }
+
+    void set_world_translation (const double x, const double y, const double z) {
+      Call c (CMD_SET_WORLD_TRANSLATION);
+      c.args ().put<double> (x);
+      c.args ().put<double> (y);
+      c.args ().put<double> (z);
+      c.post ();
+    }
+
+    void set_world_scale (const double x, const double y, const double z) {
+      Call c (CMD_SET_WORLD_SCALE);
+      c.args ().put<double> (x);
+      c.args ().put<double> (y);
+      c.args ().put<double> (z);
+      c.post ();
+    }
+  }
+
+  namespace {
+    // Copies the array replied to `command` (zeros on failure)
+    void getWorld (const Command command, const size_t n, double * out) {
+      Call c (command);
+      Reader in (nullptr, 0);
+      size_t count = 0;
+      const double * values = c.call (&in) ? in.getArray<double> (&count) : nullptr;
+      for (size_t i = 0; i < n; ++i) { out [i] = i < count ? values [i] : 0.0; }
+    }
+
+    // The same for the object getters, that reply an error first
+    int getObject (const Command command, const int objectId, const size_t n, double * out) {
+      Call c (command);
+      c.args ().put<int32_t> (objectId);
+      Reader in (nullptr, 0);
+      int res = SERVER_NOT_RUNNING;
+      size_t count = 0;
+      const double * values = nullptr;
+      if (c.call (&in)) {
+	res = in.get<int32_t> ();
+	values = in.getArray<double> (&count);
+      }
+      for (size_t i = 0; i < n; ++i) { out [i] = i < count ? values [i] : 0.0; }
+      return res == SERVER_NOT_RUNNING ? res : retErr ((ErrorMsg) res);
+    }
+  }
+
+  extern "C" {
+    void get_world_rotation (double * out) { getWorld (CMD_GET_WORLD_ROTATION, 4, out); }
+    void get_world_mirror (double * out) { getWorld (CMD_GET_WORLD_MIRROR, 3, out); }
+    void get_world_order (double * out) { getWorld (CMD_GET_WORLD_ORDER, 3, out); }
+    void get_world_translation (double * out) { getWorld (CMD_GET_WORLD_TRANSLATION, 3, out); }
+    void get_world_scale (double * out) { getWorld (CMD_GET_WORLD_SCALE, 3, out); }
+
+    // Tool state, from the state block
+
+    int get_tool_force (double outputForce [3]) {
+      return copyState (&State::force, outputForce);
+    }
+    int get_tool_proxy_position (double outputPosition [3]) {
+      return copyState (&State::proxy_position, outputPosition);
+    }
+    int get_tool_position (double outputPosition [3]) {
+      return copyState (&State::position, outputPosition);
+    }
+    int get_tool_velocity (double outputVelocity [3]) {
+      return copyState (&State::velocity, outputVelocity);
+    }
+    int get_tool_rotation (double outputRotation [4]) {
+      return copyState (&State::rotation, outputRotation);
+    }
+
+    int is_tool_button_pressed (const int buttonId) {
+      State state;
+      if (readState (&state) != SUCCESS) { return -1; }
+      if (buttonId < 0 || buttonId > 31) { return 1; }
+      return (state.buttons >> buttonId) & 1u ? 0 : 1;
+    }
+
+    int set_tool_history_size (const int samples) {
+      Call c (CMD_SET_TOOL_HISTORY_SIZE);
+      c.args ().put<int32_t> (samples);
+      return c.error ();
+    }
+
+    // A reply holds a few tens of samples: ask until `max` samples or
+    // all the new ones have been copied
+    int get_tool_history (const long long since, const int max, ToolSample * out) {
+      int copied = 0;
+      long long last = since;
+      do {
+	Call c (CMD_GET_TOOL_HISTORY);
+	c.args ().put<int64_t> (last);
+	c.args ().put<int32_t> (max - copied);
+	Reader in (nullptr, 0);
+	if (! c.call (&in)) { return -1; }
+	int count = in.get<int32_t> ();
+	size_t n;
+	const ToolSample * samples = in.getArray<ToolSample> (&n);
+	if (count < 0) { return copied > 0 ? copied : -1; }
+	if (n == 0) { break; }
+	std::memcpy (out + copied, samples, n * sizeof (ToolSample));
+	copied += (int) n;
+	last = samples [n - 1].sequence;
+      } while (copied < max);
+      return copied;
+    }
+
+    // Contacts: events are paged through the reply like the history,
+    // the snapshot holds a few contacts and fits in one reply
+
+    int get_contact_events (const int max, ContactEvent * events) {
+      int copied = 0;
+      do {
+	Call c (CMD_GET_CONTACT_EVENTS);
+	c.args ().put<int32_t> (max - copied);
+	Reader in (nullptr, 0);
+	if (! c.call (&in)) { return -1; }
+	int count = in.get<int32_t> ();
+	size_t n;
+	const ContactEvent * received = in.getArray<ContactEvent> (&n);
+	if (count < 0) { return copied > 0 ? copied : -1; }
+	if (n == 0) { break; }
+	std::memcpy (events + copied, received, n * sizeof (ContactEvent));
+	copied += (int) n;
+      } while (copied < max);
+      return copied;
+    }
+
+    long long get_contact_events_dropped (void) {
+      Call c (CMD_GET_CONTACT_EVENTS_DROPPED);
+      Reader in (nullptr, 0);
+      if (! c.call (&in)) { return 0; }
+      return (long long) in.get<int64_t> ();
+    }
+
+    int set_contact_persist_interval (const int ticks) {
+      Call c (CMD_SET_CONTACT_PERSIST_INTERVAL);
+      c.args ().put<int32_t> (ticks);
+      return c.post ();
+    }
+
+    int get_contacts (const int max, ContactEvent * contacts) {
+      Call c (CMD_GET_CONTACTS);
+      c.args ().put<int32_t> (max);
+      Reader in (nullptr, 0);
+      if (! c.call (&in)) { return -1; }
+      int count = in.get<int32_t> ();
+      size_t n;
+      const ContactEvent * received = in.getArray<ContactEvent> (&n);
+      if (n > 0) { std::memcpy (contacts, received, n * sizeof (ContactEvent)); }
+      return count;
+    }
+
+    // Objects
+
+    int set_collision_cache_directory (const char * path) {
+      Call c (CMD_SET_COLLISION_CACHE_DIRECTORY);
+      c.args ().putString (path);
+      return c.post ();
+    }
+
+    int create_mesh_object (const double objectPos [3], const double objectScale [3],
+			    const double objectRotation [4],
+			    const double vertPos [] [3], const double normals [] [3],
+			    const int vertNum,
+			    const int tris [] [3], const int triNum,
+			    const int uvNum, const double uvs [] [2]) {
+      Call c (CMD_CREATE_MESH_OBJECT);
+      c.args ().putArray (objectPos, 3);
+      c.args ().putArray (objectScale, 3);
+      c.args ().putArray (objectRotation, 4);
+      c.args ().putArray (vertPos == nullptr ? nullptr : &vertPos [0] [0],
+			  vertNum > 0 ? 3 * (size_t) vertNum : 0);
+      c.args ().putArray (normals == nullptr ? nullptr : &normals [0] [0],
+			  vertNum > 0 ? 3 * (size_t) vertNum : 0);
+      c.args ().putArray<int32_t> (tris == nullptr ? nullptr : &tris [0] [0],
+				   triNum > 0 ? 3 * (size_t) triNum : 0);
+      c.args ().putArray (uvs == nullptr ? nullptr : &uvs [0] [0],
+			  uvNum > 0 ? 2 * (size_t) uvNum : 0);
+      return c.result (-1);
+    }
+
+    int create_sdf_object (const double objectPos [3], const double objectScale [3],
+			   const double objectRotation [4],
+			   const double vertPos [] [3], const int vertNum,
+			   const int tris [] [3], const int triNum,
+			   const int resolution) {
+      Call c (CMD_CREATE_SDF_OBJECT);
+      c.args ().putArray (objectPos, 3);
+      c.args ().putArray (objectScale, 3);
+      c.args ().putArray (objectRotation, 4);
+      c.args ().putArray (vertPos == nullptr ? nullptr : &vertPos [0] [0],
+			  vertNum > 0 ? 3 * (size_t) vertNum : 0);
+      c.args ().putArray<int32_t> (tris == nullptr ? nullptr : &tris [0] [0],
+				   triNum > 0 ? 3 * (size_t) triNum : 0);
+      c.args ().put<int32_t> (resolution);
+      return c.result (-1);
+    }
+
+    int create_convex_object (const double objectPos [3], const double objectScale [3],
+			      const double objectRotation [4],
+			      const double vertPos [] [3], const int vertNum) {
+      Call c (CMD_CREATE_CONVEX_OBJECT);
+      c.args ().putArray (objectPos, 3);
+      c.args ().putArray (objectScale, 3);
+      c.args ().putArray (objectRotation, 4);
+      c.args ().putArray (vertPos == nullptr ? nullptr : &vertPos [0] [0],
+			  vertNum > 0 ? 3 * (size_t) vertNum : 0);
+      return c.result (-1);
+    }
+
+    int set_mesh_convexity_detection (const int enable) {
+      Call c (CMD_SET_MESH_CONVEXITY_DETECTION);
+      c.args ().put<int32_t> (enable);
+      return c.post ();
+    }
+
+    int create_sphere_object (const double radius, const double position [3],
+			      const double rotation [4]) {
+      Call c (CMD_CREATE_SPHERE_OBJECT);
+      c.args ().put<double> (radius);
+      c.args ().putArray (position, 3);
+      c.args ().putArray (rotation, 4);
+      return c.result (-1);
+    }
+
+    int create_box_object (const double scale [3], const double position [3],
+			   const double rotation [4]) {
+      Call c (CMD_CREATE_BOX_OBJECT);
+      c.args ().putArray (scale, 3);
+      c.args ().putArray (position, 3);
+      c.args ().putArray (rotation, 4);
+      return c.result (-1);
+    }
+
+    int add_object_to_world (const int objectId) {
+      Call c (CMD_ADD_OBJECT_TO_WORLD);
+      c.args ().put<int32_t> (objectId);
+      return c.post ();
+    }
+
+    int disable_object (const int objectId) {
+      Call c (CMD_DISABLE_OBJECT);
+      c.args ().put<int32_t> (objectId);
+      return c.post ();
+    }
+
+    int enable_object (const int objectId) {
+      Call c (CMD_ENABLE_OBJECT);
+      c.args ().put<int32_t> (objectId);
+      return c.post ();
+    }
+
+    int object_exists (const int objectId) {
+      Call c (CMD_OBJECT_EXISTS);
+      c.args ().put<int32_t> (objectId);
+      return c.result (0);
+    }
+
+    int set_object_tag (const int objectId, const char * tag) {
+      Call c (CMD_SET_OBJECT_TAG);
+      c.args ().put<int32_t> (objectId);
+      c.args ().putString (tag);
+      return c.post ();
+    }
+
+    int set_texture_mipmap_levels (const int levels) {
+      Call c (CMD_SET_TEXTURE_MIPMAP_LEVELS);
+      c.args ().put<int32_t> (levels);
+      return c.post ();
+    }
+
+    int set_object_texture (const int objectId, const unsigned int size_x,
+			    const unsigned int size_y, const float pixels [],
+			    const int spherical) {
+      Call c (CMD_SET_OBJECT_TEXTURE);
+      c.args ().put<int32_t> (objectId);
+      c.args ().put<uint32_t> (size_x);
+      c.args ().put<uint32_t> (size_y);
+      c.args ().put<int32_t> (spherical);
+      c.args ().putArray (pixels, (size_t) size_x * size_y);
+      return c.post ();
+    }
+
+    int set_object_material (const int objectId, const double stiffness,
+			     const int surface, const double staticfriction,
+			     const double dynamicfriction,
+			     const double magnetic_max_force,
+			     const double magnetic_max_distance,
+			     const double viscosity, const double level,
+			     const double stickslip_stiffness,
+			     const double stickslip_maxforce,
+			     const double vibration_freq,
+			     const double vibration_amplitude) {
+      Call c (CMD_SET_OBJECT_MATERIAL);
+      c.args ().put<int32_t> (objectId);
+      c.args ().put<double> (stiffness);
+      c.args ().put<int32_t> (surface);
+      for (double v : {staticfriction, dynamicfriction, magnetic_max_force,
+		       magnetic_max_distance, viscosity, level, stickslip_stiffness,
+		       stickslip_maxforce, vibration_freq, vibration_amplitude}) {
+	c.args ().put<double> (v);
+      }
+      return c.post ();
+    }
+
+    int enable_position_interpolation (const int objectId) {
+      Call c (CMD_ENABLE_POSITION_INTERPOLATION);
+      c.args ().put<int32_t> (objectId);
+      return c.post ();
+    }
+
+    int disable_position_interpolation (const int objectId) {
+      Call c (CMD_DISABLE_POSITION_INTERPOLATION);
+      c.args ().put<int32_t> (objectId);
+      return c.post ();
+    }
+
+    int enable_rotation_interpolation (const int objectId) {
+      Call c (CMD_ENABLE_ROTATION_INTERPOLATION);
+      c.args ().put<int32_t> (objectId);
+      return c.post ();
+    }
+
+    int disable_rotation_interpolation (const int objectId) {
+      Call c (CMD_DISABLE_ROTATION_INTERPOLATION);
+      c.args ().put<int32_t> (objectId);
+      return c.post ();
+    }
+
+    int set_interpolation_period (const int objectId, const int cycles,
+				  const double overshot) {
+      Call c (CMD_SET_INTERPOLATION_PERIOD);
+      c.args ().put<int32_t> (objectId);
+      c.args ().put<int32_t> (cycles);
+      c.args ().put<double> (overshot);
+      return c.post ();
+    }
+
+    int set_object_position (const int objectId, const double objectPosition [3]) {
+      Call c (CMD_SET_OBJECT_POSITION);
+      c.args ().put<int32_t> (objectId);
+      c.args ().putArray (objectPosition, 3);
+      return c.post ();
+    }
+
+    int get_object_position (const int objectId, double objectPosition [3]) {
+      return getObject (CMD_GET_OBJECT_POSITION, objectId, 3, objectPosition);
+    }
+
+    int set_object_rotation (const int objectId, const double objectRotation [4]) {
+      Call c (CMD_SET_OBJECT_ROTATION);
+      c.args ().put<int32_t> (objectId);
+      c.args ().putArray (objectRotation, 4);
+      return c.post ();
+    }
+
+    int set_object_rotation_euler (const int objectId, const double objectRotation [3]) {
+      Call c (CMD_SET_OBJECT_ROTATION_EULER);
+      c.args ().put<int32_t> (objectId);
+      c.args ().putArray (objectRotation, 3);
+      return c.post ();
+    }
+
+    int get_object_rotation (const int objectId, double objectRotation [4]) {
+      return getObject (CMD_GET_OBJECT_ROTATION, objectId, 4, objectRotation);
+    }
+
+    int set_object_scale (const int objectId, const double objectScale [3]) {
+      Call c (CMD_SET_OBJECT_SCALE);
+      c.args ().put<int32_t> (objectId);
+      c.args ().putArray (objectScale, 3);
+      return c.post ();
+    }
+  }
+}
@@ -0,0 +1,66 @@
+// This file is part of HPGE, an Haptic Plugin for Game Engines
+// -----------------------------------------
+
+// Software License Agreement (BSD License)
+// Copyright (c) 2017-2023,
+// Copyright © 2017-2019 Gabriel Baud-Bovy (gbaudbovy <at> gmail.com)
+// Copyright © 2017-2023 Nicolò Balzarotti (nicolo.balzarotti <at> iit.it)
+// Istituto Italiano di Tecnologia (IIT), All rights reserved.
+//
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+
+// 3. Neither the name of HPGE, Istituto Italiano di Tecnologia nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Functions of the client shim (libHPGE-client) that are not part of
+// the HPGE API. Everything else is declared in HPGE.h.
+
+#pragma once
+
+#if (defined(linux) || defined(__linux) || defined(__linux__))
+#define FUNCDLL_API
+#else
+#define FUNCDLL_API __declspec(dllexport)
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  // Connects to the server `name` (nullptr: the HPGE_SERVER
+  // environment variable, or "hpge"). The other functions connect on
+  // their first call, so this is only needed to choose the server or
+  // to check that it is running
+  FUNCDLL_API int connect_server (const char * name);
+  // Must not be called while other threads use the API
+  FUNCDLL_API int disconnect_server (void);
+  // Error of the last enqueued command that failed in the server
+  // since the previous call (0: none)
+  FUNCDLL_API int last_async_error (void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,641 @@
+// This file is part of HPGE, an Haptic Plugin for Game Engines
+// -----------------------------------------
+
+// Software License Agreement (BSD License)
+// Copyright (c) 2017-2023,
+// Copyright © 2017-2019 Gabriel Baud-Bovy (gbaudbovy <at> gmail.com)
+// Copyright © 2017-2023 Nicolò Balzarotti (nicolo.balzarotti <at> iit.it)
+// Istituto Italiano di Tecnologia (IIT), All rights reserved.
+//
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+
+// 3. Neither the name of HPGE, Istituto Italiano di Tecnologia nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// HPGE server: owns the haptic device and the world in its own
+// process, so that pauses and crashes of the game do not disrupt the
+// haptic loop. The game loads the client shim (client.cc) instead of
+// HPGE, with the same API; see protocol.h.
+//
+// Usage: hpge-server [NAME [COMMAND_RING_MB]]
+// NAME defaults to "hpge" (the client reads it from the HPGE_SERVER
+// environment variable, with the same default).
+//
+// If the client process dies, the device is deinitialized (so that it
+// stops applying forces) and the server waits for a new client. A
+// client of another process starts from a deinitialized device and an
+// empty world: the commands still queued by the previous client are
+// dropped, even if it died before the server noticed it.
+
+#include "protocol.h"
+#include "HPGE.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace HPGE;
+using namespace HPGE::server;
+
+namespace {
+  volatile std::sig_atomic_t quit = 0;
+  void onSignal (int) { quit = 1; }
+
+  // Chain hook of the server: publishes the tool state after each
+  // tick. It adds no force
+  void publishState (void * context, const HookState * state, double [3]) {
+    Header * header = static_cast<Header *> (context);
+    State s;
+    for (int i = 0; i < 3; ++i) {
+      s.position [i] = state -> position [i];
+      s.proxy_position [i] = state -> proxy_position [i];
+      s.velocity [i] = state -> velocity [i];
+      s.force [i] = state -> force [i];
+    }
+    for (int i = 0; i < 4; ++i) { s.rotation [i] = state -> rotation [i]; }
+    s.buttons = state -> buttons;
+    s.contacts = state -> contacts;
+    s.tick = state -> tick;
+
+    uint64_t sequence = header -> state_sequence;
+    __atomic_store_n (&header -> state_sequence, sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence (__ATOMIC_RELEASE);
+    std::memcpy (&header -> state, &s, sizeof (s));
+    __atomic_store_n (&header -> state_sequence, sequence + 2, __ATOMIC_RELEASE);
+  }
+
+  void updateLoopState (Header * header) {
+    __atomic_store_n (&header -> initialized, is_initialized () == SUCCESS ? 1 : 0,
+		      __ATOMIC_RELEASE);
+    __atomic_store_n (&header -> running, is_running () == SUCCESS ? 1 : 0,
+		      __ATOMIC_RELEASE);
+    double frequency = get_loop_frequency ();
+    __atomic_store (&header -> loop_frequency, &frequency, __ATOMIC_RELAXED);
+  }
+
+  template <typename T>
+  const T * array (Reader & in, const size_t n) {
+    size_t count;
+    const T * values = in.getArray<T> (&count);
+    if (count != n) { in.ok = false; }
+    return values;
+  }
+  const double * vec3 (Reader & in) { return array<double> (in, 3); }
+  const double * vec4 (Reader & in) { return array<double> (in, 4); }
+
+  // Runs the command, and writes the results of replied commands to
+  // `out`. Returns the error code of enqueued commands
+  int execute (Header * header, const Record * record, Writer & out) {
+    Reader in (reinterpret_cast<const char *> (record + 1),
+	       record -> size - sizeof (Record));
+    double values [4] {0.0, 0.0, 0.0, 0.0};
+    int result = SUCCESS;
+
+    switch (record -> command) {
+    case CMD_COUNT_DEVICES:
+      out.put<int32_t> (count_devices ());
+      break;
+    case CMD_GET_DEVICE_NAME: {
+      int device = in.get<int32_t> ();
+      char name [256] {0};
+      out.put<int32_t> (get_device_name (device, sizeof (name), name));
+      out.putString (name);
+      break;
+    }
+    case CMD_GET_DEVICE_SPECS: {
+      DeviceSpecs specs {};
+      out.put<int32_t> (get_device_specs (in.get<int32_t> (), &specs));
+      out.putArray (&specs, 1);
+      break;
+    }
+    case CMD_RESCAN_DEVICES: out.put<int32_t> (rescan_devices ()); break;
+    case CMD_GET_DEVICE_LIST_VERSION:
+      out.put<int32_t> (get_device_list_version ());
+      break;
+    case CMD_START_DEVICE_SCANNER:
+      out.put<int32_t> (start_device_scanner (in.get<int32_t> ()));
+      break;
+    case CMD_STOP_DEVICE_SCANNER: out.put<int32_t> (stop_device_scanner ()); break;
+    case CMD_INITIALIZE: {
+      int device = in.get<int32_t> ();
+      double scale = in.get<double> ();
+      double radius = in.get<double> ();
+      result = initialize (device, scale, radius);
+      // chain hooks are removed by deinitialize
+      if (result == SUCCESS) { add_chain_hook (&publishState, header, 0.0); }
+      out.put<int32_t> (result);
+      break;
+    }
+    case CMD_DEINITIALIZE: out.put<int32_t> (deinitialize ()); break;
+    case CMD_START: out.put<int32_t> (start ()); break;
+    case CMD_STOP: out.put<int32_t> (stop ()); break;
+    case CMD_GET_LOG_FRAME: out.put<int64_t> (get_log_frame ()); break;
+    case CMD_INIT_LOGGING: {
+      int flags [5];
+      for (int i = 0; i < 5; ++i) { flags [i] = in.get<int32_t> (); }
+      size_t n;
+      const int32_t * objects = in.getArray<int32_t> (&n);
+      out.put<int32_t> (init_logging (flags [0], flags [1], flags [2], flags [3],
+				      flags [4], (int) n, objects));
+      break;
+    }
+    case CMD_START_LOGGING:
+      out.put<int32_t> (start_logging (in.get<int32_t> ()));
+      break;
+    case CMD_STOP_LOGGING_AND_SAVE:
+      out.put<int32_t> (stop_logging_and_save (in.getString ()));
+      break;
+    case CMD_IS_LOGGING: out.put<int32_t> (is_logging ()); break;
+    case CMD_ENABLE_TELEMETRY: {
+      const char * name = in.getString ();
+      int capacity = in.get<int32_t> ();
+      out.put<int32_t> (enable_telemetry (name, capacity));
+      break;
+    }
+    case CMD_DISABLE_TELEMETRY: out.put<int32_t> (disable_telemetry ()); break;
+    case CMD_FORCE_FIELD_ADD_TERM: {
+      int type = in.get<int32_t> ();
+      const double * vector = vec3 (in);
+      double gain = in.get<double> ();
+      out.put<int32_t> (in.ok ? force_field_add_term (type, vector, gain) : -1);
+      break;
+    }
+    case CMD_CREATE_GUIDANCE_CONSTRAINT:
+      out.put<int32_t> (create_guidance_constraint (in.get<int32_t> ()));
+      break;
+    case CMD_GET_WORLD_ROTATION:
+      get_world_rotation (values);
+      out.putArray (values, 4);
+      break;
+    case CMD_GET_WORLD_MIRROR:
+      get_world_mirror (values);
+      out.putArray (values, 3);
+      break;
+    case CMD_GET_WORLD_ORDER:
+      get_world_order (values);
+      out.putArray (values, 3);
+      break;
+    case CMD_GET_WORLD_TRANSLATION:
+      get_world_translation (values);
+      out.putArray (values, 3);
+      break;
+    case CMD_GET_WORLD_SCALE:
+      get_world_scale (values);
+      out.putArray (values, 3);
+      break;
+    case CMD_CREATE_MESH_OBJECT: {
+      const double * position = vec3 (in);
+      const double * scale = vec3 (in);
+      const double * rotation = vec4 (in);
+      size_t vertices, normals, triangles, uvs;
+      const double * vertexData = in.getArray<double> (&vertices);
+      const double * normalData = in.getArray<double> (&normals);
+      const int32_t * triangleData = in.getArray<int32_t> (&triangles);
+      const double * uvData = in.getArray<double> (&uvs);
+      if (! in.ok || normals != vertices || vertices % 3 != 0 ||
+	  triangles % 3 != 0 || uvs % 2 != 0) {
+	out.put<int32_t> (-1);
+	break;
+      }
+      out.put<int32_t> (create_mesh_object
+			(position, scale, rotation,
+			 reinterpret_cast<const double (*) [3]> (vertexData),
+			 reinterpret_cast<const double (*) [3]> (normalData),
+			 (int) vertices / 3,
+			 reinterpret_cast<const int (*) [3]> (triangleData),
+			 (int) triangles / 3,
+			 (int) uvs / 2,
+			 reinterpret_cast<const double (*) [2]> (uvData)));
+      break;
+    }
+    case CMD_CREATE_SDF_OBJECT: {
+      const double * position = vec3 (in);
+      const double * scale = vec3 (in);
+      const double * rotation = vec4 (in);
+      size_t vertices, triangles;
+      const double * vertexData = in.getArray<double> (&vertices);
+      const int32_t * triangleData = in.getArray<int32_t> (&triangles);
+      int32_t resolution = in.get<int32_t> ();
+      if (! in.ok || vertices % 3 != 0 || triangles % 3 != 0) {
+	out.put<int32_t> (-1);
+	break;
+      }
+      out.put<int32_t> (create_sdf_object
+			(position, scale, rotation,
+			 reinterpret_cast<const double (*) [3]> (vertexData),
+			 (int) vertices / 3,
+			 reinterpret_cast<const int (*) [3]> (triangleData),
+			 (int) triangles / 3,
+			 resolution));
+      break;
+    }
+    case CMD_CREATE_CONVEX_OBJECT: {
+      const double * position = vec3 (in);
+      const double * scale = vec3 (in);
+      const double * rotation = vec4 (in);
+      size_t vertices;
+      const double * vertexData = in.getArray<double> (&vertices);
+      if (! in.ok || vertices % 3 != 0) {
+	out.put<int32_t> (-1);
+	break;
+      }
+      out.put<int32_t> (create_convex_object
+			(position, scale, rotation,
+			 reinterpret_cast<const double (*) [3]> (vertexData),
+			 (int) vertices / 3));
+      break;
+    }
+    case CMD_CREATE_SPHERE_OBJECT: {
+      double radius = in.get<double> ();
+      const double * position = vec3 (in);
+      const double * rotation = vec4 (in);
+      out.put<int32_t> (in.ok ? create_sphere_object (radius, position, rotation) : -1);
+      break;
+    }
+    case CMD_CREATE_BOX_OBJECT: {
+      const double * scale = vec3 (in);
+      const double * position = vec3 (in);
+      const double * rotation = vec4 (in);
+      out.put<int32_t> (in.ok ? create_box_object (scale, position, rotation) : -1);
+      break;
+    }
+    case CMD_OBJECT_EXISTS:
+      out.put<int32_t> (object_exists (in.get<int32_t> ()));
+      break;
+    case CMD_GET_OBJECT_POSITION:
+      out.put<int32_t> (get_object_position (in.get<int32_t> (), values));
+      out.putArray (values, 3);
+      break;
+    case CMD_GET_OBJECT_ROTATION:
+      out.put<int32_t> (get_object_rotation (in.get<int32_t> (), values));
+      out.putArray (values, 4);
+      break;
+    case CMD_SET_TOOL_HISTORY_SIZE:
+      out.put<int32_t> (set_tool_history_size (in.get<int32_t> ()));
+      break;
+    case CMD_GET_TOOL_HISTORY: {
+      // as many samples as the reply can hold
+      const int fits = (HPGE_SERVER_REPLY_CAPACITY - 64) / sizeof (ToolSample);
+      ToolSample samples [fits];
+      long long since = in.get<int64_t> ();
+      int count = get_tool_history (since, std::min (in.get<int32_t> (), fits), samples);
+      out.put<int32_t> (count);
+      out.putArray (samples, count > 0 ? count : 0);
+      break;
+    }
+    case CMD_GET_CONTACT_EVENTS:
+    case CMD_GET_CONTACTS: {
+      const int fits = (HPGE_SERVER_REPLY_CAPACITY - 64) / sizeof (ContactEvent);
+      ContactEvent events [fits];
+      int max = std::min (in.get<int32_t> (), fits);
+      int count = record -> command == CMD_GET_CONTACTS ?
+	get_contacts (max, events) : get_contact_events (max, events);
+      out.put<int32_t> (count);
+      out.putArray (events, count > 0 ? count : 0);
+      break;
+    }
+    case CMD_GET_CONTACT_EVENTS_DROPPED:
+      out.put<int64_t> (get_contact_events_dropped ());
+      break;
+    case CMD_SYNC: out.put<int32_t> (SUCCESS); break;
+
+    case CMD_TICK: tick (); break;
+    case CMD_LOG_ANNOTATE: {
+      const char * text = in.getString ();
+      if (text != nullptr) { log_annotate (const_cast<char *> (text)); }
+      break;
+    }
+    case CMD_FORCE_FIELD_SET_TERM: {
+      int term = in.get<int32_t> ();
+      const double * vector = vec3 (in);
+      double gain = in.get<double> ();
+      if (in.ok) { result = force_field_set_term (term, vector, gain); }
+      break;
+    }
+    case CMD_FORCE_FIELD_SET_TIME_FUNCTION: {
+      int term = in.get<int32_t> ();
+      for (int i = 0; i < 4; ++i) { values [i] = in.get<double> (); }
+      result = force_field_set_time_function (term, values [0], values [1],
+					      values [2], values [3]);
+      break;
+    }
+    case CMD_FORCE_FIELD_SET_REGION: {
+      int term = in.get<int32_t> ();
+      int shape = in.get<int32_t> ();
+      const double * center = vec3 (in);
+      const double * size = vec3 (in);
+      int inside = in.get<int32_t> ();
+      if (in.ok) { result = force_field_set_region (term, shape, center, size, inside); }
+      break;
+    }
+    case CMD_FORCE_FIELD_SET_BUTTON_CONDITION: {
+      int term = in.get<int32_t> ();
+      int mask = in.get<int32_t> ();
+      int pressed = in.get<int32_t> ();
+      result = force_field_set_button_condition (term, mask, pressed);
+      break;
+    }
+    case CMD_FORCE_FIELD_CLEAR: result = force_field_clear (); break;
+    case CMD_FORCE_FIELD_USE_PROXY: force_field_use_proxy (in.get<int32_t> ()); break;
+    case CMD_REMOVE_GUIDANCE_CONSTRAINT:
+      result = remove_guidance_constraint (in.get<int32_t> ());
+      break;
+    case CMD_SET_GUIDANCE_CONSTRAINT_GAINS: {
+      int id = in.get<int32_t> ();
+      for (int i = 0; i < 3; ++i) { values [i] = in.get<double> (); }
+      result = set_guidance_constraint_gains (id, values [0], values [1], values [2]);
+      break;
+    }
+    case CMD_SET_GUIDANCE_CONSTRAINT_GEOMETRY: {
+      int id = in.get<int32_t> ();
+      const double * origin = vec3 (in);
+      const double * direction = vec3 (in);
+      double angle = in.get<double> ();
+      if (in.ok) { result = set_guidance_constraint_geometry (id, origin, direction, angle); }
+      break;
+    }
+    case CMD_SET_GUIDANCE_CONSTRAINT_PATH: {
+      int id = in.get<int32_t> ();
+      size_t n;
+      const double * points = in.getArray<double> (&n);
+      if (in.ok && n % 3 == 0) {
+	result = set_guidance_constraint_path (id, points, (int) n / 3);
+      }
+      break;
+    }
+    case CMD_ENABLE_DYNAMIC_OBJECTS: result = enable_dynamic_objects (); break;
+    case CMD_DISABLE_DYNAMIC_OBJECTS: result = disable_dynamic_objects (); break;
+    case CMD_ENABLE_WAIT_FOR_SMALL_FORCES: enable_wait_for_small_forces (); break;
+    case CMD_DISABLE_WAIT_FOR_SMALL_FORCES: disable_wait_for_small_forces (); break;
+    case CMD_ENABLE_RISE_FORCES: enable_rise_forces (); break;
+    case CMD_DISABLE_RISE_FORCES: disable_rise_forces (); break;
+    case CMD_SET_WORLD_ROTATION_EULER_XYZ:
+      for (int i = 0; i < 3; ++i) { values [i] = in.get<double> (); }
+      set_world_rotation_eulerXYZ (values [0], values [1], values [2]);
+      break;
+    case CMD_SET_WORLD_ROTATION_QUATERNION:
+      for (int i = 0; i < 4; ++i) { values [i] = in.get<double> (); }
+      set_world_rotation_quaternion (values [0], values [1], values [2], values [3]);
+      break;
+    case CMD_SET_WORLD_MIRROR: {
+      int x = in.get<int32_t> ();
+      int y = in.get<int32_t> ();
+      int z = in.get<int32_t> ();
+      result = set_world_mirror (x, y, z);
+      break;
+    }
+    case CMD_SET_WORLD_TRANSLATION:
+      for (int i = 0; i < 3; ++i) { values [i] = in.get<double> (); }
+      set_world_translation (values [0], values [1], values [2]);
+      break;
+    case CMD_SET_WORLD_SCALE:
+      for (int i = 0; i < 3; ++i) { values [i] = in.get<double> (); }
+      set_world_scale (values [0], values [1], values [2]);
+      break;
+    case CMD_SET_COLLISION_CACHE_DIRECTORY:
+      result = set_collision_cache_directory (in.getString ());
+      break;
+    case CMD_ADD_OBJECT_TO_WORLD: result = add_object_to_world (in.get<int32_t> ()); break;
+    case CMD_DISABLE_OBJECT: result = disable_object (in.get<int32_t> ()); break;
+    case CMD_ENABLE_OBJECT: result = enable_object (in.get<int32_t> ()); break;
+    case CMD_SET_OBJECT_TAG: {
+      int id = in.get<int32_t> ();
+      const char * tag = in.getString ();
+      if (tag != nullptr) { result = set_object_tag (id, tag); }
+      break;
+    }
+    case CMD_SET_TEXTURE_MIPMAP_LEVELS:
+      result = set_texture_mipmap_levels (in.get<int32_t> ());
+      break;
+    case CMD_SET_OBJECT_TEXTURE: {
+      int id = in.get<int32_t> ();
+      uint32_t x = in.get<uint32_t> ();
+      uint32_t y = in.get<uint32_t> ();
+      int spherical = in.get<int32_t> ();
+      const float * pixels = array<float> (in, (size_t) x * y);
+      if (in.ok) { result = set_object_texture (id, x, y, pixels, spherical); }
+      break;
+    }
+    case CMD_SET_OBJECT_MATERIAL: {
+      int id = in.get<int32_t> ();
+      double stiffness = in.get<double> ();
+      int surface = in.get<int32_t> ();
+      double p [10];
+      for (int i = 0; i < 10; ++i) { p [i] = in.get<double> (); }
+      result = set_object_material (id, stiffness, surface, p [0], p [1], p [2],
+				    p [3], p [4], p [5], p [6], p [7], p [8], p [9]);
+      break;
+    }
+    case CMD_ENABLE_POSITION_INTERPOLATION:
+      result = enable_position_interpolation (in.get<int32_t> ());
+      break;
+    case CMD_DISABLE_POSITION_INTERPOLATION:
+      result = disable_position_interpolation (in.get<int32_t> ());
+      break;
+    case CMD_ENABLE_ROTATION_INTERPOLATION:
+      result = enable_rotation_interpolation (in.get<int32_t> ());
+      break;
+    case CMD_DISABLE_ROTATION_INTERPOLATION:
+      result = disable_rotation_interpolation (in.get<int32_t> ());
+      break;
+    case CMD_SET_INTERPOLATION_PERIOD: {
+      int id = in.get<int32_t> ();
+      int cycles = in.get<int32_t> ();
+      double overshot = in.get<double> ();
+      result = set_interpolation_period (id, cycles, overshot);
+      break;
+    }
+    case CMD_SET_OBJECT_POSITION: {
+      int id = in.get<int32_t> ();
+      const double * position = vec3 (in);
+      if (in.ok) { result = set_object_position (id, position); }
+      break;
+    }
+    case CMD_SET_OBJECT_ROTATION: {
+      int id = in.get<int32_t> ();
+      const double * rotation = vec4 (in);
+      if (in.ok) { result = set_object_rotation (id, rotation); }
+      break;
+    }
+    case CMD_SET_OBJECT_ROTATION_EULER: {
+      int id = in.get<int32_t> ();
+      const double * rotation = vec3 (in);
+      if (in.ok) { result = set_object_rotation_euler (id, rotation); }
+      break;
+    }
+    case CMD_SET_OBJECT_SCALE: {
+      int id = in.get<int32_t> ();
+      const double * scale = vec3 (in);
+      if (in.ok) { result = set_object_scale (id, scale); }
+      break;
+    }
+    case CMD_SET_CONTACT_PERSIST_INTERVAL:
+      result = set_contact_persist_interval (in.get<int32_t> ());
+      break;
+    case CMD_SET_MESH_CONVEXITY_DETECTION:
+      result = set_mesh_convexity_detection (in.get<int32_t> ());
+      break;
+    default:
+      result = NOT_IMPLEMENTED;
+    }
+    if (! in.ok) { result = INVALID_PARAMS; }
+    return result;
+  }
+
+  bool processAlive (const uint64_t pid) {
+    return kill ((pid_t) pid, 0) == 0 || errno != ESRCH;
+  }
+
+  // Stops the device and deletes the world of the previous client
+  void resetSession (Header * header) {
+    if (is_initialized () == SUCCESS) { deinitialize (); }
+    __atomic_store_n (&header -> async_error, (int32_t) SUCCESS, __ATOMIC_RELEASE);
+    updateLoopState (header);
+  }
+}
+
+int main (int argc, char ** argv) {
+  std::string name = argc > 1 ? argv [1] : "hpge";
+  if (name [0] != '/') { name = "/" + name; }
+  size_t capacity = (size_t) (argc > 2 ? std::atoi (argv [2]) : 16) << 20;
+  if (capacity == 0) {
+    std::fprintf (stderr, "Usage: %s [NAME [COMMAND_RING_MB]]\n", argv [0]);
+    return 1;
+  }
+
+  // a segment left by a server that crashed is replaced
+  shm_unlink (name.c_str ());
+  int fd = shm_open (name.c_str (), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0 || ftruncate (fd, (off_t) segmentSize (capacity)) != 0) {
+    std::perror ("hpge-server: shared memory");
+    return 1;
+  }
+  void * memory = mmap (nullptr, segmentSize (capacity), PROT_READ | PROT_WRITE,
+			MAP_SHARED, fd, 0);
+  close (fd);
+  if (memory == MAP_FAILED) {
+    std::perror ("hpge-server: mmap");
+    shm_unlink (name.c_str ());
+    return 1;
+  }
+
+  Header * header = static_cast<Header *> (memory);
+  std::memset (memory, 0, sizeof (Header));
+  header -> version = HPGE_SERVER_VERSION;
+  header -> server_pid = (uint64_t) getpid ();
+  header -> command_capacity = capacity;
+  // clients check the magic last
+  __atomic_store_n (&header -> magic, HPGE_SERVER_MAGIC, __ATOMIC_RELEASE);
+
+  std::signal (SIGINT, onSignal);
+  std::signal (SIGTERM, onSignal);
+  std::printf ("hpge-server: listening on %s\n", name.c_str ());
+
+  Writer reply;
+  auto lastCheck = std::chrono::steady_clock::now ();
+  int idle = 0;
+  // process that owns the world; it stays the owner after a clean
+  // disconnect, so that it can connect again to the same world
+  uint64_t owner = 0;
+  while (! quit) {
+    const Record * record = peekCommand (header);
+    if (record != nullptr) {
+      idle = 0;
+      // read after the record: a client takes `client_pid` before it
+      // pushes its first command
+      uint64_t client = __atomic_load_n (&header -> client_pid, __ATOMIC_ACQUIRE);
+      if (client != 0 && client != owner) {
+	std::printf ("hpge-server: client %llu connected\n", (unsigned long long) client);
+	resetSession (header);
+	owner = client;
+      }
+      // the sequence numbers of a client start at its pid << 32
+      if ((record -> sequence >> 32) != owner) {
+	popCommand (header, record);
+	continue;
+      }
+
+      reply.begin (record -> command, record -> sequence);
+      int result = execute (header, record, reply);
+      uint64_t sequence = record -> sequence;
+      bool replied = isReplied (record -> command);
+      popCommand (header, record);
+      updateLoopState (header);
+
+      if (replied) {
+	reply.end ();
+	if (reply.size () > HPGE_SERVER_REPLY_CAPACITY) {
+	  // cannot happen with the replies above
+	  reply.begin (CMD_PAD, sequence);
+	  reply.end ();
+	}
+	std::memcpy (header -> reply, reply.bytes (), reply.size ());
+	header -> reply_size = (uint32_t) reply.size ();
+	__atomic_store_n (&header -> reply_sequence, sequence, __ATOMIC_RELEASE);
+      } else if (result != SUCCESS) {
+	__atomic_store_n (&header -> async_error, result, __ATOMIC_RELEASE);
+      }
+      continue;
+    }
+
+    // Nothing to do: spin a bit, then sleep
+    if (++idle < 1000) {
+      std::this_thread::yield ();
+    } else {
+      std::this_thread::sleep_for (std::chrono::microseconds (100));
+    }
+
+    auto now = std::chrono::steady_clock::now ();
+    if (now - lastCheck > std::chrono::milliseconds (100)) {
+      lastCheck = now;
+      updateLoopState (header);
+      if (owner != 0 && ! processAlive (owner)) {
+	std::printf ("hpge-server: client %llu exited\n", (unsigned long long) owner);
+	resetSession (header);
+	uint64_t client = owner;
+	__atomic_compare_exchange_n (&header -> client_pid, &client, (uint64_t) 0,
+				     false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED);
+	owner = 0;
+      }
+    }
+  }
+
+  if (is_initialized () == SUCCESS) { deinitialize (); }
+  munmap (memory, segmentSize (capacity));
+  shm_unlink (name.c_str ());
+  return 0;
+}
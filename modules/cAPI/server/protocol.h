@@ -0,0 +1,341 @@
+// This file is part of HPGE, an Haptic Plugin for Game Engines
+// -----------------------------------------
+
+// Software License Agreement (BSD License)
+// Copyright (c) 2017-2023,
+// Copyright © 2017-2019 Gabriel Baud-Bovy (gbaudbovy <at> gmail.com)
+// Copyright © 2017-2023 Nicolò Balzarotti (nicolo.balzarotti <at> iit.it)
+// Istituto Italiano di Tecnologia (IIT), All rights reserved.
+//
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+
+// 3. Neither the name of HPGE, Istituto Italiano di Tecnologia nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Protocol between the HPGE server (hpge-server.cc), that owns the
+// device and the world in its own process, and the client shim
+// (client.cc), that exposes the HPGE.h API to the game.
+//
+// They share a POSIX shared-memory segment made of an
+// HPGEServerHeader followed by the command ring:
+// - commands (client -> server) are variable sized records in a
+//   single producer, single consumer byte ring. The client advances
+//   `command_head` after writing a record, the server advances
+//   `command_tail` after executing it. Calls that do not return
+//   data are only enqueued;
+// - calls that return data wait for `reply_sequence` to be set to
+//   their sequence number, with the result in `reply`. There is at
+//   most one such call in flight;
+// - the tool state is written by the haptic thread of the server
+//   after each tick, guarded by the seqlock `state_sequence`.
+// Shared fields are accessed with atomic builtins by both sides.
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#define HPGE_SERVER_MAGIC 0x56525348u // "HSRV"
+#define HPGE_SERVER_VERSION 6u
+#define HPGE_SERVER_REPLY_CAPACITY 4096
+
+namespace HPGE {
+  namespace server {
+    enum Command : uint32_t
+      {
+       CMD_PAD = 0, // skip to the start of the ring
+       // replied
+       CMD_COUNT_DEVICES,
+       CMD_GET_DEVICE_NAME,
+       CMD_INITIALIZE,
+       CMD_DEINITIALIZE,
+       CMD_START,
+       CMD_STOP,
+       CMD_GET_LOG_FRAME,
+       CMD_INIT_LOGGING,
+       CMD_START_LOGGING,
+       CMD_STOP_LOGGING_AND_SAVE,
+       CMD_IS_LOGGING,
+       CMD_ENABLE_TELEMETRY,
+       CMD_DISABLE_TELEMETRY,
+       CMD_FORCE_FIELD_ADD_TERM,
+       CMD_CREATE_GUIDANCE_CONSTRAINT,
+       CMD_GET_WORLD_ROTATION,
+       CMD_GET_WORLD_MIRROR,
+       CMD_GET_WORLD_ORDER,
+       CMD_GET_WORLD_TRANSLATION,
+       CMD_GET_WORLD_SCALE,
+       CMD_CREATE_MESH_OBJECT,
+       CMD_CREATE_SPHERE_OBJECT,
+       CMD_CREATE_BOX_OBJECT,
+       CMD_OBJECT_EXISTS,
+       CMD_GET_OBJECT_POSITION,
+       CMD_GET_OBJECT_ROTATION,
+       CMD_SET_TOOL_HISTORY_SIZE,
+       CMD_GET_TOOL_HISTORY,
+       CMD_GET_CONTACT_EVENTS,
+       CMD_GET_CONTACT_EVENTS_DROPPED,
+       CMD_GET_CONTACTS,
+       CMD_GET_DEVICE_SPECS,
+       CMD_RESCAN_DEVICES,
+       CMD_GET_DEVICE_LIST_VERSION,
+       CMD_START_DEVICE_SCANNER,
+       CMD_STOP_DEVICE_SCANNER,
+       CMD_CREATE_SDF_OBJECT,
+       CMD_CREATE_CONVEX_OBJECT,
+       CMD_SYNC, // waits for the commands enqueued before
+       // enqueued
+       CMD_TICK,
+       CMD_LOG_ANNOTATE,
+       CMD_FORCE_FIELD_SET_TERM,
+       CMD_FORCE_FIELD_SET_TIME_FUNCTION,
+       CMD_FORCE_FIELD_SET_REGION,
+       CMD_FORCE_FIELD_SET_BUTTON_CONDITION,
+       CMD_FORCE_FIELD_CLEAR,
+       CMD_FORCE_FIELD_USE_PROXY,
+       CMD_REMOVE_GUIDANCE_CONSTRAINT,
+       CMD_SET_GUIDANCE_CONSTRAINT_GAINS,
+       CMD_SET_GUIDANCE_CONSTRAINT_GEOMETRY,
+       CMD_SET_GUIDANCE_CONSTRAINT_PATH,
+       CMD_ENABLE_DYNAMIC_OBJECTS,
+       CMD_DISABLE_DYNAMIC_OBJECTS,
+       CMD_ENABLE_WAIT_FOR_SMALL_FORCES,
+       CMD_DISABLE_WAIT_FOR_SMALL_FORCES,
+       CMD_ENABLE_RISE_FORCES,
+       CMD_DISABLE_RISE_FORCES,
+       CMD_SET_WORLD_ROTATION_EULER_XYZ,
+       CMD_SET_WORLD_ROTATION_QUATERNION,
+       CMD_SET_WORLD_MIRROR,
+       CMD_SET_WORLD_TRANSLATION,
+       CMD_SET_WORLD_SCALE,
+       CMD_SET_COLLISION_CACHE_DIRECTORY,
+       CMD_ADD_OBJECT_TO_WORLD,
+       CMD_DISABLE_OBJECT,
+       CMD_ENABLE_OBJECT,
+       CMD_SET_OBJECT_TAG,
+       CMD_SET_TEXTURE_MIPMAP_LEVELS,
+       CMD_SET_OBJECT_TEXTURE,
+       CMD_SET_OBJECT_MATERIAL,
+       CMD_ENABLE_POSITION_INTERPOLATION,
+       CMD_DISABLE_POSITION_INTERPOLATION,
+       CMD_ENABLE_ROTATION_INTERPOLATION,
+       CMD_DISABLE_ROTATION_INTERPOLATION,
+       CMD_SET_INTERPOLATION_PERIOD,
+       CMD_SET_OBJECT_POSITION,
+       CMD_SET_OBJECT_ROTATION,
+       CMD_SET_OBJECT_ROTATION_EULER,
+       CMD_SET_OBJECT_SCALE,
+       CMD_SET_CONTACT_PERSIST_INTERVAL,
+       CMD_SET_MESH_CONVEXITY_DETECTION,
+       CMD_LAST
+      };
+
+    // Whether the client waits for the result of `command`
+    inline bool isReplied (const uint32_t command) {
+      return command > CMD_PAD && command <= CMD_SYNC;
+    }
+
+    // Tool state after a tick, as given to the chain hooks, plus the
+    // state of the loop
+    struct State {
+      double position [3];
+      double proxy_position [3];
+      double velocity [3];
+      double rotation [4];
+      double force [3];
+      uint32_t buttons;
+      int32_t contacts;
+      int64_t tick;
+    };
+
+    struct Header {
+      uint32_t magic;            // HPGE_SERVER_MAGIC
+      uint32_t version;          // HPGE_SERVER_VERSION
+      uint64_t server_pid;
+      uint64_t client_pid;       // 0: no client connected
+      uint64_t command_capacity; // bytes in the ring
+      // loop state, written by the server after each command
+      int32_t initialized;
+      int32_t running;
+      double loop_frequency;
+      // last error of an enqueued command (SUCCESS: none), cleared by
+      // the client when read
+      int32_t async_error;
+
+      alignas (64) uint64_t command_head; // written by the client
+      alignas (64) uint64_t command_tail; // written by the server
+
+      alignas (64) uint64_t reply_sequence;
+      uint32_t reply_size;
+      alignas (8) char reply [HPGE_SERVER_REPLY_CAPACITY];
+
+      alignas (64) uint64_t state_sequence;
+      State state;
+    };
+
+    // Every command starts with this, and is a multiple of 8 bytes
+    struct Record {
+      uint32_t size; // including the record
+      uint32_t command;
+      uint64_t sequence;
+    };
+
+    constexpr size_t COMMANDS_OFFSET = (sizeof (Header) + 63) & ~((size_t) 63);
+    inline size_t segmentSize (const size_t capacity) {
+      return COMMANDS_OFFSET + capacity;
+    }
+    inline char * commands (Header * header) {
+      return reinterpret_cast<char *> (header) + COMMANDS_OFFSET;
+    }
+
+    // Arguments are stored one after the other, each aligned to 8
+    // bytes; arrays are preceded by their length
+    class Writer {
+    public:
+      void begin (const uint32_t command, const uint64_t sequence) {
+	data.assign (sizeof (Record), 0);
+	Record * r = reinterpret_cast<Record *> (data.data ());
+	r -> command = command;
+	r -> sequence = sequence;
+      }
+      template <typename T> void put (const T value) {
+	putBytes (&value, sizeof (T));
+      }
+      template <typename T> void putArray (const T * values, const size_t n) {
+	put<uint64_t> (values == nullptr ? 0 : n);
+	if (values != nullptr) { putBytes (values, n * sizeof (T)); }
+      }
+      void putString (const char * s) {
+	putArray (s, s == nullptr ? 0 : std::strlen (s) + 1);
+      }
+      // Finishes the record and returns its size
+      size_t end (void) {
+	reinterpret_cast<Record *> (data.data ()) -> size = (uint32_t) data.size ();
+	return data.size ();
+      }
+      const char * bytes (void) const { return data.data (); }
+      size_t size (void) const { return data.size (); }
+    private:
+      void putBytes (const void * p, const size_t n) {
+	size_t start = data.size ();
+	data.resize (start + ((n + 7) & ~((size_t) 7)), 0);
+	if (n > 0) { std::memcpy (&data [start], p, n); }
+      }
+      std::vector<char> data;
+    };
+
+    // Reads what a Writer wrote. Arrays point into the record. After
+    // a read past the end, every value is zero and `ok` is false
+    class Reader {
+    public:
+      Reader (const char * begin, const size_t size)
+	: cursor (begin), end (begin + size) {}
+      template <typename T> T get (void) {
+	T value;
+	const void * p = take (sizeof (T));
+	if (p == nullptr) { std::memset (&value, 0, sizeof (T)); }
+	else { std::memcpy (&value, p, sizeof (T)); }
+	return value;
+      }
+      template <typename T> const T * getArray (size_t * n) {
+	uint64_t count = get<uint64_t> ();
+	if (count > (uint64_t) (end - cursor) / sizeof (T)) {
+	  ok = false;
+	  count = 0;
+	}
+	* n = (size_t) count;
+	if (count == 0) { return nullptr; }
+	return static_cast<const T *> (take (count * sizeof (T)));
+      }
+      const char * getString (void) {
+	size_t n;
+	const char * s = getArray<char> (&n);
+	if (s == nullptr) { return nullptr; }
+	if (s [n - 1] != '\0') { ok = false; return nullptr; }
+	return s;
+      }
+      bool ok {true};
+    private:
+      const void * take (const size_t n) {
+	size_t padded = (n + 7) & ~((size_t) 7);
+	if (! ok || (size_t) (end - cursor) < padded) {
+	  ok = false;
+	  return nullptr;
+	}
+	const char * p = cursor;
+	cursor += padded;
+	return p;
+      }
+      const char * cursor;
+      const char * end;
+    };
+
+    // Producer side of the command ring. Returns false if there is
+    // not enough space now
+    inline bool pushCommand (Header * header, const char * record, const size_t size) {
+      const uint64_t capacity = header -> command_capacity;
+      uint64_t head = __atomic_load_n (&header -> command_head, __ATOMIC_RELAXED);
+      uint64_t tail = __atomic_load_n (&header -> command_tail, __ATOMIC_ACQUIRE);
+      uint64_t offset = head % capacity;
+      // records are contiguous: pad to the start of the ring if needed
+      uint64_t pad = offset + size > capacity ? capacity - offset : 0;
+      if (head + pad + size - tail > capacity) { return false; }
+      char * ring = commands (header);
+      if (pad >= sizeof (Record)) {
+	Record skip {(uint32_t) pad, CMD_PAD, 0};
+	std::memcpy (ring + offset, &skip, sizeof (skip));
+      }
+      std::memcpy (ring + (head + pad) % capacity, record, size);
+      __atomic_store_n (&header -> command_head, head + pad + size, __ATOMIC_RELEASE);
+      return true;
+    }
+
+    // Consumer side: the next record, or nullptr if the ring is
+    // empty. `popCommand` releases it
+    inline const Record * peekCommand (Header * header) {
+      const uint64_t capacity = header -> command_capacity;
+      uint64_t tail = __atomic_load_n (&header -> command_tail, __ATOMIC_RELAXED);
+      while (true) {
+	uint64_t head = __atomic_load_n (&header -> command_head, __ATOMIC_ACQUIRE);
+	if (tail == head) { return nullptr; }
+	uint64_t offset = tail % capacity;
+	const Record * r = reinterpret_cast<const Record *> (commands (header) + offset);
+	if (capacity - offset < sizeof (Record) || r -> command == CMD_PAD) {
+	  // the rest of the ring is padding
+	  tail += capacity - offset;
+	  __atomic_store_n (&header -> command_tail, tail, __ATOMIC_RELEASE);
+	  continue;
+	}
+	return r;
+      }
+    }
+    inline void popCommand (Header * header, const Record * r) {
+      uint64_t tail = __atomic_load_n (&header -> command_tail, __ATOMIC_RELAXED);
+      __atomic_store_n (&header -> command_tail, tail + r -> size, __ATOMIC_RELEASE);
+    }
+  }
+}
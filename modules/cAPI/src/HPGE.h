@@ -55,18 +55,90 @@ typedef void (*ForceHookPtr)(const double [3], // input position
 			     const double [3], // input velocity
 			     double [3]);      // output force
 
+// Tool state given to the chain hooks, in the caller coordinates.
+// Forces and contacts are the ones of the previous tick
+typedef struct {
+  double position [3];       // device
+  double proxy_position [3];
+  double velocity [3];
+  double rotation [4];
+  double force [3];          // force sent to the device
+  unsigned int buttons;      // bit i set: button i pressed
+  int contacts;              // contact points of the proxy
+  long long tick;            // haptic loop counter
+} HookState;
+
+// Tool state of a tick, in the caller coordinates (see
+// `get_tool_history`)
+typedef struct {
+  long long sequence;        // +1 each tick, never reset
+  long long tick;            // haptic loop counter
+  double time;               // seconds, steady clock
+  double position [3];       // device
+  double proxy_position [3];
+  double velocity [3];
+  double force [3];          // force sent to the device
+  unsigned int buttons;      // bit i set: button i pressed
+  int contacts;              // contact points of the proxy
+} ToolSample;
+
+// Contact between the tool and an object (see `get_contact_events`)
+typedef struct {
+  int type;                  // ContactEventType
+  int object;                // object id
+  long long tick;            // haptic loop counter
+  double position [3];       // contact point, caller coordinates
+  double normal [3];         // surface normal, unit length
+  double force;              // contact force magnitude (0 for END)
+} ContactEvent;
+
+// Specifications of a device (see `get_device_specs`), in the device
+// units (N, Nm, N/m, N/(m/s), m)
+typedef struct {
+  double max_force;
+  double max_torque;
+  double max_gripper_force;
+  double max_stiffness;
+  double max_damping;
+  double workspace_radius;
+  int sensed_rotation;       // 1 if the device has the capability
+  int actuated_rotation;
+  int sensed_gripper;
+  int actuated_gripper;
+} DeviceSpecs;
+
+typedef void (*ChainHookPtr)(void *,             // context
+			     const HookState *,  // tool state
+			     double [3]);        // output force
+
 namespace HPGE {
   // Simplify debugging by adding mock functions
   namespace debug {
     bool run_hook (const double position [3],
 		   const double velocity [3],
 		   double force [3]);
+    bool run_hooks (const HookState * state, double force [3]);
+    // forcefield.cc
+    bool run_force_field (const double position [3],
+			  const double velocity [3],
+			  const unsigned int buttons,
+			  double force [3]);
+    // guidance.cc
+    bool run_guidance (const double position [3],
+		       const double velocity [3],
+		       double force [3]);
+    // nearest segment of the path at the last evaluation (or -1)
+    int guidance_path_hint (const int constraintId);
     // world.cc
     bool isInterpolationEnabled (const int objectId, const bool position);
     bool isPositionInterpolationEnabled (const int objectId);
     bool isRotationInterpolationEnabled (const int objectId);
     FUNCDLL_API std::string getObjectTag (const int objectId);
     int getCreatedObjectsNumber (void);
+    // thread.cc
+    FUNCDLL_API int initializeWithDevice (chai3d::cGenericHapticDevicePtr device,
+					  double hapticScale, double radius);
+    FUNCDLL_API bool runTick (TickProfile * profile);
   }
   bool interpolationControl (const int objectId);
   std::ostream& operator<<(std::ostream& os, const SavedFrame& f);
@@ -119,12 +191,84 @@ namespace HPGE {
      ALREADY_RECORDING,     // run stop
      NEGATIVE_CYCLES,
      OVESHOT_TOO_LOW,
-     NO_HOOK_EXISTING
+     NO_HOOK_EXISTING,
+     FORCE_TERM_NOT_FOUND,
+     GUIDANCE_NOT_FOUND,
+     TELEMETRY_FAILED,
+     SERVER_NOT_RUNNING,  // client shim only
+     SERVER_BUSY,
+     SDF_BAKE_FAILED,
+     HULL_FAILED,
+     COMMAND_TOO_LARGE,   // client shim only
+     CALLED_FROM_HOOK,
+     TELEMETRY_IN_USE
     } ErrorMsg;
 
+  // Terms of the native force field (see `force_field_add_term`).
+  // x is the tool position, v its velocity and `vector` the vector
+  // given to the term
+  typedef enum
+    {
+     FORCE_TERM_CONSTANT = 0, // F = gain * vector
+     FORCE_TERM_SPRING = 1,   // F = gain * (vector - x)
+     FORCE_TERM_DAMPER = 2,   // F = - gain * v
+     FORCE_TERM_RADIAL = 3    // F = gain * (x - vector) / |x - vector|
+    } ForceTermType;
+
+  typedef enum
+    {
+     FORCE_REGION_NONE = 0,
+     FORCE_REGION_SPHERE = 1, // size [0] is the radius
+     FORCE_REGION_BOX = 2     // size is the half extent on each axis
+    } ForceRegionShape;
+
+  // Guidance constraints (see `create_guidance_constraint`). The tool
+  // is pulled to the nearest point of the constraint
+  typedef enum
+    {
+     GUIDANCE_POINT = 0,   // origin
+     GUIDANCE_LINE = 1,    // through origin, along direction
+     GUIDANCE_SEGMENT = 2, // path of two points
+     GUIDANCE_PATH = 3,    // polyline
+     GUIDANCE_PLANE = 4,   // through origin, normal to direction
+     GUIDANCE_CONE = 5     // apex in origin, axis along direction,
+			   // half angle. Only pulls from outside
+    } GuidanceType;
+
+  typedef enum
+    {
+     CONTACT_BEGIN = 0,   // the tool touches the object
+     CONTACT_PERSIST = 1, // still touching (see set_contact_persist_interval)
+     CONTACT_END = 2      // last position of the contact
+    } ContactEventType;
+
   inline bool const isMesh(ObjectTypes x) { return x == CMeshType; }
 
   void hapticLoop (void);
+  void hapticTick (TickProfile * profile);
+  bool evaluateForceField (const double position [3],
+			   const double proxy [3],
+			   const double velocity [3],
+			   const unsigned int buttons,
+			   double force [3]);
+  void clearForceFields (void);
+  bool evaluateGuidance (const double position [3],
+			 const double velocity [3],
+			 double force [3]);
+  void clearGuidance (void);
+  void runHooks (const HookState & state, double force [3]);
+  void clearHookChain (void);
+  bool isTelemetryEnabled (void);
+  void publishTelemetry (const double tick_us);
+  void disableTelemetry (void);
+  void recordToolHistory (void);
+  void resetToolHistory (void);
+  void clearToolHistory (void);
+  void updateContacts (void);
+  void clearContacts (void);
+  ErrorMsg initializeDevice (double hapticScale, double radius);
+  ErrorMsg findDevice (const int deviceId,
+		       chai3d::cGenericHapticDevicePtr & device);
   int addObjectToMap (objectStr Obj);
   HPGE::objectStr* getObjectFromMap (int objectId);
   ErrorMsg retErr (ErrorMsg err);
@@ -169,10 +313,22 @@ namespace HPGE {
     FUNCDLL_API void tick (void);
     FUNCDLL_API void log_annotate (char * /*string*/);
 
+    // Devices are scanned on the first query and then cached, so
+    // that these calls are cheap. Device -1 is the mock device
     FUNCDLL_API int count_devices (void);
-    // Scan (count) devices before this
     FUNCDLL_API int get_device_name (const int device,
 				     int buffer_size, char * name);
+    FUNCDLL_API int get_device_specs (const int device, DeviceSpecs * specs);
+    // Scans again (not while initialized) and returns the count or -1
+    FUNCDLL_API int rescan_devices (void);
+    // Increases every time a scan finds a different set of devices
+    FUNCDLL_API int get_device_list_version (void);
+    // Rescans every `period_ms` in a background thread, to notice
+    // devices that are plugged or unplugged. Scans are skipped while
+    // a device is initialized. Stop it before starting it again with
+    // another period (ALREADY_RUNNING otherwise)
+    FUNCDLL_API int start_device_scanner (const int period_ms);
+    FUNCDLL_API int stop_device_scanner (void);
 
     // Haptic device and loops
     FUNCDLL_API int initialize (const int deviceId,
@@ -196,6 +352,88 @@ namespace HPGE {
 				double force [3]));
     FUNCDLL_API int remove_hook (void);
 
+    // Chain of hooks, run after the hook above, in the order they are
+    // added. Each one gets its context and the tool state, and adds
+    // its force. A call longer than `budget_us` microseconds (0: no
+    // budget) skips the next call, whose force is held. Unlike the
+    // hook above, chain hooks are kept when the loop is stopped. Once
+    // `remove_chain_hook` returns, the hook is not running and will
+    // not be called again, so hooks cannot remove hooks (it returns
+    // CALLED_FROM_HOOK). Adding returns the hook id (or -1)
+    FUNCDLL_API int add_chain_hook (ChainHookPtr hook,
+				    void * context,
+				    const double budget_us);
+    FUNCDLL_API int remove_chain_hook (const int hookId);
+    FUNCDLL_API int get_chain_hook_stats (const int hookId,
+					  unsigned long long * calls,
+					  unsigned long long * overruns,
+					  unsigned long long * skipped,
+					  double * max_us);
+
+    // Telemetry: publish the tool state, contacts and loop statistics
+    // of every tick to the POSIX shared-memory segment `name`, with a
+    // ring of `capacity` (at least 2) samples (see telemetry.h). A
+    // segment of another live process is not replaced
+    // (TELEMETRY_IN_USE). Other processes can read it with the
+    // hpge-telemetry library. Not available on Windows
+    FUNCDLL_API int enable_telemetry (const char * name, const int capacity);
+    FUNCDLL_API int disable_telemetry (void);
+
+    // Native force field, evaluated in the haptic loop without
+    // calling back into the game. It is the sum of its terms; each
+    // term is multiplied by gain * (offset + amplitude * sin (2 pi
+    // frequency t + phase)) and can be limited to a region and to a
+    // state of the buttons. Positions, velocities and forces are used
+    // as in the hook. Adding a term returns its id (or -1); the other
+    // functions can be called at any time, without blocking the
+    // haptic loop.
+    FUNCDLL_API int force_field_add_term (const int type, // ForceTermType
+					  const double vector [3],
+					  const double gain);
+    FUNCDLL_API int force_field_set_term (const int term,
+					  const double vector [3],
+					  const double gain);
+    FUNCDLL_API int force_field_set_time_function (const int term,
+						   const double offset,
+						   const double amplitude,
+						   const double frequency,
+						   const double phase);
+    FUNCDLL_API int force_field_set_region (const int term,
+					    const int shape, // ForceRegionShape
+					    const double center [3],
+					    const double size [3],
+					    const int inside); // 1: inside, 0: outside
+    // Active when (buttons & mask) == (pressed ? mask : 0)
+    FUNCDLL_API int force_field_set_button_condition (const int term,
+						      const int mask,
+						      const int pressed);
+    FUNCDLL_API int force_field_clear (void);
+    // 1: evaluate at the proxy position, 0: at the device position
+    FUNCDLL_API void force_field_use_proxy (const int proxy);
+
+    // Guidance constraints, evaluated in the haptic loop at the device
+    // position: F = stiffness * (nearest - x) - damping * v, where v
+    // is the velocity towards the constraint (the whole velocity for
+    // points), limited to `saturation` (0: no limit). Creating a
+    // constraint returns its id (or -1); it has no effect until its
+    // gains and geometry (or path) are set. Updates never block the
+    // haptic loop.
+    FUNCDLL_API int create_guidance_constraint (const int type); // GuidanceType
+    FUNCDLL_API int remove_guidance_constraint (const int constraintId);
+    FUNCDLL_API int set_guidance_constraint_gains (const int constraintId,
+						   const double stiffness,
+						   const double damping,
+						   const double saturation);
+    // angle (radians) is used by cones only
+    FUNCDLL_API int set_guidance_constraint_geometry (const int constraintId,
+						      const double origin [3],
+						      const double direction [3],
+						      const double angle);
+    // num_points points (x, y, z) of a segment or path
+    FUNCDLL_API int set_guidance_constraint_path (const int constraintId,
+						  const double points [],
+						  const int num_points);
+
     FUNCDLL_API int enable_dynamic_objects (void);
     FUNCDLL_API int disable_dynamic_objects (void);
 
@@ -240,6 +478,33 @@ namespace HPGE {
 
     FUNCDLL_API int is_tool_button_pressed (const int buttonId);
 
+    // Contacts of the tool with the objects. Events are queued by
+    // the haptic loop (up to 1024, the newest are dropped when the
+    // queue is full) and removed by `get_contact_events`, that
+    // returns how many were copied (or -1). A persist event is
+    // queued every `ticks` ticks of a contact (16 by default, 0: never).
+    // `get_contacts` copies the current contacts (type
+    // CONTACT_BEGIN or CONTACT_PERSIST) and returns how many (or -1)
+    FUNCDLL_API int get_contact_events (const int max, ContactEvent * events);
+    FUNCDLL_API long long get_contact_events_dropped (void); // and reset
+    FUNCDLL_API int set_contact_persist_interval (const int ticks);
+    FUNCDLL_API int get_contacts (const int max, ContactEvent * contacts);
+
+    // The last `samples` ticks are kept in memory (1024 by default, 0
+    // disables the history). Changing the size drops the history
+    FUNCDLL_API int set_tool_history_size (const int samples);
+    // Copies at most `max` samples with a sequence number greater
+    // than `since`, oldest first, and returns how many (or -1). Pass
+    // the sequence of the last sample read to get only the new ones;
+    // a gap in the sequence numbers means that samples were dropped
+    FUNCDLL_API int get_tool_history (const long long since,
+				      const int max,
+				      ToolSample * out);
+
+    // Cache collision trees of meshes and distance fields of sdf
+    // objects in an existing directory (nullptr or "" disables the cache)
+    FUNCDLL_API int set_collision_cache_directory (const char * path);
+
     // Returns the UUID of the object.
     // Please DO NOT assume the id are sequential. They might be random as well
     FUNCDLL_API int create_mesh_object (const double objectPos [3],
@@ -250,6 +515,26 @@ namespace HPGE {
 					const int vertNum,
 					const int tris [] [3],  const int triNum,
 					const int uvNum,  const double uvs [] [2]);
+    // Static closed mesh baked into a signed distance field, with
+    // `resolution` cells along its longest side: constant-time
+    // collisions whatever the triangle count
+    FUNCDLL_API int create_sdf_object (const double objectPos [3],
+				       const double objectScale [3],
+				       const double objectRotation [4],
+				       const double vertPos [] [3],
+				       const int vertNum,
+				       const int tris [] [3], const int triNum,
+				       const int resolution);
+    // Convex hull of the points: collisions cost about the same for
+    // any number of points
+    FUNCDLL_API int create_convex_object (const double objectPos [3],
+					  const double objectScale [3],
+					  const double objectRotation [4],
+					  const double vertPos [] [3],
+					  const int vertNum);
+    // When enabled (disabled by default), `create_mesh_object` creates
+    // a convex object instead of a mesh if the mesh is convex
+    FUNCDLL_API int set_mesh_convexity_detection (const int enable);
     FUNCDLL_API int create_sphere_object (const double radius,
 				       const double position [3],
 				       const double rotation[4]);
@@ -273,6 +558,8 @@ namespace HPGE {
     FUNCDLL_API int set_object_tag (const int objectId, const char * tag);
 
     // Haptic properties
+    // Mipmap levels of haptic textures set afterwards (1 = none, 0 = all)
+    FUNCDLL_API int set_texture_mipmap_levels (const int levels);
     FUNCDLL_API int set_object_texture (const int objectId,
 					const unsigned int size_x,
 					const unsigned int size_y,
@@ -0,0 +1,269 @@
+// This file is part of HPGE, an Haptic Plugin for Game Engines
+// -----------------------------------------
+
+// Software License Agreement (BSD License)
+// Copyright (c) 2017-2023,
+// Copyright © 2017-2019 Gabriel Baud-Bovy (gbaudbovy <at> gmail.com)
+// Copyright © 2017-2023 Nicolò Balzarotti (nicolo.balzarotti <at> iit.it)
+// Istituto Italiano di Tecnologia (IIT), All rights reserved.
+//
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+
+// 3. Neither the name of HPGE, Istituto Italiano di Tecnologia nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "HPGE.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <mutex>
+
+// Contacts between the tool and the objects. After each tick the
+// haptic thread collects the objects touched by the proxy (collision
+// events) and by the potential field (interaction events inside the
+// shapes), compares them with the previous tick and pushes begin,
+// persist and end events to a bounded queue, that the game drains
+// with `get_contact_events`. The current contacts are also published
+// under a seqlock for `get_contacts`. The haptic thread never waits:
+// when the queue is full, events are dropped and counted.
+
+namespace HPGE {
+  extern std::atomic<int> loop;      // thread.cc
+  extern chai3d::cToolCursor * tool; // thread.cc
+
+  const int MAX_CONTACTS = 16;
+  const unsigned long long CONTACT_QUEUE_SIZE = 1024;
+
+  // Haptic thread only
+  ContactEvent previousContacts [MAX_CONTACTS];
+  long long contactSince [MAX_CONTACTS]; // tick of the begin event
+  int numPreviousContacts {0};
+  std::atomic<int> contactPersistInterval {16};
+
+  // Single producer (haptic thread), single consumer (game, guarded
+  // by `contact_mutex`)
+  ContactEvent contactQueue [CONTACT_QUEUE_SIZE];
+  std::atomic<unsigned long long> contactHead {0};
+  std::atomic<unsigned long long> contactTail {0};
+  std::atomic<unsigned long long> contactDropped {0};
+  std::mutex contact_mutex;
+
+  // Current contacts, odd sequence while being written
+  std::atomic<unsigned int> contactSnapshotSequence {0};
+  ContactEvent contactSnapshot [MAX_CONTACTS];
+  std::atomic<int> contactSnapshotCount {0};
+
+  // HPGE objects point to their objectStr and carry their id from
+  // their creation on, before they are added to the world (see
+  // `addObjectToMap`); contacts can be reported on one of their
+  // children
+  int contactObjectId (chai3d::cGenericObject * object) {
+    while (object != nullptr) {
+      if (object -> m_userData != nullptr) { return object -> m_userTag; }
+      object = object -> getParent ();
+    }
+    return -1;
+  }
+
+  // Adds a contact unless the object already has one
+  void addContact (ContactEvent * contacts, int & n, chai3d::cGenericObject * object,
+		   const chai3d::cVector3d & position, chai3d::cVector3d normal,
+		   const double force) {
+    int id = contactObjectId (object);
+    if (id < 0 || n == MAX_CONTACTS) { return; }
+    for (int i = 0; i < n; ++i) {
+      if (contacts [i].object == id) { return; }
+    }
+    ContactEvent & c = contacts [n++];
+    c.object = id;
+    PosFromChai (position, c.position);
+    // normals are directions: no translation, normalized afterwards
+    normal.normalize ();
+    PosFromChai (normal, c.normal);
+    double length = std::sqrt (c.normal [0] * c.normal [0] +
+			       c.normal [1] * c.normal [1] +
+			       c.normal [2] * c.normal [2]);
+    if (length > 0.0) {
+      for (int i = 0; i < 3; ++i) { c.normal [i] /= length; }
+    }
+    c.force = force;
+  }
+
+  void pushContactEvent (const ContactEvent & event) {
+    unsigned long long head = contactHead.load (std::memory_order_relaxed);
+    if (head - contactTail.load (std::memory_order_acquire) >= CONTACT_QUEUE_SIZE) {
+      contactDropped.fetch_add (1, std::memory_order_relaxed);
+      return;
+    }
+    contactQueue [head % CONTACT_QUEUE_SIZE] = event;
+    contactHead.store (head + 1, std::memory_order_release);
+  }
+
+  // Force magnitude, in the caller units (as `get_tool_force`)
+  double forceMagnitude (const chai3d::cVector3d & force) {
+    double converted [3];
+    PosFromChai (force, converted);
+    return std::sqrt (converted [0] * converted [0] +
+		      converted [1] * converted [1] +
+		      converted [2] * converted [2]);
+  }
+
+  void updateContacts (void) {
+    chai3d::cHapticPoint * point = tool -> m_hapticPoint;
+    int collisions = point -> getNumCollisionEvents ();
+    int interactions = point -> getNumInteractionEvents ();
+    if (collisions == 0 && interactions == 0 && numPreviousContacts == 0) { return; }
+
+    ContactEvent contacts [MAX_CONTACTS];
+    int n = 0;
+    if (collisions > 0) {
+      double force = forceMagnitude (point -> getLastComputedForce ());
+      for (int i = 0; i < collisions; ++i) {
+	chai3d::cCollisionEvent * event = point -> getCollisionEvent (i);
+	addContact (contacts, n, event -> m_object, event -> m_globalPos,
+		    event -> m_globalNormal, force);
+      }
+    }
+    for (int i = 0; i < interactions; ++i) {
+      chai3d::cInteractionEvent * event = point -> getInteractionEvent (i);
+      if (! event -> m_isInside) { continue; }
+      chai3d::cGenericObject * object = event -> m_object;
+      chai3d::cMatrix3d rot = object -> getGlobalRot ();
+      addContact (contacts, n, object,
+		  object -> getGlobalPos () + rot * event -> m_localSurfacePos,
+		  rot * event -> m_localNormal,
+		  forceMagnitude (rot * event -> m_localForce));
+    }
+
+    const long long tick = loop.load ();
+    const int interval = contactPersistInterval.load (std::memory_order_relaxed);
+    long long since [MAX_CONTACTS];
+    for (int i = 0; i < n; ++i) {
+      ContactEvent & c = contacts [i];
+      c.tick = tick;
+      int previous = -1;
+      for (int j = 0; j < numPreviousContacts; ++j) {
+	if (previousContacts [j].object == c.object) { previous = j; break; }
+      }
+      if (previous < 0) {
+	since [i] = tick;
+	c.type = CONTACT_BEGIN;
+	pushContactEvent (c);
+      } else {
+	since [i] = contactSince [previous];
+	c.type = CONTACT_PERSIST;
+	if (interval > 0 && (tick - since [i]) % interval == 0) { pushContactEvent (c); }
+      }
+    }
+    for (int j = 0; j < numPreviousContacts; ++j) {
+      bool found = false;
+      for (int i = 0; i < n && ! found; ++i) {
+	found = contacts [i].object == previousContacts [j].object;
+      }
+      if (! found) {
+	ContactEvent end = previousContacts [j];
+	end.type = CONTACT_END;
+	end.tick = tick;
+	end.force = 0.0;
+	pushContactEvent (end);
+      }
+    }
+
+    unsigned int sequence = contactSnapshotSequence.load (std::memory_order_relaxed);
+    contactSnapshotSequence.store (sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence (std::memory_order_release);
+    std::memcpy (contactSnapshot, contacts, n * sizeof (ContactEvent));
+    contactSnapshotCount.store (n, std::memory_order_relaxed);
+    contactSnapshotSequence.store (sequence + 2, std::memory_order_release);
+
+    std::memcpy (previousContacts, contacts, n * sizeof (ContactEvent));
+    std::memcpy (contactSince, since, n * sizeof (long long));
+    numPreviousContacts = n;
+  }
+
+  // The loop is stopped
+  void clearContacts (void) {
+    std::lock_guard<std::mutex> lock (contact_mutex);
+    numPreviousContacts = 0;
+    contactSnapshotCount.store (0);
+    contactTail.store (contactHead.load ());
+    contactDropped.store (0);
+  }
+
+  extern "C" {
+    int set_contact_persist_interval (const int ticks) {
+      if (ticks < 0) { return retErr (INVALID_PARAMS); }
+      contactPersistInterval.store (ticks);
+      return retErr (SUCCESS);
+    }
+
+    int get_contact_events (const int max, ContactEvent * events) {
+      if (max < 0 || (max > 0 && events == nullptr)) {
+	retErr (INVALID_PARAMS);
+	return -1;
+      }
+      std::lock_guard<std::mutex> lock (contact_mutex);
+      unsigned long long tail = contactTail.load (std::memory_order_relaxed);
+      unsigned long long head = contactHead.load (std::memory_order_acquire);
+      int n = (int) std::min ((unsigned long long) max, head - tail);
+      for (int i = 0; i < n; ++i) {
+	events [i] = contactQueue [(tail + i) % CONTACT_QUEUE_SIZE];
+      }
+      contactTail.store (tail + n, std::memory_order_release);
+      retErr (SUCCESS);
+      return n;
+    }
+
+    long long get_contact_events_dropped (void) {
+      return (long long) contactDropped.exchange (0);
+    }
+
+    int get_contacts (const int max, ContactEvent * contacts) {
+      if (max < 0 || (max > 0 && contacts == nullptr)) {
+	retErr (INVALID_PARAMS);
+	return -1;
+      }
+      ContactEvent copy [MAX_CONTACTS];
+      int n = 0;
+      for (int attempt = 0; attempt < 1000; ++attempt) {
+	unsigned int before = contactSnapshotSequence.load (std::memory_order_acquire);
+	if (before & 1) { continue; }
+	n = contactSnapshotCount.load (std::memory_order_relaxed);
+	std::memcpy (copy, contactSnapshot, n * sizeof (ContactEvent));
+	std::atomic_thread_fence (std::memory_order_acquire);
+	if (contactSnapshotSequence.load (std::memory_order_relaxed) == before) {
+	  n = std::min (n, max);
+	  std::memcpy (contacts, copy, n * sizeof (ContactEvent));
+	  retErr (SUCCESS);
+	  return n;
+	}
+      }
+      retErr (GENERIC_FAIL);
+      return -1;
+    }
+  }
+}
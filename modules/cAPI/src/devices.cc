@@ -0,0 +1,264 @@
+// This file is part of HPGE, an Haptic Plugin for Game Engines
+// -----------------------------------------
+
+// Software License Agreement (BSD License)
+// Copyright (c) 2017-2023,
+// Copyright © 2017-2019 Gabriel Baud-Bovy (gbaudbovy <at> gmail.com)
+// Copyright © 2017-2023 Nicolò Balzarotti (nicolo.balzarotti <at> iit.it)
+// Istituto Italiano di Tecnologia (IIT), All rights reserved.
+//
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+
+// 3. Neither the name of HPGE, Istituto Italiano di Tecnologia nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// Device registry: the devices found by the last scan, with their
+// specifications. Scanning opens and closes every device, so it is
+// done once (on the first query) and then only on request or by the
+// optional background scanner; queries read the cached list.
+
+#include "HPGE.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace HPGE {
+  extern std::atomic<bool> initialized; // thread.cc
+
+  struct DeviceEntry {
+    chai3d::cGenericHapticDevicePtr device;
+    chai3d::cHapticDeviceInfo info;
+  };
+
+  // The list is replaced as a whole by a scan, readers copy the pointer
+  typedef std::shared_ptr<const std::vector<DeviceEntry>> DeviceList;
+  DeviceList device_list;
+  std::mutex device_list_mutex;
+  std::atomic<int> device_list_version {0};
+
+  // Held while scanning and while initializing, so that the scanner
+  // never opens a device that is being started
+  std::mutex device_scan_mutex;
+
+  struct DeviceScanner {
+    std::thread thread;
+    // Serializes starting and stopping (guards `thread`)
+    std::mutex control;
+    // Guards `stop`
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stop {false};
+
+    void halt (void) {
+      {
+	std::lock_guard<std::mutex> lock (mutex);
+	stop = true;
+      }
+      wake.notify_all ();
+      if (thread.joinable ()) { thread.join (); }
+    }
+    ~DeviceScanner () { halt (); }
+  } scanner;
+
+  DeviceList getDeviceList (void) {
+    std::lock_guard<std::mutex> lock (device_list_mutex);
+    return device_list;
+  }
+
+  bool sameDevices (const DeviceList & a, const std::vector<DeviceEntry> & b) {
+    if (a == nullptr || a -> size () != b.size ()) { return false; }
+    for (size_t i = 0; i < b.size (); ++i) {
+      if ((*a) [i].info.m_model != b [i].info.m_model
+	  || (*a) [i].info.m_modelName != b [i].info.m_modelName) {
+	return false;
+      }
+    }
+    return true;
+  }
+
+  // The caller holds `device_scan_mutex`
+  ErrorMsg scanDevices (void) {
+    // the device in use would not open, and would disappear
+    if (initialized.load ()) { return CANT_BE_INITD; }
+
+    // the handler lists the devices when it is created; its entries
+    // are shared pointers that outlive it
+    chai3d::cHapticDeviceHandler handler;
+    std::vector<DeviceEntry> found (handler.getNumDevices ());
+    for (unsigned int i = 0; i < found.size (); ++i) {
+      handler.getDevice (found [i].device, i);
+      found [i].info = found [i].device -> getSpecifications ();
+    }
+
+    std::lock_guard<std::mutex> lock (device_list_mutex);
+    if (! sameDevices (device_list, found)) {
+      device_list_version.fetch_add (1);
+    }
+    device_list = std::make_shared<const std::vector<DeviceEntry>> (std::move (found));
+    return SUCCESS;
+  }
+
+  // Scans if no scan has been done yet. Returns the list, or nullptr
+  // if it was never scanned (and can't be now)
+  DeviceList scannedDeviceList (void) {
+    DeviceList list = getDeviceList ();
+    if (list != nullptr) { return list; }
+    std::lock_guard<std::mutex> lock (device_scan_mutex);
+    scanDevices ();
+    return getDeviceList ();
+  }
+
+  // Device `deviceId` (-1 is the mock device) from the registry. The
+  // caller holds `device_scan_mutex`
+  ErrorMsg findDevice (const int deviceId,
+		       chai3d::cGenericHapticDevicePtr & device) {
+    DeviceList list = getDeviceList ();
+    if (list == nullptr) {
+      ErrorMsg res = scanDevices ();
+      if (res != SUCCESS) { return res; }
+      list = getDeviceList ();
+    }
+    // 1 is the offset created by the CMockDevice, that is always present
+    const int index = deviceId + 1;
+    if (index < 0 || index >= static_cast<int> (list -> size ())) {
+      return DEVICE_NOT_FOUND;
+    }
+    device = (*list) [index].device;
+    return SUCCESS;
+  }
+
+  const chai3d::cHapticDeviceInfo * deviceInfo (const DeviceList & list,
+						const int deviceId) {
+    const int index = deviceId + 1;
+    if (list == nullptr || index < 0
+	|| index >= static_cast<int> (list -> size ())) {
+      return nullptr;
+    }
+    return &(*list) [index].info;
+  }
+
+  void scannerLoop (const int period_ms) {
+    std::unique_lock<std::mutex> lock (scanner.mutex);
+    while (! scanner.stop) {
+      scanner.wake.wait_for (lock, std::chrono::milliseconds (period_ms));
+      if (scanner.stop) { break; }
+      lock.unlock ();
+      {
+	std::lock_guard<std::mutex> scan (device_scan_mutex);
+	scanDevices (); // skipped while a device is initialized
+      }
+      lock.lock ();
+    }
+  }
+
+  extern "C" {
+    int count_devices (void) {
+      DeviceList list = scannedDeviceList ();
+      if (list == nullptr) {
+	// store the error
+	retErr (CANT_BE_INITD);
+	// return a negative value (saying that we have no devices)
+	return -1;
+      }
+      return static_cast<int> (list -> size ());
+    }
+
+    int rescan_devices (void) {
+      std::lock_guard<std::mutex> lock (device_scan_mutex);
+      ErrorMsg res = scanDevices ();
+      if (res != SUCCESS) {
+	retErr (res);
+	return -1;
+      }
+      return count_devices ();
+    }
+
+    int get_device_list_version (void) {
+      return device_list_version.load ();
+    }
+
+    int get_device_name (const int deviceId,
+			 int buffer_size, char * name) {
+      const chai3d::cHapticDeviceInfo * info =
+	deviceInfo (scannedDeviceList (), deviceId);
+      if (info == nullptr) { return retErr (DEVICE_NOT_FOUND); }
+
+      const std::string & msg = info -> m_modelName;
+      // copy of the code in errors.cc, might be refactored
+      if (static_cast<int> (msg.length ()) + 1 <= buffer_size) {
+	std::copy (msg.begin (), msg.end (), name);
+	// don't forget the terminating 0
+	name [msg.size ()] = '\0';
+	return retErr (SUCCESS);
+      }
+      return retErr (BUFFER_TOO_SMALL);
+    }
+
+    int get_device_specs (const int deviceId, DeviceSpecs * specs) {
+      if (specs == nullptr) { return retErr (INVALID_PARAMS); }
+      const chai3d::cHapticDeviceInfo * info =
+	deviceInfo (scannedDeviceList (), deviceId);
+      if (info == nullptr) { return retErr (DEVICE_NOT_FOUND); }
+
+      specs -> max_force = info -> m_maxLinearForce;
+      specs -> max_torque = info -> m_maxAngularTorque;
+      specs -> max_gripper_force = info -> m_maxGripperForce;
+      specs -> max_stiffness = info -> m_maxLinearStiffness;
+      specs -> max_damping = info -> m_maxLinearDamping;
+      specs -> workspace_radius = info -> m_workspaceRadius;
+      specs -> sensed_rotation = info -> m_sensedRotation;
+      specs -> actuated_rotation = info -> m_actuatedRotation;
+      specs -> sensed_gripper = info -> m_sensedGripper;
+      specs -> actuated_gripper = info -> m_actuatedGripper;
+      return retErr (SUCCESS);
+    }
+
+    int start_device_scanner (const int period_ms) {
+      if (period_ms < 1) { return retErr (INVALID_PARAMS); }
+      std::lock_guard<std::mutex> control (scanner.control);
+      if (scanner.thread.joinable ()) { return retErr (ALREADY_RUNNING); }
+      {
+	std::lock_guard<std::mutex> lock (scanner.mutex);
+	scanner.stop = false;
+      }
+      scanner.thread = std::thread (scannerLoop, period_ms);
+      return retErr (SUCCESS);
+    }
+
+    int stop_device_scanner (void) {
+      std::lock_guard<std::mutex> control (scanner.control);
+      if (! scanner.thread.joinable ()) { return retErr (THREAD_NOT_RUNNING); }
+      scanner.halt ();
+      return retErr (SUCCESS);
+    }
+  }
+}
@@ -74,6 +74,16 @@ namespace HPGE {
     , { NEGATIVE_CYCLES, "Fail: The interpolation cycle period cannot be negative (negative time)" }
     , { OVESHOT_TOO_LOW, "The overshot percentage is too low (either 0.0 or negative)" }
     , { NO_HOOK_EXISTING, "No hooks were set, so no hook have been removed!" }
+    , { FORCE_TERM_NOT_FOUND, "Fail: Invalid force field term id" }
+    , { GUIDANCE_NOT_FOUND, "Fail: Invalid guidance constraint id" }
+    , { TELEMETRY_FAILED, "Fail: Could not create the telemetry shared memory" }
+    , { SERVER_NOT_RUNNING, "Fail: The HPGE server is not running" }
+    , { SERVER_BUSY, "Fail: The HPGE server is used by another process" }
+    , { SDF_BAKE_FAILED, "Fail: Could not bake the signed distance field" }
+    , { HULL_FAILED, "Fail: Could not compute the convex hull (flat or too few points)" }
+    , { COMMAND_TOO_LARGE, "Fail: The command (e.g. a mesh) is larger than half the command ring of the HPGE server; start it with a larger COMMAND_RING_MB" }
+    , { CALLED_FROM_HOOK, "Fail: Hooks cannot be removed from a hook (it would wait for itself)" }
+    , { TELEMETRY_IN_USE, "Fail: The telemetry segment is written by another process" }
   };
 
   std::atomic<int> errorPos {0};
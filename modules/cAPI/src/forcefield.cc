@@ -0,0 +1,339 @@
+// This file is part of HPGE, an Haptic Plugin for Game Engines
+// -----------------------------------------
+
+// Software License Agreement (BSD License)
+// Copyright (c) 2017-2023,
+// Copyright © 2017-2019 Gabriel Baud-Bovy (gbaudbovy <at> gmail.com)
+// Copyright © 2017-2023 Nicolò Balzarotti (nicolo.balzarotti <at> iit.it)
+// Istituto Italiano di Tecnologia (IIT), All rights reserved.
+//
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+
+// 3. Neither the name of HPGE, Istituto Italiano di Tecnologia nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Native force fields: a list of terms (constant forces, springs,
+// dampers, radial fields) with an optional time function, button
+// condition and region each, evaluated in the haptic loop instead of
+// (or together with) the hook, so that no managed code runs in the
+// haptic thread.
+//
+// The game thread owns the programs. Adding or removing terms
+// publishes a new copy of the program (see `HapticExchange`), that
+// the haptic thread picks up at the start of its next tick.
+// Parameters of the published program are updated in place, guarded
+// by a sequence counter per term: the haptic thread never waits, and
+// keeps the last consistent parameters while an update is being
+// written.
+
+#include "HPGE.h"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace HPGE {
+  // Layout of the parameters of a term
+  enum ForceTermParam
+    {
+     P_VECTOR = 0,              // 3 values
+     P_GAIN = 3,
+     P_TIME_OFFSET = 4,         // gain *= offset + amplitude * sin (...)
+     P_TIME_AMPLITUDE = 5,
+     P_TIME_FREQUENCY = 6,      // Hz
+     P_TIME_PHASE = 7,          // radians
+     P_REGION_SHAPE = 8,        // ForceRegionShape
+     P_REGION_INSIDE = 9,       // 1: active inside, 0: active outside
+     P_REGION_CENTER = 10,      // 3 values
+     P_REGION_SIZE = 13,        // 3 values (radius or half extents)
+     P_BUTTON_MASK = 16,
+     P_BUTTON_PRESSED = 17,
+     P_COUNT = 18
+    };
+
+  struct ForceTerm {
+    int type;
+    // written by the game thread
+    std::atomic<unsigned int> sequence;
+    std::atomic<double> shared [P_COUNT];
+    // last consistent copy, used by the haptic thread only
+    double values [P_COUNT];
+
+    ForceTerm (int type, const double * initial) : type (type), sequence (0) {
+      for (int i = 0; i < P_COUNT; ++i) {
+	shared [i].store (initial [i], std::memory_order_relaxed);
+	values [i] = initial [i];
+      }
+    }
+
+    // Called by the game thread (one writer at a time)
+    void write (int first, const double * v, int count) {
+      unsigned int s = sequence.load (std::memory_order_relaxed);
+      sequence.store (s + 1, std::memory_order_relaxed);
+      std::atomic_thread_fence (std::memory_order_release);
+      for (int i = 0; i < count; ++i) {
+	shared [first + i].store (v [i], std::memory_order_relaxed);
+      }
+      sequence.store (s + 2, std::memory_order_release);
+    }
+
+    void read (double * out) const {
+      for (int i = 0; i < P_COUNT; ++i) {
+	out [i] = shared [i].load (std::memory_order_relaxed);
+      }
+    }
+
+    // Called by the haptic thread: refresh `values` unless a write
+    // is in progress
+    void refresh (void) {
+      unsigned int before = sequence.load (std::memory_order_acquire);
+      if (before & 1) { return; }
+      double copy [P_COUNT];
+      read (copy);
+      std::atomic_thread_fence (std::memory_order_acquire);
+      if (sequence.load (std::memory_order_relaxed) != before) { return; }
+      for (int i = 0; i < P_COUNT; ++i) { values [i] = copy [i]; }
+    }
+  };
+
+  struct ForceProgram {
+    std::vector<std::unique_ptr<ForceTerm>> terms;
+    // set by the haptic thread when the first program is activated
+    bool started {false};
+    std::chrono::steady_clock::time_point start;
+  };
+
+  HapticExchange<ForceProgram> force_programs;
+  std::atomic<bool> force_field_use_proxy_position {false};
+
+  // Game side: the last published program, guarded by
+  // `force_field_mutex` (never taken by the haptic thread)
+  ForceProgram * latest_program {nullptr};
+  std::mutex force_field_mutex;
+
+  const double TWO_PI = 6.283185307179586;
+
+  // Replaces the program, returning the id of its last term. The
+  // caller holds `force_field_mutex`
+  int publishProgram (ForceProgram * program) {
+    force_programs.publish (program);
+    latest_program = program;
+    return static_cast<int> (program -> terms.size ()) - 1;
+  }
+
+  ForceProgram * copyProgram (const ForceProgram * program) {
+    ForceProgram * copy = new ForceProgram ();
+    if (program == nullptr) { return copy; }
+    for (auto & term : program -> terms) {
+      double values [P_COUNT];
+      term -> read (values);
+      copy -> terms.emplace_back (new ForceTerm (term -> type, values));
+    }
+    return copy;
+  }
+
+  // Writes `count` parameters of a term of the published program
+  ErrorMsg writeTerm (const int term, int first, const double * v, int count) {
+    std::lock_guard<std::mutex> lock (force_field_mutex);
+    if (latest_program == nullptr || term < 0 ||
+	term >= static_cast<int> (latest_program -> terms.size ())) {
+      return FORCE_TERM_NOT_FOUND;
+    }
+    latest_program -> terms [term] -> write (first, v, count);
+    return SUCCESS;
+  }
+
+  bool termIsActive (const double * p, const double x [3],
+		     const unsigned int buttons) {
+    unsigned int mask = static_cast<unsigned int> (p [P_BUTTON_MASK]);
+    if (mask != 0) {
+      unsigned int wanted = p [P_BUTTON_PRESSED] != 0.0 ? mask : 0;
+      if ((buttons & mask) != wanted) { return false; }
+    }
+
+    int shape = static_cast<int> (p [P_REGION_SHAPE]);
+    if (shape == FORCE_REGION_NONE) { return true; }
+    const double * c = p + P_REGION_CENTER;
+    const double * s = p + P_REGION_SIZE;
+    bool inside;
+    if (shape == FORCE_REGION_SPHERE) {
+      double d [3] { x [0] - c [0], x [1] - c [1], x [2] - c [2] };
+      inside = d [0] * d [0] + d [1] * d [1] + d [2] * d [2] <= s [0] * s [0];
+    } else {
+      inside = std::fabs (x [0] - c [0]) <= s [0] &&
+	std::fabs (x [1] - c [1]) <= s [1] &&
+	std::fabs (x [2] - c [2]) <= s [2];
+    }
+    return inside == (p [P_REGION_INSIDE] != 0.0);
+  }
+
+  // Evaluates the active program (picking up a new one first, if
+  // published). Returns false if there is no program
+  bool evaluateForceField (const double position [3],
+			   const double proxy [3],
+			   const double velocity [3],
+			   const unsigned int buttons,
+			   double force [3]) {
+    // The time of the time functions goes on when terms change
+    ForceProgram * program = force_programs.acquire
+      ([] (ForceProgram * next, const ForceProgram * previous) {
+	if (previous != nullptr && previous -> started) {
+	  next -> started = true;
+	  next -> start = previous -> start;
+	}
+      });
+    if (program == nullptr || program -> terms.empty ()) { return false; }
+
+    auto now = std::chrono::steady_clock::now ();
+    if (!program -> started) {
+      program -> started = true;
+      program -> start = now;
+    }
+    double t = std::chrono::duration<double> (now - program -> start).count ();
+    const double * x = force_field_use_proxy_position.load () ? proxy : position;
+
+    for (auto & term : program -> terms) {
+      term -> refresh ();
+      const double * p = term -> values;
+      if (!termIsActive (p, x, buttons)) { continue; }
+
+      double gain = p [P_GAIN] *
+	(p [P_TIME_OFFSET] + p [P_TIME_AMPLITUDE] *
+	 std::sin (TWO_PI * p [P_TIME_FREQUENCY] * t + p [P_TIME_PHASE]));
+      const double * v = p + P_VECTOR;
+
+      switch (term -> type) {
+      case FORCE_TERM_CONSTANT:
+	for (int i = 0; i < 3; ++i) { force [i] += gain * v [i]; }
+	break;
+      case FORCE_TERM_SPRING:
+	for (int i = 0; i < 3; ++i) { force [i] += gain * (v [i] - x [i]); }
+	break;
+      case FORCE_TERM_DAMPER:
+	for (int i = 0; i < 3; ++i) { force [i] -= gain * velocity [i]; }
+	break;
+      case FORCE_TERM_RADIAL: {
+	double d [3] { x [0] - v [0], x [1] - v [1], x [2] - v [2] };
+	double norm = std::sqrt (d [0] * d [0] + d [1] * d [1] + d [2] * d [2]);
+	if (norm > 0.0) {
+	  for (int i = 0; i < 3; ++i) { force [i] += gain * d [i] / norm; }
+	}
+	break;
+      }
+      default:
+	break;
+      }
+    }
+    return true;
+  }
+
+  // Frees all programs. Only when the haptic thread is not running
+  void clearForceFields (void) {
+    std::lock_guard<std::mutex> lock (force_field_mutex);
+    force_programs.clear ();
+    latest_program = nullptr;
+  }
+
+  namespace debug {
+    bool run_force_field (const double position [3],
+			  const double velocity [3],
+			  const unsigned int buttons,
+			  double force [3]) {
+      force [0] = force [1] = force [2] = 0.0;
+      return evaluateForceField (position, position, velocity, buttons, force);
+    }
+  }
+
+  extern "C" {
+    int force_field_add_term (const int type,
+			      const double vector [3],
+			      const double gain) {
+      if (type < FORCE_TERM_CONSTANT || type > FORCE_TERM_RADIAL) {
+	retErr (INVALID_PARAMS);
+	return -1;
+      }
+      // Always active, constant gain
+      double values [P_COUNT] { vector [0], vector [1], vector [2], gain,
+				1.0, 0.0, 0.0, 0.0,
+				FORCE_REGION_NONE, 1.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0,
+				0.0, 0.0 };
+      std::lock_guard<std::mutex> lock (force_field_mutex);
+      ForceProgram * program = copyProgram (latest_program);
+      program -> terms.emplace_back (new ForceTerm (type, values));
+      return publishProgram (program);
+    }
+
+    int force_field_clear (void) {
+      std::lock_guard<std::mutex> lock (force_field_mutex);
+      publishProgram (new ForceProgram ());
+      return retErr (SUCCESS);
+    }
+
+    int force_field_set_term (const int term,
+			      const double vector [3],
+			      const double gain) {
+      double v [4] { vector [0], vector [1], vector [2], gain };
+      return retErr (writeTerm (term, P_VECTOR, v, 4));
+    }
+
+    int force_field_set_time_function (const int term,
+				       const double offset,
+				       const double amplitude,
+				       const double frequency,
+				       const double phase) {
+      double v [4] { offset, amplitude, frequency, phase };
+      return retErr (writeTerm (term, P_TIME_OFFSET, v, 4));
+    }
+
+    int force_field_set_region (const int term,
+				const int shape,
+				const double center [3],
+				const double size [3],
+				const int inside) {
+      if (shape < FORCE_REGION_NONE || shape > FORCE_REGION_BOX) {
+	return retErr (INVALID_PARAMS);
+      }
+      double v [8] { (double) shape, inside == 1 ? 1.0 : 0.0,
+		     center [0], center [1], center [2],
+		     size [0], size [1], size [2] };
+      return retErr (writeTerm (term, P_REGION_SHAPE, v, 8));
+    }
+
+    int force_field_set_button_condition (const int term,
+					  const int mask,
+					  const int pressed) {
+      if (mask < 0) { return retErr (INVALID_PARAMS); }
+      double v [2] { (double) mask, pressed == 1 ? 1.0 : 0.0 };
+      return retErr (writeTerm (term, P_BUTTON_MASK, v, 2));
+    }
+
+    void force_field_use_proxy (const int proxy) {
+      force_field_use_proxy_position.store (proxy == 1);
+    }
+  }
+}
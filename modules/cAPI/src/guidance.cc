@@ -0,0 +1,441 @@
+// This file is part of HPGE, an Haptic Plugin for Game Engines
+// -----------------------------------------
+
+// Software License Agreement (BSD License)
+// Copyright (c) 2017-2023,
+// Copyright © 2017-2019 Gabriel Baud-Bovy (gbaudbovy <at> gmail.com)
+// Copyright © 2017-2023 Nicolò Balzarotti (nicolo.balzarotti <at> iit.it)
+// Istituto Italiano di Tecnologia (IIT), All rights reserved.
+//
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+
+// 3. Neither the name of HPGE, Istituto Italiano di Tecnologia nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Guidance constraints: springs (with damping and saturation) that
+// pull the tool to the nearest point of a point, line, segment,
+// path, plane or cone, evaluated in the haptic loop.
+//
+// The game thread keeps the constraints in `guidance_constraints`;
+// every change publishes a new snapshot of all of them to the haptic
+// thread (see `HapticExchange`). Paths are shared between snapshots
+// and only copied when they are set, so the nearest segment found at
+// the previous tick is kept when the gains or the other constraints
+// change.
+
+#include "HPGE.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define HPGE_GUIDANCE_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace HPGE {
+  // Segments of a path, as structure of arrays (start point, vector
+  // to the end point, inverse squared length), and the bounding
+  // sphere of each block of GUIDANCE_BLOCK segments
+  const size_t GUIDANCE_BLOCK = 16;
+  struct GuidancePath {
+    std::vector<double> ax, ay, az;
+    std::vector<double> dx, dy, dz;
+    std::vector<double> inv;
+    std::vector<double> bx, by, bz, br;
+    // nearest segment at the previous tick (written by the haptic
+    // thread only)
+    mutable std::atomic<size_t> hint {0};
+  };
+
+  struct GuidanceConstraint {
+    int id;
+    int type;
+    double stiffness {0.0};
+    double damping {0.0};
+    double saturation {0.0};
+    double origin [3] {0.0, 0.0, 0.0};
+    double direction [3] {0.0, 0.0, 1.0}; // normalized
+    double cos_angle {1.0};
+    double sin_angle {0.0};
+    std::shared_ptr<const GuidancePath> path;
+  };
+
+  typedef std::vector<GuidanceConstraint> GuidanceSnapshot;
+
+  HapticExchange<GuidanceSnapshot> guidance_snapshots;
+
+  // Game side, guarded by `guidance_mutex` (never taken by the haptic
+  // thread)
+  std::map<int, GuidanceConstraint> guidance_constraints;
+  int guidance_next_id {0};
+  std::mutex guidance_mutex;
+
+  // The caller holds `guidance_mutex`
+  void publishGuidance (void) {
+    GuidanceSnapshot * snapshot = new GuidanceSnapshot ();
+    snapshot -> reserve (guidance_constraints.size ());
+    for (auto & c : guidance_constraints) {
+      snapshot -> push_back (c.second);
+    }
+    guidance_snapshots.publish (snapshot);
+  }
+
+  inline double dot (const double a [3], const double b [3]) {
+    return a [0] * b [0] + a [1] * b [1] + a [2] * b [2];
+  }
+
+  // Squared distance from x to segment i
+  inline double segmentDistance (const GuidancePath & path, const size_t i,
+				 const double x [3], double * t = nullptr) {
+    double w [3] { x [0] - path.ax [i], x [1] - path.ay [i], x [2] - path.az [i] };
+    double d [3] { path.dx [i], path.dy [i], path.dz [i] };
+    double s = std::min (std::max (dot (w, d) * path.inv [i], 0.0), 1.0);
+    if (t != nullptr) { * t = s; }
+    double e [3] { w [0] - s * d [0], w [1] - s * d [1], w [2] - s * d [2] };
+    return dot (e, e);
+  }
+
+  // Updates `best` with the segments in [begin, end) closer to x
+  void searchSegments (const GuidancePath & path, const double x [3],
+		       size_t begin, const size_t end,
+		       size_t & best, double & bestDistance) {
+    size_t i = begin;
+#ifdef HPGE_GUIDANCE_USE_SSE2
+    // two segments at a time
+    const __m128d px = _mm_set1_pd (x [0]);
+    const __m128d py = _mm_set1_pd (x [1]);
+    const __m128d pz = _mm_set1_pd (x [2]);
+    const __m128d zero = _mm_setzero_pd ();
+    const __m128d one = _mm_set1_pd (1.0);
+    const __m128d two = _mm_set1_pd (2.0);
+    __m128d minDistance = _mm_set1_pd (bestDistance);
+    __m128d minIndex = _mm_set1_pd ((double) best);
+    __m128d index = _mm_set_pd ((double) i + 1.0, (double) i);
+    for (; i + 2 <= end; i += 2) {
+      __m128d wx = _mm_sub_pd (px, _mm_loadu_pd (&path.ax [i]));
+      __m128d wy = _mm_sub_pd (py, _mm_loadu_pd (&path.ay [i]));
+      __m128d wz = _mm_sub_pd (pz, _mm_loadu_pd (&path.az [i]));
+      __m128d dx = _mm_loadu_pd (&path.dx [i]);
+      __m128d dy = _mm_loadu_pd (&path.dy [i]);
+      __m128d dz = _mm_loadu_pd (&path.dz [i]);
+      __m128d t = _mm_mul_pd (_mm_add_pd (_mm_add_pd (_mm_mul_pd (wx, dx),
+						      _mm_mul_pd (wy, dy)),
+					  _mm_mul_pd (wz, dz)),
+			      _mm_loadu_pd (&path.inv [i]));
+      t = _mm_min_pd (_mm_max_pd (t, zero), one);
+      wx = _mm_sub_pd (wx, _mm_mul_pd (t, dx));
+      wy = _mm_sub_pd (wy, _mm_mul_pd (t, dy));
+      wz = _mm_sub_pd (wz, _mm_mul_pd (t, dz));
+      __m128d distance = _mm_add_pd (_mm_add_pd (_mm_mul_pd (wx, wx),
+						 _mm_mul_pd (wy, wy)),
+				     _mm_mul_pd (wz, wz));
+      __m128d closer = _mm_cmplt_pd (distance, minDistance);
+      minDistance = _mm_min_pd (distance, minDistance);
+      minIndex = _mm_or_pd (_mm_and_pd (closer, index),
+			    _mm_andnot_pd (closer, minIndex));
+      index = _mm_add_pd (index, two);
+    }
+    double distances [2], indices [2];
+    _mm_storeu_pd (distances, minDistance);
+    _mm_storeu_pd (indices, minIndex);
+    for (int k = 0; k < 2; ++k) {
+      if (distances [k] < bestDistance) {
+	bestDistance = distances [k];
+	best = (size_t) indices [k];
+      }
+    }
+#endif
+    for (; i < end; ++i) {
+      double distance = segmentDistance (path, i, x);
+      if (distance < bestDistance) {
+	bestDistance = distance;
+	best = i;
+      }
+    }
+  }
+
+  // Nearest point of the path to x. The nearest segment of the
+  // previous tick gives a first bound, then only the blocks whose
+  // bounding sphere is closer than the bound are searched
+  void nearestOnPath (const GuidancePath & path, const double x [3],
+		      double nearest [3]) {
+    const size_t n = path.inv.size ();
+    size_t best = path.hint.load (std::memory_order_relaxed);
+    double bestDistance = segmentDistance (path, best, x);
+
+    for (size_t b = 0; b < path.br.size (); ++b) {
+      double c [3] { x [0] - path.bx [b], x [1] - path.by [b], x [2] - path.bz [b] };
+      double gap = std::sqrt (dot (c, c)) - path.br [b];
+      if (gap > 0.0 && gap * gap >= bestDistance) { continue; }
+      searchSegments (path, x, b * GUIDANCE_BLOCK,
+		      std::min (n, (b + 1) * GUIDANCE_BLOCK), best, bestDistance);
+    }
+
+    path.hint.store (best, std::memory_order_relaxed);
+    double t;
+    segmentDistance (path, best, x, &t);
+    nearest [0] = path.ax [best] + t * path.dx [best];
+    nearest [1] = path.ay [best] + t * path.dy [best];
+    nearest [2] = path.az [best] + t * path.dz [best];
+  }
+
+  // Nearest point of the constraint to x. Returns false if the
+  // constraint does not apply (inside a cone, or not set yet)
+  bool nearestOnConstraint (GuidanceConstraint & c, const double x [3],
+			    double nearest [3]) {
+    const double * o = c.origin;
+    const double * n = c.direction;
+    double w [3] { x [0] - o [0], x [1] - o [1], x [2] - o [2] };
+
+    switch (c.type) {
+    case GUIDANCE_POINT:
+      std::copy (o, o + 3, nearest);
+      return true;
+    case GUIDANCE_LINE: {
+      double t = dot (w, n);
+      for (int i = 0; i < 3; ++i) { nearest [i] = o [i] + t * n [i]; }
+      return true;
+    }
+    case GUIDANCE_PLANE: {
+      double t = dot (w, n);
+      for (int i = 0; i < 3; ++i) { nearest [i] = x [i] - t * n [i]; }
+      return true;
+    }
+    case GUIDANCE_CONE: {
+      // inside (or on) the cone: free motion
+      double h = dot (w, n);
+      double r [3] { w [0] - h * n [0], w [1] - h * n [1], w [2] - h * n [2] };
+      double radius = std::sqrt (dot (r, r));
+      if (h * c.sin_angle >= radius * c.cos_angle) { return false; }
+      // nearest point on the generatrix in the plane of x and the axis
+      double u [3];
+      for (int i = 0; i < 3; ++i) {
+	double e = radius > 0.0 ? r [i] / radius : 0.0;
+	u [i] = c.cos_angle * n [i] + c.sin_angle * e;
+      }
+      double t = std::max (dot (w, u), 0.0);
+      for (int i = 0; i < 3; ++i) { nearest [i] = o [i] + t * u [i]; }
+      return true;
+    }
+    case GUIDANCE_SEGMENT:
+    case GUIDANCE_PATH:
+      if (c.path == nullptr || c.path -> inv.empty ()) { return false; }
+      nearestOnPath (* c.path, x, nearest);
+      return true;
+    default:
+      return false;
+    }
+  }
+
+  // Adds the guidance forces to `force`. Returns false if there are
+  // no constraints
+  bool evaluateGuidance (const double position [3],
+			 const double velocity [3],
+			 double force [3]) {
+    GuidanceSnapshot * snapshot = guidance_snapshots.acquire ();
+    if (snapshot == nullptr || snapshot -> empty ()) { return false; }
+
+    for (GuidanceConstraint & c : * snapshot) {
+      double nearest [3];
+      if (!nearestOnConstraint (c, position, nearest)) { continue; }
+
+      double error [3] { nearest [0] - position [0],
+			 nearest [1] - position [1],
+			 nearest [2] - position [2] };
+      double f [3];
+      if (c.type == GUIDANCE_POINT) {
+	for (int i = 0; i < 3; ++i) {
+	  f [i] = c.stiffness * error [i] - c.damping * velocity [i];
+	}
+      } else {
+	// damp the velocity towards (or away from) the constraint only
+	double length = std::sqrt (dot (error, error));
+	double normalVelocity = length > 0.0 ? dot (velocity, error) / length : 0.0;
+	for (int i = 0; i < 3; ++i) {
+	  double e = length > 0.0 ? error [i] / length : 0.0;
+	  f [i] = c.stiffness * error [i] - c.damping * normalVelocity * e;
+	}
+      }
+
+      if (c.saturation > 0.0) {
+	double magnitude = std::sqrt (dot (f, f));
+	if (magnitude > c.saturation) {
+	  for (int i = 0; i < 3; ++i) { f [i] *= c.saturation / magnitude; }
+	}
+      }
+      for (int i = 0; i < 3; ++i) { force [i] += f [i]; }
+    }
+    return true;
+  }
+
+  // Frees all constraints. Only when the haptic thread is not running
+  void clearGuidance (void) {
+    std::lock_guard<std::mutex> lock (guidance_mutex);
+    guidance_snapshots.clear ();
+    guidance_constraints.clear ();
+  }
+
+  namespace debug {
+    bool run_guidance (const double position [3],
+		       const double velocity [3],
+		       double force [3]) {
+      force [0] = force [1] = force [2] = 0.0;
+      return evaluateGuidance (position, velocity, force);
+    }
+
+    int guidance_path_hint (const int constraintId) {
+      std::lock_guard<std::mutex> lock (guidance_mutex);
+      auto found = guidance_constraints.find (constraintId);
+      if (found == guidance_constraints.end () || found -> second.path == nullptr) {
+	return -1;
+      }
+      return (int) found -> second.path -> hint.load (std::memory_order_relaxed);
+    }
+  }
+
+  extern "C" {
+    int create_guidance_constraint (const int type) {
+      if (type < GUIDANCE_POINT || type > GUIDANCE_CONE) {
+	retErr (INVALID_PARAMS);
+	return -1;
+      }
+      std::lock_guard<std::mutex> lock (guidance_mutex);
+      GuidanceConstraint c;
+      c.id = guidance_next_id++;
+      c.type = type;
+      guidance_constraints [c.id] = c;
+      publishGuidance ();
+      return c.id;
+    }
+
+    int remove_guidance_constraint (const int constraintId) {
+      std::lock_guard<std::mutex> lock (guidance_mutex);
+      if (guidance_constraints.erase (constraintId) == 0) {
+	return retErr (GUIDANCE_NOT_FOUND);
+      }
+      publishGuidance ();
+      return retErr (SUCCESS);
+    }
+
+    int set_guidance_constraint_gains (const int constraintId,
+				       const double stiffness,
+				       const double damping,
+				       const double saturation) {
+      if (stiffness < 0.0 || damping < 0.0 || saturation < 0.0) {
+	return retErr (INVALID_PARAMS);
+      }
+      std::lock_guard<std::mutex> lock (guidance_mutex);
+      auto found = guidance_constraints.find (constraintId);
+      if (found == guidance_constraints.end ()) {
+	return retErr (GUIDANCE_NOT_FOUND);
+      }
+      found -> second.stiffness = stiffness;
+      found -> second.damping = damping;
+      found -> second.saturation = saturation;
+      publishGuidance ();
+      return retErr (SUCCESS);
+    }
+
+    int set_guidance_constraint_geometry (const int constraintId,
+					  const double origin [3],
+					  const double direction [3],
+					  const double angle) {
+      double length = std::sqrt (dot (direction, direction));
+      if (length <= 0.0 || angle < 0.0 || angle >= chai3d::C_PI / 2.0) {
+	return retErr (INVALID_PARAMS);
+      }
+      std::lock_guard<std::mutex> lock (guidance_mutex);
+      auto found = guidance_constraints.find (constraintId);
+      if (found == guidance_constraints.end ()) {
+	return retErr (GUIDANCE_NOT_FOUND);
+      }
+      GuidanceConstraint & c = found -> second;
+      for (int i = 0; i < 3; ++i) {
+	c.origin [i] = origin [i];
+	c.direction [i] = direction [i] / length;
+      }
+      c.cos_angle = std::cos (angle);
+      c.sin_angle = std::sin (angle);
+      publishGuidance ();
+      return retErr (SUCCESS);
+    }
+
+    int set_guidance_constraint_path (const int constraintId,
+				      const double points [],
+				      const int num_points) {
+      if (num_points < 2) { return retErr (INVALID_PARAMS); }
+      std::shared_ptr<GuidancePath> path (new GuidancePath ());
+      for (int i = 0; i + 1 < num_points; ++i) {
+	const double * a = &points [3 * i];
+	const double * b = &points [3 * (i + 1)];
+	double d [3] { b [0] - a [0], b [1] - a [1], b [2] - a [2] };
+	double length2 = dot (d, d);
+	path -> ax.push_back (a [0]);
+	path -> ay.push_back (a [1]);
+	path -> az.push_back (a [2]);
+	path -> dx.push_back (d [0]);
+	path -> dy.push_back (d [1]);
+	path -> dz.push_back (d [2]);
+	// zero-length segments are points
+	path -> inv.push_back (length2 > 0.0 ? 1.0 / length2 : 0.0);
+      }
+      // bounding spheres (centered on the box) of the blocks
+      for (int first = 0; first + 1 < num_points; first += (int) GUIDANCE_BLOCK) {
+	int last = std::min (first + (int) GUIDANCE_BLOCK, num_points - 1);
+	double lo [3], hi [3];
+	for (int k = 0; k < 3; ++k) { lo [k] = hi [k] = points [3 * first + k]; }
+	for (int i = first; i <= last; ++i) {
+	  for (int k = 0; k < 3; ++k) {
+	    lo [k] = std::min (lo [k], points [3 * i + k]);
+	    hi [k] = std::max (hi [k], points [3 * i + k]);
+	  }
+	}
+	double half [3] { 0.5 * (hi [0] - lo [0]), 0.5 * (hi [1] - lo [1]), 0.5 * (hi [2] - lo [2]) };
+	path -> bx.push_back (lo [0] + half [0]);
+	path -> by.push_back (lo [1] + half [1]);
+	path -> bz.push_back (lo [2] + half [2]);
+	path -> br.push_back (std::sqrt (dot (half, half)));
+      }
+
+      std::lock_guard<std::mutex> lock (guidance_mutex);
+      auto found = guidance_constraints.find (constraintId);
+      if (found == guidance_constraints.end ()) {
+	return retErr (GUIDANCE_NOT_FOUND);
+      }
+      if (found -> second.type == GUIDANCE_SEGMENT && num_points != 2) {
+	return retErr (INVALID_PARAMS);
+      }
+      found -> second.path = path;
+      publishGuidance ();
+      return retErr (SUCCESS);
+    }
+  }
+}
@@ -0,0 +1,190 @@
+// This file is part of HPGE, an Haptic Plugin for Game Engines
+// -----------------------------------------
+
+// Software License Agreement (BSD License)
+// Copyright (c) 2017-2023,
+// Copyright © 2017-2019 Gabriel Baud-Bovy (gbaudbovy <at> gmail.com)
+// Copyright © 2017-2023 Nicolò Balzarotti (nicolo.balzarotti <at> iit.it)
+// Istituto Italiano di Tecnologia (IIT), All rights reserved.
+//
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+
+// 3. Neither the name of HPGE, Istituto Italiano di Tecnologia nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "HPGE.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// History of the tool state: the haptic thread stores every tick in a
+// ring, the game reads the samples it has not seen yet with
+// `get_tool_history`. The haptic thread never waits for the readers:
+// a reader checks, after copying, that the writer has not reached the
+// samples it copied in the meantime, and drops them otherwise.
+
+namespace HPGE {
+  extern std::atomic<bool> initialized;  // thread.cc
+  extern std::atomic<int> loop;          // thread.cc
+  extern chai3d::cToolCursor * tool;     // thread.cc
+  extern double storedPosition [3];      // positions.cc
+  extern double storedVelocity [3];      // positions.cc
+  extern double storedProxyPosition [3]; // positions.cc
+
+  struct ToolHistory {
+    explicit ToolHistory (const size_t capacity, const long long start)
+      : samples (capacity), start (start), last (start - 1) {}
+    std::vector<ToolSample> samples;
+    // sequence of the first sample stored in this ring
+    const long long start;
+    // sequence of the last sample written
+    std::atomic<long long> last;
+  };
+
+  std::atomic<ToolHistory*> tool_history {nullptr};
+  // odd while the haptic thread writes to the history
+  std::atomic<unsigned int> history_section {0};
+  // Game side: replacing and reading the history
+  std::mutex history_mutex;
+  int historyCapacity {1024};
+  // Sequence of the next sample, kept across rings
+  long long historySequence {1};
+
+  void recordToolHistory (void) {
+    history_section.fetch_add (1);
+    ToolHistory * history = tool_history.load ();
+    if (history != nullptr) {
+      long long sequence = history -> last.load (std::memory_order_relaxed) + 1;
+      ToolSample & sample = history -> samples [sequence % history -> samples.size ()];
+      sample.sequence = sequence;
+      sample.tick = loop.load ();
+      sample.time = std::chrono::duration<double>
+	(std::chrono::steady_clock::now ().time_since_epoch ()).count ();
+      for (int i = 0; i < 3; ++i) {
+	sample.position [i] = storedPosition [i];
+	sample.proxy_position [i] = storedProxyPosition [i];
+	sample.velocity [i] = storedVelocity [i];
+      }
+      // The force just sent, as `get_tool_force` will return it
+      PosFromChai (tool -> getDeviceGlobalForce (), sample.force);
+      sample.buttons = tool -> getUserSwitches ();
+      sample.contacts = tool -> m_hapticPoint -> getNumCollisionEvents ();
+      history -> last.store (sequence, std::memory_order_release);
+    }
+    history_section.fetch_add (1);
+  }
+
+  // Replaces the ring with `next`. The caller holds `history_mutex`
+  void swapToolHistory (ToolHistory * next) {
+    ToolHistory * previous = tool_history.exchange (next);
+    if (previous == nullptr) { return; }
+    // sequences continue in the next ring
+    historySequence = previous -> last.load () + 1;
+    unsigned int section = history_section.load ();
+    if (section & 1) {
+      while (history_section.load () == section) {
+	std::this_thread::yield ();
+      }
+    }
+    delete previous;
+  }
+
+  void resetToolHistory (void) {
+    std::lock_guard<std::mutex> lock (history_mutex);
+    swapToolHistory (nullptr);
+    if (historyCapacity > 0) {
+      swapToolHistory (new ToolHistory (historyCapacity, historySequence));
+    }
+  }
+
+  void clearToolHistory (void) {
+    std::lock_guard<std::mutex> lock (history_mutex);
+    swapToolHistory (nullptr);
+  }
+
+  extern "C" {
+    int set_tool_history_size (const int samples) {
+      // One slot is always being written
+      if (samples < 0 || samples == 1) { return retErr (INVALID_PARAMS); }
+      std::lock_guard<std::mutex> lock (history_mutex);
+      historyCapacity = samples;
+      if (tool_history.load () != nullptr || initialized.load ()) {
+	swapToolHistory (nullptr);
+	if (samples > 0) {
+	  swapToolHistory (new ToolHistory (samples, historySequence));
+	}
+      }
+      return retErr (SUCCESS);
+    }
+
+    int get_tool_history (const long long since, const int max, ToolSample * out) {
+      if (max < 0 || (max > 0 && out == nullptr)) {
+	retErr (INVALID_PARAMS);
+	return -1;
+      }
+      std::lock_guard<std::mutex> lock (history_mutex);
+      ToolHistory * history = tool_history.load ();
+      if (history == nullptr) {
+	retErr (NOT_INITD);
+	return -1;
+      }
+
+      const long long capacity = (long long) history -> samples.size ();
+      long long last = history -> last.load (std::memory_order_acquire);
+      // the slot of sample `last + 1` may be being written
+      long long first = std::max (std::max (since + 1, history -> start),
+				  last + 2 - capacity);
+      long long count = std::min ((long long) max, last - first + 1);
+      if (count <= 0) {
+	retErr (SUCCESS);
+	return 0;
+      }
+
+      // at most two contiguous blocks
+      size_t begin = (size_t) (first % capacity);
+      size_t head = std::min ((size_t) count, (size_t) capacity - begin);
+      std::memcpy (out, &history -> samples [begin], head * sizeof (ToolSample));
+      std::memcpy (out + head, &history -> samples [0],
+		   ((size_t) count - head) * sizeof (ToolSample));
+
+      // drop what the writer reached while we copied
+      std::atomic_thread_fence (std::memory_order_acquire);
+      long long after = history -> last.load (std::memory_order_relaxed);
+      long long overwritten = std::min (count, std::max (0LL, after + 2 - capacity - first));
+      if (overwritten > 0) {
+	std::memmove (out, out + overwritten,
+		      (size_t) (count - overwritten) * sizeof (ToolSample));
+	count -= overwritten;
+      }
+      retErr (SUCCESS);
+      return (int) count;
+    }
+  }
+}
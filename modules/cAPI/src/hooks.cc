@@ -37,24 +37,146 @@
 
 #include "HPGE.h"
 #include <atomic>
+#include <chrono>
+#include <memory>
 #include <mutex>
+#include <thread>
+#include <vector>
+
+// Hooks are called at each tick with the tool state and add a force.
+// The legacy hook (`set_hook`) gets position and velocity only; the
+// chain hooks (`add_chain_hook`) get a context pointer and the whole
+// `HookState`, and run within a time budget.
+//
+// The haptic thread never waits for hooks to be registered or
+// removed: the chain is published as an immutable array (see
+// `HapticExchange`) and the legacy hook is an atomic pointer. Removal
+// functions wait, instead, until the haptic thread is out of the
+// hooks, so that the caller can free the hook context (or the managed
+// delegate) as soon as they return. Hence a hook cannot remove hooks:
+// it would wait for itself.
 
 namespace HPGE {
-  ForceHookPtr force_hook_fn {nullptr};
+  std::atomic<ForceHookPtr> force_hook_fn {nullptr};
   std::atomic<bool> hook_use_proxy {false};
-  std::mutex hook_mutex;
+  // odd while the haptic thread runs the hooks
+  std::atomic<unsigned int> hooks_section {0};
+  // true on the thread running the hooks, while it runs them
+  thread_local bool in_hooks {false};
+
+  // Call counters of a chain hook, shared by all the copies of the
+  // chain. The last force and the skip flag are used by the haptic
+  // thread only
+  struct ChainHookStats {
+    std::atomic<unsigned long long> calls {0};
+    std::atomic<unsigned long long> overruns {0};
+    std::atomic<unsigned long long> skipped {0};
+    std::atomic<double> max_us {0.0};
+    bool skip_next {false};
+    double last_force [3] {0.0, 0.0, 0.0};
+  };
+
+  struct ChainHook {
+    int id;
+    ChainHookPtr fn;
+    void * context;
+    double budget_us;
+    std::shared_ptr<ChainHookStats> stats;
+  };
+
+  typedef std::vector<ChainHook> HookChain;
+
+  HapticExchange<HookChain> hook_chains;
+
+  // Game side, guarded by `hook_chain_mutex` (never taken by the
+  // haptic thread)
+  HookChain hook_chain;
+  int hook_next_id {0};
+  std::mutex hook_chain_mutex;
+
+  // Returns once the haptic thread is not running hooks that were
+  // replaced before this call
+  void waitForHooksSection (void) {
+    unsigned int section = hooks_section.load ();
+    if ((section & 1) == 0) { return; }
+    while (hooks_section.load () == section) {
+      std::this_thread::yield ();
+    }
+  }
+
+  // Runs the legacy hook and the chain, adding their forces to `force`
+  void runHooks (const HookState & state, double force [3]) {
+    hooks_section.fetch_add (1);
+    in_hooks = true;
+
+    ForceHookPtr legacy = force_hook_fn.load ();
+    if (legacy != nullptr) {
+      double external_force [3] { 0.0, 0.0, 0.0 };
+      (* legacy) (hook_use_proxy.load () ?
+		  state.proxy_position : state.position,
+		  state.velocity,
+		  external_force);
+      for (int i = 0; i < 3; ++i) { force [i] += external_force [i]; }
+    }
+
+    HookChain * chain = hook_chains.acquire ();
+    if (chain != nullptr) {
+      for (ChainHook & hook : * chain) {
+	ChainHookStats & stats = * hook.stats;
+	// An overrun skips the next call, holding the last force
+	if (stats.skip_next) {
+	  stats.skip_next = false;
+	  stats.skipped.fetch_add (1, std::memory_order_relaxed);
+	} else {
+	  double hook_force [3] { 0.0, 0.0, 0.0 };
+	  auto begin = std::chrono::steady_clock::now ();
+	  (* hook.fn) (hook.context, &state, hook_force);
+	  double us = std::chrono::duration<double, std::micro>
+	    (std::chrono::steady_clock::now () - begin).count ();
+
+	  stats.calls.fetch_add (1, std::memory_order_relaxed);
+	  if (us > stats.max_us.load (std::memory_order_relaxed)) {
+	    stats.max_us.store (us, std::memory_order_relaxed);
+	  }
+	  if (hook.budget_us > 0.0 && us > hook.budget_us) {
+	    stats.overruns.fetch_add (1, std::memory_order_relaxed);
+	    stats.skip_next = true;
+	  }
+	  for (int i = 0; i < 3; ++i) { stats.last_force [i] = hook_force [i]; }
+	}
+	for (int i = 0; i < 3; ++i) { force [i] += stats.last_force [i]; }
+      }
+    }
+
+    in_hooks = false;
+    hooks_section.fetch_add (1);
+  }
+
+  // Frees the chain. Only when the haptic thread is not running
+  void clearHookChain (void) {
+    std::lock_guard<std::mutex> lock (hook_chain_mutex);
+    hook_chains.clear ();
+    hook_chain.clear ();
+  }
 
   namespace debug {
     bool run_hook
     (const double position [3],
      const double velocity [3],
      double force [3]) {
-      if (force_hook_fn != nullptr) {
-	(force_hook_fn)(position, velocity, force);
+      ForceHookPtr legacy = force_hook_fn.load ();
+      if (legacy != nullptr) {
+	(legacy)(position, velocity, force);
 	return true;
       }
       return false;
     }
+
+    bool run_hooks (const HookState * state, double force [3]) {
+      force [0] = force [1] = force [2] = 0.0;
+      runHooks (* state, force);
+      return force_hook_fn.load () != nullptr || !hook_chain.empty ();
+    }
   }
 
   double get (chai3d::cQuaternion q, int el) {
@@ -81,20 +203,62 @@ namespace HPGE {
 		    const double velocity [3],
 		    double force [3])) {
       hook_use_proxy.store (proxy == 0);
-      hook_mutex.lock ();
-      force_hook_fn = f;
-      hook_mutex.unlock();
+      force_hook_fn.store (f);
+      if (!in_hooks) { waitForHooksSection (); }
     }
 
     int remove_hook (void) {
-      if (force_hook_fn != nullptr) {
-	hook_mutex.lock ();
-	force_hook_fn = nullptr;
-	hook_mutex.unlock ();
-
+      if (in_hooks) { return retErr (CALLED_FROM_HOOK); }
+      if (force_hook_fn.exchange (nullptr) != nullptr) {
+	waitForHooksSection ();
 	return retErr (SUCCESS);
       }
       return retErr (NO_HOOK_EXISTING);
     }
+
+    int add_chain_hook (ChainHookPtr fn, void * context, const double budget_us) {
+      if (fn == nullptr || budget_us < 0.0) {
+	retErr (INVALID_PARAMS);
+	return -1;
+      }
+      std::lock_guard<std::mutex> lock (hook_chain_mutex);
+      ChainHook hook { hook_next_id++, fn, context, budget_us,
+		       std::make_shared<ChainHookStats> () };
+      hook_chain.push_back (hook);
+      hook_chains.publish (new HookChain (hook_chain));
+      return hook.id;
+    }
+
+    int remove_chain_hook (const int hookId) {
+      if (in_hooks) { return retErr (CALLED_FROM_HOOK); }
+      std::lock_guard<std::mutex> lock (hook_chain_mutex);
+      for (auto it = hook_chain.begin (); it != hook_chain.end (); ++it) {
+	if (it -> id == hookId) {
+	  hook_chain.erase (it);
+	  hook_chains.publish (new HookChain (hook_chain));
+	  waitForHooksSection ();
+	  return retErr (SUCCESS);
+	}
+      }
+      return retErr (NO_HOOK_EXISTING);
+    }
+
+    int get_chain_hook_stats (const int hookId,
+			      unsigned long long * calls,
+			      unsigned long long * overruns,
+			      unsigned long long * skipped,
+			      double * max_us) {
+      std::lock_guard<std::mutex> lock (hook_chain_mutex);
+      for (const ChainHook & hook : hook_chain) {
+	if (hook.id == hookId) {
+	  * calls = hook.stats -> calls.load ();
+	  * overruns = hook.stats -> overruns.load ();
+	  * skipped = hook.stats -> skipped.load ();
+	  * max_us = hook.stats -> max_us.load ();
+	  return retErr (SUCCESS);
+	}
+      }
+      return retErr (NO_HOOK_EXISTING);
+    }
   }
 }
@@ -36,6 +36,7 @@
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #pragma once
+#include <atomic>
 namespace HPGE {
   // `RECORDING_DATA_BUFFER_SIZE` just be "big-enough" to prevent data
   // overrides, but garbage collection will happen only after the
@@ -44,6 +45,77 @@ namespace HPGE {
   // high memory usage
   const int RECORDING_DATA_BUFFER_SIZE = 2;
 
+  // Time (in seconds) spent in each stage of a haptic tick. Used to
+  // profile the loop, see `debug::runTick`
+  struct TickProfile {
+    double interpolation;    // updateLerp
+    double hook;             // hook, force field and guidance
+    double global_positions; // world -> computeGlobalPositions
+    double device;           // read the device state
+    double interactions;     // collisions, proxy and effects
+    double apply;            // send the force to the device
+    double logging;
+  };
+
+  // Hands values from the game thread (one writer at a time) to the
+  // haptic thread without locks. The writer must not touch a value
+  // once published; the ones replaced in the haptic thread are freed
+  // by the writer on its next `publish`, so the haptic thread never
+  // frees memory.
+  //
+  // Between two publishes the haptic thread replaces at most two
+  // values (the one still pending when the first publish starts and
+  // the one it publishes), hence the two retired slots
+  template <typename T>
+  class HapticExchange {
+  public:
+    ~HapticExchange () { clear (); }
+
+    // Game thread: `value` is used from the next `acquire`
+    void publish (T * value) {
+      for (auto & slot : retired) { delete slot.exchange (nullptr); }
+      // A value that has not been acquired yet can be freed here
+      delete pending.exchange (value);
+    }
+
+    // Haptic thread: the last published value (or nullptr).
+    // `onSwap (next, previous)` is called when it changes
+    template <typename F>
+    T * acquire (F onSwap) {
+      T * next = pending.exchange (nullptr);
+      if (next != nullptr) {
+	onSwap (next, active);
+	retire (active);
+	active = next;
+      }
+      return active;
+    }
+    T * acquire (void) { return acquire ([] (T *, const T *) {}); }
+
+    // Only when the haptic thread is not running
+    void clear (void) {
+      delete pending.exchange (nullptr);
+      for (auto & slot : retired) { delete slot.exchange (nullptr); }
+      delete active;
+      active = nullptr;
+    }
+
+  private:
+    void retire (T * value) {
+      if (value == nullptr) { return; }
+      for (auto & slot : retired) {
+	T * empty = nullptr;
+	if (slot.compare_exchange_strong (empty, value)) { return; }
+      }
+      // Unreachable with a single writer (see above)
+      delete value;
+    }
+
+    std::atomic<T*> pending {nullptr};
+    std::atomic<T*> retired [2] {{nullptr}, {nullptr}};
+    T * active {nullptr}; // haptic thread
+  };
+
   extern "C" {
     typedef enum
       {
@@ -59,6 +131,8 @@ namespace HPGE {
        CShapeSphereType,
        CShapeTorusType,
        CVoxelObjectType,
+       CDistanceFieldObjectType,
+       CConvexObjectType,
        CWorldType
       } ObjectTypes;
 
@@ -0,0 +1,248 @@
+// This file is part of HPGE, an Haptic Plugin for Game Engines
+// -----------------------------------------
+
+// Software License Agreement (BSD License)
+// Copyright (c) 2017-2023,
+// Copyright © 2017-2019 Gabriel Baud-Bovy (gbaudbovy <at> gmail.com)
+// Copyright © 2017-2023 Nicolò Balzarotti (nicolo.balzarotti <at> iit.it)
+// Istituto Italiano di Tecnologia (IIT), All rights reserved.
+//
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+
+// 3. Neither the name of HPGE, Istituto Italiano di Tecnologia nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Telemetry: the haptic thread publishes the tool state after each
+// tick into a POSIX shared-memory segment (see telemetry.h for the
+// layout), that other processes can map. Writing a sample is a copy
+// of a few hundred bytes, and the writer never waits for readers.
+
+#include "HPGE.h"
+#include "telemetry.h"
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define HPGE_TELEMETRY_POSIX
+#include <cerrno>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace HPGE {
+  extern chai3d::cToolCursor * tool;     // thread.cc
+  extern std::atomic<int> loop;          // thread.cc
+  extern double loopFrequency;           // thread.cc
+  extern double storedPosition [3];      // position.cc
+  extern double storedVelocity [3];      // position.cc
+  extern double storedRotation [4];      // position.cc
+  extern double storedProxyPosition [3]; // position.cc
+
+  // Segment written by the haptic thread, or nullptr
+  std::atomic<HPGETelemetryHeader*> telemetry_segment {nullptr};
+  // odd while the haptic thread writes to the segment
+  std::atomic<unsigned int> telemetry_section {0};
+
+  // Game side, guarded by `telemetry_mutex`
+  std::string telemetry_name;
+  size_t telemetry_size {0};
+  std::mutex telemetry_mutex;
+
+  bool isTelemetryEnabled (void) {
+    return telemetry_segment.load (std::memory_order_relaxed) != nullptr;
+  }
+
+  void publishTelemetry (const double tick_us) {
+    telemetry_section.fetch_add (1);
+    HPGETelemetryHeader * header = telemetry_segment.load ();
+    if (header == nullptr) {
+      telemetry_section.fetch_add (1);
+      return;
+    }
+
+    HPGETelemetrySample sample;
+    sample.tick = (uint64_t) loop.load ();
+    sample.time_ns = (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>
+      (std::chrono::steady_clock::now ().time_since_epoch ()).count ();
+    for (int i = 0; i < 3; ++i) {
+      sample.position [i] = storedPosition [i];
+      sample.proxy_position [i] = storedProxyPosition [i];
+      sample.velocity [i] = storedVelocity [i];
+    }
+    for (int i = 0; i < 4; ++i) { sample.rotation [i] = storedRotation [i]; }
+    // The same conversion as `get_tool_force`
+    PosFromChai (tool -> getDeviceGlobalForce (), sample.force);
+    PosFromChai (tool -> m_hapticPoint -> getLastComputedForce (),
+		 sample.contact_force);
+    sample.buttons = tool -> getUserSwitches ();
+    sample.contacts = tool -> m_hapticPoint -> getNumCollisionEvents ();
+    sample.tick_us = tick_us;
+    sample.loop_frequency = loopFrequency;
+
+    // latest state
+    uint64_t sequence = header -> latest_sequence;
+    __atomic_store_n (&header -> latest_sequence, sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence (__ATOMIC_RELEASE);
+    std::memcpy (&header -> latest, &sample, sizeof (sample));
+    __atomic_store_n (&header -> latest_sequence, sequence + 2, __ATOMIC_RELEASE);
+
+    // ring
+    uint64_t n = header -> written;
+    HPGETelemetrySample * samples = reinterpret_cast<HPGETelemetrySample *>
+      (reinterpret_cast<char *> (header) + HPGE_TELEMETRY_SAMPLES_OFFSET);
+    std::memcpy (&samples [n % header -> capacity], &sample, sizeof (sample));
+    __atomic_store_n (&header -> written, n + 1, __ATOMIC_RELEASE);
+
+    // loop statistics
+    __atomic_store_n (&header -> ticks, header -> ticks + 1, __ATOMIC_RELAXED);
+    if (tick_us > header -> max_tick_us) {
+      __atomic_store (&header -> max_tick_us, &tick_us, __ATOMIC_RELAXED);
+    }
+    if (tick_us > 1000.0) {
+      __atomic_store_n (&header -> overruns, header -> overruns + 1, __ATOMIC_RELAXED);
+    }
+
+    telemetry_section.fetch_add (1);
+  }
+
+  // Stops publishing and removes the segment. The caller holds
+  // `telemetry_mutex`
+  ErrorMsg closeTelemetry (void) {
+    HPGETelemetryHeader * header = telemetry_segment.exchange (nullptr);
+    if (header == nullptr) { return NOT_RECORDING; }
+
+    // wait until the haptic thread is done with the segment
+    unsigned int section = telemetry_section.load ();
+    if (section & 1) {
+      while (telemetry_section.load () == section) {
+	std::this_thread::yield ();
+      }
+    }
+#ifdef HPGE_TELEMETRY_POSIX
+    munmap (header, telemetry_size);
+    shm_unlink (telemetry_name.c_str ());
+#endif
+    return SUCCESS;
+  }
+
+#ifdef HPGE_TELEMETRY_POSIX
+  bool processAlive (const uint64_t pid) {
+    return kill ((pid_t) pid, 0) == 0 || errno != ESRCH;
+  }
+
+  // True if the segment `name` was left by a writer that is gone. A
+  // segment without the magic may be being created by another
+  // process, and is left alone
+  bool isStaleTelemetry (const std::string & name) {
+    int fd = shm_open (name.c_str (), O_RDONLY, 0);
+    if (fd < 0) { return errno == ENOENT; }
+    struct stat info;
+    bool stale = false;
+    if (fstat (fd, &info) == 0 && (size_t) info.st_size >= sizeof (HPGETelemetryHeader)) {
+      void * memory = mmap (nullptr, sizeof (HPGETelemetryHeader), PROT_READ,
+			    MAP_SHARED, fd, 0);
+      if (memory != MAP_FAILED) {
+	const HPGETelemetryHeader * header = static_cast<const HPGETelemetryHeader *> (memory);
+	stale = __atomic_load_n (&header -> magic, __ATOMIC_ACQUIRE) == HPGE_TELEMETRY_MAGIC
+	  && ! processAlive (header -> writer_pid);
+	munmap (memory, sizeof (HPGETelemetryHeader));
+      }
+    }
+    close (fd);
+    return stale;
+  }
+#endif
+
+  void disableTelemetry (void) {
+    std::lock_guard<std::mutex> lock (telemetry_mutex);
+    closeTelemetry ();
+  }
+
+  extern "C" {
+    int enable_telemetry (const char * name, const int capacity) {
+#ifdef HPGE_TELEMETRY_POSIX
+      // readers leave the slot being written, so a ring holds at least
+      // two samples
+      if (name == nullptr || name [0] == '\0' || capacity < 2) {
+	return retErr (INVALID_PARAMS);
+      }
+      std::lock_guard<std::mutex> lock (telemetry_mutex);
+      closeTelemetry ();
+
+      // POSIX names start with a slash
+      telemetry_name = name [0] == '/' ? name : std::string ("/") + name;
+      telemetry_size = HPGE_TELEMETRY_SIZE (capacity);
+
+      // never take over the segment of a live writer
+      int fd = shm_open (telemetry_name.c_str (), O_CREAT | O_EXCL | O_RDWR, 0644);
+      if (fd < 0 && errno == EEXIST) {
+	if (! isStaleTelemetry (telemetry_name)) { return retErr (TELEMETRY_IN_USE); }
+	shm_unlink (telemetry_name.c_str ());
+	fd = shm_open (telemetry_name.c_str (), O_CREAT | O_EXCL | O_RDWR, 0644);
+      }
+      if (fd < 0) { return retErr (TELEMETRY_FAILED); }
+      if (ftruncate (fd, (off_t) telemetry_size) != 0) {
+	close (fd);
+	shm_unlink (telemetry_name.c_str ());
+	return retErr (TELEMETRY_FAILED);
+      }
+      void * memory = mmap (nullptr, telemetry_size, PROT_READ | PROT_WRITE,
+			    MAP_SHARED, fd, 0);
+      close (fd);
+      if (memory == MAP_FAILED) {
+	shm_unlink (telemetry_name.c_str ());
+	return retErr (TELEMETRY_FAILED);
+      }
+
+      HPGETelemetryHeader * header = static_cast<HPGETelemetryHeader *> (memory);
+      std::memset (memory, 0, telemetry_size);
+      header -> version = HPGE_TELEMETRY_VERSION;
+      header -> sample_size = sizeof (HPGETelemetrySample);
+      header -> capacity = (uint32_t) capacity;
+      header -> writer_pid = (uint64_t) getpid ();
+      // readers check the magic last
+      __atomic_store_n (&header -> magic, HPGE_TELEMETRY_MAGIC, __ATOMIC_RELEASE);
+
+      telemetry_segment.store (header);
+      return retErr (SUCCESS);
+#else
+      return retErr (NOT_IMPLEMENTED);
+#endif
+    }
+
+    int disable_telemetry (void) {
+      std::lock_guard<std::mutex> lock (telemetry_mutex);
+      return retErr (closeTelemetry ());
+    }
+  }
+}
@@ -0,0 +1,106 @@
+// This file is part of HPGE, an Haptic Plugin for Game Engines
+// -----------------------------------------
+
+// Software License Agreement (BSD License)
+// Copyright (c) 2017-2023,
+// Copyright © 2017-2019 Gabriel Baud-Bovy (gbaudbovy <at> gmail.com)
+// Copyright © 2017-2023 Nicolò Balzarotti (nicolo.balzarotti <at> iit.it)
+// Istituto Italiano di Tecnologia (IIT), All rights reserved.
+//
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+
+// 3. Neither the name of HPGE, Istituto Italiano di Tecnologia nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Layout of the shared-memory segment written by `enable_telemetry`.
+// Plain C, so that readers in other processes (and languages) can
+// map it; see ../telemetry/hpge-telemetry.h for the reader library.
+//
+// The segment starts with an HPGETelemetryHeader, followed by
+// `capacity` samples from HPGE_TELEMETRY_SAMPLES_OFFSET. The haptic
+// thread is the only writer:
+// - `latest` is guarded by the seqlock `latest_sequence` (odd while
+//   it is being written);
+// - sample n (counting from 0) is stored in samples [n % capacity],
+//   then `written` is set to n + 1. A reader that copied sample n
+//   must check that `written` is still < n + capacity afterwards,
+//   otherwise the sample may have been overwritten while being copied.
+// 64 bit fields are accessed with atomic builtins by both sides.
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#define HPGE_TELEMETRY_MAGIC 0x45475048u // "HPGE"
+#define HPGE_TELEMETRY_VERSION 1u
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  // State of the tool after a tick, in the caller coordinates (as
+  // `get_tool_position` and friends)
+  typedef struct {
+    uint64_t tick;              // haptic loop counter
+    uint64_t time_ns;           // steady clock of the writer
+    double position [3];        // device
+    double proxy_position [3];
+    double velocity [3];
+    double rotation [4];
+    double force [3];           // sent to the device
+    double contact_force [3];   // from the contacts with the objects
+    uint32_t buttons;           // bit i set: button i pressed
+    int32_t contacts;           // contact points of the proxy
+    double tick_us;             // duration of the tick
+    double loop_frequency;      // ticks per second
+  } HPGETelemetrySample;
+
+  typedef struct {
+    uint32_t magic;             // HPGE_TELEMETRY_MAGIC
+    uint32_t version;           // HPGE_TELEMETRY_VERSION
+    uint32_t sample_size;       // sizeof (HPGETelemetrySample)
+    uint32_t capacity;          // samples in the ring
+    uint64_t writer_pid;
+    // loop statistics
+    uint64_t ticks;             // ticks published
+    double max_tick_us;
+    uint64_t overruns;          // ticks longer than 1 ms
+    // latest state, seqlocked
+    uint64_t latest_sequence;
+    HPGETelemetrySample latest;
+    // ring of samples
+    uint64_t written;
+  } HPGETelemetryHeader;
+
+  // Samples start on a cache line after the header
+#define HPGE_TELEMETRY_SAMPLES_OFFSET \
+  ((sizeof (HPGETelemetryHeader) + 63) & ~((size_t) 63))
+#define HPGE_TELEMETRY_SIZE(capacity) \
+  (HPGE_TELEMETRY_SAMPLES_OFFSET + (size_t) (capacity) * sizeof (HPGETelemetrySample))
+
+#ifdef __cplusplus
+}
+#endif
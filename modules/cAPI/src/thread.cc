@@ -51,8 +51,7 @@ namespace HPGE {
   chai3d::cToolCursor * tool = nullptr; // init'd in initialize()
   // a pointer to the current haptic device
   chai3d::cGenericHapticDevicePtr hapticDevice; // init'd in initialize()
-  // a haptic device handler
-  chai3d::cHapticDeviceHandler handler = chai3d::cHapticDeviceHandler ();
+  extern std::mutex device_scan_mutex; // devices.cc
   // get spec of haptic device
   chai3d::cHapticDeviceInfo hapticDeviceInfo;
 
@@ -68,14 +67,12 @@ namespace HPGE {
   std::atomic<bool> stopped {false};
   extern std::atomic<bool> logging; // logging.cc
   std::mutex objects_mutex;
-  extern std::mutex hook_mutex; // hooks.cc
   extern std::mutex world_mutex; // world.cc
   extern std::map<int,HPGE::objectStr> objects;
   extern std::atomic<int> id;
   extern std::mutex data_mutex;
 
-  extern ForceHookPtr force_hook_fn;       // hooks.cc
-  extern std::atomic<bool> hook_use_proxy; // hooks.cc
+  extern std::atomic<ForceHookPtr> force_hook_fn; // hooks.cc
   extern chai3d::cWorld * world;           // world.cc
 
   // logging.cc
@@ -142,112 +139,148 @@ namespace HPGE {
     PosFromChai (deviceForce, storedForce);
   }
 
+  // Seconds elapsed since `start`, used to profile the tick stages
+  inline double elapsed (std::chrono::steady_clock::time_point & start) {
+    auto now = std::chrono::steady_clock::now ();
+    double res = std::chrono::duration<double> (now - start).count ();
+    start = now;
+    return res;
+  }
+
+  // A single iteration of the haptic loop. If `profile` is not null,
+  // the time spent in each stage is stored in it
+  void hapticTick (TickProfile * profile) {
+    std::chrono::steady_clock::time_point clock, tickStart;
+    if (profile != nullptr) { clock = std::chrono::steady_clock::now (); }
+    bool telemetry = isTelemetryEnabled ();
+    if (telemetry) { tickStart = std::chrono::steady_clock::now (); }
+
+    double hook_force [3] {0.0,0.0,0.0};
+
+    loopFrequency = frequencyCounter.signal (1);
+    loop.fetch_add (1);
+
+    // Update object position (to allow force computing)
+    objects_mutex.lock ();
+    bool updated = updateLerp ();
+    objects_mutex.unlock ();
+    if (profile != nullptr) { profile -> interpolation = elapsed (clock); }
+
+    // Run the hooks, if any
+    HookState state;
+    for (int i = 0; i < 3; ++i) {
+      state.position [i] = storedPosition [i];
+      state.proxy_position [i] = storedProxyPosition [i];
+      state.velocity [i] = storedVelocity [i];
+      state.force [i] = storedForce [i];
+    }
+    for (int i = 0; i < 4; ++i) { state.rotation [i] = storedRotation [i]; }
+    state.buttons = tool -> getUserSwitches ();
+    state.contacts = tool -> m_hapticPoint -> getNumCollisionEvents ();
+    state.tick = loop.load ();
+    runHooks (state, hook_force);
+    // Add the native force field and guidance constraints, if any
+    evaluateForceField (storedPosition, storedProxyPosition, storedVelocity,
+			state.buttons, hook_force);
+    evaluateGuidance (storedPosition, storedVelocity, hook_force);
+    if (profile != nullptr) { profile -> hook = elapsed (clock); }
+
+    world_mutex.lock ();
+    // if position or roation has been updated,
+    // force (by setting the parameter to false) to compute vertex positions
+    world -> computeGlobalPositions (updated);
+    if (profile != nullptr) { profile -> global_positions = elapsed (clock); }
+    updateDeviceInformation ();
+    if (profile != nullptr) { profile -> device = elapsed (clock); }
+
+    // compute interaction forces
+    tool -> computeInteractionForces ();
+    world_mutex.unlock ();
+    if (profile != nullptr) { profile -> interactions = elapsed (clock); }
+    // Add the external-hook force
+    tool -> addDeviceGlobalForce (hook_force [0],
+				  hook_force [1],
+				  hook_force [2]);
+
+    // send forces to haptic device
+    tool -> applyToDevice ();
+    if (profile != nullptr) { profile -> apply = elapsed (clock); }
+
+    recordToolHistory ();
+    updateContacts ();
+    if (telemetry) {
+      publishTelemetry (std::chrono::duration<double, std::micro>
+			(std::chrono::steady_clock::now () - tickStart).count ());
+    }
+
+
+    // Store data, if needed
+    SavedFrame thisframe;
+    if(logging.load() &&
+       // requires custom HPGE
+       (loop % log.sampling_rate == 0)) {
+      chai3d::cVector3d devicePos;
+      chai3d::cVector3d deviceVel;
+      chai3d::cVector3d deviceFor;
+
+      // Get information (position, velocity and force) in the
+      // same coordinates and units as the real device.
+      hapticDevice -> getPosition (devicePos);
+      hapticDevice -> getLinearVelocity(deviceVel);
+      hapticDevice -> getForce (deviceFor);
+
+      if(log.device_coordinates) {
+	thisframe = { Now (), ticks.load (),
+		      { devicePos.x (),
+			devicePos.y (),
+			devicePos.z ()
+		      },
+		      { deviceVel.x (),
+			deviceVel.y (),
+			deviceVel.z ()
+		      },
+		      { deviceFor.x (),
+			deviceFor.y (),
+			deviceFor.z ()
+		      },
+		      nullptr,
+		      "auto",
+	};
+      } else {
+	// Get transformed coordinates: same axis and units as the
+	// caller
+	thisframe = { Now(), ticks.load (),
+		      { storedPosition [0],
+			storedPosition [1],
+			storedPosition [2]
+		      },
+		      { storedVelocity [0],
+			storedVelocity [1],
+			storedVelocity [2]
+		      },
+		      {
+			storedForce [0],
+			storedForce [1],
+			storedForce [2]
+		      },
+		      nullptr,
+		      "auto"};
+      }
+
+      data_mutex.lock ();
+      current_data -> frames.push_back (thisframe);
+      data_mutex.unlock ();
+    }
+    if (profile != nullptr) { profile -> logging = elapsed (clock); }
+  }
+
   void hapticLoop (void) {
     resetClock ();
     loop.store (0);
 
     stopped.store (false);
     while (running.load ()) {
-      double hook_force [3] {0.0,0.0,0.0};
-
-      loopFrequency = frequencyCounter.signal (1);
-      loop.fetch_add (1);
-
-      // Update object position (to allow force computing)
-      objects_mutex.lock ();
-      bool updated = updateLerp ();
-      objects_mutex.unlock ();
-
-      hook_mutex.lock ();
-      // Run the hook, if exists
-      if (force_hook_fn != nullptr) {
-	double external_force [3] { 0.0, 0.0, 0.0 };
-	(* force_hook_fn) (hook_use_proxy.load () ?
-			   storedProxyPosition : storedPosition,
-			   storedVelocity,
-			   external_force);
-
-	hook_force [0] = external_force [0];
-	hook_force [1] = external_force [1];
-	hook_force [2] = external_force [2];
-      }
-      hook_mutex.unlock ();
-
-      world_mutex.lock ();
-      // if position or roation has been updated,
-      // force (by setting the parameter to false) to compute vertex positions
-      world -> computeGlobalPositions (updated);
-      updateDeviceInformation ();
-
-      // compute interaction forces
-      tool -> computeInteractionForces ();
-      world_mutex.unlock ();
-      // Add the external-hook force
-      tool -> addDeviceGlobalForce (hook_force [0],
-				    hook_force [1],
-				    hook_force [2]);
-
-      // send forces to haptic device
-      tool -> applyToDevice ();
-
-
-      // Store data, if needed
-      SavedFrame thisframe;
-      if(logging.load() &&
-	 // requires custom HPGE
-	 (loop % log.sampling_rate == 0)) {
-	chai3d::cVector3d devicePos;
-	chai3d::cVector3d deviceVel;
-	chai3d::cVector3d deviceFor;
-
-	// Get information (position, velocity and force) in the
-	// same coordinates and units as the real device.
-	hapticDevice -> getPosition (devicePos);
-	hapticDevice -> getLinearVelocity(deviceVel);
-	hapticDevice -> getForce (deviceFor);
-
-	if(log.device_coordinates) {
-	  thisframe = { Now (), ticks.load (),
-			{ devicePos.x (),
-			  devicePos.y (),
-			  devicePos.z ()
-			},
-			{ deviceVel.x (),
-			  deviceVel.y (),
-			  deviceVel.z ()
-			},
-			{ deviceFor.x (),
-			  deviceFor.y (),
-			  deviceFor.z ()
-			},
-			nullptr,
-			"auto",
-	  };
-	} else {
-	  // Get transformed coordinates: same axis and units as the
-	  // caller
-	  thisframe = { Now(), ticks.load (),
-			{ storedPosition [0],
-			  storedPosition [1],
-			  storedPosition [2]
-			},
-			{ storedVelocity [0],
-			  storedVelocity [1],
-			  storedVelocity [2]
-			},
-			{
-			  storedForce [0],
-			  storedForce [1],
-			  storedForce [2]
-			},
-			nullptr,
-		        "auto"};
-	}
-
-	data_mutex.lock ();
-	current_data -> frames.push_back (thisframe);
-	data_mutex.unlock ();
-      }
+      hapticTick (nullptr);
     }
     tool -> setForcesOFF ();
     
@@ -281,92 +314,79 @@ namespace HPGE {
     }
   }
 
-  extern "C" {
-    int count_devices (void) {
-      if(initialized.load()) {
-	// store the error
-	retErr(CANT_BE_INITD);
-	// return a negative value (saying that we have no devices)
-	return -1;
-      }
-
-      handler.update ();
-      return handler.getNumDevices ();
-    }
-    int get_device_name (const int deviceId,
-			 int buffer_size, char * name) {
-      int foundDevices = count_devices();
-      if(deviceId > foundDevices) {
-	return retErr (DEVICE_NOT_FOUND);
-      }
-
-      chai3d::cGenericHapticDevicePtr tmpDevice;
-      chai3d::cHapticDeviceInfo tmpInfo;
+  // Set up the world and the tool around `hapticDevice`, which must
+  // have already been selected
+  ErrorMsg initializeDevice (double hapticScale, double radius) {
+    hapticDeviceInfo = hapticDevice -> getSpecifications ();
+
+    world = new chai3d::cWorld ();
+    // create a 3D tool and add it to the world
+    tool = new chai3d::cToolCursor (world);
+    world -> addChild (tool);
+    tool -> setHapticDevice (hapticDevice);
+
+    toolRadius = radius;
+    tool -> setRadius (radius);
+    // FIXME: do we need it?
+    tool -> setWorkspaceScaleFactor (hapticScale * 10);
+    tool -> enableDynamicObjects (true);
+    // tool -> start ();
+    workspaceScaleFactor = tool -> getWorkspaceScaleFactor ();
+
+    // don't divide by workspace scale to keep stiffness invariant to scale change
+    maxStiffness = hapticDeviceInfo.m_maxLinearStiffness
+      / workspaceScaleFactor;
+    maxDamping = hapticDeviceInfo.m_maxLinearDamping
+      / workspaceScaleFactor;
+    maxForce = hapticDeviceInfo.m_maxLinearForce;
+
+    tool -> setWaitForSmallForce (wait_for_small_forces);
+    tool -> setUseForceRise (raise_forces);
+    tool -> start ();
+    resetToolHistory ();
+
+    // Set initial device position
+    updateDeviceInformation (); // requires tool
+    world -> computeGlobalPositions (false);
+
+    initialized.store (true);
+    stopped.store (false);
+    return SUCCESS;
+  }
 
-      if (!handler.getDevice (tmpDevice, deviceId + 1)) {
-	return retErr (DEVICE_NOT_FOUND);
-      }
+  namespace debug {
+    // Like `initialize`, but using a device that is not known to the
+    // handler (e.g. a simulated device used by benchmarks)
+    int initializeWithDevice (chai3d::cGenericHapticDevicePtr device,
+			      double hapticScale, double radius) {
+      if (initialized.load ()) { return retErr (ALREADY_INITD); }
+      if (running.load ()) { return retErr (ALREADY_RUNNING); }
+      if (device == nullptr) { return retErr (DEVICE_NOT_FOUND); }
 
-      tmpInfo = tmpDevice -> getSpecifications ();
-      tmpDevice -> close ();
+      hapticDevice = device;
+      return retErr (initializeDevice (hapticScale, radius));
+    }
 
-      std::string msg = tmpInfo.m_modelName;
-      // copy of the code in errors.cc, might be refactored
-      if (static_cast<int> (msg.length ()) + 1 <= buffer_size) {
-	std::copy (msg.begin (), msg.end (), name);
-	// don't forget the terminating 0
-	name [msg.size ()] = '\0';
-	return retErr (SUCCESS);
-      }
-      return retErr (BUFFER_TOO_SMALL);
+    // Run a single haptic tick in the calling thread. Fails if the
+    // haptic thread is running
+    bool runTick (TickProfile * profile) {
+      if (!initialized.load () || running.load ()) { return false; }
+      hapticTick (profile);
+      return true;
     }
+  }
 
+  extern "C" {
     int initialize (int deviceId, double hapticScale, double radius) {
       if (initialized.load ()) { return retErr (ALREADY_INITD); }
       // This should not be possible! (unless we support multiple devices)
       if (running.load ()) { return retErr (ALREADY_RUNNING); }
 
-      assert(count_devices () != -1);
-
-      // 1 is the offset created by the CMockDevice, that is
-      // always present
-      if (!handler.getDevice (hapticDevice, deviceId + 1)) {
-	return retErr (DEVICE_NOT_FOUND);
-      }
-      hapticDeviceInfo = hapticDevice -> getSpecifications ();
-
-      world = new chai3d::cWorld ();
-      // create a 3D tool and add it to the world
-      tool = new chai3d::cToolCursor (world);
-      world -> addChild (tool);
-      tool -> setHapticDevice (hapticDevice);
-
-      toolRadius = radius;
-      tool -> setRadius (radius);
-      // FIXME: do we need it?
-      tool -> setWorkspaceScaleFactor (hapticScale * 10);
-      tool -> enableDynamicObjects (true);
-      // tool -> start ();
-      workspaceScaleFactor = tool -> getWorkspaceScaleFactor ();
-
-      // don't divide by workspace scale to keep stiffness invariant to scale change
-      maxStiffness = hapticDeviceInfo.m_maxLinearStiffness
-	/ workspaceScaleFactor;
-      maxDamping = hapticDeviceInfo.m_maxLinearDamping
-	/ workspaceScaleFactor;
-      maxForce = hapticDeviceInfo.m_maxLinearForce;
-
-      tool -> setWaitForSmallForce (wait_for_small_forces);
-      tool -> setUseForceRise (raise_forces);
-      tool -> start ();
-
-      // Set initial device position
-      updateDeviceInformation (); // requires tool
-      world -> computeGlobalPositions (false);
-
-      initialized.store (true);
-      stopped.store (false);
-      return retErr (SUCCESS);
+      // the device probed by the last scan is reused
+      std::lock_guard<std::mutex> lock (device_scan_mutex);
+      ErrorMsg res = findDevice (deviceId, hapticDevice);
+      if (res != SUCCESS) { return retErr (res); }
+      return retErr (initializeDevice (hapticScale, radius));
     }
 
     int deinitialize (void) {
@@ -389,23 +409,30 @@ namespace HPGE {
       tool -> stop ();
       hapticDevice -> close ();
 
+      // objects that were never added to the world are deleted with it
+      for (auto & obj : objects) {
+	if (obj.second.obj -> getParent () == nullptr) {
+	  delete obj.second.obj;
+	}
+      }
       world -> deleteAllChildren ();
 
-      //delete world;
+      // the arena of the objects is freed with the world
+      delete world;
       world = nullptr;
-      //delete handler;
-      //handler = nullptr;
 
       id.store (0);
 
       objects.clear ();
+      clearForceFields ();
+      clearGuidance ();
+      clearHookChain ();
+      disableTelemetry ();
+      clearToolHistory ();
+      clearContacts ();
 
       initialized.store (false);
 
-      // If we need to `delete` something we can do it here
-      // for (auto &obj : objects) {
-      // }
-
       return retErr (SUCCESS);
     }
 
@@ -450,7 +477,7 @@ namespace HPGE {
 
       // Do not call the force hook next time the loop is started!
       // It might get deleted in the meanwhile
-      force_hook_fn = nullptr;
+      force_hook_fn.store (nullptr);
 
       // restore default to prevent strange behavior
       wait_for_small_forces = false;
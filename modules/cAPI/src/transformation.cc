@@ -277,12 +277,34 @@ namespace HPGE {
       rotation [3] = q.z;
     }
 
+    void set_world_rotation_quaternion (const double w,
+				       const double x,
+				       const double y,
+				       const double z) {
+      rotation [0] = w;
+      rotation [1] = x;
+      rotation [2] = y;
+      rotation [3] = z;
+    }
+
     void get_world_mirror (double* out) {
       out [0] = mirror [0];
       out [1] = mirror [1];
       out [2] = mirror [2];
     }
 
+    void get_world_translation (double* out) {
+      out [0] = transl [0];
+      out [1] = transl [1];
+      out [2] = transl [2];
+    }
+
+    void get_world_scale (double* out) {
+      out [0] = scale [0];
+      out [1] = scale [1];
+      out [2] = scale [2];
+    }
+
     void get_world_order (double* out) {
       out [0] = order [0];
       out [1] = order [1];
@@ -36,6 +36,7 @@
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "HPGE.h"
+#include <algorithm>
 #include <atomic>
 #include <mutex>
 
@@ -58,6 +59,21 @@ namespace HPGE {
   // define the radius of the tool (sphere)
   double toolRadius = 0.0;
 
+  // Directory where mesh collision trees and distance fields are
+  // cached, empty = disabled
+  std::mutex collision_cache_mutex;
+  std::string collisionCacheDirectory;
+
+  // create_mesh_object creates convex objects for convex meshes
+  std::atomic<bool> meshConvexityDetection (false);
+  // Meshes whose concavities are shallower than this fraction of
+  // their size are considered convex
+  const double CONVEXITY_TOLERANCE {1e-4};
+
+  // Mipmap levels of the haptic texture fields created by
+  // set_object_texture (1 = no mipmapping, 0 = all levels)
+  std::atomic<int> textureMipmapLevels (1);
+
   // Store all created objects indexed by a UUID
   std::map<int,HPGE::objectStr> objects;
 
@@ -75,10 +91,19 @@ namespace HPGE {
     int idx = id.fetch_add (1);
     objects_mutex.lock ();
     objects [idx] = Obj;
+    // the haptic loop finds the id of the objects it touches here
+    Obj.obj -> m_userTag = idx;
+    Obj.obj -> m_userData = &objects [idx];
     objects_mutex.unlock ();
     return idx;
   }
 
+  // Objects are allocated in the arena of the world, and are freed
+  // with it. Objects created before `initialize` are on the heap
+  chai3d::cArena * objectArena (void) {
+    return world != nullptr ? world -> getObjectArena () : nullptr;
+  }
+
   HPGE::objectStr* getObjectFromMap (int objectId) {
     objects_mutex.lock ();
     // FIXME: replace find() with count(), 0
@@ -151,6 +176,28 @@ namespace HPGE {
   }
 
   extern "C" {
+    // Collision trees of meshes (and distance fields of sdf objects)
+    // created afterwards are loaded from (and saved to) this
+    // directory, keyed by a hash of the geometry and of the tool
+    // radius. The directory must exist. nullptr or "" disables the
+    // cache.
+    int set_collision_cache_directory (const char * path) {
+      std::lock_guard<std::mutex> lock (collision_cache_mutex);
+      collisionCacheDirectory = (path == nullptr) ? "" : std::string (path);
+
+      return retErr (SUCCESS);
+    }
+
+    // Haptic textures set afterwards get `levels` mipmap levels, used
+    // when the tool moves quickly across the texture to avoid
+    // aliasing (1 disables mipmapping, 0 creates all levels).
+    int set_texture_mipmap_levels (const int levels) {
+      if (levels < 0) { return retErr (INVALID_PARAMS); }
+      textureMipmapLevels = levels;
+
+      return retErr (SUCCESS);
+    }
+
     // By default, this does not add the object to the world
     int create_mesh_object (const double objectPos [],
 			    const double objectScale [],
@@ -161,7 +208,7 @@ namespace HPGE {
 			    const int triPos [] [3], const int triNum,
 			    const int uvNum, const double uvs [] [2]) {
       if (!initialized.load ()) { return -1; } // FIXME: add error codes?
-      chai3d::cMesh * object = new chai3d::cMesh ();
+      chai3d::cMesh * object = chai3d::cArena::create<chai3d::cMesh> (objectArena ());
 
       for (int i = 0; i < vertNum; ++i) {
 	int vertex = object -> newVertex ();
@@ -204,12 +251,48 @@ namespace HPGE {
       // compute a boundary box
       object -> computeBoundaryBox (true);
 
+      // a convex mesh is replaced by its hull, whose collisions do not
+      // depend on the number of triangles
+      if (meshConvexityDetection.load ()) {
+	chai3d::cVector3d size = object -> getBoundaryMax () - object -> getBoundaryMin ();
+	double tolerance = CONVEXITY_TOLERANCE
+	  * std::max (std::max (size.x (), size.y ()), size.z ());
+	chai3d::cConvexHullPtr hull = chai3d::cConvexHull::create ();
+	if (hull -> createFromTriangles (object -> m_triangles) &&
+	    hull -> isHullOf (object -> m_triangles, tolerance)) {
+	  delete object;
+	  chai3d::cConvexObject * convex = chai3d::cArena::create<chai3d::cConvexObject> (objectArena ());
+	  convex -> setConvexHull (hull);
+	  convex -> setLocalPos (objPos);
+	  convex -> setLocalRot (rotmat);
+
+	  objectStr obj { convex, CConvexObjectType, "unnamed",
+			  { DEFAULT_INTERPOLATION_MS, 0, 1.0,
+			    // POSITION
+			    false, true, // enable, reached
+			    objPos, objPos, // source, dest
+			    // ROTATION
+			    false, true, // enable, reached
+			    // source, dest
+			    qrot, qrot
+			  }
+	  };
+
+	  return addObjectToMap (obj);
+	}
+      }
+
       // compute collision detection algorithm
       const int brute = 1; // FIXME: add as a parameter
       if (brute == 0) {
 	object -> createBruteForceCollisionDetector ();
       } else {
-	object -> createAABBCollisionDetector (toolRadius);
+	std::string cacheDirectory;
+	{
+	  std::lock_guard<std::mutex> lock (collision_cache_mutex);
+	  cacheDirectory = collisionCacheDirectory;
+	}
+	object -> createAABBCollisionDetector (toolRadius, cacheDirectory);
       }
 
       //object -> computeAllNormals ();
@@ -229,13 +312,153 @@ namespace HPGE {
       return addObjectToMap (obj);
     }
 
+    // Bakes the mesh into a signed distance field with `resolution`
+    // cells along the longest side of the mesh, and creates an object
+    // that collides with it: queries cost the same for any number of
+    // triangles, at the price of memory. The mesh must be closed. The
+    // field covers the tool radius plus 4 cells around the surface.
+    int create_sdf_object (const double objectPos [],
+			   const double objectScale [],
+			   const double objectRotation [],
+			   const double vertPos [] [3],
+			   const int vertNum,
+			   const int triPos [] [3], const int triNum,
+			   const int resolution) {
+      if (!initialized.load ()) { return -1; }
+      if (vertPos == nullptr || triPos == nullptr || vertNum < 3 || triNum < 1 ||
+	  resolution < 1 || resolution > 4096) {
+	retErr (INVALID_PARAMS);
+	return -1;
+      }
+      for (int i = 0; i < triNum; ++i) {
+	for (int j = 0; j < 3; ++j) {
+	  if (triPos [i] [j] < 0 || triPos [i] [j] >= vertNum) {
+	    retErr (INVALID_PARAMS);
+	    return -1;
+	  }
+	}
+      }
+
+      // the same geometry as `create_mesh_object`, only used to bake
+      chai3d::cMesh mesh;
+      for (int i = 0; i < vertNum; ++i) {
+	mesh.newVertex (PosToChai (vertPos [i]));
+      }
+      for (int i = 0; i < triNum; ++i) {
+	mesh.newTriangle (triPos [i] [2], triPos [i] [1], triPos [i] [0]);
+      }
+      auto convertedScale = ScaleToChai (objectScale);
+      mesh.scaleXYZ (convertedScale.get (0),
+		     convertedScale.get (1),
+		     convertedScale.get (2));
+      mesh.computeBoundaryBox (true);
+      chai3d::cVector3d size = mesh.getBoundaryMax () - mesh.getBoundaryMin ();
+      double cellSize = std::max (std::max (size.x (), size.y ()), size.z ())
+	/ resolution;
+      if (!(cellSize > 0.0)) {
+	retErr (INVALID_PARAMS);
+	return -1;
+      }
+
+      std::string cacheDirectory;
+      {
+	std::lock_guard<std::mutex> lock (collision_cache_mutex);
+	cacheDirectory = collisionCacheDirectory;
+      }
+      chai3d::cDistanceFieldObject * object = chai3d::cArena::create<chai3d::cDistanceFieldObject> (objectArena ());
+      if (!object -> createFromMesh (&mesh, cellSize, toolRadius + 4.0 * cellSize,
+				     cacheDirectory)) {
+	delete object;
+	retErr (SDF_BAKE_FAILED);
+	return -1;
+      }
+
+      auto objPos = PosToChai (objectPos);
+      object -> setLocalPos (objPos);
+      chai3d::cMatrix3d rotmat;
+      chai3d::cQuaternion qrot;
+      RotToChai (objectRotation, &qrot);
+      qrot.toRotMat (rotmat);
+      object -> setLocalRot (rotmat);
+
+      objectStr obj { object, CDistanceFieldObjectType, "unnamedsdf",
+		      { DEFAULT_INTERPOLATION_MS, 0, 1.0,
+			// POSITION
+			false, true, // enable, reached
+			objPos, objPos, // source, dest
+			// ROTATION
+			false, true, // enable, reached
+			// source, dest
+			qrot, qrot
+		      }
+      };
+
+      return addObjectToMap (obj);
+    }
+
+    // Creates an object from the convex hull of the points, that
+    // collides with GJK: queries climb the hull from the vertex found
+    // by the previous tick, and cost about the same for any number of
+    // points.
+    int create_convex_object (const double objectPos [],
+			      const double objectScale [],
+			      const double objectRotation [],
+			      const double vertPos [] [3],
+			      const int vertNum) {
+      if (!initialized.load ()) { return -1; }
+      if (vertPos == nullptr || vertNum < 4) {
+	retErr (INVALID_PARAMS);
+	return -1;
+      }
+
+      auto convertedScale = ScaleToChai (objectScale);
+      std::vector<chai3d::cVector3d> points (vertNum);
+      for (int i = 0; i < vertNum; ++i) {
+	points [i] = PosToChai (vertPos [i]);
+	points [i].mulElement (convertedScale);
+      }
+      chai3d::cConvexObject * object = chai3d::cArena::create<chai3d::cConvexObject> (objectArena ());
+      if (!object -> createFromPoints (points)) {
+	delete object;
+	retErr (HULL_FAILED);
+	return -1;
+      }
+
+      auto objPos = PosToChai (objectPos);
+      object -> setLocalPos (objPos);
+      chai3d::cMatrix3d rotmat;
+      chai3d::cQuaternion qrot;
+      RotToChai (objectRotation, &qrot);
+      qrot.toRotMat (rotmat);
+      object -> setLocalRot (rotmat);
+
+      objectStr obj { object, CConvexObjectType, "unnamedconvex",
+		      { DEFAULT_INTERPOLATION_MS, 0, 1.0,
+			// POSITION
+			false, true, // enable, reached
+			objPos, objPos, // source, dest
+			// ROTATION
+			false, true, // enable, reached
+			// source, dest
+			qrot, qrot
+		      }
+      };
+
+      return addObjectToMap (obj);
+    }
+
+    int set_mesh_convexity_detection (const int enable) {
+      meshConvexityDetection = (enable != 0);
+
+      return retErr (SUCCESS);
+    }
+
     int create_box_object (const double scale [3],
 			   const double position [3],
 			   const double rotation [4]) {
       auto objScale = ScaleToChai (scale);
-      chai3d::cShapeBox * object = new chai3d::cShapeBox (objScale.x (),
-							  objScale.y (),
-							  objScale.z ());
+      chai3d::cShapeBox * object = chai3d::cArena::create<chai3d::cShapeBox>
+	(objectArena (), objScale.x (), objScale.y (), objScale.z ());
 
       auto objPos = PosToChai (position);
       object -> setLocalPos (objPos);
@@ -271,7 +494,7 @@ namespace HPGE {
     int create_sphere_object (const double radius,
 			   const double position [3],
 			   const double rotation [4]) {
-      chai3d::cShapeSphere * object = new chai3d::cShapeSphere(radius);
+      chai3d::cShapeSphere * object = chai3d::cArena::create<chai3d::cShapeSphere> (objectArena (), radius);
 
       auto objPos = PosToChai (position);
       object -> setLocalPos (objPos);
@@ -434,15 +657,20 @@ namespace HPGE {
 	}
 
 
-    // README: if the object was NOT a mesh, only the first value of
-    // objectScale is used others are discarded because it's not
-    // possible to scale with XYZ
+    // README: if the object was NOT a mesh (or a convex object), only
+    // the first value of objectScale is used others are discarded
+    // because it's not possible to scale with XYZ
     int set_object_scale (const int objectId, const double objectScale [3]) {
       auto obj = getObjectFromMap (objectId);
       if (obj == nullptr) { return retErr (OBJ_NOT_FOUND); }
 
       auto converted = ScaleToChai (objectScale);
-      if (isMesh (obj -> type)) {
+      if (obj -> type == CConvexObjectType) {
+	static_cast<chai3d::cConvexObject*>
+	  (obj -> obj) -> scaleXYZ (converted.get (0),
+				    converted.get (1),
+				    converted.get (2));
+      } else if (isMesh (obj -> type)) {
 	static_cast<chai3d::cMesh*>
 	  (obj -> obj) -> scaleXYZ (converted.get (0),
 				    converted.get (1),
@@ -575,35 +803,53 @@ namespace HPGE {
       auto obj = getObjectFromMap (objectId);
       if (obj == nullptr) { return retErr (OBJ_NOT_FOUND); }
 
+      // Everything is computed before taking world_mutex, on
+      // objects that the haptic thread cannot see yet, so that the
+      // haptic loop is only blocked while they are swapped in
       chai3d::cImagePtr texture_img (new chai3d::cImage ());
       if (!texture_img -> allocate (size_x, size_y)) {
 	return retErr (FAIL_ALLOCATE_TEXTURE);
       }
-      // Add the pixels
-      for (unsigned int y = 0; y < size_y; ++y) {
-	for (unsigned int x = 0; x < size_x; ++x) {
-	  texture_img -> setPixelColor (x, y,
-					floatToByte (pixels [y * size_x + x]));
-	}
-      }
+      // Add the pixels (gray levels), one row per task
+      unsigned char * data = texture_img -> getData ();
+      const unsigned int threads = std::min (chai3d::cGetNumHardwareThreads (), size_y);
+      chai3d::cParallelFor (threads, [&] (unsigned int thread) {
+	  for (unsigned int y = thread; y < size_y; y += threads) {
+	    const float * row = &pixels [(size_t) y * size_x];
+	    unsigned char * rgb = &data [3 * (size_t) y * size_x];
+	    for (unsigned int x = 0; x < size_x; ++x) {
+	      unsigned char gray = floatToByte (row [x]);
+	      rgb [3 * x] = gray;
+	      rgb [3 * x + 1] = gray;
+	      rgb [3 * x + 2] = gray;
+	    }
+	  }
+	});
 
-      world_mutex.lock ();
-      obj -> obj -> m_texture = chai3d::cTexture2d::create ();
-      if (!obj -> obj -> m_texture -> setImage (texture_img)) {
-	world_mutex.unlock ();
+      chai3d::cTexture2dPtr texture = chai3d::cTexture2d::create ();
+      if (!texture -> setImage (texture_img)) {
 	return retErr (FAIL_SET_TEXTURE);
       }
+      texture -> setSphericalMappingEnabled (spherical == 1);
 
-      obj -> obj -> m_texture -> setSphericalMappingEnabled (spherical == 1);
+      // create normal map from texture data
+      chai3d::cNormalMapPtr normalMap = chai3d::cNormalMap::create ();
+      normalMap -> createMap (texture);
+      normalMap -> flip (false, true);
 
+      // precompute the field sampled by haptic texture rendering
+      if (!normalMap -> createHapticField (texture_img, textureMipmapLevels)) {
+	return retErr (FAIL_SET_TEXTURE);
+      }
+
+      // the previous texture and normal map are swapped out and
+      // released by this thread, after the lock
+      chai3d::cTexture1dPtr previousTexture = texture;
+      world_mutex.lock ();
+      std::swap (obj -> obj -> m_texture, previousTexture);
       obj -> obj -> setUseTexture (true, true);
       obj -> obj -> m_material -> setWhite ();
-
-      // create normal map from texture data
-      chai3d::cNormalMapPtr normalMap = chai3d::cNormalMap::create ();
-      normalMap -> createMap (obj -> obj -> m_texture);
-      obj -> obj -> m_normalMap = normalMap;
-      obj -> obj -> m_normalMap -> flip (false, true);
+      std::swap (obj -> obj -> m_normalMap, normalMap);
 
       // set haptic properties
       obj -> obj -> m_material -> setUseHapticTexture (true);
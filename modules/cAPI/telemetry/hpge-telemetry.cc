@@ -0,0 +1,158 @@
+// This file is part of HPGE, an Haptic Plugin for Game Engines
+// -----------------------------------------
+
+// Software License Agreement (BSD License)
+// Copyright (c) 2017-2023,
+// Copyright © 2017-2019 Gabriel Baud-Bovy (gbaudbovy <at> gmail.com)
+// Copyright © 2017-2023 Nicolò Balzarotti (nicolo.balzarotti <at> iit.it)
+// Istituto Italiano di Tecnologia (IIT), All rights reserved.
+//
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+
+// 3. Neither the name of HPGE, Istituto Italiano di Tecnologia nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "hpge-telemetry.h"
+
+#include <cstring>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+struct HPGETelemetryReader {
+  const HPGETelemetryHeader * header;
+  const HPGETelemetrySample * samples;
+  size_t size;
+  uint64_t next; // next sample to read
+};
+
+extern "C" {
+  HPGETelemetryReader * hpge_telemetry_open (const char * name) {
+    if (name == nullptr || name [0] == '\0') { return nullptr; }
+    std::string path = name [0] == '/' ? name : std::string ("/") + name;
+
+    int fd = shm_open (path.c_str (), O_RDONLY, 0);
+    if (fd < 0) { return nullptr; }
+    struct stat info;
+    if (fstat (fd, &info) != 0 ||
+	(size_t) info.st_size < HPGE_TELEMETRY_SAMPLES_OFFSET) {
+      close (fd);
+      return nullptr;
+    }
+    size_t size = (size_t) info.st_size;
+    void * memory = mmap (nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close (fd);
+    if (memory == MAP_FAILED) { return nullptr; }
+
+    const HPGETelemetryHeader * header = static_cast<const HPGETelemetryHeader *> (memory);
+    if (__atomic_load_n (&header -> magic, __ATOMIC_ACQUIRE) != HPGE_TELEMETRY_MAGIC ||
+	header -> version != HPGE_TELEMETRY_VERSION ||
+	header -> sample_size != sizeof (HPGETelemetrySample) ||
+	header -> capacity < 2 ||
+	HPGE_TELEMETRY_SIZE (header -> capacity) > size) {
+      munmap (memory, size);
+      return nullptr;
+    }
+
+    HPGETelemetryReader * reader = new HPGETelemetryReader ();
+    reader -> header = header;
+    reader -> samples = reinterpret_cast<const HPGETelemetrySample *>
+      (static_cast<const char *> (memory) + HPGE_TELEMETRY_SAMPLES_OFFSET);
+    reader -> size = size;
+    reader -> next = __atomic_load_n (&header -> written, __ATOMIC_ACQUIRE);
+    return reader;
+  }
+
+  void hpge_telemetry_close (HPGETelemetryReader * reader) {
+    if (reader == nullptr) { return; }
+    munmap (const_cast<HPGETelemetryHeader *> (reader -> header), reader -> size);
+    delete reader;
+  }
+
+  const HPGETelemetryHeader * hpge_telemetry_header (const HPGETelemetryReader * reader) {
+    return reader -> header;
+  }
+
+  int hpge_telemetry_latest (const HPGETelemetryReader * reader,
+			     HPGETelemetrySample * sample) {
+    const HPGETelemetryHeader * header = reader -> header;
+    for (int attempt = 0; attempt < 100; ++attempt) {
+      uint64_t before = __atomic_load_n (&header -> latest_sequence, __ATOMIC_ACQUIRE);
+      if (before == 0) { return -1; }
+      if (before & 1) { continue; }
+      std::memcpy (sample, &header -> latest, sizeof (HPGETelemetrySample));
+      __atomic_thread_fence (__ATOMIC_ACQUIRE);
+      if (__atomic_load_n (&header -> latest_sequence, __ATOMIC_RELAXED) == before) {
+	return 0;
+      }
+    }
+    return -1;
+  }
+
+  int hpge_telemetry_read (HPGETelemetryReader * reader,
+			   HPGETelemetrySample * samples,
+			   const int max,
+			   uint64_t * lost) {
+    const HPGETelemetryHeader * header = reader -> header;
+    const uint64_t capacity = header -> capacity;
+    uint64_t written = __atomic_load_n (&header -> written, __ATOMIC_ACQUIRE);
+    uint64_t missed = 0;
+
+    // samples older than the ring are gone; the oldest slot is the
+    // next one the writer fills, so it cannot be read either
+    const uint64_t window = capacity - 1;
+    if (written > window && reader -> next < written - window) {
+      missed += written - window - reader -> next;
+      reader -> next = written - window;
+    }
+    uint64_t first = reader -> next;
+    uint64_t count = written - first;
+    if (max < 0) { count = 0; }
+    if (count > (uint64_t) max) { count = (uint64_t) max; }
+    for (uint64_t i = 0; i < count; ++i) {
+      std::memcpy (&samples [i], &reader -> samples [(first + i) % capacity],
+		   sizeof (HPGETelemetrySample));
+    }
+
+    // drop the samples overwritten while they were copied
+    __atomic_thread_fence (__ATOMIC_ACQUIRE);
+    uint64_t after = __atomic_load_n (&header -> written, __ATOMIC_RELAXED);
+    uint64_t valid = 0;
+    while (valid < count && first + valid + capacity <= after) { ++valid; }
+    if (valid > 0) {
+      std::memmove (samples, &samples [valid], (size_t) (count - valid) * sizeof (HPGETelemetrySample));
+    }
+    missed += valid;
+    count -= valid;
+
+    reader -> next = first + valid + count;
+    if (lost != nullptr) { * lost = missed; }
+    return (int) count;
+  }
+}
@@ -0,0 +1,78 @@
+// This file is part of HPGE, an Haptic Plugin for Game Engines
+// -----------------------------------------
+
+// Software License Agreement (BSD License)
+// Copyright (c) 2017-2023,
+// Copyright © 2017-2019 Gabriel Baud-Bovy (gbaudbovy <at> gmail.com)
+// Copyright © 2017-2023 Nicolò Balzarotti (nicolo.balzarotti <at> iit.it)
+// Istituto Italiano di Tecnologia (IIT), All rights reserved.
+//
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+
+// 3. Neither the name of HPGE, Istituto Italiano di Tecnologia nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Reader of the telemetry published by HPGE (`enable_telemetry`),
+// for other processes on the same machine. The segment is mapped
+// read-only: readers never slow down the haptic thread, and the
+// haptic thread never waits for them. Plain C interface.
+
+#pragma once
+#include "../src/telemetry.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  typedef struct HPGETelemetryReader HPGETelemetryReader;
+
+  // Maps the segment `name` (as given to `enable_telemetry`). Returns
+  // NULL if it does not exist or is not an HPGE telemetry segment
+  HPGETelemetryReader * hpge_telemetry_open (const char * name);
+  void hpge_telemetry_close (HPGETelemetryReader * reader);
+
+  // Header of the mapped segment: loop statistics can be read
+  // directly from it
+  const HPGETelemetryHeader * hpge_telemetry_header (const HPGETelemetryReader * reader);
+
+  // Copies the latest state. Returns 0 on success, -1 if nothing has
+  // been published yet or the writer kept it busy
+  int hpge_telemetry_latest (const HPGETelemetryReader * reader,
+			     HPGETelemetrySample * sample);
+
+  // Copies the samples published since the previous call (or since
+  // the reader was opened), at most `max`, oldest first. At most
+  // `capacity - 1` samples can be read at once. Returns the
+  // number of samples copied. `lost` (if not NULL) gets the number of
+  // samples that were overwritten before they could be read
+  int hpge_telemetry_read (HPGETelemetryReader * reader,
+			   HPGETelemetrySample * samples,
+			   const int max,
+			   uint64_t * lost);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,98 @@
+// This file is part of HPGE, an Haptic Plugin for Game Engines
+// -----------------------------------------
+
+// Software License Agreement (BSD License)
+// Copyright (c) 2017-2023,
+// Copyright © 2017-2019 Gabriel Baud-Bovy (gbaudbovy <at> gmail.com)
+// Copyright © 2017-2023 Nicolò Balzarotti (nicolo.balzarotti <at> iit.it)
+// Istituto Italiano di Tecnologia (IIT), All rights reserved.
+//
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+
+// 3. Neither the name of HPGE, Istituto Italiano di Tecnologia nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Prints the state of the tool published by a running HPGE instance
+// once per second.
+//
+// Usage: telemetry-example NAME
+// where NAME is the one given to `enable_telemetry`
+
+#include "hpge-telemetry.h"
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+int main (int argc, char ** argv) {
+  if (argc < 2) {
+    std::fprintf (stderr, "Usage: %s NAME\n", argv [0]);
+    return 1;
+  }
+  HPGETelemetryReader * reader = hpge_telemetry_open (argv [1]);
+  if (reader == nullptr) {
+    std::fprintf (stderr, "No telemetry named %s\n", argv [1]);
+    return 1;
+  }
+
+  const HPGETelemetryHeader * header = hpge_telemetry_header (reader);
+  std::printf ("Reading from process %llu, %u samples in the ring\n",
+	       (unsigned long long) header -> writer_pid, header -> capacity);
+
+  std::vector<HPGETelemetrySample> samples (header -> capacity);
+  while (true) {
+    std::this_thread::sleep_for (std::chrono::seconds (1));
+
+    uint64_t received = 0, lost = 0, missed;
+    int n;
+    double max_tick_us = 0.0;
+    while ((n = hpge_telemetry_read (reader, samples.data (),
+				     (int) samples.size (), &missed)) > 0 ||
+	   missed > 0) {
+      received += (uint64_t) n;
+      lost += missed;
+      for (int i = 0; i < n; ++i) {
+	if (samples [i].tick_us > max_tick_us) { max_tick_us = samples [i].tick_us; }
+      }
+    }
+
+    HPGETelemetrySample latest;
+    if (hpge_telemetry_latest (reader, &latest) != 0) {
+      std::printf ("Waiting for the haptic loop\n");
+      continue;
+    }
+    std::printf ("%llu samples/s (%llu lost), max tick %.1f us, "
+		 "position [%.4f %.4f %.4f], force [%.3f %.3f %.3f]\n",
+		 (unsigned long long) received, (unsigned long long) lost,
+		 max_tick_us,
+		 latest.position [0], latest.position [1], latest.position [2],
+		 latest.force [0], latest.force [1], latest.force [2]);
+  }
+
+  hpge_telemetry_close (reader);
+  return 0;
+}
@@ -0,0 +1,579 @@
+// Deterministic trajectory replay benchmark for the full haptic pipeline.
+//
+// A scene (meshes, primitives, materials and textures) is created
+// through the HPGE API, then the tool is driven along a recorded (or
+// generated) trajectory by a simulated device. Ticks are run back to
+// back in the calling thread, without the 1 kHz pacing of the haptic
+// thread, and the time spent in each stage of every tick is stored.
+//
+// Results (per-stage latency distribution, throughput and a checksum
+// of the rendered forces) are printed and written to a JSON file, so
+// that they can be compared between builds.
+//
+// Trajectories can be recorded with `stop_logging_and_save` (using
+// `init_logging` with device_coordinates enabled). Only the header
+// names are used, so any CSV file with `position_x`, `position_y`,
+// `position_z` columns (and optionally `velocity_*` and `buttons`)
+// works.
+
+#include "cxxopts.hpp"
+#include "HPGE.h"
+#include "chai3d.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Nominal period of the haptic loop, used to generate trajectories
+// and to estimate velocities when they are not recorded
+const double tickPeriod = 0.001;
+
+struct TrajectorySample {
+  chai3d::cVector3d position;
+  chai3d::cVector3d velocity;
+  unsigned int buttons;
+};
+
+// A haptic device that plays back a trajectory, one sample per tick.
+// Velocities come from the trajectory, so that the replay does not
+// depend on the wall clock
+class cReplayDevice : public chai3d::cGenericHapticDevice {
+public:
+  cReplayDevice (const std::vector<TrajectorySample> & samples)
+    : m_samples (samples), m_current (0) {
+    m_specifications.m_model = chai3d::C_HAPTIC_DEVICE_CUSTOM;
+    m_specifications.m_manufacturerName = "HPGE";
+    m_specifications.m_modelName = "ReplayDevice";
+    m_specifications.m_maxLinearForce = 8.0;
+    m_specifications.m_maxLinearStiffness = 3000.0;
+    m_specifications.m_maxLinearDamping = 20.0;
+    m_specifications.m_workspaceRadius = 0.1;
+    m_specifications.m_sensedPosition = true;
+    m_specifications.m_actuatedPosition = true;
+    m_deviceAvailable = true;
+  }
+
+  virtual bool open () { m_deviceReady = true; return (chai3d::C_SUCCESS); }
+  virtual bool close () { m_deviceReady = false; return (chai3d::C_SUCCESS); }
+
+  virtual bool getPosition (chai3d::cVector3d& a_position) {
+    a_position = m_samples [m_current].position;
+    return (m_deviceReady);
+  }
+  virtual bool getLinearVelocity (chai3d::cVector3d& a_linearVelocity) {
+    a_linearVelocity = m_samples [m_current].velocity;
+    return (m_deviceReady);
+  }
+  virtual bool getUserSwitches (unsigned int& a_userSwitches) {
+    a_userSwitches = m_samples [m_current].buttons;
+    return (m_deviceReady);
+  }
+  virtual bool setForceAndTorqueAndGripperForce (const chai3d::cVector3d& a_force,
+						 const chai3d::cVector3d& a_torque,
+						 double a_gripperForce) {
+    m_prevForce = a_force;
+    m_prevTorque = a_torque;
+    m_prevGripperForce = a_gripperForce;
+    return (m_deviceReady);
+  }
+
+  // Move to the next sample, wrapping around at the end
+  void step (void) {
+    m_current = (m_current + 1) % m_samples.size ();
+  }
+  void rewind (void) { m_current = 0; }
+
+private:
+  std::vector<TrajectorySample> m_samples;
+  size_t m_current;
+};
+
+////////////////////////////////////////////////////////////////////////
+// Trajectories
+////////////////////////////////////////////////////////////////////////
+
+void fillVelocities (std::vector<TrajectorySample> & samples) {
+  for (size_t i = 0; i < samples.size (); ++i) {
+    size_t next = std::min (i + 1, samples.size () - 1);
+    size_t prev = i > 0 ? i - 1 : 0;
+    double dt = (next - prev) * tickPeriod;
+    samples [i].velocity = dt > 0.0 ?
+      (samples [next].position - samples [prev].position) / dt :
+      chai3d::cVector3d (0.0, 0.0, 0.0);
+  }
+}
+
+// Generated trajectories, in device coordinates (meters). They
+// repeatedly press into the default scene
+std::vector<TrajectorySample> generateTrajectory (const std::string & kind,
+						  int length) {
+  std::vector<TrajectorySample> samples (length);
+  for (int i = 0; i < length; ++i) {
+    double t = i * tickPeriod;
+    chai3d::cVector3d p;
+    if (kind == "sweep") {
+      // back and forth across the scene, dipping into the objects
+      p.set (0.07 * sin (2.0 * M_PI * 0.25 * t),
+	     0.02 * sin (2.0 * M_PI * 1.5 * t),
+	     0.01 * cos (2.0 * M_PI * 0.5 * t));
+    } else if (kind == "spiral") {
+      double r = 0.01 + 0.06 * (0.5 + 0.5 * sin (2.0 * M_PI * 0.1 * t));
+      p.set (r * cos (2.0 * M_PI * 0.5 * t),
+	     r * sin (2.0 * M_PI * 0.5 * t),
+	     0.02 * sin (2.0 * M_PI * 0.2 * t));
+    } else { // circle
+      p.set (0.035 * cos (2.0 * M_PI * 0.5 * t),
+	     0.035 * sin (2.0 * M_PI * 0.5 * t),
+	     0.005 * sin (2.0 * M_PI * 3.0 * t));
+    }
+    samples [i].position = p;
+    // press the first button half of the time
+    samples [i].buttons = (i / 500) % 2;
+  }
+  fillVelocities (samples);
+  return samples;
+}
+
+std::vector<std::string> splitCSV (const std::string & line) {
+  std::vector<std::string> res;
+  std::stringstream ss (line);
+  std::string cell;
+  while (std::getline (ss, cell, ',')) {
+    res.push_back (cell);
+  }
+  return res;
+}
+
+// Returns an empty trajectory on failure
+std::vector<TrajectorySample> loadTrajectory (const std::string & filename) {
+  std::vector<TrajectorySample> samples;
+  std::ifstream input (filename);
+  std::string line;
+  if (!std::getline (input, line)) { return samples; }
+
+  auto header = splitCSV (line);
+  auto column = [&header] (const std::string & name) {
+    auto it = std::find (header.begin (), header.end (), name);
+    return it == header.end () ? -1 : static_cast<int> (it - header.begin ());
+  };
+  int pos [3] = { column ("position_x"), column ("position_y"),
+		  column ("position_z") };
+  int vel [3] = { column ("velocity_x"), column ("velocity_y"),
+		  column ("velocity_z") };
+  int buttons = column ("buttons");
+  if (pos [0] < 0 || pos [1] < 0 || pos [2] < 0) { return samples; }
+  bool hasVelocity = vel [0] >= 0 && vel [1] >= 0 && vel [2] >= 0;
+
+  while (std::getline (input, line)) {
+    auto cells = splitCSV (line);
+    int last = std::max (std::max (pos [0], pos [1]), pos [2]);
+    if (static_cast<int> (cells.size ()) <= last) { continue; }
+
+    TrajectorySample s { chai3d::cVector3d (0.0, 0.0, 0.0),
+			 chai3d::cVector3d (0.0, 0.0, 0.0), 0 };
+    s.position.set (std::stod (cells [pos [0]]),
+		    std::stod (cells [pos [1]]),
+		    std::stod (cells [pos [2]]));
+    if (hasVelocity &&
+	static_cast<int> (cells.size ()) > std::max (std::max (vel [0], vel [1]), vel [2])) {
+      s.velocity.set (std::stod (cells [vel [0]]),
+		      std::stod (cells [vel [1]]),
+		      std::stod (cells [vel [2]]));
+    }
+    s.buttons = (buttons >= 0 && static_cast<int> (cells.size ()) > buttons) ?
+      std::stoul (cells [buttons]) : 0;
+    samples.push_back (s);
+  }
+  if (!hasVelocity) { fillVelocities (samples); }
+  return samples;
+}
+
+////////////////////////////////////////////////////////////////////////
+// Scene
+////////////////////////////////////////////////////////////////////////
+
+struct MeshData {
+  std::vector<std::array<double, 3>> vertices;
+  std::vector<std::array<double, 3>> normals;
+  std::vector<std::array<double, 2>> uvs;
+  std::vector<std::array<int, 3>> triangles;
+
+  // `create_mesh_object` reverses the winding (left handed callers),
+  // so store them reversed
+  void addTriangle (int a, int b, int c) { triangles.push_back ({{ c, b, a }}); }
+};
+
+int createMesh (const MeshData & mesh, const double position [3],
+		const double scale [3]) {
+  double rotation [4] { 1.0, 0.0, 0.0, 0.0 };
+  return HPGE::create_mesh_object
+    (position, scale, rotation,
+     reinterpret_cast<const double (*) [3]> (mesh.vertices.data ()),
+     reinterpret_cast<const double (*) [3]> (mesh.normals.data ()),
+     mesh.vertices.size (),
+     reinterpret_cast<const int (*) [3]> (mesh.triangles.data ()),
+     mesh.triangles.size (),
+     mesh.uvs.size (),
+     reinterpret_cast<const double (*) [2]> (mesh.uvs.data ()));
+}
+
+// Unit UV sphere with `resolution` rings and 2 * `resolution` sectors
+MeshData sphereMesh (int resolution) {
+  MeshData m;
+  int rings = std::max (resolution, 3);
+  int sectors = 2 * rings;
+  for (int r = 0; r <= rings; ++r) {
+    double theta = M_PI * r / rings;
+    for (int s = 0; s <= sectors; ++s) {
+      double phi = 2.0 * M_PI * s / sectors;
+      std::array<double, 3> n {{ sin (theta) * cos (phi),
+				 sin (theta) * sin (phi),
+				 cos (theta) }};
+      m.vertices.push_back (n);
+      m.normals.push_back (n);
+      m.uvs.push_back ({{ (double)s / sectors, (double)r / rings }});
+    }
+  }
+  for (int r = 0; r < rings; ++r) {
+    for (int s = 0; s < sectors; ++s) {
+      int a = r * (sectors + 1) + s;
+      int b = a + sectors + 1;
+      m.addTriangle (a, b, a + 1);
+      m.addTriangle (a + 1, b, b + 1);
+    }
+  }
+  return m;
+}
+
+// Deterministic noisy height field on [-1, 1]^2
+MeshData terrainMesh (int resolution) {
+  MeshData m;
+  int n = std::max (resolution, 2);
+  for (int j = 0; j <= n; ++j) {
+    for (int i = 0; i <= n; ++i) {
+      double x = -1.0 + 2.0 * i / n;
+      double y = -1.0 + 2.0 * j / n;
+      double z = 0.05 * sin (7.0 * x) * cos (5.0 * y)
+	+ 0.02 * sin (31.0 * x + 17.0 * y);
+      m.vertices.push_back ({{ x, y, z }});
+      m.normals.push_back ({{ 0.0, 0.0, 1.0 }});
+      m.uvs.push_back ({{ (double)i / n, (double)j / n }});
+    }
+  }
+  for (int j = 0; j < n; ++j) {
+    for (int i = 0; i < n; ++i) {
+      int a = j * (n + 1) + i;
+      int b = a + n + 1;
+      m.addTriangle (a, a + 1, b);
+      m.addTriangle (a + 1, b + 1, b);
+    }
+  }
+  return m;
+}
+
+// Load every mesh in a file supported by chai3d (obj, 3ds, stl)
+std::vector<MeshData> fileMeshes (const std::string & filename) {
+  std::vector<MeshData> res;
+  chai3d::cMultiMesh multimesh;
+  if (!multimesh.loadFromFile (filename)) { return res; }
+
+  for (int k = 0; k < multimesh.getNumMeshes (); ++k) {
+    chai3d::cMesh * mesh = multimesh.getMesh (k);
+    MeshData m;
+    unsigned int vertices = mesh -> m_vertices -> getNumElements ();
+    for (unsigned int i = 0; i < vertices; ++i) {
+      auto p = mesh -> m_vertices -> getLocalPos (i);
+      auto n = mesh -> m_vertices -> getNormal (i);
+      auto uv = mesh -> m_vertices -> getTexCoord (i);
+      m.vertices.push_back ({{ p.x (), p.y (), p.z () }});
+      m.normals.push_back ({{ n.x (), n.y (), n.z () }});
+      m.uvs.push_back ({{ uv.x (), uv.y () }});
+    }
+    unsigned int triangles = mesh -> m_triangles -> getNumElements ();
+    for (unsigned int i = 0; i < triangles; ++i) {
+      if (!mesh -> m_triangles -> getAllocated (i)) { continue; }
+      m.addTriangle (mesh -> m_triangles -> getVertexIndex0 (i),
+		     mesh -> m_triangles -> getVertexIndex1 (i),
+		     mesh -> m_triangles -> getVertexIndex2 (i));
+    }
+    res.push_back (m);
+  }
+  return res;
+}
+
+std::vector<float> checkerTexture (unsigned int size) {
+  std::vector<float> pixels (size * size);
+  for (unsigned int y = 0; y < size; ++y) {
+    for (unsigned int x = 0; x < size; ++x) {
+      pixels [y * size + x] = 0.5f + 0.25f * sin (x * 0.3) * cos (y * 0.2)
+	+ ((((x / 8) + (y / 8)) % 2) ? 0.2f : -0.2f);
+    }
+  }
+  return pixels;
+}
+
+int material (int objectId, double viscosity, double magnet,
+	      double stickslip, double vibration) {
+  return HPGE::set_object_material (objectId,
+				    0.5,       // stiffness
+				    1,         // surface
+				    0.3, 0.2,  // friction
+				    magnet, magnet > 0.0 ? 0.2 : 0.0,
+				    viscosity,
+				    0.02,      // texture level
+				    stickslip, stickslip > 0.0 ? 0.5 : 0.0,
+				    vibration, vibration > 0.0 ? 0.5 : 0.0);
+}
+
+// Returns false if some object could not be created
+bool createScene (int resolution, int primitives, unsigned int textureSize,
+		  bool vibration, const std::vector<std::string> & files) {
+  std::vector<int> ids;
+  auto texture = checkerTexture (textureSize);
+
+  // A textured sphere mesh in the center, on top of a terrain
+  double center [3] { 0.0, 0.0, 0.0 };
+  double sphereScale [3] { 0.4, 0.4, 0.4 };
+  int sphere = createMesh (sphereMesh (resolution), center, sphereScale);
+  ids.push_back (sphere);
+  if (material (sphere, 0.0, 0.0, 0.0, 0.0) != HPGE::SUCCESS ||
+      HPGE::set_object_texture (sphere, textureSize, textureSize,
+				texture.data (), 1) != HPGE::SUCCESS) {
+    return false;
+  }
+
+  double below [3] { 0.0, 0.0, -0.35 };
+  double terrainScale [3] { 1.0, 1.0, 1.0 };
+  int terrain = createMesh (terrainMesh (resolution), below, terrainScale);
+  ids.push_back (terrain);
+  if (material (terrain, 0.2, 0.0, 0.5, 0.0) != HPGE::SUCCESS) {
+    return false;
+  }
+
+  // Primitives in a ring around the mesh, cycling through effects
+  double rotation [4] { 1.0, 0.0, 0.0, 0.0 };
+  for (int i = 0; i < primitives; ++i) {
+    double angle = 2.0 * M_PI * i / primitives;
+    double position [3] { 0.6 * cos (angle), 0.6 * sin (angle), 0.0 };
+    int obj;
+    if (i % 2 == 0) {
+      obj = HPGE::create_sphere_object (0.08, position, rotation);
+    } else {
+      double scale [3] { 0.12, 0.12, 0.12 };
+      obj = HPGE::create_box_object (scale, position, rotation);
+    }
+    ids.push_back (obj);
+    int res = material (obj,
+			i % 4 == 1 ? 0.5 : 0.0,
+			i % 4 == 2 ? 0.5 : 0.0,
+			i % 4 == 3 ? 0.5 : 0.0,
+			(vibration && i % 4 == 0) ? 50.0 : 0.0);
+    if (res != HPGE::SUCCESS) { return false; }
+  }
+
+  for (auto & file : files) {
+    auto meshes = fileMeshes (file);
+    if (meshes.empty ()) {
+      std::cerr << "Could not load " << file << "\n";
+      return false;
+    }
+    for (auto & m : meshes) {
+      int obj = createMesh (m, center, terrainScale);
+      ids.push_back (obj);
+      if (material (obj, 0.0, 0.0, 0.0, 0.0) != HPGE::SUCCESS) {
+	return false;
+      }
+    }
+  }
+
+  for (auto id : ids) {
+    if (id < 0 || HPGE::add_object_to_world (id) != HPGE::SUCCESS) {
+      return false;
+    }
+  }
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////
+// Statistics
+////////////////////////////////////////////////////////////////////////
+
+struct Stats {
+  double min, mean, p50, p90, p99, p999, max;
+};
+
+// Values are in seconds, stats in microseconds
+Stats computeStats (std::vector<double> values) {
+  Stats s { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+  if (values.empty ()) { return s; }
+  std::sort (values.begin (), values.end ());
+  auto percentile = [&values] (double p) {
+    size_t idx = static_cast<size_t> (p * (values.size () - 1) + 0.5);
+    return values [idx] * 1e6;
+  };
+  double sum = 0.0;
+  for (auto v : values) { sum += v; }
+  s.min = values.front () * 1e6;
+  s.mean = sum / values.size () * 1e6;
+  s.p50 = percentile (0.5);
+  s.p90 = percentile (0.9);
+  s.p99 = percentile (0.99);
+  s.p999 = percentile (0.999);
+  s.max = values.back () * 1e6;
+  return s;
+}
+
+std::ostream& operator<<(std::ostream& os, const Stats& s) {
+  os << "{ \"min\": " << s.min << ", \"mean\": " << s.mean
+     << ", \"p50\": " << s.p50 << ", \"p90\": " << s.p90
+     << ", \"p99\": " << s.p99 << ", \"p999\": " << s.p999
+     << ", \"max\": " << s.max << " }";
+  return os;
+}
+
+int main (int argc, char * argv []) {
+  cxxopts::Options options ("benchmark-replay",
+			    "Replay a trajectory through the haptic pipeline");
+  options.add_options ()
+    ("t,trajectory", "CSV trajectory (device coordinates) to replay",
+     cxxopts::value<std::string> ())
+    ("g,generate", "Generated trajectory if none is given: circle, sweep, spiral",
+     cxxopts::value<std::string> ()->default_value ("circle"))
+    ("n,ticks", "Measured ticks", cxxopts::value<int> ()->default_value ("20000"))
+    ("w,warmup", "Ticks run before measuring", cxxopts::value<int> ()->default_value ("1000"))
+    ("r,resolution", "Resolution of the generated meshes",
+     cxxopts::value<int> ()->default_value ("64"))
+    ("p,primitives", "Number of primitive objects", cxxopts::value<int> ()->default_value ("16"))
+    ("texture", "Texture size (pixels)", cxxopts::value<int> ()->default_value ("256"))
+    ("m,mesh", "Additional mesh file(s) to load", cxxopts::value<std::vector<std::string>> ())
+    ("vibration", "Add vibration effects (uses the wall clock: the force checksum is not reproducible)")
+    ("radius", "Tool radius", cxxopts::value<double> ()->default_value ("0.02"))
+    ("o,output", "JSON output file", cxxopts::value<std::string> ()->default_value ("benchmark-replay.json"))
+    ("h,help", "Print help");
+
+  try {
+    options.parse (argc, argv);
+  } catch (const cxxopts::OptionException & e) {
+    std::cerr << e.what () << "\n";
+    return 1;
+  }
+  if (options.count ("help")) {
+    std::cout << options.help () << "\n";
+    return 0;
+  }
+
+  const int ticks = options ["ticks"].as<int> ();
+  const int warmup = options ["warmup"].as<int> ();
+  std::string trajectoryName;
+  std::vector<TrajectorySample> trajectory;
+  if (options.count ("trajectory")) {
+    trajectoryName = options ["trajectory"].as<std::string> ();
+    trajectory = loadTrajectory (trajectoryName);
+  } else {
+    trajectoryName = options ["generate"].as<std::string> ();
+    trajectory = generateTrajectory (trajectoryName, ticks + warmup);
+  }
+  if (trajectory.empty () || ticks <= 0 || warmup < 0) {
+    std::cerr << "Invalid trajectory or number of ticks\n";
+    return 1;
+  }
+
+  std::vector<std::string> files;
+  if (options.count ("mesh")) {
+    files = options ["mesh"].as<std::vector<std::string>> ();
+  }
+
+  auto device = std::make_shared<cReplayDevice> (trajectory);
+  int res = HPGE::debug::initializeWithDevice (device, 1.0,
+					       options ["radius"].as<double> ());
+  if (res != HPGE::SUCCESS) {
+    std::cerr << "Could not initialize: " << HPGE::ErrorMsgStrings.at (res) << "\n";
+    return 1;
+  }
+
+  if (!createScene (options ["resolution"].as<int> (),
+		    options ["primitives"].as<int> (),
+		    options ["texture"].as<int> (),
+		    options.count ("vibration") > 0, files)) {
+    std::cerr << "Could not create the scene\n";
+    HPGE::deinitialize ();
+    return 1;
+  }
+
+  for (int i = 0; i < warmup; ++i) {
+    HPGE::debug::runTick (nullptr);
+    device -> step ();
+  }
+
+  const char * stageNames [] = { "interpolation", "hook", "global_positions",
+				 "device", "interactions", "apply",
+				 "logging", "total" };
+  const int stagesNum = sizeof (stageNames) / sizeof (stageNames [0]);
+  std::vector<std::vector<double>> stages (stagesNum,
+					   std::vector<double> (ticks));
+  // Sum of the force magnitudes: changes if the rendering changes
+  double forceChecksum = 0.0;
+
+  auto begin = std::chrono::steady_clock::now ();
+  for (int i = 0; i < ticks; ++i) {
+    HPGE::TickProfile p;
+    HPGE::debug::runTick (&p);
+    device -> step ();
+
+    double force [3];
+    HPGE::get_tool_force (force);
+    forceChecksum += sqrt (force [0] * force [0] + force [1] * force [1]
+			   + force [2] * force [2]);
+
+    stages [0] [i] = p.interpolation;
+    stages [1] [i] = p.hook;
+    stages [2] [i] = p.global_positions;
+    stages [3] [i] = p.device;
+    stages [4] [i] = p.interactions;
+    stages [5] [i] = p.apply;
+    stages [6] [i] = p.logging;
+    stages [7] [i] = p.interpolation + p.hook + p.global_positions
+      + p.device + p.interactions + p.apply + p.logging;
+  }
+  double wall = std::chrono::duration<double>
+    (std::chrono::steady_clock::now () - begin).count ();
+
+  HPGE::deinitialize ();
+
+  std::ofstream output (options ["output"].as<std::string> ());
+  output << std::setprecision (10);
+  output << "{\n"
+	 << "  \"benchmark\": \"replay\",\n"
+	 << "  \"trajectory\": \"" << trajectoryName << "\",\n"
+	 << "  \"ticks\": " << ticks << ",\n"
+	 << "  \"warmup\": " << warmup << ",\n"
+	 << "  \"resolution\": " << options ["resolution"].as<int> () << ",\n"
+	 << "  \"primitives\": " << options ["primitives"].as<int> () << ",\n"
+	 << "  \"wall_time_s\": " << wall << ",\n"
+	 << "  \"ticks_per_second\": " << ticks / wall << ",\n"
+	 << "  \"force_checksum\": " << forceChecksum << ",\n"
+	 << "  \"stages_us\": {\n";
+  std::cout << std::fixed << std::setprecision (2)
+	    << "ticks: " << ticks << ", throughput: " << ticks / wall
+	    << " ticks/s, force checksum: " << forceChecksum << "\n"
+	    << std::setw (18) << "stage [us]" << std::setw (10) << "mean"
+	    << std::setw (10) << "p50" << std::setw (10) << "p99"
+	    << std::setw (10) << "p99.9" << std::setw (10) << "max" << "\n";
+  for (int s = 0; s < stagesNum; ++s) {
+    Stats st = computeStats (stages [s]);
+    output << "    \"" << stageNames [s] << "\": " << st
+	   << (s + 1 < stagesNum ? ",\n" : "\n");
+    std::cout << std::setw (18) << stageNames [s] << std::setw (10) << st.mean
+	      << std::setw (10) << st.p50 << std::setw (10) << st.p99
+	      << std::setw (10) << st.p999 << std::setw (10) << st.max << "\n";
+  }
+  output << "  }\n}\n";
+
+  return 0;
+}
@@ -0,0 +1,62 @@
+#include "catch.hpp"
+#include "HPGE.h"
+#include <chrono>
+#include <thread>
+
+SCENARIO( "We want to know which objects the tool touches", "[contacts]" ) {
+  GIVEN( "The device is initilized" ) {
+    HPGE::initialize(-1, 10.0, 10.0);
+    ContactEvent events [64];
+
+    WHEN( "We give invalid parameters" ) {
+      THEN( "The calls fail" ) {
+	REQUIRE( HPGE::get_contact_events (-1, events) == -1 );
+	REQUIRE( HPGE::get_contacts (4, nullptr) == -1 );
+	REQUIRE( HPGE::set_contact_persist_interval (-1) == HPGE::INVALID_PARAMS );
+      }
+    }
+    WHEN( "The tool is inside a sphere" ) {
+      double position [3] {0.0, 0.0, 0.0};
+      double rotation [4] {1.0, 0.0, 0.0, 0.0};
+      int sphere = HPGE::create_sphere_object (1.0, position, rotation);
+      REQUIRE( HPGE::set_object_material (sphere, 1.0, 1, 0.0, 0.0, 0.0, 0.0,
+					   0.0, 0.0, 0.0, 0.0, 0.0, 0.0) == HPGE::SUCCESS );
+      REQUIRE( HPGE::add_object_to_world (sphere) == HPGE::SUCCESS );
+      REQUIRE( HPGE::set_contact_persist_interval (0) == HPGE::SUCCESS );
+      HPGE::start ();
+      std::this_thread::sleep_for (std::chrono::milliseconds (50));
+
+      THEN( "A begin event and a contact are reported" ) {
+	REQUIRE( HPGE::get_contact_events (64, events) == 1 );
+	REQUIRE( events [0].type == HPGE::CONTACT_BEGIN );
+	REQUIRE( events [0].object == sphere );
+	REQUIRE( HPGE::get_contact_events (64, events) == 0 );
+	REQUIRE( HPGE::get_contacts (64, events) == 1 );
+	REQUIRE( events [0].object == sphere );
+      }
+      AND_WHEN( "The sphere moves away" ) {
+	double away [3] {10.0, 0.0, 0.0};
+	HPGE::set_object_position (sphere, away);
+	std::this_thread::sleep_for (std::chrono::milliseconds (50));
+	THEN( "The contact ends" ) {
+	  REQUIRE( HPGE::get_contact_events (64, events) == 2 );
+	  REQUIRE( events [1].type == HPGE::CONTACT_END );
+	  REQUIRE( events [1].object == sphere );
+	  REQUIRE( HPGE::get_contacts (64, events) == 0 );
+	}
+      }
+      AND_WHEN( "Persist events are enabled" ) {
+	HPGE::get_contact_events (64, events);
+	HPGE::set_contact_persist_interval (1);
+	std::this_thread::sleep_for (std::chrono::milliseconds (20));
+	THEN( "They are queued while the contact lasts" ) {
+	  int n = HPGE::get_contact_events (64, events);
+	  REQUIRE( n > 5 );
+	  REQUIRE( events [n - 1].type == HPGE::CONTACT_PERSIST );
+	}
+      }
+      HPGE::stop ();
+    }
+    HPGE::deinitialize ();
+  }
+}
@@ -0,0 +1,99 @@
+#include "catch.hpp"
+#include "HPGE.h"
+#include <chrono>
+#include <thread>
+
+// Closed cube of side 2 centered in the origin
+static const double cubeVertices [8] [3] {
+  {-1, -1, -1}, {1, -1, -1}, {1, 1, -1}, {-1, 1, -1},
+  {-1, -1, 1}, {1, -1, 1}, {1, 1, 1}, {-1, 1, 1}
+};
+static const double cubeNormals [8] [3] {};
+static const int cubeTriangles [12] [3] {
+  {0, 3, 2}, {0, 2, 1}, {4, 5, 6}, {4, 6, 7},
+  {0, 1, 5}, {0, 5, 4}, {2, 3, 7}, {2, 7, 6},
+  {1, 2, 6}, {1, 6, 5}, {0, 4, 7}, {0, 7, 3}
+};
+
+// The same cube, with the center of the top face pushed down
+static const double dentedVertices [9] [3] {
+  {-1, -1, -1}, {1, -1, -1}, {1, 1, -1}, {-1, 1, -1},
+  {-1, -1, 1}, {1, -1, 1}, {1, 1, 1}, {-1, 1, 1}, {0, 0, 0.5}
+};
+static const double dentedNormals [9] [3] {};
+static const int dentedTriangles [14] [3] {
+  {0, 3, 2}, {0, 2, 1}, {4, 5, 8}, {5, 6, 8}, {6, 7, 8}, {7, 4, 8},
+  {0, 1, 5}, {0, 5, 4}, {2, 3, 7}, {2, 7, 6},
+  {1, 2, 6}, {1, 6, 5}, {0, 4, 7}, {0, 7, 3}
+};
+
+// Starts the haptic loop with the object in the world and returns
+// how many contacts the tool has
+static int contactsWith (const int object) {
+  HPGE::set_object_material (object, 1.0, 1, 0.0, 0.0, 0.0, 0.0,
+			     0.0, 0.0, 0.0, 0.0, 0.0, 0.0);
+  HPGE::add_object_to_world (object);
+  HPGE::start ();
+  std::this_thread::sleep_for (std::chrono::milliseconds (50));
+  ContactEvent events [8];
+  int contacts = HPGE::get_contacts (8, events);
+  HPGE::stop ();
+  return contacts;
+}
+
+SCENARIO( "We want collisions with convex props that do not depend on their triangles", "[convex]" ) {
+  double position [3] {0.0, 0.0, 0.0};
+  double scale [3] {1.0, 1.0, 1.0};
+  double rotation [4] {1.0, 0.0, 0.0, 0.0};
+
+  GIVEN( "The device is not initialized" ) {
+    THEN( "No object is created" ) {
+      REQUIRE( HPGE::create_convex_object (position, scale, rotation,
+					    cubeVertices, 8) == -1 );
+    }
+  }
+  GIVEN( "The device is initilized" ) {
+    HPGE::initialize(-1, 10.0, 10.0);
+
+    WHEN( "We give too few or flat points" ) {
+      const double flat [4] [3] {{0, 0, 0}, {1, 0, 0}, {0, 1, 0}, {1, 1, 0}};
+      THEN( "The calls fail" ) {
+	REQUIRE( HPGE::create_convex_object (position, scale, rotation,
+					      cubeVertices, 3) == -1 );
+	REQUIRE( HPGE::create_convex_object (position, scale, rotation,
+					      nullptr, 8) == -1 );
+	REQUIRE( HPGE::create_convex_object (position, scale, rotation,
+					      flat, 4) == -1 );
+      }
+    }
+    WHEN( "The tool is inside a convex cube" ) {
+      int cube = HPGE::create_convex_object (position, scale, rotation,
+					     cubeVertices, 8);
+      REQUIRE( cube >= 0 );
+      REQUIRE( HPGE::object_exists (cube) == HPGE::SUCCESS );
+      THEN( "The tool touches it" ) {
+	REQUIRE( contactsWith (cube) == 1 );
+      }
+    }
+    WHEN( "Convexity detection is enabled" ) {
+      REQUIRE( HPGE::set_mesh_convexity_detection (1) == HPGE::SUCCESS );
+
+      THEN( "A convex mesh becomes a convex object, touched from inside" ) {
+	int cube = HPGE::create_mesh_object (position, scale, rotation,
+					     cubeVertices, cubeNormals, 8,
+					     cubeTriangles, 12, 0, nullptr);
+	REQUIRE( cube >= 0 );
+	REQUIRE( contactsWith (cube) == 1 );
+      }
+      THEN( "A concave mesh stays a mesh, not touched from inside" ) {
+	int dented = HPGE::create_mesh_object (position, scale, rotation,
+					       dentedVertices, dentedNormals, 9,
+					       dentedTriangles, 14, 0, nullptr);
+	REQUIRE( dented >= 0 );
+	REQUIRE( contactsWith (dented) == 0 );
+      }
+      REQUIRE( HPGE::set_mesh_convexity_detection (0) == HPGE::SUCCESS );
+    }
+    HPGE::deinitialize ();
+  }
+}
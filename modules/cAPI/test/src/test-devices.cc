@@ -0,0 +1,51 @@
+#include "catch.hpp"
+#include "HPGE.h"
+#include "chai3d.h"
+#include <chrono>
+#include <thread>
+
+SCENARIO( "Devices are scanned once and cached", "[devices]" ) {
+  GIVEN( "The devices have been counted" ) {
+    int devs = HPGE::count_devices ();
+    REQUIRE( devs >= 1 ); // the mock device always exists
+    int version = HPGE::get_device_list_version ();
+    REQUIRE( version >= 1 );
+
+    WHEN( "We query the mock device" ) {
+      char name [256];
+      DeviceSpecs specs;
+      THEN( "Name and specifications come from the cache" ) {
+	REQUIRE( HPGE::get_device_name (-1, sizeof (name), name) == HPGE::SUCCESS );
+	REQUIRE( HPGE::get_device_name (-1, 1, name) == HPGE::BUFFER_TOO_SMALL );
+	REQUIRE( HPGE::get_device_specs (-1, &specs) == HPGE::SUCCESS );
+	REQUIRE( specs.max_force > 0.0 );
+	REQUIRE( HPGE::get_device_name (devs - 1, sizeof (name), name) == HPGE::DEVICE_NOT_FOUND );
+	REQUIRE( HPGE::get_device_specs (-2, &specs) == HPGE::DEVICE_NOT_FOUND );
+      }
+    }
+    WHEN( "We rescan" ) {
+      THEN( "The same devices are found" ) {
+	REQUIRE( HPGE::rescan_devices () == devs );
+	REQUIRE( HPGE::get_device_list_version () == version );
+      }
+    }
+    WHEN( "A device is initialized" ) {
+      REQUIRE( HPGE::initialize (-1, 1.0, 0.05) == HPGE::SUCCESS );
+      THEN( "The cache is still readable, but can't be scanned" ) {
+	REQUIRE( HPGE::count_devices () == devs );
+	REQUIRE( HPGE::rescan_devices () == -1 );
+      }
+      HPGE::deinitialize ();
+    }
+    WHEN( "The background scanner runs" ) {
+      REQUIRE( HPGE::start_device_scanner (1) == HPGE::SUCCESS );
+      std::this_thread::sleep_for (std::chrono::milliseconds (20));
+      THEN( "It cannot be started twice, and can be stopped once" ) {
+	REQUIRE( HPGE::start_device_scanner (1) == HPGE::ALREADY_RUNNING );
+	REQUIRE( HPGE::count_devices () == devs );
+	REQUIRE( HPGE::stop_device_scanner () == HPGE::SUCCESS );
+	REQUIRE( HPGE::stop_device_scanner () == HPGE::THREAD_NOT_RUNNING );
+      }
+    }
+  }
+}
@@ -0,0 +1,103 @@
+#include "catch.hpp"
+#include "HPGE.h"
+#include "chai3d.h"
+#include <atomic>
+#include <thread>
+#include <chrono>
+
+SCENARIO( "We want to render a native force field", "[forcefield]" ) {
+  GIVEN( "The device is initilized" ) {
+    HPGE::initialize(-1, 10.0, 10.0);
+    double pos [3] {1.0, 2.0, 3.0};
+    double vel [3] {10.0, 20.0, 30.0};
+    double frc [3];
+
+    WHEN( "No term is added" ) {
+      THEN( "The force field is not run" ) {
+	REQUIRE( HPGE::debug::run_force_field (pos, vel, 0, frc) == false );
+	REQUIRE( frc [0] == 0.0 );
+      }
+    }
+    WHEN( "We add a spring and a damper" ) {
+      double anchor [3] {0.0, 0.0, 0.0};
+      int spring = HPGE::force_field_add_term (HPGE::FORCE_TERM_SPRING, anchor, 2.0);
+      int damper = HPGE::force_field_add_term (HPGE::FORCE_TERM_DAMPER, anchor, 0.5);
+      REQUIRE( spring == 0 );
+      REQUIRE( damper == 1 );
+
+      THEN( "The force is the sum of the terms" ) {
+	REQUIRE( HPGE::debug::run_force_field (pos, vel, 0, frc) );
+	for (int i = 0; i < 3; ++i) {
+	  REQUIRE( frc [i] == Approx (-2.0 * pos [i] - 0.5 * vel [i]) );
+	}
+      }
+      AND_WHEN( "We update the parameters" ) {
+	double moved [3] {1.0, 1.0, 1.0};
+	REQUIRE( HPGE::force_field_set_term (spring, moved, 1.0) == HPGE::SUCCESS );
+	REQUIRE( HPGE::force_field_set_term (damper, moved, 0.0) == HPGE::SUCCESS );
+	THEN( "The next evaluation uses them" ) {
+	  REQUIRE( HPGE::debug::run_force_field (pos, vel, 0, frc) );
+	  for (int i = 0; i < 3; ++i) {
+	    REQUIRE( frc [i] == Approx (moved [i] - pos [i]) );
+	  }
+	}
+      }
+      AND_WHEN( "The spring requires a button" ) {
+	REQUIRE( HPGE::force_field_set_button_condition (spring, 1, 1) == HPGE::SUCCESS );
+	THEN( "It is active only while the button is pressed" ) {
+	  REQUIRE( HPGE::debug::run_force_field (pos, vel, 0, frc) );
+	  REQUIRE( frc [0] == Approx (-0.5 * vel [0]) );
+	  REQUIRE( HPGE::debug::run_force_field (pos, vel, 1, frc) );
+	  REQUIRE( frc [0] == Approx (-2.0 * pos [0] - 0.5 * vel [0]) );
+	}
+      }
+      AND_WHEN( "The damper is limited to a region" ) {
+	double center [3] {0.0, 0.0, 0.0};
+	double size [3] {1.0, 1.0, 1.0};
+	REQUIRE( HPGE::force_field_set_region (damper, HPGE::FORCE_REGION_BOX,
+					       center, size, 1) == HPGE::SUCCESS );
+	THEN( "It is not active outside of it" ) {
+	  REQUIRE( HPGE::debug::run_force_field (pos, vel, 0, frc) );
+	  REQUIRE( frc [0] == Approx (-2.0 * pos [0]) );
+	}
+      }
+      AND_WHEN( "We use an invalid term" ) {
+	int res = HPGE::force_field_set_term (10, anchor, 1.0);
+	THEN( "The update fails" ) {
+	  REQUIRE( res == HPGE::FORCE_TERM_NOT_FOUND );
+	}
+      }
+      HPGE::force_field_clear ();
+    }
+    WHEN( "We add a term of an unknown type" ) {
+      double vector [3] {0.0, 0.0, 1.0};
+      THEN( "No term is added" ) {
+	REQUIRE( HPGE::force_field_add_term (42, vector, 1.0) == -1 );
+	REQUIRE( HPGE::debug::run_force_field (pos, vel, 0, frc) == false );
+      }
+    }
+    HPGE::deinitialize ();
+  }
+}
+
+SCENARIO( "We want a force field in the main loop", "[forcefield]" ) {
+  GIVEN( "The device is initilized and started" ) {
+    HPGE::initialize(-1, 10.0, 10.0);
+    HPGE::start ();
+    WHEN( "A constant force is added and updated while running" ) {
+      double vector [3] {0.0, 0.0, 1.0};
+      int term = HPGE::force_field_add_term (HPGE::FORCE_TERM_CONSTANT, vector, 0.0);
+      REQUIRE( term == 0 );
+      THEN( "Updates do not fail" ) {
+	for (int i = 0; i < 1000; ++i) {
+	  REQUIRE( HPGE::force_field_set_term (term, vector, 0.001 * (i % 10))
+		   == HPGE::SUCCESS );
+	}
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	REQUIRE( HPGE::get_loops () > 0 );
+      }
+    }
+    HPGE::stop ();
+    HPGE::deinitialize ();
+  }
+}
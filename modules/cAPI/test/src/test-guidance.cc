@@ -0,0 +1,109 @@
+#include "catch.hpp"
+#include "HPGE.h"
+#include "chai3d.h"
+#include <cmath>
+#include <vector>
+
+SCENARIO( "We want to guide the tool with constraints", "[guidance]" ) {
+  GIVEN( "The device is initilized" ) {
+    HPGE::initialize(-1, 10.0, 10.0);
+    double vel [3] {0.0, 0.0, 0.0};
+    double frc [3];
+    double origin [3] {0.0, 0.0, 0.0};
+    double zAxis [3] {0.0, 0.0, 2.0}; // normalized when set
+
+    WHEN( "No constraint exists" ) {
+      double pos [3] {1.0, 2.0, 3.0};
+      THEN( "No force is added" ) {
+	REQUIRE( HPGE::debug::run_guidance (pos, vel, frc) == false );
+      }
+    }
+    WHEN( "We create a line constraint" ) {
+      int line = HPGE::create_guidance_constraint (HPGE::GUIDANCE_LINE);
+      REQUIRE( line >= 0 );
+      REQUIRE( HPGE::set_guidance_constraint_gains (line, 100.0, 0.0, 0.0) == HPGE::SUCCESS );
+      REQUIRE( HPGE::set_guidance_constraint_geometry (line, origin, zAxis, 0.0) == HPGE::SUCCESS );
+      THEN( "The tool is pulled to the line" ) {
+	double pos [3] {0.01, -0.02, 5.0};
+	REQUIRE( HPGE::debug::run_guidance (pos, vel, frc) );
+	REQUIRE( frc [0] == Approx (-1.0) );
+	REQUIRE( frc [1] == Approx (2.0) );
+	REQUIRE( frc [2] == Approx (0.0) );
+      }
+      AND_WHEN( "The force is saturated" ) {
+	REQUIRE( HPGE::set_guidance_constraint_gains (line, 100.0, 0.0, 0.5) == HPGE::SUCCESS );
+	THEN( "Its magnitude is limited" ) {
+	  double pos [3] {0.0, 0.02, 0.0};
+	  REQUIRE( HPGE::debug::run_guidance (pos, vel, frc) );
+	  REQUIRE( frc [1] == Approx (-0.5) );
+	}
+      }
+      AND_WHEN( "The constraint is removed" ) {
+	REQUIRE( HPGE::remove_guidance_constraint (line) == HPGE::SUCCESS );
+	THEN( "It cannot be removed twice" ) {
+	  REQUIRE( HPGE::remove_guidance_constraint (line) == HPGE::GUIDANCE_NOT_FOUND );
+	}
+      }
+    }
+    WHEN( "We create a path constraint" ) {
+      // zig-zag in the xy plane
+      std::vector<double> points;
+      for (int i = 0; i < 101; ++i) {
+	points.push_back (0.01 * i);
+	points.push_back (i % 2 == 0 ? 0.0 : 0.01);
+	points.push_back (0.0);
+      }
+      int path = HPGE::create_guidance_constraint (HPGE::GUIDANCE_PATH);
+      REQUIRE( HPGE::set_guidance_constraint_gains (path, 10.0, 0.0, 0.0) == HPGE::SUCCESS );
+      REQUIRE( HPGE::set_guidance_constraint_path (path, points.data (), 101) == HPGE::SUCCESS );
+      THEN( "The tool is pulled to the nearest point" ) {
+	// above the vertex (0.55, 0.01, 0)
+	double pos [3] {0.55, 0.01, 0.1};
+	REQUIRE( HPGE::debug::run_guidance (pos, vel, frc) );
+	REQUIRE( frc [0] == Approx (0.0).margin (1e-12) );
+	REQUIRE( frc [1] == Approx (0.0).margin (1e-12) );
+	REQUIRE( frc [2] == Approx (-1.0) );
+      }
+      THEN( "The nearest segment is kept when the gains change" ) {
+	double pos [3] {0.55, 0.01, 0.1};
+	REQUIRE( HPGE::debug::run_guidance (pos, vel, frc) );
+	int hint = HPGE::debug::guidance_path_hint (path);
+	REQUIRE( (hint == 54 || hint == 55) );
+	REQUIRE( HPGE::set_guidance_constraint_gains (path, 20.0, 0.0, 0.0) == HPGE::SUCCESS );
+	REQUIRE( HPGE::debug::guidance_path_hint (path) == hint );
+	REQUIRE( HPGE::debug::run_guidance (pos, vel, frc) );
+	REQUIRE( frc [2] == Approx (-2.0) );
+	REQUIRE( HPGE::set_guidance_constraint_path (path, points.data (), 101) == HPGE::SUCCESS );
+	REQUIRE( HPGE::debug::guidance_path_hint (path) == 0 );
+      }
+      HPGE::remove_guidance_constraint (path);
+    }
+    WHEN( "We create a cone constraint" ) {
+      int cone = HPGE::create_guidance_constraint (HPGE::GUIDANCE_CONE);
+      REQUIRE( HPGE::set_guidance_constraint_gains (cone, 1.0, 0.0, 0.0) == HPGE::SUCCESS );
+      REQUIRE( HPGE::set_guidance_constraint_geometry (cone, origin, zAxis, M_PI / 4.0) == HPGE::SUCCESS );
+      THEN( "The tool is free inside and pulled back from outside" ) {
+	double inside [3] {0.5, 0.0, 1.0};
+	REQUIRE( HPGE::debug::run_guidance (inside, vel, frc) );
+	REQUIRE( frc [0] == 0.0 );
+	double outside [3] {2.0, 0.0, 0.0};
+	REQUIRE( HPGE::debug::run_guidance (outside, vel, frc) );
+	REQUIRE( frc [0] == Approx (-1.0) );
+	REQUIRE( frc [2] == Approx (1.0) );
+      }
+      HPGE::remove_guidance_constraint (cone);
+    }
+    WHEN( "We give invalid parameters" ) {
+      THEN( "The calls fail" ) {
+	REQUIRE( HPGE::create_guidance_constraint (42) == -1 );
+	REQUIRE( HPGE::set_guidance_constraint_gains (1000, 1.0, 0.0, 0.0) == HPGE::GUIDANCE_NOT_FOUND );
+	int segment = HPGE::create_guidance_constraint (HPGE::GUIDANCE_SEGMENT);
+	double points [9] {0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 2.0, 0.0, 0.0};
+	REQUIRE( HPGE::set_guidance_constraint_path (segment, points, 3) == HPGE::INVALID_PARAMS );
+	REQUIRE( HPGE::set_guidance_constraint_path (segment, points, 2) == HPGE::SUCCESS );
+	HPGE::remove_guidance_constraint (segment);
+      }
+    }
+    HPGE::deinitialize ();
+  }
+}
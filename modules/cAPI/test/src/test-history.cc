@@ -0,0 +1,58 @@
+#include "catch.hpp"
+#include "HPGE.h"
+#include <chrono>
+#include <thread>
+#include <vector>
+
+SCENARIO( "We want every tick of the tool state", "[history]" ) {
+  GIVEN( "The device is initilized" ) {
+    HPGE::initialize(-1, 10.0, 10.0);
+    std::vector<ToolSample> samples (2048);
+
+    WHEN( "We give invalid parameters" ) {
+      THEN( "The calls fail" ) {
+	REQUIRE( HPGE::get_tool_history (0, -1, samples.data ()) == -1 );
+	REQUIRE( HPGE::set_tool_history_size (-1) == HPGE::INVALID_PARAMS );
+      }
+    }
+    WHEN( "The loop runs" ) {
+      REQUIRE( HPGE::set_tool_history_size (256) == HPGE::SUCCESS );
+      HPGE::start ();
+      std::this_thread::sleep_for (std::chrono::milliseconds (100));
+      int first = HPGE::get_tool_history (0, 2048, samples.data ());
+      THEN( "The last samples are returned in order" ) {
+	REQUIRE( first > 0 );
+	REQUIRE( first < 256 );
+	for (int i = 1; i < first; ++i) {
+	  REQUIRE( samples [i].sequence == samples [i - 1].sequence + 1 );
+	  REQUIRE( samples [i].time >= samples [i - 1].time );
+	}
+      }
+      AND_WHEN( "We ask for the new samples only" ) {
+	long long last = samples [first - 1].sequence;
+	std::this_thread::sleep_for (std::chrono::milliseconds (20));
+	int next = HPGE::get_tool_history (last, 2048, samples.data ());
+	THEN( "They follow the previous ones" ) {
+	  REQUIRE( next > 0 );
+	  REQUIRE( samples [0].sequence == last + 1 );
+	}
+      }
+      AND_WHEN( "We ask for fewer samples" ) {
+	int some = HPGE::get_tool_history (0, 3, samples.data ());
+	THEN( "The oldest ones are returned" ) {
+	  REQUIRE( some == 3 );
+	  REQUIRE( samples [1].sequence == samples [0].sequence + 1 );
+	}
+      }
+      HPGE::stop ();
+    }
+    WHEN( "The history is disabled" ) {
+      REQUIRE( HPGE::set_tool_history_size (0) == HPGE::SUCCESS );
+      THEN( "There is nothing to read" ) {
+	REQUIRE( HPGE::get_tool_history (0, 16, samples.data ()) == -1 );
+      }
+      HPGE::set_tool_history_size (1024);
+    }
+    HPGE::deinitialize ();
+  }
+}
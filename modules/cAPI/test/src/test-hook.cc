@@ -135,3 +135,135 @@ SCENARIO( "We want to register a hook in the main loop",
     }
   }
 }
+
+struct ChainContext {
+  std::atomic<int> calls {0};
+  double gain {1.0};
+  int sleep_us {0};
+};
+
+void chain_hook (void * context, const HookState * state, double force [3]) {
+  ChainContext * c = static_cast<ChainContext *> (context);
+  c -> calls.fetch_add (1);
+  if (c -> sleep_us > 0) {
+    std::this_thread::sleep_for (std::chrono::microseconds (c -> sleep_us));
+  }
+  force [0] = c -> gain * state -> position [0];
+  force [1] = c -> gain * state -> velocity [1];
+  force [2] = (double) state -> buttons;
+}
+
+SCENARIO( "We want to register a chain of hooks", "[hook]" ) {
+  GIVEN( "The device is initilized" ) {
+    HPGE::initialize(-1, 10.0, 10.0);
+    HookState state {};
+    state.position [0] = 1.0;
+    state.velocity [1] = 2.0;
+    state.buttons = 1;
+    double frc [3];
+
+    WHEN( "Two hooks are added" ) {
+      ChainContext first, second;
+      second.gain = 10.0;
+      int a = HPGE::add_chain_hook (chain_hook, &first, 0.0);
+      int b = HPGE::add_chain_hook (chain_hook, &second, 0.0);
+      REQUIRE( a >= 0 );
+      REQUIRE( b > a );
+      THEN( "Both are run with their context and their forces are summed" ) {
+	REQUIRE( HPGE::debug::run_hooks (&state, frc) );
+	REQUIRE( first.calls == 1 );
+	REQUIRE( second.calls == 1 );
+	REQUIRE( frc [0] == Approx (11.0) );
+	REQUIRE( frc [1] == Approx (22.0) );
+	REQUIRE( frc [2] == Approx (2.0) );
+      }
+      AND_WHEN( "One is removed" ) {
+	REQUIRE( HPGE::remove_chain_hook (a) == HPGE::SUCCESS );
+	THEN( "Only the other one runs" ) {
+	  HPGE::debug::run_hooks (&state, frc);
+	  REQUIRE( first.calls == 0 );
+	  REQUIRE( frc [0] == Approx (10.0) );
+	  REQUIRE( HPGE::remove_chain_hook (a) == HPGE::NO_HOOK_EXISTING );
+	}
+      }
+      HPGE::remove_chain_hook (a);
+      HPGE::remove_chain_hook (b);
+    }
+    WHEN( "A hook overruns its budget" ) {
+      ChainContext slow;
+      slow.sleep_us = 2000;
+      int id = HPGE::add_chain_hook (chain_hook, &slow, 100.0);
+      THEN( "The next call is skipped and its force is held" ) {
+	HPGE::debug::run_hooks (&state, frc);
+	slow.sleep_us = 0;
+	state.position [0] = 5.0;
+	HPGE::debug::run_hooks (&state, frc);
+	REQUIRE( slow.calls == 1 );
+	REQUIRE( frc [0] == Approx (1.0) );
+	HPGE::debug::run_hooks (&state, frc);
+	REQUIRE( slow.calls == 2 );
+	REQUIRE( frc [0] == Approx (5.0) );
+
+	unsigned long long calls, overruns, skipped;
+	double max_us;
+	REQUIRE( HPGE::get_chain_hook_stats (id, &calls, &overruns, &skipped, &max_us)
+		 == HPGE::SUCCESS );
+	REQUIRE( calls == 2 );
+	REQUIRE( overruns == 1 );
+	REQUIRE( skipped == 1 );
+	REQUIRE( max_us >= 2000.0 );
+      }
+      HPGE::remove_chain_hook (id);
+    }
+    HPGE::deinitialize ();
+  }
+}
+
+struct SelfRemovingContext {
+  int id {-1};
+  int result {HPGE::SUCCESS};
+};
+
+void self_removing_hook (void * context, const HookState *, double *) {
+  SelfRemovingContext * c = static_cast<SelfRemovingContext *> (context);
+  c -> result = HPGE::remove_chain_hook (c -> id);
+}
+
+SCENARIO( "A hook removes itself", "[hook]" ) {
+  GIVEN( "The device is initilized" ) {
+    HPGE::initialize (-1, 10.0, 10.0);
+    HookState state {};
+    double frc [3];
+    SelfRemovingContext context;
+    context.id = HPGE::add_chain_hook (self_removing_hook, &context, 0.0);
+    THEN( "The removal fails instead of waiting for the hook forever" ) {
+      HPGE::debug::run_hooks (&state, frc);
+      REQUIRE( context.result == HPGE::CALLED_FROM_HOOK );
+      REQUIRE( HPGE::remove_chain_hook (context.id) == HPGE::SUCCESS );
+    }
+    HPGE::deinitialize ();
+  }
+}
+
+SCENARIO( "We want to change the chain of hooks in the main loop", "[hook]" ) {
+  GIVEN( "The device is initilized and started" ) {
+    HPGE::initialize (-1, 10.0, 10.0);
+    HPGE::start ();
+    WHEN( "Hooks are added and removed while running" ) {
+      ChainContext context;
+      THEN( "A removed hook is not called anymore" ) {
+	for (int i = 0; i < 20; ++i) {
+	  int id = HPGE::add_chain_hook (chain_hook, &context, 0.0);
+	  std::this_thread::sleep_for (std::chrono::milliseconds (5));
+	  REQUIRE( HPGE::remove_chain_hook (id) == HPGE::SUCCESS );
+	  int calls = context.calls;
+	  std::this_thread::sleep_for (std::chrono::milliseconds (5));
+	  REQUIRE( context.calls == calls );
+	}
+	REQUIRE( context.calls > 0 );
+      }
+    }
+    HPGE::stop ();
+    HPGE::deinitialize ();
+  }
+}
@@ -0,0 +1,67 @@
+#include "catch.hpp"
+#include "HPGE.h"
+#include <chrono>
+#include <thread>
+
+// Closed cube of side 2 centered in the origin
+static const double cubeVertices [8] [3] {
+  {-1, -1, -1}, {1, -1, -1}, {1, 1, -1}, {-1, 1, -1},
+  {-1, -1, 1}, {1, -1, 1}, {1, 1, 1}, {-1, 1, 1}
+};
+static const int cubeTriangles [12] [3] {
+  {0, 3, 2}, {0, 2, 1}, {4, 5, 6}, {4, 6, 7},
+  {0, 1, 5}, {0, 5, 4}, {2, 3, 7}, {2, 7, 6},
+  {1, 2, 6}, {1, 6, 5}, {0, 4, 7}, {0, 7, 3}
+};
+
+SCENARIO( "We want constant-time collisions with a detailed mesh", "[sdf]" ) {
+  double position [3] {0.0, 0.0, 0.0};
+  double scale [3] {1.0, 1.0, 1.0};
+  double rotation [4] {1.0, 0.0, 0.0, 0.0};
+
+  GIVEN( "The device is not initialized" ) {
+    THEN( "No object is created" ) {
+      REQUIRE( HPGE::create_sdf_object (position, scale, rotation,
+					 cubeVertices, 8, cubeTriangles, 12,
+					 32) == -1 );
+    }
+  }
+  GIVEN( "The device is initilized" ) {
+    HPGE::initialize(-1, 10.0, 10.0);
+
+    WHEN( "We give invalid parameters" ) {
+      const int outOfRange [1] [3] {{0, 1, 8}};
+      THEN( "The calls fail" ) {
+	REQUIRE( HPGE::create_sdf_object (position, scale, rotation,
+					   cubeVertices, 8, cubeTriangles, 12,
+					   0) == -1 );
+	REQUIRE( HPGE::create_sdf_object (position, scale, rotation,
+					   cubeVertices, 8, outOfRange, 1,
+					   32) == -1 );
+	REQUIRE( HPGE::create_sdf_object (position, scale, rotation,
+					   nullptr, 0, cubeTriangles, 12,
+					   32) == -1 );
+      }
+    }
+    WHEN( "The tool is inside a cube" ) {
+      int cube = HPGE::create_sdf_object (position, scale, rotation,
+					  cubeVertices, 8, cubeTriangles, 12,
+					  32);
+      REQUIRE( cube >= 0 );
+      REQUIRE( HPGE::object_exists (cube) == HPGE::SUCCESS );
+      REQUIRE( HPGE::set_object_material (cube, 1.0, 1, 0.0, 0.0, 0.0, 0.0,
+					   0.0, 0.0, 0.0, 0.0, 0.0, 0.0) == HPGE::SUCCESS );
+      REQUIRE( HPGE::add_object_to_world (cube) == HPGE::SUCCESS );
+      HPGE::start ();
+      std::this_thread::sleep_for (std::chrono::milliseconds (50));
+
+      THEN( "The tool touches it" ) {
+	ContactEvent events [8];
+	REQUIRE( HPGE::get_contacts (8, events) == 1 );
+	REQUIRE( events [0].object == cube );
+      }
+      HPGE::stop ();
+    }
+    HPGE::deinitialize ();
+  }
+}
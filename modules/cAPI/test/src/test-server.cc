@@ -0,0 +1,134 @@
+#include "catch.hpp"
+#include "HPGE.h"
+#include "../../server/hpge-client.h"
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Runs against the hpge-server executable in the working directory
+SCENARIO( "We want to drive HPGE from another process", "[server]" ) {
+  GIVEN( "The server is running" ) {
+    pid_t server;
+    char program [] = "./hpge-server";
+    char name [] = "hpge-test-server";
+    char * argv [] = { program, name, nullptr };
+    REQUIRE( posix_spawn (&server, program, nullptr, nullptr, argv, environ) == 0 );
+    int res = HPGE::SERVER_NOT_RUNNING;
+    for (int i = 0; i < 100 && res != HPGE::SUCCESS; ++i) {
+      std::this_thread::sleep_for (std::chrono::milliseconds (10));
+      res = connect_server (name);
+    }
+    REQUIRE( res == HPGE::SUCCESS );
+
+    WHEN( "The device is initialized and started" ) {
+      REQUIRE( HPGE::initialize (-1, 10.0, 10.0) == HPGE::SUCCESS );
+      REQUIRE( HPGE::is_initialized () == HPGE::SUCCESS );
+      double scale [3] {1.0, 1.0, 1.0};
+      double position [3] {0.1, 0.2, 0.3};
+      double rotation [4] {1.0, 0.0, 0.0, 0.0};
+      int box = HPGE::create_box_object (scale, position, rotation);
+      REQUIRE( box >= 0 );
+      REQUIRE( HPGE::add_object_to_world (box) == HPGE::SUCCESS );
+      REQUIRE( HPGE::start () == HPGE::SUCCESS );
+      std::this_thread::sleep_for (std::chrono::milliseconds (100));
+
+      THEN( "The tool state is published" ) {
+	double tool [3];
+	REQUIRE( HPGE::get_tool_position (tool) == HPGE::SUCCESS );
+	REQUIRE( HPGE::get_loops () > 0 );
+      }
+      THEN( "The history is read in several replies" ) {
+	ToolSample samples [50];
+	REQUIRE( HPGE::get_tool_history (0, 50, samples) == 50 );
+	REQUIRE( samples [49].sequence == samples [0].sequence + 49 );
+      }
+      AND_WHEN( "An object is moved" ) {
+	double moved [3] {0.5, 0.0, 0.0};
+	REQUIRE( HPGE::set_object_position (box, moved) == HPGE::SUCCESS );
+	THEN( "Replied calls see the enqueued ones" ) {
+	  // the position is set by the haptic loop
+	  std::this_thread::sleep_for (std::chrono::milliseconds (50));
+	  double read [3];
+	  REQUIRE( HPGE::get_object_position (box, read) == HPGE::SUCCESS );
+	  REQUIRE( read [0] == Approx (0.5) );
+	}
+      }
+      AND_WHEN( "An enqueued call fails" ) {
+	double moved [3] {0.5, 0.0, 0.0};
+	REQUIRE( HPGE::set_object_position (box + 1000, moved) == HPGE::SUCCESS );
+	HPGE::object_exists (box); // waits for the server
+	THEN( "The error is reported later" ) {
+	  REQUIRE( last_async_error () == HPGE::OBJ_NOT_FOUND );
+	  REQUIRE( last_async_error () == HPGE::SUCCESS );
+	}
+      }
+      REQUIRE( HPGE::stop () == HPGE::SUCCESS );
+      REQUIRE( HPGE::deinitialize () == HPGE::SUCCESS );
+    }
+    WHEN( "A client exits without disconnecting and another process connects" ) {
+      REQUIRE( disconnect_server () == HPGE::SUCCESS );
+      pid_t other = fork ();
+      if (other == 0) {
+	double scale [3] {1.0, 1.0, 1.0};
+	double position [3] {0.1, 0.2, 0.3};
+	double rotation [4] {1.0, 0.0, 0.0, 0.0};
+	if (connect_server (name) != HPGE::SUCCESS ||
+	    HPGE::initialize (-1, 10.0, 10.0) != HPGE::SUCCESS) { _exit (255); }
+	int box = HPGE::create_box_object (scale, position, rotation);
+	HPGE::add_object_to_world (box);
+	// still queued when the process exits
+	HPGE::set_object_position (box, position);
+	// the id of the box is the exit status
+	_exit (box >= 0 && box < 255 ? box : 255);
+      }
+      int status = -1;
+      REQUIRE( waitpid (other, &status, 0) == other );
+      REQUIRE( WIFEXITED (status) );
+      int box = WEXITSTATUS (status);
+      REQUIRE( box != 255 );
+      REQUIRE( connect_server (name) == HPGE::SUCCESS );
+      THEN( "It does not see the world of the client that exited" ) {
+	REQUIRE( HPGE::object_exists (box) == HPGE::OBJ_NOT_FOUND );
+	REQUIRE( HPGE::is_initialized () == HPGE::NOT_INITD );
+      }
+    }
+    WHEN( "A mesh does not fit in the command ring" ) {
+      // the ring of the server is 16 MB; this mesh is about 10 MB
+      std::vector<double> vertices (3 * 200000, 0.0);
+      double scale [3] {1.0, 1.0, 1.0};
+      double position [3] {0.0, 0.0, 0.0};
+      double rotation [4] {1.0, 0.0, 0.0, 0.0};
+      int mesh = HPGE::create_mesh_object
+	(position, scale, rotation,
+	 reinterpret_cast<const double (*) [3]> (vertices.data ()),
+	 reinterpret_cast<const double (*) [3]> (vertices.data ()),
+	 200000, nullptr, 0, 0, nullptr);
+      THEN( "The call fails with a clear error" ) {
+	REQUIRE( mesh == -1 );
+	char expected [256], message [256];
+	REQUIRE( HPGE::last_error_msg (sizeof (message), message) == HPGE::SUCCESS );
+	REQUIRE( HPGE::get_error_msg (HPGE::COMMAND_TOO_LARGE, sizeof (expected), expected)
+		 == HPGE::SUCCESS );
+	REQUIRE( std::strcmp (message, expected) == 0 );
+      }
+    }
+    WHEN( "Hooks are added" ) {
+      THEN( "They are refused" ) {
+	REQUIRE( HPGE::remove_chain_hook (0) == HPGE::NOT_IMPLEMENTED );
+      }
+    }
+
+    REQUIRE( disconnect_server () == HPGE::SUCCESS );
+    kill (server, SIGTERM);
+    waitpid (server, nullptr, 0);
+    THEN( "Calls fail once the server has exited" ) {
+      REQUIRE( connect_server (name) == HPGE::SERVER_NOT_RUNNING );
+    }
+  }
+}
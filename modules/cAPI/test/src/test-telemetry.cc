@@ -0,0 +1,105 @@
+#include "catch.hpp"
+#include "HPGE.h"
+#include "../../telemetry/hpge-telemetry.h"
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Creates the segment `name` as if the process `pid` were writing it
+void createSegment (const char * name, const uint64_t pid) {
+  size_t size = HPGE_TELEMETRY_SIZE (16);
+  int fd = shm_open (name, O_CREAT | O_RDWR, 0644);
+  REQUIRE( fd >= 0 );
+  REQUIRE( ftruncate (fd, (off_t) size) == 0 );
+  void * memory = mmap (nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close (fd);
+  REQUIRE( memory != MAP_FAILED );
+  HPGETelemetryHeader * header = static_cast<HPGETelemetryHeader *> (memory);
+  std::memset (memory, 0, size);
+  header -> version = HPGE_TELEMETRY_VERSION;
+  header -> sample_size = sizeof (HPGETelemetrySample);
+  header -> capacity = 16;
+  header -> writer_pid = pid;
+  header -> ticks = 42;
+  header -> magic = HPGE_TELEMETRY_MAGIC;
+  munmap (memory, size);
+}
+
+SCENARIO( "We want to read the tool state from another process", "[telemetry]" ) {
+  GIVEN( "The device is initilized" ) {
+    HPGE::initialize(-1, 10.0, 10.0);
+
+    WHEN( "Telemetry is not enabled" ) {
+      THEN( "There is nothing to read" ) {
+	REQUIRE( hpge_telemetry_open ("hpge-test-telemetry") == nullptr );
+	REQUIRE( HPGE::disable_telemetry () == HPGE::NOT_RECORDING );
+	REQUIRE( HPGE::enable_telemetry ("", 16) == HPGE::INVALID_PARAMS );
+	REQUIRE( HPGE::enable_telemetry ("hpge-test-telemetry", 0) == HPGE::INVALID_PARAMS );
+	REQUIRE( HPGE::enable_telemetry ("hpge-test-telemetry", 1) == HPGE::INVALID_PARAMS );
+      }
+    }
+    WHEN( "Telemetry is enabled and the loop runs" ) {
+      REQUIRE( HPGE::enable_telemetry ("hpge-test-telemetry", 64) == HPGE::SUCCESS );
+      HPGETelemetryReader * reader = hpge_telemetry_open ("hpge-test-telemetry");
+      REQUIRE( reader != nullptr );
+      REQUIRE( hpge_telemetry_header (reader) -> capacity == 64 );
+
+      HPGE::start ();
+      std::this_thread::sleep_for (std::chrono::milliseconds (200));
+      HPGE::stop ();
+
+      THEN( "The latest state and the ring are filled" ) {
+	HPGETelemetrySample latest;
+	REQUIRE( hpge_telemetry_latest (reader, &latest) == 0 );
+	REQUIRE( latest.tick > 0 );
+
+	std::vector<HPGETelemetrySample> samples (64);
+	uint64_t lost;
+	int n = hpge_telemetry_read (reader, samples.data (), 64, &lost);
+	// The loop ran for more ticks than the ring holds
+	REQUIRE( n == 63 );
+	REQUIRE( lost > 0 );
+	for (int i = 1; i < n; ++i) {
+	  REQUIRE( samples [i].tick == samples [i - 1].tick + 1 );
+	}
+	REQUIRE( samples [n - 1].tick == latest.tick );
+	REQUIRE( hpge_telemetry_read (reader, samples.data (), 64, &lost) == 0 );
+	REQUIRE( lost == 0 );
+      }
+      hpge_telemetry_close (reader);
+      REQUIRE( HPGE::disable_telemetry () == HPGE::SUCCESS );
+      REQUIRE( hpge_telemetry_open ("hpge-test-telemetry") == nullptr );
+    }
+    WHEN( "Another process writes a segment with the same name" ) {
+      createSegment ("/hpge-test-telemetry", (uint64_t) getppid ());
+      THEN( "It is left alone" ) {
+	REQUIRE( HPGE::enable_telemetry ("hpge-test-telemetry", 64) == HPGE::TELEMETRY_IN_USE );
+	HPGETelemetryReader * reader = hpge_telemetry_open ("hpge-test-telemetry");
+	REQUIRE( reader != nullptr );
+	REQUIRE( hpge_telemetry_header (reader) -> ticks == 42 );
+	hpge_telemetry_close (reader);
+      }
+      shm_unlink ("/hpge-test-telemetry");
+    }
+    WHEN( "A process that is gone left a segment with the same name" ) {
+      pid_t child = fork ();
+      if (child == 0) { _exit (0); }
+      waitpid (child, nullptr, 0);
+      createSegment ("/hpge-test-telemetry", (uint64_t) child);
+      THEN( "It is replaced" ) {
+	REQUIRE( HPGE::enable_telemetry ("hpge-test-telemetry", 64) == HPGE::SUCCESS );
+	HPGETelemetryReader * reader = hpge_telemetry_open ("hpge-test-telemetry");
+	REQUIRE( reader != nullptr );
+	REQUIRE( hpge_telemetry_header (reader) -> writer_pid == (uint64_t) getpid () );
+	hpge_telemetry_close (reader);
+	REQUIRE( HPGE::disable_telemetry () == HPGE::SUCCESS );
+      }
+    }
+    HPGE::deinitialize ();
+  }
+}
@@ -46,7 +46,9 @@
 //------------------------------------------------------------------------------
 #include "collisions/CCollisionAABB.h"
 //------------------------------------------------------------------------------
+#include <cstdio>
 #include <iostream>
+#include <type_traits>
 //------------------------------------------------------------------------------
 using namespace std;
 //------------------------------------------------------------------------------
@@ -55,6 +57,62 @@ using namespace std;
 namespace chai3d {
 //------------------------------------------------------------------------------
 
+//------------------------------------------------------------------------------
+// collision tree files
+//------------------------------------------------------------------------------
+
+// nodes are written to disk and mapped back as they are laid out in memory
+static_assert(!std::is_polymorphic<cCollisionAABBNode>::value &&
+              std::is_standard_layout<cCollisionAABBNode>::value &&
+              std::is_trivially_destructible<cCollisionAABBNode>::value,
+              "cCollisionAABBNode must be plain data");
+
+// increment whenever the file layout or the tree construction changes
+static const unsigned int C_AABB_FILE_VERSION = 1;
+
+// detects files written on a platform with a different byte order
+static const unsigned int C_AABB_FILE_ENDIANNESS = 0x01020304;
+
+// header of a collision tree file, the nodes follow at offset m_nodesOffset
+struct cCollisionAABBFileHeader
+{
+    char m_magic[8];
+    unsigned int m_version;
+    unsigned int m_endianness;
+    unsigned int m_nodeSize;
+    unsigned int m_nodesOffset;
+    int m_numElements;
+    int m_numVerticesPerElement;
+    int m_numNodes;
+    int m_rootIndex;
+    int m_maxDepth;
+    int m_reserved;
+    unsigned long long m_hash;
+    double m_radius;
+};
+
+static const char C_AABB_FILE_MAGIC[8] = { 'C', 'H', 'A', 'I', 'A', 'A', 'B', 'B' };
+
+// nodes start on a 64 byte boundary
+static const unsigned int C_AABB_FILE_NODES_OFFSET = (sizeof(cCollisionAABBFileHeader) + 63) & ~63u;
+
+// mixes a 64 bit word into a hash value
+static inline void cHashMix(unsigned long long& a_hash, unsigned long long a_value)
+{
+    a_value *= 0x9E3779B97F4A7C15ULL;
+    a_value ^= a_value >> 32;
+    a_hash ^= a_value;
+    a_hash *= 0x100000001B3ULL;
+    a_hash ^= a_hash >> 29;
+}
+
+static inline void cHashMix(unsigned long long& a_hash, double a_value)
+{
+    unsigned long long value;
+    memcpy(&value, &a_value, sizeof(value));
+    cHashMix(a_hash, value);
+}
+
 //==============================================================================
 /*!
     Constructor of cCollisionAABB.
@@ -73,6 +131,8 @@ cCollisionAABB::cCollisionAABB()
 
     // clear nodes
     m_nodes.clear();
+    m_treeNodes = nullptr;
+    m_numNodes = 0;
 
     // initialize variables
     m_rootIndex = -1;
@@ -114,6 +174,12 @@ void cCollisionAABB::initialize(const cGenericArrayPtr a_elements, const double
     // INITIALIZATION
     ////////////////////////////////////////////////////////////////////////////
 
+    // clear previous tree
+    m_nodes.clear();
+    m_treeNodes = nullptr;
+    m_numNodes = 0;
+    m_mappedFile = nullptr;
+
     // sanity check
     if (a_elements == nullptr)
     {
@@ -125,9 +191,6 @@ void cCollisionAABB::initialize(const cGenericArrayPtr a_elements, const double
     // store radius
     m_radius = a_radius;
 
-    // clear previous tree
-    m_nodes.clear();
-
     // get number of elements
     m_numElements = m_elements->getNumElements();
 
@@ -234,6 +297,275 @@ void cCollisionAABB::initialize(const cGenericArrayPtr a_elements, const double
     {
         m_rootIndex = 0;
     }
+
+    // the node list is complete
+    m_treeNodes = m_nodes.data();
+    m_numNodes = (int)(m_nodes.size());
+}
+
+
+//==============================================================================
+/*!
+    This method loads a collision tree saved by saveToFile(). The file is
+    memory mapped, so that loading costs no more than validating the header
+    and nodes are paged in on demand. \n\n
+
+    The file is rejected if it was written by a different version of the
+    library, on a platform with a different memory layout, or for elements
+    or a radius that do not match the ones passed as argument. In that case
+    the current tree is left unchanged. \n\n
+
+    Only the tree is stored: its leaves refer to the elements by index, and
+    the vertices and elements themselves are those of __a_elements__.
+
+    \param  a_elements  Pointer to element array.
+    \param  a_radius    Bounding radius to add around each elements.
+    \param  a_filename  Filename.
+    \param  a_hash      Hash of the elements and radius, as returned by computeHash().
+
+    \return __true__ if the tree was loaded, __false__ otherwise.
+*/
+//==============================================================================
+bool cCollisionAABB::loadFromFile(const cGenericArrayPtr a_elements,
+                                  const double a_radius,
+                                  const std::string& a_filename,
+                                  const unsigned long long a_hash)
+{
+    // sanity check
+    if (a_elements == nullptr)
+    {
+        return (C_ERROR);
+    }
+
+    // map file
+    cMappedFilePtr file = cMappedFile::create();
+    if (!file->open(a_filename))
+    {
+        return (C_ERROR);
+    }
+
+    if (file->getSize() < C_AABB_FILE_NODES_OFFSET)
+    {
+        return (C_ERROR);
+    }
+
+    // check header
+    cCollisionAABBFileHeader header;
+    memcpy(&header, file->getData(), sizeof(header));
+
+    int numElements = (int)(a_elements->getNumElements());
+    int numVerticesPerElement = (int)(a_elements->getNumVerticesPerElement());
+
+    if ((memcmp(header.m_magic, C_AABB_FILE_MAGIC, sizeof(header.m_magic)) != 0) ||
+        (header.m_version != C_AABB_FILE_VERSION) ||
+        (header.m_endianness != C_AABB_FILE_ENDIANNESS) ||
+        (header.m_nodeSize != sizeof(cCollisionAABBNode)) ||
+        (header.m_nodesOffset != C_AABB_FILE_NODES_OFFSET) ||
+        (header.m_numElements != numElements) ||
+        (header.m_numVerticesPerElement != numVerticesPerElement) ||
+        (header.m_radius != a_radius) ||
+        (header.m_numNodes < 0) ||
+        (header.m_rootIndex < -1) ||
+        (header.m_rootIndex >= header.m_numNodes) ||
+        (header.m_maxDepth < 0))
+    {
+        return (C_ERROR);
+    }
+
+    if (file->getSize() != (size_t)header.m_nodesOffset + (size_t)header.m_numNodes * sizeof(cCollisionAABBNode))
+    {
+        return (C_ERROR);
+    }
+
+    // check that the tree was built for the same geometry
+    if (header.m_hash != a_hash)
+    {
+        return (C_ERROR);
+    }
+
+    // check that the nodes form a tree that the traversal can walk safely:
+    // children are stored before their parent and no path is deeper than the
+    // traversal stack
+    const cCollisionAABBNode* nodes = (const cCollisionAABBNode*)(file->getData() + header.m_nodesOffset);
+    std::vector<int> height(header.m_numNodes);
+    for (int i=0; i<header.m_numNodes; i++)
+    {
+        if (nodes[i].m_nodeType == C_AABB_NODE_LEAF)
+        {
+            if ((nodes[i].m_leftSubTree < 0) || (nodes[i].m_leftSubTree >= numElements))
+            {
+                return (C_ERROR);
+            }
+            height[i] = 1;
+        }
+        else if (nodes[i].m_nodeType == C_AABB_NODE_INTERNAL)
+        {
+            int left = nodes[i].m_leftSubTree;
+            int right = nodes[i].m_rightSubTree;
+            if ((left < 0) || (left >= i) || (right < 0) || (right >= i))
+            {
+                return (C_ERROR);
+            }
+            height[i] = 1 + cMax(height[left], height[right]);
+        }
+        else
+        {
+            return (C_ERROR);
+        }
+    }
+
+    if ((header.m_rootIndex >= 0) && (height[header.m_rootIndex] > header.m_maxDepth + 1))
+    {
+        return (C_ERROR);
+    }
+
+    // use nodes in place
+    m_nodes.clear();
+    m_mappedFile = file;
+    m_treeNodes = (cCollisionAABBNode*)(file->getData() + header.m_nodesOffset);
+    m_numNodes = header.m_numNodes;
+    m_elements = a_elements;
+    m_numElements = numElements;
+    m_radius = a_radius;
+    m_rootIndex = header.m_rootIndex;
+    m_maxDepth = header.m_maxDepth;
+
+    return (C_SUCCESS);
+}
+
+
+//==============================================================================
+/*!
+    This method saves the collision tree to a file, which can be loaded with
+    loadFromFile(). The file is written under a temporary name and then
+    renamed, so that other processes never map a partially written file.
+
+    \param  a_filename  Filename.
+    \param  a_hash      Hash of the elements and radius, as returned by computeHash().
+
+    \return __true__ if the tree was saved, __false__ otherwise.
+*/
+//==============================================================================
+bool cCollisionAABB::saveToFile(const std::string& a_filename,
+                                const unsigned long long a_hash)
+{
+    // sanity check
+    if (m_elements == nullptr)
+    {
+        return (C_ERROR);
+    }
+
+    // build header
+    cCollisionAABBFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.m_magic, C_AABB_FILE_MAGIC, sizeof(header.m_magic));
+    header.m_version = C_AABB_FILE_VERSION;
+    header.m_endianness = C_AABB_FILE_ENDIANNESS;
+    header.m_nodeSize = sizeof(cCollisionAABBNode);
+    header.m_nodesOffset = C_AABB_FILE_NODES_OFFSET;
+    header.m_numElements = m_numElements;
+    header.m_numVerticesPerElement = (int)(m_elements->getNumVerticesPerElement());
+    header.m_numNodes = m_numNodes;
+    header.m_rootIndex = m_rootIndex;
+    header.m_maxDepth = m_maxDepth;
+    header.m_hash = a_hash;
+    header.m_radius = m_radius;
+
+    // write temporary file
+    std::string filename = a_filename + ".tmp";
+    FILE* file = fopen(filename.c_str(), "wb");
+    if (file == nullptr)
+    {
+        return (C_ERROR);
+    }
+
+    char padding[C_AABB_FILE_NODES_OFFSET] = { 0 };
+    size_t paddingSize = C_AABB_FILE_NODES_OFFSET - sizeof(header);
+    bool result = (fwrite(&header, sizeof(header), 1, file) == 1);
+    if (paddingSize > 0)
+    {
+        result = result && (fwrite(padding, paddingSize, 1, file) == 1);
+    }
+    if (m_numNodes > 0)
+    {
+        result = result && (fwrite(m_treeNodes, sizeof(cCollisionAABBNode), m_numNodes, file) == (size_t)m_numNodes);
+    }
+    result = (fclose(file) == 0) && result;
+
+    // replace previous file
+    if (result)
+    {
+        remove(a_filename.c_str());
+        result = (rename(filename.c_str(), a_filename.c_str()) == 0);
+    }
+    if (!result)
+    {
+        remove(filename.c_str());
+    }
+
+    return (result);
+}
+
+
+//==============================================================================
+/*!
+    This method computes a 64 bit hash of the vertex positions, element
+    indices, element allocation flags and radius. Collision trees saved to
+    disk are tagged with this value so that trees built for another geometry
+    are never reused.
+
+    \param  a_elements  Pointer to element array.
+    \param  a_radius    Bounding radius to add around each elements.
+
+    \return Hash value.
+*/
+//==============================================================================
+unsigned long long cCollisionAABB::computeHash(const cGenericArrayPtr a_elements,
+                                               const double a_radius)
+{
+    unsigned long long hash = 0xCBF29CE484222325ULL;
+
+    cHashMix(hash, a_radius);
+
+    if (a_elements == nullptr)
+    {
+        return (hash);
+    }
+
+    cHashMix(hash, (unsigned long long)a_elements->getNumVerticesPerElement());
+    cHashMix(hash, (unsigned long long)a_elements->m_indices.size());
+    for (size_t i=0; i<a_elements->m_indices.size(); i++)
+    {
+        cHashMix(hash, (unsigned long long)a_elements->m_indices[i]);
+    }
+
+    cHashMix(hash, (unsigned long long)a_elements->m_allocated.size());
+    unsigned long long flags = 0;
+    for (size_t i=0; i<a_elements->m_allocated.size(); i++)
+    {
+        flags = (flags << 1) | (a_elements->m_allocated[i] ? 1 : 0);
+        if ((i & 63) == 63)
+        {
+            cHashMix(hash, flags);
+            flags = 0;
+        }
+    }
+    cHashMix(hash, flags);
+
+    if (a_elements->m_vertices != nullptr)
+    {
+        const unsigned int numVertices = a_elements->m_vertices->getNumElements();
+        cHashMix(hash, (unsigned long long)numVertices);
+        for (unsigned int i=0; i<numVertices; i++)
+        {
+            cVector3d position = a_elements->m_vertices->getLocalPos(i);
+            cHashMix(hash, position(0));
+            cHashMix(hash, position(1));
+            cHashMix(hash, position(2));
+        }
+    }
+
+    return (hash);
 }
 
 
@@ -421,7 +753,7 @@ bool cCollisionAABB::computeCollision (cGenericObject* a_object,
     int nodeIndex = stack[index].m_index;
 
     // get type of current node
-    cAABBNodeType nodeType = m_nodes[nodeIndex].m_nodeType;
+    cAABBNodeType nodeType = m_treeNodes[nodeIndex].m_nodeType;
 
 
     //----------------------------------------------------------------------
@@ -434,9 +766,9 @@ bool cCollisionAABB::computeCollision (cGenericObject* a_object,
 	////////////////////////////////////////////////////////////////
       case C_AABB_STATE_TEST_CURRENT_NODE: {
 	// check if line box intersects box of current node
-	if (m_nodes[nodeIndex].m_bbox.intersect(lineBox)) {
+	if (m_treeNodes[nodeIndex].m_bbox.intersect(lineBox)) {
 	  // check if segment intersects box of current node
-	  if (m_nodes[nodeIndex].m_bbox.intersect(a_segmentPointA, a_segmentPointB)) {
+	  if (m_treeNodes[nodeIndex].m_bbox.intersect(a_segmentPointA, a_segmentPointB)) {
 	    stack[index].m_state = C_AABB_STATE_TEST_LEFT_NODE;
 	  } else {
 	    stack[index].m_state = C_AABB_STATE_TEST_CURRENT_NODE;
@@ -457,7 +789,7 @@ bool cCollisionAABB::computeCollision (cGenericObject* a_object,
 
 	  // push left child node on stack
 	  index++;
-	  stack[index].m_index =  m_nodes[nodeIndex].m_leftSubTree;
+	  stack[index].m_index =  m_treeNodes[nodeIndex].m_leftSubTree;
 	  stack[index].m_state = C_AABB_STATE_TEST_CURRENT_NODE;
 	}
 	break;
@@ -471,7 +803,7 @@ bool cCollisionAABB::computeCollision (cGenericObject* a_object,
 
 	  // push right child node on stack
 	  index++;
-	  stack[index].m_index =  m_nodes[nodeIndex].m_rightSubTree;
+	  stack[index].m_index =  m_treeNodes[nodeIndex].m_rightSubTree;
 	  stack[index].m_state = C_AABB_STATE_TEST_CURRENT_NODE;
 	}
 	break;
@@ -495,7 +827,7 @@ bool cCollisionAABB::computeCollision (cGenericObject* a_object,
     //----------------------------------------------------------------------
     else if (nodeType == C_AABB_NODE_LEAF) {
       // get index of leaf element
-      int elementIndex =  m_nodes[nodeIndex].m_leftSubTree;
+      int elementIndex =  m_treeNodes[nodeIndex].m_leftSubTree;
 
       // call the element's collision detection method
       if (m_elements->m_allocated[elementIndex]) {
@@ -535,10 +867,9 @@ void cCollisionAABB::render(cRenderOptions& a_options)
     glColor4fv(m_color.getData());
 
     // render tree by calling the root, which recursively calls the children
-    vector<cCollisionAABBNode>::iterator i;
-    for(i = m_nodes.begin(); i != m_nodes.end(); i++)
+    for (int i=0; i<m_numNodes; i++)
     {
-        i->render(m_displayDepth);
+        m_treeNodes[i].render(m_displayDepth);
     }
 
     // restore lighting settings
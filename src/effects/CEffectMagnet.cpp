@@ -134,6 +134,20 @@ bool cEffectMagnet::computeForce(const cVector3d& a_toolPos,
 }
 
 
+//==============================================================================
+/*!
+    This method returns the distance from the surface of the object beyond
+    which the magnet produces no force, as set in the material of the object.
+
+    \return Magnet distance of the material.
+*/
+//==============================================================================
+double cEffectMagnet::getInfluenceDistance() const
+{
+    return (cMax(0.0, m_parent->m_material->getMagnetMaxDistance()));
+}
+
+
 //------------------------------------------------------------------------------
 } // namespace chai3d
 //------------------------------------------------------------------------------
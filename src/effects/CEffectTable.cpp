@@ -0,0 +1,950 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2003-2016, CHAI3D.
+    (www.chai3d.org)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of CHAI3D nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE. 
+
+    \author    <http://www.chai3d.org>
+    \version   3.2.0 $Rev: 1869 $
+*/
+//==============================================================================
+
+//------------------------------------------------------------------------------
+#include "effects/CEffectTable.h"
+//------------------------------------------------------------------------------
+#include "effects/CEffectMagnet.h"
+#include "effects/CEffectSurface.h"
+#include "effects/CEffectViscosity.h"
+#include "forces/CInteractionBasics.h"
+#include "world/CShapeSphere.h"
+//------------------------------------------------------------------------------
+#include <algorithm>
+#include <typeinfo>
+//------------------------------------------------------------------------------
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define C_EFFECT_TABLE_USE_SSE2
+#include <emmintrin.h>
+#endif
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+namespace chai3d {
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+// Number of effects in a block: blocks out of reach of the tool are skipped
+static const int C_EFFECT_TABLE_BLOCK_SIZE = 16;
+//------------------------------------------------------------------------------
+
+//==============================================================================
+/*!
+    This function interleaves the bits of three 10 bit coordinates, so that
+    sorting by code keeps nearby positions together.
+*/
+//==============================================================================
+static unsigned int cMortonCode(unsigned int a_x, unsigned int a_y, unsigned int a_z)
+{
+    unsigned int code = 0;
+    for (int i=0; i<10; i++)
+    {
+        code |= ((a_x >> i) & 1) << (3 * i);
+        code |= ((a_y >> i) & 1) << (3 * i + 1);
+        code |= ((a_z >> i) & 1) << (3 * i + 2);
+    }
+    return (code);
+}
+
+
+//==============================================================================
+/*!
+    This function grows a box to contain another one.
+*/
+//==============================================================================
+static inline void cExpandBox(cVector3d& a_lower, cVector3d& a_upper,
+                              const cVector3d& a_min, const cVector3d& a_max)
+{
+    for (int k=0; k<3; k++)
+    {
+        a_lower(k) = cMin(a_lower(k), a_min(k));
+        a_upper(k) = cMax(a_upper(k), a_max(k));
+    }
+}
+
+
+//==============================================================================
+/*!
+    Constructor of cEffectTable.
+*/
+//==============================================================================
+cEffectTable::cEffectTable()
+{
+}
+
+
+//==============================================================================
+/*!
+    Destructor of cEffectTable.
+*/
+//==============================================================================
+cEffectTable::~cEffectTable()
+{
+    clear();
+}
+
+
+//==============================================================================
+/*!
+    This method collects the spheres of a scene graph whose enabled effects
+    are all surface, viscosity or magnet effects, and copies their effects
+    and materials. Their effects are then only evaluated by computeForces().
+    Effects are sorted by the current global position of their object, so
+    that blocks of nearby objects can be skipped.
+
+    \param  a_root  Root of the scene graph.
+*/
+//==============================================================================
+void cEffectTable::compile(cGenericObject* a_root)
+{
+    clear();
+    if (a_root == NULL) { return; }
+
+    collect(a_root);
+
+    // bounds of the objects, to compute the codes
+    cVector3d lower(C_LARGE, C_LARGE, C_LARGE);
+    cVector3d upper(-C_LARGE, -C_LARGE, -C_LARGE);
+    for (unsigned int i=0; i<m_objects.size(); i++)
+    {
+        cExpandBox(lower, upper, m_objects[i]->m_globalPos, m_objects[i]->m_globalPos);
+    }
+    cVector3d size = upper - lower;
+    double extent = cMax(size(0), cMax(size(1), size(2)));
+    double scale = (extent > 0.0) ? 1023.0 / extent : 0.0;
+
+    for (int type=0; type<C_EFFECT_TABLE_NUM_TYPES; type++)
+    {
+        cEffectBatch unsorted = m_batches[type];
+        cEffectBatch& batch = m_batches[type];
+        int count = (int)(unsorted.m_object.size());
+
+        // sort the effects by the position of their objects
+        std::vector<std::pair<unsigned int, int> > order(count);
+        for (int i=0; i<count; i++)
+        {
+            cVector3d p = cMul(scale, m_objects[unsorted.m_object[i]]->m_globalPos - lower);
+            order[i] = std::make_pair(cMortonCode((unsigned int)p(0),
+                                                  (unsigned int)p(1),
+                                                  (unsigned int)p(2)), i);
+        }
+        std::stable_sort(order.begin(), order.end());
+
+        // pad to whole blocks with effects that never apply
+        int padded = ((count + C_EFFECT_TABLE_BLOCK_SIZE - 1) / C_EFFECT_TABLE_BLOCK_SIZE) * C_EFFECT_TABLE_BLOCK_SIZE;
+        batch.m_object.assign(padded, -1);
+        batch.m_posX.assign(padded, 0.0);
+        batch.m_posY.assign(padded, 0.0);
+        batch.m_posZ.assign(padded, 0.0);
+        batch.m_radius.assign(padded, -1.0);
+        batch.m_reach.assign(padded, -C_LARGE);
+        for (int i=0; i<count; i++)
+        {
+            batch.m_object[i] = unsorted.m_object[order[i].second];
+        }
+        if (type == C_EFFECT_TABLE_SURFACE)
+        {
+            batch.m_stiffness.assign(padded, 0.0);
+            for (int i=0; i<count; i++)
+            {
+                batch.m_stiffness[i] = unsorted.m_stiffness[order[i].second];
+            }
+        }
+        else if (type == C_EFFECT_TABLE_VISCOSITY)
+        {
+            batch.m_viscosity.assign(padded, 0.0);
+            for (int i=0; i<count; i++)
+            {
+                batch.m_viscosity[i] = unsorted.m_viscosity[order[i].second];
+            }
+        }
+        else
+        {
+            batch.m_magnetMaxDistance.assign(padded, -1.0);
+            batch.m_magnetKnee.assign(padded, 0.0);
+            batch.m_magnetStiffness.assign(padded, 0.0);
+            batch.m_magnetSlope.assign(padded, 0.0);
+            batch.m_magnetInside.assign(padded, 0.0);
+            for (int i=0; i<count; i++)
+            {
+                int j = order[i].second;
+                batch.m_magnetMaxDistance[i] = unsorted.m_magnetMaxDistance[j];
+                batch.m_magnetKnee[i] = unsorted.m_magnetKnee[j];
+                batch.m_magnetStiffness[i] = unsorted.m_magnetStiffness[j];
+                batch.m_magnetSlope[i] = unsorted.m_magnetSlope[j];
+                batch.m_magnetInside[i] = unsorted.m_magnetInside[j];
+            }
+        }
+        batch.m_blockMin.resize(padded / C_EFFECT_TABLE_BLOCK_SIZE);
+        batch.m_blockMax.resize(padded / C_EFFECT_TABLE_BLOCK_SIZE);
+        batch.m_blockGrown.assign(padded / C_EFFECT_TABLE_BLOCK_SIZE, 1);
+    }
+
+    // where each object writes its position
+    m_slots.assign(C_EFFECT_TABLE_NUM_TYPES * m_objects.size(), -1);
+    for (int type=0; type<C_EFFECT_TABLE_NUM_TYPES; type++)
+    {
+        const std::vector<int>& objects = m_batches[type].m_object;
+        for (unsigned int i=0; i<objects.size(); i++)
+        {
+            if (objects[i] >= 0)
+            {
+                m_slots[C_EFFECT_TABLE_NUM_TYPES * objects[i] + type] = i;
+            }
+        }
+    }
+    for (unsigned int i=0; i<m_objects.size(); i++)
+    {
+        updateObject(i);
+    }
+    for (int type=0; type<C_EFFECT_TABLE_NUM_TYPES; type++)
+    {
+        for (unsigned int i=0; i<m_batches[type].m_blockMin.size(); i++)
+        {
+            updateBlock(m_batches[type], i);
+        }
+    }
+
+    m_eventForces.assign(m_objects.size(), cVector3d(0.0, 0.0, 0.0));
+    m_eventObjects.assign(m_objects.size(), false);
+    m_events.clear();
+}
+
+
+//==============================================================================
+/*!
+    This method adds an object to the table if its effects can be evaluated
+    in batches, then its children. Ghost objects are not traversed, as in
+    cGenericObject::computeInteractions().
+
+    \param  a_object  Object.
+*/
+//==============================================================================
+void cEffectTable::collect(cGenericObject* a_object)
+{
+    if (a_object->m_ghostEnabled) { return; }
+
+    // spheres only: subclasses may locate the tool differently
+    bool batched = (typeid(*a_object) == typeid(cShapeSphere)) && (a_object->m_effectTable == NULL);
+    bool effects = false;
+    for (unsigned int i=0; batched && (i<a_object->m_effects.size()); i++)
+    {
+        cGenericEffect* effect = a_object->m_effects[i];
+        if (effect->getEnabled())
+        {
+            effects = true;
+            batched = (typeid(*effect) == typeid(cEffectSurface)) ||
+                      (typeid(*effect) == typeid(cEffectViscosity)) ||
+                      (typeid(*effect) == typeid(cEffectMagnet));
+        }
+    }
+
+    if (batched && effects)
+    {
+        int index = (int)(m_objects.size());
+        m_objects.push_back((cShapeSphere*)a_object);
+        a_object->m_effectTable = this;
+        a_object->m_effectTableIndex = index;
+
+        cMaterialPtr material = a_object->m_material;
+        for (unsigned int i=0; i<a_object->m_effects.size(); i++)
+        {
+            cGenericEffect* effect = a_object->m_effects[i];
+            if (!effect->getEnabled()) { continue; }
+
+            if (typeid(*effect) == typeid(cEffectSurface))
+            {
+                cEffectBatch& batch = m_batches[C_EFFECT_TABLE_SURFACE];
+                batch.m_object.push_back(index);
+                batch.m_stiffness.push_back(material->getStiffness());
+            }
+            else if (typeid(*effect) == typeid(cEffectViscosity))
+            {
+                cEffectBatch& batch = m_batches[C_EFFECT_TABLE_VISCOSITY];
+                batch.m_object.push_back(index);
+                batch.m_viscosity.push_back(material->getViscosity());
+            }
+            else
+            {
+                // as cEffectMagnet::computeForce()
+                cEffectBatch& batch = m_batches[C_EFFECT_TABLE_MAGNET];
+                double stiffness = material->getStiffness();
+                double maxForce = material->getMagnetMaxForce();
+                double maxDistance = material->getMagnetMaxDistance();
+                double knee = (stiffness > 0.0) ? maxForce / stiffness : 0.0;
+                double slope = (maxDistance - knee > 0.0) ? maxForce / (maxDistance - knee) : 0.0;
+                batch.m_object.push_back(index);
+                batch.m_magnetMaxDistance.push_back((stiffness > 0.0) ? maxDistance : -1.0);
+                batch.m_magnetKnee.push_back(knee);
+                batch.m_magnetStiffness.push_back(stiffness);
+                batch.m_magnetSlope.push_back(slope);
+                batch.m_magnetInside.push_back(((cEffectMagnet*)effect)->getEnabledInside() ? 1.0 : 0.0);
+            }
+        }
+    }
+
+    for (unsigned int i=0; i<a_object->m_children.size(); i++)
+    {
+        collect(a_object->m_children[i]);
+    }
+}
+
+
+//==============================================================================
+/*!
+    This method releases all objects, whose effects are then evaluated one
+    object at a time again.
+*/
+//==============================================================================
+void cEffectTable::clear()
+{
+    for (unsigned int i=0; i<m_objects.size(); i++)
+    {
+        if (m_objects[i] != NULL)
+        {
+            m_objects[i]->m_effectTable = NULL;
+            m_objects[i]->m_effectTableIndex = -1;
+        }
+    }
+    m_objects.clear();
+    m_slots.clear();
+    for (int type=0; type<C_EFFECT_TABLE_NUM_TYPES; type++)
+    {
+        m_batches[type] = cEffectBatch();
+    }
+    m_eventForces.clear();
+    m_eventObjects.clear();
+    m_events.clear();
+}
+
+
+//==============================================================================
+/*!
+    This method removes an object from the table. It is called by the
+    destructor of compiled objects.
+
+    \param  a_object  Object.
+*/
+//==============================================================================
+void cEffectTable::release(cGenericObject* a_object)
+{
+    if (a_object->m_effectTable != this) { return; }
+
+    int index = a_object->m_effectTableIndex;
+    m_objects[index] = NULL;
+    a_object->m_effectTable = NULL;
+    a_object->m_effectTableIndex = -1;
+    updateObject(index);
+}
+
+
+//==============================================================================
+/*!
+    This method returns the number of effects in the table.
+
+    \return Number of effects.
+*/
+//==============================================================================
+int cEffectTable::getNumEffects() const
+{
+    int count = 0;
+    for (int type=0; type<C_EFFECT_TABLE_NUM_TYPES; type++)
+    {
+        const std::vector<int>& objects = m_batches[type].m_object;
+        for (unsigned int i=0; i<objects.size(); i++)
+        {
+            if ((objects[i] >= 0) && (m_objects[objects[i]] != NULL)) { count++; }
+        }
+    }
+    return (count);
+}
+
+
+//==============================================================================
+/*!
+    This method copies the global position and the radius of an object of
+    the table to its effects. It is called by
+    cGenericObject::computeGlobalPositions(). Objects that are disabled, or
+    that are released, get a negative radius so that no effect applies.
+
+    \param  a_index  Index of the object in the table.
+*/
+//==============================================================================
+void cEffectTable::updateObject(const int a_index)
+{
+    cShapeSphere* object = m_objects[a_index];
+    bool active = (object != NULL) && object->m_enabled && object->m_hapticEnabled &&
+                  (object->m_effectTable == this);
+    double radius = active ? object->getRadius() : -1.0;
+
+    for (int type=0; type<C_EFFECT_TABLE_NUM_TYPES; type++)
+    {
+        int slot = m_slots[C_EFFECT_TABLE_NUM_TYPES * a_index + type];
+        if (slot < 0) { continue; }
+
+        cEffectBatch& batch = m_batches[type];
+        batch.m_radius[slot] = radius;
+        batch.m_reach[slot] = -C_LARGE;
+        if (active)
+        {
+            batch.m_reach[slot] = radius;
+            if (type == C_EFFECT_TABLE_MAGNET)
+            {
+                batch.m_reach[slot] += cMax(0.0, batch.m_magnetMaxDistance[slot]);
+            }
+            batch.m_posX[slot] = object->m_globalPos(0);
+            batch.m_posY[slot] = object->m_globalPos(1);
+            batch.m_posZ[slot] = object->m_globalPos(2);
+
+            // grow the bounds of the block, which are computed again only
+            // if the tool gets within them
+            int block = slot / C_EFFECT_TABLE_BLOCK_SIZE;
+            double reach = batch.m_reach[slot];
+            cVector3d margin(reach, reach, reach);
+            cExpandBox(batch.m_blockMin[block], batch.m_blockMax[block],
+                       object->m_globalPos - margin, object->m_globalPos + margin);
+            batch.m_blockGrown[block] = 1;
+        }
+    }
+}
+
+
+//==============================================================================
+/*!
+    This method computes the bounds of a block from the positions of its
+    objects, grown by the reach of their effects.
+
+    \param  a_batch  Batch.
+    \param  a_block  Block index.
+*/
+//==============================================================================
+void cEffectTable::updateBlock(cEffectBatch& a_batch,
+                               const int a_block)
+{
+    // disabled objects have a reach of -C_LARGE, and never grow the bounds
+    int begin = a_block * C_EFFECT_TABLE_BLOCK_SIZE;
+    const double* pos[3] = { &a_batch.m_posX[begin], &a_batch.m_posY[begin], &a_batch.m_posZ[begin] };
+    const double* reach = &a_batch.m_reach[begin];
+    for (int k=0; k<3; k++)
+    {
+        double lower = C_LARGE;
+        double upper = -C_LARGE;
+        for (int i=0; i<C_EFFECT_TABLE_BLOCK_SIZE; i++)
+        {
+            lower = cMin(lower, pos[k][i] - reach[i]);
+            upper = cMax(upper, pos[k][i] + reach[i]);
+        }
+        a_batch.m_blockMin[a_block](k) = lower;
+        a_batch.m_blockMax[a_block](k) = upper;
+    }
+    a_batch.m_blockGrown[a_block] = 0;
+}
+
+
+//==============================================================================
+/*!
+    This method returns __true__ if a tool position is within the bounds of
+    a block of a batch.
+
+    \param  a_batch    Batch.
+    \param  a_block    Block index.
+    \param  a_toolPos  Position of the tool in world coordinates.
+
+    \return __true__ if the block may produce a force.
+*/
+//==============================================================================
+bool cEffectTable::isBlockInReach(cEffectBatch& a_batch,
+                                  const int a_block,
+                                  const cVector3d& a_toolPos)
+{
+    const cVector3d& lower = a_batch.m_blockMin[a_block];
+    const cVector3d& upper = a_batch.m_blockMax[a_block];
+    bool inside = ((a_toolPos(0) >= lower(0)) && (a_toolPos(0) <= upper(0)) &&
+                   (a_toolPos(1) >= lower(1)) && (a_toolPos(1) <= upper(1)) &&
+                   (a_toolPos(2) >= lower(2)) && (a_toolPos(2) <= upper(2)));
+
+    // grown bounds may be loose: test again with exact ones
+    if (inside && a_batch.m_blockGrown[a_block])
+    {
+        updateBlock(a_batch, a_block);
+        return (isBlockInReach(a_batch, a_block, a_toolPos));
+    }
+    return (inside);
+}
+
+
+//==============================================================================
+/*!
+    This method adds the force of an effect to its object, which then
+    reports an interaction.
+
+    \param  a_object  Index of the object.
+    \param  a_force   Force of the effect in world coordinates.
+*/
+//==============================================================================
+void cEffectTable::addEvent(const int a_object, const double a_force[3])
+{
+    if (!m_eventObjects[a_object])
+    {
+        m_eventObjects[a_object] = true;
+        m_eventForces[a_object].zero();
+        m_events.push_back(a_object);
+    }
+    m_eventForces[a_object].add(a_force[0], a_force[1], a_force[2]);
+}
+
+
+//==============================================================================
+/*!
+    This method evaluates the surface effects (see cEffectSurface) and adds
+    their force: inside of a sphere, the tool is pushed to the nearest point
+    of its surface.
+
+    \param  a_toolPos  Position of the tool in world coordinates.
+    \param  a_force    Sum of the forces.
+*/
+//==============================================================================
+void cEffectTable::computeSurfaces(const cVector3d& a_toolPos, double a_force[3])
+{
+    cEffectBatch& batch = m_batches[C_EFFECT_TABLE_SURFACE];
+    int blocks = (int)(batch.m_blockMin.size());
+
+#if defined(C_EFFECT_TABLE_USE_SSE2)
+
+    const __m128d tx = _mm_set1_pd(a_toolPos(0));
+    const __m128d ty = _mm_set1_pd(a_toolPos(1));
+    const __m128d tz = _mm_set1_pd(a_toolPos(2));
+    const __m128d zero = _mm_setzero_pd();
+    const __m128d one = _mm_set1_pd(1.0);
+    __m128d fx = zero, fy = zero, fz = zero;
+
+    for (int block=0; block<blocks; block++)
+    {
+        if (!isBlockInReach(batch, block, a_toolPos)) { continue; }
+
+        int end = (block + 1) * C_EFFECT_TABLE_BLOCK_SIZE;
+        for (int i=block * C_EFFECT_TABLE_BLOCK_SIZE; i<end; i+=2)
+        {
+            __m128d dx = _mm_sub_pd(tx, _mm_loadu_pd(&batch.m_posX[i]));
+            __m128d dy = _mm_sub_pd(ty, _mm_loadu_pd(&batch.m_posY[i]));
+            __m128d dz = _mm_sub_pd(tz, _mm_loadu_pd(&batch.m_posZ[i]));
+            __m128d distance = _mm_sqrt_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(dx, dx),
+                _mm_mul_pd(dy, dy)), _mm_mul_pd(dz, dz)));
+            __m128d radius = _mm_loadu_pd(&batch.m_radius[i]);
+            __m128d inside = _mm_and_pd(_mm_cmple_pd(distance, radius),
+                                        _mm_cmpge_pd(radius, zero));
+            if (_mm_movemask_pd(inside) == 0) { continue; }
+
+            // stiffness * (surface point - tool), zero at the center
+            __m128d scale = _mm_mul_pd(_mm_loadu_pd(&batch.m_stiffness[i]),
+                                       _mm_sub_pd(_mm_div_pd(radius, distance), one));
+            scale = _mm_and_pd(scale, _mm_and_pd(inside, _mm_cmpgt_pd(distance, zero)));
+            __m128d x = _mm_mul_pd(scale, dx);
+            __m128d y = _mm_mul_pd(scale, dy);
+            __m128d z = _mm_mul_pd(scale, dz);
+            fx = _mm_add_pd(fx, x);
+            fy = _mm_add_pd(fy, y);
+            fz = _mm_add_pd(fz, z);
+
+            double lanes[3][2];
+            _mm_storeu_pd(lanes[0], x);
+            _mm_storeu_pd(lanes[1], y);
+            _mm_storeu_pd(lanes[2], z);
+            int mask = _mm_movemask_pd(inside);
+            for (int k=0; k<2; k++)
+            {
+                if (mask & (1 << k))
+                {
+                    double force[3] = { lanes[0][k], lanes[1][k], lanes[2][k] };
+                    addEvent(batch.m_object[i + k], force);
+                }
+            }
+        }
+    }
+
+    double sum[3][2];
+    _mm_storeu_pd(sum[0], fx);
+    _mm_storeu_pd(sum[1], fy);
+    _mm_storeu_pd(sum[2], fz);
+    for (int k=0; k<3; k++)
+    {
+        a_force[k] += sum[k][0] + sum[k][1];
+    }
+
+#else
+
+    for (int block=0; block<blocks; block++)
+    {
+        if (!isBlockInReach(batch, block, a_toolPos)) { continue; }
+
+        int end = (block + 1) * C_EFFECT_TABLE_BLOCK_SIZE;
+        for (int i=block * C_EFFECT_TABLE_BLOCK_SIZE; i<end; i++)
+        {
+            double d[3] = { a_toolPos(0) - batch.m_posX[i],
+                            a_toolPos(1) - batch.m_posY[i],
+                            a_toolPos(2) - batch.m_posZ[i] };
+            double distance = sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+            double radius = batch.m_radius[i];
+            if ((radius < 0.0) || (distance > radius)) { continue; }
+
+            // stiffness * (surface point - tool), zero at the center
+            double scale = (distance > 0.0) ? batch.m_stiffness[i] * (radius / distance - 1.0) : 0.0;
+            double force[3] = { scale * d[0], scale * d[1], scale * d[2] };
+            for (int k=0; k<3; k++)
+            {
+                a_force[k] += force[k];
+            }
+            addEvent(batch.m_object[i], force);
+        }
+    }
+
+#endif
+}
+
+
+//==============================================================================
+/*!
+    This method evaluates the viscosity effects (see cEffectViscosity) and
+    adds their force: inside of a sphere, the tool is slowed down.
+
+    \param  a_toolPos  Position of the tool in world coordinates.
+    \param  a_toolVel  Velocity of the tool in world coordinates.
+    \param  a_force    Sum of the forces.
+*/
+//==============================================================================
+void cEffectTable::computeViscosities(const cVector3d& a_toolPos,
+                                      const cVector3d& a_toolVel,
+                                      double a_force[3])
+{
+    cEffectBatch& batch = m_batches[C_EFFECT_TABLE_VISCOSITY];
+    int blocks = (int)(batch.m_blockMin.size());
+
+#if defined(C_EFFECT_TABLE_USE_SSE2)
+
+    const __m128d tx = _mm_set1_pd(a_toolPos(0));
+    const __m128d ty = _mm_set1_pd(a_toolPos(1));
+    const __m128d tz = _mm_set1_pd(a_toolPos(2));
+    const __m128d vx = _mm_set1_pd(-a_toolVel(0));
+    const __m128d vy = _mm_set1_pd(-a_toolVel(1));
+    const __m128d vz = _mm_set1_pd(-a_toolVel(2));
+    const __m128d zero = _mm_setzero_pd();
+    __m128d fx = zero, fy = zero, fz = zero;
+
+    for (int block=0; block<blocks; block++)
+    {
+        if (!isBlockInReach(batch, block, a_toolPos)) { continue; }
+
+        int end = (block + 1) * C_EFFECT_TABLE_BLOCK_SIZE;
+        for (int i=block * C_EFFECT_TABLE_BLOCK_SIZE; i<end; i+=2)
+        {
+            __m128d dx = _mm_sub_pd(tx, _mm_loadu_pd(&batch.m_posX[i]));
+            __m128d dy = _mm_sub_pd(ty, _mm_loadu_pd(&batch.m_posY[i]));
+            __m128d dz = _mm_sub_pd(tz, _mm_loadu_pd(&batch.m_posZ[i]));
+            __m128d distance = _mm_sqrt_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(dx, dx),
+                _mm_mul_pd(dy, dy)), _mm_mul_pd(dz, dz)));
+            __m128d radius = _mm_loadu_pd(&batch.m_radius[i]);
+            __m128d inside = _mm_and_pd(_mm_cmple_pd(distance, radius),
+                                        _mm_cmpge_pd(radius, zero));
+            if (_mm_movemask_pd(inside) == 0) { continue; }
+
+            // -viscosity * velocity
+            __m128d viscosity = _mm_and_pd(inside, _mm_loadu_pd(&batch.m_viscosity[i]));
+            __m128d x = _mm_mul_pd(viscosity, vx);
+            __m128d y = _mm_mul_pd(viscosity, vy);
+            __m128d z = _mm_mul_pd(viscosity, vz);
+            fx = _mm_add_pd(fx, x);
+            fy = _mm_add_pd(fy, y);
+            fz = _mm_add_pd(fz, z);
+
+            double lanes[3][2];
+            _mm_storeu_pd(lanes[0], x);
+            _mm_storeu_pd(lanes[1], y);
+            _mm_storeu_pd(lanes[2], z);
+            int mask = _mm_movemask_pd(inside);
+            for (int k=0; k<2; k++)
+            {
+                if (mask & (1 << k))
+                {
+                    double force[3] = { lanes[0][k], lanes[1][k], lanes[2][k] };
+                    addEvent(batch.m_object[i + k], force);
+                }
+            }
+        }
+    }
+
+    double sum[3][2];
+    _mm_storeu_pd(sum[0], fx);
+    _mm_storeu_pd(sum[1], fy);
+    _mm_storeu_pd(sum[2], fz);
+    for (int k=0; k<3; k++)
+    {
+        a_force[k] += sum[k][0] + sum[k][1];
+    }
+
+#else
+
+    for (int block=0; block<blocks; block++)
+    {
+        if (!isBlockInReach(batch, block, a_toolPos)) { continue; }
+
+        int end = (block + 1) * C_EFFECT_TABLE_BLOCK_SIZE;
+        for (int i=block * C_EFFECT_TABLE_BLOCK_SIZE; i<end; i++)
+        {
+            double d[3] = { a_toolPos(0) - batch.m_posX[i],
+                            a_toolPos(1) - batch.m_posY[i],
+                            a_toolPos(2) - batch.m_posZ[i] };
+            double distance = sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+            double radius = batch.m_radius[i];
+            if ((radius < 0.0) || (distance > radius)) { continue; }
+
+            // -viscosity * velocity
+            double viscosity = batch.m_viscosity[i];
+            double force[3] = { -viscosity * a_toolVel(0),
+                                -viscosity * a_toolVel(1),
+                                -viscosity * a_toolVel(2) };
+            for (int k=0; k<3; k++)
+            {
+                a_force[k] += force[k];
+            }
+            addEvent(batch.m_object[i], force);
+        }
+    }
+
+#endif
+}
+
+
+//==============================================================================
+/*!
+    This method evaluates the magnet effects (see cEffectMagnet) and adds
+    their force: near the surface of a sphere, the tool is attracted to it.
+
+    \param  a_toolPos  Position of the tool in world coordinates.
+    \param  a_force    Sum of the forces.
+*/
+//==============================================================================
+void cEffectTable::computeMagnets(const cVector3d& a_toolPos, double a_force[3])
+{
+    cEffectBatch& batch = m_batches[C_EFFECT_TABLE_MAGNET];
+    int blocks = (int)(batch.m_blockMin.size());
+
+#if defined(C_EFFECT_TABLE_USE_SSE2)
+
+    const __m128d tx = _mm_set1_pd(a_toolPos(0));
+    const __m128d ty = _mm_set1_pd(a_toolPos(1));
+    const __m128d tz = _mm_set1_pd(a_toolPos(2));
+    const __m128d zero = _mm_setzero_pd();
+    const __m128d sign = _mm_set1_pd(-0.0);
+    __m128d fx = zero, fy = zero, fz = zero;
+
+    for (int block=0; block<blocks; block++)
+    {
+        if (!isBlockInReach(batch, block, a_toolPos)) { continue; }
+
+        int end = (block + 1) * C_EFFECT_TABLE_BLOCK_SIZE;
+        for (int i=block * C_EFFECT_TABLE_BLOCK_SIZE; i<end; i+=2)
+        {
+            __m128d dx = _mm_sub_pd(tx, _mm_loadu_pd(&batch.m_posX[i]));
+            __m128d dy = _mm_sub_pd(ty, _mm_loadu_pd(&batch.m_posY[i]));
+            __m128d dz = _mm_sub_pd(tz, _mm_loadu_pd(&batch.m_posZ[i]));
+            __m128d distance = _mm_sqrt_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(dx, dx),
+                _mm_mul_pd(dy, dy)), _mm_mul_pd(dz, dz)));
+            __m128d radius = _mm_loadu_pd(&batch.m_radius[i]);
+            __m128d active = _mm_cmpge_pd(radius, zero);
+            __m128d inside = _mm_cmple_pd(distance, radius);
+            __m128d centered = _mm_cmpgt_pd(distance, zero);
+
+            // distance to the surface, zero at the center
+            __m128d surface = _mm_and_pd(centered, _mm_andnot_pd(sign, _mm_sub_pd(distance, radius)));
+            __m128d maxDistance = _mm_loadu_pd(&batch.m_magnetMaxDistance[i]);
+            __m128d hit = _mm_and_pd(_mm_and_pd(active, _mm_cmplt_pd(surface, maxDistance)),
+                                     _mm_or_pd(_mm_cmpnle_pd(distance, radius),
+                                               _mm_cmpneq_pd(_mm_loadu_pd(&batch.m_magnetInside[i]), zero)));
+            if (_mm_movemask_pd(hit) == 0) { continue; }
+
+            // stiffness below the knee, then decreasing to zero at the maximum distance
+            __m128d below = _mm_cmplt_pd(surface, _mm_loadu_pd(&batch.m_magnetKnee[i]));
+            __m128d magnitude = _mm_or_pd(
+                _mm_and_pd(below, _mm_mul_pd(_mm_loadu_pd(&batch.m_magnetStiffness[i]), surface)),
+                _mm_andnot_pd(below, _mm_mul_pd(_mm_loadu_pd(&batch.m_magnetSlope[i]),
+                                                _mm_sub_pd(maxDistance, surface))));
+
+            // along the normal, outwards inside of the object, otherwise
+            // inwards. At the center, the magnitude is zero
+            magnitude = _mm_xor_pd(_mm_div_pd(magnitude, distance), _mm_andnot_pd(inside, sign));
+            __m128d scale = _mm_and_pd(hit, _mm_and_pd(centered, magnitude));
+            __m128d x = _mm_mul_pd(scale, dx);
+            __m128d y = _mm_mul_pd(scale, dy);
+            __m128d z = _mm_mul_pd(scale, dz);
+            fx = _mm_add_pd(fx, x);
+            fy = _mm_add_pd(fy, y);
+            fz = _mm_add_pd(fz, z);
+
+            double lanes[3][2];
+            _mm_storeu_pd(lanes[0], x);
+            _mm_storeu_pd(lanes[1], y);
+            _mm_storeu_pd(lanes[2], z);
+            int mask = _mm_movemask_pd(hit);
+            for (int k=0; k<2; k++)
+            {
+                if (mask & (1 << k))
+                {
+                    double force[3] = { lanes[0][k], lanes[1][k], lanes[2][k] };
+                    addEvent(batch.m_object[i + k], force);
+                }
+            }
+        }
+    }
+
+    double sum[3][2];
+    _mm_storeu_pd(sum[0], fx);
+    _mm_storeu_pd(sum[1], fy);
+    _mm_storeu_pd(sum[2], fz);
+    for (int k=0; k<3; k++)
+    {
+        a_force[k] += sum[k][0] + sum[k][1];
+    }
+
+#else
+
+    for (int block=0; block<blocks; block++)
+    {
+        if (!isBlockInReach(batch, block, a_toolPos)) { continue; }
+
+        int end = (block + 1) * C_EFFECT_TABLE_BLOCK_SIZE;
+        for (int i=block * C_EFFECT_TABLE_BLOCK_SIZE; i<end; i++)
+        {
+            double d[3] = { a_toolPos(0) - batch.m_posX[i],
+                            a_toolPos(1) - batch.m_posY[i],
+                            a_toolPos(2) - batch.m_posZ[i] };
+            double distance = sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+            double radius = batch.m_radius[i];
+            bool inside = (distance <= radius);
+            if (radius < 0.0) { continue; }
+            if (inside && (batch.m_magnetInside[i] == 0.0)) { continue; }
+
+            // distance to the surface, zero at the center
+            double surface = (distance > 0.0) ? fabs(distance - radius) : 0.0;
+            double maxDistance = batch.m_magnetMaxDistance[i];
+            if (!(surface < maxDistance)) { continue; }
+
+            // stiffness below the knee, then decreasing to zero at the maximum distance
+            double magnitude = (surface < batch.m_magnetKnee[i]) ?
+                batch.m_magnetStiffness[i] * surface :
+                batch.m_magnetSlope[i] * (maxDistance - surface);
+
+            // along the normal, outwards inside of the object, otherwise inwards
+            double force[3] = { 0.0, 0.0, 0.0 };
+            if (distance > 0.0)
+            {
+                double scale = (inside ? magnitude : -magnitude) / distance;
+                force[0] = scale * d[0];
+                force[1] = scale * d[1];
+                force[2] = scale * d[2];
+            }
+            for (int k=0; k<3; k++)
+            {
+                a_force[k] += force[k];
+            }
+            addEvent(batch.m_object[i], force);
+        }
+    }
+
+#endif
+}
+
+
+//==============================================================================
+/*!
+    This method computes the force of all effects of the table for a tool.
+    The objects that produce a force report it to \p a_interactions, in their
+    reference frame, as cGenericObject::computeInteractions() does.
+
+    \param  a_toolPos       Position of the tool in world coordinates.
+    \param  a_toolVel       Velocity of the tool in world coordinates.
+    \param  a_IDN           Identification number of the force algorithm.
+    \param  a_interactions  Recorder of the interaction events.
+
+    \return Force in world coordinates.
+*/
+//==============================================================================
+cVector3d cEffectTable::computeForces(const cVector3d& a_toolPos,
+                                      const cVector3d& a_toolVel,
+                                      const unsigned int a_IDN,
+                                      cInteractionRecorder& a_interactions)
+{
+    double force[3] = { 0.0, 0.0, 0.0 };
+    computeSurfaces(a_toolPos, force);
+    computeViscosities(a_toolPos, a_toolVel, force);
+    computeMagnets(a_toolPos, force);
+
+    // report the objects in the order of the table
+    std::sort(m_events.begin(), m_events.end());
+    for (unsigned int i=0; i<m_events.size(); i++)
+    {
+        int index = m_events[i];
+        cGenericObject* object = m_objects[index];
+        m_eventObjects[index] = false;
+
+        cMatrix3d rotTrans;
+        object->m_globalRot.transr(rotTrans);
+        cVector3d toolPosLocal = cMul(rotTrans, cSub(a_toolPos, object->m_globalPos));
+        object->computeLocalInteraction(toolPosLocal, cMul(rotTrans, a_toolVel), a_IDN);
+
+        cInteractionEvent event;
+        event.m_object = object;
+        event.m_isInside = object->m_interactionInside;
+        event.m_localPos = toolPosLocal;
+        event.m_localSurfacePos = object->m_interactionPoint;
+        event.m_localNormal = object->m_interactionNormal;
+        event.m_localForce = cMul(rotTrans, m_eventForces[index]);
+        a_interactions.m_interactions.push_back(event);
+    }
+    m_events.clear();
+
+    return (cVector3d(force[0], force[1], force[2]));
+}
+
+
+//------------------------------------------------------------------------------
+} // namespace chai3d
+//------------------------------------------------------------------------------
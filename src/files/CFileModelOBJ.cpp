@@ -44,6 +44,8 @@
 
 //------------------------------------------------------------------------------
 #include "files/CFileModelOBJ.h"
+#include "system/CMappedFile.h"
+#include "system/CThread.h"
 //------------------------------------------------------------------------------
 #include <iostream>
 #include <iomanip>
@@ -52,6 +54,10 @@
 #include <algorithm>
 #include <string>
 #include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <unordered_map>
+#include <new>
 //------------------------------------------------------------------------------
 using namespace std;
 //------------------------------------------------------------------------------
@@ -63,135 +69,816 @@ namespace chai3d {
 
 //------------------------------------------------------------------------------
 bool g_objLoaderShouldGenerateExtraVertices = false;
+bool g_objLoaderUseLegacyParser = false;
 //------------------------------------------------------------------------------
 
 //==============================================================================
 /*!
-    This function loads an OBJ 3D model from a file into a cMultiMesh structure.
-    If the operation succeeds, then the functions returns __true__ and the
-    3D model is loaded into cMultiMesh.
-    If the operation fails, then the function returns __false__.
+    This function replaces the meshes of a cMultiMesh by one mesh per material
+    (or a single mesh if there are no materials) and sets up their material
+    properties and textures.
+
+    \param  a_object        Multimesh object.
+    \param  a_materials     Materials read from the material libraries.
+    \param  a_numMaterials  Number of materials.
+    \param  a_filename      Filename of the OBJ file.
+*/
+//==============================================================================
+static void cOBJCreateMeshes(cMultiMesh* a_object,
+                             const cMaterialInfo* a_materials,
+                             const int a_numMaterials,
+                             const std::string& a_filename)
+{
+    // clear all vertices and triangle of current mesh
+    a_object->deleteAllMeshes();
 
-    \param  a_object    Multimesh object.
-    \param  a_filename  Filename.
+    // object has no material properties
+    if (a_numMaterials == 0)
+    {
+        // create a new child
+        cMesh *newMesh = a_object->newMesh();
+        newMesh->setUseMaterial(true);
+        newMesh->setUseTransparency(false);
+    }
 
-    \return __true__ if in case of success, __false__ otherwise.
-*/
+    // object has material properties. Create a child for each material
+    // property.
+    else
+    {
+        int i = 0;
+        bool found_transparent_material = false;
+
+        while (i < a_numMaterials)
+        {
+            // create a new child
+            cMesh *newMesh = a_object->newMesh();
+
+            // use materials
+            newMesh->setUseMaterial(true);
+
+            // get next material
+            cMaterialInfo material = a_materials[i];
+
+            int textureId = material.m_textureID;
+            if (textureId >= 1)
+            {
+                cTexture2dPtr newTexture = cTexture2d::create();
+                bool result = newTexture->loadFromFile(material.m_texture);
+
+                // If this didn't work out, try again in the obj file's path
+                if (result == false) 
+                {
+                    string model_dir = cGetDirectory(a_filename);
+
+                    char new_texture_path[1024];
+                    sprintf(new_texture_path,"%s/%s",model_dir.c_str(),material.m_texture);
+
+                    result = newTexture->loadFromFile(new_texture_path);
+                }
+
+                if (result)
+                {
+                    newMesh->setTexture(newTexture);
+                    newMesh->setUseTexture(true);
+                }
+            }
+
+            float alpha = material.m_alpha;
+            if (alpha < 1.0) 
+            {
+                newMesh->setUseTransparency(true, false);
+                found_transparent_material = true;
+            }
+
+            // get ambient component:
+            newMesh->m_material->m_ambient.setR(material.m_ambient[0]);
+            newMesh->m_material->m_ambient.setG(material.m_ambient[1]);
+            newMesh->m_material->m_ambient.setB(material.m_ambient[2]);
+            newMesh->m_material->m_ambient.setA(alpha);
+
+            // get diffuse component:
+            newMesh->m_material->m_diffuse.setR(material.m_diffuse[0]);
+            newMesh->m_material->m_diffuse.setG(material.m_diffuse[1]);
+            newMesh->m_material->m_diffuse.setB(material.m_diffuse[2]);
+            newMesh->m_material->m_diffuse.setA(alpha);
+
+            // get specular component:
+            newMesh->m_material->m_specular.setR(material.m_specular[0]);
+            newMesh->m_material->m_specular.setG(material.m_specular[1]);
+            newMesh->m_material->m_specular.setB(material.m_specular[2]);
+            newMesh->m_material->m_specular.setA(alpha);
+
+            // get emissive component:
+            newMesh->m_material->m_emission.setR(material.m_emmissive[0]);
+            newMesh->m_material->m_emission.setG(material.m_emmissive[1]);
+            newMesh->m_material->m_emission.setB(material.m_emmissive[2]);
+            newMesh->m_material->m_emission.setA(alpha);
+
+            // get shininess
+            newMesh->m_material->setShininess((GLuint)(1.28 * material.m_shininess));
+
+            i++;
+        }
+
+        // Enable material property rendering
+        a_object->setUseVertexColors(false, true);
+        a_object->setUseMaterial(true, true);
+
+        // Mark the presence of transparency in the root mesh; don't
+        // modify the value stored in children...
+        a_object->setUseTransparency(found_transparent_material, false);
+    }
+}
+
+
+//------------------------------------------------------------------------------
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+//------------------------------------------------------------------------------
 //==============================================================================
-bool cLoadFileOBJ(cMultiMesh* a_object, const std::string& a_filename)
+// PARALLEL OBJ PARSER IMPLEMENTATION:
+//==============================================================================
+
+// Files are split into chunks of at least this size, parsed in parallel
+static const size_t C_OBJ_MIN_CHUNK_SIZE = 1 << 20;
+
+// Powers of ten that are exactly representable as doubles
+static const double C_OBJ_POW10[23] =
 {
-    try
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// Array of plain values parsed from the file. Its memory grows with realloc(),
+// which moves the pages of large blocks instead of copying them (and
+// std::vector copies every element when it grows).
+template <typename T> class cOBJArray
+{
+public:
+    cOBJArray() : m_data(NULL), m_size(0), m_capacity(0) {}
+    ~cOBJArray() { free(m_data); }
+
+    size_t size() const { return (m_size); }
+    bool empty() const { return (m_size == 0); }
+    T* data() { return (m_data); }
+    const T* data() const { return (m_data); }
+    T& operator[](const size_t a_index) { return (m_data[a_index]); }
+    const T& operator[](const size_t a_index) const { return (m_data[a_index]); }
+
+    void push_back(const T& a_value)
     {
-        cOBJModel fileObj;
+        if (m_size == m_capacity) { grow(m_size + 1); }
+        m_data[m_size++] = a_value;
+    }
 
-        // load file into memory. If an error occurs, exit.
-        if (!fileObj.LoadModel(a_filename.c_str())) { return (false); }
+    void append(const T* a_values, const size_t a_count)
+    {
+        if (m_size + a_count > m_capacity) { grow(m_size + a_count); }
+        memcpy(m_data + m_size, a_values, a_count * sizeof(T));
+        m_size += a_count;
+    }
 
-        // clear all vertices and triangle of current mesh
-        a_object->deleteAllMeshes();
+    void resize(const size_t a_size, const T& a_value)
+    {
+        if (a_size > m_capacity) { grow(a_size); }
+        for (size_t i=m_size; i<a_size; i++) { m_data[i] = a_value; }
+        m_size = a_size;
+    }
 
-        // get information about file
-        int numMaterials = fileObj.m_OBJInfo.m_materialCount;
+    void clear()
+    {
+        free(m_data);
+        m_data = NULL;
+        m_size = 0;
+        m_capacity = 0;
+    }
+
+private:
+    cOBJArray(const cOBJArray&);
+    cOBJArray& operator=(const cOBJArray&);
+
+    void grow(const size_t a_size)
+    {
+        size_t capacity = cMax(cMax(a_size, 2 * m_capacity), (size_t)1024);
+        T* data = (T*)realloc(m_data, capacity * sizeof(T));
+        if (data == NULL) { throw std::bad_alloc(); }
+        m_data = data;
+        m_capacity = capacity;
+    }
+
+    T* m_data;
+    size_t m_size;
+    size_t m_capacity;
+};
+
+// Statement that changes the state of the faces that follow it
+struct cOBJStatement
+{
+    enum cOBJStatementType { C_OBJ_MTL_LIB, C_OBJ_USE_MTL, C_OBJ_GROUP };
+
+    cOBJStatementType m_type;
+
+    // number of faces of the chunk that precede the statement
+    size_t m_faceIndex;
+
+    std::string m_value;
+};
+
+// Data parsed from a range of lines of an OBJ file
+struct cOBJChunk
+{
+    cOBJArray<float> m_positions;
+
+    // colors of the vertices, 0 until the first vertex with a color (empty if
+    // no vertex of the chunk has one)
+    cOBJArray<float> m_colors;
+    cOBJArray<float> m_texCoords;
+    cOBJArray<float> m_normals;
+
+    // vertex, texture coordinate and normal index of each face corner
+    // (starting at 0, -1 if absent)
+    cOBJArray<int> m_corners;
+
+    // number of corners of each face
+    cOBJArray<unsigned int> m_faceSizes;
+
+    // entries of m_corners given relative to the start of the chunk
+    // (negative indices in the file)
+    cOBJArray<size_t> m_relativeCorners;
+
+    std::vector<cOBJStatement> m_statements;
+
+    bool m_hasColors;
+    bool m_error;
+
+    cOBJChunk() : m_hasColors(false), m_error(false) {}
+};
+
+// Key identifying a vertex of a mesh, as in vertexIndexSet
+struct cOBJVertexKey
+{
+    int m_mesh;
+    int m_vIndex;
+    int m_nIndex;
+    int m_tIndex;
+
+    bool operator==(const cOBJVertexKey& a_key) const
+    {
+        return ((m_mesh == a_key.m_mesh) && (m_vIndex == a_key.m_vIndex) &&
+                (m_nIndex == a_key.m_nIndex) && (m_tIndex == a_key.m_tIndex));
+    }
+};
+
+struct cOBJVertexKeyHash
+{
+    size_t operator()(const cOBJVertexKey& a_key) const
+    {
+        unsigned long long h = (unsigned int)a_key.m_vIndex;
+        h = h * 0x9E3779B97F4A7C15ULL + (unsigned int)a_key.m_nIndex;
+        h = h * 0x9E3779B97F4A7C15ULL + (unsigned int)a_key.m_tIndex;
+        h = h * 0x9E3779B97F4A7C15ULL + (unsigned int)a_key.m_mesh;
+        return ((size_t)(h ^ (h >> 32)));
+    }
+};
+
+// Vertices and triangles of one mesh, filled in bulk once all faces are read
+struct cOBJMeshData
+{
+    // position and texture coordinate index of each vertex (-1 if absent)
+    cOBJArray<int> m_vertexPositions;
+    cOBJArray<int> m_vertexTexCoords;
+
+    // normal of each vertex: the index of a normal of the file, -1 if absent,
+    // or -2 - t for the normal computed for triangle t
+    cOBJArray<int> m_vertexNormals;
+
+    // vertices of each triangle
+    cOBJArray<unsigned int> m_triangles;
+
+    // group name last assigned to the mesh
+    int m_group;
+
+    cOBJMeshData() : m_group(-1) {}
+
+    unsigned int newVertex(const int a_position)
+    {
+        m_vertexPositions.push_back(a_position);
+        m_vertexTexCoords.push_back(-1);
+        m_vertexNormals.push_back(-1);
+        return ((unsigned int)(m_vertexPositions.size()) - 1);
+    }
+};
+
+//------------------------------------------------------------------------------
+
+// returns true if cTriangleArray::computeNormal() finds a normal for a
+// triangle with these vertices, false if the triangle is degenerate
+static inline bool cOBJHasComputedNormal(const cVector3d& a_pos0,
+                                         const cVector3d& a_pos1,
+                                         const cVector3d& a_pos2)
+{
+    cVector3d normal, v01, v02;
+    a_pos1.subr(a_pos0, v01);
+    a_pos2.subr(a_pos0, v02);
+    v01.crossr(v02, normal);
+    return (normal.length() > 0.0);
+}
+
+//------------------------------------------------------------------------------
+
+// The functions below parse lines that end with '\n': the line feed stops
+// every scan, so that characters are not compared to the end of the line.
+
+static inline bool cOBJIsBlank(const char a_c)
+{
+    return ((a_c == ' ') || (a_c == '\t') || (a_c == '\r'));
+}
+
+//------------------------------------------------------------------------------
+
+// skips blanks, returns false if the end of the line is reached
+static inline bool cOBJSkipBlanks(const char*& a_p)
+{
+    while (cOBJIsBlank(*a_p)) { a_p++; }
+    return (*a_p != '\n');
+}
+
+//------------------------------------------------------------------------------
+
+static inline const char* cOBJTokenEnd(const char* a_p)
+{
+    while (!cOBJIsBlank(*a_p) && (*a_p != '\n')) { a_p++; }
+    return (a_p);
+}
+
+//------------------------------------------------------------------------------
+
+static inline bool cOBJIsDigit(const char a_c)
+{
+    return ((unsigned char)(a_c - '0') < 10);
+}
 
-        // extract materials
-        vector<cMaterial> materials;
+//------------------------------------------------------------------------------
+
+// returns the rest of the line as the original parser did: leading spaces
+// and the carriage return are removed
+static inline std::string cOBJRestOfLine(const char* a_p, const char* a_end)
+{
+    if ((a_end > a_p) && (*(a_end-1) == '\r')) { a_end--; }
+    while ((a_p < a_end) && (*a_p == ' ')) { a_p++; }
+    return (std::string(a_p, a_end));
+}
+
+//------------------------------------------------------------------------------
+
+static float cOBJStringToFloat(const char* a_begin, const char* a_end)
+{
+    char buffer[64];
+    size_t length = a_end - a_begin;
+    if (length < sizeof(buffer))
+    {
+        memcpy(buffer, a_begin, length);
+        buffer[length] = '\0';
+        return (strtof(buffer, NULL));
+    }
+    std::string str(a_begin, a_end);
+    return (strtof(str.c_str(), NULL));
+}
+
+//------------------------------------------------------------------------------
+
+// parses the next number of the line, returns false if there is none. The
+// result is the float strtof() returns: simple decimal numbers are converted
+// with a single correctly rounded double operation, others use strtof().
+static inline bool cOBJParseFloat(const char*& a_p, float& a_value)
+{
+    if (!cOBJSkipBlanks(a_p)) { return (false); }
+
+    const char* begin = a_p;
+    const char* p = begin;
+    bool negative = false;
+    if ((*p == '-') || (*p == '+'))
+    {
+        negative = (*p == '-');
+        p++;
+    }
 
-        // object has no material properties
-        if (numMaterials == 0)
+    // mantissa, kept below 2^53 so that it converts exactly to a double (a
+    // digit is added while it is at most maxMantissa)
+    const unsigned long long maxMantissa = 900719925474098ULL;
+    unsigned long long mantissa = 0;
+    int exponent = 0;
+    bool digits = cOBJIsDigit(*p);
+    bool exact = true;
+
+    while (cOBJIsDigit(*p))
+    {
+        if (mantissa <= maxMantissa) { mantissa = 10 * mantissa + (*p - '0'); }
+        else { exact = false; }
+        p++;
+    }
+    if (*p == '.')
+    {
+        p++;
+        digits = digits || cOBJIsDigit(*p);
+        while (cOBJIsDigit(*p))
         {
-            // create a new child
-            cMesh *newMesh = a_object->newMesh();
-            newMesh->setUseMaterial(true);
-            newMesh->setUseTransparency(false);
+            if (mantissa <= maxMantissa) { mantissa = 10 * mantissa + (*p - '0'); exponent--; }
+            else { exact = false; }
+            p++;
+        }
+    }
+    if (digits && ((*p == 'e') || (*p == 'E')))
+    {
+        p++;
+        bool negativeExponent = false;
+        if ((*p == '-') || (*p == '+'))
+        {
+            negativeExponent = (*p == '-');
+            p++;
+        }
+        if (!cOBJIsDigit(*p)) { exact = false; }
+        int value = 0;
+        while (cOBJIsDigit(*p))
+        {
+            if (value < 10000) { value = 10 * value + (*p - '0'); }
+            p++;
         }
+        exponent += negativeExponent ? -value : value;
+    }
 
-        // object has material properties. Create a child for each material
-        // property.
+    // not a simple decimal number (nan, inf, hexadecimal...): the whole
+    // token is converted
+    if (!cOBJIsBlank(*p) && (*p != '\n'))
+    {
+        p = cOBJTokenEnd(p);
+        exact = false;
+    }
+    a_p = p;
+    if (!digits || !exact || (exponent < -22) || (exponent > 22))
+    {
+        a_value = cOBJStringToFloat(begin, p);
+        return (true);
+    }
+
+    double value = (double)mantissa;
+    if (exponent < 0) { value /= C_OBJ_POW10[-exponent]; }
+    else              { value *= C_OBJ_POW10[exponent]; }
+
+    // rounding the double to a float gives the correctly rounded float unless
+    // the double lies exactly halfway between two floats, that is unless the
+    // 29 bits it has in excess end with a single one (the value is 0 or lies
+    // between 1e-22 and 1e38, where floats are normalized)
+    unsigned long long bits;
+    memcpy(&bits, &value, sizeof(bits));
+    if ((bits & 0x1FFFFFFFULL) == 0x10000000ULL)
+    {
+        a_value = cOBJStringToFloat(begin, p);
+        return (true);
+    }
+
+    float result = (float)value;
+    a_value = negative ? -result : result;
+    return (true);
+}
+
+//------------------------------------------------------------------------------
+
+static inline bool cOBJParseInt(const char*& a_p, int& a_value)
+{
+    bool negative = false;
+    if ((*a_p == '-') || (*a_p == '+'))
+    {
+        negative = (*a_p == '-');
+        a_p++;
+    }
+    if (!cOBJIsDigit(*a_p)) { return (false); }
+
+    long long value = 0;
+    while (cOBJIsDigit(*a_p))
+    {
+        if (value < 0x7FFFFFFF) { value = 10 * value + (*a_p - '0'); }
+        a_p++;
+    }
+    if (value > 0x7FFFFFFF) { value = 0x7FFFFFFF; }
+    a_value = (int)(negative ? -value : value);
+    return (true);
+}
+
+//------------------------------------------------------------------------------
+
+// converts an index of the file (starting at 1, or negative if relative to
+// the last element read) into an index starting at 0, for the entry
+// a_corner of the corners of the chunk
+static inline int cOBJIndex(cOBJChunk* a_chunk, const int a_index, const size_t a_count, const size_t a_corner)
+{
+    if (a_index > 0)
+    {
+        return (a_index - 1);
+    }
+    else if (a_index < 0)
+    {
+        a_chunk->m_relativeCorners.push_back(a_corner);
+        return ((int)a_count + a_index);
+    }
+    else
+    {
+        a_chunk->m_error = true;
+        return (-1);
+    }
+}
+
+//------------------------------------------------------------------------------
+
+// parses the corners of a face, returns the end of the line
+static const char* cOBJParseFace(const char* a_p, cOBJChunk* a_chunk)
+{
+    size_t numPositions = a_chunk->m_positions.size() / 3;
+    size_t numTexCoords = a_chunk->m_texCoords.size() / 3;
+    size_t numNormals = a_chunk->m_normals.size() / 3;
+
+    unsigned int numCorners = 0;
+    bool hasTexCoords = false;
+    bool hasNormals = false;
+    int texCoord = 0;
+    int normal = 0;
+
+    while (cOBJSkipBlanks(a_p))
+    {
+        // format: v, v/t, v//n or v/t/n, anything else up to the end of the
+        // token is ignored
+        int vertex = 0;
+        bool foundTexCoord = false;
+        bool foundNormal = false;
+        if (!cOBJParseInt(a_p, vertex))
+        {
+            a_p = cOBJTokenEnd(a_p);
+            continue;
+        }
+        if (*a_p == '/')
+        {
+            a_p++;
+            foundTexCoord = cOBJParseInt(a_p, texCoord);
+            if (*a_p == '/')
+            {
+                a_p++;
+                foundNormal = cOBJParseInt(a_p, normal);
+            }
+        }
+        a_p = cOBJTokenEnd(a_p);
+
+        // the format of the first corner applies to the whole face; corners
+        // with missing indices reuse the previous ones
+        if (numCorners == 0)
+        {
+            hasTexCoords = foundTexCoord;
+            hasNormals = foundNormal;
+        }
+
+        size_t index = a_chunk->m_corners.size();
+        int corner[3];
+        corner[0] = cOBJIndex(a_chunk, vertex, numPositions, index);
+        corner[1] = hasTexCoords ? cOBJIndex(a_chunk, texCoord, numTexCoords, index + 1) : -1;
+        corner[2] = hasNormals ? cOBJIndex(a_chunk, normal, numNormals, index + 2) : -1;
+        a_chunk->m_corners.append(corner, 3);
+
+        numCorners++;
+    }
+
+    a_chunk->m_faceSizes.push_back(numCorners);
+    return (a_p);
+}
+
+//------------------------------------------------------------------------------
+
+// parses the line that starts at a_p and ends with '\n' before a_end,
+// returns the start of the next line
+static const char* cOBJParseLine(const char* a_p, const char* a_end, cOBJChunk* a_chunk)
+{
+    const char* p = a_p;
+    if (cOBJSkipBlanks(p))
+    {
+        const char* keyword = p;
+        p = cOBJTokenEnd(p);
+        size_t length = p - keyword;
+
+        // vertex position and optional color
+        if ((length == 1) && (keyword[0] == 'v'))
+        {
+            float value[6] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+            int count = 0;
+            while ((count < 6) && cOBJParseFloat(p, value[count])) { count++; }
+            a_chunk->m_positions.append(value, 3);
+
+            // colors are stored from the first vertex that has one
+            if ((count > 3) && !a_chunk->m_hasColors)
+            {
+                a_chunk->m_colors.resize(a_chunk->m_positions.size() - 3, 0.0f);
+                a_chunk->m_hasColors = true;
+            }
+            if (a_chunk->m_hasColors)
+            {
+                a_chunk->m_colors.append(value + 3, 3);
+            }
+        }
+
+        // texture coordinate
+        else if ((length == 2) && (keyword[0] == 'v') && (keyword[1] == 't'))
+        {
+            float value[3] = { 0.0f, 0.0f, 0.0f };
+            int count = 0;
+            while ((count < 3) && cOBJParseFloat(p, value[count])) { count++; }
+            a_chunk->m_texCoords.append(value, 3);
+        }
+
+        // vertex normal
+        else if ((length == 2) && (keyword[0] == 'v') && (keyword[1] == 'n'))
+        {
+            float value[3] = { 0.0f, 0.0f, 0.0f };
+            int count = 0;
+            while ((count < 3) && cOBJParseFloat(p, value[count])) { count++; }
+            a_chunk->m_normals.append(value, 3);
+        }
+
+        // face
+        else if ((length == 1) && (keyword[0] == 'f'))
+        {
+            p = cOBJParseFace(p, a_chunk);
+        }
+
+        // group, material and material library
         else
         {
-            int i = 0;
-            bool found_transparent_material = false;
+            cOBJStatement statement;
+            bool found = true;
+            if ((length == 1) && (keyword[0] == 'g'))
+            {
+                statement.m_type = cOBJStatement::C_OBJ_GROUP;
+            }
+            else if ((length == 6) && (strncmp(keyword, C_OBJ_USE_MTL_ID, 6) == 0))
+            {
+                statement.m_type = cOBJStatement::C_OBJ_USE_MTL;
+            }
+            else if ((length == 6) && (strncmp(keyword, C_OBJ_MTL_LIB_ID, 6) == 0))
+            {
+                statement.m_type = cOBJStatement::C_OBJ_MTL_LIB;
+            }
+            else
+            {
+                found = false;
+            }
 
-            while (i < numMaterials)
+            if (found)
             {
-                // create a new child
-                cMesh *newMesh = a_object->newMesh();
+                const char* lineEnd = (const char*)memchr(p, '\n', a_end - p);
+                statement.m_faceIndex = a_chunk->m_faceSizes.size();
+                statement.m_value = cOBJRestOfLine(p, lineEnd);
+                a_chunk->m_statements.push_back(statement);
+            }
+        }
+    }
 
-                // use materials
-                newMesh->setUseMaterial(true);
+    // skip values beyond the ones read, comments and unknown statements
+    if (*p != '\n')
+    {
+        p = (const char*)memchr(p, '\n', a_end - p);
+    }
+    return (p + 1);
+}
 
-                // get next material
-                cMaterialInfo material = fileObj.m_pMaterials[i];
+//------------------------------------------------------------------------------
 
-                int textureId = material.m_textureID;
-                if (textureId >= 1)
-                {
-                    cTexture2dPtr newTexture = cTexture2d::create();
-                    bool result = newTexture->loadFromFile(material.m_texture);
+// parses the lines in [a_begin, a_end)
+static void cOBJParseChunk(const char* a_begin, const char* a_end, cOBJChunk* a_chunk)
+{
+    try
+    {
+        // the last line of the file is copied if it does not end with '\n'
+        const char* end = a_end;
+        while ((end > a_begin) && (*(end-1) != '\n')) { end--; }
 
-                    // If this didn't work out, try again in the obj file's path
-                    if (result == false) 
-                    {
-                        string model_dir = cGetDirectory(a_filename);
+        const char* p = a_begin;
+        while (p < end)
+        {
+            p = cOBJParseLine(p, end, a_chunk);
+        }
 
-                        char new_texture_path[1024];
-                        sprintf(new_texture_path,"%s/%s",model_dir.c_str(),material.m_texture);
+        if (end < a_end)
+        {
+            std::string line(end, a_end);
+            line.push_back('\n');
+            cOBJParseLine(line.c_str(), line.c_str() + line.size(), a_chunk);
+        }
+    }
+    catch (...)
+    {
+        a_chunk->m_error = true;
+    }
+}
 
-                        result = newTexture->loadFromFile(new_texture_path);
-                    }
+//------------------------------------------------------------------------------
 
-                    if (result)
-                    {
-                        newMesh->setTexture(newTexture);
-                        newMesh->setUseTexture(true);
-                    }
-                }
+// loads a material library (.mtl) and appends its materials to a_materials,
+// with the same interpretation of each property as cOBJModel
+static void cOBJLoadMaterialLib(const std::string& a_filename,
+                                const std::string& a_basePath,
+                                std::vector<cMaterialInfo>& a_materials)
+{
+    ifstream file(a_filename.c_str(), ios::in | ios::binary);
+    if (!file.is_open()) { return; }
 
-                float alpha = material.m_alpha;
-                if (alpha < 1.0) 
-                {
-                    newMesh->setUseTransparency(true, false);
-                    found_transparent_material = true;
-                }
+    // properties set before the first material apply to it
+    std::vector<cMaterialInfo> materials(1);
+    bool firstMaterial = true;
+
+    std::string line;
+    while (std::getline(file, line))
+    {
+        line.push_back('\n');
+        const char* p = line.c_str();
+        const char* end = p + line.size() - 1;
+        if (!cOBJSkipBlanks(p)) { continue; }
 
-                // get ambient component:
-                newMesh->m_material->m_ambient.setR(material.m_ambient[0]);
-                newMesh->m_material->m_ambient.setG(material.m_ambient[1]);
-                newMesh->m_material->m_ambient.setB(material.m_ambient[2]);
-                newMesh->m_material->m_ambient.setA(alpha);
-
-                // get diffuse component:
-                newMesh->m_material->m_diffuse.setR(material.m_diffuse[0]);
-                newMesh->m_material->m_diffuse.setG(material.m_diffuse[1]);
-                newMesh->m_material->m_diffuse.setB(material.m_diffuse[2]);
-                newMesh->m_material->m_diffuse.setA(alpha);
-
-                // get specular component:
-                newMesh->m_material->m_specular.setR(material.m_specular[0]);
-                newMesh->m_material->m_specular.setG(material.m_specular[1]);
-                newMesh->m_material->m_specular.setB(material.m_specular[2]);
-                newMesh->m_material->m_specular.setA(alpha);
-
-                // get emissive component:
-                newMesh->m_material->m_emission.setR(material.m_emmissive[0]);
-                newMesh->m_material->m_emission.setG(material.m_emmissive[1]);
-                newMesh->m_material->m_emission.setB(material.m_emmissive[2]);
-                newMesh->m_material->m_emission.setA(alpha);
-
-                // get shininess
-                newMesh->m_material->setShininess((GLuint)(1.28 * material.m_shininess));
+        const char* keyword = p;
+        p = cOBJTokenEnd(p);
+        std::string id(keyword, p);
+        cMaterialInfo& material = materials.back();
 
-                i++;
+        if (id == C_OBJ_NEW_MTL_ID)
+        {
+            if (firstMaterial) { firstMaterial = false; }
+            else               { materials.push_back(cMaterialInfo()); }
+            std::string name = cOBJRestOfLine(p, end);
+            strncpy(materials.back().m_name, name.c_str(), sizeof(material.m_name) - 1);
+            materials.back().m_name[sizeof(material.m_name) - 1] = '\0';
+        }
+        else if (id == C_OBJ_MTL_ALPHA_ID_ALT)
+        {
+            float value;
+            if (cOBJParseFloat(p, value)) { material.m_alpha = 1.0f - value; }
+        }
+        else if (id == C_OBJ_MTL_ALPHA_ID)
+        {
+            float value;
+            if (cOBJParseFloat(p, value)) { material.m_alpha = value; }
+        }
+        else if ((id == C_OBJ_MTL_AMBIENT_ID) || (id == C_OBJ_MTL_DIFFUSE_ID) || (id == C_OBJ_MTL_SPECULAR_ID))
+        {
+            float* color = (id == C_OBJ_MTL_AMBIENT_ID) ? material.m_ambient :
+                           (id == C_OBJ_MTL_DIFFUSE_ID) ? material.m_diffuse : material.m_specular;
+            for (int i=0; i<3; i++)
+            {
+                if (!cOBJParseFloat(p, color[i])) { break; }
             }
+        }
+        else if (id == C_OBJ_MTL_TEXTURE_ID)
+        {
+            std::string texture = a_basePath + cOBJRestOfLine(p, end);
+            strncpy(material.m_texture, texture.c_str(), sizeof(material.m_texture) - 1);
+            material.m_texture[sizeof(material.m_texture) - 1] = '\0';
+            material.m_textureID = 1;
+        }
+        else if (id == C_OBJ_MTL_SHININESS_ID)
+        {
+            float value;
+            if (cOBJParseFloat(p, value)) { material.m_shininess = value * 1.28f; }
+        }
+    }
+
+    if (!firstMaterial)
+    {
+        a_materials.insert(a_materials.end(), materials.begin(), materials.end());
+    }
+}
+
+//------------------------------------------------------------------------------
+#endif  // DOXYGEN_SHOULD_SKIP_THIS
+//------------------------------------------------------------------------------
 
-            // Enable material property rendering
-            a_object->setUseVertexColors(false, true);
-            a_object->setUseMaterial(true, true);
 
-            // Mark the presence of transparency in the root mesh; don't
-            // modify the value stored in children...
-            a_object->setUseTransparency(found_transparent_material, false);
-        }
+//==============================================================================
+/*!
+    This function loads an OBJ 3D model from a file into a cMultiMesh structure
+    with the original cOBJModel parser. It is used instead of the parallel
+    parser when \ref g_objLoaderUseLegacyParser is __true__.
+
+    \param  a_object    Multimesh object.
+    \param  a_filename  Filename.
+
+    \return __true__ if in case of success, __false__ otherwise.
+*/
+//==============================================================================
+static bool cLoadFileOBJLegacy(cMultiMesh* a_object, const std::string& a_filename)
+{
+    try
+    {
+        cOBJModel fileObj;
+
+        // load file into memory. If an error occurs, exit.
+        if (!fileObj.LoadModel(a_filename.c_str())) { return (false); }
+
+        // create one mesh per material
+        int numMaterials = fileObj.m_OBJInfo.m_materialCount;
+        cOBJCreateMeshes(a_object, fileObj.m_pMaterials, numMaterials, a_filename);
 
         // Keep track of vertex mapping in each mesh; maps "old" vertices
         // to new vertices
@@ -365,6 +1052,424 @@ bool cLoadFileOBJ(cMultiMesh* a_object, const std::string& a_filename)
 }
 
 
+//==============================================================================
+/*!
+    This function loads an OBJ 3D model from a file into a cMultiMesh structure.
+    The file is memory mapped and split into chunks of lines that are parsed
+    in parallel. Chunks are then merged in file order, so that the resulting
+    meshes are identical to the ones created by the original parser.
+
+    \param  a_object    Multimesh object.
+    \param  a_filename  Filename.
+
+    \return __true__ if in case of success, __false__ otherwise.
+*/
+//==============================================================================
+static bool cLoadFileOBJParallel(cMultiMesh* a_object, const std::string& a_filename)
+{
+    try
+    {
+        ////////////////////////////////////////////////////////////////////////
+        // PARSE FILE
+        ////////////////////////////////////////////////////////////////////////
+
+        cMappedFilePtr file = cMappedFile::create();
+        if (!file->open(a_filename)) { return (C_ERROR); }
+
+        const char* data = (const char*)file->getData();
+        size_t size = file->getSize();
+
+        // split file into chunks of whole lines
+        size_t numThreads = cGetNumHardwareThreads();
+        size_t numChunks = cMin(numThreads, size / C_OBJ_MIN_CHUNK_SIZE + 1);
+
+        std::vector<size_t> bounds(numChunks + 1, size);
+        bounds[0] = 0;
+        for (size_t i=1; i<numChunks; i++)
+        {
+            size_t position = cMax(bounds[i-1], i * (size / numChunks));
+            const char* lineEnd = (const char*)memchr(data + position, '\n', size - position);
+            bounds[i] = (lineEnd == NULL) ? size : (lineEnd - data) + 1;
+        }
+
+        std::vector<cOBJChunk> chunks(numChunks);
+        cParallelFor((unsigned int)numChunks, [&](unsigned int a_index)
+        {
+            cOBJParseChunk(data + bounds[a_index], data + bounds[a_index+1], &chunks[a_index]);
+        });
+
+
+        ////////////////////////////////////////////////////////////////////////
+        // MERGE CHUNKS
+        ////////////////////////////////////////////////////////////////////////
+
+        // offsets of each chunk in the merged lists
+        std::vector<size_t> positionOffsets(numChunks + 1, 0);
+        std::vector<size_t> texCoordOffsets(numChunks + 1, 0);
+        std::vector<size_t> normalOffsets(numChunks + 1, 0);
+        size_t numFaces = 0;
+        bool hasColors = false;
+        for (size_t i=0; i<numChunks; i++)
+        {
+            if (chunks[i].m_error) { return (C_ERROR); }
+            positionOffsets[i+1] = positionOffsets[i] + chunks[i].m_positions.size() / 3;
+            texCoordOffsets[i+1] = texCoordOffsets[i] + chunks[i].m_texCoords.size() / 3;
+            normalOffsets[i+1] = normalOffsets[i] + chunks[i].m_normals.size() / 3;
+            numFaces += chunks[i].m_faceSizes.size();
+            hasColors = hasColors || chunks[i].m_hasColors;
+        }
+
+        size_t numPositions = positionOffsets[numChunks];
+        size_t numTexCoords = texCoordOffsets[numChunks];
+        size_t numNormals = normalOffsets[numChunks];
+
+        std::vector<cVector3d> positions(numPositions);
+        std::vector<cVector3d> texCoords(numTexCoords);
+        std::vector<cVector3d> normals(numNormals);
+        std::vector<cColorf> colors((numFaces == 0) ? numPositions : 0);
+        std::vector<char> valid(numChunks, 1);
+
+        // convert data and make all indices absolute, in parallel
+        cParallelFor((unsigned int)numChunks, [&](unsigned int a_index)
+        {
+            cOBJChunk& chunk = chunks[a_index];
+
+            for (size_t j=0; j<chunk.m_positions.size()/3; j++)
+            {
+                positions[positionOffsets[a_index] + j].set(chunk.m_positions[3*j], chunk.m_positions[3*j+1], chunk.m_positions[3*j+2]);
+            }
+            for (size_t j=0; j<chunk.m_texCoords.size()/3; j++)
+            {
+                texCoords[texCoordOffsets[a_index] + j].set(chunk.m_texCoords[3*j], chunk.m_texCoords[3*j+1], chunk.m_texCoords[3*j+2]);
+            }
+            for (size_t j=0; j<chunk.m_normals.size()/3; j++)
+            {
+                cVector3d& normal = normals[normalOffsets[a_index] + j];
+                normal.set(chunk.m_normals[3*j], chunk.m_normals[3*j+1], chunk.m_normals[3*j+2]);
+                normal.normalize();
+            }
+            for (size_t j=0; j<colors.size() && j<chunk.m_positions.size()/3; j++)
+            {
+                if (chunk.m_colors.empty())
+                {
+                    colors[positionOffsets[a_index] + j].set(0.0f, 0.0f, 0.0f);
+                }
+                else
+                {
+                    colors[positionOffsets[a_index] + j].set(chunk.m_colors[3*j], chunk.m_colors[3*j+1], chunk.m_colors[3*j+2]);
+                }
+            }
+
+            const size_t offsets[3] = { positionOffsets[a_index], texCoordOffsets[a_index], normalOffsets[a_index] };
+            for (size_t j=0; j<chunk.m_relativeCorners.size(); j++)
+            {
+                size_t k = chunk.m_relativeCorners[j];
+                chunk.m_corners[k] += (int)offsets[k % 3];
+            }
+
+            const size_t counts[3] = { numPositions, numTexCoords, numNormals };
+            for (size_t k=0; k<chunk.m_corners.size(); k++)
+            {
+                int index = chunk.m_corners[k];
+                if ((index < -1) || ((index == -1) && (k % 3 == 0)) || (index >= (int)counts[k % 3]))
+                {
+                    valid[a_index] = 0;
+                    break;
+                }
+            }
+        });
+
+        for (size_t i=0; i<numChunks; i++)
+        {
+            if (!valid[i]) { return (C_ERROR); }
+        }
+
+
+        ////////////////////////////////////////////////////////////////////////
+        // MATERIALS
+        ////////////////////////////////////////////////////////////////////////
+
+        // path of the file, with a trailing separator
+        std::string basePath = a_filename.substr(0, a_filename.find_last_of("/\\") + 1);
+
+        std::vector<cMaterialInfo> materials;
+        for (size_t i=0; i<numChunks; i++)
+        {
+            for (size_t j=0; j<chunks[i].m_statements.size(); j++)
+            {
+                const cOBJStatement& statement = chunks[i].m_statements[j];
+                if (statement.m_type == cOBJStatement::C_OBJ_MTL_LIB)
+                {
+                    cOBJLoadMaterialLib(basePath + statement.m_value, basePath, materials);
+                }
+            }
+        }
+
+        int numMaterials = (int)(materials.size());
+        cOBJCreateMeshes(a_object, materials.data(), numMaterials, a_filename);
+
+
+        ////////////////////////////////////////////////////////////////////////
+        // POINT CLOUD
+        ////////////////////////////////////////////////////////////////////////
+
+        if (numFaces == 0)
+        {
+            cMesh* mesh = a_object->getMesh(0);
+            if (numPositions > 0)
+            {
+                int first = mesh->m_vertices->newVertices((unsigned int)numPositions);
+                for (size_t j=0; j<numPositions; j++)
+                {
+                    mesh->m_vertices->setLocalPos(first + (unsigned int)j, positions[j]);
+                    mesh->m_vertices->setColor(first + (unsigned int)j, colors[j]);
+                }
+                mesh->setUseVertexColors(hasColors);
+            }
+
+            a_object->computeBoundaryBox(true);
+            a_object->computeGlobalPositionsFromRoot(true);
+            return (C_SUCCESS);
+        }
+
+
+        ////////////////////////////////////////////////////////////////////////
+        // BUILD TRIANGLES
+        ////////////////////////////////////////////////////////////////////////
+
+        int numMeshes = a_object->getNumMeshes();
+        std::vector<cOBJMeshData> meshes(numMeshes);
+        std::vector<std::string> groupNames;
+        int curMaterial = 0;
+
+        // vertices are shared by the corners with the same position, normal
+        // and texture coordinate indices in a mesh. The first combination
+        // seen for each position is looked up directly, others are hashed.
+        std::vector<cOBJVertexKey> firstKeys(numPositions);
+        std::vector<unsigned int> firstVertices(numPositions);
+        for (size_t j=0; j<numPositions; j++) { firstKeys[j].m_mesh = -1; }
+        std::unordered_map<cOBJVertexKey, unsigned int, cOBJVertexKeyHash> otherVertices;
+
+        std::vector<unsigned int> faceVertices;
+        for (size_t i=0; i<numChunks; i++)
+        {
+            const cOBJChunk& chunk = chunks[i];
+            const int* corner = chunk.m_corners.data();
+            size_t statement = 0;
+
+            for (size_t f=0; f<=chunk.m_faceSizes.size(); f++)
+            {
+                // apply statements preceding the face
+                while ((statement < chunk.m_statements.size()) && (chunk.m_statements[statement].m_faceIndex == f))
+                {
+                    const cOBJStatement& current = chunk.m_statements[statement];
+                    if (current.m_type == cOBJStatement::C_OBJ_GROUP)
+                    {
+                        groupNames.push_back(current.m_value);
+                    }
+                    else if (current.m_type == cOBJStatement::C_OBJ_USE_MTL)
+                    {
+                        for (int m=0; m<numMaterials; m++)
+                        {
+                            if (current.m_value == materials[m].m_name)
+                            {
+                                curMaterial = m;
+                                break;
+                            }
+                        }
+                    }
+                    statement++;
+                }
+                if (f == chunk.m_faceSizes.size()) { break; }
+
+                unsigned int numCorners = chunk.m_faceSizes[f];
+                const int* faceCorners = corner;
+                corner += 3 * numCorners;
+
+                cOBJMeshData& mesh = meshes[curMaterial];
+
+                // name the mesh after the current group
+                if (!groupNames.empty())
+                {
+                    mesh.m_group = (int)(groupNames.size()) - 1;
+                }
+
+                if (numCorners < 3) { continue; }
+
+                // get (possibly new) vertices of the face
+                faceVertices.resize(numCorners);
+                for (unsigned int c=0; c<numCorners; c++)
+                {
+                    const int* indices = faceCorners + 3*c;
+                    if (g_objLoaderShouldGenerateExtraVertices)
+                    {
+                        faceVertices[c] = indices[0];
+                        continue;
+                    }
+
+                    cOBJVertexKey key;
+                    key.m_mesh = curMaterial;
+                    key.m_vIndex = indices[0];
+                    key.m_tIndex = cMax(indices[1], 0);
+                    key.m_nIndex = cMax(indices[2], 0);
+
+                    cOBJVertexKey& first = firstKeys[key.m_vIndex];
+                    if (first.m_mesh == -1)
+                    {
+                        first = key;
+                        firstVertices[key.m_vIndex] = mesh.newVertex(key.m_vIndex);
+                        faceVertices[c] = firstVertices[key.m_vIndex];
+                    }
+                    else if (first == key)
+                    {
+                        faceVertices[c] = firstVertices[key.m_vIndex];
+                    }
+                    else
+                    {
+                        std::pair<std::unordered_map<cOBJVertexKey, unsigned int, cOBJVertexKeyHash>::iterator, bool> result =
+                            otherVertices.insert(std::make_pair(key, (unsigned int)(mesh.m_vertexPositions.size())));
+                        if (result.second)
+                        {
+                            mesh.newVertex(key.m_vIndex);
+                        }
+                        faceVertices[c] = result.first->second;
+                    }
+                }
+
+                // triangulate face as a fan. Each vertex keeps the normal and
+                // texture coordinate that newTriangle() followed by
+                // computeNormal() and the corner normals and texture
+                // coordinates would leave: the last normal set, and the
+                // texture coordinate of its corners that have one (they all
+                // have the same).
+                for (unsigned int c=2; c<numCorners; c++)
+                {
+                    const unsigned int triangleCorners[3] = { 0, c-1, c };
+                    const int* corners[3] = { faceCorners, faceCorners + 3*(c-1), faceCorners + 3*c };
+                    int triangle = (int)(mesh.m_triangles.size() / 3);
+                    unsigned int vertices[3];
+                    for (int k=0; k<3; k++)
+                    {
+                        vertices[k] = g_objLoaderShouldGenerateExtraVertices ? mesh.newVertex(corners[k][0]) : faceVertices[triangleCorners[k]];
+                        mesh.m_triangles.push_back(vertices[k]);
+                    }
+
+                    // computed normals are replaced by the normals of the file, if any
+                    if (((corners[0][2] < 0) || (corners[1][2] < 0) || (corners[2][2] < 0)) &&
+                        cOBJHasComputedNormal(positions[corners[0][0]], positions[corners[1][0]], positions[corners[2][0]]))
+                    {
+                        for (int k=0; k<3; k++) { mesh.m_vertexNormals[vertices[k]] = -2 - triangle; }
+                    }
+                    for (int k=0; k<3; k++)
+                    {
+                        if (corners[k][2] >= 0) { mesh.m_vertexNormals[vertices[k]] = corners[k][2]; }
+                        if (corners[k][1] >= 0) { mesh.m_vertexTexCoords[vertices[k]] = corners[k][1]; }
+                    }
+                }
+            }
+        }
+
+        // free parsed data before filling the meshes
+        chunks.clear();
+        firstKeys.clear();
+        firstVertices.clear();
+        otherVertices.clear();
+
+        // fill meshes in bulk
+        for (int m=0; m<numMeshes; m++)
+        {
+            cMesh* mesh = a_object->getMesh(m);
+            cOBJMeshData& data = meshes[m];
+
+            if (data.m_group >= 0)
+            {
+                mesh->m_name = groupNames[data.m_group];
+            }
+
+            size_t numVertices = data.m_vertexPositions.size();
+            if (numVertices == 0) { continue; }
+
+            int first = mesh->m_vertices->newVertices((unsigned int)numVertices);
+            for (size_t j=0; j<numVertices; j++)
+            {
+                mesh->m_vertices->setLocalPos(first + (unsigned int)j, positions[data.m_vertexPositions[j]]);
+            }
+
+            // triangles are appended in bulk, as newTriangle() would append
+            // them to the new mesh (it has no free triangles)
+            size_t numTriangles = data.m_triangles.size() / 3;
+            cTriangleArrayPtr triangles = mesh->m_triangles;
+            unsigned int firstTriangle = triangles->getNumElements();
+            size_t firstIndex = triangles->m_indices.size();
+            triangles->m_indices.resize(firstIndex + 3 * numTriangles);
+            unsigned int* indices = &triangles->m_indices[firstIndex];
+            for (size_t k=0; k<3*numTriangles; k++)
+            {
+                indices[k] = first + data.m_triangles[k];
+            }
+            triangles->m_allocated.resize(triangles->m_allocated.size() + numTriangles, true);
+            triangles->m_flagMarkForResize = true;
+            triangles->m_flagMarkForUpdate = true;
+
+            for (size_t j=0; j<numVertices; j++)
+            {
+                int normal = data.m_vertexNormals[j];
+                if (normal >= 0)
+                {
+                    mesh->m_vertices->setNormal(first + (unsigned int)j, normals[normal]);
+                }
+                else if (normal < -1)
+                {
+                    mesh->m_vertices->setNormal(first + (unsigned int)j, triangles->computeNormal(firstTriangle + (-2 - normal), false));
+                }
+                if (data.m_vertexTexCoords[j] >= 0)
+                {
+                    mesh->m_vertices->setTexCoord(first + (unsigned int)j, texCoords[data.m_vertexTexCoords[j]]);
+                }
+            }
+            mesh->markForUpdate(false);
+        }
+
+        // compute boundary boxes
+        a_object->computeBoundaryBox(true);
+
+        // update global position in world
+        a_object->computeGlobalPositionsFromRoot(true);
+
+        // return success
+        return (C_SUCCESS);
+    }
+
+    catch (...)
+    {
+        return (C_ERROR);
+    }
+}
+
+
+//==============================================================================
+/*!
+    This function loads an OBJ 3D model from a file into a cMultiMesh structure.
+    If the operation succeeds, then the functions returns __true__ and the
+    3D model is loaded into cMultiMesh.
+    If the operation fails, then the function returns __false__.
+
+    \param  a_object    Multimesh object.
+    \param  a_filename  Filename.
+
+    \return __true__ if in case of success, __false__ otherwise.
+*/
+//==============================================================================
+bool cLoadFileOBJ(cMultiMesh* a_object, const std::string& a_filename)
+{
+    if (g_objLoaderUseLegacyParser)
+    {
+        return (cLoadFileOBJLegacy(a_object, a_filename));
+    }
+    return (cLoadFileOBJParallel(a_object, a_filename));
+}
+
+
 //==============================================================================
 /*!
     This function saves an OBJ 3D model from a cMultiMesh object to a file.
@@ -43,11 +43,16 @@
 
 //------------------------------------------------------------------------------
 #include "files/CFileModelSTL.h"
+#include "system/CMappedFile.h"
+#include "system/CThread.h"
 //------------------------------------------------------------------------------
 #include "stdint.h"
 #include <stdio.h>
 #include <math.h>
+#include <string.h>
+#include <stddef.h>
 #include <fstream>
+#include <vector>
 //------------------------------------------------------------------------------
 using namespace std;
 //------------------------------------------------------------------------------
@@ -57,6 +62,13 @@ using namespace chai3d;
 namespace chai3d {
 //------------------------------------------------------------------------------
 
+//------------------------------------------------------------------------------
+// GLOBAL VARIABLES:
+//------------------------------------------------------------------------------
+
+double g_stlLoaderWeldingEpsilon = 0.0;
+
+
 //------------------------------------------------------------------------------
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
 //------------------------------------------------------------------------------
@@ -76,6 +88,335 @@ struct cTriangleSTL
     int m_attribute;
 };
 
+//------------------------------------------------------------------------------
+
+// size of a triangle record in a binary STL file
+const size_t C_STL_TRIANGLE_SIZE = 50;
+
+// size of the header of a binary STL file
+const size_t C_STL_HEADER_SIZE = 84;
+
+// minimum number of triangles processed by a thread
+const size_t C_STL_MIN_TRIANGLES_PER_THREAD = 65536;
+
+// marks an empty slot of a hash table
+const unsigned int C_STL_EMPTY = 0xffffffff;
+
+//------------------------------------------------------------------------------
+
+// key of a vertex in the welding hash tables: bit pattern of the coordinates,
+// or grid cell of the vertex when an epsilon is used
+struct cSTLVertexKey
+{
+    int m_x;
+    int m_y;
+    int m_z;
+
+    bool operator==(const cSTLVertexKey& a_other) const
+    {
+        return ((m_x == a_other.m_x) && (m_y == a_other.m_y) && (m_z == a_other.m_z));
+    }
+};
+
+//------------------------------------------------------------------------------
+
+static inline uint64_t cSTLHashKey(const cSTLVertexKey& a_key)
+{
+    uint64_t h = (uint64_t)(uint32_t)a_key.m_x * 0x9e3779b97f4a7c15ULL;
+    h = (h ^ (h >> 29)) + (uint64_t)(uint32_t)a_key.m_y * 0xbf58476d1ce4e5b9ULL;
+    h = (h ^ (h >> 31)) + (uint64_t)(uint32_t)a_key.m_z * 0x94d049bb133111ebULL;
+    h ^= h >> 32;
+    h *= 0xd6e8feb83b5e4bc5ULL;
+    h ^= h >> 29;
+    return (h);
+}
+
+//------------------------------------------------------------------------------
+
+// open addressing hash table holding the first vertex of each key of one
+// partition of the vertices
+struct cSTLWeldTable
+{
+    struct cSlot
+    {
+        cSTLVertexKey m_key;
+        unsigned int m_index;
+    };
+
+    std::vector<cSlot> m_slots;
+    uint64_t m_mask;
+    size_t m_count;
+
+    // one bit per hash value, set if a key may be in the table; it fits in
+    // cache and avoids most misses when looking up empty neighbouring cells
+    std::vector<uint64_t> m_filter;
+    uint64_t m_filterMask;
+
+    void initFilter(const size_t a_count)
+    {
+        size_t bits = 64;
+        while (bits < 8 * a_count) { bits <<= 1; }
+        m_filter.assign(bits / 64, 0);
+        m_filterMask = bits - 1;
+    }
+
+    bool mayContain(const uint64_t a_hash) const
+    {
+        uint64_t bit = (a_hash >> 16) & m_filterMask;
+        return ((m_filter[bit >> 6] >> (bit & 63)) & 1) != 0;
+    }
+
+    // allocates a table for about a_count keys; it grows when needed
+    void init(const size_t a_count)
+    {
+        size_t size = 16;
+        while (size < 2 * a_count) { size <<= 1; }
+        cSlot empty;
+        empty.m_key.m_x = empty.m_key.m_y = empty.m_key.m_z = 0;
+        empty.m_index = C_STL_EMPTY;
+        m_slots.assign(size, empty);
+        m_mask = size - 1;
+        m_count = 0;
+    }
+
+    void grow()
+    {
+        std::vector<cSlot> slots;
+        slots.swap(m_slots);
+        init(slots.size());
+        for (size_t i=0; i<slots.size(); i++)
+        {
+            if (slots[i].m_index != C_STL_EMPTY)
+            {
+                insert(slots[i].m_key, cSTLHashKey(slots[i].m_key), slots[i].m_index);
+            }
+        }
+    }
+
+    // returns the first vertex with key a_key, inserting a_index if none
+    unsigned int insert(const cSTLVertexKey& a_key, const uint64_t a_hash, const unsigned int a_index)
+    {
+        uint64_t slot = a_hash & m_mask;
+        while (true)
+        {
+            cSlot& entry = m_slots[slot];
+            if (entry.m_index == C_STL_EMPTY)
+            {
+                entry.m_key = a_key;
+                entry.m_index = a_index;
+                if (!m_filter.empty())
+                {
+                    uint64_t bit = (a_hash >> 16) & m_filterMask;
+                    m_filter[bit >> 6] |= (uint64_t)1 << (bit & 63);
+                }
+                if (2 * (++m_count) > m_slots.size()) { grow(); }
+                return (a_index);
+            }
+            if (entry.m_key == a_key)
+            {
+                return (entry.m_index);
+            }
+            slot = (slot + 1) & m_mask;
+        }
+    }
+
+    // returns the first vertex with key a_key, or C_STL_EMPTY if none
+    unsigned int find(const cSTLVertexKey& a_key, const uint64_t a_hash) const
+    {
+        if (!m_filter.empty() && !mayContain(a_hash)) { return (C_STL_EMPTY); }
+
+        uint64_t slot = a_hash & m_mask;
+        while (true)
+        {
+            const cSlot& entry = m_slots[slot];
+            if ((entry.m_index == C_STL_EMPTY) || (entry.m_key == a_key))
+            {
+                return (entry.m_index);
+            }
+            slot = (slot + 1) & m_mask;
+        }
+    }
+};
+
+//------------------------------------------------------------------------------
+
+static inline unsigned int cSTLPartition(const uint64_t a_hash, const unsigned int a_numPartitions)
+{
+    return ((unsigned int)((a_hash >> 32) % a_numPartitions));
+}
+
+//------------------------------------------------------------------------------
+
+// splits [0, a_count) into a_numTasks ranges and processes them in parallel
+static void cSTLParallelRanges(const size_t a_count,
+                               const unsigned int a_numTasks,
+                               const std::function<void(size_t, size_t)>& a_task)
+{
+    cParallelFor(a_numTasks, [&](unsigned int a_index)
+    {
+        a_task((a_count * a_index) / a_numTasks, (a_count * (a_index + 1)) / a_numTasks);
+    });
+}
+
+//------------------------------------------------------------------------------
+
+/*
+    Welds the vertices of a triangle soup (3 vertices per triangle). On return,
+    a_indices holds the index of the welded vertex of each corner, and
+    a_vertices the position of the welded vertices, in order of first use.
+
+    With a_epsilon == 0, vertices with equal coordinates are merged. Otherwise
+    vertices are merged with the first vertex of their cell in a grid of size
+    2 * a_epsilon, and the first vertex of each cell is merged with the first
+    vertex of a neighbouring cell if they are closer than a_epsilon along
+    each axis. As the cells are twice as large as a_epsilon, only the 7
+    neighbouring cells on the side of the vertex need to be searched.
+
+    Keys and hashes are computed in parallel. Each thread then owns the keys
+    whose hash falls in its partition and records the first vertex using each
+    key, so that the result does not depend on the number of threads.
+*/
+static void cSTLWeldVertices(const std::vector<float>& a_points,
+                             const double a_epsilon,
+                             const unsigned int a_numThreads,
+                             std::vector<unsigned int>& a_indices,
+                             std::vector<float>& a_vertices)
+{
+    const size_t numPoints = a_points.size() / 3;
+    const bool useGrid = (a_epsilon > 0.0);
+    const double invCellSize = useGrid ? 0.5 / a_epsilon : 0.0;
+    const double maxCell = 2147483000.0;
+
+    // compute keys; side[] records for each axis whether the vertex lies in
+    // the upper half of its cell, or 0xff if it cannot be welded
+    std::vector<cSTLVertexKey> keys(numPoints);
+    std::vector<uint64_t> hashes(numPoints);
+    std::vector<unsigned char> side(numPoints, 0);
+    cSTLParallelRanges(numPoints, a_numThreads, [&](size_t a_begin, size_t a_end)
+    {
+        for (size_t i=a_begin; i<a_end; i++)
+        {
+            const float* p = &a_points[3*i];
+            int key[3];
+            unsigned char sides = 0;
+            bool outside = false;
+            for (int k=0; k<3; k++)
+            {
+                if (useGrid)
+                {
+                    double position = (double)p[k] * invCellSize;
+                    double cell = floor(position);
+                    if (!(fabs(cell) < maxCell))
+                    {
+                        // never weld vertices that are not finite or out of the grid
+                        outside = true;
+                        cell = 0.0;
+                    }
+                    sides |= (unsigned char)((position - cell >= 0.5) << k);
+                    key[k] = (int)cell;
+                }
+                else
+                {
+                    // adding zero turns -0 into +0
+                    float value = p[k] + 0.0f;
+                    memcpy(&key[k], &value, sizeof(value));
+                }
+            }
+            side[i] = outside ? 0xff : sides;
+            keys[i].m_x = key[0];
+            keys[i].m_y = key[1];
+            keys[i].m_z = key[2];
+            hashes[i] = cSTLHashKey(keys[i]);
+        }
+    });
+
+    // find the first vertex of each key, one partition of the keys per thread
+    std::vector<unsigned int> first(numPoints);
+    std::vector<cSTLWeldTable> tables(a_numThreads);
+    cParallelFor(a_numThreads, [&](unsigned int a_index)
+    {
+        size_t count = 0;
+        for (size_t i=0; i<numPoints; i++)
+        {
+            if (cSTLPartition(hashes[i], a_numThreads) == a_index) { count++; }
+        }
+
+        // vertices of closed meshes are usually shared by about 6 triangles
+        cSTLWeldTable& table = tables[a_index];
+        table.init(count / 4);
+        if (useGrid) { table.initFilter(count / 4); }
+        for (size_t i=0; i<numPoints; i++)
+        {
+            if (cSTLPartition(hashes[i], a_numThreads) != a_index) { continue; }
+            first[i] = (side[i] != 0xff) ? table.insert(keys[i], hashes[i], (unsigned int)i) : (unsigned int)i;
+        }
+    });
+
+    // with a grid, link the first vertex of each cell to the earliest first
+    // vertex of a neighbouring cell closer than epsilon
+    std::vector<unsigned int> link;
+    if (useGrid)
+    {
+        link.resize(numPoints);
+        cSTLParallelRanges(numPoints, a_numThreads, [&](size_t a_begin, size_t a_end)
+        {
+            for (size_t i=a_begin; i<a_end; i++)
+            {
+                link[i] = (unsigned int)i;
+                if ((first[i] != i) || (side[i] == 0xff)) { continue; }
+
+                const float* p = &a_points[3*i];
+                int step[3];
+                for (int k=0; k<3; k++)
+                {
+                    step[k] = (side[i] & (1 << k)) ? 1 : -1;
+                }
+
+                for (int n=1; n<8; n++)
+                {
+                    cSTLVertexKey key = keys[i];
+                    if (n & 1) { key.m_x += step[0]; }
+                    if (n & 2) { key.m_y += step[1]; }
+                    if (n & 4) { key.m_z += step[2]; }
+                    uint64_t hash = cSTLHashKey(key);
+                    unsigned int other = tables[cSTLPartition(hash, a_numThreads)].find(key, hash);
+                    if ((other == C_STL_EMPTY) || (other >= link[i])) { continue; }
+
+                    const float* q = &a_points[3*other];
+                    if ((fabs((double)p[0] - (double)q[0]) <= a_epsilon) &&
+                        (fabs((double)p[1] - (double)q[1]) <= a_epsilon) &&
+                        (fabs((double)p[2] - (double)q[2]) <= a_epsilon))
+                    {
+                        link[i] = other;
+                    }
+                }
+            }
+        });
+    }
+
+    // number the welded vertices in order of first use; first[] and link[]
+    // always point to earlier vertices, which are already numbered
+    a_indices.resize(numPoints);
+    a_vertices.clear();
+    a_vertices.reserve(3 * numPoints);
+    for (size_t i=0; i<numPoints; i++)
+    {
+        if (first[i] != i)
+        {
+            a_indices[i] = a_indices[first[i]];
+        }
+        else if (useGrid && (link[i] != i))
+        {
+            a_indices[i] = a_indices[link[i]];
+        }
+        else
+        {
+            a_indices[i] = (unsigned int)(a_vertices.size() / 3);
+            a_vertices.insert(a_vertices.end(), &a_points[3*i], &a_points[3*i+3]);
+        }
+    }
+}
+
 //------------------------------------------------------------------------------
 #endif // DOXYGEN_SHOULD_SKIP_THIS
 //------------------------------------------------------------------------------
@@ -88,6 +429,11 @@ struct cTriangleSTL
     3D model is loaded into cMultiMesh as a single mesh.
     If the operation fails, then the function returns __false__.
 
+    The file is memory mapped and its vertices are welded in parallel
+    according to \ref g_stlLoaderWeldingEpsilon, so that the mesh is indexed
+    and triangles share their vertices. Triangles that become degenerate
+    after welding are discarded.
+
     \param  a_object    Multimesh object.
     \param  a_filename  Filename.
 
@@ -100,64 +446,90 @@ bool cLoadFileSTL(cMultiMesh* a_object, const std::string& a_filename)
     if (a_object == NULL)
         return (C_ERROR);
 
-    // open file
-    ifstream file(a_filename.c_str(), ios::binary);
-    if (!file)
+    // map file
+    cMappedFilePtr file = cMappedFile::create();
+    if (!file->open(a_filename))
         return (C_ERROR);
 
-    // get length of file
-    file.seekg (0, file.end);
-    int length = (int)(file.tellg());
-    file.seekg (0, file.beg);
-    if (length < 84)
-    {
-        file.close();
+    const unsigned char* data = file->getData();
+    size_t length = file->getSize();
+    if (length < C_STL_HEADER_SIZE)
         return (C_ERROR);
-    }
-
-    // read header
-    cHeaderSTL header;
-    file.read((char*)(&header), 84);
 
     // read number of triangles
-    int numTriangles = (int)header.m_numTriangles;
+    cHeaderSTL header;
+    memcpy(&header, data, C_STL_HEADER_SIZE);
+    size_t numTriangles = header.m_numTriangles;
     if (numTriangles == 0)
-    {
-        file.close();
         return (C_ERROR);
-    }
 
-    // check if the length of the file correspond to the number of triangles found
-    double num = (double)(length - sizeof(cHeaderSTL)) / 50.0;
-    if ((num != floor(num)) && ((int)num != numTriangles))
-    {
-        file.close();
+    // check that the file contains all triangles
+    if ((length - C_STL_HEADER_SIZE) / C_STL_TRIANGLE_SIZE < numTriangles)
         return (C_ERROR);
+
+    unsigned int numThreads = (unsigned int)cMin((size_t)cGetNumHardwareThreads(),
+                                                 numTriangles / C_STL_MIN_TRIANGLES_PER_THREAD + 1);
+
+    // read vertex positions
+    std::vector<float> points(9 * numTriangles);
+    cSTLParallelRanges(numTriangles, numThreads, [&](size_t a_begin, size_t a_end)
+    {
+        for (size_t i=a_begin; i<a_end; i++)
+        {
+            const unsigned char* triangle = data + C_STL_HEADER_SIZE + i * C_STL_TRIANGLE_SIZE;
+            memcpy(&points[9*i], triangle + offsetof(cTriangleSTL, m_vertex0), 9 * sizeof(float));
+        }
+    });
+    file->close();
+
+    // weld vertices
+    std::vector<unsigned int> indices;
+    std::vector<float> vertices;
+    if (g_stlLoaderWeldingEpsilon >= 0.0)
+    {
+        cSTLWeldVertices(points, g_stlLoaderWeldingEpsilon, numThreads, indices, vertices);
+    }
+    else
+    {
+        indices.resize(3 * numTriangles);
+        for (size_t i=0; i<indices.size(); i++)
+        {
+            indices[i] = (unsigned int)i;
+        }
+        vertices.swap(points);
     }
 
     // create mesh
     cMesh* mesh = a_object->newMesh();
 
-    // load triangles
-    for (int i=0; i<(int)numTriangles; i++)
+    size_t numVertices = vertices.size() / 3;
+    int firstVertex = mesh->m_vertices->newVertices((unsigned int)numVertices);
+    for (size_t i=0; i<numVertices; i++)
     {
-        cTriangleSTL triangle;
+        mesh->m_vertices->setLocalPos(firstVertex + (unsigned int)i, vertices[3*i], vertices[3*i+1], vertices[3*i+2]);
+    }
 
-        // read triangle data from file
-        file.read((char*)(&triangle), 50);
+    mesh->m_triangles->m_indices.reserve(3 * numTriangles);
+    mesh->m_triangles->m_allocated.reserve(numTriangles);
+    for (size_t i=0; i<numTriangles; i++)
+    {
+        unsigned int index0 = indices[3*i];
+        unsigned int index1 = indices[3*i+1];
+        unsigned int index2 = indices[3*i+2];
+
+        // discard triangles collapsed by welding
+        if ((g_stlLoaderWeldingEpsilon >= 0.0) &&
+            ((index0 == index1) || (index1 == index2) || (index2 == index0)))
+        {
+            continue;
+        }
 
-        // create triangle entity
-        mesh->newTriangle(cVector3d(triangle.m_vertex0[0], triangle.m_vertex0[1], triangle.m_vertex0[2]),
-                          cVector3d(triangle.m_vertex1[0], triangle.m_vertex1[1], triangle.m_vertex1[2]),
-                          cVector3d(triangle.m_vertex2[0], triangle.m_vertex2[1], triangle.m_vertex2[2]));
+        mesh->newTriangle(firstVertex + index0, firstVertex + index1, firstVertex + index2);
     }
 
     // compute normals
     mesh->computeAllNormals();
 
-    // close file
-    file.close();
-
     // return success
     return (C_SUCCESS);
 }
@@ -96,6 +96,12 @@ cAlgorithmFingerProxy::cAlgorithmFingerProxy()
     // friction properties
     m_slipping = true;
 
+    // no texture contact yet
+    m_textureObject = NULL;
+    m_textureTexCoord.zero();
+    m_textureSpeed = 0.0;
+    m_textureContact = false;
+
     // setup collision detector settings
     m_collisionSettings.m_checkForNearestCollisionOnly  = true;
     m_collisionSettings.m_returnMinimalCollisionData    = false;
@@ -1070,6 +1076,7 @@ void cAlgorithmFingerProxy::updateForce()
     // if proxy is not touching any object, then the force is simply set to zero.
     if (m_numCollisionEvents == 0)
     {
+        m_textureContact = false;
         m_tangentialForce.zero();
         m_normalForce.zero();
         m_lastGlobalForce.zero();
@@ -1114,6 +1121,7 @@ void cAlgorithmFingerProxy::updateForce()
 
     if (force.lengthsq() == 0)
     {
+        m_textureContact = false;
         m_normalForce.zero();
         m_tangentialForce.zero();
         m_lastGlobalForce.zero();
@@ -1125,6 +1133,9 @@ void cAlgorithmFingerProxy::updateForce()
     // APPLY TEXTURE RENDERING
     //---------------------------------------------------------------------
 
+    // set if a precomputed haptic texture field is sampled
+    bool textureContact = false;
+
     // is haptic texture rendering enabled?
     bool useHapticTexture = m_collisionEvents[0]->m_object->m_material->getUseHapticTexture();
     if ((useHapticTexture) && (m_collisionEvents[0]->m_type == C_COL_TRIANGLE))
@@ -1178,55 +1189,90 @@ void cAlgorithmFingerProxy::updateForce()
                     cVector3d gradientSurface(0,0,0);
                     cVector3d gradientTexture;
 
-                    // pixel and colors
-                    cColorb color00, color01, color10, color11;
-                    int pixelX0, pixelX1;
-                    int pixelY0, pixelY1;
-
-                    // image size
-                    int w = normalMap->m_image->getWidth();
-                    int h = normalMap->m_image->getHeight();
-
-                    // compute nearest pixels along the X axis.
-                    double px = (w-1) * texCoord(0);
-                    double py = (h-1) * texCoord(1);
-
-                    pixelX0 = (int)(floor(px));
-                    pixelY0 = (int)(floor(py));
-                    pixelX1 = cClamp(pixelX0+1, 0, (w-1));
-                    pixelY1 = cClamp(pixelY0+1, 0, (h-1));
-
-                    // get normals from
-                    normalMap->m_image->getPixelColor(pixelX0, pixelY0, color00);
-                    normalMap->m_image->getPixelColor(pixelX1, pixelY0, color10);
-                    normalMap->m_image->getPixelColor(pixelX1, pixelY1, color11);
-                    normalMap->m_image->getPixelColor(pixelX0, pixelY1, color01);
-
-                    // compute relative position within 4 texels
-                    double x = px - floor(px);
-                    double y = py - floor(py);
-
-                    const double SCALE = (1.0/255.0);
-                    double fX00 = SCALE * (color00.getR() - 128);
-                    double fY00 =-SCALE * (color00.getG() - 128);
-                    double fZ00 = SCALE * (color00.getB() - 128);
-                    double fX01 = SCALE * (color01.getR() - 128);
-                    double fY01 =-SCALE * (color01.getG() - 128);
-                    double fZ01 = SCALE * (color01.getB() - 128);
-                    double fX10 = SCALE * (color10.getR() - 128);
-                    double fY10 =-SCALE * (color10.getG() - 128);
-                    double fZ10 = SCALE * (color10.getB() - 128);
-                    double fX11 = SCALE * (color11.getR() - 128);
-                    double fY11 =-SCALE * (color11.getG() - 128);
-                    double fZ11 = SCALE * (color11.getB() - 128);
-
-                    // bilinear interpolation
-                    double fX = fX00 * (1-x)*(1-y) + fX10*x*(1-y) + fX01*(1-x)*y + fX11*x*y;
-                    double fY = fY00 * (1-x)*(1-y) + fY10*x*(1-y) + fY01*(1-x)*y + fY11*x*y;
-                    double fZ = fZ00 * (1-x)*(1-y) + fZ10*x*(1-y) + fZ01*(1-x)*y + fZ11*x*y;
-
-                    // assign gradient (negate fy!)
-                    gradientTexture.set(fX,-fY, fZ);
+                    // retrieve precomputed haptic texture field
+                    cHapticTextureFieldPtr field = normalMap->m_hapticField;
+
+                    if (field != nullptr)
+                    {
+                        // select the mipmap level from the number of texels
+                        // travelled per sample, low-pass filtered
+                        double level = 0.0;
+                        if (field->getNumLevels() > 1)
+                        {
+                            if (m_textureContact && (m_textureObject == m_collisionEvents[i]->m_object))
+                            {
+                                double texels = cMax(fabs(texCoord(0) - m_textureTexCoord(0)) * field->getWidth(),
+                                                     fabs(texCoord(1) - m_textureTexCoord(1)) * field->getHeight());
+                                m_textureSpeed += 0.1 * (texels - m_textureSpeed);
+                            }
+                            else
+                            {
+                                m_textureSpeed = 0.0;
+                            }
+                            level = field->getLevel(m_textureSpeed);
+                        }
+                        textureContact = true;
+                        m_textureObject = m_collisionEvents[i]->m_object;
+                        m_textureTexCoord = texCoord;
+
+                        double value[4];
+                        field->sample(texCoord(0), texCoord(1), level, value);
+
+                        // assign gradient (negate fy!)
+                        gradientTexture.set(value[0],-value[1], value[2]);
+                    }
+                    else
+                    {
+                        // pixel and colors
+                        cColorb color00, color01, color10, color11;
+                        int pixelX0, pixelX1;
+                        int pixelY0, pixelY1;
+
+                        // image size
+                        int w = normalMap->m_image->getWidth();
+                        int h = normalMap->m_image->getHeight();
+
+                        // compute nearest pixels along the X axis.
+                        double px = (w-1) * texCoord(0);
+                        double py = (h-1) * texCoord(1);
+
+                        pixelX0 = (int)(floor(px));
+                        pixelY0 = (int)(floor(py));
+                        pixelX1 = cClamp(pixelX0+1, 0, (w-1));
+                        pixelY1 = cClamp(pixelY0+1, 0, (h-1));
+
+                        // get normals from
+                        normalMap->m_image->getPixelColor(pixelX0, pixelY0, color00);
+                        normalMap->m_image->getPixelColor(pixelX1, pixelY0, color10);
+                        normalMap->m_image->getPixelColor(pixelX1, pixelY1, color11);
+                        normalMap->m_image->getPixelColor(pixelX0, pixelY1, color01);
+
+                        // compute relative position within 4 texels
+                        double x = px - floor(px);
+                        double y = py - floor(py);
+
+                        const double SCALE = (1.0/255.0);
+                        double fX00 = SCALE * (color00.getR() - 128);
+                        double fY00 =-SCALE * (color00.getG() - 128);
+                        double fZ00 = SCALE * (color00.getB() - 128);
+                        double fX01 = SCALE * (color01.getR() - 128);
+                        double fY01 =-SCALE * (color01.getG() - 128);
+                        double fZ01 = SCALE * (color01.getB() - 128);
+                        double fX10 = SCALE * (color10.getR() - 128);
+                        double fY10 =-SCALE * (color10.getG() - 128);
+                        double fZ10 = SCALE * (color10.getB() - 128);
+                        double fX11 = SCALE * (color11.getR() - 128);
+                        double fY11 =-SCALE * (color11.getG() - 128);
+                        double fZ11 = SCALE * (color11.getB() - 128);
+
+                        // bilinear interpolation
+                        double fX = fX00 * (1-x)*(1-y) + fX10*x*(1-y) + fX01*(1-x)*y + fX11*x*y;
+                        double fY = fY00 * (1-x)*(1-y) + fY10*x*(1-y) + fY01*(1-x)*y + fY11*x*y;
+                        double fZ = fZ00 * (1-x)*(1-y) + fZ10*x*(1-y) + fZ01*(1-x)*y + fZ11*x*y;
+
+                        // assign gradient (negate fy!)
+                        gradientTexture.set(fX,-fY, fZ);
+                    }
 
                     // boolean used to inform us if the projection succeeds
                     bool success = false;
@@ -1308,6 +1354,9 @@ void cAlgorithmFingerProxy::updateForce()
     }
 
 
+    m_textureContact = textureContact;
+
+
     //---------------------------------------------------------------------
     // FINALIZATION
     //---------------------------------------------------------------------
@@ -0,0 +1,108 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2003-2016, CHAI3D.
+    (www.chai3d.org)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of CHAI3D nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE. 
+
+    \author    <http://www.chai3d.org>
+    \version   3.2.0 $Rev: 1869 $
+*/
+//==============================================================================
+
+//------------------------------------------------------------------------------
+#include "graphics/CGenericArray.h"
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+namespace chai3d {
+//------------------------------------------------------------------------------
+
+//==============================================================================
+/*!
+    This method compresses the array by removing all non allocated elements.
+    The remaining elements keep their order, and the memory of the removed
+    ones is released. The list of free elements is emptied.\n
+
+    __IMPORTANT:__ \n
+    After calling this method, it is important to immediately update any
+    collision detector as the collision tree may try to access elements
+    that no longer exist.\n
+*/
+//==============================================================================
+void cGenericArray::compress()
+{
+    // nothing to remove
+    if (m_freeElements.empty())
+    {
+        return;
+    }
+
+    // get number of allocated elements
+    unsigned int numElements = getNumElements();
+    unsigned int numVerticesPerElement = getNumVerticesPerElement();
+
+    // remove non allocated elements
+    unsigned int j = 0;
+    for (unsigned int i=0; i<numElements; i++)
+    {
+        if (getAllocated(i))
+        {
+            if (i != j)
+            {
+                for (unsigned int k=0; k<numVerticesPerElement; k++)
+                {
+                    m_indices[numVerticesPerElement*j+k] = m_indices[numVerticesPerElement*i+k];
+                }
+            }
+            j++;
+        }
+    }
+
+    // resize arrays
+    m_allocated.assign(j, true);
+    m_allocated.shrink_to_fit();
+    m_indices.resize(numVerticesPerElement*j);
+    m_indices.shrink_to_fit();
+    m_freeElements.clear();
+    m_freeElements.shrink_to_fit();
+
+    // mark for update
+    m_flagMarkForUpdate = true;
+    m_flagMarkForResize = true;
+}
+
+
+//------------------------------------------------------------------------------
+} // namespace chai3d
+//------------------------------------------------------------------------------
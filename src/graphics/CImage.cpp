@@ -65,6 +65,9 @@ namespace chai3d {
 //==============================================================================
 cImage::cImage()
 {
+    // no modification yet
+    m_modificationCount = 0;
+
     // init internal variables
     defaults();
 }
@@ -86,6 +89,9 @@ cImage::cImage(const unsigned int a_width,
                const GLenum a_format,
                const GLenum a_type)
 {
+    // no modification yet
+    m_modificationCount = 0;
+
     // init internal variables
     defaults();
 
@@ -149,6 +155,9 @@ void cImage::defaults()
 //==============================================================================
 void cImage::cleanup()
 {
+    // the image data is modified
+    markAsModified();
+
     // delete image data
     if ((m_data != NULL) && (m_responsibleForMemoryAllocation))
     {
@@ -176,6 +185,9 @@ bool cImage::allocate(const unsigned int a_width,
                       const GLenum a_format,
                       const GLenum a_type)
 {
+    // the image data is modified
+    markAsModified();
+
     // verify the memory requirements for given format
     int bytesPerPixel = queryBytesPerPixel(a_format, a_type);
     if (bytesPerPixel < 1)
@@ -356,6 +368,9 @@ int cImage::queryBytesPerPixel(const GLenum a_format,
 //==============================================================================
 bool cImage::convert(unsigned int a_newFormat)
 {
+    // the image data is modified
+    markAsModified();
+
     // verify if new format is different
     if (a_newFormat == m_format) { return (true); }
 
@@ -409,6 +424,9 @@ bool cImage::setProperties(const unsigned int a_width,
                            const GLenum a_format,
                            const GLenum a_type)
 {
+    // the image data is modified
+    markAsModified();
+
     // sanity check on image format
     int bytesPerPixel = queryBytesPerPixel(a_format, a_type);
     if (bytesPerPixel < 1) { return (false); }
@@ -465,6 +483,9 @@ void cImage::copyTo(const unsigned int a_sourcePosX,
     if (!a_destImage->isInitialized())
         { return; }
 
+    // the data of the destination image is modified
+    a_destImage->markAsModified();
+
     // if source and destination images are the same object, then we need
     // to create a copied image of the source. (overwriting problem)
     cImagePtr temp_image = cImagePtr();
@@ -841,6 +862,9 @@ void cImage::setData(unsigned char* a_data,
                      const unsigned int a_dataSizeInBytes,
                      const bool a_dealloc)
 {
+    // the image data is modified
+    markAsModified();
+
     // update data information
     m_data            = a_data;
     m_memorySize      = a_dataSizeInBytes;
@@ -877,6 +901,9 @@ void cImage::clear()
 //==============================================================================
 void cImage::clear(const cColorb& a_color)
 {
+    // the image data is modified
+    markAsModified();
+
     // check if image exists
     if (!m_allocated) { return; }
 
@@ -1193,6 +1220,9 @@ void cImage::setPixelColor(const unsigned int a_x,
                            const unsigned int a_y,
                            const cColorb& a_color)
 {
+    // the image data is modified
+    markAsModified();
+
     // check if image exists
     if (!m_allocated) { return; }
 
@@ -1241,6 +1271,9 @@ void cImage::setPixelColor(const unsigned int a_x,
                            const unsigned int a_y,
                            const unsigned char a_grayLevel)
 {
+    // the image data is modified
+    markAsModified();
+
     // check if image exists
     if (!m_allocated) { return; }
 
@@ -1291,6 +1324,9 @@ void cImage::setPixelColor(const unsigned int a_x,
 void cImage::setTransparentColor(const cColorb &a_color,
                                  const unsigned char a_transparencyLevel)
 {
+    // the image data is modified
+    markAsModified();
+
     // check if image exists
     if (!m_allocated) { return; }
 
@@ -1335,6 +1371,9 @@ void cImage::setTransparentColor(const cColorb &a_color,
 //==============================================================================
 void cImage::setTransparency(const unsigned char a_transparencyLevel)
 {
+    // the image data is modified
+    markAsModified();
+
     // check if image exists
     if (!m_allocated) { return; }
 
@@ -1368,6 +1407,9 @@ void cImage::setTransparency(const unsigned char a_transparencyLevel)
 //==============================================================================
 void cImage::flipHorizontal()
 {
+    // the image data is modified
+    markAsModified();
+
     // check if image exists
     if (!m_allocated) { return; }
 
@@ -1423,6 +1465,9 @@ void cImage::setTransparentColor(const unsigned char a_r,
 //==============================================================================
 bool cImage::loadFromFile(const string& a_filename)
 {
+    // the image data is modified
+    markAsModified();
+
     // cleanup previous image
     cleanup();
 
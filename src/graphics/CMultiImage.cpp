@@ -135,6 +135,9 @@ bool cMultiImage::allocate(const unsigned int a_width,
                            const GLenum a_format,
                            const GLenum a_type)
 {
+    // the image data is modified
+    markAsModified();
+
     // verify size makes sense
     if (a_width <= 0 || a_height <= 0 || a_slices <= 0)
     {
@@ -230,6 +233,9 @@ cMultiImagePtr cMultiImage::copy()
 //==============================================================================
 bool cMultiImage::convert(const unsigned int a_newFormat)
 {
+    // the image data is modified
+    markAsModified();
+
     // sanity check
     if (m_imageCount == 0)
     {
@@ -341,6 +347,9 @@ bool cMultiImage::selectImage(unsigned long a_index)
 bool cMultiImage::addImage(cImage &a_image,
                            unsigned long a_index)
 {
+    // the image data is modified
+    markAsModified();
+
     // check index validity
     if (a_index != (unsigned long)-1 &&
         a_index >= m_imageCount &&
@@ -427,6 +436,9 @@ bool cMultiImage::addImage(cImage &a_image,
 bool cMultiImage::addImagePrealloc(cImage &a_image,
                                    unsigned long a_index)
 {
+    // the image data is modified
+    markAsModified();
+
     // check index validity
     if (a_index != (unsigned long)-1 &&
         a_index >= m_imageCount &&
@@ -469,6 +481,9 @@ bool cMultiImage::addImagePrealloc(cImage &a_image,
 //==============================================================================
 bool cMultiImage::removeImage(unsigned long a_index)
 {
+    // the image data is modified
+    markAsModified();
+
     // check index validity
     if (a_index >= m_imageCount)
     {
@@ -830,6 +845,9 @@ void cMultiImage::setVoxelColor(const unsigned int a_x,
                                 const unsigned int a_z,
                                 const cColorb& a_color)
 {
+    // the image data is modified
+    markAsModified();
+
     // check if image exists
     if (!m_allocated) { return; }
 
@@ -880,6 +898,9 @@ void cMultiImage::setVoxelColor(const unsigned int a_x,
                                 const unsigned int a_z,
                                 const unsigned char a_grayLevel)
 {
+    // the image data is modified
+    markAsModified();
+
     // check if image exists
     if (!m_allocated) { return; }
 
@@ -930,6 +951,9 @@ void cMultiImage::setVoxelColor(const unsigned int a_x,
 void cMultiImage::setTransparentColor(const cColorb &a_color,
                                       const unsigned char a_transparencyLevel)
 {
+    // the image data is modified
+    markAsModified();
+
     // verify format, convert otherwise
     if (m_format != GL_RGBA)
     {
@@ -958,6 +982,9 @@ void cMultiImage::setTransparentColor(const cColorb &a_color,
 //==============================================================================
 void cMultiImage::setTransparency(const unsigned char a_transparencyLevel)
 {
+    // the image data is modified
+    markAsModified();
+
     // verify format, convert otherwise
     if (m_format != GL_RGBA)
     {
@@ -1031,6 +1058,9 @@ unsigned char* cMultiImage::getVoxelData(const unsigned int a_x,
 //==============================================================================
 void cMultiImage::flipHorizontal()
 {
+    // the image data is modified
+    markAsModified();
+
     // process all images one-by-one
     for (unsigned long i=0; i<m_imageCount; i++)
     {
@@ -1054,6 +1084,9 @@ void cMultiImage::flipHorizontal()
 //==============================================================================
 bool cMultiImage::loadFromFile(const string& a_filename)
 {
+    // the image data is modified
+    markAsModified();
+
     // cleanup previous set
     cleanup();
 
@@ -1202,6 +1235,9 @@ int cMultiImage::loadFromFiles(const std::vector<std::string>& a_filename)
 bool cMultiImage::addFromFile(const string& a_filename,
                               unsigned long a_index)
 {
+    // the image data is modified
+    markAsModified();
+
     cImage image;
 
     // load image from file
@@ -1232,6 +1268,9 @@ bool cMultiImage::addFromFile(const string& a_filename,
 bool cMultiImage::addFromFilePrealloc(const string& a_filename,
                                       unsigned long a_index)
 {
+    // the image data is modified
+    markAsModified();
+
     cImage image;
 
     // load image from file
@@ -233,47 +233,6 @@ cPointArrayPtr cPointArray::copy()
 }
 
 
-//==============================================================================
-/*!
-    This method compress the point array by removing all non allocated points.
-    If many points are unused, this method can effectively reduce 
-    the memory footprint allocated by the array.\n
-
-    __IMPORTANT:__ \n
-    After calling this method, it is important to immediately update any
-    collision detector as the collision tree may try to access points
-    that no longer exist.\n
-*/
-//==============================================================================
-void cPointArray::compress()
-{
-    // get number of allocated points
-    unsigned int numPoints = getNumElements();
-
-    // remove non allocated points
-    unsigned int j= (unsigned int)(-1);
-    for (unsigned int i=0; i<numPoints; i++)
-    {
-        if (getAllocated(i))
-        {
-            j++;
-
-            if (i!=j)
-            {
-                unsigned int index = getVertexIndex0(i);
-                m_allocated[j] = true;
-                setVertex(j, index);
-            }
-        }
-    }
-
-    // resize arrays
-    unsigned size = j+1;
-    m_allocated.resize(size);
-    m_indices.resize(1*size);
-}
-
-
 //------------------------------------------------------------------------------
 } // namespace chai3d
 //------------------------------------------------------------------------------
@@ -281,48 +281,6 @@ cSegmentArrayPtr cSegmentArray::copy()
 }
 
 
-//==============================================================================
-/*!
-    This method compresses the segment array by removing all non allocated 
-    segments. If many segments are unused, this method can effectively reduce 
-    the memory footprint allocated by the array.\n
-
-    __IMPORTANT:__ \n
-    After calling this method, it is important to immediately update any
-    collision detector as the collision tree may try to access segments
-    that no longer exist.\n
-*/
-//==============================================================================
-void cSegmentArray::compress()
-{
-    // get number of allocated segments
-    unsigned int numSegments = getNumElements();
-
-    // remove non allocated segments
-    unsigned int j= (unsigned int)(-1);
-    for (unsigned int i=0; i<numSegments; i++)
-    {
-        if (getAllocated(i))
-        {
-            j++;
-
-            if (i!=j)
-            {
-                unsigned int index0 = getVertexIndex0(i);
-                unsigned int index1 = getVertexIndex1(i);
-                m_allocated[j] = true;
-                setVertices(j, index0, index1);
-            }
-        }
-    }
-
-    // resize arrays
-    unsigned size = j+1;
-    m_allocated.resize(size);
-    m_indices.resize(2*size);
-}
-
-
 //------------------------------------------------------------------------------
 } // namespace chai3d
 //------------------------------------------------------------------------------
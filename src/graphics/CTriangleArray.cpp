@@ -496,49 +496,6 @@ cTriangleArrayPtr cTriangleArray::copy()
 }
 
 
-//==============================================================================
-/*!
-    This method compressed the triangle array by removing all non allocated
-    triangles. If many triangles are unused, this method can effectively reduce
-    the memory footprint allocated by the array.\n
-
-    __IMPORTANT:__ \n
-    After calling this method, it is important to immediately update any
-    collision detector as the collision tree may try to access triangles
-    that no longer exist.\n
-*/
-//==============================================================================
-void cTriangleArray::compress()
-{
-    // get number of allocated triangles
-    unsigned int numTriangles = getNumElements();
-
-    // remove non allocated triangles
-    unsigned int j= (unsigned int)(-1);
-    for (unsigned int i=0; i<numTriangles; i++)
-    {
-        if (getAllocated(i))
-        {
-            j++;
-
-            if (i!=j)
-            {
-                unsigned int index0 = getVertexIndex0(i);
-                unsigned int index1 = getVertexIndex1(i);
-                unsigned int index2 = getVertexIndex2(i);
-                m_allocated[j] = true;
-                setVertices(j, index0, index1, index2);
-            }
-        }
-    }
-
-    // resize arrays
-    unsigned size = j+1;
-    m_allocated.resize(size);
-    m_indices.resize(3*size);
-}
-
-
 //------------------------------------------------------------------------------
 } // namespace chai3d
 //------------------------------------------------------------------------------
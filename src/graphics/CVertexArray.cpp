@@ -0,0 +1,619 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2003-2016, CHAI3D.
+    (www.chai3d.org)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of CHAI3D nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE. 
+
+    \author    <http://www.chai3d.org>
+    \version   3.2.0 $Rev: 1869 $
+*/
+//==============================================================================
+
+//------------------------------------------------------------------------------
+#include "graphics/CVertexArray.h"
+//------------------------------------------------------------------------------
+#include "math/CMaths.h"
+#include "system/CThread.h"
+//------------------------------------------------------------------------------
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define C_VERTEX_ARRAY_USE_SSE2
+#include <emmintrin.h>
+#endif
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define C_VERTEX_ARRAY_USE_AVX2
+#include <immintrin.h>
+#endif
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+namespace chai3d {
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+// Smallest number of vertices transformed by each thread
+static const unsigned int C_VERTEX_ARRAY_VERTICES_PER_THREAD = 65536;
+//------------------------------------------------------------------------------
+
+//==============================================================================
+/*!
+    This function transforms a range of positions by a matrix followed by a
+    translation. The operations are done in the same order as in
+    cMatrix3d::mulr() and cVector3d::add(), so that results are identical to
+    the scalar code. Source and destination may be the same array.
+*/
+//==============================================================================
+static void cTransformRangeSSE2(const cVector3d* a_src,
+                                cVector3d* a_dst,
+                                const unsigned int a_num,
+                                const cMatrix3d& a_rot,
+                                const cVector3d& a_pos)
+{
+#if defined(C_VERTEX_ARRAY_USE_SSE2)
+
+    // X and Y are computed in pairs, Z on its own
+    const __m128d col0 = _mm_setr_pd(a_rot(0,0), a_rot(1,0));
+    const __m128d col1 = _mm_setr_pd(a_rot(0,1), a_rot(1,1));
+    const __m128d col2 = _mm_setr_pd(a_rot(0,2), a_rot(1,2));
+    const __m128d pos  = _mm_setr_pd(a_pos(0), a_pos(1));
+    const __m128d row2 = _mm_setr_pd(a_rot(2,0), a_rot(2,1));
+    const __m128d rot22 = _mm_set_sd(a_rot(2,2));
+    const __m128d pos2 = _mm_set_sd(a_pos(2));
+
+    for (unsigned int i=0; i<a_num; i++)
+    {
+        const double* src = &a_src[i](0);
+        __m128d xy = _mm_loadu_pd(src);
+        __m128d z = _mm_load_sd(src + 2);
+        __m128d x = _mm_unpacklo_pd(xy, xy);
+        __m128d y = _mm_unpackhi_pd(xy, xy);
+        __m128d zz = _mm_unpacklo_pd(z, z);
+
+        __m128d resultXY = _mm_add_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(col0, x),
+                                                            _mm_mul_pd(col1, y)),
+                                                 _mm_mul_pd(col2, zz)),
+                                      pos);
+
+        __m128d productsXY = _mm_mul_pd(row2, xy);
+        __m128d resultZ = _mm_add_sd(_mm_add_sd(_mm_add_sd(productsXY,
+                                                           _mm_unpackhi_pd(productsXY, productsXY)),
+                                                _mm_mul_sd(rot22, z)),
+                                     pos2);
+
+        double* dst = &a_dst[i](0);
+        _mm_storeu_pd(dst, resultXY);
+        _mm_store_sd(dst + 2, resultZ);
+    }
+
+#else
+
+    for (unsigned int i=0; i<a_num; i++)
+    {
+        cVector3d result;
+        a_rot.mulr(a_src[i], result);
+        result.add(a_pos);
+        a_dst[i] = result;
+    }
+
+#endif
+}
+
+
+#if defined(C_VERTEX_ARRAY_USE_AVX2)
+//==============================================================================
+/*!
+    This function is the AVX2 version of cTransformRangeSSE2(). It transforms
+    four positions at a time, with the X, Y and Z coordinates of the four
+    positions in separate registers, and leaves the remaining positions to
+    cTransformRangeSSE2(). The operations are done in the same order and
+    without fused multiply-add, so that results are identical.
+*/
+//==============================================================================
+__attribute__((target("avx2")))
+static void cTransformRangeAVX2(const cVector3d* a_src,
+                                cVector3d* a_dst,
+                                const unsigned int a_num,
+                                const cMatrix3d& a_rot,
+                                const cVector3d& a_pos)
+{
+    const __m256d r00 = _mm256_set1_pd(a_rot(0,0));
+    const __m256d r01 = _mm256_set1_pd(a_rot(0,1));
+    const __m256d r02 = _mm256_set1_pd(a_rot(0,2));
+    const __m256d r10 = _mm256_set1_pd(a_rot(1,0));
+    const __m256d r11 = _mm256_set1_pd(a_rot(1,1));
+    const __m256d r12 = _mm256_set1_pd(a_rot(1,2));
+    const __m256d r20 = _mm256_set1_pd(a_rot(2,0));
+    const __m256d r21 = _mm256_set1_pd(a_rot(2,1));
+    const __m256d r22 = _mm256_set1_pd(a_rot(2,2));
+    const __m256d px = _mm256_set1_pd(a_pos(0));
+    const __m256d py = _mm256_set1_pd(a_pos(1));
+    const __m256d pz = _mm256_set1_pd(a_pos(2));
+
+    unsigned int i = 0;
+    for (; i+4<=a_num; i+=4)
+    {
+        // (x0 y0 x2 y2) and (x1 y1 x3 y3)
+        const double* src = &a_src[i](0);
+        __m256d xy02 = _mm256_insertf128_pd(_mm256_castpd128_pd256(_mm_loadu_pd(src)), _mm_loadu_pd(src + 6), 1);
+        __m256d xy13 = _mm256_insertf128_pd(_mm256_castpd128_pd256(_mm_loadu_pd(src + 3)), _mm_loadu_pd(src + 9), 1);
+        __m256d x = _mm256_unpacklo_pd(xy02, xy13);
+        __m256d y = _mm256_unpackhi_pd(xy02, xy13);
+        __m256d z = _mm256_set_pd(src[11], src[8], src[5], src[2]);
+
+        __m256d resultX = _mm256_add_pd(_mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(r00, x),
+                                                                    _mm256_mul_pd(r01, y)),
+                                                      _mm256_mul_pd(r02, z)),
+                                        px);
+        __m256d resultY = _mm256_add_pd(_mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(r10, x),
+                                                                    _mm256_mul_pd(r11, y)),
+                                                      _mm256_mul_pd(r12, z)),
+                                        py);
+        __m256d resultZ = _mm256_add_pd(_mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(r20, x),
+                                                                    _mm256_mul_pd(r21, y)),
+                                                      _mm256_mul_pd(r22, z)),
+                                        pz);
+
+        double* dst = &a_dst[i](0);
+        __m256d resultXY02 = _mm256_unpacklo_pd(resultX, resultY);
+        __m256d resultXY13 = _mm256_unpackhi_pd(resultX, resultY);
+        __m128d resultZ01 = _mm256_castpd256_pd128(resultZ);
+        __m128d resultZ23 = _mm256_extractf128_pd(resultZ, 1);
+        _mm_storeu_pd(dst, _mm256_castpd256_pd128(resultXY02));
+        _mm_storeu_pd(dst + 3, _mm256_castpd256_pd128(resultXY13));
+        _mm_storeu_pd(dst + 6, _mm256_extractf128_pd(resultXY02, 1));
+        _mm_storeu_pd(dst + 9, _mm256_extractf128_pd(resultXY13, 1));
+        _mm_store_sd(dst + 2, resultZ01);
+        _mm_storeh_pd(dst + 5, resultZ01);
+        _mm_store_sd(dst + 8, resultZ23);
+        _mm_storeh_pd(dst + 11, resultZ23);
+    }
+
+    cTransformRangeSSE2(a_src + i, a_dst + i, a_num - i, a_rot, a_pos);
+}
+#endif
+
+
+//==============================================================================
+/*!
+    This function transforms a range of positions by a matrix followed by a
+    translation, with the AVX2 kernel when the processor supports it and the
+    SSE2 or scalar kernel otherwise.
+*/
+//==============================================================================
+static void cTransformRange(const cVector3d* a_src,
+                            cVector3d* a_dst,
+                            const unsigned int a_num,
+                            const cMatrix3d& a_rot,
+                            const cVector3d& a_pos)
+{
+#if defined(C_VERTEX_ARRAY_USE_AVX2)
+    static const bool useAVX2 = (__builtin_cpu_init(), __builtin_cpu_supports("avx2") != 0);
+    if (useAVX2)
+    {
+        cTransformRangeAVX2(a_src, a_dst, a_num, a_rot, a_pos);
+        return;
+    }
+#endif
+
+    cTransformRangeSSE2(a_src, a_dst, a_num, a_rot, a_pos);
+}
+
+
+//==============================================================================
+/*!
+    This function transforms an array of positions by a matrix followed by a
+    translation. Large arrays are split across the worker threads of
+    cParallelFor(): it is meant for edits of the geometry, not for the
+    haptic loop.
+*/
+//==============================================================================
+static void cTransformPositions(const cVector3d* a_src,
+                                cVector3d* a_dst,
+                                const unsigned int a_num,
+                                const cMatrix3d& a_rot,
+                                const cVector3d& a_pos)
+{
+    if (a_num < 2 * C_VERTEX_ARRAY_VERTICES_PER_THREAD)
+    {
+        cTransformRange(a_src, a_dst, a_num, a_rot, a_pos);
+        return;
+    }
+
+    const unsigned int numThreads = cMin(cGetNumHardwareThreads(),
+                                         a_num / C_VERTEX_ARRAY_VERTICES_PER_THREAD);
+
+    cParallelFor(numThreads, [&](unsigned int a_thread)
+    {
+        size_t begin = (size_t)a_thread * a_num / numThreads;
+        size_t end = (size_t)(a_thread + 1) * a_num / numThreads;
+        cTransformRange(a_src + begin, a_dst + begin, (unsigned int)(end - begin), a_rot, a_pos);
+    });
+}
+
+
+//==============================================================================
+/*!
+    This function transforms an array of positions in single precision by a
+    matrix followed by a translation. The result is stored in double
+    precision if __a_dst__ is not __nullptr__, and in place otherwise.
+*/
+//==============================================================================
+static void cTransformCompactPositions(float* a_src,
+                                       cVector3d* a_dst,
+                                       const unsigned int a_num,
+                                       const cMatrix3d& a_rot,
+                                       const cVector3d& a_pos)
+{
+    for (unsigned int i=0; i<a_num; i++)
+    {
+        float* src = &a_src[3 * i];
+        cVector3d result;
+        a_rot.mulr(cVector3d(src[0], src[1], src[2]), result);
+        result.add(a_pos);
+        if (a_dst != nullptr)
+        {
+            a_dst[i] = result;
+        }
+        else
+        {
+            src[0] = (float)result(0);
+            src[1] = (float)result(1);
+            src[2] = (float)result(2);
+        }
+    }
+}
+
+
+//==============================================================================
+/*!
+    This function moves the data of the vertices that are kept to their new
+    index, and releases the memory of the removed ones. Vertices keep their
+    order, so the data can be moved in place.
+
+    \param  a_data        Attribute data, __a_stride__ components per vertex.
+    \param  a_newIndices  New index of each vertex, or -1 if it is removed.
+    \param  a_numKept     Number of vertices that are kept.
+    \param  a_stride      Number of components per vertex.
+*/
+//==============================================================================
+template <typename T>
+static void cCompressAttribute(std::vector<T>& a_data,
+                               const std::vector<int>& a_newIndices,
+                               const unsigned int a_numKept,
+                               const unsigned int a_stride)
+{
+    // attributes that are not allocated stay empty
+    if (a_data.size() < a_stride * a_newIndices.size())
+    {
+        a_data.clear();
+        a_data.shrink_to_fit();
+        return;
+    }
+
+    for (size_t i=0; i<a_newIndices.size(); i++)
+    {
+        int j = a_newIndices[i];
+        if ((j >= 0) && ((size_t)(j) != i))
+        {
+            for (unsigned int k=0; k<a_stride; k++)
+            {
+                a_data[a_stride*j+k] = a_data[a_stride*i+k];
+            }
+        }
+    }
+    a_data.resize(a_stride * a_numKept);
+    a_data.shrink_to_fit();
+}
+
+
+//==============================================================================
+/*!
+    This method computes the global position of all vertices given the global
+    position and global rotation matrix of the parent object.
+
+    This method is called from the haptic loop, so it runs on the calling
+    thread only.
+
+    \param  a_globalPos  Global position vector of parent.
+    \param  a_globalRot  Global rotation matrix of parent.
+*/
+//==============================================================================
+void cVertexArray::computeGlobalPositions(const cVector3d& a_globalPos,
+                                          const cMatrix3d& a_globalRot)
+{
+    if (m_numVertices == 0) { return; }
+
+    // compact storage allocates global positions when they are first needed
+    if (m_globalPos.size() != m_numVertices)
+    {
+        m_globalPos.resize(m_numVertices);
+    }
+
+    if (m_compactStorage)
+    {
+        cTransformCompactPositions(&m_compactLocalPos[0], &m_globalPos[0], m_numVertices, a_globalRot, a_globalPos);
+    }
+    else
+    {
+        cTransformRange(&m_localPos[0], &m_globalPos[0], m_numVertices, a_globalRot, a_globalPos);
+    }
+}
+
+
+//==============================================================================
+/*!
+    This method transforms the local position of all vertices by a matrix
+    (a rotation or a scaling) followed by a translation.
+
+    \param  a_rot          Transformation matrix.
+    \param  a_translation  Translation added after the transformation.
+*/
+//==============================================================================
+void cVertexArray::transformLocalPositions(const cMatrix3d& a_rot,
+                                           const cVector3d& a_translation)
+{
+    if (m_numVertices == 0) { return; }
+
+    if (m_compactStorage)
+    {
+        cTransformCompactPositions(&m_compactLocalPos[0], nullptr, m_numVertices, a_rot, a_translation);
+    }
+    else
+    {
+        cTransformPositions(&m_localPos[0], &m_localPos[0], m_numVertices, a_rot, a_translation);
+    }
+    m_flagPositionData = true;
+}
+
+
+//==============================================================================
+/*!
+    This method selects how positions and normals are stored. In compact
+    storage, they are stored in single precision (and normals optionally in 16
+    bits per component), which divides the memory used by large meshes by 4 to
+    8. Texture coordinates, colors, tangents, bitangents and user data are
+    only allocated when they are first set, and global positions when they are
+    first computed. Attributes that only hold their default value are released
+    when switching to compact storage. \n
+
+    Accessors behave in the same way in both storages, but the public arrays
+    of positions and normals in double precision are empty in compact storage.
+
+    \param  a_compactStorage   If __true__, then positions and normals are stored in single precision.
+    \param  a_quantizeNormals  If __true__, then normals are quantized to 16 bits per component.
+*/
+//==============================================================================
+void cVertexArray::setCompactStorage(const bool a_compactStorage,
+                                     const bool a_quantizeNormals)
+{
+    const bool quantizeNormals = a_compactStorage && a_quantizeNormals;
+    if ((a_compactStorage == m_compactStorage) && (quantizeNormals == m_quantizedNormals)) { return; }
+
+    // read positions and normals in the current storage
+    std::vector<cVector3d> positions(m_numVertices);
+    std::vector<cVector3d> normals(m_useNormalData ? m_numVertices : 0);
+    for (unsigned int i=0; i<m_numVertices; i++)
+    {
+        positions[i] = getLocalPos(i);
+        if (m_useNormalData)
+        {
+            normals[i] = getNormal(i);
+        }
+    }
+
+    // release all positions and normals
+    std::vector<cVector3d>().swap(m_localPos);
+    std::vector<cVector3d>().swap(m_globalPos);
+    std::vector<cVector3d>().swap(m_normal);
+    std::vector<float>().swap(m_compactLocalPos);
+    std::vector<float>().swap(m_compactNormal);
+    std::vector<short>().swap(m_quantizedNormal);
+
+    m_compactStorage = a_compactStorage;
+    m_quantizedNormals = quantizeNormals;
+
+    if (m_compactStorage)
+    {
+        m_compactLocalPos.resize(3 * m_numVertices);
+        if (m_useNormalData)
+        {
+            if (m_quantizedNormals)
+            {
+                m_quantizedNormal.resize(3 * m_numVertices);
+            }
+            else
+            {
+                m_compactNormal.resize(3 * m_numVertices);
+            }
+        }
+
+        // release attributes that were never set
+        bool defaultTexCoord = true;
+        bool defaultColor = true;
+        bool defaultTangent = true;
+        bool defaultBitangent = true;
+        bool defaultUserData = true;
+        for (size_t i=0; i<m_texCoord.size(); i++)
+        {
+            defaultTexCoord = defaultTexCoord && (m_texCoord[i].lengthsq() == 0.0);
+        }
+        for (size_t i=0; i<m_color.size(); i++)
+        {
+            defaultColor = defaultColor && (m_color[i].getR() == 0.0f) && (m_color[i].getG() == 0.0f) &&
+                           (m_color[i].getB() == 0.0f) && (m_color[i].getA() == 1.0f);
+        }
+        for (size_t i=0; i<m_tangent.size(); i++)
+        {
+            defaultTangent = defaultTangent && (cDistance(m_tangent[i], cVector3d(1.0, 0.0, 0.0)) == 0.0);
+        }
+        for (size_t i=0; i<m_bitangent.size(); i++)
+        {
+            defaultBitangent = defaultBitangent && (cDistance(m_bitangent[i], cVector3d(0.0, 1.0, 0.0)) == 0.0);
+        }
+        for (size_t i=0; i<m_userData.size(); i++)
+        {
+            defaultUserData = defaultUserData && (m_userData[i] == 0);
+        }
+        if (defaultTexCoord) { std::vector<cVector3d>().swap(m_texCoord); }
+        if (defaultColor) { std::vector<cColorf>().swap(m_color); }
+        if (defaultTangent) { std::vector<cVector3d>().swap(m_tangent); }
+        if (defaultBitangent) { std::vector<cVector3d>().swap(m_bitangent); }
+        if (defaultUserData) { std::vector<int>().swap(m_userData); }
+    }
+    else
+    {
+        m_localPos.resize(m_numVertices);
+        m_globalPos.resize(m_numVertices, cVector3d(0.0, 0.0, 0.0));
+        if (m_useNormalData)
+        {
+            m_normal.resize(m_numVertices);
+        }
+
+        // allocate all attributes in use
+        if (m_useTexCoordData) { allocateAttribute(m_texCoord, cVector3d(0.0, 0.0, 0.0)); }
+        if (m_useColorData) { allocateAttribute(m_color, cColorf(0.0, 0.0, 0.0, 1.0)); }
+        if (m_useTangentData) { allocateAttribute(m_tangent, cVector3d(1.0, 0.0, 0.0)); }
+        if (m_useBitangentData) { allocateAttribute(m_bitangent, cVector3d(0.0, 1.0, 0.0)); }
+        if (m_useUserData) { allocateAttribute(m_userData, 0); }
+    }
+
+    // store positions and normals in the new storage
+    for (unsigned int i=0; i<m_numVertices; i++)
+    {
+        setLocalPos(i, positions[i]);
+        if (m_useNormalData)
+        {
+            setNormal(i, normals[i]);
+        }
+    }
+
+    m_flagBufferResize = true;
+    m_flagPositionData = true;
+    m_flagNormalData = m_useNormalData;
+}
+
+
+//==============================================================================
+/*!
+    This method returns the number of bytes allocated for vertex data.
+
+    \return Number of bytes.
+*/
+//==============================================================================
+size_t cVertexArray::getMemoryUsage() const
+{
+    return (m_localPos.capacity() * sizeof(cVector3d) +
+            m_globalPos.capacity() * sizeof(cVector3d) +
+            m_normal.capacity() * sizeof(cVector3d) +
+            m_texCoord.capacity() * sizeof(cVector3d) +
+            m_color.capacity() * sizeof(cColorf) +
+            m_tangent.capacity() * sizeof(cVector3d) +
+            m_bitangent.capacity() * sizeof(cVector3d) +
+            m_userData.capacity() * sizeof(int) +
+            m_compactLocalPos.capacity() * sizeof(float) +
+            m_compactNormal.capacity() * sizeof(float) +
+            m_quantizedNormal.capacity() * sizeof(short));
+}
+
+
+//==============================================================================
+/*!
+    This method removes the vertices that are not used and renumbers the
+    remaining ones, which keep their order. All vertex data is moved and the
+    memory of the removed vertices is released.\n
+
+    __IMPORTANT:__ \n
+    Elements that refer to this array must have their vertex indices
+    remapped with __a_newIndices__ immediately after calling this method.\n
+
+    \param  a_used        __true__ for each vertex that is kept.
+    \param  a_newIndices  Returns the new index of each vertex, or -1 if it is removed.
+
+    \return Number of removed vertices.
+*/
+//==============================================================================
+unsigned int cVertexArray::compress(const std::vector<bool>& a_used,
+                                    std::vector<int>& a_newIndices)
+{
+    // number the vertices that are kept
+    a_newIndices.resize(m_numVertices);
+    unsigned int numKept = 0;
+    for (unsigned int i=0; i<m_numVertices; i++)
+    {
+        if ((i < a_used.size()) && a_used[i])
+        {
+            a_newIndices[i] = (int)(numKept++);
+        }
+        else
+        {
+            a_newIndices[i] = -1;
+        }
+    }
+
+    unsigned int numRemoved = m_numVertices - numKept;
+    if (numRemoved == 0)
+    {
+        return (0);
+    }
+
+    // move vertex data
+    cCompressAttribute(m_localPos, a_newIndices, numKept, 1);
+    cCompressAttribute(m_globalPos, a_newIndices, numKept, 1);
+    cCompressAttribute(m_normal, a_newIndices, numKept, 1);
+    cCompressAttribute(m_texCoord, a_newIndices, numKept, 1);
+    cCompressAttribute(m_color, a_newIndices, numKept, 1);
+    cCompressAttribute(m_tangent, a_newIndices, numKept, 1);
+    cCompressAttribute(m_bitangent, a_newIndices, numKept, 1);
+    cCompressAttribute(m_userData, a_newIndices, numKept, 1);
+    cCompressAttribute(m_compactLocalPos, a_newIndices, numKept, 3);
+    cCompressAttribute(m_compactNormal, a_newIndices, numKept, 3);
+    cCompressAttribute(m_quantizedNormal, a_newIndices, numKept, 3);
+    m_numVertices = numKept;
+
+    // mark for update
+    m_flagPositionData  = true;
+    m_flagNormalData    = true;
+    m_flagTexCoordData  = true;
+    m_flagColorData     = true;
+    m_flagTangentData   = true;
+    m_flagBitangentData = true;
+    m_flagUserData      = true;
+    m_flagBufferResize  = true;
+
+    return (numRemoved);
+}
+
+
+//------------------------------------------------------------------------------
+} // namespace chai3d
+//------------------------------------------------------------------------------
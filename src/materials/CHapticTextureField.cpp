@@ -0,0 +1,356 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2003-2016, CHAI3D.
+    (www.chai3d.org)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of CHAI3D nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE. 
+
+    \author    <http://www.chai3d.org>
+    \version   3.2.0 $Rev: 1869 $
+*/
+//==============================================================================
+
+//------------------------------------------------------------------------------
+#include "materials/CHapticTextureField.h"
+#include "math/CMaths.h"
+#include "system/CThread.h"
+//------------------------------------------------------------------------------
+#include <cstdint>
+#include <cmath>
+//------------------------------------------------------------------------------
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 1))
+#define C_HAPTIC_TEXTURE_USE_SSE
+#include <xmmintrin.h>
+#endif
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+namespace chai3d {
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+//------------------------------------------------------------------------------
+
+// size of a cache line, in floats
+const size_t C_HAPTIC_TEXTURE_ALIGNMENT = 16;
+
+//------------------------------------------------------------------------------
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+//------------------------------------------------------------------------------
+
+
+//==============================================================================
+/*!
+    Constructor of cHapticTextureField.
+*/
+//==============================================================================
+cHapticTextureField::cHapticTextureField()
+{
+    m_texels = NULL;
+}
+
+
+//==============================================================================
+/*!
+    This method creates the field from a normal map image, as created by
+    \ref cNormalMap::createMap(), and an optional height image whose
+    luminance gives the height of the surface (between 0 and 1). \n
+
+    The gradient of each texel is decoded from the RGB components of the
+    normal map exactly as the finger-proxy algorithm does it when it reads the
+    normal map directly.
+
+    \param  a_normalImage  Normal map image.
+    \param  a_heightImage  Height image (same size as the normal map), or __nullptr__.
+    \param  a_numLevels    Number of mipmap levels. If 0 or less, all levels down to 1x1 texel are created.
+
+    \return __true__ if in case of success, __false__ otherwise.
+*/
+//==============================================================================
+bool cHapticTextureField::createField(cImagePtr a_normalImage,
+                                      cImagePtr a_heightImage,
+                                      const int a_numLevels)
+{
+    m_levels.clear();
+    m_data.clear();
+    m_texels = NULL;
+
+    // sanity check
+    if (a_normalImage == nullptr) { return (C_ERROR); }
+
+    int w = a_normalImage->getWidth();
+    int h = a_normalImage->getHeight();
+    if ((w <= 0) || (h <= 0)) { return (C_ERROR); }
+
+    if ((a_heightImage != nullptr) &&
+        (((int)a_heightImage->getWidth() != w) || ((int)a_heightImage->getHeight() != h)))
+    {
+        return (C_ERROR);
+    }
+
+    // compute the size of each level, aligned on whole tiles
+    const int tileSize = (int)C_HAPTIC_TEXTURE_TILE_SIZE;
+    size_t numTexels = 0;
+    while (true)
+    {
+        cLevel level;
+        level.m_width = w;
+        level.m_height = h;
+        level.m_numTilesX = (w + tileSize - 1) / tileSize;
+        level.m_offset = numTexels;
+        int numTilesY = (h + tileSize - 1) / tileSize;
+        numTexels += (size_t)level.m_numTilesX * numTilesY * tileSize * tileSize;
+        m_levels.push_back(level);
+
+        if (((a_numLevels > 0) && ((int)m_levels.size() >= a_numLevels)) || ((w == 1) && (h == 1)))
+        {
+            break;
+        }
+        w = cMax(1, w / 2);
+        h = cMax(1, h / 2);
+    }
+
+    // allocate texels, aligned on a cache line
+    m_data.assign(4 * numTexels + C_HAPTIC_TEXTURE_ALIGNMENT, 0.0f);
+    uintptr_t address = (uintptr_t)m_data.data();
+    uintptr_t alignment = C_HAPTIC_TEXTURE_ALIGNMENT * sizeof(float);
+    m_texels = (float*)((address + alignment - 1) & ~(alignment - 1));
+
+    // decode the finest level, one tile at a time so that texels are
+    // written sequentially, and rows of tiles in parallel
+    const cLevel& level0 = m_levels[0];
+    const double SCALE = (1.0/255.0);
+    const int numTileRows = (level0.m_height + tileSize - 1) / tileSize;
+    const unsigned int numThreads = cMin(cGetNumHardwareThreads(), (unsigned int)numTileRows);
+    cParallelFor(numThreads, [&](unsigned int a_thread)
+    {
+        for (int ty=(int)a_thread * tileSize; ty<level0.m_height; ty+=(int)numThreads * tileSize)
+        {
+            for (int tx=0; tx<level0.m_width; tx+=tileSize)
+            {
+                for (int y=ty; y<cMin(ty + tileSize, level0.m_height); y++)
+                {
+                    for (int x=tx; x<cMin(tx + tileSize, level0.m_width); x++)
+                    {
+                        cColorb color;
+                        a_normalImage->getPixelColor(x, y, color);
+
+                        float* texel = getTexel(level0, x, y);
+                        texel[0] = (float)( SCALE * (color.getR() - 128));
+                        texel[1] = (float)(-SCALE * (color.getG() - 128));
+                        texel[2] = (float)( SCALE * (color.getB() - 128));
+                        texel[3] = 0.0f;
+
+                        if (a_heightImage != nullptr)
+                        {
+                            cColorb height;
+                            a_heightImage->getPixelColor(x, y, height);
+                            texel[3] = (float)(SCALE * height.getLuminance());
+                        }
+                    }
+                }
+            }
+        }
+    });
+
+    // average 2x2 texels of each level to build the next one
+    for (size_t i=1; i<m_levels.size(); i++)
+    {
+        const cLevel& src = m_levels[i-1];
+        const cLevel& dst = m_levels[i];
+        const unsigned int numRowThreads = cMin(numThreads, (unsigned int)dst.m_height);
+        cParallelFor(numRowThreads, [&](unsigned int a_thread)
+        {
+            for (int y=(int)a_thread; y<dst.m_height; y+=(int)numRowThreads)
+            {
+                int y0 = cMin(2 * y, src.m_height - 1);
+                int y1 = cMin(2 * y + 1, src.m_height - 1);
+                for (int x=0; x<dst.m_width; x++)
+                {
+                    int x0 = cMin(2 * x, src.m_width - 1);
+                    int x1 = cMin(2 * x + 1, src.m_width - 1);
+                    const float* t00 = getTexel(src, x0, y0);
+                    const float* t10 = getTexel(src, x1, y0);
+                    const float* t01 = getTexel(src, x0, y1);
+                    const float* t11 = getTexel(src, x1, y1);
+                    float* texel = getTexel(dst, x, y);
+                    for (int k=0; k<4; k++)
+                    {
+                        texel[k] = 0.25f * (t00[k] + t10[k] + t01[k] + t11[k]);
+                    }
+                }
+            }
+        });
+    }
+
+    return (C_SUCCESS);
+}
+
+
+//==============================================================================
+/*!
+    This method returns the mipmap level to use when a contact moves across
+    __a_texels__ texels of the finest level between two haptic samples. The
+    finest level is used up to one texel per sample; each time the speed
+    doubles, the next coarser level is used.
+
+    \param  a_texels  Number of texels travelled per sample.
+
+    \return Mipmap level (may be fractional).
+*/
+//==============================================================================
+double cHapticTextureField::getLevel(const double a_texels) const
+{
+    if ((m_levels.size() < 2) || !(a_texels > 1.0)) { return (0.0); }
+    return (cMin(log(a_texels) / log(2.0), (double)(m_levels.size() - 1)));
+}
+
+
+//==============================================================================
+/*!
+    This method samples the field at texture coordinate (__a_u__, __a_v__)
+    with bilinear interpolation between the four nearest texels. Texture
+    coordinates are clamped to [0, 1]. If __a_level__ is fractional, the two
+    nearest mipmap levels are sampled and blended.
+
+    \param  a_u      Texture coordinate along the X axis.
+    \param  a_v      Texture coordinate along the Y axis.
+    \param  a_level  Mipmap level, as returned by \ref getLevel().
+    \param  a_value  Returned gradient (x, y, z) and height.
+*/
+//==============================================================================
+void cHapticTextureField::sample(const double a_u,
+                                 const double a_v,
+                                 const double a_level,
+                                 double a_value[4]) const
+{
+    if (m_levels.empty())
+    {
+        a_value[0] = a_value[1] = a_value[2] = a_value[3] = 0.0;
+        return;
+    }
+
+    // select levels
+    double level = cClamp(a_level, 0.0, (double)(m_levels.size() - 1));
+    int level0 = (int)level;
+    double blend = level - level0;
+
+    float value[4];
+    sampleLevel(m_levels[level0], a_u, a_v, value);
+
+    if (blend > 0.0)
+    {
+        float value1[4];
+        sampleLevel(m_levels[level0 + 1], a_u, a_v, value1);
+        for (int k=0; k<4; k++)
+        {
+            value[k] += (float)blend * (value1[k] - value[k]);
+        }
+    }
+
+    for (int k=0; k<4; k++)
+    {
+        a_value[k] = value[k];
+    }
+}
+
+
+//==============================================================================
+/*!
+    This method samples a mipmap level with bilinear interpolation. Pixel
+    centers are at (w-1) * u and (h-1) * v, as in the finger-proxy algorithm.
+
+    \param  a_level  Mipmap level.
+    \param  a_u      Texture coordinate along the X axis.
+    \param  a_v      Texture coordinate along the Y axis.
+    \param  a_value  Returned gradient (x, y, z) and height.
+*/
+//==============================================================================
+void cHapticTextureField::sampleLevel(const cLevel& a_level,
+                                      const double a_u,
+                                      const double a_v,
+                                      float a_value[4]) const
+{
+    // pixel coordinates, clamped to the image without branches (NaN gives
+    // the last pixel)
+    double maxX = (double)(a_level.m_width - 1);
+    double maxY = (double)(a_level.m_height - 1);
+    double px = maxX * a_u;
+    double py = maxY * a_v;
+    px = (px < maxX) ? px : maxX;
+    py = (py < maxY) ? py : maxY;
+    px = (px > 0.0) ? px : 0.0;
+    py = (py > 0.0) ? py : 0.0;
+
+    unsigned int x0 = (unsigned int)px;
+    unsigned int y0 = (unsigned int)py;
+    unsigned int x1 = cMin(x0 + 1, (unsigned int)(a_level.m_width - 1));
+    unsigned int y1 = cMin(y0 + 1, (unsigned int)(a_level.m_height - 1));
+
+    // bilinear weights
+    float x = (float)(px - x0);
+    float y = (float)(py - y0);
+    float w00 = (1.0f - x) * (1.0f - y);
+    float w10 = x * (1.0f - y);
+    float w01 = (1.0f - x) * y;
+    float w11 = x * y;
+
+    const float* t00 = getTexel(a_level, x0, y0);
+    const float* t10 = getTexel(a_level, x1, y0);
+    const float* t01 = getTexel(a_level, x0, y1);
+    const float* t11 = getTexel(a_level, x1, y1);
+
+#if defined(C_HAPTIC_TEXTURE_USE_SSE)
+
+    // texels are 16 byte aligned
+    __m128 value = _mm_mul_ps(_mm_load_ps(t00), _mm_set1_ps(w00));
+    value = _mm_add_ps(value, _mm_mul_ps(_mm_load_ps(t10), _mm_set1_ps(w10)));
+    value = _mm_add_ps(value, _mm_mul_ps(_mm_load_ps(t01), _mm_set1_ps(w01)));
+    value = _mm_add_ps(value, _mm_mul_ps(_mm_load_ps(t11), _mm_set1_ps(w11)));
+    _mm_storeu_ps(a_value, value);
+
+#else
+
+    for (int k=0; k<4; k++)
+    {
+        a_value[k] = t00[k] * w00 + t10[k] * w10 + t01[k] * w01 + t11[k] * w11;
+    }
+
+#endif
+}
+
+
+//------------------------------------------------------------------------------
+} // namespace chai3d
+//------------------------------------------------------------------------------
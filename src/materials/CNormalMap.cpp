@@ -43,6 +43,9 @@
 
 //------------------------------------------------------------------------------
 #include "materials/CNormalMap.h"
+#include "system/CThread.h"
+//------------------------------------------------------------------------------
+#include <vector>
 using namespace std;
 //------------------------------------------------------------------------------
 
@@ -96,6 +99,9 @@ cNormalMapPtr cNormalMap::copy()
     obj->m_useSphericalMapping      = m_useSphericalMapping;
     obj->m_environmentMode          = m_environmentMode;
 
+    // the haptic field is never modified once created
+    obj->m_hapticField              = m_hapticField;
+
     // return
     return (obj);
 }
@@ -141,45 +147,64 @@ void cNormalMap::createMap(cImagePtr a_image)
 
     // allocate image size
     m_image->allocate(w, h, GL_RGB);
+    if ((w <= 0) || (h <= 0)) { return; }
 
-    for (int u=0; u<w; u++)
+    // height of each pixel, read once from the luminance of the input image
+    vector<GLubyte> level((size_t)w * (size_t)h);
+    const unsigned int numThreads = cMin(cGetNumHardwareThreads(), (unsigned int)h);
+    cParallelFor(numThreads, [&](unsigned int a_thread)
     {
-        for (int v=0; v<h; v++)
+        for (int v=(int)a_thread; v<h; v+=(int)numThreads)
         {
-            cColorb colorU0V, colorU1V, colorUV0, colorUV1;
-
-            // get color pixels
-            a_image->getPixelColor(u, cClamp(v-1, 0, h-1), colorUV0);
-            a_image->getPixelColor(u, cClamp(v+1, 0, h-1), colorUV1);
-            a_image->getPixelColor(cClamp(u-1, 0, w-1), v, colorU0V);
-            a_image->getPixelColor(cClamp(u+1, 0, w-1), v, colorU1V);
-
-            // compute height from luminance value
-            double levelUV0 = (double)(colorUV0.getLuminance());
-            double levelUV1 = (double)(colorUV1.getLuminance());
-            double levelU0V = (double)(colorU0V.getLuminance());
-            double levelU1V = (double)(colorU1V.getLuminance());
-
-            // compute normalized gradient
-            double SCALE = 1.0/255.0;
-            double deltaU =-SCALE * (levelU1V - levelU0V);
-            double deltaV = SCALE * (levelUV1 - levelUV0);
-            double deltaH = 1-cSqr(deltaU)-cSqr(deltaV);
-
-            // compute length of vector
-            double l = sqrt(deltaU*deltaU + deltaV*deltaV + deltaH*deltaH);
-
-            // normalize, scale, and offset
-            deltaU = 128 + 127 * (deltaU / l);
-            deltaV = 128 + 127 * (deltaV / l);
-            deltaH = 128 + 127 * (deltaH / l);
-
-            // set gradient value at location (u,v)
-            cColorb gradient;
-            gradient.set((GLubyte)deltaU, (GLubyte)deltaV, (GLubyte)deltaH, 0xff);
-            m_image->setPixelColor(u, v, gradient);
+            for (int u=0; u<w; u++)
+            {
+                cColorb color;
+                a_image->getPixelColor(u, v, color);
+                level[(size_t)v * w + u] = color.getLuminance();
+            }
         }
-    }
+    });
+
+    // compute normalized gradients, one row at a time
+    unsigned char* data = m_image->getData();
+    cParallelFor(numThreads, [&](unsigned int a_thread)
+    {
+        for (int v=(int)a_thread; v<h; v+=(int)numThreads)
+        {
+            const GLubyte* rowV  = &level[(size_t)v * w];
+            const GLubyte* rowV0 = &level[(size_t)cClamp(v-1, 0, h-1) * w];
+            const GLubyte* rowV1 = &level[(size_t)cClamp(v+1, 0, h-1) * w];
+            unsigned char* gradient = &data[3 * (size_t)v * w];
+
+            for (int u=0; u<w; u++)
+            {
+                // compute height from luminance value
+                double levelUV0 = (double)(rowV0[u]);
+                double levelUV1 = (double)(rowV1[u]);
+                double levelU0V = (double)(rowV[cClamp(u-1, 0, w-1)]);
+                double levelU1V = (double)(rowV[cClamp(u+1, 0, w-1)]);
+
+                // compute normalized gradient
+                double SCALE = 1.0/255.0;
+                double deltaU =-SCALE * (levelU1V - levelU0V);
+                double deltaV = SCALE * (levelUV1 - levelUV0);
+                double deltaH = 1-cSqr(deltaU)-cSqr(deltaV);
+
+                // compute length of vector
+                double l = sqrt(deltaU*deltaU + deltaV*deltaV + deltaH*deltaH);
+
+                // normalize, scale, and offset
+                deltaU = 128 + 127 * (deltaU / l);
+                deltaV = 128 + 127 * (deltaV / l);
+                deltaH = 128 + 127 * (deltaH / l);
+
+                // set gradient value at location (u,v)
+                gradient[3*u]   = (GLubyte)deltaU;
+                gradient[3*u+1] = (GLubyte)deltaV;
+                gradient[3*u+2] = (GLubyte)deltaH;
+            }
+        }
+    });
 }
 
 
@@ -217,6 +242,32 @@ void cNormalMap::flip(const bool a_flipU, const bool a_flipV)
 }
 
 
+//==============================================================================
+/*!
+    This method precomputes the field used for haptic texture rendering from
+    the current normal map image, so that the finger-proxy algorithm does not
+    need to read and convert image pixels. The field must be created again if
+    the normal map image is modified.
+
+    \param  a_heightImage  Image whose luminance gives the height of the surface, or __nullptr__.
+    \param  a_numLevels    Number of mipmap levels used at high contact speeds (1 disables mipmapping, 0 or less creates all levels).
+
+    \return __true__ if in case of success, __false__ otherwise.
+*/
+//==============================================================================
+bool cNormalMap::createHapticField(cImagePtr a_heightImage, const int a_numLevels)
+{
+    cHapticTextureFieldPtr field = cHapticTextureField::create();
+    if (!field->createField(m_image, a_heightImage, a_numLevels))
+    {
+        return (C_ERROR);
+    }
+
+    m_hapticField = field;
+    return (C_SUCCESS);
+}
+
+
 //------------------------------------------------------------------------------
 } // namespace chai3d
 //------------------------------------------------------------------------------
@@ -0,0 +1,407 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2003-2016, CHAI3D.
+    (www.chai3d.org)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of CHAI3D nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE. 
+
+    \author    <http://www.chai3d.org>
+    \version   3.2.0 $Rev: 1869 $
+*/
+//==============================================================================
+
+//------------------------------------------------------------------------------
+#include "system/CArena.h"
+//------------------------------------------------------------------------------
+#include <new>
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+namespace chai3d {
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+// Arena of the object being allocated by the calling thread, handed from the
+// __new__ operator to the constructor of cArenaObject.
+static thread_local cArena* s_newObjectArena = NULL;
+//------------------------------------------------------------------------------
+
+
+//==============================================================================
+/*!
+    Constructor of cArenaObject. The object takes the arena it was allocated
+    from by its __new__ operator.
+*/
+//==============================================================================
+cArenaObject::cArenaObject()
+{
+    m_arena = s_newObjectArena;
+    s_newObjectArena = NULL;
+}
+
+
+//==============================================================================
+/*!
+    Copy constructor of cArenaObject. The copy takes the arena it was
+    allocated from, not the arena of the original.
+
+    \param  a_object  Original object.
+*/
+//==============================================================================
+cArenaObject::cArenaObject(const cArenaObject& /*a_object*/)
+{
+    m_arena = s_newObjectArena;
+    s_newObjectArena = NULL;
+}
+
+
+//==============================================================================
+/*!
+    This operator allocates an object on the heap.
+
+    \param  a_size  Size of the object.
+
+    \return Pointer to the memory of the object.
+*/
+//==============================================================================
+void* cArenaObject::operator new(size_t a_size)
+{
+    void* object = cArena::allocate(NULL, a_size);
+    s_newObjectArena = NULL;
+    return (object);
+}
+
+
+//==============================================================================
+/*!
+    This operator allocates an object from an arena, or on the heap if the
+    arena is NULL.
+
+    \param  a_size   Size of the object.
+    \param  a_arena  Arena, or NULL.
+
+    \return Pointer to the memory of the object.
+*/
+//==============================================================================
+void* cArenaObject::operator new(size_t a_size, cArena* a_arena)
+{
+    void* object = cArena::allocate(a_arena, a_size);
+    s_newObjectArena = a_arena;
+    return (object);
+}
+
+
+//==============================================================================
+/*!
+    This operator releases the memory of an object, on the heap or in the
+    arena it was allocated from.
+
+    \param  a_object  Pointer to the memory of the object.
+*/
+//==============================================================================
+void cArenaObject::operator delete(void* a_object)
+{
+    cArena::deallocate(a_object);
+}
+
+
+//==============================================================================
+/*!
+    This operator releases the memory of an object whose constructor threw
+    an exception.
+
+    \param  a_object  Pointer to the memory of the object.
+    \param  a_arena   Arena, or NULL.
+*/
+//==============================================================================
+void cArenaObject::operator delete(void* a_object, cArena* /*a_arena*/)
+{
+    cArena::deallocate(a_object);
+}
+
+
+//==============================================================================
+/*!
+    Constructor of cArena.
+*/
+//==============================================================================
+cArena::cArena()
+{
+    // the owner holds a reference until it releases the arena
+    m_numReferences = 1;
+    m_numBytes = 0;
+    m_released = false;
+}
+
+
+//==============================================================================
+/*!
+    Destructor of cArena. All memory blocks are freed.
+*/
+//==============================================================================
+cArena::~cArena()
+{
+    std::map<size_t, cArenaPool*>::iterator it;
+    for (it = m_pools.begin(); it != m_pools.end(); ++it)
+    {
+        cArenaPool* pool = it->second;
+        for (unsigned int i=0; i<pool->m_blocks.size(); i++)
+        {
+            ::operator delete(pool->m_blocks[i]);
+        }
+        delete pool;
+    }
+}
+
+
+//==============================================================================
+/*!
+    This method releases the arena. If all its objects are deleted, its
+    memory is freed immediately, otherwise it is freed when the last object
+    is deleted. The arena must not be used by its owner afterwards.
+*/
+//==============================================================================
+void cArena::release()
+{
+    m_released = true;
+
+    if (m_numReferences.fetch_sub(1) == 1)
+    {
+        delete this;
+    }
+}
+
+
+//==============================================================================
+/*!
+    This method returns the number of objects allocated from the arena that
+    are not deleted yet.
+
+    \return Number of objects.
+*/
+//==============================================================================
+unsigned int cArena::getNumObjects()
+{
+    unsigned int numReferences = m_numReferences;
+    return (m_released ? numReferences : numReferences - 1);
+}
+
+
+//==============================================================================
+/*!
+    This method returns the number of bytes of the memory blocks allocated
+    by the arena.
+
+    \return Number of bytes.
+*/
+//==============================================================================
+size_t cArena::getMemoryUsage()
+{
+    m_mutex.acquire();
+    size_t numBytes = m_numBytes;
+    m_mutex.release();
+
+    return (numBytes);
+}
+
+
+//==============================================================================
+/*!
+    This method allocates memory for an object in an arena, or on the heap
+    if the arena is NULL. A header in front of the object stores the pool
+    of the object, or NULL if it is on the heap.
+
+    \param  a_arena  Arena, or NULL.
+    \param  a_size   Size of the object.
+
+    \return Pointer to the memory of the object.
+*/
+//==============================================================================
+void* cArena::allocate(cArena* a_arena, const size_t a_size)
+{
+    size_t size = C_ARENA_HEADER_SIZE + a_size;
+    cArenaPool* pool = NULL;
+    char* slot;
+
+    if (a_arena == NULL)
+    {
+        slot = static_cast<char*>(::operator new(size));
+    }
+    else
+    {
+        slot = a_arena->allocateSlot(size, pool);
+    }
+
+    *reinterpret_cast<cArenaPool**>(slot) = pool;
+    return (slot + C_ARENA_HEADER_SIZE);
+}
+
+
+//==============================================================================
+/*!
+    This method releases the memory of an object allocated by
+    \ref allocate(), on the heap or in its arena.
+
+    \param  a_object  Pointer to the memory of the object.
+*/
+//==============================================================================
+void cArena::deallocate(void* a_object)
+{
+    if (a_object == NULL)
+    {
+        return;
+    }
+
+    char* slot = static_cast<char*>(a_object) - C_ARENA_HEADER_SIZE;
+    cArenaPool* pool = *reinterpret_cast<cArenaPool**>(slot);
+
+    if (pool == NULL)
+    {
+        ::operator delete(slot);
+    }
+    else
+    {
+        pool->m_arena->deallocateSlot(pool, slot);
+    }
+}
+
+
+//==============================================================================
+/*!
+    This method returns a slot of the pool of a given size. Slots of deleted
+    objects are reused first, otherwise the next slot of the last block is
+    used, and a new block is allocated when it is full.
+
+    \param  a_size  Size of the slot, header included.
+    \param  a_pool  Returns the pool of the slot.
+
+    \return Pointer to the slot.
+*/
+//==============================================================================
+char* cArena::allocateSlot(const size_t a_size, cArenaPool*& a_pool)
+{
+    // slots are aligned like the header
+    size_t slotSize = (a_size + C_ARENA_HEADER_SIZE - 1) / C_ARENA_HEADER_SIZE * C_ARENA_HEADER_SIZE;
+
+    m_mutex.acquire();
+
+    // find or create pool
+    cArenaPool* pool;
+    std::map<size_t, cArenaPool*>::iterator it = m_pools.find(slotSize);
+    if (it != m_pools.end())
+    {
+        pool = it->second;
+    }
+    else
+    {
+        pool = new cArenaPool();
+        pool->m_arena = this;
+        pool->m_slotSize = slotSize;
+        pool->m_next = NULL;
+        pool->m_end = NULL;
+        pool->m_freeSlots = NULL;
+        m_pools[slotSize] = pool;
+    }
+
+    char* slot;
+    if (pool->m_freeSlots != NULL)
+    {
+        // reuse slot of a deleted object
+        slot = static_cast<char*>(pool->m_freeSlots);
+        pool->m_freeSlots = *reinterpret_cast<void**>(slot);
+    }
+    else
+    {
+        // allocate new block
+        if (pool->m_next == pool->m_end)
+        {
+            size_t numSlots = C_ARENA_BLOCK_SIZE / slotSize;
+            if (numSlots < 16)
+            {
+                numSlots = 16;
+            }
+            size_t blockSize = numSlots * slotSize;
+            char* block = static_cast<char*>(::operator new(blockSize, std::nothrow));
+            if (block == NULL)
+            {
+                m_mutex.release();
+                throw std::bad_alloc();
+            }
+            pool->m_blocks.push_back(block);
+            pool->m_next = block;
+            pool->m_end = block + blockSize;
+            m_numBytes += blockSize;
+        }
+
+        slot = pool->m_next;
+        pool->m_next += slotSize;
+    }
+    m_numReferences++;
+
+    m_mutex.release();
+
+    a_pool = pool;
+    return (slot);
+}
+
+
+//==============================================================================
+/*!
+    This method returns a slot to its pool. Once the arena is released, the
+    slot is left as it is, since it is freed with its block. If the arena is
+    released and this was its last object, the arena is destroyed.
+
+    \param  a_pool  Pool of the slot.
+    \param  a_slot  Slot.
+*/
+//==============================================================================
+void cArena::deallocateSlot(cArenaPool* a_pool, char* a_slot)
+{
+    if (!m_released)
+    {
+        m_mutex.acquire();
+        *reinterpret_cast<void**>(a_slot) = a_pool->m_freeSlots;
+        a_pool->m_freeSlots = a_slot;
+        m_mutex.release();
+    }
+
+    if (m_numReferences.fetch_sub(1) == 1)
+    {
+        delete this;
+    }
+}
+
+
+//------------------------------------------------------------------------------
+} // namespace chai3d
+//------------------------------------------------------------------------------
@@ -0,0 +1,200 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2003-2016, CHAI3D.
+    (www.chai3d.org)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of CHAI3D nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE. 
+
+    \author    <http://www.chai3d.org>
+    \version   3.2.0 $Rev: 1869 $
+*/
+//==============================================================================
+
+//------------------------------------------------------------------------------
+#include "system/CMappedFile.h"
+//------------------------------------------------------------------------------
+#if defined(LINUX) || defined(MACOSX)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+namespace chai3d {
+//------------------------------------------------------------------------------
+
+//==============================================================================
+/*!
+    Constructor of cMappedFile.
+*/
+//==============================================================================
+cMappedFile::cMappedFile()
+{
+    m_data = nullptr;
+    m_size = 0;
+
+#if defined(WIN32) | defined(WIN64)
+    m_file = INVALID_HANDLE_VALUE;
+    m_mapping = NULL;
+#endif
+}
+
+
+//==============================================================================
+/*!
+    Destructor of cMappedFile.
+*/
+//==============================================================================
+cMappedFile::~cMappedFile()
+{
+    close();
+}
+
+
+//==============================================================================
+/*!
+    This method maps a file in memory. Any previously mapped file is unmapped.
+    Empty files cannot be mapped.
+
+    \param  a_filename  Filename.
+
+    \return __true__ if the file has been mapped, __false__ otherwise.
+*/
+//==============================================================================
+bool cMappedFile::open(const std::string& a_filename)
+{
+    close();
+
+#if defined(WIN32) | defined(WIN64)
+    m_file = CreateFileA(a_filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                         OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (m_file == INVALID_HANDLE_VALUE)
+    {
+        return (C_ERROR);
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(m_file, &size) || (size.QuadPart == 0))
+    {
+        close();
+        return (C_ERROR);
+    }
+
+    m_mapping = CreateFileMappingA(m_file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+    if (m_mapping == NULL)
+    {
+        close();
+        return (C_ERROR);
+    }
+
+    m_data = (unsigned char*)MapViewOfFile(m_mapping, FILE_MAP_COPY, 0, 0, 0);
+    if (m_data == nullptr)
+    {
+        close();
+        return (C_ERROR);
+    }
+    m_size = (size_t)size.QuadPart;
+#endif
+
+#if defined(LINUX) || defined(MACOSX)
+    int fd = ::open(a_filename.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return (C_ERROR);
+    }
+
+    struct stat info;
+    if ((fstat(fd, &info) != 0) || (info.st_size == 0))
+    {
+        ::close(fd);
+        return (C_ERROR);
+    }
+
+    void* data = mmap(NULL, (size_t)info.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+
+    // the mapping stays valid after closing the descriptor
+    ::close(fd);
+
+    if (data == MAP_FAILED)
+    {
+        return (C_ERROR);
+    }
+    m_data = (unsigned char*)data;
+    m_size = (size_t)info.st_size;
+#endif
+
+    return (C_SUCCESS);
+}
+
+
+//==============================================================================
+/*!
+    This method unmaps the file. Pointers returned by getData() become invalid.
+*/
+//==============================================================================
+void cMappedFile::close()
+{
+#if defined(WIN32) | defined(WIN64)
+    if (m_data != nullptr)
+    {
+        UnmapViewOfFile(m_data);
+    }
+    if (m_mapping != NULL)
+    {
+        CloseHandle(m_mapping);
+        m_mapping = NULL;
+    }
+    if (m_file != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(m_file);
+        m_file = INVALID_HANDLE_VALUE;
+    }
+#endif
+
+#if defined(LINUX) || defined(MACOSX)
+    if (m_data != nullptr)
+    {
+        munmap(m_data, m_size);
+    }
+#endif
+
+    m_data = nullptr;
+    m_size = 0;
+}
+
+
+//------------------------------------------------------------------------------
+} // namespace chai3d
+//------------------------------------------------------------------------------
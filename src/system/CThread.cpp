@@ -45,6 +45,12 @@
 //------------------------------------------------------------------------------
 #include "system/CThread.h"
 //------------------------------------------------------------------------------
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+//------------------------------------------------------------------------------
 
 //------------------------------------------------------------------------------
 namespace chai3d {
@@ -241,6 +247,173 @@ void cThread::setPriority(CThreadPriority a_level)
 }
 
 
+//==============================================================================
+/*!
+    This function returns the number of threads that the hardware can run
+    concurrently. If this number cannot be determined, 1 is returned.
+
+    \return Number of hardware threads.
+*/
+//==============================================================================
+unsigned int cGetNumHardwareThreads()
+{
+    unsigned int num = std::thread::hardware_concurrency();
+    return ((num > 0) ? num : 1);
+}
+
+
+//------------------------------------------------------------------------------
+// Tasks of a call to cParallelFor(), which lives on the stack of the caller.
+// Its counters are guarded by the mutex of the pool.
+struct cParallelJob
+{
+    const std::function<void(unsigned int)>* m_task;
+    unsigned int m_numTasks;
+    unsigned int m_next;
+    unsigned int m_done;
+};
+//------------------------------------------------------------------------------
+
+
+//==============================================================================
+/*!
+    Worker threads of cParallelFor(), started at its first call and kept
+    until the program exits. Workers and callers take the tasks of the
+    pending jobs one at a time.
+*/
+//==============================================================================
+class cParallelPool
+{
+public:
+
+    cParallelPool() : m_stop(false)
+    {
+        unsigned int numWorkers = cGetNumHardwareThreads() - 1;
+        for (unsigned int i=0; i<numWorkers; i++)
+        {
+            m_workers.push_back(std::thread(&cParallelPool::work, this));
+        }
+    }
+
+    ~cParallelPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        for (size_t i=0; i<m_workers.size(); i++)
+        {
+            m_workers[i].join();
+        }
+    }
+
+    //! This method runs the tasks of a job, on the calling thread and on the idle workers.
+    void run(cParallelJob& a_job)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_jobs.push_back(&a_job);
+        m_wake.notify_all();
+
+        // the caller runs tasks too, so that nested calls from a task finish
+        unsigned int index;
+        while (take(a_job, index))
+        {
+            runTask(lock, a_job, index);
+        }
+        while (a_job.m_done < a_job.m_numTasks)
+        {
+            m_finished.wait(lock);
+        }
+    }
+
+private:
+
+    //! This method takes the next task of a job, and removes the job from the queue with its last task.
+    bool take(cParallelJob& a_job, unsigned int& a_index)
+    {
+        if (a_job.m_next >= a_job.m_numTasks) { return (false); }
+        a_index = a_job.m_next++;
+        if (a_job.m_next == a_job.m_numTasks)
+        {
+            for (std::deque<cParallelJob*>::iterator it = m_jobs.begin(); it != m_jobs.end(); ++it)
+            {
+                if (*it == &a_job) { m_jobs.erase(it); break; }
+            }
+        }
+        return (true);
+    }
+
+    //! This method runs a task without the lock, and counts it as done.
+    void runTask(std::unique_lock<std::mutex>& a_lock, cParallelJob& a_job, unsigned int a_index)
+    {
+        a_lock.unlock();
+        (*a_job.m_task)(a_index);
+        a_lock.lock();
+        a_job.m_done++;
+        if (a_job.m_done == a_job.m_numTasks)
+        {
+            m_finished.notify_all();
+        }
+    }
+
+    //! This method is the loop of the workers.
+    void work()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true)
+        {
+            while (!m_stop && m_jobs.empty())
+            {
+                m_wake.wait(lock);
+            }
+            if (m_stop) { return; }
+
+            cParallelJob& job = *m_jobs.front();
+            unsigned int index;
+            if (take(job, index))
+            {
+                runTask(lock, job, index);
+            }
+        }
+    }
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_finished;
+    std::deque<cParallelJob*> m_jobs;
+    std::vector<std::thread> m_workers;
+    bool m_stop;
+};
+
+
+//==============================================================================
+/*!
+    This function runs __a_task__ __a_numTasks__ times, passing the task index
+    (0 to __a_numTasks__-1) to each call, and returns when all tasks are done.
+    The tasks run on the calling thread and on a pool of worker threads that
+    is started at the first call and kept afterwards, so a call does not
+    create threads. Tasks may call this function themselves.
+
+    \param  a_numTasks  Number of tasks.
+    \param  a_task      Task to execute.
+*/
+//==============================================================================
+void cParallelFor(const unsigned int a_numTasks, const std::function<void(unsigned int)>& a_task)
+{
+    if (a_numTasks == 0) { return; }
+    if (a_numTasks == 1)
+    {
+        a_task(0);
+        return;
+    }
+
+    static cParallelPool pool;
+    cParallelJob job = { &a_task, a_numTasks, 0, 0 };
+    pool.run(job);
+}
+
+
 //------------------------------------------------------------------------------
 } // namespace chai3d
 //------------------------------------------------------------------------------
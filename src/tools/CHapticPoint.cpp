@@ -419,6 +419,7 @@ cVector3d cHapticPoint::computeInteractionForces(cVector3d& a_globalPos,
   for (int i=0; i<3; i++) {
     if (m_meshProxyContacts[i] != NULL) {
       m_meshProxyContacts[i]->m_interactionInside = false;
+      m_meshProxyContacts[i]->setInteractionContact(false);
 
       cMultiMesh* multiMesh = dynamic_cast<cMultiMesh*>(m_meshProxyContacts[i]->getOwner());
       if (multiMesh != NULL) {
@@ -445,6 +446,7 @@ cVector3d cHapticPoint::computeInteractionForces(cVector3d& a_globalPos,
       // Viscosity of cMesh
 
       object->m_interactionInside = true;
+      object->setInteractionContact(true);
       object->m_interactionPoint = m_algorithmFingerProxy->m_collisionEvents[i]->m_localPos;
       object->m_interactionNormal = m_algorithmFingerProxy->m_collisionEvents[i]->m_localNormal;
 
@@ -0,0 +1,1216 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2003-2016, CHAI3D.
+    (www.chai3d.org)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of CHAI3D nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE. 
+
+    \author    <http://www.chai3d.org>
+    \version   3.2.0 $Rev: 1869 $
+*/
+//==============================================================================
+
+//------------------------------------------------------------------------------
+#include "world/CConvexHull.h"
+#include "math/CMaths.h"
+#include "system/CThread.h"
+//------------------------------------------------------------------------------
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <utility>
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+namespace chai3d {
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+// hull construction
+//------------------------------------------------------------------------------
+
+// tolerance of the hull, relative to the largest side of its bounding box
+static const double C_HULL_TOLERANCE = 1e-6;
+
+// point clouds are split between threads above this number of points per thread
+static const size_t C_HULL_POINTS_PER_THREAD = 4096;
+
+// iterations of GJK, EPA and the ray cast before they give up
+static const int C_HULL_MAX_ITERATIONS = 64;
+
+// face of a hull under construction, with the points in front of it
+struct cHullFace
+{
+    unsigned int m_vertex[3];
+    cVector3d m_normal;
+    double m_offset;
+    std::vector<unsigned int> m_outside;
+    bool m_alive;
+};
+
+// key of the directed edge from a_vertex0 to a_vertex1
+static inline unsigned long long cHullEdge(const unsigned int a_vertex0, const unsigned int a_vertex1)
+{
+    return (((unsigned long long)a_vertex0 << 32) | a_vertex1);
+}
+
+// hull of a subset of points computed by quickhull, as triangles indexing
+// the points, counterclockwise seen from outside. Returns false if the
+// points are flat.
+static bool cQuickhull(const std::vector<cVector3d>& a_points,
+                       const std::vector<unsigned int>& a_subset,
+                       const double a_tolerance,
+                       std::vector<unsigned int>& a_triangles)
+{
+    a_triangles.clear();
+    if (a_subset.size() < 4)
+    {
+        return (false);
+    }
+
+    const std::vector<cVector3d>& p = a_points;
+
+    // extreme points along the axes
+    unsigned int extremes[6];
+    std::fill(extremes, extremes + 6, a_subset[0]);
+    for (unsigned int i : a_subset)
+    {
+        for (int axis=0; axis<3; axis++)
+        {
+            if (p[i](axis) < p[extremes[2*axis]](axis)) { extremes[2*axis] = i; }
+            if (p[i](axis) > p[extremes[2*axis+1]](axis)) { extremes[2*axis+1] = i; }
+        }
+    }
+
+    // initial tetrahedron: the furthest extreme points, the point furthest
+    // from their line and the point furthest from the plane of the three
+    unsigned int v0 = extremes[0];
+    unsigned int v1 = extremes[1];
+    for (int axis=1; axis<3; axis++)
+    {
+        if (cDistanceSq(p[extremes[2*axis]], p[extremes[2*axis+1]]) > cDistanceSq(p[v0], p[v1]))
+        {
+            v0 = extremes[2*axis];
+            v1 = extremes[2*axis+1];
+        }
+    }
+    if (cDistance(p[v0], p[v1]) <= a_tolerance)
+    {
+        return (false);
+    }
+
+    cVector3d axis = cNormalize(p[v1] - p[v0]);
+    unsigned int v2 = v0;
+    double furthest = 0.0;
+    for (unsigned int i : a_subset)
+    {
+        double distance = cCross(p[i] - p[v0], axis).length();
+        if (distance > furthest) { furthest = distance; v2 = i; }
+    }
+    if (furthest <= a_tolerance)
+    {
+        return (false);
+    }
+
+    cVector3d normal = cNormalize(cCross(p[v1] - p[v0], p[v2] - p[v0]));
+    unsigned int v3 = v0;
+    furthest = 0.0;
+    for (unsigned int i : a_subset)
+    {
+        double distance = fabs(normal.dot(p[i] - p[v0]));
+        if (distance > furthest) { furthest = distance; v3 = i; }
+    }
+    if (furthest <= a_tolerance)
+    {
+        return (false);
+    }
+
+    std::vector<cHullFace> faces;
+    std::unordered_map<unsigned long long, unsigned int> edges;
+    auto addFace = [&](unsigned int a_a, unsigned int a_b, unsigned int a_c)
+    {
+        cHullFace face;
+        face.m_vertex[0] = a_a;
+        face.m_vertex[1] = a_b;
+        face.m_vertex[2] = a_c;
+        face.m_normal = cCross(p[a_b] - p[a_a], p[a_c] - p[a_a]);
+        double length = face.m_normal.length();
+        if (length > 0.0) { face.m_normal.mul(1.0 / length); }
+        face.m_offset = face.m_normal.dot(p[a_a]);
+        face.m_alive = true;
+        unsigned int index = (unsigned int)faces.size();
+        faces.push_back(face);
+        edges[cHullEdge(a_a, a_b)] = index;
+        edges[cHullEdge(a_b, a_c)] = index;
+        edges[cHullEdge(a_c, a_a)] = index;
+    };
+    auto height = [&](const cHullFace& a_face, unsigned int a_point)
+    {
+        return (a_face.m_normal.dot(p[a_point]) - a_face.m_offset);
+    };
+    // gives a point to the face it is furthest in front of, if any
+    auto assign = [&](unsigned int a_point, size_t a_firstFace)
+    {
+        size_t best = faces.size();
+        double bestHeight = a_tolerance;
+        for (size_t f=a_firstFace; f<faces.size(); f++)
+        {
+            double h = height(faces[f], a_point);
+            if (h > bestHeight) { bestHeight = h; best = f; }
+        }
+        if (best < faces.size())
+        {
+            faces[best].m_outside.push_back(a_point);
+        }
+    };
+
+    // v3 lies behind the first face
+    if (normal.dot(p[v3] - p[v0]) > 0.0)
+    {
+        std::swap(v1, v2);
+    }
+    addFace(v0, v1, v2);
+    addFace(v0, v3, v1);
+    addFace(v1, v3, v2);
+    addFace(v2, v3, v0);
+    for (unsigned int i : a_subset)
+    {
+        if ((i != v0) && (i != v1) && (i != v2) && (i != v3))
+        {
+            assign(i, 0);
+        }
+    }
+
+    // add the furthest point in front of a face until no face has points in front
+    std::vector<unsigned int> visited;
+    std::vector<char> visible;
+    std::vector<unsigned int> stack;
+    std::vector<unsigned int> removed;
+    std::vector<std::pair<unsigned int, unsigned int> > horizon;
+    std::vector<unsigned int> orphans;
+    unsigned int stamp = 0;
+    for (size_t f=0; f<faces.size(); f++)
+    {
+        if (!faces[f].m_alive || faces[f].m_outside.empty())
+        {
+            continue;
+        }
+
+        unsigned int eye = faces[f].m_outside[0];
+        for (unsigned int i : faces[f].m_outside)
+        {
+            if (height(faces[f], i) > height(faces[f], eye)) { eye = i; }
+        }
+
+        // faces seen from the eye, connected to this one, and their boundary
+        stamp++;
+        visited.resize(faces.size(), 0);
+        visible.resize(faces.size(), 0);
+        removed.clear();
+        horizon.clear();
+        stack.assign(1, (unsigned int)f);
+        visited[f] = stamp;
+        visible[f] = 1;
+        while (!stack.empty())
+        {
+            unsigned int g = stack.back();
+            stack.pop_back();
+            removed.push_back(g);
+            for (int e=0; e<3; e++)
+            {
+                unsigned int a = faces[g].m_vertex[e];
+                unsigned int b = faces[g].m_vertex[(e+1)%3];
+                auto twin = edges.find(cHullEdge(b, a));
+                if (twin == edges.end())
+                {
+                    continue;
+                }
+                unsigned int h = twin->second;
+                if (visited[h] != stamp)
+                {
+                    visited[h] = stamp;
+                    // any face the eye is in front of, however little,
+                    // or the cone would leave a fold
+                    visible[h] = (height(faces[h], eye) > 0.0) ? 1 : 0;
+                    if (visible[h]) { stack.push_back(h); }
+                }
+                if (!visible[h])
+                {
+                    horizon.push_back(std::make_pair(a, b));
+                }
+            }
+        }
+
+        // replace the visible faces by a cone from the boundary to the eye
+        orphans.clear();
+        for (unsigned int g : removed)
+        {
+            faces[g].m_alive = false;
+            for (int e=0; e<3; e++)
+            {
+                edges.erase(cHullEdge(faces[g].m_vertex[e], faces[g].m_vertex[(e+1)%3]));
+            }
+            orphans.insert(orphans.end(), faces[g].m_outside.begin(), faces[g].m_outside.end());
+            std::vector<unsigned int>().swap(faces[g].m_outside);
+        }
+        size_t firstNewFace = faces.size();
+        for (auto& edge : horizon)
+        {
+            addFace(edge.first, edge.second, eye);
+        }
+        for (unsigned int i : orphans)
+        {
+            if (i != eye)
+            {
+                assign(i, firstNewFace);
+            }
+        }
+    }
+
+    for (auto& face : faces)
+    {
+        if (face.m_alive)
+        {
+            a_triangles.insert(a_triangles.end(), face.m_vertex, face.m_vertex + 3);
+        }
+    }
+    return (true);
+}
+
+
+//------------------------------------------------------------------------------
+// simplices
+//------------------------------------------------------------------------------
+
+// nearest point to the origin on a segment, and the mask of the points of
+// the feature it lies on
+static cVector3d cNearestOnSegment(const cVector3d* a_w, const int a_i0, const int a_i1, int& a_mask)
+{
+    cVector3d ab = a_w[a_i1] - a_w[a_i0];
+    double lengthSq = ab.lengthsq();
+    double t = (lengthSq > 0.0) ? -a_w[a_i0].dot(ab) / lengthSq : 0.0;
+    if (t <= 0.0)
+    {
+        a_mask = 1 << a_i0;
+        return (a_w[a_i0]);
+    }
+    if (t >= 1.0)
+    {
+        a_mask = 1 << a_i1;
+        return (a_w[a_i1]);
+    }
+    a_mask = (1 << a_i0) | (1 << a_i1);
+    return (a_w[a_i0] + t * ab);
+}
+
+// nearest point to the origin on a triangle, and the mask of the points of
+// the feature it lies on (see Ericson, Real-Time Collision Detection, 5.1.5)
+static cVector3d cNearestOnTriangle(const cVector3d* a_w, const int a_i0, const int a_i1, const int a_i2, int& a_mask)
+{
+    const cVector3d& a = a_w[a_i0];
+    const cVector3d& b = a_w[a_i1];
+    const cVector3d& c = a_w[a_i2];
+    cVector3d ab = b - a;
+    cVector3d ac = c - a;
+    double d1 = -ab.dot(a);
+    double d2 = -ac.dot(a);
+    if ((d1 <= 0.0) && (d2 <= 0.0)) { a_mask = 1 << a_i0; return (a); }
+
+    double d3 = -ab.dot(b);
+    double d4 = -ac.dot(b);
+    if ((d3 >= 0.0) && (d4 <= d3)) { a_mask = 1 << a_i1; return (b); }
+
+    double vc = d1 * d4 - d3 * d2;
+    if ((vc <= 0.0) && (d1 >= 0.0) && (d3 <= 0.0))
+    {
+        a_mask = (1 << a_i0) | (1 << a_i1);
+        return (a + (d1 / (d1 - d3)) * ab);
+    }
+
+    double d5 = -ab.dot(c);
+    double d6 = -ac.dot(c);
+    if ((d6 >= 0.0) && (d5 <= d6)) { a_mask = 1 << a_i2; return (c); }
+
+    double vb = d5 * d2 - d1 * d6;
+    if ((vb <= 0.0) && (d2 >= 0.0) && (d6 <= 0.0))
+    {
+        a_mask = (1 << a_i0) | (1 << a_i2);
+        return (a + (d2 / (d2 - d6)) * ac);
+    }
+
+    double va = d3 * d6 - d5 * d4;
+    if ((va <= 0.0) && ((d4 - d3) >= 0.0) && ((d5 - d6) >= 0.0))
+    {
+        a_mask = (1 << a_i1) | (1 << a_i2);
+        return (b + ((d4 - d3) / ((d4 - d3) + (d5 - d6))) * (c - b));
+    }
+
+    double sum = va + vb + vc;
+    if (!(sum > 0.0))
+    {
+        // degenerate triangle
+        return (cNearestOnSegment(a_w, a_i0, a_i1, a_mask));
+    }
+    a_mask = (1 << a_i0) | (1 << a_i1) | (1 << a_i2);
+    return (a + (vb / sum) * ab + (vc / sum) * ac);
+}
+
+// nearest point to the origin on a simplex of 1 to 4 points, and the mask of
+// the points of the smallest feature it lies on. The mask has all 4 points
+// if the origin is inside of a tetrahedron.
+static cVector3d cNearestOnSimplex(const cVector3d* a_w, const int a_size, int& a_mask)
+{
+    switch (a_size)
+    {
+        case 1:
+            a_mask = 1;
+            return (a_w[0]);
+
+        case 2:
+            return (cNearestOnSegment(a_w, 0, 1, a_mask));
+
+        case 3:
+            return (cNearestOnTriangle(a_w, 0, 1, 2, a_mask));
+
+        default:
+        {
+            // faces of the tetrahedron and their opposite point
+            static const int faces[4][4] = { {0, 1, 2, 3}, {0, 3, 1, 2}, {0, 2, 3, 1}, {1, 3, 2, 0} };
+            cVector3d nearest(0.0, 0.0, 0.0);
+            double nearestSq = C_LARGE;
+            bool inside = true;
+            for (int f=0; f<4; f++)
+            {
+                const cVector3d& a = a_w[faces[f][0]];
+                cVector3d n = cCross(a_w[faces[f][1]] - a, a_w[faces[f][2]] - a);
+                double origin = -n.dot(a);
+                double opposite = n.dot(a_w[faces[f][3]] - a);
+
+                // the origin is on the other side of the face than the opposite point
+                if ((origin * opposite < 0.0) || (opposite == 0.0))
+                {
+                    inside = false;
+                    int mask;
+                    cVector3d point = cNearestOnTriangle(a_w, faces[f][0], faces[f][1], faces[f][2], mask);
+                    if (point.lengthsq() < nearestSq)
+                    {
+                        nearestSq = point.lengthsq();
+                        nearest = point;
+                        a_mask = mask;
+                    }
+                }
+            }
+            if (inside)
+            {
+                a_mask = 15;
+                return (cVector3d(0.0, 0.0, 0.0));
+            }
+            return (nearest);
+        }
+    }
+}
+
+// keeps the points of a simplex selected by a mask, in order
+template <typename T> static int cReduceSimplex(T* a_points, const int a_size, const int a_mask)
+{
+    int size = 0;
+    for (int i=0; i<a_size; i++)
+    {
+        if (a_mask & (1 << i))
+        {
+            a_points[size++] = a_points[i];
+        }
+    }
+    return (size);
+}
+
+
+//==============================================================================
+/*!
+    Constructor of cConvexHull.
+*/
+//==============================================================================
+cConvexHull::cConvexHull()
+{
+    m_boundaryMin.zero();
+    m_boundaryMax.zero();
+    m_tolerance = 0.0;
+}
+
+
+//==============================================================================
+/*!
+    This method computes the convex hull of a point cloud. Points closer than
+    a millionth of the size of the cloud to the hull are not kept as
+    vertices. \n\n
+
+    Large clouds are split in as many parts as there are hardware threads:
+    the hulls of the parts are computed in parallel, then the hull of their
+    vertices.
+
+    \param  a_points  Points.
+
+    \return __true__ if the operation succeeds, __false__ if the points are
+            fewer than four or flat.
+*/
+//==============================================================================
+bool cConvexHull::createFromPoints(const std::vector<cVector3d>& a_points)
+{
+    m_vertices.clear();
+    m_triangles.clear();
+    updateGeometry();
+
+    if (a_points.size() < 4)
+    {
+        return (C_ERROR);
+    }
+
+    // tolerance from the size of the cloud
+    cVector3d boundaryMin = a_points[0];
+    cVector3d boundaryMax = a_points[0];
+    for (auto& point : a_points)
+    {
+        for (int axis=0; axis<3; axis++)
+        {
+            boundaryMin(axis) = cMin(boundaryMin(axis), point(axis));
+            boundaryMax(axis) = cMax(boundaryMax(axis), point(axis));
+        }
+    }
+    cVector3d size = boundaryMax - boundaryMin;
+    double tolerance = C_HULL_TOLERANCE * cMax(size(0), cMax(size(1), size(2)));
+
+    // hulls of the parts, in parallel
+    const size_t numPoints = a_points.size();
+    const unsigned int numParts = (unsigned int)cMin((size_t)cGetNumHardwareThreads(),
+                                                     numPoints / C_HULL_POINTS_PER_THREAD);
+    std::vector<unsigned int> candidates;
+    if (numParts > 1)
+    {
+        std::vector<std::vector<unsigned int> > parts(numParts);
+        cParallelFor(numParts, [&](unsigned int a_part)
+        {
+            std::vector<unsigned int> subset;
+            for (size_t i=a_part*numPoints/numParts; i<(a_part+1)*numPoints/numParts; i++)
+            {
+                subset.push_back((unsigned int)i);
+            }
+            // flat parts keep all their points
+            if (!cQuickhull(a_points, subset, tolerance, parts[a_part]))
+            {
+                parts[a_part].swap(subset);
+            }
+        });
+
+        std::vector<char> used(numPoints, 0);
+        for (auto& part : parts)
+        {
+            for (unsigned int i : part) { used[i] = 1; }
+        }
+        for (size_t i=0; i<numPoints; i++)
+        {
+            if (used[i]) { candidates.push_back((unsigned int)i); }
+        }
+    }
+    else
+    {
+        candidates.resize(numPoints);
+        for (size_t i=0; i<numPoints; i++) { candidates[i] = (unsigned int)i; }
+    }
+
+    // hull of the remaining points
+    std::vector<unsigned int> triangles;
+    if (!cQuickhull(a_points, candidates, tolerance, triangles))
+    {
+        return (C_ERROR);
+    }
+
+    // keep the points used by the triangles
+    std::vector<int> index(numPoints, -1);
+    m_triangles.reserve(triangles.size());
+    for (unsigned int i : triangles)
+    {
+        if (index[i] < 0)
+        {
+            index[i] = (int)m_vertices.size();
+            m_vertices.push_back(a_points[i]);
+        }
+        m_triangles.push_back((unsigned int)index[i]);
+    }
+    updateGeometry();
+
+    return (C_SUCCESS);
+}
+
+
+//==============================================================================
+/*!
+    This method computes the convex hull of the vertices of triangles.
+
+    \param  a_triangles  Triangles.
+
+    \return __true__ if the operation succeeds, __false__ if the vertices are
+            fewer than four or flat.
+*/
+//==============================================================================
+bool cConvexHull::createFromTriangles(const cTriangleArrayPtr a_triangles)
+{
+    std::vector<cVector3d> points;
+    if (a_triangles != nullptr)
+    {
+        std::vector<char> used(a_triangles->m_vertices->getNumElements(), 0);
+        int numTriangles = (int)(a_triangles->getNumElements());
+        for (int i=0; i<numTriangles; i++)
+        {
+            if (a_triangles->getAllocated(i))
+            {
+                unsigned int vertices[3] = { a_triangles->getVertexIndex0(i),
+                                             a_triangles->getVertexIndex1(i),
+                                             a_triangles->getVertexIndex2(i) };
+                for (unsigned int vertex : vertices)
+                {
+                    if (!used[vertex])
+                    {
+                        used[vertex] = 1;
+                        points.push_back(a_triangles->m_vertices->getLocalPos(vertex));
+                    }
+                }
+            }
+        }
+    }
+
+    return (createFromPoints(points));
+}
+
+
+//==============================================================================
+/*!
+    This method tells whether triangles form a convex mesh, the surface of
+    this hull: every triangle must lie in a plane that leaves the hull on one
+    side, and the triangles must cover the surface of the hull, within 1%.
+    The orientation of the triangles is not checked. \n\n
+
+    Each triangle costs a support query, which makes the test fast enough to
+    run on every mesh.
+
+    \param  a_triangles  Triangles, usually the ones this hull was created from.
+    \param  a_tolerance  Largest distance of the hull in front of the plane of a triangle.
+
+    \return __true__ if the triangles form the surface of this hull.
+*/
+//==============================================================================
+bool cConvexHull::isHullOf(const cTriangleArrayPtr a_triangles, const double a_tolerance) const
+{
+    if (isEmpty() || (a_triangles == nullptr))
+    {
+        return (false);
+    }
+
+    cConvexHullCache cache;
+    double area = 0.0;
+    int numTriangles = (int)(a_triangles->getNumElements());
+    for (int i=0; i<numTriangles; i++)
+    {
+        if (!a_triangles->getAllocated(i))
+        {
+            continue;
+        }
+
+        cVector3d vertex0 = a_triangles->m_vertices->getLocalPos(a_triangles->getVertexIndex0(i));
+        cVector3d vertex1 = a_triangles->m_vertices->getLocalPos(a_triangles->getVertexIndex1(i));
+        cVector3d vertex2 = a_triangles->m_vertices->getLocalPos(a_triangles->getVertexIndex2(i));
+        cVector3d normal = cCross(vertex1 - vertex0, vertex2 - vertex0);
+        double length = normal.length();
+        area += 0.5 * length;
+
+        // the plane of a sliver is noise: its vertices are tested by the
+        // triangles around it
+        double edge = cMax(cDistance(vertex0, vertex1),
+                           cMax(cDistance(vertex1, vertex2), cDistance(vertex2, vertex0)));
+        if (!(length > a_tolerance * edge))
+        {
+            continue;
+        }
+        normal.mul(1.0 / length);
+
+        // the hull is behind the plane of the triangle, on either side
+        bool supporting = false;
+        for (int side=0; (side<2) && !supporting; side++)
+        {
+            cVector3d direction = (side == 0) ? normal : -normal;
+            int support = getSupportVertex(direction, cache);
+            supporting = (direction.dot(m_vertices[support] - vertex0) <= a_tolerance);
+        }
+        if (!supporting)
+        {
+            return (false);
+        }
+    }
+
+    double hullArea = 0.0;
+    for (size_t i=0; i<m_faceNormals.size(); i++)
+    {
+        const cVector3d& vertex0 = m_vertices[m_triangles[3*i]];
+        hullArea += 0.5 * cCross(m_vertices[m_triangles[3*i+1]] - vertex0,
+                                 m_vertices[m_triangles[3*i+2]] - vertex0).length();
+    }
+
+    return (fabs(area - hullArea) <= 0.01 * hullArea);
+}
+
+
+//==============================================================================
+/*!
+    This method scales the hull about the origin of its frame, with a factor
+    along each axis.
+
+    \param  a_scaleFactors  Scale factors along X, Y and Z, all positive.
+*/
+//==============================================================================
+void cConvexHull::scale(const cVector3d& a_scaleFactors)
+{
+    if (!(a_scaleFactors(0) > 0.0) || !(a_scaleFactors(1) > 0.0) || !(a_scaleFactors(2) > 0.0))
+    {
+        return;
+    }
+
+    for (auto& vertex : m_vertices)
+    {
+        vertex.mulElement(a_scaleFactors);
+    }
+    updateGeometry();
+}
+
+
+//==============================================================================
+/*!
+    This method computes the planes of the triangles, the edges between
+    vertices, the bounding box and the tolerance of the hull.
+*/
+//==============================================================================
+void cConvexHull::updateGeometry()
+{
+    const size_t numVertices = m_vertices.size();
+    const size_t numTriangles = m_triangles.size() / 3;
+
+    // planes
+    m_faceNormals.resize(numTriangles);
+    m_faceOffsets.resize(numTriangles);
+    for (size_t i=0; i<numTriangles; i++)
+    {
+        const cVector3d& vertex0 = m_vertices[m_triangles[3*i]];
+        cVector3d normal = cCross(m_vertices[m_triangles[3*i+1]] - vertex0,
+                                  m_vertices[m_triangles[3*i+2]] - vertex0);
+        double length = normal.length();
+        if (length > 0.0) { normal.mul(1.0 / length); }
+        m_faceNormals[i] = normal;
+        m_faceOffsets[i] = normal.dot(vertex0);
+    }
+
+    // each edge is shared by two triangles, once in each direction
+    m_neighbourOffsets.assign(numVertices + 1, 0);
+    for (size_t i=0; i<m_triangles.size(); i++)
+    {
+        m_neighbourOffsets[m_triangles[i] + 1]++;
+    }
+    for (size_t i=0; i<numVertices; i++)
+    {
+        m_neighbourOffsets[i + 1] += m_neighbourOffsets[i];
+    }
+    m_neighbours.resize(m_triangles.size());
+    std::vector<unsigned int> next(m_neighbourOffsets.begin(), m_neighbourOffsets.end() - 1);
+    for (size_t i=0; i<numTriangles; i++)
+    {
+        for (int e=0; e<3; e++)
+        {
+            m_neighbours[next[m_triangles[3*i+e]]++] = m_triangles[3*i+(e+1)%3];
+        }
+    }
+
+    // bounding box
+    m_boundaryMin.zero();
+    m_boundaryMax.zero();
+    if (numVertices > 0)
+    {
+        m_boundaryMin = m_vertices[0];
+        m_boundaryMax = m_vertices[0];
+    }
+    for (auto& vertex : m_vertices)
+    {
+        for (int axis=0; axis<3; axis++)
+        {
+            m_boundaryMin(axis) = cMin(m_boundaryMin(axis), vertex(axis));
+            m_boundaryMax(axis) = cMax(m_boundaryMax(axis), vertex(axis));
+        }
+    }
+    cVector3d size = m_boundaryMax - m_boundaryMin;
+    m_tolerance = C_HULL_TOLERANCE * cMax(size(0), cMax(size(1), size(2)));
+}
+
+
+//==============================================================================
+/*!
+    This method returns the vertex of the hull furthest in a direction. The
+    search climbs the edges of the hull from the support vertex of the cache,
+    which is updated: on a convex polyhedron, a vertex that has no neighbour
+    further in the direction is the furthest.
+
+    \param  a_direction  Direction.
+    \param  a_cache      Result of the previous queries, updated.
+
+    \return Index of the vertex.
+*/
+//==============================================================================
+int cConvexHull::getSupportVertex(const cVector3d& a_direction, cConvexHullCache& a_cache) const
+{
+    int best = a_cache.m_supportVertex;
+    if ((best < 0) || (best >= (int)m_vertices.size()))
+    {
+        best = 0;
+    }
+
+    double bestDot = a_direction.dot(m_vertices[best]);
+    while (true)
+    {
+        int current = best;
+        for (unsigned int i=m_neighbourOffsets[current]; i<m_neighbourOffsets[current + 1]; i++)
+        {
+            double dot = a_direction.dot(m_vertices[m_neighbours[i]]);
+            if (dot > bestDot)
+            {
+                bestDot = dot;
+                best = (int)m_neighbours[i];
+            }
+        }
+        if (best == current)
+        {
+            break;
+        }
+    }
+
+    a_cache.m_supportVertex = best;
+    return (best);
+}
+
+
+//==============================================================================
+/*!
+    This method computes the distance from a point to the hull with GJK,
+    starting from the simplex of the cache, which is updated.
+
+    \param  a_point         Point.
+    \param  a_nearestPoint  Returned nearest point of the hull, the point itself if inside.
+    \param  a_cache         Result of the previous queries, updated.
+
+    \return Distance to the hull, zero if the point is inside.
+*/
+//==============================================================================
+double cConvexHull::computeDistance(const cVector3d& a_point,
+                                    cVector3d& a_nearestPoint,
+                                    cConvexHullCache& a_cache) const
+{
+    a_nearestPoint = a_point;
+    if (isEmpty())
+    {
+        return (0.0);
+    }
+
+    // simplex of hull vertices, relative to the point, started from the cache
+    int simplex[4];
+    cVector3d w[4];
+    int size = 0;
+    for (int i=0; i<a_cache.m_simplexSize; i++)
+    {
+        if ((a_cache.m_simplex[i] >= 0) && (a_cache.m_simplex[i] < (int)m_vertices.size()))
+        {
+            simplex[size] = a_cache.m_simplex[i];
+            w[size] = m_vertices[simplex[size]] - a_point;
+            size++;
+        }
+    }
+    if (size == 0)
+    {
+        // the support vertex of the cache, found for a null direction
+        simplex[0] = getSupportVertex(cVector3d(0.0, 0.0, 0.0), a_cache);
+        w[0] = m_vertices[simplex[0]] - a_point;
+        size = 1;
+    }
+
+    int mask;
+    cVector3d v = cNearestOnSimplex(w, size, mask);
+    cReduceSimplex(simplex, size, mask);
+    size = cReduceSimplex(w, size, mask);
+
+    const double insideSq = cSqr(1e-3 * m_tolerance);
+    for (int iteration=0; iteration<C_HULL_MAX_ITERATIONS; iteration++)
+    {
+        // the origin is inside of the simplex
+        if ((size == 4) || (v.lengthsq() <= insideSq))
+        {
+            v.zero();
+            break;
+        }
+
+        // stop when the support point does not bring the simplex closer
+        int support = getSupportVertex(-v, a_cache);
+        cVector3d point = m_vertices[support] - a_point;
+        if ((v.lengthsq() - v.dot(point) <= 1e-12 * v.lengthsq()) ||
+            (std::find(simplex, simplex + size, support) != simplex + size))
+        {
+            break;
+        }
+
+        simplex[size] = support;
+        w[size] = point;
+        size++;
+        v = cNearestOnSimplex(w, size, mask);
+        cReduceSimplex(simplex, size, mask);
+        size = cReduceSimplex(w, size, mask);
+    }
+
+    std::copy(simplex, simplex + size, a_cache.m_simplex);
+    a_cache.m_simplexSize = size;
+
+    a_nearestPoint = a_point + v;
+    return (v.length());
+}
+
+
+//==============================================================================
+/*!
+    This method computes how deep a point is inside of the hull, and the
+    direction in which it leaves the hull the soonest, with EPA. The
+    polytope is expanded from the simplex of the cache. Points outside of the
+    hull get minus their distance to the hull and the direction away from it.
+
+    \param  a_point   Point.
+    \param  a_normal  Returned direction to the nearest point of the surface, outwards.
+    \param  a_cache   Result of the previous queries, updated.
+
+    \return Penetration depth, negative outside.
+*/
+//==============================================================================
+double cConvexHull::computePenetration(const cVector3d& a_point,
+                                       cVector3d& a_normal,
+                                       cConvexHullCache& a_cache) const
+{
+    a_normal.set(0.0, 0.0, 1.0);
+    if (isEmpty())
+    {
+        return (0.0);
+    }
+
+    cVector3d nearest;
+    double distance = computeDistance(a_point, nearest, a_cache);
+    if (distance > 0.0)
+    {
+        a_normal = (a_point - nearest) / distance;
+        return (-distance);
+    }
+
+    // points of the polytope, relative to the point: the simplex of GJK,
+    // completed to a tetrahedron with support points
+    std::vector<cVector3d> points;
+    for (int i=0; i<a_cache.m_simplexSize; i++)
+    {
+        points.push_back(m_vertices[a_cache.m_simplex[i]] - a_point);
+    }
+    const cVector3d axes[6] = { cVector3d(1,0,0), cVector3d(-1,0,0), cVector3d(0,1,0),
+                                cVector3d(0,-1,0), cVector3d(0,0,1), cVector3d(0,0,-1) };
+    for (int i=0; (i<6) && (points.size() == 1); i++)
+    {
+        cVector3d point = m_vertices[getSupportVertex(axes[i], a_cache)] - a_point;
+        if (cDistance(point, points[0]) > m_tolerance) { points.push_back(point); }
+    }
+    if (points.size() == 2)
+    {
+        cVector3d edge = cNormalize(points[1] - points[0]);
+        int axis = (fabs(edge(0)) < fabs(edge(1))) ? 0 : 1;
+        axis = (fabs(edge(axis)) < fabs(edge(2))) ? axis : 2;
+        cVector3d u = cNormalize(cCross(edge, axes[2 * axis]));
+        cVector3d directions[4] = { u, -u, cCross(edge, u), -cCross(edge, u) };
+        for (int i=0; (i<4) && (points.size() == 2); i++)
+        {
+            cVector3d point = m_vertices[getSupportVertex(directions[i], a_cache)] - a_point;
+            if (cCross(point - points[0], edge).length() > m_tolerance) { points.push_back(point); }
+        }
+    }
+    if (points.size() == 3)
+    {
+        cVector3d n = cNormalize(cCross(points[1] - points[0], points[2] - points[0]));
+        for (int side=0; (side<2) && (points.size() == 3); side++)
+        {
+            cVector3d direction = (side == 0) ? n : -n;
+            cVector3d point = m_vertices[getSupportVertex(direction, a_cache)] - a_point;
+            if (fabs(n.dot(point - points[0])) > m_tolerance) { points.push_back(point); }
+        }
+    }
+
+    // faces of the polytope, facing outwards
+    struct cPolytopeFace
+    {
+        int m_vertex[3];
+        cVector3d m_normal;
+        double m_distance;
+    };
+    std::vector<cPolytopeFace> faces;
+    auto addFace = [&](int a_a, int a_b, int a_c)
+    {
+        cPolytopeFace face;
+        face.m_vertex[0] = a_a;
+        face.m_vertex[1] = a_b;
+        face.m_vertex[2] = a_c;
+        face.m_normal = cCross(points[a_b] - points[a_a], points[a_c] - points[a_a]);
+        double length = face.m_normal.length();
+        if (!(length > 0.0))
+        {
+            return (false);
+        }
+        face.m_normal.mul(1.0 / length);
+        face.m_distance = face.m_normal.dot(points[a_a]);
+        faces.push_back(face);
+        return (true);
+    };
+
+    bool expanded = false;
+    if (points.size() == 4)
+    {
+        if (cCross(points[1] - points[0], points[2] - points[0]).dot(points[3] - points[0]) > 0.0)
+        {
+            std::swap(points[1], points[2]);
+        }
+        expanded = addFace(0, 1, 2) && addFace(0, 3, 1) && addFace(1, 3, 2) && addFace(2, 3, 0);
+    }
+
+    std::vector<std::pair<int, int> > horizon;
+    for (int iteration=0; expanded && (iteration<C_HULL_MAX_ITERATIONS); iteration++)
+    {
+        // the face nearest to the point
+        size_t nearestFace = 0;
+        for (size_t f=1; f<faces.size(); f++)
+        {
+            if (faces[f].m_distance < faces[nearestFace].m_distance) { nearestFace = f; }
+        }
+        cPolytopeFace face = faces[nearestFace];
+
+        // done when the hull does not extend beyond it
+        cVector3d support = m_vertices[getSupportVertex(face.m_normal, a_cache)] - a_point;
+        if (face.m_normal.dot(support) - face.m_distance <= 1e-3 * m_tolerance)
+        {
+            a_normal = face.m_normal;
+            return (cMax(0.0, face.m_distance));
+        }
+
+        // replace the faces seen from the support point by a cone
+        horizon.clear();
+        for (size_t f=0; f<faces.size(); )
+        {
+            if (faces[f].m_normal.dot(support) - faces[f].m_distance > 1e-3 * m_tolerance)
+            {
+                for (int e=0; e<3; e++)
+                {
+                    std::pair<int, int> edge(faces[f].m_vertex[e], faces[f].m_vertex[(e+1)%3]);
+                    auto twin = std::find(horizon.begin(), horizon.end(), std::make_pair(edge.second, edge.first));
+                    if (twin != horizon.end()) { horizon.erase(twin); }
+                    else { horizon.push_back(edge); }
+                }
+                faces[f] = faces.back();
+                faces.pop_back();
+            }
+            else
+            {
+                f++;
+            }
+        }
+        points.push_back(support);
+        int apex = (int)points.size() - 1;
+        for (auto& edge : horizon)
+        {
+            expanded = addFace(edge.first, edge.second, apex) && expanded;
+        }
+        expanded = expanded && !faces.empty();
+    }
+
+    // degenerate polytope: nearest plane of the hull
+    double depth = C_LARGE;
+    for (size_t f=0; f<m_faceNormals.size(); f++)
+    {
+        double d = m_faceOffsets[f] - m_faceNormals[f].dot(a_point);
+        if (d < depth)
+        {
+            depth = d;
+            a_normal = m_faceNormals[f];
+        }
+    }
+    return (cMax(0.0, depth));
+}
+
+
+//==============================================================================
+/*!
+    This method computes the first contact of a sphere moving along a segment
+    with the hull, with the GJK ray cast of van den Bergen: the segment is
+    cast against the hull grown by the radius of the sphere, starting from
+    the axis that separates its start point from the hull.
+
+    \param  a_segmentPointA  Start point of the center of the sphere.
+    \param  a_segmentPointB  End point of the center of the sphere.
+    \param  a_radius         Radius of the sphere.
+    \param  a_fraction       Returned fraction of the segment covered before the contact.
+    \param  a_normal         Returned normal of the surface at the contact, zero if the sphere starts in contact.
+    \param  a_cache          Result of the previous queries, updated.
+
+    \return __true__ if the sphere touches the hull along the segment.
+*/
+//==============================================================================
+bool cConvexHull::computeSweptSphere(const cVector3d& a_segmentPointA,
+                                     const cVector3d& a_segmentPointB,
+                                     const double a_radius,
+                                     double& a_fraction,
+                                     cVector3d& a_normal,
+                                     cConvexHullCache& a_cache) const
+{
+    a_fraction = 0.0;
+    a_normal.zero();
+    if (isEmpty())
+    {
+        return (false);
+    }
+
+    const cVector3d ray = a_segmentPointB - a_segmentPointA;
+    const double radius = cMax(0.0, a_radius);
+    double lambda = 0.0;
+    cVector3d x = a_segmentPointA;
+    cVector3d normal(0.0, 0.0, 0.0);
+
+    // simplex of points of the grown hull, and the same relative to x
+    cVector3d points[4];
+    cVector3d w[4];
+    for (int i=0; i<4; i++)
+    {
+        points[i].zero();
+        w[i].zero();
+    }
+    int size = 0;
+    int mask = 0;
+
+    // start from the simplex of GJK that separates the start point from
+    // the hull, moved by the radius along the separating axis: on curved
+    // hulls, the search then stays around the normal of the contact
+    cVector3d nearest;
+    cVector3d v;
+    double distance = computeDistance(x, nearest, a_cache);
+    if (distance > 0.0)
+    {
+        cVector3d offset = (radius / distance) * (x - nearest);
+        for (int i=0; i<a_cache.m_simplexSize; i++)
+        {
+            points[size] = m_vertices[a_cache.m_simplex[i]] + offset;
+            w[size] = x - points[size];
+            size++;
+        }
+        v = cNearestOnSimplex(w, size, mask);
+        size = cReduceSimplex(points, size, mask);
+    }
+    else
+    {
+        v = x - m_vertices[getSupportVertex(cVector3d(0.0, 0.0, 0.0), a_cache)];
+    }
+
+    const double contactSq = cSqr(m_tolerance);
+    int iteration = 0;
+    while ((v.lengthsq() > contactSq) && (iteration < C_HULL_MAX_ITERATIONS))
+    {
+        iteration++;
+
+        // support point of the hull grown by the radius
+        cVector3d support = m_vertices[getSupportVertex(v, a_cache)] + (radius / v.length()) * v;
+        cVector3d point = x - support;
+        double vw = v.dot(point);
+        if (vw > 0.0)
+        {
+            // x is in front of the support plane: move it to the plane
+            double vr = v.dot(ray);
+            if (vr >= 0.0)
+            {
+                return (false);
+            }
+            lambda -= vw / vr;
+            if (lambda > 1.0)
+            {
+                return (false);
+            }
+            x = a_segmentPointA + lambda * ray;
+            normal = v;
+        }
+
+        // the support point may already be in the simplex, if x moved
+        bool known = false;
+        for (int i=0; i<size; i++)
+        {
+            known = known || (cDistance(points[i], support) <= m_tolerance);
+        }
+        if (!known)
+        {
+            points[size] = support;
+            size++;
+        }
+        for (int i=0; i<size; i++)
+        {
+            w[i] = x - points[i];
+        }
+        v = cNearestOnSimplex(w, size, mask);
+        size = cReduceSimplex(points, size, mask);
+        if (size == 4)
+        {
+            break;
+        }
+    }
+
+    // no convergence: accept contacts within the tolerance
+    if ((iteration == C_HULL_MAX_ITERATIONS) && (v.length() > m_tolerance))
+    {
+        return (false);
+    }
+
+    a_fraction = lambda;
+    double length = normal.length();
+    if (length > 0.0)
+    {
+        a_normal = normal / length;
+    }
+    return (true);
+}
+
+//------------------------------------------------------------------------------
+} // namespace chai3d
+//------------------------------------------------------------------------------
@@ -0,0 +1,451 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2003-2016, CHAI3D.
+    (www.chai3d.org)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of CHAI3D nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE. 
+
+    \author    <http://www.chai3d.org>
+    \version   3.2.0 $Rev: 1869 $
+*/
+//==============================================================================
+
+//------------------------------------------------------------------------------
+#include "world/CConvexObject.h"
+#include "world/CMesh.h"
+//------------------------------------------------------------------------------
+#include "shaders/CShaderProgram.h"
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+namespace chai3d {
+//------------------------------------------------------------------------------
+
+//==============================================================================
+/*!
+    Constructor of cConvexObject.
+
+    \param  a_material  Material property to be applied to object.
+*/
+//==============================================================================
+cConvexObject::cConvexObject(cMaterialPtr a_material)
+{
+    // set material properties
+    if (a_material == nullptr)
+    {
+        m_material = cMaterial::create();
+        m_material->setWhite();
+    }
+    else
+    {
+        m_material = a_material;
+    }
+}
+
+
+//==============================================================================
+/*!
+    This method sets the hull of this object to the convex hull of a point
+    cloud, in the frame of the object.
+
+    \param  a_points  Points.
+
+    \return __true__ if the operation succeeds, __false__ if the points are
+            fewer than four or flat.
+*/
+//==============================================================================
+bool cConvexObject::createFromPoints(const std::vector<cVector3d>& a_points)
+{
+    cConvexHullPtr convexHull = cConvexHull::create();
+    if (!convexHull->createFromPoints(a_points))
+    {
+        return (C_ERROR);
+    }
+
+    setConvexHull(convexHull);
+    return (C_SUCCESS);
+}
+
+
+//==============================================================================
+/*!
+    This method sets the hull of this object to the convex hull of the
+    vertices of the triangles of a mesh, in the frame of the mesh.
+
+    \param  a_mesh  Mesh.
+
+    \return __true__ if the operation succeeds, __false__ if the mesh is flat.
+*/
+//==============================================================================
+bool cConvexObject::createFromMesh(cMesh* a_mesh)
+{
+    if (a_mesh == nullptr)
+    {
+        return (C_ERROR);
+    }
+
+    cConvexHullPtr convexHull = cConvexHull::create();
+    if (!convexHull->createFromTriangles(a_mesh->m_triangles))
+    {
+        return (C_ERROR);
+    }
+
+    setConvexHull(convexHull);
+    return (C_SUCCESS);
+}
+
+
+//==============================================================================
+/*!
+    This method sets the convex hull of this object. Hulls are not modified
+    by the object and can be shared by several objects.
+
+    \param  a_convexHull  Convex hull, in the frame of the object.
+*/
+//==============================================================================
+void cConvexObject::setConvexHull(cConvexHullPtr a_convexHull)
+{
+    m_convexHull = a_convexHull;
+    m_cache = cConvexHullCache();
+    updateBoundaryBox();
+    markForUpdate(false);
+}
+
+
+//==============================================================================
+/*!
+    This method scales this object by using different factors along X, Y and
+    Z axes. The hull may be shared with other objects, so a scaled copy
+    replaces it.
+
+    \param  a_scaleX  Scale factor along X axis.
+    \param  a_scaleY  Scale factor along Y axis.
+    \param  a_scaleZ  Scale factor along Z axis.
+*/
+//==============================================================================
+void cConvexObject::scaleXYZ(const double a_scaleX, const double a_scaleY, const double a_scaleZ)
+{
+    if ((m_convexHull == nullptr) || !(a_scaleX > 0.0) || !(a_scaleY > 0.0) || !(a_scaleZ > 0.0))
+    {
+        return;
+    }
+
+    cConvexHullPtr convexHull = std::make_shared<cConvexHull>(*m_convexHull);
+    convexHull->scale(cVector3d(a_scaleX, a_scaleY, a_scaleZ));
+    setConvexHull(convexHull);
+}
+
+
+//==============================================================================
+/*!
+    This method renders the triangles of the hull using OpenGL.
+
+    \param  a_options  Render options.
+*/
+//==============================================================================
+void cConvexObject::render(cRenderOptions& a_options)
+{
+#ifdef C_USE_OPENGL
+
+    if ((m_convexHull == nullptr) || m_convexHull->isEmpty())
+    {
+        return;
+    }
+
+    /////////////////////////////////////////////////////////////////////////
+    // ENABLE SHADER
+    /////////////////////////////////////////////////////////////////////////
+    if ((m_shaderProgram != nullptr) && (!a_options.m_creating_shadow_map))
+    {
+        // enable shader
+        m_shaderProgram->use(this, a_options);
+    }
+
+
+    /////////////////////////////////////////////////////////////////////////
+    // Render parts that use material properties
+    /////////////////////////////////////////////////////////////////////////
+    if (SECTION_RENDER_PARTS_WITH_MATERIALS(a_options, m_useTransparency))
+    {
+        // render material properties
+        if (m_useMaterialProperty)
+        {
+            m_material->render(a_options);
+        }
+
+        if (!m_displayList.render(m_useDisplayList))
+        {
+            // create display list if requested
+            m_displayList.begin(m_useDisplayList);
+
+            // render flat triangles
+            glBegin(GL_TRIANGLES);
+            for (unsigned int i=0; i<m_convexHull->getNumTriangles(); i++)
+            {
+                const cVector3d& normal = m_convexHull->getTriangleNormal(i);
+                glNormal3d(normal(0), normal(1), normal(2));
+                for (unsigned int j=0; j<3; j++)
+                {
+                    const cVector3d& vertex = m_convexHull->getVertex(m_convexHull->getTriangleVertex(i, j));
+                    glVertex3d(vertex(0), vertex(1), vertex(2));
+                }
+            }
+            glEnd();
+
+            // finalize display list
+            m_displayList.end(true);
+        }
+    }
+
+    /////////////////////////////////////////////////////////////////////////
+    // DISABLE SHADER
+    /////////////////////////////////////////////////////////////////////////
+    if ((m_shaderProgram != nullptr) && (!a_options.m_creating_shadow_map))
+    {
+        // disable shader
+        m_shaderProgram->disable();
+    }
+
+#else
+
+    // nothing is rendered without OpenGL
+    (void)a_options;
+
+#endif
+}
+
+
+//==============================================================================
+/*!
+    This method updates the boundary box of this object, which is the one of
+    the hull.
+*/
+//==============================================================================
+void cConvexObject::updateBoundaryBox()
+{
+    if ((m_convexHull == nullptr) || m_convexHull->isEmpty())
+    {
+        m_boundaryBoxMin.zero();
+        m_boundaryBoxMax.zero();
+        m_boundaryBoxEmpty = true;
+        return;
+    }
+
+    m_boundaryBoxMin = m_convexHull->getBoundaryMin();
+    m_boundaryBoxMax = m_convexHull->getBoundaryMax();
+    m_boundaryBoxEmpty = false;
+}
+
+
+//==============================================================================
+/*!
+    This method uses the position of the tool and searches for the nearest point
+    located at the surface of the current object and identifies if the point is
+    located inside or outside of the object.
+
+    \param  a_toolPos  Position of the tool.
+    \param  a_toolVel  Velocity of the tool.
+    \param  a_IDN      Identification number of the force algorithm.
+*/
+//==============================================================================
+void cConvexObject::computeLocalInteraction(const cVector3d& a_toolPos,
+                                            const cVector3d& /*a_toolVel*/,
+                                            const unsigned int /*a_IDN*/)
+{
+    if ((m_convexHull == nullptr) || m_convexHull->isEmpty())
+    {
+        m_interactionPoint = a_toolPos;
+        m_interactionNormal.set(0,0,1);
+        m_interactionInside = false;
+        return;
+    }
+
+    // the surface is one depth away, along the normal
+    double depth = m_convexHull->computePenetration(a_toolPos, m_interactionNormal, m_cache);
+    m_interactionPoint = a_toolPos + depth * m_interactionNormal;
+    m_interactionInside = (depth >= 0.0);
+}
+
+
+//==============================================================================
+/*!
+    This method determines whether a given segment intersects this object. \n
+    The segment is described by a start point \p a_segmentPointA and end 
+    point \p a_segmentPointB. \n
+    All detected collisions are reported in the collision recorder passed 
+    by argument \p a_recorder. \n
+    Specifications about the type of collisions reported are specified by 
+    argument \p a_settings. \n
+
+    The reported position is the center of the tool, at the collision radius
+    from the surface. A segment that starts inside of the surface collides
+    at its start if it goes deeper, and does not collide if it goes out.
+
+    \param  a_segmentPointA  Start point of segment.
+    \param  a_segmentPointB  End point of segment.
+    \param  a_recorder       Recorder which stores all collision events.
+    \param  a_settings       Collision settings information.
+
+    \return __true__ if a collision has occurred, __false__ otherwise.
+*/
+//==============================================================================
+bool cConvexObject::computeOtherCollisionDetection(cVector3d& a_segmentPointA,
+                                                   cVector3d& a_segmentPointB,
+                                                   cCollisionRecorder& a_recorder,
+                                                   cCollisionSettings& a_settings)
+{
+    ////////////////////////////////////////////////////////////////////////////
+    // COMPUTE COLLISION
+    ////////////////////////////////////////////////////////////////////////////
+
+    if ((m_convexHull == nullptr) || m_convexHull->isEmpty())
+    {
+        return (false);
+    }
+
+    const double radius = cMax(0.0, a_settings.m_collisionRadius);
+    cVector3d direction = a_segmentPointB - a_segmentPointA;
+    const double length = direction.length();
+
+    // no collision has occurred yet
+    bool hit = false;
+    double fraction = 0.0;
+    cVector3d collisionNormal;
+
+    cVector3d nearest;
+    double distance = m_convexHull->computeDistance(a_segmentPointA, nearest, m_cache);
+    if (distance <= radius)
+    {
+        // start inside: collide only when going deeper
+        if (distance > 0.0)
+        {
+            collisionNormal = (a_segmentPointA - nearest) / distance;
+        }
+        else
+        {
+            m_convexHull->computePenetration(a_segmentPointA, collisionNormal, m_cache);
+        }
+        hit = (length > 0.0) && (direction.dot(collisionNormal) < 0.0);
+    }
+    else
+    {
+        hit = m_convexHull->computeSweptSphere(a_segmentPointA, a_segmentPointB, radius,
+                                               fraction, collisionNormal, m_cache);
+        if (hit && (collisionNormal.lengthsq() == 0.0))
+        {
+            collisionNormal = -direction / length;
+        }
+    }
+
+    if (!hit)
+    {
+        return (false);
+    }
+
+    // collision point
+    cVector3d collisionPoint = a_segmentPointA + fraction * direction;
+    double collisionDistanceSq = cSqr(fraction * length);
+
+
+    ////////////////////////////////////////////////////////////////////////////
+    // REPORT COLLISION
+    ////////////////////////////////////////////////////////////////////////////
+
+    // we verify if anew collision needs to be created or if we simply
+    // need to update the nearest collision.
+    if (a_settings.m_checkForNearestCollisionOnly)
+    {
+        // no new collision event is create. We just check if we need
+        // to update the nearest collision
+        if (collisionDistanceSq <= a_recorder.m_nearestCollision.m_squareDistance)
+        {
+            // report basic collision data
+            a_recorder.m_nearestCollision.m_type = C_COL_SHAPE;
+            a_recorder.m_nearestCollision.m_object = this;
+            a_recorder.m_nearestCollision.m_triangles = nullptr;
+            a_recorder.m_nearestCollision.m_localPos = collisionPoint;
+            a_recorder.m_nearestCollision.m_localNormal = collisionNormal;
+            a_recorder.m_nearestCollision.m_squareDistance = collisionDistanceSq;
+            a_recorder.m_nearestCollision.m_adjustedSegmentAPoint = a_segmentPointA;
+
+            // report advanced collision data
+            if (!a_settings.m_returnMinimalCollisionData)
+            {
+                a_recorder.m_nearestCollision.m_globalPos = cAdd(getGlobalPos(),
+                    cMul(getGlobalRot(),
+                    a_recorder.m_nearestCollision.m_localPos));
+                a_recorder.m_nearestCollision.m_globalNormal = cMul(getGlobalRot(),
+                    a_recorder.m_nearestCollision.m_localNormal);
+            }
+        }
+    }
+    else
+    {
+        cCollisionEvent newCollisionEvent;
+
+        // report basic collision data
+        newCollisionEvent.m_type = C_COL_SHAPE;
+        newCollisionEvent.m_object = this;
+        newCollisionEvent.m_triangles = nullptr;
+        newCollisionEvent.m_localPos = collisionPoint;
+        newCollisionEvent.m_localNormal = collisionNormal;
+        newCollisionEvent.m_squareDistance = collisionDistanceSq;
+        newCollisionEvent.m_adjustedSegmentAPoint = a_segmentPointA;
+
+        // report advanced collision data
+        if (!a_settings.m_returnMinimalCollisionData)
+        {
+            newCollisionEvent.m_globalPos = cAdd(getGlobalPos(),
+                cMul(getGlobalRot(),
+                newCollisionEvent.m_localPos));
+            newCollisionEvent.m_globalNormal = cMul(getGlobalRot(),
+                newCollisionEvent.m_localNormal);
+        }
+
+        // add new collision even to collision list
+        a_recorder.m_collisions.push_back(newCollisionEvent);
+
+        // check if this new collision is a candidate for "nearest one"
+        if (collisionDistanceSq <= a_recorder.m_nearestCollision.m_squareDistance)
+        {
+            a_recorder.m_nearestCollision = newCollisionEvent;
+        }
+    }
+
+    // return result
+    return (true);
+}
+
+//------------------------------------------------------------------------------
+} // namespace chai3d
+//------------------------------------------------------------------------------
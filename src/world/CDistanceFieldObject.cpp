@@ -0,0 +1,419 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2003-2016, CHAI3D.
+    (www.chai3d.org)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of CHAI3D nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE. 
+
+    \author    <http://www.chai3d.org>
+    \version   3.2.0 $Rev: 1869 $
+*/
+//==============================================================================
+
+//------------------------------------------------------------------------------
+#include "world/CDistanceFieldObject.h"
+#include "world/CMesh.h"
+//------------------------------------------------------------------------------
+#include <cstdio>
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+namespace chai3d {
+//------------------------------------------------------------------------------
+
+//==============================================================================
+/*!
+    Constructor of cDistanceFieldObject.
+
+    \param  a_material  Material property to be applied to object.
+*/
+//==============================================================================
+cDistanceFieldObject::cDistanceFieldObject(cMaterialPtr a_material)
+{
+    // set material properties
+    if (a_material == nullptr)
+    {
+        m_material = cMaterial::create();
+        m_material->setWhite();
+    }
+    else
+    {
+        m_material = a_material;
+    }
+}
+
+
+//==============================================================================
+/*!
+    This method bakes the signed distance field of this object from the
+    triangles of a mesh, in the frame of the mesh. \n\n
+
+    If a cache directory is given, fields are stored in files named after
+    a hash of the triangles, cell size and band (as collision trees, see
+    cMesh::createAABBCollisionDetector()), and a field baked before for the
+    same geometry is loaded instead of being baked again. The cache
+    directory must exist.
+
+    \param  a_mesh            Closed mesh, with triangles facing outwards.
+    \param  a_cellSize        Distance between two neighbour nodes of the field.
+    \param  a_bandWidth       Distance from the surface beyond which the field is clamped.
+    \param  a_cacheDirectory  Directory where fields are cached, or empty.
+
+    \return __true__ if the operation succeeds, __false__ otherwise.
+*/
+//==============================================================================
+bool cDistanceFieldObject::createFromMesh(cMesh* a_mesh,
+                                          const double a_cellSize,
+                                          const double a_bandWidth,
+                                          const std::string& a_cacheDirectory)
+{
+    if (a_mesh == nullptr)
+    {
+        return (C_ERROR);
+    }
+
+    cSignedDistanceFieldPtr field = cSignedDistanceField::create();
+
+    // no cache
+    if (a_cacheDirectory.empty())
+    {
+        if (!field->createFromTriangles(a_mesh->m_triangles, a_cellSize, a_bandWidth))
+        {
+            return (C_ERROR);
+        }
+        setDistanceField(field);
+        return (C_SUCCESS);
+    }
+
+    // name of cached field
+    unsigned long long hash = cSignedDistanceField::computeHash(a_mesh->m_triangles, a_cellSize, a_bandWidth);
+    char name[32];
+    snprintf(name, sizeof(name), "sdf-%016llx.bin", hash);
+    std::string filename = a_cacheDirectory + "/" + name;
+
+    // load cached field, or bake and save it
+    if (!field->loadFromFile(filename, hash))
+    {
+        if (!field->createFromTriangles(a_mesh->m_triangles, a_cellSize, a_bandWidth))
+        {
+            return (C_ERROR);
+        }
+        field->saveToFile(filename, hash);
+    }
+
+    setDistanceField(field);
+    return (C_SUCCESS);
+}
+
+
+//==============================================================================
+/*!
+    This method sets the signed distance field of this object. Fields are
+    not modified by the object and can be shared by several objects.
+
+    \param  a_field  Signed distance field, in the frame of the object.
+*/
+//==============================================================================
+void cDistanceFieldObject::setDistanceField(cSignedDistanceFieldPtr a_field)
+{
+    m_distanceField = a_field;
+    updateBoundaryBox();
+}
+
+
+//==============================================================================
+/*!
+    This method updates the boundary box of this object, which is the grid
+    of the field.
+*/
+//==============================================================================
+void cDistanceFieldObject::updateBoundaryBox()
+{
+    if ((m_distanceField == nullptr) || m_distanceField->isEmpty())
+    {
+        m_boundaryBoxMin.zero();
+        m_boundaryBoxMax.zero();
+        m_boundaryBoxEmpty = true;
+        return;
+    }
+
+    m_boundaryBoxMin = m_distanceField->getOrigin();
+    m_boundaryBoxMax = m_distanceField->getEnd();
+    m_boundaryBoxEmpty = false;
+}
+
+
+//==============================================================================
+/*!
+    This method scales the size of this object with given scale factor. The
+    field may be shared with other objects, so a scaled copy replaces it.
+
+    \param  a_scaleFactor  Scale factor.
+*/
+//==============================================================================
+void cDistanceFieldObject::scaleObject(const double& a_scaleFactor)
+{
+    if ((m_distanceField == nullptr) || !(a_scaleFactor > 0.0) || (a_scaleFactor == 1.0))
+    {
+        return;
+    }
+
+    cSignedDistanceFieldPtr field = std::make_shared<cSignedDistanceField>(*m_distanceField);
+    field->scale(a_scaleFactor);
+    setDistanceField(field);
+}
+
+
+//==============================================================================
+/*!
+    This method uses the position of the tool and searches for the nearest point
+    located at the surface of the current object and identifies if the point is
+    located inside or outside of the object.
+
+    \param  a_toolPos  Position of the tool.
+    \param  a_toolVel  Velocity of the tool.
+    \param  a_IDN      Identification number of the force algorithm.
+*/
+//==============================================================================
+void cDistanceFieldObject::computeLocalInteraction(const cVector3d& a_toolPos,
+                                                   const cVector3d& /*a_toolVel*/,
+                                                   const unsigned int /*a_IDN*/)
+{
+    if (m_distanceField == nullptr)
+    {
+        m_interactionPoint = a_toolPos;
+        m_interactionNormal.set(0,0,1);
+        m_interactionInside = false;
+        return;
+    }
+
+    // the surface is one distance away, against the gradient
+    cVector3d gradient;
+    double distance = m_distanceField->getDistance(a_toolPos, gradient);
+    double length = gradient.length();
+    if (length > 0.0)
+    {
+        m_interactionNormal = gradient / length;
+    }
+    else
+    {
+        m_interactionNormal.set(0,0,1);
+    }
+    m_interactionPoint = a_toolPos - distance * m_interactionNormal;
+    m_interactionInside = (distance <= 0.0);
+}
+
+
+//==============================================================================
+/*!
+    This method determines whether a given segment intersects this object. \n
+    The segment is described by a start point \p a_segmentPointA and end 
+    point \p a_segmentPointB. \n
+    All detected collisions are reported in the collision recorder passed 
+    by argument \p a_recorder. \n
+    Specifications about the type of collisions reported are specified by 
+    argument \p a_settings. \n
+
+    The reported position is the center of the tool, at the collision radius
+    from the surface. A segment that starts inside of the surface collides
+    at its start if it goes deeper, and does not collide if it goes out.
+
+    \param  a_segmentPointA  Start point of segment.
+    \param  a_segmentPointB  End point of segment.
+    \param  a_recorder       Recorder which stores all collision events.
+    \param  a_settings       Collision settings information.
+
+    \return __true__ if a collision has occurred, __false__ otherwise.
+*/
+//==============================================================================
+bool cDistanceFieldObject::computeOtherCollisionDetection(cVector3d& a_segmentPointA,
+                                                          cVector3d& a_segmentPointB,
+                                                          cCollisionRecorder& a_recorder,
+                                                          cCollisionSettings& a_settings)
+{
+    ////////////////////////////////////////////////////////////////////////////
+    // COMPUTE COLLISION
+    ////////////////////////////////////////////////////////////////////////////
+
+    if ((m_distanceField == nullptr) || m_distanceField->isEmpty())
+    {
+        return (false);
+    }
+
+    // the surface grown by the radius must lie within the band
+    const double cellSize = m_distanceField->getCellSize();
+    const double radius = cClamp(a_settings.m_collisionRadius, 0.0,
+                                 cMax(0.0, m_distanceField->getBandWidth() - cellSize));
+
+    cVector3d direction = a_segmentPointB - a_segmentPointA;
+    const double length = direction.length();
+    if (length > 0.0)
+    {
+        direction.mul(1.0 / length);
+    }
+
+    // no collision has occurred yet
+    bool hit = false;
+    double position = 0.0;
+
+    cVector3d gradient;
+    double distance = m_distanceField->getDistance(a_segmentPointA, gradient) - radius;
+    if (distance <= 0.0)
+    {
+        // start inside: collide only when going deeper
+        hit = (length > 0.0) && (direction.dot(gradient) < 0.0);
+    }
+    else
+    {
+        // trilinear interpolation can change up to sqrt(3) times faster than
+        // the distance, so steps are shortened accordingly
+        const double minStep = 0.02 * cellSize;
+        while (position < length)
+        {
+            double previous = position;
+            position = cMin(position + cMax(distance * 0.57735, minStep), length);
+            distance = m_distanceField->getDistance(a_segmentPointA + position * direction) - radius;
+            if (distance <= 0.0)
+            {
+                // refine the crossing between the last two steps
+                double outside = previous;
+                for (int i=0; i<16; i++)
+                {
+                    double middle = 0.5 * (outside + position);
+                    if (m_distanceField->getDistance(a_segmentPointA + middle * direction) - radius <= 0.0)
+                    {
+                        position = middle;
+                    }
+                    else
+                    {
+                        outside = middle;
+                    }
+                }
+                hit = true;
+                break;
+            }
+        }
+    }
+
+    if (!hit)
+    {
+        return (false);
+    }
+
+    // collision point and normal
+    cVector3d collisionPoint = a_segmentPointA + position * direction;
+    m_distanceField->getDistance(collisionPoint, gradient);
+    cVector3d collisionNormal;
+    if (gradient.length() > 0.0)
+    {
+        collisionNormal = cNormalize(gradient);
+    }
+    else
+    {
+        collisionNormal = -direction;
+    }
+    double collisionDistanceSq = position * position;
+
+
+    ////////////////////////////////////////////////////////////////////////////
+    // REPORT COLLISION
+    ////////////////////////////////////////////////////////////////////////////
+
+    // we verify if anew collision needs to be created or if we simply
+    // need to update the nearest collision.
+    if (a_settings.m_checkForNearestCollisionOnly)
+    {
+        // no new collision event is create. We just check if we need
+        // to update the nearest collision
+        if (collisionDistanceSq <= a_recorder.m_nearestCollision.m_squareDistance)
+        {
+            // report basic collision data
+            a_recorder.m_nearestCollision.m_type = C_COL_SHAPE;
+            a_recorder.m_nearestCollision.m_object = this;
+            a_recorder.m_nearestCollision.m_triangles = nullptr;
+            a_recorder.m_nearestCollision.m_localPos = collisionPoint;
+            a_recorder.m_nearestCollision.m_localNormal = collisionNormal;
+            a_recorder.m_nearestCollision.m_squareDistance = collisionDistanceSq;
+            a_recorder.m_nearestCollision.m_adjustedSegmentAPoint = a_segmentPointA;
+
+            // report advanced collision data
+            if (!a_settings.m_returnMinimalCollisionData)
+            {
+                a_recorder.m_nearestCollision.m_globalPos = cAdd(getGlobalPos(),
+                    cMul(getGlobalRot(),
+                    a_recorder.m_nearestCollision.m_localPos));
+                a_recorder.m_nearestCollision.m_globalNormal = cMul(getGlobalRot(),
+                    a_recorder.m_nearestCollision.m_localNormal);
+            }
+        }
+    }
+    else
+    {
+        cCollisionEvent newCollisionEvent;
+
+        // report basic collision data
+        newCollisionEvent.m_type = C_COL_SHAPE;
+        newCollisionEvent.m_object = this;
+        newCollisionEvent.m_triangles = nullptr;
+        newCollisionEvent.m_localPos = collisionPoint;
+        newCollisionEvent.m_localNormal = collisionNormal;
+        newCollisionEvent.m_squareDistance = collisionDistanceSq;
+        newCollisionEvent.m_adjustedSegmentAPoint = a_segmentPointA;
+
+        // report advanced collision data
+        if (!a_settings.m_returnMinimalCollisionData)
+        {
+            newCollisionEvent.m_globalPos = cAdd(getGlobalPos(),
+                cMul(getGlobalRot(),
+                newCollisionEvent.m_localPos));
+            newCollisionEvent.m_globalNormal = cMul(getGlobalRot(),
+                newCollisionEvent.m_localNormal);
+        }
+
+        // add new collision even to collision list
+        a_recorder.m_collisions.push_back(newCollisionEvent);
+
+        // check if this new collision is a candidate for "nearest one"
+        if (collisionDistanceSq <= a_recorder.m_nearestCollision.m_squareDistance)
+        {
+            a_recorder.m_nearestCollision = newCollisionEvent;
+        }
+    }
+
+    // return result
+    return (true);
+}
+
+//------------------------------------------------------------------------------
+} // namespace chai3d
+//------------------------------------------------------------------------------
@@ -50,9 +50,11 @@
 #include "effects/CEffectMagnet.h"
 #include "effects/CEffectStickSlip.h"
 #include "effects/CEffectSurface.h"
+#include "effects/CEffectTable.h"
 #include "effects/CEffectVibration.h"
 #include "effects/CEffectViscosity.h"
 #include "shaders/CShaderProgram.h"
+#include "world/CHapticScene.h"
 //------------------------------------------------------------------------------
 #include <float.h>
 #include <vector>
@@ -145,6 +147,26 @@ cGenericObject::cGenericObject()
     // empty list of haptic effects
     m_effects.clear();
 
+    // skip the object when the tool is beyond the reach of its effects,
+    // once its interaction boundary has been computed
+    m_interactionCullingEnabled = true;
+    m_interactionBounded = false;
+    m_interactionBoundaryEmpty = true;
+    m_interactionBoundaryMin.zero();
+    m_interactionBoundaryMax.zero();
+    for (int i=0; i<C_EFFECT_MAX_IDN; i++)
+    {
+        m_interactionNear[i] = true;
+    }
+    m_interactionContacts = 0;
+
+    // effects are evaluated by this object
+    m_effectTable = NULL;
+    m_effectTableIndex = -1;
+
+    // object is traversed as a tree
+    m_hapticScene = NULL;
+
     // setup default material
     m_material = s_defaultMaterial;
 
@@ -184,6 +206,15 @@ cGenericObject::cGenericObject()
 //==============================================================================
 cGenericObject::~cGenericObject()
 {
+    // remove object from its effect table
+    if (m_effectTable != NULL)
+    {
+        m_effectTable->release(this);
+    }
+
+    // the compiled scene must be flattened again
+    invalidateHapticScene();
+
     // delete collision detector
     deleteCollisionDetector(false);
 
@@ -374,12 +405,21 @@ void cGenericObject::computeGlobalPositions(const bool a_frameOnly,
     // updated (e.g. vertex positions)
     updateGlobalPositions(a_frameOnly);
 
+    // compiled effects read the new position while the object is in cache
+    if (m_effectTable != NULL)
+    {
+        m_effectTable->updateObject(m_effectTableIndex);
+    }
+
     // propagate this method to my children
     vector<cGenericObject*>::iterator it;
     for (it = m_children.begin(); it < m_children.end(); it++)
     {
         (*it)->computeGlobalPositions(a_frameOnly, m_globalPos, m_globalRot);
     }
+
+    // the boundaries of the children are up to date: update mine
+    updateInteractionBoundary();
 }
 
 
@@ -514,7 +554,7 @@ bool cGenericObject::createEffectMagnetic()
 
     if (flag)
     {
-        cGenericEffect* effect = new cEffectMagnet(this);
+        cGenericEffect* effect = cArena::create<cEffectMagnet>(m_arena, this);
         addEffect(effect);
         return (true);
     }
@@ -567,7 +607,7 @@ bool cGenericObject::createEffectStickSlip()
 
     if (flag)
     {
-        cGenericEffect* effect = new cEffectStickSlip(this);
+        cGenericEffect* effect = cArena::create<cEffectStickSlip>(m_arena, this);
         addEffect(effect);
         return (true);
     }
@@ -619,7 +659,7 @@ bool cGenericObject::createEffectSurface()
 
     if (flag)
     {
-        cGenericEffect* effect = new cEffectSurface(this);
+        cGenericEffect* effect = cArena::create<cEffectSurface>(m_arena, this);
         addEffect(effect);
         return (true);
     }
@@ -673,7 +713,7 @@ bool cGenericObject::createEffectVibration()
 
     if (flag)
     {
-        cGenericEffect* effect = new cEffectVibration(this);
+        cGenericEffect* effect = cArena::create<cEffectVibration>(m_arena, this);
         addEffect(effect);
         return (true);
     }
@@ -726,7 +766,7 @@ bool cGenericObject::createEffectViscosity()
 
     if (flag)
     {
-        cGenericEffect* effect = new cEffectViscosity(this);
+        cGenericEffect* effect = cArena::create<cEffectViscosity>(m_arena, this);
         addEffect(effect);
         return (true);
     }
@@ -841,6 +881,66 @@ void cGenericObject::setFriction(double a_staticFriction,
 }
 
 
+//==============================================================================
+/*!
+    This method enables or disables skipping this object and its children in
+    computeInteractions() when the tool is outside of their interaction
+    boundary: the boundary box of the objects, grown by the reach of their
+    haptic effects (see cGenericEffect::getInfluenceDistance()). The boundary
+    is updated by computeGlobalPositions() from the boundary boxes, which
+    must be recomputed with computeBoundaryBox() when the geometry changes.
+
+    \param  a_enabled         If __true__, then the object may be skipped.
+    \param  a_affectChildren  If __true__, then children are updated too.
+*/
+//==============================================================================
+void cGenericObject::setInteractionCullingEnabled(const bool a_enabled,
+    const bool a_affectChildren)
+{
+    m_interactionCullingEnabled = a_enabled;
+
+    // apply change to children
+    if (a_affectChildren)
+    {
+        vector<cGenericObject*>::iterator it;
+        for (it = m_children.begin(); it < m_children.end(); it++)
+        {
+            (*it)->setInteractionCullingEnabled(a_enabled, true);
+        }
+    }
+}
+
+
+//==============================================================================
+/*!
+    This method returns the box, in the reference frame of the parent,
+    outside of which this object and its children produce no interaction,
+    as computed by the last call to computeGlobalPositions(). The box is
+    empty (minimum above maximum) if they produce no interaction at all.
+
+    \param  a_boundaryMin  Returned minimum corner of the box.
+    \param  a_boundaryMax  Returned maximum corner of the box.
+
+    \return __true__ if the box is known, __false__ if the object and its children may interact anywhere.
+*/
+//==============================================================================
+bool cGenericObject::getInteractionBoundary(cVector3d& a_boundaryMin,
+    cVector3d& a_boundaryMax) const
+{
+    if (m_interactionBoundaryEmpty)
+    {
+        a_boundaryMin.set(C_LARGE, C_LARGE, C_LARGE);
+        a_boundaryMax.set(-C_LARGE, -C_LARGE, -C_LARGE);
+    }
+    else
+    {
+        a_boundaryMin = m_interactionBoundaryMin;
+        a_boundaryMax = m_interactionBoundaryMax;
+    }
+    return (m_interactionBounded);
+}
+
+
 //==============================================================================
 /*!
     This method graphically shows or hides this object, optionally recursively
@@ -1458,12 +1558,12 @@ void cGenericObject::computeBoundaryBox(const bool a_includeChildren)
             // update boundary box by taking into account child boundary box
             for (int i=0; i<8; i++)
             {
-                minBox(0) = cMin(corners[i](0),  m_boundaryBoxMin(0));
-                minBox(1) = cMin(corners[i](1),  m_boundaryBoxMin(1));
-                minBox(2) = cMin(corners[i](2),  m_boundaryBoxMin(2));
-                maxBox(0) = cMin(corners[i](0),  m_boundaryBoxMax(0));
-                maxBox(1) = cMin(corners[i](1),  m_boundaryBoxMax(1));
-                maxBox(2) = cMin(corners[i](2),  m_boundaryBoxMax(2));
+                minBox(0) = cMin(corners[i](0),  minBox(0));
+                minBox(1) = cMin(corners[i](1),  minBox(1));
+                minBox(2) = cMin(corners[i](2),  minBox(2));
+                maxBox(0) = cMax(corners[i](0),  maxBox(0));
+                maxBox(1) = cMax(corners[i](1),  maxBox(1));
+                maxBox(2) = cMax(corners[i](2),  maxBox(2));
             }
         }
     }
@@ -1787,6 +1887,7 @@ bool cGenericObject::addChild(cGenericObject* a_object)
     {
         m_children.push_back(a_object);
         a_object->m_parent = this;
+        invalidateHapticScene();
         return (true);
     }
 
@@ -1795,6 +1896,7 @@ bool cGenericObject::addChild(cGenericObject* a_object)
     else if (m_ghostEnabled)
     {
         m_children.push_back(a_object);
+        invalidateHapticScene();
         return (true);
     }
 
@@ -1834,6 +1936,7 @@ bool cGenericObject::removeChild(cGenericObject* a_object)
 
             // remove this object from my list of children
             m_children.erase(it);
+            invalidateHapticScene();
 
             // return success
             return (true);
@@ -1845,6 +1948,22 @@ bool cGenericObject::removeChild(cGenericObject* a_object)
 }
 
 
+//==============================================================================
+/*!
+    This method tells the compiled haptic scene that this object belongs to,
+    if any, that the scene graph changed below this object. The scene is
+    flattened again before its next traversal.
+*/
+//==============================================================================
+void cGenericObject::invalidateHapticScene()
+{
+    if (m_hapticScene != NULL)
+    {
+        m_hapticScene->invalidate();
+    }
+}
+
+
 //==============================================================================
 /*!
     This method removes this object from its parent's list of children.
@@ -1912,6 +2031,7 @@ void cGenericObject::clearAllChildren()
 
     // clear children list
     m_children.clear();
+    invalidateHapticScene();
 }
 
 
@@ -1932,6 +2052,7 @@ void cGenericObject::deleteAllChildren()
 
     // clear my list of children
     m_children.clear();
+    invalidateHapticScene();
 }
 
 
@@ -2435,55 +2556,22 @@ cVector3d cGenericObject::computeInteractions (const cVector3d& a_toolPos,
   // check if node is a ghost. If yes, then ignore call
   if (m_ghostEnabled) { return (cVector3d (0,0,0)); }
 
-  // process current object if enabled
-  if (m_enabled) {
+  // process current object if enabled, unless its effects are compiled
+  if (m_enabled && (m_effectTable == NULL)) {
     // compute local interaction with current object
     computeLocalInteraction(toolPosLocal,
 			    toolVelLocal,
 			    a_IDN);
-    if(m_hapticEnabled) {
-      // compute each force effect
-      bool interactionEvent = false;
-      for (unsigned int i=0; i<m_effects.size(); i++) {
-	cGenericEffect *nextEffect = m_effects[i];
-
-	if (nextEffect -> getEnabled ()) {
-	  cVector3d force (0,0,0);
-
-	  interactionEvent = interactionEvent |
-	    nextEffect -> computeForce (toolPosLocal,
-					toolVelLocal,
-					a_IDN,
-					force);
-	  localForce.add (force);
-	}
-      }
-
-      // report any interaction
-      if (interactionEvent) {
-	cInteractionEvent newInteractionEvent;
-	newInteractionEvent.m_object = this;
-	newInteractionEvent.m_isInside = m_interactionInside;
-	newInteractionEvent.m_localPos = toolPosLocal;
-	newInteractionEvent.m_localSurfacePos = m_interactionPoint;
-	newInteractionEvent.m_localNormal = m_interactionNormal;
-	newInteractionEvent.m_localForce = localForce;
-	a_interactions.m_interactions.push_back (newInteractionEvent);
-      }
-
-      // compute any other force interactions
-      cVector3d force = computeOtherInteractions (toolPosLocal,
-						  toolVelLocal,
-						  a_IDN,
-						  a_interactions);
-
-      localForce.add(force);
-    }
+    localForce = computeEffectForces (toolPosLocal,
+				      toolVelLocal,
+				      a_IDN,
+				      a_interactions);
   }
 
-  // descend through the children
+  // descend through the children the tool is close enough to
   vector<cGenericObject*>::iterator it;
   for (it = m_children.begin (); it < m_children.end (); it++) {
+    if ((*it) -> isInteractionCulled (toolPosLocal, a_IDN)) { continue; }
     cVector3d force = (*it) -> computeInteractions (toolPosLocal,
 						    toolVelLocal,
 						    a_IDN,
@@ -2499,6 +2587,274 @@ cVector3d cGenericObject::computeInteractions (const cVector3d& a_toolPos,
 }
 
 
+//==============================================================================
+/*!
+    This method computes the forces of the effects programmed for this
+    object, once computeLocalInteraction() has located the tool, and reports
+    the interaction.
+
+    \param  a_toolPos       Position of the tool in local coordinates.
+    \param  a_toolVel       Velocity of the tool in local coordinates.
+    \param  a_IDN           Identification number of the force algorithm.
+    \param  a_interactions  List of recorded interactions.
+
+    \return Resulting force in local coordinates.
+*/
+//==============================================================================
+cVector3d cGenericObject::computeEffectForces (const cVector3d& a_toolPos,
+					       const cVector3d& a_toolVel,
+					       const unsigned int a_IDN,
+					       cInteractionRecorder& a_interactions) {
+  cVector3d localForce (0,0,0);
+  if (!m_hapticEnabled) { return (localForce); }
+
+  // compute each force effect
+  bool interactionEvent = false;
+  for (unsigned int i=0; i<m_effects.size(); i++) {
+    cGenericEffect *nextEffect = m_effects[i];
+
+    if (nextEffect -> getEnabled ()) {
+      cVector3d force (0,0,0);
+
+      interactionEvent = interactionEvent |
+	nextEffect -> computeForce (a_toolPos,
+				    a_toolVel,
+				    a_IDN,
+				    force);
+      localForce.add (force);
+    }
+  }
+
+  // report any interaction
+  if (interactionEvent) {
+    cInteractionEvent newInteractionEvent;
+    newInteractionEvent.m_object = this;
+    newInteractionEvent.m_isInside = m_interactionInside;
+    newInteractionEvent.m_localPos = a_toolPos;
+    newInteractionEvent.m_localSurfacePos = m_interactionPoint;
+    newInteractionEvent.m_localNormal = m_interactionNormal;
+    newInteractionEvent.m_localForce = localForce;
+    a_interactions.m_interactions.push_back (newInteractionEvent);
+  }
+
+  // compute any other force interactions
+  cVector3d force = computeOtherInteractions (a_toolPos,
+					      a_toolVel,
+					      a_IDN,
+					      a_interactions);
+
+  localForce.add(force);
+  return (localForce);
+}
+
+
+//==============================================================================
+/*!
+    This method updates the interaction boundary of this object: the box, in
+    the reference frame of the parent, outside of which neither this object
+    nor its children produce any interaction. It is called by
+    computeGlobalPositions() once the children are updated. Objects that
+    compute forces in computeOtherInteractions() must extend it.
+*/
+//==============================================================================
+void cGenericObject::updateInteractionBoundary()
+{
+    initInteractionBoundary();
+
+    vector<cGenericObject*>::iterator it;
+    for (it = m_children.begin(); it < m_children.end(); it++)
+    {
+        addInteractionBoundary(*it);
+    }
+
+    transformInteractionBoundary();
+}
+
+
+//==============================================================================
+/*!
+    This method starts the interaction boundary, in the reference frame of
+    this object, with the boundary box grown by the largest reach of the
+    enabled haptic effects. Objects that can locate the tool inside of them
+    beyond their boundary box (see hasBoundedInteraction()) have no boundary.
+*/
+//==============================================================================
+void cGenericObject::initInteractionBoundary()
+{
+    m_interactionBounded = m_interactionCullingEnabled;
+    m_interactionBoundaryEmpty = true;
+
+    // effects are only computed for enabled haptic objects, and compiled
+    // effects by their table
+    if (!m_enabled || !m_hapticEnabled || (m_effectTable != NULL))
+    {
+        return;
+    }
+
+    double reach = -1.0;
+    for (unsigned int i=0; i<m_effects.size(); i++)
+    {
+        if (m_effects[i]->getEnabled())
+        {
+            reach = cMax(reach, m_effects[i]->getInfluenceDistance());
+        }
+    }
+    if (reach < 0.0)
+    {
+        return;
+    }
+
+    if (!hasBoundedInteraction() || m_boundaryBoxEmpty || (reach >= C_LARGE))
+    {
+        m_interactionBounded = false;
+        return;
+    }
+
+    cVector3d margin(reach, reach, reach);
+    m_interactionBoundaryMin = m_boundaryBoxMin - margin;
+    m_interactionBoundaryMax = m_boundaryBoxMax + margin;
+    m_interactionBoundaryEmpty = false;
+}
+
+
+//==============================================================================
+/*!
+    This method extends the interaction boundary of this object with the one
+    of a child, which is expressed in the reference frame of this object.
+
+    \param  a_child  Child object.
+*/
+//==============================================================================
+void cGenericObject::addInteractionBoundary(const cGenericObject* a_child)
+{
+    // ghosts are not traversed
+    if (a_child->m_ghostEnabled)
+    {
+        return;
+    }
+
+    if (!a_child->m_interactionBounded)
+    {
+        m_interactionBounded = false;
+    }
+    else if (!a_child->m_interactionBoundaryEmpty)
+    {
+        if (m_interactionBoundaryEmpty)
+        {
+            m_interactionBoundaryMin = a_child->m_interactionBoundaryMin;
+            m_interactionBoundaryMax = a_child->m_interactionBoundaryMax;
+            m_interactionBoundaryEmpty = false;
+        }
+        else
+        {
+            for (int i=0; i<3; i++)
+            {
+                m_interactionBoundaryMin(i) = cMin(m_interactionBoundaryMin(i), a_child->m_interactionBoundaryMin(i));
+                m_interactionBoundaryMax(i) = cMax(m_interactionBoundaryMax(i), a_child->m_interactionBoundaryMax(i));
+            }
+        }
+    }
+}
+
+
+//==============================================================================
+/*!
+    This method converts the interaction boundary from the reference frame of
+    this object to the one of its parent, as the box that bounds the rotated
+    box.
+*/
+//==============================================================================
+void cGenericObject::transformInteractionBoundary()
+{
+    if (!m_interactionBounded || m_interactionBoundaryEmpty)
+    {
+        return;
+    }
+
+    cVector3d center = 0.5 * (m_interactionBoundaryMin + m_interactionBoundaryMax);
+    cVector3d halfSize = 0.5 * (m_interactionBoundaryMax - m_interactionBoundaryMin);
+    center = cAdd(m_localPos, cMul(m_localRot, center));
+
+    cVector3d extent;
+    for (int i=0; i<3; i++)
+    {
+        extent(i) = fabs(m_localRot(i,0)) * halfSize(0) +
+                    fabs(m_localRot(i,1)) * halfSize(1) +
+                    fabs(m_localRot(i,2)) * halfSize(2);
+    }
+    m_interactionBoundaryMin = center - extent;
+    m_interactionBoundaryMax = center + extent;
+}
+
+
+//==============================================================================
+/*!
+    This method tells whether computeInteractions() can skip this object and
+    its children: the tool is outside of their interaction boundary, it was
+    already outside at the previous haptic iteration of the same force
+    algorithm (so that the effects have seen it leave) and the proxy is not
+    in contact with any of them. Tools with an identification number of
+    C_EFFECT_MAX_IDN or more are never culled.
+
+    \param  a_toolPos  Position of the tool, in the reference frame of the parent.
+    \param  a_IDN      Identification number of the force algorithm.
+
+    \return __true__ if the object and its children can be skipped.
+*/
+//==============================================================================
+bool cGenericObject::isInteractionCulled(const cVector3d& a_toolPos,
+                                         const unsigned int a_IDN)
+{
+    if (a_IDN >= (unsigned int)C_EFFECT_MAX_IDN)
+    {
+        return (false);
+    }
+    if (!m_interactionBounded || (m_interactionContacts > 0))
+    {
+        m_interactionNear[a_IDN] = true;
+        return (false);
+    }
+
+    bool outside = m_interactionBoundaryEmpty;
+    for (int i=0; (i<3) && !outside; i++)
+    {
+        outside = (a_toolPos(i) < m_interactionBoundaryMin(i)) ||
+                  (a_toolPos(i) > m_interactionBoundaryMax(i));
+    }
+    if (!outside || m_interactionNear[a_IDN])
+    {
+        m_interactionNear[a_IDN] = !outside;
+        return (false);
+    }
+    return (true);
+}
+
+
+//==============================================================================
+/*!
+    This method records the start or the end of a contact between the proxy
+    and this object: while the proxy touches it, the object and its parents
+    are never skipped, even if the tool went through it.
+
+    \param  a_contact  __true__ when the contact starts, __false__ when it ends.
+*/
+//==============================================================================
+void cGenericObject::setInteractionContact(const bool a_contact)
+{
+    for (cGenericObject* object = this; object != NULL; object = object->m_parent)
+    {
+        if (a_contact)
+        {
+            object->m_interactionContacts++;
+        }
+        else if (object->m_interactionContacts > 0)
+        {
+            object->m_interactionContacts--;
+        }
+    }
+}
+
+
 //------------------------------------------------------------------------------
 } // namespace chai3d
 //------------------------------------------------------------------------------
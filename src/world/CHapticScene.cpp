@@ -0,0 +1,324 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2003-2016, CHAI3D.
+    (www.chai3d.org)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of CHAI3D nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE. 
+
+    \author    <http://www.chai3d.org>
+    \version   3.2.0 $Rev: 1869 $
+*/
+//==============================================================================
+//------------------------------------------------------------------------------
+#include "world/CHapticScene.h"
+//------------------------------------------------------------------------------
+#include "collisions/CGenericCollision.h"
+#include "world/CShapeBox.h"
+#include "world/CShapeSphere.h"
+#include "world/CVoxelObject.h"
+#include "world/CWorld.h"
+//------------------------------------------------------------------------------
+#include <typeinfo>
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+namespace chai3d {
+//------------------------------------------------------------------------------
+
+//==============================================================================
+/*!
+    Constructor of cHapticScene.
+*/
+//==============================================================================
+cHapticScene::cHapticScene()
+{
+    m_world = NULL;
+}
+
+
+//==============================================================================
+/*!
+    Destructor of cHapticScene.
+*/
+//==============================================================================
+cHapticScene::~cHapticScene()
+{
+    clear();
+}
+
+
+//==============================================================================
+/*!
+    This method flattens the scene graph of a world into arrays, in the
+    order in which the recursive traversal visits the objects.
+
+    \param  a_world  World.
+*/
+//==============================================================================
+void cHapticScene::compile(cWorld* a_world)
+{
+    clear();
+    if (a_world == NULL) { return; }
+
+    m_world = a_world;
+    flatten(a_world, -1);
+
+    int count = (int)(m_objects.size());
+    m_segmentPointsA.resize(count);
+    m_segmentPointsB.resize(count);
+}
+
+
+//==============================================================================
+/*!
+    This method adds an object to the scene and, if its type is known, its
+    descendants. The descendants of objects of other types are traversed by
+    their own methods.
+
+    \param  a_object  Object.
+    \param  a_parent  Index of the parent of the object, -1 for the world.
+*/
+//==============================================================================
+void cHapticScene::flatten(cGenericObject* a_object, const int a_parent)
+{
+    const std::type_info& type = typeid(*a_object);
+    unsigned char node = C_HAPTIC_SCENE_OTHER;
+    if (a_parent < 0)                        { node = C_HAPTIC_SCENE_ROOT; }
+    else if (type == typeid(cGenericObject)) { node = C_HAPTIC_SCENE_GROUP; }
+    else if (type == typeid(cShapeSphere))   { node = C_HAPTIC_SCENE_SPHERE; }
+    else if (type == typeid(cShapeBox))      { node = C_HAPTIC_SCENE_BOX; }
+    else if (type == typeid(cMesh))          { node = C_HAPTIC_SCENE_MESH; }
+    else if (type == typeid(cVoxelObject))   { node = C_HAPTIC_SCENE_VOXEL; }
+
+    int index = (int)(m_objects.size());
+    m_objects.push_back(a_object);
+    m_parents.push_back(a_parent);
+    m_types.push_back(node);
+    m_ends.push_back(index + 1);
+    if (node == C_HAPTIC_SCENE_OTHER) { return; }
+
+    // changes to the children invalidate the scene
+    a_object->m_hapticScene = this;
+    for (unsigned int i=0; i<a_object->m_children.size(); i++)
+    {
+        flatten(a_object->m_children[i], index);
+    }
+    m_ends[index] = (int)(m_objects.size());
+}
+
+
+//==============================================================================
+/*!
+    This method releases the objects of the scene and forgets the world.
+*/
+//==============================================================================
+void cHapticScene::clear()
+{
+    invalidate();
+    m_world = NULL;
+}
+
+
+//==============================================================================
+/*!
+    This method releases the objects of the scene. It is called when
+    children are added to or removed from an object of the scene, which is
+    then compiled again before its next traversal.
+*/
+//==============================================================================
+void cHapticScene::invalidate()
+{
+    for (unsigned int i=0; i<m_objects.size(); i++)
+    {
+        if (m_types[i] != C_HAPTIC_SCENE_OTHER)
+        {
+            m_objects[i]->m_hapticScene = NULL;
+        }
+    }
+    m_objects.clear();
+    m_parents.clear();
+    m_ends.clear();
+    m_types.clear();
+}
+
+
+//==============================================================================
+/*!
+    This method compiles the scene again if it was invalidated.
+*/
+//==============================================================================
+void cHapticScene::update()
+{
+    if (isInvalid())
+    {
+        compile(m_world);
+    }
+}
+
+
+//==============================================================================
+/*!
+    This method returns the number of objects in the scene, including the
+    world. Objects of unknown types count for one, with their descendants.
+
+    \return Number of objects.
+*/
+//==============================================================================
+int cHapticScene::getNumObjects()
+{
+    update();
+    return ((int)(m_objects.size()));
+}
+
+
+//==============================================================================
+/*!
+    This method computes the collisions between a segment and the objects of
+    the scene, as cWorld::computeCollisionDetection() does.
+
+    \param  a_segmentPointA  Start point of segment.
+    \param  a_segmentPointB  End point of segment.
+    \param  a_recorder       Recorder which stores all collision events.
+    \param  a_settings       Collision settings information.
+
+    \return __true__ if a collision has occurred, __false__ otherwise.
+*/
+//==============================================================================
+bool cHapticScene::computeCollisionDetection(const cVector3d& a_segmentPointA,
+                                             const cVector3d& a_segmentPointB,
+                                             cCollisionRecorder& a_recorder,
+                                             cCollisionSettings& a_settings)
+{
+    update();
+    if (m_world == NULL) { return (false); }
+
+    // the world only passes the segment to its children
+    m_segmentPointsA[0] = a_segmentPointA;
+    m_segmentPointsB[0] = a_segmentPointB;
+
+    bool hit = false;
+    int count = (int)(m_objects.size());
+    int i = 1;
+    while (i < count)
+    {
+        cGenericObject* object = m_objects[i];
+        int parent = m_parents[i];
+
+        // ghosts and their descendants are ignored
+        if (object->m_ghostEnabled)
+        {
+            i = m_ends[i];
+            continue;
+        }
+
+        if (m_types[i] == C_HAPTIC_SCENE_OTHER)
+        {
+            hit = hit | object->computeCollisionDetection(m_segmentPointsA[parent],
+                                                          m_segmentPointsB[parent],
+                                                          a_recorder,
+                                                          a_settings);
+            i++;
+            continue;
+        }
+
+        // convert the segment into the local coordinate frame
+        cMatrix3d transLocalRot;
+        object->m_localRot.transr(transLocalRot);
+        cVector3d& segmentPointA = m_segmentPointsA[i];
+        cVector3d& segmentPointB = m_segmentPointsB[i];
+        segmentPointA = m_segmentPointsA[parent];
+        segmentPointA.sub(object->m_localPos);
+        transLocalRot.mul(segmentPointA);
+        segmentPointB = m_segmentPointsB[parent];
+        segmentPointB.sub(object->m_localPos);
+        transLocalRot.mul(segmentPointB);
+
+        if ((object->m_enabled) &&
+            ((a_settings.m_checkVisibleObjects && object->m_showEnabled) ||
+             (a_settings.m_checkHapticObjects && object->m_hapticEnabled)))
+        {
+            // dynamic motion compensation
+            cVector3d segmentPointAadjusted;
+            if (a_settings.m_adjustObjectMotion)
+            {
+                object->cGenericObject::adjustCollisionSegment(segmentPointA, segmentPointAadjusted);
+            }
+            else
+            {
+                segmentPointAadjusted = segmentPointA;
+            }
+
+            if (object->m_collisionDetector != NULL)
+            {
+                if (object->m_collisionDetector->computeCollision(object,
+                                                                  segmentPointAadjusted,
+                                                                  segmentPointB,
+                                                                  a_recorder,
+                                                                  a_settings))
+                {
+                    hit = true;
+                }
+            }
+
+            // groups and meshes have no other collisions
+            switch (m_types[i])
+            {
+                case C_HAPTIC_SCENE_SPHERE:
+                    hit = hit | ((cShapeSphere*)object)->cShapeSphere::computeOtherCollisionDetection(
+                        segmentPointAadjusted, segmentPointB, a_recorder, a_settings);
+                    break;
+
+                case C_HAPTIC_SCENE_BOX:
+                    hit = hit | ((cShapeBox*)object)->cShapeBox::computeOtherCollisionDetection(
+                        segmentPointAadjusted, segmentPointB, a_recorder, a_settings);
+                    break;
+
+                case C_HAPTIC_SCENE_VOXEL:
+                    hit = hit | ((cVoxelObject*)object)->cVoxelObject::computeOtherCollisionDetection(
+                        segmentPointAadjusted, segmentPointB, a_recorder, a_settings);
+                    break;
+
+                default:
+                    break;
+            }
+        }
+        i++;
+    }
+
+    return (hit);
+}
+
+
+//------------------------------------------------------------------------------
+} // namespace chai3d
+//------------------------------------------------------------------------------
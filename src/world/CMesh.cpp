@@ -54,6 +54,7 @@
 #include "shaders/CShaderProgram.h"
 //------------------------------------------------------------------------------
 #include <algorithm>
+#include <cstdio>
 #include <vector>
 #include <list>
 #include <utility>
@@ -464,6 +465,61 @@ bool cMesh::removeTriangle(const unsigned int a_index)
 }
 
 
+//==============================================================================
+/*!
+    This method removes the triangles that were removed by \ref removeTriangle()
+    and the vertices that are no longer used by any triangle. The remaining
+    triangles and vertices are renumbered, so that memory and collision
+    queries depend only on the geometry that is left. Edges are cleared.\n
+
+    Indices of triangles and vertices kept by the application are no longer
+    valid after calling this method.
+
+    \param  a_updateCollisionDetector  If __true__, then update collision detector.
+*/
+//==============================================================================
+void cMesh::compress(const bool a_updateCollisionDetector)
+{
+    // remove non allocated triangles
+    m_triangles->compress();
+
+    // find vertices used by the remaining triangles
+    unsigned int numVertices = m_vertices->getNumElements();
+    vector<bool> used(numVertices, false);
+    vector<unsigned int>& indices = m_triangles->m_indices;
+    for (size_t i=0; i<indices.size(); i++)
+    {
+        used[indices[i]] = true;
+    }
+
+    // remove unused vertices and remap triangle indices
+    vector<int> newIndices;
+    if (m_vertices->compress(used, newIndices) > 0)
+    {
+        for (size_t i=0; i<indices.size(); i++)
+        {
+            indices[i] = newIndices[indices[i]];
+        }
+        m_triangles->m_flagMarkForUpdate = true;
+    }
+
+    // clear edges
+    clearAllEdges();
+
+    // update boundary box
+    updateBoundaryBox();
+
+    // update collision detector if requested
+    if (a_updateCollisionDetector && m_collisionDetector)
+    {
+        m_collisionDetector->update();
+    }
+
+    // mark mesh for update
+    markForUpdate(false);
+}
+
+
 //==============================================================================
 /*!
     This method clears all triangles and vertices.
@@ -497,11 +553,9 @@ void cMesh::computeAllNormals()
     unsigned int numTriangles = m_triangles->getNumElements();
     unsigned int numVertices = m_vertices->getNumElements();
 
-    // initialize all normals to zero
-    for (unsigned int i=0; i<numVertices; i++)
-    {
-        m_vertices->setNormal(i, 0, 0, 0);
-    }
+    // initialize all normals to zero (they are summed in double precision,
+    // whatever the storage of the vertices)
+    vector<cVector3d> normals(numVertices, cVector3d(0.0, 0.0, 0.0));
 
     // compute the normal of each triangle, add contribution to each vertex
     for (unsigned int i=0; i<numTriangles; i++)
@@ -523,19 +577,20 @@ void cMesh::computeAllNormals()
         if (length > 0.0)
         {
             normal.div(length);
-            m_vertices->m_normal[vertexIndex0].add(normal);
-            m_vertices->m_normal[vertexIndex1].add(normal);
-            m_vertices->m_normal[vertexIndex2].add(normal);
+            normals[vertexIndex0].add(normal);
+            normals[vertexIndex1].add(normal);
+            normals[vertexIndex2].add(normal);
         }
     }
 
     // normalize all triangles
     for (unsigned int i=0; i<numVertices; i++)
     {
-        if (m_vertices->m_normal[i].length() > 0.000000001)
+        if (normals[i].length() > 0.000000001)
         {
-            m_vertices->m_normal[i].normalize();
+            normals[i].normalize();
         }
+        m_vertices->setNormal(i, normals[i]);
     }
 }
 
@@ -563,12 +618,10 @@ void cMesh::computeBTN()
 //==============================================================================
 void cMesh::scaleXYZ(const double a_scaleX, const double a_scaleY, const double a_scaleZ)
 {
-    int numVertices = m_vertices->getNumElements();
-
-    for (int i=0; i<numVertices; i++)
-    {
-        m_vertices->m_localPos[i].mul(a_scaleX, a_scaleY, a_scaleZ);
-    }
+    m_vertices->transformLocalPositions(cMatrix3d(a_scaleX, 0.0, 0.0,
+                                                  0.0, a_scaleY, 0.0,
+                                                  0.0, 0.0, a_scaleZ),
+                                        cVector3d(0.0, 0.0, 0.0));
 
     m_boundaryBoxMax.mul(a_scaleX, a_scaleY, a_scaleZ);
     m_boundaryBoxMin.mul(a_scaleX, a_scaleY, a_scaleZ);
@@ -589,12 +642,7 @@ void cMesh::updateGlobalPositions(const bool a_frameOnly)
 {
     if (a_frameOnly) return;
 
-    int numVertices = m_vertices->getNumElements();
-
-    for (int i=0; i<numVertices; i++)
-    {
-        m_vertices->computeGlobalPosition(i, m_globalPos, m_globalRot);
-    }
+    m_vertices->computeGlobalPositions(m_globalPos, m_globalRot);
 }
 
 
@@ -645,7 +693,9 @@ void cMesh::setTransparencyLevel(const float a_level,
         int numVertices = m_vertices->getNumElements();
         for (int i = 0; i < numVertices; i++)
         {
-            m_vertices->m_color[i].setA(a_level);
+            cColorf color = m_vertices->getColor(i);
+            color.setA(a_level);
+            m_vertices->setColor(i, color);
         }
 
         // mark for update
@@ -688,12 +738,7 @@ void cMesh::offsetVertices(const cVector3d& a_offset,
                            const bool a_updateCollisionDetector)
 {
     // offset all vertices
-    int numVertices = m_vertices->getNumElements();
-
-    for (int i=0; i<numVertices; i++)
-    {
-        m_vertices->m_localPos[i].add(a_offset);
-    }
+    m_vertices->transformLocalPositions(cIdentity3d(), a_offset);
 
     // update boundary box
     m_boundaryBoxMin+=a_offset;
@@ -724,7 +769,7 @@ void cMesh::reverseAllNormals()
 
     for (int i=0; i<numVertices; i++)
     {
-        m_vertices->m_normal[i].negate();
+        m_vertices->setNormal(i, -m_vertices->getNormal(i));
     }
 }
 
@@ -1004,7 +1049,7 @@ void cMesh::createBruteForceCollisionDetector()
     }
 
     // create brute collision detector
-    m_collisionDetector = new cCollisionBrute(m_triangles);
+    m_collisionDetector = cArena::create<cCollisionBrute>(m_arena, m_triangles);
 }
 
 
@@ -1025,7 +1070,7 @@ void cMesh::createAABBCollisionDetector(const double a_radius)
     }
 
     // create AABB and initialize collision detector
-    cCollisionAABB* collisionDetector = new cCollisionAABB();
+    cCollisionAABB* collisionDetector = cArena::create<cCollisionAABB>(m_arena);
     collisionDetector->initialize(m_triangles, a_radius);
 
     // assign new collision detector
@@ -1033,6 +1078,60 @@ void cMesh::createAABBCollisionDetector(const double a_radius)
 }
 
 
+//==============================================================================
+/*!
+    This method builds an AABB collision detector for this mesh, reusing a
+    tree saved in a cache directory if available. \n\n
+
+    Trees are stored in files named after a hash of the triangles and of the
+    radius, so that any change to the geometry selects a different file. If
+    no valid file exists, the tree is built and saved for the next call.
+    The cache directory must exist. \n\n
+
+    Only the tree is cached. The vertices and triangles stay those of the
+    mesh: they are loaded with the model and needed anyway to compute the
+    hash, so storing them again would not save any work.
+
+    \param  a_radius          Bounding radius.
+    \param  a_cacheDirectory  Directory where collision trees are cached.
+*/
+//==============================================================================
+void cMesh::createAABBCollisionDetector(const double a_radius,
+                                        const std::string& a_cacheDirectory)
+{
+    // no cache
+    if (a_cacheDirectory.empty())
+    {
+        createAABBCollisionDetector(a_radius);
+        return;
+    }
+
+    // delete previous collision detector
+    if (m_collisionDetector != NULL)
+    {
+        delete m_collisionDetector;
+        m_collisionDetector = NULL;
+    }
+
+    // name of cached tree
+    unsigned long long hash = cCollisionAABB::computeHash(m_triangles, a_radius);
+    char name[32];
+    snprintf(name, sizeof(name), "aabb-%016llx.bin", hash);
+    string filename = a_cacheDirectory + "/" + name;
+
+    // load cached tree, or build and save it
+    cCollisionAABB* collisionDetector = cArena::create<cCollisionAABB>(m_arena);
+    if (!collisionDetector->loadFromFile(m_triangles, a_radius, filename, hash))
+    {
+        collisionDetector->initialize(m_triangles, a_radius);
+        collisionDetector->saveToFile(filename, hash);
+    }
+
+    // assign new collision detector
+    m_collisionDetector = collisionDetector;
+}
+
+
 //==============================================================================
 /*!
     This method uses the position of the tool and searches for the nearest point
@@ -1565,16 +1664,16 @@ void cMesh::renderMesh(cRenderOptions& a_options)
                         unsigned int index2 = m_triangles->getVertexIndex2(i);
 
                         // render vertex 0
-                        glNormal3dv(&m_vertices->m_normal[index0](0));
-                        glVertex3dv(&m_vertices->m_localPos[index0](0));
+                        glNormal3dv(&m_vertices->getNormal(index0)(0));
+                        glVertex3dv(&m_vertices->getLocalPos(index0)(0));
 
                         // render vertex 1
-                        glNormal3dv(&m_vertices->m_normal[index1](0));
-                        glVertex3dv(&m_vertices->m_localPos[index1](0));
+                        glNormal3dv(&m_vertices->getNormal(index1)(0));
+                        glVertex3dv(&m_vertices->getLocalPos(index1)(0));
 
                         // render vertex 2
-                        glNormal3dv(&m_vertices->m_normal[index2](0));
-                        glVertex3dv(&m_vertices->m_localPos[index2](0));
+                        glNormal3dv(&m_vertices->getNormal(index2)(0));
+                        glVertex3dv(&m_vertices->getLocalPos(index2)(0));
                     }
                 }
             }
@@ -1591,19 +1690,19 @@ void cMesh::renderMesh(cRenderOptions& a_options)
                             unsigned int index2 = m_triangles->getVertexIndex2(i);
 
                             // render vertex 0
-                            glNormal3dv(&m_vertices->m_normal[index0](0));
-                            glMultiTexCoord3dv(textureUnit, &m_vertices->m_texCoord[index0](0));
-                            glVertex3dv(&m_vertices->m_localPos[index0](0));
+                            glNormal3dv(&m_vertices->getNormal(index0)(0));
+                            glMultiTexCoord3dv(textureUnit, &m_vertices->getTexCoord(index0)(0));
+                            glVertex3dv(&m_vertices->getLocalPos(index0)(0));
 
                             // render vertex 1
-                            glNormal3dv(&m_vertices->m_normal[index1](0));
-                            glMultiTexCoord3dv(textureUnit, &m_vertices->m_texCoord[index1](0));
-                            glVertex3dv(&m_vertices->m_localPos[index1](0));
+                            glNormal3dv(&m_vertices->getNormal(index1)(0));
+                            glMultiTexCoord3dv(textureUnit, &m_vertices->getTexCoord(index1)(0));
+                            glVertex3dv(&m_vertices->getLocalPos(index1)(0));
 
                             // render vertex 2
-                            glNormal3dv(&m_vertices->m_normal[index2](0));
-                            glMultiTexCoord3dv(textureUnit, &m_vertices->m_texCoord[index2](0));
-                            glVertex3dv(&m_vertices->m_localPos[index2](0));
+                            glNormal3dv(&m_vertices->getNormal(index2)(0));
+                            glMultiTexCoord3dv(textureUnit, &m_vertices->getTexCoord(index2)(0));
+                            glVertex3dv(&m_vertices->getLocalPos(index2)(0));
                         }
                     }
                 }
@@ -1618,19 +1717,19 @@ void cMesh::renderMesh(cRenderOptions& a_options)
                             unsigned int index2 = m_triangles->getVertexIndex2(i);
 
                             // render vertex 0
-                            glNormal3dv(&m_vertices->m_normal[index0](0));
-                            glMultiTexCoord2dv(textureUnit, &m_vertices->m_texCoord[index0](0));
-                            glVertex3dv(&m_vertices->m_localPos[index0](0));
+                            glNormal3dv(&m_vertices->getNormal(index0)(0));
+                            glMultiTexCoord2dv(textureUnit, &m_vertices->getTexCoord(index0)(0));
+                            glVertex3dv(&m_vertices->getLocalPos(index0)(0));
 
                             // render vertex 1
-                            glNormal3dv(&m_vertices->m_normal[index1](0));
-                            glMultiTexCoord2dv(textureUnit, &m_vertices->m_texCoord[index1](0));
-                            glVertex3dv(&m_vertices->m_localPos[index1](0));
+                            glNormal3dv(&m_vertices->getNormal(index1)(0));
+                            glMultiTexCoord2dv(textureUnit, &m_vertices->getTexCoord(index1)(0));
+                            glVertex3dv(&m_vertices->getLocalPos(index1)(0));
 
                             // render vertex 2
-                            glNormal3dv(&m_vertices->m_normal[index2](0));
-                            glMultiTexCoord2dv(textureUnit, &m_vertices->m_texCoord[index2](0));
-                            glVertex3dv(&m_vertices->m_localPos[index2](0));
+                            glNormal3dv(&m_vertices->getNormal(index2)(0));
+                            glMultiTexCoord2dv(textureUnit, &m_vertices->getTexCoord(index2)(0));
+                            glVertex3dv(&m_vertices->getLocalPos(index2)(0));
                         }
                     }
                 }
@@ -1647,19 +1746,19 @@ void cMesh::renderMesh(cRenderOptions& a_options)
                         unsigned int index2 = m_triangles->getVertexIndex2(i);
 
                         // render vertex 0
-                        glNormal3dv(&m_vertices->m_normal[index0](0));
-                        glColor4fv(m_vertices->m_color[index0].getData());
-                        glVertex3dv(&m_vertices->m_localPos[index0](0));
+                        glNormal3dv(&m_vertices->getNormal(index0)(0));
+                        glColor4fv(m_vertices->getColor(index0).getData());
+                        glVertex3dv(&m_vertices->getLocalPos(index0)(0));
 
                         // render vertex 1
-                        glNormal3dv(&m_vertices->m_normal[index1](0));
-                        glColor4fv(m_vertices->m_color[index1].getData());
-                        glVertex3dv(&m_vertices->m_localPos[index1](0));
+                        glNormal3dv(&m_vertices->getNormal(index1)(0));
+                        glColor4fv(m_vertices->getColor(index1).getData());
+                        glVertex3dv(&m_vertices->getLocalPos(index1)(0));
 
                         // render vertex 2
-                        glNormal3dv(&m_vertices->m_normal[index2](0));
-                        glColor4fv(m_vertices->m_color[index2].getData());
-                        glVertex3dv(&m_vertices->m_localPos[index2](0));
+                        glNormal3dv(&m_vertices->getNormal(index2)(0));
+                        glColor4fv(m_vertices->getColor(index2).getData());
+                        glVertex3dv(&m_vertices->getLocalPos(index2)(0));
                     }
                 }
             }
@@ -1676,22 +1775,22 @@ void cMesh::renderMesh(cRenderOptions& a_options)
                             unsigned int index2 = m_triangles->getVertexIndex2(i);
 
                             // render vertex 0
-                            glNormal3dv(&m_vertices->m_normal[index0](0));
-                            glColor4fv(m_vertices->m_color[index0].getData());
-                            glMultiTexCoord3dv(textureUnit, &m_vertices->m_texCoord[index0](0));
-                            glVertex3dv(&m_vertices->m_localPos[index0](0));
+                            glNormal3dv(&m_vertices->getNormal(index0)(0));
+                            glColor4fv(m_vertices->getColor(index0).getData());
+                            glMultiTexCoord3dv(textureUnit, &m_vertices->getTexCoord(index0)(0));
+                            glVertex3dv(&m_vertices->getLocalPos(index0)(0));
 
                             // render vertex 1
-                            glNormal3dv(&m_vertices->m_normal[index1](0));
-                            glColor4fv(m_vertices->m_color[index1].getData());
-                            glMultiTexCoord3dv(textureUnit, &m_vertices->m_texCoord[index1](0));
-                            glVertex3dv(&m_vertices->m_localPos[index1](0));
+                            glNormal3dv(&m_vertices->getNormal(index1)(0));
+                            glColor4fv(m_vertices->getColor(index1).getData());
+                            glMultiTexCoord3dv(textureUnit, &m_vertices->getTexCoord(index1)(0));
+                            glVertex3dv(&m_vertices->getLocalPos(index1)(0));
 
                             // render vertex 2
-                            glNormal3dv(&m_vertices->m_normal[index2](0));
-                            glColor4fv(m_vertices->m_color[index2].getData());
-                            glMultiTexCoord3dv(textureUnit, &m_vertices->m_texCoord[index2](0));
-                            glVertex3dv(&m_vertices->m_localPos[index2](0));
+                            glNormal3dv(&m_vertices->getNormal(index2)(0));
+                            glColor4fv(m_vertices->getColor(index2).getData());
+                            glMultiTexCoord3dv(textureUnit, &m_vertices->getTexCoord(index2)(0));
+                            glVertex3dv(&m_vertices->getLocalPos(index2)(0));
                         }
                     }
                 }
@@ -1706,22 +1805,22 @@ void cMesh::renderMesh(cRenderOptions& a_options)
                             unsigned int index2 = m_triangles->getVertexIndex2(i);
 
                             // render vertex 0
-                            glNormal3dv(&m_vertices->m_normal[index0](0));
-                            glColor4fv(m_vertices->m_color[index0].getData());
-                            glMultiTexCoord2dv(textureUnit, &m_vertices->m_texCoord[index0](0));
-                            glVertex3dv(&m_vertices->m_localPos[index0](0));
+                            glNormal3dv(&m_vertices->getNormal(index0)(0));
+                            glColor4fv(m_vertices->getColor(index0).getData());
+                            glMultiTexCoord2dv(textureUnit, &m_vertices->getTexCoord(index0)(0));
+                            glVertex3dv(&m_vertices->getLocalPos(index0)(0));
 
                             // render vertex 1
-                            glNormal3dv(&m_vertices->m_normal[index1](0));
-                            glColor4fv(m_vertices->m_color[index1].getData());
-                            glMultiTexCoord2dv(textureUnit, &m_vertices->m_texCoord[index1](0));
-                            glVertex3dv(&m_vertices->m_localPos[index1](0));
+                            glNormal3dv(&m_vertices->getNormal(index1)(0));
+                            glColor4fv(m_vertices->getColor(index1).getData());
+                            glMultiTexCoord2dv(textureUnit, &m_vertices->getTexCoord(index1)(0));
+                            glVertex3dv(&m_vertices->getLocalPos(index1)(0));
 
                             // render vertex 2
-                            glNormal3dv(&m_vertices->m_normal[index2](0));
-                            glColor4fv(m_vertices->m_color[index2].getData());
-                            glMultiTexCoord2dv(textureUnit, &m_vertices->m_texCoord[index2](0));
-                            glVertex3dv(&m_vertices->m_localPos[index2](0));
+                            glNormal3dv(&m_vertices->getNormal(index2)(0));
+                            glColor4fv(m_vertices->getColor(index2).getData());
+                            glMultiTexCoord2dv(textureUnit, &m_vertices->getTexCoord(index2)(0));
+                            glVertex3dv(&m_vertices->getLocalPos(index2)(0));
                         }
                     }
                 }
@@ -216,6 +216,30 @@ void cMultiMesh::setHapticEnabled(const bool a_hapticEnabled,
 }
 
 
+//==============================================================================
+/*!
+    This method enables or disables skipping this object and its meshes when
+    the tool is beyond the reach of their haptic effects.
+
+    \param  a_enabled         If __true__, then the object may be skipped.
+    \param  a_affectChildren  If __true__, then children are updated too.
+*/
+//==============================================================================
+void cMultiMesh::setInteractionCullingEnabled(const bool a_enabled, 
+                                              const bool a_affectChildren)
+{
+    // update current object and possibly children
+    cGenericObject::setInteractionCullingEnabled(a_enabled, a_affectChildren);
+
+    // update meshes
+    vector<cMesh*>::iterator it;
+    for (it = m_meshes->begin(); it < m_meshes->end(); it++)
+    {
+        (*it)->setInteractionCullingEnabled(a_enabled, true);
+    }
+}
+
+
 //==============================================================================
 /*!
      This method sets the haptic stiffness for this object, optionally recursively 
@@ -1070,16 +1094,11 @@ void cMultiMesh::scaleXYZ(const double a_scaleX, const double a_scaleY, const do
         cMatrix3d b_R_a = cTranspose(a_R_b);
 
         // scale vertices
-        unsigned int numVertices = (*it)->m_vertices->getNumElements();
-        for (unsigned int i=0; i<numVertices; i++)
-        {
-            cVector3d b_Vertex =  (*it)->m_vertices->getLocalPos(i);
-            cVector3d a_Vertex = a_R_b *  b_Vertex;
-            a_Vertex = a_R_b * b_Vertex;
-            a_Vertex.mul(a_scaleX, a_scaleY, a_scaleZ);
-            b_Vertex = b_R_a * a_Vertex;
-            (*it)->m_vertices->setLocalPos(i, b_Vertex);
-        }
+        cMatrix3d scale(a_scaleX, 0.0, 0.0,
+                        0.0, a_scaleY, 0.0,
+                        0.0, 0.0, a_scaleZ);
+        (*it)->m_vertices->transformLocalPositions(b_R_a * scale * a_R_b,
+                                                   cVector3d(0.0, 0.0, 0.0));
 
         // scale position
         (*it)->m_localPos.mul(a_scaleX, a_scaleY, a_scaleZ);
@@ -1114,7 +1133,7 @@ void cMultiMesh::scaleXYZ(const double a_scaleX, const double a_scaleY, const do
 cMesh* cMultiMesh::newMesh()
 {
     // create new mesh entity
-    cMesh* obj = new cMesh();
+    cMesh* obj = cArena::create<cMesh>(m_arena);
 
     // set parent and owner
     obj->setParent(this);
@@ -1406,6 +1425,24 @@ unsigned int cMultiMesh::getNumTriangles() const
 }
 
 
+//==============================================================================
+/*!
+    This method removes unused triangles and vertices from all meshes that
+    compose this multi-mesh, and renumbers the remaining ones.
+
+    \param  a_updateCollisionDetector  If __true__, then update collision detectors.
+*/
+//==============================================================================
+void cMultiMesh::compress(const bool a_updateCollisionDetector)
+{
+    vector<cMesh*>::iterator it;
+    for (it = m_meshes->begin(); it < m_meshes->end(); it++)
+    {
+        (*it)->compress(a_updateCollisionDetector);
+    }
+}
+
+
 //==============================================================================
 /*!
     This method returns the position data of specific vertex.
@@ -1821,6 +1858,32 @@ void cMultiMesh::updateGlobalPositions(const bool a_frameOnly)
 }
 
 
+//==============================================================================
+/*!
+    This method updates the interaction boundary of this object from its
+    effects, its meshes and its children.
+*/
+//==============================================================================
+void cMultiMesh::updateInteractionBoundary()
+{
+    initInteractionBoundary();
+
+    vector<cMesh*>::iterator itMesh;
+    for (itMesh = m_meshes->begin(); itMesh < m_meshes->end(); itMesh++)
+    {
+        addInteractionBoundary(*itMesh);
+    }
+
+    vector<cGenericObject*>::iterator it;
+    for (it = m_children.begin(); it < m_children.end(); it++)
+    {
+        addInteractionBoundary(*it);
+    }
+
+    transformInteractionBoundary();
+}
+
+
 //==============================================================================
 /*!
     This method sets the color of each vertex.
@@ -1940,6 +2003,26 @@ void cMultiMesh::createAABBCollisionDetector(const double a_radius)
 }
 
 
+//==============================================================================
+/*!
+    This method builds an AABB collision detector for each mesh, reusing trees
+    saved in a cache directory if available.
+
+    \param  a_radius          Bounding radius.
+    \param  a_cacheDirectory  Directory where collision trees are cached.
+*/
+//==============================================================================
+void cMultiMesh::createAABBCollisionDetector(const double a_radius,
+                                             const std::string& a_cacheDirectory)
+{
+    vector<cMesh*>::iterator it;
+    for (it = m_meshes->begin(); it < m_meshes->end(); it++)
+    {
+        (*it)->createAABBCollisionDetector(a_radius, a_cacheDirectory);
+    }
+}
+
+
 //==============================================================================
 /*!
     This message renders this multi-mesh using OpenGL.
@@ -2043,11 +2126,12 @@ cVector3d cMultiMesh::computeInteractions(const cVector3d& a_toolPos,
         }
     }
 
-    // descend through the meshes
+    // descend through the meshes the tool is close enough to
     {
         vector<cMesh*>::iterator it;
         for (it = m_meshes->begin(); it < m_meshes->end(); it++)
         {
+            if ((*it)->isInteractionCulled(toolPosLocal, a_IDN)) { continue; }
             cVector3d force = (*it)->computeInteractions(toolPosLocal,
                                                          toolVelLocal,
                                                          a_IDN,
@@ -2056,11 +2140,12 @@ cVector3d cMultiMesh::computeInteractions(const cVector3d& a_toolPos,
         }
     }
 
-    // descend through the children
+    // descend through the children the tool is close enough to
     {
         vector<cGenericObject*>::iterator it;
         for (it = m_children.begin(); it < m_children.end(); it++)
         {
+            if ((*it)->isInteractionCulled(toolPosLocal, a_IDN)) { continue; }
             cVector3d force = (*it)->computeInteractions(toolPosLocal,
                                                          toolVelLocal,
                                                          a_IDN,
@@ -388,12 +388,10 @@ void cMultiPoint::clear()
 //==============================================================================
 void cMultiPoint::scaleXYZ(const double a_scaleX, const double a_scaleY, const double a_scaleZ)
 {
-    int numVertices = m_vertices->getNumElements();
-
-    for (int i=0; i<numVertices; i++)
-    {
-        m_vertices->m_localPos[i].mul(a_scaleX, a_scaleY, a_scaleZ);
-    }
+    m_vertices->transformLocalPositions(cMatrix3d(a_scaleX, 0.0, 0.0,
+                                                  0.0, a_scaleY, 0.0,
+                                                  0.0, 0.0, a_scaleZ),
+                                        cVector3d(0.0, 0.0, 0.0));
 
     m_boundaryBoxMax.mul(a_scaleX, a_scaleY, a_scaleZ);
     m_boundaryBoxMin.mul(a_scaleX, a_scaleY, a_scaleZ);
@@ -411,12 +409,7 @@ void cMultiPoint::updateGlobalPositions(const bool a_frameOnly)
 {
     if (a_frameOnly) return;
 
-    int numVertices = m_vertices->getNumElements();
-
-    for (int i=0; i<numVertices; i++)
-    {
-        m_vertices->computeGlobalPosition(i, m_globalPos, m_globalRot);
-    }
+    m_vertices->computeGlobalPositions(m_globalPos, m_globalRot);
 }
 
 
@@ -463,7 +456,9 @@ void cMultiPoint::setTransparencyLevel(const float a_level,
         int numVertices = m_vertices->getNumElements();
         for (int i = 0; i < numVertices; i++)
         {
-            m_vertices->m_color[i].setA(a_level);
+            cColorf color = m_vertices->getColor(i);
+            color.setA(a_level);
+            m_vertices->setColor(i, color);
         }
 
         // mark for update
@@ -503,12 +498,7 @@ void cMultiPoint::offsetVertices(const cVector3d& a_offset,
                                  const bool a_updateCollisionDetector)
 {
     // offset all vertices
-    int numVertices = m_vertices->getNumElements();
-
-    for (int i=0; i<numVertices; i++)
-    {
-        m_vertices->m_localPos[i].add(a_offset);
-    }
+    m_vertices->transformLocalPositions(cIdentity3d(), a_offset);
 
     // update boundary box
     m_boundaryBoxMin+=a_offset;
@@ -595,7 +585,7 @@ void cMultiPoint::createBruteForceCollisionDetector()
     }
 
     // create brute collision detector
-    m_collisionDetector = new cCollisionBrute(m_points);
+    m_collisionDetector = cArena::create<cCollisionBrute>(m_arena, m_points);
 }
 
 
@@ -616,7 +606,7 @@ void cMultiPoint::createAABBCollisionDetector(const double a_radius)
     }
 
     // create AABB collision detector
-    cCollisionAABB* collisionDetector = new cCollisionAABB();
+    cCollisionAABB* collisionDetector = cArena::create<cCollisionAABB>(m_arena);
     collisionDetector->initialize(m_points, a_radius);
 
     // assign new collision detector
@@ -894,8 +884,8 @@ void cMultiPoint::renderPoints(cRenderOptions& a_options)
                     unsigned int index0 = m_points->getVertexIndex0(i);
      
                     // render vertex 0
-                    glColor4fv(m_vertices->m_color[index0].getData());
-                    glVertex3dv(&m_vertices->m_localPos[index0](0));
+                    glColor4fv(m_vertices->getColor(index0).getData());
+                    glVertex3dv(&m_vertices->getLocalPos(index0)(0));
                 }
             }
 
@@ -402,12 +402,10 @@ void cMultiSegment::clear()
 //==============================================================================
 void cMultiSegment::scaleXYZ(const double a_scaleX, const double a_scaleY, const double a_scaleZ)
 {
-    int numVertices = m_vertices->getNumElements();
-
-    for (int i=0; i<numVertices; i++)
-    {
-        m_vertices->m_localPos[i].mul(a_scaleX, a_scaleY, a_scaleZ);
-    }
+    m_vertices->transformLocalPositions(cMatrix3d(a_scaleX, 0.0, 0.0,
+                                                  0.0, a_scaleY, 0.0,
+                                                  0.0, 0.0, a_scaleZ),
+                                        cVector3d(0.0, 0.0, 0.0));
 
     m_boundaryBoxMax.mul(a_scaleX, a_scaleY, a_scaleZ);
     m_boundaryBoxMin.mul(a_scaleX, a_scaleY, a_scaleZ);
@@ -425,12 +423,7 @@ void cMultiSegment::updateGlobalPositions(const bool a_frameOnly)
 {
     if (a_frameOnly) return;
 
-    int numVertices = m_vertices->getNumElements();
-
-    for (int i=0; i<numVertices; i++)
-    {
-        m_vertices->computeGlobalPosition(i, m_globalPos, m_globalRot);
-    }
+    m_vertices->computeGlobalPositions(m_globalPos, m_globalRot);
 }
 
 
@@ -477,7 +470,9 @@ void cMultiSegment::setTransparencyLevel(const float a_level,
         int numVertices = m_vertices->getNumElements();
         for (int i = 0; i < numVertices; i++)
         {
-            m_vertices->m_color[i].setA(a_level);
+            cColorf color = m_vertices->getColor(i);
+            color.setA(a_level);
+            m_vertices->setColor(i, color);
         }
 
         // mark for update
@@ -517,12 +512,7 @@ void cMultiSegment::offsetVertices(const cVector3d& a_offset,
                                    const bool a_updateCollisionDetector)
 {
     // offset all vertices
-    int numVertices = m_vertices->getNumElements();
-
-    for (int i=0; i<numVertices; i++)
-    {
-        m_vertices->m_localPos[i].add(a_offset);
-    }
+    m_vertices->transformLocalPositions(cIdentity3d(), a_offset);
 
     // update boundary box
     m_boundaryBoxMin+=a_offset;
@@ -618,7 +608,7 @@ void cMultiSegment::createBruteForceCollisionDetector()
     }
 
     // create brute collision detector
-    m_collisionDetector = new cCollisionBrute(m_segments);
+    m_collisionDetector = cArena::create<cCollisionBrute>(m_arena, m_segments);
 }
 
 
@@ -640,7 +630,7 @@ void cMultiSegment::createAABBCollisionDetector(const double a_radius)
     }
 
     // create AABB collision detector
-    cCollisionAABB* collisionDetector = new cCollisionAABB();
+    cCollisionAABB* collisionDetector = cArena::create<cCollisionAABB>(m_arena);
     collisionDetector->initialize(m_segments, a_radius);
 
     // assign new collision detector
@@ -827,12 +817,12 @@ void cMultiSegment::renderSegments(cRenderOptions& a_options)
                     unsigned int index1 = m_segments->getVertexIndex1(i);
 
                     // render vertex 0
-                    glColor4fv(m_vertices->m_color[index0].getData());
-                    glVertex3dv(&m_vertices->m_localPos[index0](0));
+                    glColor4fv(m_vertices->getColor(index0).getData());
+                    glVertex3dv(&m_vertices->getLocalPos(index0)(0));
 
                     // render vertex 1
-                    glColor4fv(m_vertices->m_color[index1].getData());
-                    glVertex3dv(&m_vertices->m_localPos[index1](0));
+                    glColor4fv(m_vertices->getColor(index1).getData());
+                    glVertex3dv(&m_vertices->getLocalPos(index1)(0));
                 }
             }
 
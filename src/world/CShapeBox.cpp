@@ -397,6 +397,7 @@ void cShapeBox::updateBoundaryBox()
     // compute half size lengths
     m_boundaryBoxMin.set(-m_hSizeX,-m_hSizeY,-m_hSizeZ);
     m_boundaryBoxMax.set( m_hSizeX, m_hSizeY, m_hSizeZ);
+    m_boundaryBoxEmpty = false;
 }
 
 
@@ -0,0 +1,937 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2003-2016, CHAI3D.
+    (www.chai3d.org)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of CHAI3D nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE. 
+
+    \author    <http://www.chai3d.org>
+    \version   3.2.0 $Rev: 1869 $
+*/
+//==============================================================================
+
+//------------------------------------------------------------------------------
+#include "world/CSignedDistanceField.h"
+#include "collisions/CCollisionAABB.h"
+#include "math/CMaths.h"
+#include "system/CMappedFile.h"
+#include "system/CThread.h"
+//------------------------------------------------------------------------------
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+namespace chai3d {
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+// definitions of the class constants, which are bound to references
+// (std::vector::assign, std::fill) and therefore need storage
+//------------------------------------------------------------------------------
+
+const int cSignedDistanceField::C_SDF_BRICK_WIDTH;
+const int cSignedDistanceField::C_SDF_BRICK_NODES;
+const int cSignedDistanceField::C_SDF_BRICK_OUTSIDE;
+const int cSignedDistanceField::C_SDF_BRICK_INSIDE;
+
+//------------------------------------------------------------------------------
+// distance field files
+//------------------------------------------------------------------------------
+
+// increment whenever the file layout or the field construction changes
+static const unsigned int C_SDF_FILE_VERSION = 1;
+
+// detects files written on a platform with a different byte order
+static const unsigned int C_SDF_FILE_ENDIANNESS = 0x01020304;
+
+// header of a distance field file, followed by the brick indices and the
+// nodes of the stored bricks
+struct cSignedDistanceFieldFileHeader
+{
+    char m_magic[8];
+    unsigned int m_version;
+    unsigned int m_endianness;
+    int m_brickSize;
+    int m_numCells[3];
+    int m_numStoredBricks;
+    int m_reserved;
+    unsigned long long m_hash;
+    double m_origin[3];
+    double m_cellSize;
+    double m_bandWidth;
+};
+
+static const char C_SDF_FILE_MAGIC[8] = { 'C', 'H', 'A', 'I', 'S', 'D', 'F', '1' };
+
+// largest number of bricks of a field
+static const size_t C_SDF_MAX_BRICKS = (size_t)1 << 24;
+
+// squared distance from a point to a triangle
+static double cDistanceSqPointTriangle(const cVector3d& a_point,
+                                       const cVector3d& a_vertex0,
+                                       const cVector3d& a_vertex1,
+                                       const cVector3d& a_vertex2)
+{
+    // region of the nearest point, see Ericson, Real-Time Collision Detection, 5.1.5
+    cVector3d ab = a_vertex1 - a_vertex0;
+    cVector3d ac = a_vertex2 - a_vertex0;
+    cVector3d ap = a_point - a_vertex0;
+    double d1 = ab.dot(ap);
+    double d2 = ac.dot(ap);
+    if ((d1 <= 0.0) && (d2 <= 0.0)) { return (ap.lengthsq()); }
+
+    cVector3d bp = a_point - a_vertex1;
+    double d3 = ab.dot(bp);
+    double d4 = ac.dot(bp);
+    if ((d3 >= 0.0) && (d4 <= d3)) { return (bp.lengthsq()); }
+
+    double vc = d1 * d4 - d3 * d2;
+    if ((vc <= 0.0) && (d1 >= 0.0) && (d3 <= 0.0))
+    {
+        double v = d1 / (d1 - d3);
+        return (cDistanceSq(a_point, a_vertex0 + v * ab));
+    }
+
+    cVector3d cp = a_point - a_vertex2;
+    double d5 = ab.dot(cp);
+    double d6 = ac.dot(cp);
+    if ((d6 >= 0.0) && (d5 <= d6)) { return (cp.lengthsq()); }
+
+    double vb = d5 * d2 - d1 * d6;
+    if ((vb <= 0.0) && (d2 >= 0.0) && (d6 <= 0.0))
+    {
+        double w = d2 / (d2 - d6);
+        return (cDistanceSq(a_point, a_vertex0 + w * ac));
+    }
+
+    double va = d3 * d6 - d5 * d4;
+    if ((va <= 0.0) && ((d4 - d3) >= 0.0) && ((d5 - d6) >= 0.0))
+    {
+        double w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+        return (cDistanceSq(a_point, a_vertex1 + w * (a_vertex2 - a_vertex1)));
+    }
+
+    double denominator = 1.0 / (va + vb + vc);
+    double v = vb * denominator;
+    double w = vc * denominator;
+    return (cDistanceSq(a_point, a_vertex0 + v * ab + w * ac));
+}
+
+
+//==============================================================================
+/*!
+    Constructor of cSignedDistanceField.
+*/
+//==============================================================================
+cSignedDistanceField::cSignedDistanceField()
+{
+    m_origin.zero();
+    m_cellSize = 0.0;
+    m_bandWidth = 0.0;
+    m_numCells[0] = m_numCells[1] = m_numCells[2] = 0;
+    m_numBricks[0] = m_numBricks[1] = m_numBricks[2] = 0;
+}
+
+
+//==============================================================================
+/*!
+    This method creates the field from a closed triangle mesh, whose
+    triangles face outwards. \n\n
+
+    The grid covers the bounding box of the triangles plus the band. Each
+    node is inside if rays cast from it along the three axes cross the
+    triangles an odd number of times for at least two of the axes, so that
+    small holes in the mesh do not flip whole regions. The distance of the
+    nodes near the surface is the distance to the nearest triangle among
+    the ones whose bounding box, grown by the band, contains the brick.
+    Bricks are computed in parallel.
+
+    \param  a_triangles  Triangles of the surface.
+    \param  a_cellSize   Distance between two neighbour nodes.
+    \param  a_bandWidth  Distance from the surface beyond which values are clamped.
+
+    \return __true__ if the operation succeeds, __false__ otherwise.
+*/
+//==============================================================================
+bool cSignedDistanceField::createFromTriangles(const cTriangleArrayPtr a_triangles,
+                                               const double a_cellSize,
+                                               const double a_bandWidth)
+{
+    m_brickIndex.clear();
+    m_values.clear();
+
+    if (a_triangles == nullptr)
+    {
+        return (C_ERROR);
+    }
+
+    // copy the vertices of the allocated triangles
+    std::vector<cVector3d> vertices;
+    int numTriangles = (int)(a_triangles->getNumElements());
+    vertices.reserve(3 * numTriangles);
+    for (int i=0; i<numTriangles; i++)
+    {
+        if (a_triangles->getAllocated(i))
+        {
+            vertices.push_back(a_triangles->m_vertices->getLocalPos(a_triangles->getVertexIndex0(i)));
+            vertices.push_back(a_triangles->m_vertices->getLocalPos(a_triangles->getVertexIndex1(i)));
+            vertices.push_back(a_triangles->m_vertices->getLocalPos(a_triangles->getVertexIndex2(i)));
+        }
+    }
+    numTriangles = (int)(vertices.size() / 3);
+    if (numTriangles == 0)
+    {
+        return (C_ERROR);
+    }
+
+    // the grid covers the triangles, the band and one more cell
+    if (!(a_cellSize > 0.0) || !(a_bandWidth > 0.0))
+    {
+        return (C_ERROR);
+    }
+    cVector3d boundsMin = vertices[0];
+    cVector3d boundsMax = vertices[0];
+    for (size_t i=1; i<vertices.size(); i++)
+    {
+        for (int axis=0; axis<3; axis++)
+        {
+            boundsMin(axis) = cMin(boundsMin(axis), vertices[i](axis));
+            boundsMax(axis) = cMax(boundsMax(axis), vertices[i](axis));
+        }
+    }
+    const double padding = a_bandWidth + a_cellSize;
+    double numCells[3];
+    for (int axis=0; axis<3; axis++)
+    {
+        numCells[axis] = ceil((boundsMax(axis) - boundsMin(axis) + 2.0 * padding) / a_cellSize);
+    }
+    if (!allocateGrid(boundsMin - cVector3d(padding, padding, padding), numCells, a_cellSize, a_bandWidth))
+    {
+        return (C_ERROR);
+    }
+
+    const int B = C_SDF_BRICK_SIZE;
+    const double h = m_cellSize;
+    const int numNodes[3] = { m_numCells[0] + 1, m_numCells[1] + 1, m_numCells[2] + 1 };
+
+    // nodes within the band of the bounding box of each triangle, and
+    // triangles near each brick
+    std::vector<int> nodeRanges(6 * (size_t)numTriangles);
+    std::vector<std::vector<int> > brickTriangles(m_brickIndex.size());
+    for (int i=0; i<numTriangles; i++)
+    {
+        const cVector3d* v = &vertices[3 * i];
+        int* range = &nodeRanges[6 * (size_t)i];
+        int first[3], last[3];
+        for (int axis=0; axis<3; axis++)
+        {
+            double triangleMin = cMin(cMin(v[0](axis), v[1](axis)), v[2](axis));
+            double triangleMax = cMax(cMax(v[0](axis), v[1](axis)), v[2](axis));
+            range[axis] = cMax(0, (int)ceil((triangleMin - m_bandWidth - m_origin(axis)) / h));
+            range[axis + 3] = cMin(m_numCells[axis], (int)floor((triangleMax + m_bandWidth - m_origin(axis)) / h));
+            first[axis] = cMax(0, (range[axis] - 1) / B);
+            last[axis] = cMin(m_numBricks[axis] - 1, range[axis + 3] / B);
+        }
+        for (int bz=first[2]; bz<=last[2]; bz++)
+        {
+            for (int by=first[1]; by<=last[1]; by++)
+            {
+                for (int bx=first[0]; bx<=last[0]; bx++)
+                {
+                    brickTriangles[((size_t)bz * m_numBricks[1] + by) * m_numBricks[0] + bx].push_back(i);
+                }
+            }
+        }
+    }
+
+    // inside votes of the nodes, by ray parity along each axis
+    std::vector<unsigned char> votes((size_t)numNodes[0] * numNodes[1] * numNodes[2], 0);
+    for (int axis=0; axis<3; axis++)
+    {
+        const int u = (axis + 1) % 3;
+        const int v = (axis + 2) % 3;
+
+        // rays are moved off the nodes, so that they do not hit edges shared by two triangles
+        const double jitterU = 1.31e-4 * h;
+        const double jitterV = 0.73e-4 * h;
+
+        // triangles crossed by each plane of rays
+        std::vector<std::vector<int> > planeTriangles(numNodes[v]);
+        for (int i=0; i<numTriangles; i++)
+        {
+            const cVector3d* p = &vertices[3 * i];
+            double low = cMin(cMin(p[0](v), p[1](v)), p[2](v)) - m_origin(v) - jitterV;
+            double high = cMax(cMax(p[0](v), p[1](v)), p[2](v)) - m_origin(v) - jitterV;
+            for (int iv=cMax(0, (int)ceil(low / h)); iv<=cMin(numNodes[v] - 1, (int)floor(high / h)); iv++)
+            {
+                planeTriangles[iv].push_back(i);
+            }
+        }
+
+        const unsigned int numThreads = cMin(cGetNumHardwareThreads(), (unsigned int)numNodes[v]);
+        cParallelFor(numThreads, [&](unsigned int a_thread)
+        {
+            std::vector<std::vector<double> > crossings(numNodes[u]);
+            for (int iv=(int)a_thread; iv<numNodes[v]; iv+=(int)numThreads)
+            {
+                const double rayV = m_origin(v) + iv * h + jitterV;
+                for (auto& row : crossings) { row.clear(); }
+
+                for (int i : planeTriangles[iv])
+                {
+                    const cVector3d* p = &vertices[3 * i];
+                    double u0 = p[0](u), u1 = p[1](u), u2 = p[2](u);
+                    double v0 = p[0](v) - rayV, v1 = p[1](v) - rayV, v2 = p[2](v) - rayV;
+                    double area = (u1 - u0) * (v2 - v0) - (u2 - u0) * (v1 - v0);
+                    if (area == 0.0) { continue; }
+
+                    double low = cMin(cMin(u0, u1), u2) - m_origin(u) - jitterU;
+                    double high = cMax(cMax(u0, u1), u2) - m_origin(u) - jitterU;
+                    for (int iu=cMax(0, (int)ceil(low / h)); iu<=cMin(numNodes[u] - 1, (int)floor(high / h)); iu++)
+                    {
+                        // barycentric coordinates of the ray in the plane of the other axes
+                        double rayU = m_origin(u) + iu * h + jitterU;
+                        double w0 = ((u1 - rayU) * v2 - (u2 - rayU) * v1) / area;
+                        double w1 = ((u2 - rayU) * v0 - (u0 - rayU) * v2) / area;
+                        double w2 = 1.0 - w0 - w1;
+                        if ((w0 >= 0.0) && (w1 >= 0.0) && (w2 >= 0.0))
+                        {
+                            crossings[iu].push_back(w0 * p[0](axis) + w1 * p[1](axis) + w2 * p[2](axis));
+                        }
+                    }
+                }
+
+                for (int iu=0; iu<numNodes[u]; iu++)
+                {
+                    std::vector<double>& row = crossings[iu];
+                    if (row.empty()) { continue; }
+                    std::sort(row.begin(), row.end());
+
+                    int node[3];
+                    node[u] = iu;
+                    node[v] = iv;
+                    size_t crossed = 0;
+                    for (node[axis]=0; node[axis]<numNodes[axis]; node[axis]++)
+                    {
+                        double position = m_origin(axis) + node[axis] * h;
+                        while ((crossed < row.size()) && (row[crossed] < position)) { crossed++; }
+                        if (crossed & 1)
+                        {
+                            votes[((size_t)node[2] * numNodes[1] + node[1]) * numNodes[0] + node[0]]++;
+                        }
+                    }
+                }
+            }
+        });
+    }
+
+    // distances near the surface: each triangle of a brick updates the
+    // nodes of the brick within the band of its bounding box
+    fillBricks([&](const int a_brick[3], float* a_nodes)
+    {
+        const std::vector<int>& triangles =
+            brickTriangles[((size_t)a_brick[2] * m_numBricks[1] + a_brick[1]) * m_numBricks[0] + a_brick[0]];
+        const int W = C_SDF_BRICK_WIDTH;
+        const int first[3] = { a_brick[0] * B, a_brick[1] * B, a_brick[2] * B };
+
+        double distanceSq[C_SDF_BRICK_NODES];
+        std::fill(distanceSq, distanceSq + C_SDF_BRICK_NODES, m_bandWidth * m_bandWidth);
+
+        for (int i : triangles)
+        {
+            const cVector3d* p = &vertices[3 * i];
+            const int* range = &nodeRanges[6 * (size_t)i];
+            cVector3d normal = cCross(p[1] - p[0], p[2] - p[0]);
+            double area = normal.length();
+            if (area > 0.0) { normal.mul(1.0 / area); }
+
+            for (int z=cMax(range[2] - first[2], 0); z<=cMin(range[5] - first[2], B); z++)
+            {
+                for (int y=cMax(range[1] - first[1], 0); y<=cMin(range[4] - first[1], B); y++)
+                {
+                    for (int x=cMax(range[0] - first[0], 0); x<=cMin(range[3] - first[0], B); x++)
+                    {
+                        double& nodeSq = distanceSq[(z * W + y) * W + x];
+                        cVector3d position = m_origin + h * cVector3d(first[0] + x, first[1] + y, first[2] + z);
+
+                        // the plane of the triangle is nearer than the triangle
+                        double plane = normal.dot(position - p[0]);
+                        if (plane * plane >= nodeSq) { continue; }
+                        nodeSq = cMin(nodeSq, cDistanceSqPointTriangle(position, p[0], p[1], p[2]));
+                    }
+                }
+            }
+        }
+
+        for (int z=0; z<W; z++)
+        {
+            for (int y=0; y<W; y++)
+            {
+                for (int x=0; x<W; x++)
+                {
+                    int n = (z * W + y) * W + x;
+                    float distance = (float)sqrt(distanceSq[n]);
+                    bool inside = votes[((size_t)(first[2] + z) * numNodes[1] + first[1] + y) * numNodes[0] + first[0] + x] >= 2;
+                    a_nodes[n] = inside ? -distance : distance;
+                }
+            }
+        }
+    });
+
+    return (C_SUCCESS);
+}
+
+
+//==============================================================================
+/*!
+    This method creates the field from a grid of signed distances (negative
+    inside), for instance computed by another tool. Nodes beyond the grid,
+    which is extended to a multiple of the brick size, repeat the nearest
+    node of the grid.
+
+    \param  a_values     Distance at each node, X first.
+    \param  a_numNodesX  Number of nodes along X.
+    \param  a_numNodesY  Number of nodes along Y.
+    \param  a_numNodesZ  Number of nodes along Z.
+    \param  a_origin     Position of the first node.
+    \param  a_cellSize   Distance between two neighbour nodes.
+    \param  a_bandWidth  Distance from the surface beyond which values are clamped.
+
+    \return __true__ if the operation succeeds, __false__ otherwise.
+*/
+//==============================================================================
+bool cSignedDistanceField::createFromGrid(const float* a_values,
+                                          const int a_numNodesX,
+                                          const int a_numNodesY,
+                                          const int a_numNodesZ,
+                                          const cVector3d& a_origin,
+                                          const double a_cellSize,
+                                          const double a_bandWidth)
+{
+    m_brickIndex.clear();
+    m_values.clear();
+
+    if ((a_values == nullptr) || (a_numNodesX < 2) || (a_numNodesY < 2) || (a_numNodesZ < 2))
+    {
+        return (C_ERROR);
+    }
+
+    const int numNodes[3] = { a_numNodesX, a_numNodesY, a_numNodesZ };
+    const double numCells[3] = { (double)(numNodes[0] - 1), (double)(numNodes[1] - 1), (double)(numNodes[2] - 1) };
+    if (!allocateGrid(a_origin, numCells, a_cellSize, a_bandWidth))
+    {
+        return (C_ERROR);
+    }
+
+    const int B = C_SDF_BRICK_SIZE;
+    fillBricks([&](const int a_brick[3], float* a_nodes)
+    {
+        for (int z=0; z<C_SDF_BRICK_WIDTH; z++)
+        {
+            int k = cMin(a_brick[2] * B + z, numNodes[2] - 1);
+            for (int y=0; y<C_SDF_BRICK_WIDTH; y++)
+            {
+                int j = cMin(a_brick[1] * B + y, numNodes[1] - 1);
+                for (int x=0; x<C_SDF_BRICK_WIDTH; x++)
+                {
+                    int i = cMin(a_brick[0] * B + x, numNodes[0] - 1);
+                    a_nodes[(z * C_SDF_BRICK_WIDTH + y) * C_SDF_BRICK_WIDTH + x] =
+                        a_values[((size_t)k * numNodes[1] + j) * numNodes[0] + i];
+                }
+            }
+        }
+    });
+
+    return (C_SUCCESS);
+}
+
+
+//==============================================================================
+/*!
+    This method sets the size of the grid, rounded up to a multiple of the
+    brick size, and marks all bricks as outside.
+
+    \param  a_origin     Position of the first node.
+    \param  a_numCells   Minimum number of cells along each axis.
+    \param  a_cellSize   Distance between two neighbour nodes.
+    \param  a_bandWidth  Distance from the surface beyond which values are clamped.
+
+    \return __true__ if the operation succeeds, __false__ if the grid would be too large.
+*/
+//==============================================================================
+bool cSignedDistanceField::allocateGrid(const cVector3d& a_origin,
+                                        const double a_numCells[3],
+                                        const double a_cellSize,
+                                        const double a_bandWidth)
+{
+    if (!(a_cellSize > 0.0) || !(a_bandWidth > 0.0))
+    {
+        return (C_ERROR);
+    }
+
+    size_t numBricks = 1;
+    for (int i=0; i<3; i++)
+    {
+        double bricks = cMax(1.0, ceil(a_numCells[i] / C_SDF_BRICK_SIZE));
+        if (!(bricks * numBricks <= (double)C_SDF_MAX_BRICKS))
+        {
+            return (C_ERROR);
+        }
+        m_numBricks[i] = (int)bricks;
+        m_numCells[i] = m_numBricks[i] * C_SDF_BRICK_SIZE;
+        numBricks *= m_numBricks[i];
+    }
+
+    m_origin = a_origin;
+    m_cellSize = a_cellSize;
+    m_bandWidth = a_bandWidth;
+    m_brickIndex.assign(numBricks, C_SDF_BRICK_OUTSIDE);
+    return (C_SUCCESS);
+}
+
+
+//==============================================================================
+/*!
+    This method computes the nodes of all bricks, slices of bricks in
+    parallel, clamps them to the band and stores the bricks that are not
+    entirely outside or inside of the band. Bricks are stored in the order
+    of their index, whatever the number of threads.
+
+    \param  a_brickNodes  Callback that writes the nodes of a brick.
+*/
+//==============================================================================
+template <typename T> void cSignedDistanceField::fillBricks(T a_brickNodes)
+{
+    const unsigned int numThreads = cMin(cGetNumHardwareThreads(), (unsigned int)m_numBricks[2]);
+    std::vector<std::vector<float> > threadValues(numThreads);
+    std::vector<int> threadOffset(m_brickIndex.size(), -1);
+    const float band = (float)m_bandWidth;
+
+    cParallelFor(numThreads, [&](unsigned int a_thread)
+    {
+        float nodes[C_SDF_BRICK_NODES];
+        for (int bz=(int)a_thread; bz<m_numBricks[2]; bz+=(int)numThreads)
+        {
+            for (int by=0; by<m_numBricks[1]; by++)
+            {
+                for (int bx=0; bx<m_numBricks[0]; bx++)
+                {
+                    const int brick[3] = { bx, by, bz };
+                    a_brickNodes(brick, nodes);
+
+                    bool outside = true;
+                    bool inside = true;
+                    for (int i=0; i<C_SDF_BRICK_NODES; i++)
+                    {
+                        nodes[i] = cClamp(nodes[i], -band, band);
+                        outside = outside && (nodes[i] >= band);
+                        inside = inside && (nodes[i] <= -band);
+                    }
+
+                    size_t index = ((size_t)bz * m_numBricks[1] + by) * m_numBricks[0] + bx;
+                    if (outside || inside)
+                    {
+                        m_brickIndex[index] = outside ? C_SDF_BRICK_OUTSIDE : C_SDF_BRICK_INSIDE;
+                    }
+                    else
+                    {
+                        threadOffset[index] = (int)(threadValues[a_thread].size() / C_SDF_BRICK_NODES);
+                        threadValues[a_thread].insert(threadValues[a_thread].end(), nodes, nodes + C_SDF_BRICK_NODES);
+                    }
+                }
+            }
+        }
+    });
+
+    // gather the stored bricks
+    size_t numStored = 0;
+    for (auto& values : threadValues) { numStored += values.size(); }
+    m_values.resize(numStored);
+
+    int numBricks = 0;
+    for (size_t index=0; index<m_brickIndex.size(); index++)
+    {
+        if (threadOffset[index] >= 0)
+        {
+            int bz = (int)(index / ((size_t)m_numBricks[0] * m_numBricks[1]));
+            const float* source = &threadValues[bz % numThreads][(size_t)threadOffset[index] * C_SDF_BRICK_NODES];
+            std::copy(source, source + C_SDF_BRICK_NODES, &m_values[(size_t)numBricks * C_SDF_BRICK_NODES]);
+            m_brickIndex[index] = numBricks++;
+        }
+    }
+}
+
+
+//==============================================================================
+/*!
+    This method scales the field, and the surface it describes, about the
+    origin of its frame.
+
+    \param  a_scaleFactor  Scale factor, greater than 0.
+*/
+//==============================================================================
+void cSignedDistanceField::scale(const double a_scaleFactor)
+{
+    if (!(a_scaleFactor > 0.0))
+    {
+        return;
+    }
+
+    m_origin.mul(a_scaleFactor);
+    m_cellSize *= a_scaleFactor;
+    m_bandWidth *= a_scaleFactor;
+    for (auto& value : m_values)
+    {
+        value = (float)(value * a_scaleFactor);
+    }
+}
+
+
+//==============================================================================
+/*!
+    This method returns the position of the last node of the grid.
+
+    \return Position of the last node.
+*/
+//==============================================================================
+cVector3d cSignedDistanceField::getEnd() const
+{
+    return (m_origin + m_cellSize * cVector3d(m_numCells[0], m_numCells[1], m_numCells[2]));
+}
+
+
+//==============================================================================
+/*!
+    This method returns the signed distance from a point to the surface,
+    negative inside. Values are clamped to the band.
+
+    \param  a_point  Point, in the frame of the field.
+
+    \return Signed distance.
+*/
+//==============================================================================
+double cSignedDistanceField::getDistance(const cVector3d& a_point) const
+{
+    cVector3d gradient;
+    return (getDistance(a_point, gradient));
+}
+
+
+//==============================================================================
+/*!
+    This method returns the signed distance from a point to the surface and
+    the gradient of the distance, which points away from the surface. The
+    gradient is not normalized, and is zero far from the surface.
+
+    \param  a_point     Point, in the frame of the field.
+    \param  a_gradient  Returned gradient of the distance.
+
+    \return Signed distance.
+*/
+//==============================================================================
+double cSignedDistanceField::getDistance(const cVector3d& a_point, cVector3d& a_gradient) const
+{
+    a_gradient.zero();
+    if (isEmpty())
+    {
+        return (C_LARGE);
+    }
+
+    // nearest point of the grid
+    cVector3d end = getEnd();
+    cVector3d clamped(cClamp(a_point(0), m_origin(0), end(0)),
+                      cClamp(a_point(1), m_origin(1), end(1)),
+                      cClamp(a_point(2), m_origin(2), end(2)));
+    double distance = interpolate(clamped, &a_gradient);
+
+    // outside of the grid
+    cVector3d offset = a_point - clamped;
+    double length = offset.length();
+    if (length > 0.0)
+    {
+        distance += length;
+        a_gradient = offset / length;
+    }
+
+    return (distance);
+}
+
+
+//==============================================================================
+/*!
+    This method interpolates the 8 nodes around a point inside of the grid.
+
+    \param  a_point     Point inside of the grid.
+    \param  a_gradient  Returned gradient of the distance, if not null.
+
+    \return Signed distance.
+*/
+//==============================================================================
+double cSignedDistanceField::interpolate(const cVector3d& a_point, cVector3d* a_gradient) const
+{
+    int cell[3];
+    double t[3];
+    for (int i=0; i<3; i++)
+    {
+        double position = (a_point(i) - m_origin(i)) / m_cellSize;
+        cell[i] = cClamp((int)floor(position), 0, m_numCells[i] - 1);
+        t[i] = cClamp(position - cell[i], 0.0, 1.0);
+    }
+
+    const int B = C_SDF_BRICK_SIZE;
+    int brick = m_brickIndex[((size_t)(cell[2] / B) * m_numBricks[1] + cell[1] / B) * m_numBricks[0] + cell[0] / B];
+    if (brick < 0)
+    {
+        if (a_gradient != nullptr) { a_gradient->zero(); }
+        return ((brick == C_SDF_BRICK_OUTSIDE) ? m_bandWidth : -m_bandWidth);
+    }
+
+    const int W = C_SDF_BRICK_WIDTH;
+    const float* n = &m_values[(size_t)brick * C_SDF_BRICK_NODES
+                               + ((cell[2] % B) * W + (cell[1] % B)) * W + (cell[0] % B)];
+    double c000 = n[0], c100 = n[1], c010 = n[W], c110 = n[W + 1];
+    double c001 = n[W * W], c101 = n[W * W + 1], c011 = n[W * W + W], c111 = n[W * W + W + 1];
+
+    // along X
+    double c00 = c000 + t[0] * (c100 - c000);
+    double c10 = c010 + t[0] * (c110 - c010);
+    double c01 = c001 + t[0] * (c101 - c001);
+    double c11 = c011 + t[0] * (c111 - c011);
+
+    // along Y, then Z
+    double c0 = c00 + t[1] * (c10 - c00);
+    double c1 = c01 + t[1] * (c11 - c01);
+
+    if (a_gradient != nullptr)
+    {
+        double dx0 = (c100 - c000) + t[1] * ((c110 - c010) - (c100 - c000));
+        double dx1 = (c101 - c001) + t[1] * ((c111 - c011) - (c101 - c001));
+        a_gradient->set((dx0 + t[2] * (dx1 - dx0)) / m_cellSize,
+                        ((c10 - c00) + t[2] * ((c11 - c01) - (c10 - c00))) / m_cellSize,
+                        (c1 - c0) / m_cellSize);
+    }
+
+    return (c0 + t[2] * (c1 - c0));
+}
+
+
+//==============================================================================
+/*!
+    This method loads a field saved by saveToFile(). The file is rejected if
+    it was written by a different version of the library, on a platform with
+    a different byte order, or for another hash, in which case the current
+    field is left unchanged.
+
+    \param  a_filename  Filename.
+    \param  a_hash      Hash of the source of the field, see computeHash().
+
+    \return __true__ if the field was loaded, __false__ otherwise.
+*/
+//==============================================================================
+bool cSignedDistanceField::loadFromFile(const std::string& a_filename, const unsigned long long a_hash)
+{
+    cMappedFilePtr file = cMappedFile::create();
+    if (!file->open(a_filename) || (file->getSize() < sizeof(cSignedDistanceFieldFileHeader)))
+    {
+        return (C_ERROR);
+    }
+
+    // check header
+    cSignedDistanceFieldFileHeader header;
+    memcpy(&header, file->getData(), sizeof(header));
+
+    if ((memcmp(header.m_magic, C_SDF_FILE_MAGIC, sizeof(header.m_magic)) != 0) ||
+        (header.m_version != C_SDF_FILE_VERSION) ||
+        (header.m_endianness != C_SDF_FILE_ENDIANNESS) ||
+        (header.m_brickSize != C_SDF_BRICK_SIZE) ||
+        (header.m_hash != a_hash) ||
+        (header.m_numStoredBricks < 0) ||
+        !(header.m_cellSize > 0.0) ||
+        !(header.m_bandWidth > 0.0))
+    {
+        return (C_ERROR);
+    }
+
+    size_t numBricks = 1;
+    int numBricksAxis[3];
+    for (int i=0; i<3; i++)
+    {
+        if ((header.m_numCells[i] <= 0) || (header.m_numCells[i] % C_SDF_BRICK_SIZE != 0))
+        {
+            return (C_ERROR);
+        }
+        numBricksAxis[i] = header.m_numCells[i] / C_SDF_BRICK_SIZE;
+        numBricks *= numBricksAxis[i];
+        if (numBricks > C_SDF_MAX_BRICKS)
+        {
+            return (C_ERROR);
+        }
+    }
+
+    size_t numValues = (size_t)header.m_numStoredBricks * C_SDF_BRICK_NODES;
+    if (file->getSize() != sizeof(header) + numBricks * sizeof(int) + numValues * sizeof(float))
+    {
+        return (C_ERROR);
+    }
+
+    // check that the brick indices are valid
+    std::vector<int> brickIndex(numBricks);
+    memcpy(brickIndex.data(), file->getData() + sizeof(header), numBricks * sizeof(int));
+    for (int index : brickIndex)
+    {
+        if ((index < C_SDF_BRICK_INSIDE) || (index >= header.m_numStoredBricks))
+        {
+            return (C_ERROR);
+        }
+    }
+
+    m_values.resize(numValues);
+    memcpy(m_values.data(), file->getData() + sizeof(header) + numBricks * sizeof(int), numValues * sizeof(float));
+    m_brickIndex.swap(brickIndex);
+    m_origin.set(header.m_origin[0], header.m_origin[1], header.m_origin[2]);
+    m_cellSize = header.m_cellSize;
+    m_bandWidth = header.m_bandWidth;
+    for (int i=0; i<3; i++)
+    {
+        m_numCells[i] = header.m_numCells[i];
+        m_numBricks[i] = numBricksAxis[i];
+    }
+
+    return (C_SUCCESS);
+}
+
+
+//==============================================================================
+/*!
+    This method saves the field to a file, which can be loaded with
+    loadFromFile(). The file is written under a temporary name and then
+    renamed, so that other processes never read a partially written file.
+
+    \param  a_filename  Filename.
+    \param  a_hash      Hash of the source of the field, see computeHash().
+
+    \return __true__ if the field was saved, __false__ otherwise.
+*/
+//==============================================================================
+bool cSignedDistanceField::saveToFile(const std::string& a_filename, const unsigned long long a_hash) const
+{
+    if (isEmpty())
+    {
+        return (C_ERROR);
+    }
+
+    // build header
+    cSignedDistanceFieldFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.m_magic, C_SDF_FILE_MAGIC, sizeof(header.m_magic));
+    header.m_version = C_SDF_FILE_VERSION;
+    header.m_endianness = C_SDF_FILE_ENDIANNESS;
+    header.m_brickSize = C_SDF_BRICK_SIZE;
+    for (int i=0; i<3; i++)
+    {
+        header.m_numCells[i] = m_numCells[i];
+        header.m_origin[i] = m_origin(i);
+    }
+    header.m_numStoredBricks = getNumStoredBricks();
+    header.m_hash = a_hash;
+    header.m_cellSize = m_cellSize;
+    header.m_bandWidth = m_bandWidth;
+
+    // write temporary file
+    std::string filename = a_filename + ".tmp";
+    FILE* file = fopen(filename.c_str(), "wb");
+    if (file == nullptr)
+    {
+        return (C_ERROR);
+    }
+
+    bool result = (fwrite(&header, sizeof(header), 1, file) == 1);
+    result = result && (fwrite(m_brickIndex.data(), sizeof(int), m_brickIndex.size(), file) == m_brickIndex.size());
+    if (!m_values.empty())
+    {
+        result = result && (fwrite(m_values.data(), sizeof(float), m_values.size(), file) == m_values.size());
+    }
+    result = (fclose(file) == 0) && result;
+
+    // replace previous file
+    if (result)
+    {
+        remove(a_filename.c_str());
+        result = (rename(filename.c_str(), a_filename.c_str()) == 0);
+    }
+    if (!result)
+    {
+        remove(filename.c_str());
+    }
+
+    return (result);
+}
+
+
+//==============================================================================
+/*!
+    This method computes a 64 bit hash of triangles (as the hash of the
+    collision trees, see cCollisionAABB::computeHash()) and of the parameters
+    of a field. Fields saved to disk are tagged with this value so that
+    fields baked from another geometry are never reused.
+
+    \param  a_triangles  Triangles of the surface.
+    \param  a_cellSize   Distance between two neighbour nodes.
+    \param  a_bandWidth  Distance from the surface beyond which values are clamped.
+
+    \return Hash value.
+*/
+//==============================================================================
+unsigned long long cSignedDistanceField::computeHash(const cTriangleArrayPtr a_triangles,
+                                                     const double a_cellSize,
+                                                     const double a_bandWidth)
+{
+    unsigned long long hash = cCollisionAABB::computeHash(a_triangles, a_cellSize);
+
+    unsigned long long value;
+    memcpy(&value, &a_bandWidth, sizeof(value));
+    value *= 0x9E3779B97F4A7C15ULL;
+    value ^= value >> 32;
+    hash ^= value;
+    hash *= 0x100000001B3ULL;
+    hash ^= hash >> 29;
+
+    return (hash);
+}
+
+//------------------------------------------------------------------------------
+} // namespace chai3d
+//------------------------------------------------------------------------------
@@ -0,0 +1,371 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2003-2016, CHAI3D.
+    (www.chai3d.org)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of CHAI3D nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE. 
+
+    \author    <http://www.chai3d.org>
+    \version   3.2.0 $Rev: 1869 $
+*/
+//==============================================================================
+
+//------------------------------------------------------------------------------
+#include "world/CVoxelDistanceField.h"
+#include "math/CMaths.h"
+#include "system/CThread.h"
+//------------------------------------------------------------------------------
+#include <climits>
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+namespace chai3d {
+//------------------------------------------------------------------------------
+
+//==============================================================================
+/*!
+    Constructor of cVoxelDistanceField.
+*/
+//==============================================================================
+cVoxelDistanceField::cVoxelDistanceField()
+{
+    m_size[0] = m_size[1] = m_size[2] = 0;
+    m_numBricks[0] = m_numBricks[1] = m_numBricks[2] = 0;
+    m_brickSize = C_VOXEL_BRICK_SIZE;
+    m_isosurfaceValue = 0.0f;
+    m_imageModificationCount = 0;
+    m_numOccupiedBricks = 0;
+}
+
+
+//==============================================================================
+/*!
+    This method creates the field from a volume image. A voxel is occupied
+    when its alpha value (between 0.0 and 1.0) is greater or equal to
+    __a_isosurfaceValue__, as in cVoxelObject collision detection.
+
+    \param  a_image            Volume image (usually a cMultiImage).
+    \param  a_isosurfaceValue  Isosurface value.
+    \param  a_brickSize        Width of the bricks in voxels.
+
+    \return __true__ if the operation succeeds, __false__ otherwise.
+*/
+//==============================================================================
+bool cVoxelDistanceField::createField(cImagePtr a_image, const float a_isosurfaceValue, const int a_brickSize)
+{
+    m_distance.clear();
+    m_numOccupiedBricks = 0;
+
+    if ((a_image == nullptr) || (a_brickSize < 1))
+    {
+        return (C_ERROR);
+    }
+
+    // voxels modified from now on invalidate the field
+    m_image = a_image;
+    m_imageModificationCount = a_image->getModificationCount();
+
+    m_size[0] = (int)a_image->getWidth();
+    m_size[1] = (int)a_image->getHeight();
+    m_size[2] = (int)a_image->getImageCount();
+    if ((m_size[0] == 0) || (m_size[1] == 0) || (m_size[2] == 0))
+    {
+        return (C_ERROR);
+    }
+
+    m_brickSize = a_brickSize;
+    m_isosurfaceValue = a_isosurfaceValue;
+    for (int i=0; i<3; i++)
+    {
+        m_numBricks[i] = (m_size[i] + m_brickSize - 1) / m_brickSize;
+    }
+    const size_t numBricks = (size_t)m_numBricks[0] * m_numBricks[1] * m_numBricks[2];
+
+    // count the occupied voxels of each brick, slices of bricks in parallel
+    std::vector<int> count(numBricks, 0);
+    const unsigned int numThreads = cMin(cGetNumHardwareThreads(), (unsigned int)m_numBricks[2]);
+    cParallelFor(numThreads, [&](unsigned int a_thread)
+    {
+        const float CONVERSION_FACTOR = (1.0f / 255.0f);
+        for (int bz=(int)a_thread; bz<m_numBricks[2]; bz+=(int)numThreads)
+        {
+            for (int z=bz * m_brickSize; z<cMin((bz + 1) * m_brickSize, m_size[2]); z++)
+            {
+                for (int y=0; y<m_size[1]; y++)
+                {
+                    int* row = &count[((size_t)bz * m_numBricks[1] + y / m_brickSize) * m_numBricks[0]];
+                    for (int x=0; x<m_size[0]; x++)
+                    {
+                        cColorb color;
+                        if (a_image->getVoxelColor(x, y, z, color))
+                        {
+                            float level = CONVERSION_FACTOR * (float)(color.getA());
+                            if (level >= a_isosurfaceValue)
+                            {
+                                row[x / m_brickSize]++;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    });
+
+    // distance of empty bricks to the occupied ones
+    const int fullCount = m_brickSize * m_brickSize * m_brickSize;
+    std::vector<int> outside(numBricks), inside(numBricks);
+    for (size_t i=0; i<numBricks; i++)
+    {
+        outside[i] = (count[i] > 0) ? 0 : INT_MAX;
+        inside[i] = (count[i] < fullCount) ? 0 : INT_MAX;
+        if (count[i] > 0) { m_numOccupiedBricks++; }
+    }
+    computeDistance(outside);
+
+    // distance of full bricks to the other ones, also outside of the volume
+    computeDistance(inside);
+
+    m_distance.resize(numBricks);
+    for (int bz=0; bz<m_numBricks[2]; bz++)
+    {
+        for (int by=0; by<m_numBricks[1]; by++)
+        {
+            for (int bx=0; bx<m_numBricks[0]; bx++)
+            {
+                size_t i = ((size_t)bz * m_numBricks[1] + by) * m_numBricks[0] + bx;
+                int distance = 0;
+                if (count[i] == 0)
+                {
+                    distance = outside[i];
+                }
+                else if (count[i] == fullCount)
+                {
+                    int border = cMin(cMin(cMin(bx, m_numBricks[0] - 1 - bx),
+                                           cMin(by, m_numBricks[1] - 1 - by)),
+                                      cMin(bz, m_numBricks[2] - 1 - bz)) + 1;
+                    distance = -cMin(inside[i], border);
+                }
+                m_distance[i] = (int16_t)cClamp(distance, -INT16_MAX, (int)INT16_MAX);
+            }
+        }
+    }
+
+    return (C_SUCCESS);
+}
+
+
+//==============================================================================
+/*!
+    This method computes, in place, the Chebyshev distance (in bricks) of each
+    brick to the nearest brick with a distance of 0, with a forward and a
+    backward pass over the 26 neighbours of the bricks.
+
+    \param  a_distance  0 for source bricks and INT_MAX for the others.
+*/
+//==============================================================================
+void cVoxelDistanceField::computeDistance(std::vector<int>& a_distance) const
+{
+    const int nx = m_numBricks[0];
+    const int ny = m_numBricks[1];
+    const int nz = m_numBricks[2];
+
+    for (int pass=0; pass<2; pass++)
+    {
+        const int step = (pass == 0) ? 1 : -1;
+        for (int z=(pass == 0) ? 0 : nz-1; (z >= 0) && (z < nz); z+=step)
+        {
+            for (int y=(pass == 0) ? 0 : ny-1; (y >= 0) && (y < ny); y+=step)
+            {
+                for (int x=(pass == 0) ? 0 : nx-1; (x >= 0) && (x < nx); x+=step)
+                {
+                    int& value = a_distance[((size_t)z * ny + y) * nx + x];
+                    if (value == 0) { continue; }
+
+                    // neighbours already visited by this pass
+                    for (int dz=-1; dz<=0; dz++)
+                    {
+                        for (int dy=-1; dy<=1; dy++)
+                        {
+                            for (int dx=-1; dx<=1; dx++)
+                            {
+                                if ((dz == 0) && ((dy > 0) || ((dy == 0) && (dx >= 0)))) { continue; }
+                                int qx = x + step * dx;
+                                int qy = y + step * dy;
+                                int qz = z + step * dz;
+                                if ((qx < 0) || (qx >= nx) || (qy < 0) || (qy >= ny) || (qz < 0) || (qz >= nz)) { continue; }
+                                int neighbour = a_distance[((size_t)qz * ny + qy) * nx + qx];
+                                if (neighbour != INT_MAX)
+                                {
+                                    value = cMin(value, neighbour + 1);
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+
+//==============================================================================
+/*!
+    This method returns __true__ if the field was created from this image
+    with the same isosurface value, and the image has not been modified
+    since (see cImage::getModificationCount()).
+
+    \param  a_image            Volume image.
+    \param  a_isosurfaceValue  Isosurface value.
+
+    \return __true__ if the field can be used for this image.
+*/
+//==============================================================================
+bool cVoxelDistanceField::isValidFor(cImagePtr a_image, const float a_isosurfaceValue) const
+{
+    return ((!isEmpty()) &&
+            (a_image != nullptr) &&
+            !m_image.owner_before(a_image) && !a_image.owner_before(m_image) &&
+            (m_imageModificationCount == a_image->getModificationCount()) &&
+            (m_isosurfaceValue == a_isosurfaceValue) &&
+            (m_size[0] == (int)a_image->getWidth()) &&
+            (m_size[1] == (int)a_image->getHeight()) &&
+            (m_size[2] == (int)a_image->getImageCount()));
+}
+
+
+//==============================================================================
+/*!
+    This method returns a radius (in voxels) around a voxel in which no voxel
+    is occupied: all voxels whose Chebyshev distance to the voxel is smaller
+    or equal to the radius are empty. Returns 0 if the voxel is occupied or
+    is near the surface.
+
+    \param  a_x  X coordinate of the voxel, in the volume.
+    \param  a_y  Y coordinate of the voxel, in the volume.
+    \param  a_z  Z coordinate of the voxel, in the volume.
+
+    \return Free radius in voxels.
+*/
+//==============================================================================
+int cVoxelDistanceField::getFreeRadius(const int a_x, const int a_y, const int a_z) const
+{
+    int distance = getBrickDistance(a_x / m_brickSize, a_y / m_brickSize, a_z / m_brickSize);
+    if (distance <= 0) { return (0); }
+
+    // the voxel is at least this far from the faces of its brick
+    int margin = m_brickSize;
+    const int coord[3] = { a_x, a_y, a_z };
+    for (int i=0; i<3; i++)
+    {
+        int offset = coord[i] % m_brickSize;
+        margin = cMin(margin, cMin(offset, m_brickSize - 1 - offset));
+    }
+    return ((distance - 1) * m_brickSize + margin);
+}
+
+
+//==============================================================================
+/*!
+    This method returns the signed Chebyshev distance (in voxels) from a voxel
+    to the surface: positive for empty voxels, negative for voxels deep inside
+    the volume and 0 near the surface. The magnitude is a lower bound of the
+    distance.
+
+    \param  a_x  X coordinate of the voxel, clamped to the volume.
+    \param  a_y  Y coordinate of the voxel, clamped to the volume.
+    \param  a_z  Z coordinate of the voxel, clamped to the volume.
+
+    \return Signed distance in voxels.
+*/
+//==============================================================================
+int cVoxelDistanceField::getVoxelDistance(const int a_x, const int a_y, const int a_z) const
+{
+    const int x = cClamp(a_x, 0, m_size[0] - 1);
+    const int y = cClamp(a_y, 0, m_size[1] - 1);
+    const int z = cClamp(a_z, 0, m_size[2] - 1);
+
+    int distance = getBrickDistance(x / m_brickSize, y / m_brickSize, z / m_brickSize);
+    if (distance == 0) { return (0); }
+
+    int margin = m_brickSize;
+    const int coord[3] = { x, y, z };
+    for (int i=0; i<3; i++)
+    {
+        int offset = coord[i] % m_brickSize;
+        margin = cMin(margin, cMin(offset, m_brickSize - 1 - offset));
+    }
+    int voxels = (cAbs(distance) - 1) * m_brickSize + margin + 1;
+    return ((distance > 0) ? voxels : -voxels);
+}
+
+
+//==============================================================================
+/*!
+    This method returns __true__ if no voxel of a box of voxels is occupied.
+    The box may extend outside of the volume.
+
+    \param  a_min  Minimum voxel coordinates of the box.
+    \param  a_max  Maximum voxel coordinates of the box (included).
+
+    \return __true__ if the box is empty.
+*/
+//==============================================================================
+bool cVoxelDistanceField::isRegionEmpty(const int a_min[3], const int a_max[3]) const
+{
+    int bmin[3], bmax[3];
+    for (int i=0; i<3; i++)
+    {
+        int vmin = cMax(a_min[i], 0);
+        int vmax = cMin(a_max[i], m_size[i] - 1);
+        if (vmin > vmax) { return (true); }
+        bmin[i] = vmin / m_brickSize;
+        bmax[i] = vmax / m_brickSize;
+    }
+
+    for (int bz=bmin[2]; bz<=bmax[2]; bz++)
+    {
+        for (int by=bmin[1]; by<=bmax[1]; by++)
+        {
+            for (int bx=bmin[0]; bx<=bmax[0]; bx++)
+            {
+                if (getBrickDistance(bx, by, bz) <= 0) { return (false); }
+            }
+        }
+    }
+    return (true);
+}
+
+
+//------------------------------------------------------------------------------
+} // namespace chai3d
+//------------------------------------------------------------------------------
@@ -1105,6 +1105,16 @@ bool cVoxelObject::computeOtherCollisionDetection(cVector3d& a_segmentPointA,
     // distance counter
     double distance = 0.0;
 
+    // the distance field is used only if it matches the volume
+    const cVoxelDistanceField* field = isDistanceFieldValid() ? m_distanceField.get() : NULL;
+
+    // texels crossed per unit of length along each axis
+    double texelsPerUnit[3];
+    for (int i=0; i<3; i++)
+    {
+        texelsPerUnit[i] = (objectRange(i) == 0.0) ? C_LARGE : fabs(texSize[i] * texRange(i) / objectRange(i));
+    }
+
     // search for collision
     while ((!hit) && (distance < distanceAB))
     {
@@ -1135,6 +1145,26 @@ bool cVoxelObject::computeOtherCollisionDetection(cVector3d& a_segmentPointA,
         tmax[1] = texel[1] + texRadius[1] + 1;
         tmax[2] = texel[2] + texRadius[2] + 1;
 
+        // if no voxel around the point is occupied, skip the following steps
+        // for as long as their own neighbourhood stays in the empty region;
+        // the texel moves by less than (length x texelsPerUnit + 1) texels
+        if ((field != NULL) && field->isRegionEmpty(tmin, tmax))
+        {
+            int freeRadius = field->getFreeRadius(texel[0], texel[1], texel[2]);
+            double freeLength = C_LARGE;
+            for (int i=0; i<3; i++)
+            {
+                freeLength = cMin(freeLength, (double)(freeRadius - texRadius[i] - 2) / texelsPerUnit[i]);
+            }
+
+            double start = distance;
+            while ((distance < distanceAB) && (cMin((distance + voxelSmallestSize), distanceAB) - start <= freeLength))
+            {
+                distance = cMin((distance + voxelSmallestSize), distanceAB);
+            }
+            continue;
+        }
+
         // check all voxels 
         for (int t2=tmin[2]; t2<=tmax[2]; t2++)
         {
@@ -1330,6 +1360,101 @@ bool cVoxelObject::computeOtherCollisionDetection(cVector3d& a_segmentPointA,
 }
 
 
+//==============================================================================
+/*!
+    This method builds a brick map and coarse distance field of the volume
+    (see \ref cVoxelDistanceField) for the current isosurface value.
+    Collision detection then skips the empty space around the tool. The
+    field is ignored once the voxels, the image or the isosurface value
+    change, until it is built again.
+
+    \param  a_brickSize  Width of the bricks in voxels.
+
+    \return __true__ if the operation succeeds, __false__ otherwise.
+*/
+//==============================================================================
+bool cVoxelObject::buildDistanceField(const int a_brickSize)
+{
+    m_distanceField = nullptr;
+    if ((m_texture == nullptr) || (m_texture->m_image == nullptr))
+    {
+        return (C_ERROR);
+    }
+
+    cVoxelDistanceFieldPtr field = cVoxelDistanceField::create();
+    if (!field->createField(m_texture->m_image, m_isosurfaceValue, a_brickSize))
+    {
+        return (C_ERROR);
+    }
+    m_distanceField = field;
+    return (C_SUCCESS);
+}
+
+
+//==============================================================================
+/*!
+    This method returns __true__ if a distance field was built from the
+    current image, unmodified since, and for the current isosurface value.
+
+    \return __true__ if the distance field can be used.
+*/
+//==============================================================================
+bool cVoxelObject::isDistanceFieldValid() const
+{
+    return ((m_distanceField != nullptr) &&
+            (m_texture != nullptr) &&
+            m_distanceField->isValidFor(m_texture->m_image, m_isosurfaceValue));
+}
+
+
+//==============================================================================
+/*!
+    This method computes, in constant time, a lower bound of the distance
+    from a point to the cells of the occupied voxels: positive outside of
+    the isosurface, negative deep inside and 0 near the surface.
+
+    \param  a_localPos  Position in local coordinates.
+    \param  a_distance  Return value for the signed distance.
+
+    \return __true__ if the operation succeeds, __false__ if no valid distance field exists.
+*/
+//==============================================================================
+bool cVoxelObject::computeSurfaceDistance(const cVector3d& a_localPos, double& a_distance) const
+{
+    if (!isDistanceFieldValid())
+    {
+        return (C_ERROR);
+    }
+
+    cImagePtr image = m_texture->m_image;
+    double texSize[3];
+    texSize[0] = (double)(image->getWidth());
+    texSize[1] = (double)(image->getHeight());
+    texSize[2] = (double)(image->getImageCount());
+
+    // same voxel size and texture mapping as collision detection
+    cVector3d objectRange = m_maxCorner - m_minCorner;
+    cVector3d texRange = m_maxTextureCoord - m_minTextureCoord;
+    double voxelSmallestSize = C_LARGE;
+    cVector3d texCoord;
+    for (int i=0; i<3; i++)
+    {
+        double s = fabs(objectRange(i));
+        double size = (texRange(i) == 0.0) ? s : cMin(s, (s / (texRange(i) * texSize[i])));
+        voxelSmallestSize = cMin(voxelSmallestSize, size);
+        texCoord(i) = m_minTextureCoord(i) + ((a_localPos(i) - m_minCorner(i)) / (objectRange(i)) * (texRange(i)));
+    }
+
+    int texel[3];
+    image->getVoxelLocation(texCoord, texel[0], texel[1], texel[2], true);
+    int voxels = m_distanceField->getVoxelDistance(texel[0], texel[1], texel[2]);
+
+    // the point can be anywhere in its voxel
+    a_distance = cSign((double)voxels) * cMax(0, cAbs(voxels) - 1) * voxelSmallestSize;
+    return (C_SUCCESS);
+}
+
+
 //==============================================================================
 /*!
     This method converts this voxel object into a triangle multi-mesh.\n
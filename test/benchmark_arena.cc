@@ -0,0 +1,222 @@
+// Arena benchmark: does allocating the objects of a world in its arena
+// (cWorld::getObjectArena) make the haptic traversal and the teardown
+// of large levels faster?
+//
+// Two worlds of 100 to --max-objects objects (spheres, boxes and box
+// meshes with collision trees and effects) are built at the same time,
+// one with `new` and one with cArena::create, interleaved with other
+// allocations of random sizes, half of which are freed, as a game does
+// while it loads a level. A tool then walks through both worlds for
+// --ticks ticks; each tick updates the global positions and computes
+// the interaction forces. The build time, the time of a tick (p50/p99)
+// and the time to delete each world are printed and written to a JSON
+// file. Exits with an error if the forces of the two worlds differ.
+//
+// The world deleted second pays for the memory the allocator gives
+// back after the first one, so the pair is built twice and deleted in
+// both orders; the delete times are the mean of the two.
+//
+// Usage: benchmark_arena [--max-objects N] [--ticks N]
+//                        [--output file.json]
+
+#include "benchmark_common.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <list>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Object `i` of a world, created in `arena` (on the heap if nullptr)
+chai3d::cGenericObject * createObject (int i, chai3d::cArena * arena) {
+  chai3d::cGenericObject * object;
+  switch (i % 3) {
+  case 0:
+    object = chai3d::cArena::create<chai3d::cShapeSphere> (arena, 0.01);
+    break;
+  case 1:
+    object = chai3d::cArena::create<chai3d::cShapeBox> (arena, 0.02, 0.01, 0.015);
+    break;
+  default: {
+    chai3d::cMesh * mesh = chai3d::cArena::create<chai3d::cMesh> (arena);
+    chai3d::cCreateBox (mesh, 0.02, 0.02, 0.01);
+    mesh -> computeBoundaryBox (true);
+    mesh -> createAABBCollisionDetector (0.001);
+    object = mesh;
+    break;
+  }
+  }
+  object -> m_material -> setStiffness (500.0);
+  object -> m_material -> setMagnetMaxForce (2.0);
+  object -> m_material -> setMagnetMaxDistance (0.02);
+  object -> createEffectSurface ();
+  if (i % 2 == 0) { object -> createEffectMagnetic (); }
+  return object;
+}
+
+// Builds a world on the heap and a world in its arena with `count`
+// objects each, and adds their build times in microseconds
+void buildWorlds (int count, std::list<std::vector<char>> & garbage,
+		  chai3d::cWorld *& heapWorld, chai3d::cWorld *& arenaWorld,
+		  double & heapBuild, double & arenaBuild) {
+  std::mt19937 rng (42);
+  std::uniform_real_distribution<double> position (-0.5, 0.5);
+  std::uniform_int_distribution<int> garbageSize (16, 512);
+
+  heapWorld = new chai3d::cWorld ();
+  arenaWorld = new chai3d::cWorld ();
+  for (int i = 0; i < count; ++i) {
+    chai3d::cVector3d pos (position (rng), position (rng), position (rng));
+
+    auto begin = std::chrono::steady_clock::now ();
+    chai3d::cGenericObject * object = createObject (i, nullptr);
+    object -> setLocalPos (pos);
+    heapWorld -> addChild (object);
+    heapBuild += elapsedUs (begin);
+
+    begin = std::chrono::steady_clock::now ();
+    object = createObject (i, arenaWorld -> getObjectArena ());
+    object -> setLocalPos (pos);
+    arenaWorld -> addChild (object);
+    arenaBuild += elapsedUs (begin);
+
+    // other allocations of the game, half of them short lived
+    garbage.emplace_back (garbageSize (rng));
+    garbage.emplace_back (garbageSize (rng));
+    garbage.pop_front ();
+  }
+  heapWorld -> computeGlobalPositions (false);
+  arenaWorld -> computeGlobalPositions (false);
+}
+
+// Deletes a world and returns the time it took in milliseconds
+double deleteWorld (chai3d::cWorld * world) {
+  auto begin = std::chrono::steady_clock::now ();
+  delete world;
+  return elapsedUs (begin) / 1000.0;
+}
+
+int main (int argc, char * argv []) {
+  int maxObjects = 10000;
+  int ticks = 5000;
+  std::string output = "benchmark-arena.json";
+
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv [i];
+    bool hasValue = i + 1 < argc;
+    if (arg == "--max-objects" && hasValue) {
+      maxObjects = std::stoi (argv [++i]);
+    } else if (arg == "--ticks" && hasValue) {
+      ticks = std::stoi (argv [++i]);
+    } else if (arg == "--output" && hasValue) {
+      output = argv [++i];
+    } else {
+      std::cerr << "Unknown or incomplete option " << arg << "\n"
+		<< "Options: --max-objects --ticks --output\n";
+      return 1;
+    }
+  }
+
+  std::cout << std::fixed << std::setprecision (2)
+	    << std::setw (9) << "objects" << std::setw (11) << "heap ms"
+	    << std::setw (11) << "arena ms" << std::setw (11) << "heap p50"
+	    << std::setw (11) << "arena p50" << std::setw (11) << "heap p99"
+	    << std::setw (11) << "arena p99" << std::setw (11) << "heap del"
+	    << std::setw (11) << "arena del" << std::setw (10) << "arena MB"
+	    << std::setw (10) << "mismatch\n";
+
+  bool allOk = true;
+  std::ostringstream json;
+  json << std::setprecision (10)
+       << "{\n  \"benchmark\": \"arena\",\n  \"ticks\": " << ticks
+       << ",\n  \"results\": [\n";
+  for (int count = 100; count <= maxObjects; count *= 10) {
+    std::mt19937 rng (42);
+    std::uniform_real_distribution<double> position (-0.5, 0.5);
+
+    chai3d::cWorld * heapWorld;
+    chai3d::cWorld * arenaWorld;
+    std::list<std::vector<char>> garbage;
+    double heapBuild = 0.0;
+    double arenaBuild = 0.0;
+    buildWorlds (count, garbage, heapWorld, arenaWorld, heapBuild, arenaBuild);
+    double arenaMb = arenaWorld -> getObjectArena () -> getMemoryUsage () / 1048576.0;
+
+    // the tool walks in a straight line between random points
+    std::vector<double> heapTicks, arenaTicks;
+    chai3d::cInteractionRecorder recorder;
+    chai3d::cVector3d tool (0.0, 0.0, 0.0);
+    chai3d::cVector3d goal (position (rng), position (rng), position (rng));
+    int mismatches = 0;
+    for (int t = 0; t < ticks; ++t) {
+      chai3d::cVector3d toGoal = goal - tool;
+      if (toGoal.length () < 0.002) {
+	goal.set (position (rng), position (rng), position (rng));
+      }
+      chai3d::cVector3d velocity = (0.002 / std::max (0.002, toGoal.length ())) * toGoal;
+      tool += velocity;
+      velocity *= 1000.0;
+
+      auto begin = std::chrono::steady_clock::now ();
+      heapWorld -> computeGlobalPositions (true);
+      recorder.clear ();
+      chai3d::cVector3d heapForce = heapWorld -> computeInteractions (tool, velocity, 0, recorder);
+      heapTicks.push_back (elapsedUs (begin));
+
+      begin = std::chrono::steady_clock::now ();
+      arenaWorld -> computeGlobalPositions (true);
+      recorder.clear ();
+      chai3d::cVector3d arenaForce = arenaWorld -> computeInteractions (tool, velocity, 0, recorder);
+      arenaTicks.push_back (elapsedUs (begin));
+
+      mismatches += chai3d::cDistance (heapForce, arenaForce) == 0.0 ? 0 : 1;
+    }
+    allOk = allOk && (mismatches == 0);
+
+    double heapDelete = deleteWorld (heapWorld);
+    double arenaDelete = deleteWorld (arenaWorld);
+
+    // same worlds, deleted in the other order
+    double unused = 0.0;
+    buildWorlds (count, garbage, heapWorld, arenaWorld, unused, unused);
+    arenaDelete = (arenaDelete + deleteWorld (arenaWorld)) / 2.0;
+    heapDelete = (heapDelete + deleteWorld (heapWorld)) / 2.0;
+
+    Latency heapTick = summarize (heapTicks);
+    Latency arenaTick = summarize (arenaTicks);
+    std::cout << std::setw (9) << count
+	      << std::setw (11) << heapBuild / 1000.0 << std::setw (11) << arenaBuild / 1000.0
+	      << std::setw (11) << heapTick.p50 << std::setw (11) << arenaTick.p50
+	      << std::setw (11) << heapTick.p99 << std::setw (11) << arenaTick.p99
+	      << std::setw (11) << heapDelete << std::setw (11) << arenaDelete
+	      << std::setw (10) << arenaMb << std::setw (9) << mismatches << "\n";
+
+    json << (count == 100 ? "" : ",\n")
+	 << "    { \"objects\": " << count
+	 << ", \"heap_build_ms\": " << heapBuild / 1000.0
+	 << ", \"arena_build_ms\": " << arenaBuild / 1000.0
+	 << ", \"heap_tick_us\": { \"p50\": " << heapTick.p50 << ", \"p99\": " << heapTick.p99 << " }"
+	 << ", \"arena_tick_us\": { \"p50\": " << arenaTick.p50 << ", \"p99\": " << arenaTick.p99 << " }"
+	 << ", \"heap_delete_ms\": " << heapDelete
+	 << ", \"arena_delete_ms\": " << arenaDelete
+	 << ", \"arena_mb\": " << arenaMb
+	 << ", \"mismatches\": " << mismatches << " }";
+  }
+  json << "\n  ]\n}\n";
+
+  std::ofstream file (output);
+  file << json.str ();
+  std::cout << "Results written to " << output << "\n";
+
+  if (!allOk) {
+    std::cerr << "The forces of the worlds in the heap and in the arena differ\n";
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,325 @@
+// Collision micro-benchmark: how do the collision detectors scale?
+//
+// For every shape (sphere, noisy terrain, CAD-like thin fins) and every
+// mesh size, each detector configuration is built on the same mesh and
+// then queried with proxy-like segments: short segments crossing (or
+// grazing) the surface, as the finger proxy does every tick. Build
+// time, memory and the query latency distribution are printed and
+// written to a JSON file. The aabb-cache-* rows save the padded tree to
+// --cache-dir and map it back, their build column is the save (store)
+// or load (load) time.
+//
+// Usage: benchmark_collision [--sizes 100,1000,...] [--shapes sphere,terrain,cad]
+//                            [--queries N] [--radius R] [--brute-max N]
+//                            [--cache-dir dir] [--output file.json]
+
+#include "benchmark_common.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+struct Detector {
+  std::string name;
+  // Build the detector for `mesh`, return its memory usage (bytes)
+  std::function<size_t (chai3d::cMesh * mesh, double radius)> build;
+  // Largest mesh (triangles) to test. 0 means no limit
+  unsigned int maxTriangles;
+};
+
+////////////////////////////////////////////////////////////////////////
+// Meshes (sizes are approximate, in triangles)
+////////////////////////////////////////////////////////////////////////
+
+// Height field on [-1, 1]^2 with deterministic multi-scale noise
+chai3d::cMesh * terrainMesh (unsigned int triangles) {
+  chai3d::cMesh * m = new chai3d::cMesh ();
+  int n = std::max (2, (int)sqrt (triangles / 2.0));
+  for (int j = 0; j <= n; ++j) {
+    for (int i = 0; i <= n; ++i) {
+      double x = -1.0 + 2.0 * i / n;
+      double y = -1.0 + 2.0 * j / n;
+      double z = 0.1 * sin (3.0 * x) * cos (4.0 * y)
+	+ 0.03 * sin (17.0 * x + 11.0 * y)
+	+ 0.01 * sin (97.0 * x) * sin (83.0 * y);
+      m -> newVertex (x, y, z);
+    }
+  }
+  for (int j = 0; j < n; ++j) {
+    for (int i = 0; i < n; ++i) {
+      int a = j * (n + 1) + i;
+      addQuad (m, a, a + 1, a + n + 2, a + n + 1);
+    }
+  }
+  return m;
+}
+
+void addBox (chai3d::cMesh * m, chai3d::cVector3d min, chai3d::cVector3d max) {
+  int v = m -> newVertex (min.x (), min.y (), min.z ());
+  m -> newVertex (max.x (), min.y (), min.z ());
+  m -> newVertex (max.x (), max.y (), min.z ());
+  m -> newVertex (min.x (), max.y (), min.z ());
+  m -> newVertex (min.x (), min.y (), max.z ());
+  m -> newVertex (max.x (), min.y (), max.z ());
+  m -> newVertex (max.x (), max.y (), max.z ());
+  m -> newVertex (min.x (), max.y (), max.z ());
+  addQuad (m, v + 0, v + 3, v + 2, v + 1);
+  addQuad (m, v + 4, v + 5, v + 6, v + 7);
+  addQuad (m, v + 0, v + 1, v + 5, v + 4);
+  addQuad (m, v + 2, v + 3, v + 7, v + 6);
+  addQuad (m, v + 1, v + 2, v + 6, v + 5);
+  addQuad (m, v + 0, v + 4, v + 7, v + 3);
+}
+
+// A plate with a grid of thin, tall fins: long skinny triangles and
+// many parallel surfaces close to each other
+chai3d::cMesh * cadMesh (unsigned int triangles) {
+  chai3d::cMesh * m = new chai3d::cMesh ();
+  addBox (m, chai3d::cVector3d (-1.0, -1.0, -0.05),
+	  chai3d::cVector3d (1.0, 1.0, 0.0));
+  int fins = std::max (1, (int)(triangles / 12) - 1);
+  int rows = std::max (1, (int)sqrt (fins / 8.0));
+  int perRow = std::max (1, fins / rows);
+  double pitch = 2.0 / perRow;
+  double thickness = std::min (0.002, pitch * 0.2);
+  for (int r = 0; r < rows; ++r) {
+    double y0 = -1.0 + 2.0 * r / rows;
+    double y1 = -1.0 + 2.0 * (r + 1) / rows - 0.01;
+    for (int i = 0; i < perRow; ++i) {
+      double x = -1.0 + (i + 0.5) * pitch;
+      addBox (m, chai3d::cVector3d (x - thickness, y0, 0.0),
+	      chai3d::cVector3d (x + thickness, y1, 0.3));
+    }
+  }
+  return m;
+}
+
+size_t meshMemoryUsage (chai3d::cMesh * m) {
+  auto v = m -> m_vertices;
+  size_t bytes = 0;
+  bytes += v -> m_localPos.capacity () * sizeof (chai3d::cVector3d);
+  bytes += v -> m_globalPos.capacity () * sizeof (chai3d::cVector3d);
+  bytes += v -> m_normal.capacity () * sizeof (chai3d::cVector3d);
+  bytes += v -> m_texCoord.capacity () * sizeof (chai3d::cVector3d);
+  bytes += v -> m_color.capacity () * sizeof (chai3d::cColorf);
+  bytes += v -> m_tangent.capacity () * sizeof (chai3d::cVector3d);
+  bytes += v -> m_bitangent.capacity () * sizeof (chai3d::cVector3d);
+  bytes += v -> m_userData.capacity () * sizeof (int);
+  bytes += m -> m_triangles -> m_indices.capacity () * sizeof (unsigned int);
+  bytes += m -> m_triangles -> m_allocated.capacity () / 8;
+  return bytes;
+}
+
+////////////////////////////////////////////////////////////////////////
+// Main
+////////////////////////////////////////////////////////////////////////
+
+struct Result {
+  std::string shape;
+  std::string detector;
+  unsigned int triangles;
+  double build_ms;
+  size_t detector_bytes;
+  size_t mesh_bytes;
+  int hits;
+  double mean_us, p50_us, p99_us, max_us;
+};
+
+std::vector<std::string> split (const std::string & s) {
+  std::vector<std::string> res;
+  std::stringstream ss (s);
+  std::string item;
+  while (std::getline (ss, item, ',')) { res.push_back (item); }
+  return res;
+}
+
+// Same naming as cMesh::createAABBCollisionDetector (radius, cacheDirectory)
+std::string cacheFile (const std::string & dir, unsigned long long hash) {
+  char name [32];
+  snprintf (name, sizeof (name), "aabb-%016llx.bin", hash);
+  return dir + "/" + name;
+}
+
+int main (int argc, char * argv []) {
+  std::vector<unsigned int> sizes { 100, 1000, 10000, 100000, 1000000, 2000000 };
+  std::vector<std::string> shapes { "sphere", "terrain", "cad" };
+  int queriesNum = 2000;
+  double radius = 0.005;
+  unsigned int bruteMax = 20000;
+  std::string output = "benchmark-collision.json";
+  std::string cacheDir = ".";
+
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv [i];
+    bool hasValue = i + 1 < argc;
+    if (arg == "--sizes" && hasValue) {
+      sizes.clear ();
+      for (auto & s : split (argv [++i])) { sizes.push_back (std::stoul (s)); }
+    } else if (arg == "--shapes" && hasValue) {
+      shapes = split (argv [++i]);
+    } else if (arg == "--queries" && hasValue) {
+      queriesNum = std::stoi (argv [++i]);
+    } else if (arg == "--radius" && hasValue) {
+      radius = std::stod (argv [++i]);
+    } else if (arg == "--brute-max" && hasValue) {
+      bruteMax = std::stoul (argv [++i]);
+    } else if (arg == "--cache-dir" && hasValue) {
+      cacheDir = argv [++i];
+    } else if (arg == "--output" && hasValue) {
+      output = argv [++i];
+    } else {
+      std::cerr << "Unknown or incomplete option " << arg << "\n"
+		<< "Options: --sizes --shapes --queries --radius --brute-max --cache-dir --output\n";
+      return 1;
+    }
+  }
+
+  std::vector<Detector> detectors {
+    { "brute",
+      [] (chai3d::cMesh * m, double) {
+	m -> createBruteForceCollisionDetector ();
+	return (size_t) 0;
+      }, bruteMax },
+    // Tree built without padding: only exact for point tools, the hits
+    // column shows the contacts it misses when queried with a radius
+    { "aabb",
+      [] (chai3d::cMesh * m, double) {
+	auto tree = new cCollisionAABBProbe ();
+	tree -> initialize (m -> m_triangles, 0.0);
+	m -> setCollisionDetector (tree);
+	return tree -> getMemoryUsage ();
+      }, 0 },
+    // Padded by the tool radius, as done by `create_mesh_object`
+    { "aabb-radius",
+      [] (chai3d::cMesh * m, double r) {
+	auto tree = new cCollisionAABBProbe ();
+	tree -> initialize (m -> m_triangles, r);
+	m -> setCollisionDetector (tree);
+	return tree -> getMemoryUsage ();
+      }, 0 },
+    // Same tree, built and saved to the cache
+    { "aabb-cache-store",
+      [&cacheDir] (chai3d::cMesh * m, double r) {
+	auto tree = new cCollisionAABBProbe ();
+	tree -> initialize (m -> m_triangles, r);
+	unsigned long long hash = chai3d::cCollisionAABB::computeHash (m -> m_triangles, r);
+	tree -> saveToFile (cacheFile (cacheDir, hash), hash);
+	m -> setCollisionDetector (tree);
+	return tree -> getMemoryUsage ();
+      }, 0 },
+    // Same tree, mapped from the file saved above
+    { "aabb-cache-load",
+      [&cacheDir] (chai3d::cMesh * m, double r) {
+	auto tree = new cCollisionAABBProbe ();
+	unsigned long long hash = chai3d::cCollisionAABB::computeHash (m -> m_triangles, r);
+	if (!tree -> loadFromFile (m -> m_triangles, r, cacheFile (cacheDir, hash), hash)) {
+	  std::cerr << "Cannot load cached tree from " << cacheDir << "\n";
+	  tree -> initialize (m -> m_triangles, r);
+	}
+	m -> setCollisionDetector (tree);
+	return tree -> getMemoryUsage ();
+      }, 0 },
+  };
+
+  std::vector<Result> results;
+  std::cout << std::fixed << std::setprecision (2)
+	    << std::setw (8) << "shape" << std::setw (18) << "detector"
+	    << std::setw (10) << "tris" << std::setw (11) << "build ms"
+	    << std::setw (10) << "tree MB" << std::setw (10) << "mesh MB"
+	    << std::setw (8) << "hits" << std::setw (10) << "p50 us"
+	    << std::setw (10) << "p99 us" << "\n";
+
+  for (auto & shape : shapes) {
+    for (auto size : sizes) {
+      chai3d::cMesh * mesh;
+      if (shape == "terrain") {
+	mesh = terrainMesh (size);
+      } else if (shape == "cad") {
+	mesh = cadMesh (size);
+      } else {
+	mesh = sphereMesh (size);
+      }
+      mesh -> m_material -> setHapticTriangleSides (true, true);
+      unsigned int triangles = mesh -> m_triangles -> getNumElements ();
+      auto queries = surfaceQueries (mesh, queriesNum, radius, 42 + size);
+
+      chai3d::cCollisionSettings settings;
+      settings.m_checkForNearestCollisionOnly = true;
+      settings.m_collisionRadius = radius;
+      chai3d::cCollisionRecorder recorder;
+
+      for (auto & detector : detectors) {
+	if (detector.maxTriangles > 0 && triangles > detector.maxTriangles) {
+	  continue;
+	}
+	mesh -> deleteCollisionDetector ();
+
+	auto begin = std::chrono::steady_clock::now ();
+	size_t bytes = detector.build (mesh, radius);
+	double buildMs = elapsedMs (begin);
+
+	std::vector<double> latencies;
+	latencies.reserve (queries.size ());
+	int hits = 0;
+	for (auto & q : queries) {
+	  recorder.clear ();
+	  auto start = std::chrono::steady_clock::now ();
+	  bool hit = mesh -> getCollisionDetector () ->
+	    computeCollision (mesh, q.a, q.b, recorder, settings);
+	  latencies.push_back (elapsedUs (start));
+	  hits += hit ? 1 : 0;
+	}
+	Latency latency = summarize (latencies);
+
+	Result r { shape, detector.name, triangles, buildMs, bytes,
+		   meshMemoryUsage (mesh), hits,
+		   latency.mean, latency.p50, latency.p99, latency.max };
+	results.push_back (r);
+
+	std::cout << std::setw (8) << r.shape << std::setw (18) << r.detector
+		  << std::setw (10) << r.triangles << std::setw (11) << r.build_ms
+		  << std::setw (10) << r.detector_bytes / 1048576.0
+		  << std::setw (10) << r.mesh_bytes / 1048576.0
+		  << std::setw (8) << r.hits << std::setw (10) << r.p50_us
+		  << std::setw (10) << r.p99_us << "\n";
+      }
+      std::string cached = cacheFile (cacheDir, chai3d::cCollisionAABB::computeHash (mesh -> m_triangles, radius));
+      delete mesh;
+      remove (cached.c_str ());
+    }
+  }
+
+  std::ofstream out (output);
+  out << std::setprecision (10)
+      << "{\n  \"benchmark\": \"collision\",\n"
+      << "  \"queries\": " << queriesNum << ",\n"
+      << "  \"radius\": " << radius << ",\n"
+      << "  \"results\": [\n";
+  for (size_t i = 0; i < results.size (); ++i) {
+    auto & r = results [i];
+    out << "    { \"shape\": \"" << r.shape << "\", \"detector\": \"" << r.detector
+	<< "\", \"triangles\": " << r.triangles
+	<< ", \"build_ms\": " << r.build_ms
+	<< ", \"detector_bytes\": " << r.detector_bytes
+	<< ", \"mesh_bytes\": " << r.mesh_bytes
+	<< ", \"hits\": " << r.hits
+	<< ", \"mean_us\": " << r.mean_us
+	<< ", \"p50_us\": " << r.p50_us
+	<< ", \"p99_us\": " << r.p99_us
+	<< ", \"max_us\": " << r.max_us << " }"
+	<< (i + 1 < results.size () ? ",\n" : "\n");
+  }
+  out << "  ]\n}\n";
+
+  return 0;
+}
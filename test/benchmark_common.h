@@ -0,0 +1,221 @@
+// Helpers shared by the benchmarks (benchmark_*.cc): timers, latency
+// percentiles, test meshes and proxy-like collision queries.
+
+#ifndef BENCHMARK_COMMON_H
+#define BENCHMARK_COMMON_H
+
+#include "../include/chai3d.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////
+// Timing
+////////////////////////////////////////////////////////////////////////
+
+inline double elapsedUs (std::chrono::steady_clock::time_point begin) {
+  return std::chrono::duration<double, std::micro>
+    (std::chrono::steady_clock::now () - begin).count ();
+}
+
+inline double elapsedMs (std::chrono::steady_clock::time_point begin) {
+  return std::chrono::duration<double, std::milli>
+    (std::chrono::steady_clock::now () - begin).count ();
+}
+
+struct Latency {
+  double mean;
+  double p50;
+  double p99;
+  double max;
+};
+
+// Sorts `latencies`, that must not be empty
+inline Latency summarize (std::vector<double> & latencies) {
+  std::sort (latencies.begin (), latencies.end ());
+  double sum = 0.0;
+  for (auto l : latencies) { sum += l; }
+  return Latency { sum / latencies.size (),
+		   latencies [latencies.size () / 2],
+		   latencies [(size_t) (0.99 * (latencies.size () - 1))],
+		   latencies.back () };
+}
+
+////////////////////////////////////////////////////////////////////////
+// Meshes
+////////////////////////////////////////////////////////////////////////
+
+// Exposes the size of the tree
+class cCollisionAABBProbe : public chai3d::cCollisionAABB {
+public:
+  size_t getMemoryUsage () const {
+    return m_numNodes * sizeof (chai3d::cCollisionAABBNode);
+  }
+  int getMaxDepth () const { return m_maxDepth; }
+};
+
+inline void addQuad (chai3d::cMesh * m, int a, int b, int c, int d) {
+  m -> newTriangle (a, b, c);
+  m -> newTriangle (a, c, d);
+}
+
+// Unit sphere with about `triangles` triangles
+inline chai3d::cMesh * sphereMesh (unsigned int triangles) {
+  chai3d::cMesh * m = new chai3d::cMesh ();
+  int rings = std::max (3, (int)sqrt (triangles / 4.0));
+  int sectors = 2 * rings;
+  for (int r = 0; r <= rings; ++r) {
+    double theta = M_PI * r / rings;
+    for (int s = 0; s <= sectors; ++s) {
+      double phi = 2.0 * M_PI * s / sectors;
+      m -> newVertex (sin (theta) * cos (phi), sin (theta) * sin (phi),
+		      cos (theta));
+    }
+  }
+  for (int r = 0; r < rings; ++r) {
+    for (int s = 0; s < sectors; ++s) {
+      int a = r * (sectors + 1) + s;
+      int b = a + sectors + 1;
+      addQuad (m, a, b, b + 1, a + 1);
+    }
+  }
+  return m;
+}
+
+////////////////////////////////////////////////////////////////////////
+// Queries
+////////////////////////////////////////////////////////////////////////
+
+struct Query {
+  chai3d::cVector3d a;
+  chai3d::cVector3d b;
+};
+
+// Nearest contact found by a query
+struct Contact {
+  bool hit;
+  chai3d::cVector3d position;
+};
+
+// Short segment at the surface point `p` of normal `n`, as the proxy
+// moves: from outside the shell of the tool to just inside the surface
+// or, if `grazing`, tangentially a bit outside the shell. The tangent
+// is normal to `n` and `edge`
+inline Query proxyQuery (const chai3d::cVector3d & p, const chai3d::cVector3d & n,
+			 const chai3d::cVector3d & edge, bool grazing,
+			 double radius, std::mt19937 & rng) {
+  std::uniform_real_distribution<double> unit (0.0, 1.0);
+  const double step = std::max (radius, 0.002);
+  Query q;
+  if (! grazing) {
+    q.a = p + (radius + step * unit (rng)) * n;
+    q.b = p - step * unit (rng) * n;
+  } else {
+    chai3d::cVector3d tangent = chai3d::cCross (n, edge);
+    if (tangent.length () < 1e-12) { tangent.set (1.0, 0.0, 0.0); }
+    tangent.normalize ();
+    chai3d::cVector3d start = p + (radius + step * (0.5 + unit (rng))) * n;
+    q.a = start - step * tangent;
+    q.b = start + step * tangent;
+  }
+  return q;
+}
+
+// Proxy queries around random points of the surface of `m`; one in
+// four grazes it
+inline std::vector<Query> surfaceQueries (chai3d::cMesh * m, int count, double radius,
+					  unsigned int seed) {
+  std::mt19937 rng (seed);
+  unsigned int triangles = m -> m_triangles -> getNumElements ();
+  std::uniform_int_distribution<unsigned int> pick (0, triangles - 1);
+  std::uniform_real_distribution<double> unit (0.0, 1.0);
+
+  std::vector<Query> queries;
+  for (int i = 0; i < count; ++i) {
+    unsigned int t = pick (rng);
+    auto v0 = m -> m_vertices -> getLocalPos (m -> m_triangles -> getVertexIndex0 (t));
+    auto v1 = m -> m_vertices -> getLocalPos (m -> m_triangles -> getVertexIndex1 (t));
+    auto v2 = m -> m_vertices -> getLocalPos (m -> m_triangles -> getVertexIndex2 (t));
+    double u = unit (rng), v = unit (rng);
+    if (u + v > 1.0) { u = 1.0 - u; v = 1.0 - v; }
+    chai3d::cVector3d p = v0 + u * (v1 - v0) + v * (v2 - v0);
+    chai3d::cVector3d n = chai3d::cCross (v1 - v0, v2 - v0);
+    if (n.length () < 1e-12) { n.set (0.0, 0.0, 1.0); }
+    n.normalize ();
+    queries.push_back (proxyQuery (p, n, v1 - v0, i % 4 == 3, radius, rng));
+  }
+  return queries;
+}
+
+// Proxy queries around points of the unit sphere; one in four grazes
+// it. With a `walkStep` (radians), the points follow a random walk,
+// as a tool sliding on the surface; otherwise they are independent
+inline std::vector<Query> sphereQueries (int count, double radius, double walkStep,
+					 unsigned int seed) {
+  std::mt19937 rng (seed);
+  std::normal_distribution<double> normal (0.0, 1.0);
+
+  std::vector<Query> queries;
+  chai3d::cVector3d n (1.0, 0.0, 0.0);
+  for (int i = 0; i < count; ++i) {
+    chai3d::cVector3d move (normal (rng), normal (rng), normal (rng));
+    if (walkStep > 0.0) {
+      n += walkStep * move;
+    } else {
+      n = move;
+      if (n.length () < 1e-9) { n.set (0.0, 0.0, 1.0); }
+    }
+    n.normalize ();
+    queries.push_back (proxyQuery (n, n, chai3d::cVector3d (0.0, 0.0, 1.0),
+				   i % 4 == 3, radius, rng));
+  }
+  return queries;
+}
+
+// Segments of random directions and lengths up to `length`, starting
+// anywhere in the cube [-extent, extent]^3
+inline std::vector<Query> volumeQueries (int count, double extent, double length,
+					 unsigned int seed) {
+  std::mt19937 rng (seed);
+  std::uniform_real_distribution<double> position (-extent, extent);
+  std::uniform_real_distribution<double> lengths (0.0, length);
+  std::normal_distribution<double> direction (0.0, 1.0);
+  std::vector<Query> queries (count);
+  for (auto & q : queries) {
+    q.a.set (position (rng), position (rng), position (rng));
+    chai3d::cVector3d d (direction (rng), direction (rng), direction (rng));
+    if (d.length () < 1e-9) { d.set (1.0, 0.0, 0.0); }
+    d.normalize ();
+    q.b = q.a + lengths (rng) * d;
+  }
+  return queries;
+}
+
+// Runs the queries against `object` with the tool radius, and stores
+// the nearest contact of each one. Returns the latencies (us)
+inline Latency runQueries (chai3d::cGenericObject * object, const std::vector<Query> & queries,
+			   double radius, std::vector<Contact> & contacts) {
+  chai3d::cCollisionSettings settings;
+  settings.m_checkForNearestCollisionOnly = true;
+  settings.m_collisionRadius = radius;
+  chai3d::cCollisionRecorder recorder;
+
+  std::vector<double> latencies;
+  latencies.reserve (queries.size ());
+  contacts.resize (queries.size ());
+  for (size_t i = 0; i < queries.size (); ++i) {
+    recorder.clear ();
+    auto start = std::chrono::steady_clock::now ();
+    bool hit = object -> computeCollisionDetection (queries [i].a, queries [i].b,
+						    recorder, settings);
+    latencies.push_back (elapsedUs (start));
+    contacts [i].hit = hit;
+    contacts [i].position = recorder.m_nearestCollision.m_localPos;
+  }
+  return summarize (latencies);
+}
+
+#endif
@@ -0,0 +1,227 @@
+// Mesh compaction benchmark: do memory and collision queries follow the
+// geometry that is left after a mesh is edited?
+//
+// Spheres of about 1k to --max-triangles triangles are edited as a
+// cutting or sculpting tool would: for --rounds rounds, --edit-fraction
+// of the live triangles are removed and half of them are replaced by
+// new triangles (on new vertices) pushed slightly inside, then a cut
+// removes every triangle on one side of a plane. Dead triangles and
+// orphan vertices are still stored and still in the collision tree.
+// The memory used by the mesh and its tree and the latency of proxy-like
+// segment queries are measured before and after cMesh::compress, and
+// written to a JSON file. Exits with an error if a query result changes.
+//
+// Usage: benchmark_compress [--max-triangles N] [--rounds N]
+//                           [--edit-fraction F] [--queries N]
+//                           [--output file.json]
+
+#include "benchmark_common.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+struct Measure {
+  double p50_us;
+  double p99_us;
+  std::vector<chai3d::cVector3d> hits;
+};
+
+std::vector<unsigned int> liveTriangles (chai3d::cMesh * m) {
+  std::vector<unsigned int> live;
+  for (unsigned int i = 0; i < m -> m_triangles -> getNumElements (); ++i) {
+    if (m -> m_triangles -> getAllocated (i)) { live.push_back (i); }
+  }
+  return live;
+}
+
+void edit (chai3d::cMesh * m, int rounds, double fraction, std::mt19937 & rng) {
+  for (int r = 0; r < rounds; ++r) {
+    std::vector<unsigned int> live = liveTriangles (m);
+    std::shuffle (live.begin (), live.end (), rng);
+    size_t removed = (size_t)(fraction * live.size ());
+    for (size_t k = 0; k < removed; ++k) {
+      unsigned int t = live [k];
+      chai3d::cVector3d p [3];
+      for (int v = 0; v < 3; ++v) {
+	p [v] = m -> m_vertices -> getLocalPos (m -> m_triangles -> getVertexIndex (t, v));
+      }
+      m -> removeTriangle (t);
+      if (k % 2 == 0) {
+	m -> newTriangle (0.98 * p [0], 0.98 * p [1], 0.98 * p [2]);
+      }
+    }
+  }
+
+  // cut
+  for (unsigned int t : liveTriangles (m)) {
+    chai3d::cVector3d centroid (0, 0, 0);
+    for (int v = 0; v < 3; ++v) {
+      centroid += m -> m_vertices -> getLocalPos (m -> m_triangles -> getVertexIndex (t, v));
+    }
+    if (centroid.x () > 0.6) { m -> removeTriangle (t); }
+  }
+}
+
+size_t memoryUsage (chai3d::cMesh * m, cCollisionAABBProbe * tree) {
+  auto t = m -> m_triangles;
+  return m -> m_vertices -> getMemoryUsage () + tree -> getMemoryUsage ()
+    + t -> m_indices.capacity () * sizeof (unsigned int)
+    + t -> m_allocated.capacity () / 8;
+}
+
+Measure measure (chai3d::cMesh * m, std::vector<Query> & queries, int repeats) {
+  chai3d::cCollisionSettings settings;
+  settings.m_checkForNearestCollisionOnly = true;
+  chai3d::cCollisionRecorder recorder;
+  Measure result;
+  std::vector<double> latencies;
+  for (int r = 0; r < repeats; ++r) {
+    for (auto & q : queries) {
+      recorder.clear ();
+      auto start = std::chrono::steady_clock::now ();
+      bool hit = m -> getCollisionDetector () ->
+	computeCollision (m, q.a, q.b, recorder, settings);
+      latencies.push_back (elapsedUs (start));
+      if (r == 0) {
+	result.hits.push_back (hit ? recorder.m_nearestCollision.m_localPos
+			       : chai3d::cVector3d (0, 0, 0));
+      }
+    }
+  }
+  Latency latency = summarize (latencies);
+  result.p50_us = latency.p50;
+  result.p99_us = latency.p99;
+  return result;
+}
+
+int main (int argc, char * argv []) {
+  unsigned int maxTriangles = 256000;
+  int rounds = 10;
+  double fraction = 0.1;
+  unsigned int queriesNum = 2000;
+  std::string output = "benchmark-compress.json";
+
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv [i];
+    bool hasValue = i + 1 < argc;
+    if (arg == "--max-triangles" && hasValue) {
+      maxTriangles = std::stoul (argv [++i]);
+    } else if (arg == "--rounds" && hasValue) {
+      rounds = std::stoi (argv [++i]);
+    } else if (arg == "--edit-fraction" && hasValue) {
+      fraction = std::stod (argv [++i]);
+    } else if (arg == "--queries" && hasValue) {
+      queriesNum = std::stoul (argv [++i]);
+    } else if (arg == "--output" && hasValue) {
+      output = argv [++i];
+    } else {
+      std::cerr << "Unknown or incomplete option " << arg << "\n"
+		<< "Options: --max-triangles --rounds --edit-fraction --queries --output\n";
+      return 1;
+    }
+  }
+
+  std::cout << std::fixed << std::setprecision (2)
+	    << std::setw (10) << "triangles" << std::setw (10) << "live"
+	    << std::setw (10) << "slots" << std::setw (10) << "vertices"
+	    << std::setw (10) << "MB" << std::setw (10) << "p50 us"
+	    << std::setw (10) << "p99 us" << std::setw (10) << "slots"
+	    << std::setw (10) << "vertices" << std::setw (10) << "MB"
+	    << std::setw (10) << "p50 us" << std::setw (10) << "p99 us"
+	    << std::setw (12) << "compress ms" << std::setw (10) << "mismatch\n";
+
+  bool allOk = true;
+  std::ostringstream json;
+  json << std::setprecision (10)
+       << "{\n  \"benchmark\": \"compress\",\n  \"rounds\": " << rounds
+       << ",\n  \"edit_fraction\": " << fraction
+       << ",\n  \"queries\": " << queriesNum << ",\n  \"results\": [\n";
+  for (unsigned int size = 1000; size <= maxTriangles; size *= 4) {
+    std::mt19937 rng (42 + size);
+    chai3d::cMesh * mesh = sphereMesh (size);
+    unsigned int triangles = mesh -> getNumTriangles ();
+    edit (mesh, rounds, fraction, rng);
+    unsigned int live = (unsigned int) liveTriangles (mesh).size ();
+
+    cCollisionAABBProbe * tree = new cCollisionAABBProbe ();
+    tree -> initialize (mesh -> m_triangles, 0.0);
+    mesh -> setCollisionDetector (tree);
+
+    // segments from outside the sphere towards its center
+    std::vector<Query> queries;
+    std::uniform_real_distribution<double> unit (-1.0, 1.0);
+    while (queries.size () < queriesNum) {
+      chai3d::cVector3d d (unit (rng), unit (rng), unit (rng));
+      if (d.length () < 0.1 || d.length () > 1.0) { continue; }
+      d.normalize ();
+      queries.push_back ({ 1.5 * d, 0.5 * d });
+    }
+
+    unsigned int slotsBefore = mesh -> getNumTriangles ();
+    unsigned int verticesBefore = mesh -> getNumVertices ();
+    double mbBefore = memoryUsage (mesh, tree) / 1048576.0;
+    Measure before = measure (mesh, queries, 5);
+
+    auto start = std::chrono::steady_clock::now ();
+    mesh -> compress ();
+    double compressMs = elapsedMs (start);
+
+    unsigned int slotsAfter = mesh -> getNumTriangles ();
+    unsigned int verticesAfter = mesh -> getNumVertices ();
+    double mbAfter = memoryUsage (mesh, tree) / 1048576.0;
+    Measure after = measure (mesh, queries, 5);
+
+    int mismatch = 0;
+    for (size_t q = 0; q < queries.size (); ++q) {
+      if (chai3d::cDistance (before.hits [q], after.hits [q]) > 1e-12) {
+	mismatch++;
+      }
+    }
+    allOk = allOk && (mismatch == 0) && (slotsAfter == live);
+
+    std::cout << std::setw (10) << triangles << std::setw (10) << live
+	      << std::setw (10) << slotsBefore << std::setw (10) << verticesBefore
+	      << std::setw (10) << mbBefore << std::setw (10) << before.p50_us
+	      << std::setw (10) << before.p99_us << std::setw (10) << slotsAfter
+	      << std::setw (10) << verticesAfter << std::setw (10) << mbAfter
+	      << std::setw (10) << after.p50_us << std::setw (10) << after.p99_us
+	      << std::setw (12) << compressMs << std::setw (9) << mismatch << "\n";
+
+    json << (size == 1000 ? "" : ",\n")
+	 << "    { \"triangles\": " << triangles
+	 << ", \"live_triangles\": " << live
+	 << ", \"slots_before\": " << slotsBefore
+	 << ", \"vertices_before\": " << verticesBefore
+	 << ", \"mb_before\": " << mbBefore
+	 << ", \"p50_us_before\": " << before.p50_us
+	 << ", \"p99_us_before\": " << before.p99_us
+	 << ", \"slots_after\": " << slotsAfter
+	 << ", \"vertices_after\": " << verticesAfter
+	 << ", \"mb_after\": " << mbAfter
+	 << ", \"p50_us_after\": " << after.p50_us
+	 << ", \"p99_us_after\": " << after.p99_us
+	 << ", \"compress_ms\": " << compressMs
+	 << ", \"mismatch\": " << mismatch << " }";
+
+    delete mesh;
+  }
+  json << "\n  ]\n}\n";
+
+  std::ofstream file (output);
+  file << json.str ();
+  std::cout << "Results written to " << output << "\n";
+
+  if (!allOk) {
+    std::cerr << "The queries differ after compress, or dead triangles remain\n";
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,144 @@
+// Convex object benchmark: does a cConvexObject answer proxy queries in
+// a time independent of the size of the hull?
+//
+// Spheres tessellated from 1k to --max-triangles triangles are queried
+// with proxy-like segments (crossing or grazing the surface), once
+// through the padded AABB tree of the mesh and once through the convex
+// hull of its vertices (GJK ray cast). Consecutive queries follow a
+// random walk of --step radians per query (0.002 is a tool moving at
+// 0.2 m/s over a 10 cm object, queried at 1 kHz), so that each query
+// starts from the vertices found by the previous one. The hull
+// computation time, the query latency distribution and the difference
+// between the contacts found by the two detectors are printed and
+// written to a JSON file. Exits with an error if the contacts differ by
+// more than the tolerance of the hull.
+//
+// Usage: benchmark_convex [--max-triangles N] [--queries N] [--radius R]
+//                         [--step S] [--output file.json]
+
+#include "benchmark_common.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+int main (int argc, char * argv []) {
+  unsigned int maxTriangles = 256000;
+  int queriesNum = 20000;
+  double radius = 0.005;
+  double walkStep = 0.002;
+  std::string output = "benchmark-convex.json";
+
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv [i];
+    bool hasValue = i + 1 < argc;
+    if (arg == "--max-triangles" && hasValue) {
+      maxTriangles = std::stoul (argv [++i]);
+    } else if (arg == "--queries" && hasValue) {
+      queriesNum = std::stoi (argv [++i]);
+    } else if (arg == "--radius" && hasValue) {
+      radius = std::stod (argv [++i]);
+    } else if (arg == "--step" && hasValue) {
+      walkStep = std::stod (argv [++i]);
+    } else if (arg == "--output" && hasValue) {
+      output = argv [++i];
+    } else {
+      std::cerr << "Unknown or incomplete option " << arg << "\n"
+		<< "Options: --max-triangles --queries --radius --step --output\n";
+      return 1;
+    }
+  }
+
+  auto queries = sphereQueries (queriesNum, radius, walkStep, 42);
+
+  std::cout << std::fixed << std::setprecision (2)
+	    << std::setw (9) << "tris" << std::setw (10) << "hull ms"
+	    << std::setw (10) << "vertices" << std::setw (10) << "aabb p50"
+	    << std::setw (10) << "aabb p99" << std::setw (10) << "gjk p50"
+	    << std::setw (10) << "gjk p99" << std::setw (9) << "hits"
+	    << std::setw (9) << "differ" << std::setw (12) << "error um\n";
+
+  bool allOk = true;
+  std::ostringstream json;
+  json << std::setprecision (10)
+       << "{\n  \"benchmark\": \"convex\",\n  \"radius\": " << radius
+       << ",\n  \"step\": " << walkStep << ",\n  \"results\": [\n";
+  for (unsigned int size = 1000; size <= maxTriangles; size *= 4) {
+    chai3d::cMesh * mesh = sphereMesh (size);
+    unsigned int triangles = mesh -> getNumTriangles ();
+    mesh -> createAABBCollisionDetector (radius);
+
+    chai3d::cConvexObject * object = new chai3d::cConvexObject ();
+    auto begin = std::chrono::steady_clock::now ();
+    bool created = object -> createFromMesh (mesh);
+    double hullMs = elapsedMs (begin);
+    // a tessellated sphere is convex, with the tolerance of
+    // `set_mesh_convexity_detection`
+    created = created && object -> getConvexHull () -> isHullOf (mesh -> m_triangles, 2e-4);
+    if (!created) {
+      std::cerr << "The sphere of " << triangles << " triangles is not convex\n";
+      allOk = false;
+    }
+
+    std::vector<Contact> aabb, convex;
+    Latency aabbLatency = runQueries (mesh, queries, radius, aabb);
+    Latency convexLatency = runQueries (object, queries, radius, convex);
+
+    // both detectors compute the same swept sphere, up to rounding:
+    // only grazing contacts may differ
+    int hits = 0;
+    int differ = 0;
+    double error = 0.0;
+    for (size_t i = 0; i < queries.size (); ++i) {
+      hits += convex [i].hit ? 1 : 0;
+      if (aabb [i].hit != convex [i].hit) {
+	differ++;
+      } else if (aabb [i].hit) {
+	error = std::max (error, chai3d::cDistance (aabb [i].position, convex [i].position));
+      }
+    }
+    allOk = allOk && (error < 2.0 * object -> getConvexHull () -> getTolerance ())
+      && (differ < (int) queries.size () / 1000 + 1);
+
+    std::cout << std::setw (9) << triangles << std::setw (10) << hullMs
+	      << std::setw (10) << object -> getConvexHull () -> getNumVertices ()
+	      << std::setw (10) << aabbLatency.p50 << std::setw (10) << aabbLatency.p99
+	      << std::setw (10) << convexLatency.p50 << std::setw (10) << convexLatency.p99
+	      << std::setw (9) << hits << std::setw (9) << differ
+	      << std::setw (11) << 1e6 * error << "\n";
+
+    json << (size == 1000 ? "" : ",\n")
+	 << "    { \"triangles\": " << triangles
+	 << ", \"hull_ms\": " << hullMs
+	 << ", \"hull_vertices\": " << object -> getConvexHull () -> getNumVertices ()
+	 << ", \"queries\": " << queries.size ()
+	 << ", \"hits\": " << hits
+	 << ", \"aabb_us\": { \"mean\": " << aabbLatency.mean
+	 << ", \"p50\": " << aabbLatency.p50 << ", \"p99\": " << aabbLatency.p99 << " }"
+	 << ", \"convex_us\": { \"mean\": " << convexLatency.mean
+	 << ", \"p50\": " << convexLatency.p50 << ", \"p99\": " << convexLatency.p99 << " }"
+	 << ", \"differ\": " << differ
+	 << ", \"max_error\": " << error << " }";
+
+    delete object;
+    delete mesh;
+  }
+  json << "\n  ]\n}\n";
+
+  std::ofstream file (output);
+  file << json.str ();
+  std::cout << "Results written to " << output << "\n";
+
+  if (!allOk) {
+    std::cerr << "The convex object contacts differ from the mesh ones\n";
+    return 1;
+  }
+  return 0;
+}
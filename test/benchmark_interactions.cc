@@ -0,0 +1,269 @@
+// Interaction benchmark: does the force traversal of a world cost only
+// what is near the tool, whatever the number of objects with effects?
+//
+// Worlds of 10 to --max-objects small spheres (1 cm, scattered in a
+// 1 m cube, grouped ten by ten under moving nodes) with magnetic,
+// viscosity, surface and stick-slip effects are built three times: with
+// the default interaction culling, with culling disabled, and with the
+// effects compiled into an effect table (cWorld::compileEffects). A
+// tool walks from sphere to sphere at --step meters per tick; each tick
+// moves the groups, updates the global positions and computes the
+// interaction forces, as the haptic thread does. The time of both steps
+// and the number of objects the tool interacts with are printed and
+// written to a JSON file. Exits with an error if culling changes the
+// force or the interaction events, or if the compiled effects differ
+// from them by more than rounding.
+//
+// Usage: benchmark_interactions [--max-objects N] [--ticks N] [--step S]
+//                               [--output file.json]
+
+#include "benchmark_common.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+struct Scene {
+  chai3d::cWorld * world;
+  std::vector<chai3d::cGenericObject *> groups;
+  std::vector<chai3d::cVector3d> origins;
+  std::vector<chai3d::cShapeSphere *> spheres;
+  std::map<const chai3d::cGenericObject *, int> index;
+};
+
+struct Event {
+  int sphere;
+  chai3d::cVector3d force;
+  bool operator< (const Event & other) const { return sphere < other.sphere; }
+};
+
+// Spheres with effects, grouped ten by ten. The same seed gives the
+// same scene
+Scene buildScene (int count, unsigned int seed) {
+  std::mt19937 rng (seed);
+  std::uniform_real_distribution<double> position (-0.5, 0.5);
+  std::uniform_real_distribution<double> offset (-0.05, 0.05);
+
+  Scene scene;
+  scene.world = new chai3d::cWorld ();
+  for (int i = 0; i < count; ++i) {
+    if (i % 10 == 0) {
+      chai3d::cGenericObject * group = new chai3d::cGenericObject ();
+      chai3d::cVector3d origin (position (rng), position (rng), position (rng));
+      group -> setLocalPos (origin);
+      scene.world -> addChild (group);
+      scene.groups.push_back (group);
+      scene.origins.push_back (origin);
+    }
+    chai3d::cShapeSphere * sphere = new chai3d::cShapeSphere (0.01);
+    sphere -> setLocalPos (offset (rng), offset (rng), offset (rng));
+    sphere -> m_material -> setStiffness (500.0);
+    sphere -> m_material -> setMagnetMaxForce (2.0);
+    sphere -> m_material -> setMagnetMaxDistance (0.02);
+    sphere -> m_material -> setViscosity (5.0);
+    sphere -> m_material -> setStickSlipForceMax (1.0);
+    sphere -> m_material -> setStickSlipStiffness (200.0);
+    sphere -> createEffectSurface ();
+    switch (i % 3) {
+    case 0: sphere -> createEffectMagnetic (); break;
+    case 1: sphere -> createEffectViscosity (); break;
+    default: sphere -> createEffectStickSlip (); break;
+    }
+    scene.groups.back () -> addChild (sphere);
+    scene.index [sphere] = (int) scene.spheres.size ();
+    scene.spheres.push_back (sphere);
+  }
+  scene.world -> computeGlobalPositions (false);
+  return scene;
+}
+
+// Groups drift by a few millimeters, as interpolated game objects
+void moveGroups (Scene & scene, int tick) {
+  for (size_t i = 0; i < scene.groups.size (); ++i) {
+    double phase = 0.001 * tick + i;
+    chai3d::cVector3d drift (cos (phase), sin (phase), 0.0);
+    scene.groups [i] -> setLocalPos (scene.origins [i] + 0.003 * drift);
+  }
+}
+
+// Interaction events by sphere: compiled effects are reported after
+// the other ones
+std::vector<Event> sortedEvents (const Scene & scene,
+				 const chai3d::cInteractionRecorder & recorder) {
+  std::vector<Event> events;
+  for (auto & interaction : recorder.m_interactions) {
+    events.push_back (Event { scene.index.at (interaction.m_object),
+			      interaction.m_localForce });
+  }
+  std::stable_sort (events.begin (), events.end ());
+  return events;
+}
+
+bool sameForce (const chai3d::cVector3d & a, const chai3d::cVector3d & b) {
+  return chai3d::cDistance (a, b) <= 1e-9 * (1.0 + a.length ());
+}
+
+// One haptic tick: moves the groups, updates the positions and computes
+// the interactions
+chai3d::cVector3d tick (Scene & scene, int tick, const chai3d::cVector3d & tool,
+			const chai3d::cVector3d & velocity,
+			chai3d::cInteractionRecorder & recorder,
+			std::vector<double> & positions,
+			std::vector<double> & interactions) {
+  auto begin = std::chrono::steady_clock::now ();
+  moveGroups (scene, tick);
+  scene.world -> computeGlobalPositions (true);
+  positions.push_back (elapsedUs (begin));
+  recorder.clear ();
+  begin = std::chrono::steady_clock::now ();
+  chai3d::cVector3d force = scene.world -> computeInteractions (tool, velocity, 0, recorder);
+  interactions.push_back (elapsedUs (begin));
+  return force;
+}
+
+int main (int argc, char * argv []) {
+  int maxObjects = 10000;
+  int ticks = 20000;
+  double step = 0.002;
+  std::string output = "benchmark-interactions.json";
+
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv [i];
+    bool hasValue = i + 1 < argc;
+    if (arg == "--max-objects" && hasValue) {
+      maxObjects = std::stoi (argv [++i]);
+    } else if (arg == "--ticks" && hasValue) {
+      ticks = std::stoi (argv [++i]);
+    } else if (arg == "--step" && hasValue) {
+      step = std::stod (argv [++i]);
+    } else if (arg == "--output" && hasValue) {
+      output = argv [++i];
+    } else {
+      std::cerr << "Unknown or incomplete option " << arg << "\n"
+		<< "Options: --max-objects --ticks --step --output\n";
+      return 1;
+    }
+  }
+
+  std::cout << std::fixed << std::setprecision (2)
+	    << std::setw (9) << "objects" << std::setw (11) << "full pos"
+	    << std::setw (11) << "full p50" << std::setw (11) << "full p99"
+	    << std::setw (11) << "cull pos" << std::setw (11) << "cull p50"
+	    << std::setw (11) << "cull p99" << std::setw (11) << "batch p50"
+	    << std::setw (11) << "batch p99" << std::setw (10) << "events"
+	    << std::setw (10) << "mismatch\n";
+
+  bool allOk = true;
+  std::ostringstream json;
+  json << std::setprecision (10)
+       << "{\n  \"benchmark\": \"interactions\",\n  \"ticks\": " << ticks
+       << ",\n  \"step\": " << step << ",\n  \"results\": [\n";
+  for (int count = 10; count <= maxObjects; count *= 10) {
+    Scene culled = buildScene (count, 42);
+    Scene full = buildScene (count, 42);
+    full.world -> setInteractionCullingEnabled (false, true);
+    Scene batched = buildScene (count, 42);
+    batched.world -> compileEffects ();
+
+    std::mt19937 rng (7);
+    std::uniform_int_distribution<int> target (0, count - 1);
+    chai3d::cShapeSphere * goal = culled.spheres [target (rng)];
+    chai3d::cVector3d tool (0.0, 0.0, 0.0);
+
+    std::vector<double> fullPositions, fullInteractions;
+    std::vector<double> culledPositions, culledInteractions;
+    std::vector<double> batchedPositions, batchedInteractions;
+    chai3d::cInteractionRecorder fullRecorder, culledRecorder, batchedRecorder;
+    long events = 0;
+    int mismatches = 0;
+    for (int t = 0; t < ticks; ++t) {
+      // walk to the center of a sphere, then to another one
+      chai3d::cVector3d toGoal = goal -> getGlobalPos () - tool;
+      if (toGoal.length () < step) { goal = culled.spheres [target (rng)]; }
+      chai3d::cVector3d velocity = (step / std::max (step, toGoal.length ())) * toGoal;
+      tool += velocity;
+      velocity *= 1000.0;
+
+      chai3d::cVector3d fullForce = tick (full, t, tool, velocity, fullRecorder,
+					  fullPositions, fullInteractions);
+      chai3d::cVector3d culledForce = tick (culled, t, tool, velocity, culledRecorder,
+					    culledPositions, culledInteractions);
+      chai3d::cVector3d batchedForce = tick (batched, t, tool, velocity, batchedRecorder,
+					     batchedPositions, batchedInteractions);
+
+      // culled worlds are traversed in the same order
+      bool same = fullForce.equals (culledForce, 0.0)
+	&& fullRecorder.m_interactions.size () == culledRecorder.m_interactions.size ();
+      for (size_t i = 0; same && i < culledRecorder.m_interactions.size (); ++i) {
+	same = fullRecorder.m_interactions [i].m_localForce.equals
+	  (culledRecorder.m_interactions [i].m_localForce, 0.0);
+      }
+
+      // compiled effects are summed in another order
+      auto expected = sortedEvents (full, fullRecorder);
+      auto found = sortedEvents (batched, batchedRecorder);
+      same = same && sameForce (fullForce, batchedForce) && expected.size () == found.size ();
+      for (size_t i = 0; same && i < found.size (); ++i) {
+	same = expected [i].sphere == found [i].sphere
+	  && sameForce (expected [i].force, found [i].force);
+      }
+      mismatches += same ? 0 : 1;
+      events += culledRecorder.m_interactions.size ();
+    }
+    allOk = allOk && mismatches == 0;
+
+    Latency fullPos = summarize (fullPositions);
+    Latency fullLatency = summarize (fullInteractions);
+    Latency culledPos = summarize (culledPositions);
+    Latency culledLatency = summarize (culledInteractions);
+    Latency batchedPos = summarize (batchedPositions);
+    Latency batchedLatency = summarize (batchedInteractions);
+    std::cout << std::setw (9) << count << std::setw (11) << fullPos.p50
+	      << std::setw (11) << fullLatency.p50 << std::setw (11) << fullLatency.p99
+	      << std::setw (11) << culledPos.p50
+	      << std::setw (11) << culledLatency.p50 << std::setw (11) << culledLatency.p99
+	      << std::setw (11) << batchedLatency.p50 << std::setw (11) << batchedLatency.p99
+	      << std::setw (10) << events << std::setw (9) << mismatches << "\n";
+
+    json << (count == 10 ? "" : ",\n")
+	 << "    { \"objects\": " << count
+	 << ", \"compiled_objects\": " << batched.world -> getCompiledEffects () -> getNumObjects ()
+	 << ", \"events\": " << events
+	 << ", \"full_positions_us\": { \"mean\": " << fullPos.mean
+	 << ", \"p50\": " << fullPos.p50 << ", \"p99\": " << fullPos.p99 << " }"
+	 << ", \"full_interactions_us\": { \"mean\": " << fullLatency.mean
+	 << ", \"p50\": " << fullLatency.p50 << ", \"p99\": " << fullLatency.p99 << " }"
+	 << ", \"culled_positions_us\": { \"mean\": " << culledPos.mean
+	 << ", \"p50\": " << culledPos.p50 << ", \"p99\": " << culledPos.p99 << " }"
+	 << ", \"culled_interactions_us\": { \"mean\": " << culledLatency.mean
+	 << ", \"p50\": " << culledLatency.p50 << ", \"p99\": " << culledLatency.p99 << " }"
+	 << ", \"batched_positions_us\": { \"mean\": " << batchedPos.mean
+	 << ", \"p50\": " << batchedPos.p50 << ", \"p99\": " << batchedPos.p99 << " }"
+	 << ", \"batched_interactions_us\": { \"mean\": " << batchedLatency.mean
+	 << ", \"p50\": " << batchedLatency.p50 << ", \"p99\": " << batchedLatency.p99 << " }"
+	 << ", \"mismatches\": " << mismatches << " }";
+
+    delete full.world;
+    delete culled.world;
+    delete batched.world;
+  }
+  json << "\n  ]\n}\n";
+
+  std::ofstream file (output);
+  file << json.str ();
+  std::cout << "Results written to " << output << "\n";
+
+  if (!allOk) {
+    std::cerr << "Culling or compiled effects changed the interaction forces\n";
+    return 1;
+  }
+  return 0;
+}
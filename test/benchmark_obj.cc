@@ -0,0 +1,303 @@
+// OBJ loader benchmark: is the parallel parser identical to, and faster
+// than, the original cOBJModel parser?
+//
+// A corpus of small OBJ files covering the supported features (plain
+// triangles, normals, texture coordinates with seams, polygons,
+// materials, groups, comments, CRLF line endings, point clouds) is
+// written to --dir, together with a large textured terrain of about
+// --size MB. Every file, plus any file given on the command line, is
+// loaded with both parsers: the meshes must be identical, the load
+// times are printed and written to a JSON file. Exits with an error if
+// any file differs.
+//
+// Usage: benchmark_obj [--size MB] [--dir dir] [--output file.json] [file.obj ...]
+
+#include "benchmark_common.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////
+// Corpus
+////////////////////////////////////////////////////////////////////////
+
+void writeFile (const std::string & filename, const std::string & content) {
+  std::ofstream out (filename.c_str (), std::ios::binary);
+  out << content;
+}
+
+// Grid of n x n quads over a bumpy surface. Texture coordinates have a
+// seam every `seam` columns, so that positions are shared by vertices
+// with different texture coordinates.
+std::string terrainOBJ (int n, bool normals, bool texCoords, bool quads,
+			int seam, const std::string & eol) {
+  std::ostringstream out;
+  out << std::setprecision (7);
+  out << "# terrain " << n << "x" << n << eol;
+  std::mt19937 rng (n);
+  std::uniform_real_distribution<double> noise (-0.01, 0.01);
+  for (int j = 0; j <= n; ++j) {
+    for (int i = 0; i <= n; ++i) {
+      double x = (double) i / n - 0.5;
+      double y = (double) j / n - 0.5;
+      double z = 0.05 * std::sin (12.0 * x) * std::cos (9.0 * y) + noise (rng);
+      out << "v " << x << " " << y << " " << z << eol;
+    }
+  }
+  if (texCoords) {
+    for (int j = 0; j <= n; ++j) {
+      for (int i = 0; i <= n; ++i) {
+	out << "vt " << (double) (i % (seam + 1)) / seam << " " << (double) j / n << eol;
+      }
+    }
+    // second set of texture coordinates, used at the seams
+    for (int j = 0; j <= n; ++j) {
+      out << "vt 0 " << (double) j / n << eol;
+    }
+  }
+  if (normals) {
+    for (int j = 0; j <= n; ++j) {
+      for (int i = 0; i <= n; ++i) {
+	out << "vn " << 0.1 * std::sin ((double) i) << " "
+	    << 0.1 * std::cos ((double) j) << " 1" << eol;
+      }
+    }
+  }
+  int texSeamBase = (n + 1) * (n + 1) + 1;
+  auto corner = [&] (int i, int j, int column) {
+    int v = j * (n + 1) + i + 1;
+    std::ostringstream c;
+    c << v;
+    if (texCoords) {
+      int t = v;
+      // the right side of the last quad before a seam uses the seam set
+      if (i > column && i % seam == 0) { t = texSeamBase + j; }
+      c << "/" << t;
+    }
+    if (normals) { c << (texCoords ? "/" : "//") << v; }
+    return c.str ();
+  };
+  for (int j = 0; j < n; ++j) {
+    for (int i = 0; i < n; ++i) {
+      if (quads) {
+	out << "f " << corner (i, j, i) << " " << corner (i + 1, j, i) << " "
+	    << corner (i + 1, j + 1, i) << " " << corner (i, j + 1, i) << eol;
+      } else {
+	out << "f " << corner (i, j, i) << " " << corner (i + 1, j, i) << " "
+	    << corner (i + 1, j + 1, i) << eol;
+	out << "f " << corner (i, j, i) << " " << corner (i + 1, j + 1, i) << " "
+	    << corner (i, j + 1, i) << eol;
+      }
+    }
+  }
+  return out.str ();
+}
+
+// Two materials and groups, polygons, comments, exponents, CRLF. All
+// faces of a file use the same format: the original parser reads
+// garbage when formats are mixed.
+void writeMaterialsOBJ (const std::string & dir, const std::string & name) {
+  writeFile (dir + "/" + name + ".mtl",
+	     "# materials\r\n"
+	     "newmtl red\r\nKa 0.2 0 0\r\nKd 0.8 0.1 0.1\r\nKs 0.5 0.5 0.5\r\nNs 50\r\n"
+	     "newmtl glass\r\nKd 0.1 0.1 0.9\r\nd 0.25\r\nNs 900\r\n");
+  std::ostringstream out;
+  out << "# two materials\r\nmtllib " << name << ".mtl\r\n";
+  // hexagonal prism
+  for (int k = 0; k < 2; ++k) {
+    for (int i = 0; i < 6; ++i) {
+      double a = i * 3.14159265358979 / 3.0;
+      out << "v " << std::cos (a) << " " << std::sin (a) << " " << (k ? "1.5e-1" : "-15E-2") << "\r\n";
+    }
+  }
+  out << "vn 0 0 -1\r\nvn 0 0 2\r\n";
+  for (int i = 0; i < 6; ++i) {
+    double a = (i + 0.5) * 3.14159265358979 / 3.0;
+    out << "vn " << std::cos (a) << " " << std::sin (a) << " 0\r\n";
+  }
+  out << "g bottom\r\nusemtl red\r\nf 6//1 5//1 4//1 3//1 2//1 1//1\r\n";
+  out << "# top and sides\r\ng top cap\r\nusemtl glass\r\nf 7//2 8//2 9//2 10//2 11//2 12//2\r\n";
+  out << "g sides\r\nusemtl red\r\n";
+  for (int i = 0; i < 6; ++i) {
+    int a = i + 1, b = (i + 1) % 6 + 1;
+    out << "f " << a << "//" << i + 3 << " " << b << "//" << i + 3 << " "
+	<< b + 6 << "//" << i + 3 << " " << a + 6 << "//" << i + 3 << "\r\n";
+  }
+  writeFile (dir + "/" + name + ".obj", out.str ());
+}
+
+std::string pointCloudOBJ (int n) {
+  std::ostringstream out;
+  out << std::setprecision (9);
+  std::mt19937 rng (n);
+  std::uniform_real_distribution<double> u (0.0, 1.0);
+  for (int i = 0; i < n; ++i) {
+    out << "v " << u (rng) - 0.5 << " " << u (rng) - 0.5 << " " << u (rng) - 0.5
+	<< " " << u (rng) << " " << u (rng) << " " << u (rng) << "\n";
+  }
+  return out.str ();
+}
+
+////////////////////////////////////////////////////////////////////////
+// Comparison
+////////////////////////////////////////////////////////////////////////
+
+bool sameVector (const chai3d::cVector3d & a, const chai3d::cVector3d & b) {
+  return std::memcmp (&a, &b, sizeof (a)) == 0;
+}
+
+bool sameColor (const chai3d::cColorf & a, const chai3d::cColorf & b) {
+  return std::memcmp (a.getData (), b.getData (), 4 * sizeof (float)) == 0;
+}
+
+// Returns an empty string if both objects are identical
+std::string compare (chai3d::cMultiMesh * a, chai3d::cMultiMesh * b) {
+  if (a -> getNumMeshes () != b -> getNumMeshes ()) { return "number of meshes"; }
+  for (int m = 0; m < a -> getNumMeshes (); ++m) {
+    chai3d::cMesh * ma = a -> getMesh (m);
+    chai3d::cMesh * mb = b -> getMesh (m);
+    std::ostringstream where;
+    where << "mesh " << m << ": ";
+    if (ma -> m_name != mb -> m_name) { return where.str () + "name"; }
+    if (!sameColor (ma -> m_material -> m_diffuse, mb -> m_material -> m_diffuse) ||
+	!sameColor (ma -> m_material -> m_ambient, mb -> m_material -> m_ambient) ||
+	!sameColor (ma -> m_material -> m_specular, mb -> m_material -> m_specular) ||
+	ma -> m_material -> getShininess () != mb -> m_material -> getShininess () ||
+	ma -> getUseTransparency () != mb -> getUseTransparency ()) {
+      return where.str () + "material";
+    }
+    unsigned int nv = ma -> getNumVertices ();
+    if (nv != mb -> getNumVertices ()) { return where.str () + "number of vertices"; }
+    for (unsigned int i = 0; i < nv; ++i) {
+      if (!sameVector (ma -> m_vertices -> getLocalPos (i), mb -> m_vertices -> getLocalPos (i)) ||
+	  !sameVector (ma -> m_vertices -> getNormal (i), mb -> m_vertices -> getNormal (i)) ||
+	  !sameVector (ma -> m_vertices -> getTexCoord (i), mb -> m_vertices -> getTexCoord (i)) ||
+	  !sameColor (ma -> m_vertices -> getColor (i), mb -> m_vertices -> getColor (i))) {
+	std::ostringstream v;
+	v << "vertex " << i;
+	return where.str () + v.str ();
+      }
+    }
+    unsigned int nt = ma -> getNumTriangles ();
+    if (nt != mb -> getNumTriangles ()) { return where.str () + "number of triangles"; }
+    if (ma -> m_triangles -> m_indices != mb -> m_triangles -> m_indices) {
+      return where.str () + "triangle indices";
+    }
+  }
+  return "";
+}
+
+double loadMs (chai3d::cMultiMesh * object, const std::string & filename,
+	       bool legacy, bool & ok) {
+  chai3d::g_objLoaderUseLegacyParser = legacy;
+  auto begin = std::chrono::steady_clock::now ();
+  ok = chai3d::cLoadFileOBJ (object, filename);
+  return elapsedMs (begin);
+}
+
+int main (int argc, char * argv []) {
+  double sizeMB = 120.0;
+  std::string dir = ".";
+  std::string output = "benchmark-obj.json";
+  std::vector<std::string> files;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv [i];
+    bool hasValue = i + 1 < argc;
+    if (arg == "--size" && hasValue) {
+      sizeMB = std::stod (argv [++i]);
+    } else if (arg == "--dir" && hasValue) {
+      dir = argv [++i];
+    } else if (arg == "--output" && hasValue) {
+      output = argv [++i];
+    } else if (arg.size () > 2 && arg.compare (0, 2, "--") == 0) {
+      std::cerr << "Unknown or incomplete option " << arg << "\n"
+		<< "Options: --size --dir --output [file.obj ...]\n";
+      return 1;
+    } else {
+      files.push_back (arg);
+    }
+  }
+
+  // corpus
+  std::vector<std::string> corpus;
+  auto add = [&] (const std::string & name, const std::string & content) {
+    writeFile (dir + "/" + name, content);
+    corpus.push_back (dir + "/" + name);
+  };
+  add ("obj-triangles.obj", terrainOBJ (20, false, false, false, 5, "\n"));
+  add ("obj-normals.obj", terrainOBJ (20, true, false, true, 5, "\n"));
+  add ("obj-textured.obj", terrainOBJ (20, true, true, true, 4, "\n"));
+  add ("obj-textured-crlf.obj", terrainOBJ (20, true, true, false, 7, "\r\n"));
+  add ("obj-pointcloud.obj", pointCloudOBJ (1000));
+  writeMaterialsOBJ (dir, "obj-materials");
+  corpus.push_back (dir + "/obj-materials.obj");
+
+  // large file: about 150 bytes per grid point
+  int n = (int) std::sqrt (sizeMB * 1e6 / 150.0);
+  if (n > 0) {
+    std::cout << "Writing " << n << "x" << n << " terrain..." << std::endl;
+    add ("obj-large.obj", terrainOBJ (n, true, true, true, 64, "\n"));
+  }
+  corpus.insert (corpus.end (), files.begin (), files.end ());
+
+  std::cout << std::fixed << std::setprecision (1)
+	    << std::left << std::setw (28) << "file" << std::right
+	    << std::setw (10) << "MB" << std::setw (12) << "legacy ms"
+	    << std::setw (14) << "parallel ms" << std::setw (10) << "speedup"
+	    << "  result\n";
+
+  bool allIdentical = true;
+  std::ostringstream json;
+  json << std::setprecision (10)
+       << "{\n  \"benchmark\": \"obj\",\n  \"results\": [\n";
+  for (size_t i = 0; i < corpus.size (); ++i) {
+    const std::string & file = corpus [i];
+    std::ifstream in (file.c_str (), std::ios::binary | std::ios::ate);
+    double mb = in.tellg () / 1e6;
+
+    chai3d::cMultiMesh * legacy = new chai3d::cMultiMesh ();
+    chai3d::cMultiMesh * parallel = new chai3d::cMultiMesh ();
+    bool legacyOk, parallelOk;
+    double legacyMs = loadMs (legacy, file, true, legacyOk);
+    double parallelMs = loadMs (parallel, file, false, parallelOk);
+
+    std::string result;
+    if (!legacyOk || !parallelOk) {
+      result = legacyOk ? "parallel failed" : (parallelOk ? "legacy failed" : "both failed");
+    } else {
+      result = compare (legacy, parallel);
+      if (result.empty ()) { result = "identical"; }
+    }
+    bool identical = result == "identical";
+    allIdentical = allIdentical && identical;
+
+    std::string name = file.substr (file.find_last_of ("/\\") + 1);
+    std::cout << std::left << std::setw (28) << name << std::right
+	      << std::setw (10) << mb << std::setw (12) << legacyMs
+	      << std::setw (14) << parallelMs << std::setw (10) << legacyMs / parallelMs
+	      << "  " << result << std::endl;
+
+    json << "    { \"file\": \"" << name << "\", \"mb\": " << mb
+	 << ", \"legacy_ms\": " << legacyMs << ", \"parallel_ms\": " << parallelMs
+	 << ", \"identical\": " << (identical ? "true" : "false") << " }"
+	 << (i + 1 < corpus.size () ? ",\n" : "\n");
+
+    delete legacy;
+    delete parallel;
+  }
+  json << "  ]\n}\n";
+  writeFile (output, json.str ());
+
+  chai3d::g_objLoaderUseLegacyParser = false;
+  return allIdentical ? 0 : 1;
+}
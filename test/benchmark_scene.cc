@@ -0,0 +1,317 @@
+// Compiled scene benchmark: does computing the collisions of a world
+// flattened into arrays (cWorld::compileScene) cost less than the
+// recursive traversal, with the same results?
+//
+// Worlds of 10 to --max-objects small objects (spheres, boxes and box
+// meshes with effects, and a few cylinders that the compiled scene
+// leaves to their own methods) are built twice, under moving groups of
+// groups. A tool walks from object to object at --step meters per tick;
+// each tick moves the groups, then updates the global positions,
+// computes the collisions of the segment swept by the tool and the
+// interaction forces, in both worlds. Every --edit-period ticks an
+// object is moved to another group, which compiles the scene again.
+// The time of each step and of the compilations is printed and written
+// to a JSON file. Exits with an error if the positions, the collisions,
+// the forces or the interaction events differ.
+//
+// Usage: benchmark_scene [--max-objects N] [--ticks N] [--step S]
+//                        [--edit-period N] [--output file.json]
+
+#include "benchmark_common.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+struct Scene {
+  chai3d::cWorld * world;
+  std::vector<chai3d::cGenericObject *> groups;
+  std::vector<chai3d::cVector3d> origins;
+  std::vector<chai3d::cGenericObject *> objects;
+};
+
+struct Timings {
+  std::vector<double> positions;
+  std::vector<double> collisions;
+  std::vector<double> interactions;
+  std::vector<double> compilations;
+};
+
+// Objects grouped ten by ten, and groups ten by ten. The same seed
+// gives the same scene
+Scene buildScene (int count, unsigned int seed) {
+  std::mt19937 rng (seed);
+  std::uniform_real_distribution<double> position (-0.5, 0.5);
+  std::uniform_real_distribution<double> offset (-0.05, 0.05);
+  std::uniform_real_distribution<double> angle (0.0, M_PI);
+
+  Scene scene;
+  scene.world = new chai3d::cWorld ();
+  chai3d::cGenericObject * parent = nullptr;
+  for (int i = 0; i < count; ++i) {
+    if (i % 100 == 0) {
+      parent = new chai3d::cGenericObject ();
+      parent -> setLocalPos (position (rng), position (rng), position (rng));
+      scene.world -> addChild (parent);
+    }
+    if (i % 10 == 0) {
+      chai3d::cGenericObject * group = new chai3d::cGenericObject ();
+      chai3d::cVector3d origin (0.3 * position (rng), 0.3 * position (rng),
+				0.3 * position (rng));
+      group -> setLocalPos (origin);
+      group -> setLocalRot (chai3d::cMatrix3d (0.0, 0.0, 1.0, angle (rng)));
+      parent -> addChild (group);
+      scene.groups.push_back (group);
+      scene.origins.push_back (origin);
+    }
+
+    chai3d::cGenericObject * object;
+    switch (i % 10) {
+    case 0: case 1: case 2: case 3:
+      object = new chai3d::cShapeSphere (0.01);
+      break;
+    case 4: case 5: case 6:
+      object = new chai3d::cShapeBox (0.02, 0.01, 0.015);
+      break;
+    case 7: case 8: {
+      chai3d::cMesh * mesh = new chai3d::cMesh ();
+      chai3d::cCreateBox (mesh, 0.02, 0.02, 0.01);
+      mesh -> computeBoundaryBox (true);
+      mesh -> createAABBCollisionDetector (0.001);
+      object = mesh;
+      break;
+    }
+    default:
+      object = new chai3d::cShapeCylinder (0.01, 0.01, 0.02);
+      break;
+    }
+    object -> setLocalPos (offset (rng), offset (rng), offset (rng));
+    object -> setLocalRot (chai3d::cMatrix3d (1.0, 0.0, 0.0, angle (rng)));
+    object -> m_material -> setStiffness (500.0);
+    object -> m_material -> setMagnetMaxForce (2.0);
+    object -> m_material -> setMagnetMaxDistance (0.02);
+    object -> createEffectSurface ();
+    if (i % 3 == 0) { object -> createEffectMagnetic (); }
+    scene.groups.back () -> addChild (object);
+    scene.objects.push_back (object);
+  }
+  scene.world -> computeGlobalPositions (false);
+  return scene;
+}
+
+// Groups drift by a few millimeters, as interpolated game objects
+void moveGroups (Scene & scene, int tick) {
+  for (size_t i = 0; i < scene.groups.size (); ++i) {
+    double phase = 0.001 * tick + i;
+    chai3d::cVector3d drift (cos (phase), sin (phase), 0.0);
+    scene.groups [i] -> setLocalPos (scene.origins [i] + 0.003 * drift);
+  }
+}
+
+// Moves an object to another group, in both scenes
+void moveObject (Scene & scene, int object, int group) {
+  chai3d::cGenericObject * o = scene.objects [object];
+  o -> removeFromGraph ();
+  scene.groups [group] -> addChild (o);
+}
+
+bool sameVector (const chai3d::cVector3d & a, const chai3d::cVector3d & b) {
+  return chai3d::cDistance (a, b) <= 1e-9 * (1.0 + a.length ());
+}
+
+// Objects are compared by their index in their scene
+int indexOf (const Scene & scene, const chai3d::cGenericObject * object) {
+  auto it = std::find (scene.objects.begin (), scene.objects.end (), object);
+  return it == scene.objects.end () ? -1 : (int) (it - scene.objects.begin ());
+}
+
+bool sameCollision (const Scene & a, const chai3d::cCollisionEvent & ea,
+		    const Scene & b, const chai3d::cCollisionEvent & eb) {
+  return indexOf (a, ea.m_object) == indexOf (b, eb.m_object)
+    && sameVector (ea.m_localPos, eb.m_localPos)
+    && sameVector (ea.m_globalPos, eb.m_globalPos);
+}
+
+// One haptic tick
+chai3d::cVector3d tick (Scene & scene, int t, const chai3d::cVector3d & from,
+			const chai3d::cVector3d & tool,
+			const chai3d::cVector3d & velocity,
+			chai3d::cCollisionRecorder & collisions,
+			chai3d::cInteractionRecorder & interactions,
+			Timings & timings) {
+  // the world routes collisions through its compiled scene, if any
+  moveGroups (scene, t);
+  auto begin = std::chrono::steady_clock::now ();
+  scene.world -> computeGlobalPositions (true);
+  timings.positions.push_back (elapsedUs (begin));
+
+  chai3d::cCollisionSettings settings;
+  settings.m_checkForNearestCollisionOnly = false;
+  settings.m_adjustObjectMotion = true;
+  settings.m_collisionRadius = 0.001;
+  collisions.clear ();
+  begin = std::chrono::steady_clock::now ();
+  scene.world -> computeCollisionDetection (from, tool, collisions, settings);
+  timings.collisions.push_back (elapsedUs (begin));
+
+  interactions.clear ();
+  begin = std::chrono::steady_clock::now ();
+  chai3d::cVector3d force = scene.world -> computeInteractions (tool, velocity, 0, interactions);
+  timings.interactions.push_back (elapsedUs (begin));
+  return force;
+}
+
+int main (int argc, char * argv []) {
+  int maxObjects = 10000;
+  int ticks = 20000;
+  double step = 0.002;
+  int editPeriod = 1000;
+  std::string output = "benchmark-scene.json";
+
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv [i];
+    bool hasValue = i + 1 < argc;
+    if (arg == "--max-objects" && hasValue) {
+      maxObjects = std::stoi (argv [++i]);
+    } else if (arg == "--ticks" && hasValue) {
+      ticks = std::stoi (argv [++i]);
+    } else if (arg == "--step" && hasValue) {
+      step = std::stod (argv [++i]);
+    } else if (arg == "--edit-period" && hasValue) {
+      editPeriod = std::max (1, std::stoi (argv [++i]));
+    } else if (arg == "--output" && hasValue) {
+      output = argv [++i];
+    } else {
+      std::cerr << "Unknown or incomplete option " << arg << "\n"
+		<< "Options: --max-objects --ticks --step --edit-period --output\n";
+      return 1;
+    }
+  }
+
+  std::cout << std::fixed << std::setprecision (2)
+	    << std::setw (9) << "objects" << std::setw (11) << "positions"
+	    << std::setw (11) << "tree col" << std::setw (11) << "flat col"
+	    << std::setw (11) << "interact" << std::setw (12) << "compile us"
+	    << std::setw (10) << "hits" << std::setw (10) << "mismatch\n";
+
+  bool allOk = true;
+  std::ostringstream json;
+  json << std::setprecision (10)
+       << "{\n  \"benchmark\": \"scene\",\n  \"ticks\": " << ticks
+       << ",\n  \"step\": " << step << ",\n  \"results\": [\n";
+  for (int count = 10; count <= maxObjects; count *= 10) {
+    Scene tree = buildScene (count, 42);
+    Scene flat = buildScene (count, 42);
+    flat.world -> compileScene ();
+
+    std::mt19937 rng (7);
+    std::uniform_int_distribution<int> target (0, count - 1);
+    std::uniform_int_distribution<int> group (0, (int) tree.groups.size () - 1);
+    chai3d::cGenericObject * goal = tree.objects [target (rng)];
+    chai3d::cVector3d tool (0.0, 0.0, 0.0);
+
+    Timings treeTimings, flatTimings;
+    chai3d::cCollisionRecorder treeCollisions, flatCollisions;
+    chai3d::cInteractionRecorder treeInteractions, flatInteractions;
+    long hits = 0;
+    int mismatches = 0;
+    for (int t = 0; t < ticks; ++t) {
+      if (t % editPeriod == editPeriod - 1) {
+	int object = target (rng);
+	int to = group (rng);
+	moveObject (tree, object, to);
+	moveObject (flat, object, to);
+
+	// the scene is compiled again before its next traversal
+	auto begin = std::chrono::steady_clock::now ();
+	flat.world -> getCompiledScene () -> getNumObjects ();
+	flatTimings.compilations.push_back (elapsedUs (begin));
+      }
+
+      // walk to the center of an object, then to another one
+      chai3d::cVector3d toGoal = goal -> getGlobalPos () - tool;
+      if (toGoal.length () < step) { goal = tree.objects [target (rng)]; }
+      chai3d::cVector3d velocity = (step / std::max (step, toGoal.length ())) * toGoal;
+      chai3d::cVector3d from = tool;
+      tool += velocity;
+      velocity *= 1000.0;
+
+      chai3d::cVector3d treeForce = tick (tree, t, from, tool, velocity, treeCollisions,
+					  treeInteractions, treeTimings);
+      chai3d::cVector3d flatForce = tick (flat, t, from, tool, velocity, flatCollisions,
+					  flatInteractions, flatTimings);
+
+      bool same = sameVector (treeForce, flatForce)
+	&& treeCollisions.m_collisions.size () == flatCollisions.m_collisions.size ()
+	&& treeInteractions.m_interactions.size () == flatInteractions.m_interactions.size ();
+      for (size_t i = 0; same && i < treeCollisions.m_collisions.size (); ++i) {
+	same = sameCollision (tree, treeCollisions.m_collisions [i],
+			      flat, flatCollisions.m_collisions [i]);
+      }
+      same = same && (treeCollisions.m_collisions.empty ()
+		      || sameCollision (tree, treeCollisions.m_nearestCollision,
+					flat, flatCollisions.m_nearestCollision));
+      for (size_t i = 0; same && i < treeInteractions.m_interactions.size (); ++i) {
+	const chai3d::cInteractionEvent & a = treeInteractions.m_interactions [i];
+	const chai3d::cInteractionEvent & b = flatInteractions.m_interactions [i];
+	same = indexOf (tree, a.m_object) == indexOf (flat, b.m_object)
+	  && sameVector (a.m_localForce, b.m_localForce);
+      }
+      for (size_t i = 0; same && i < tree.objects.size (); ++i) {
+	same = chai3d::cDistance (tree.objects [i] -> getGlobalPos (),
+				 flat.objects [i] -> getGlobalPos ()) == 0.0;
+      }
+      mismatches += same ? 0 : 1;
+      hits += treeCollisions.m_collisions.size ();
+    }
+    allOk = allOk && (mismatches == 0);
+
+    // positions and interactions are computed recursively in both worlds
+    Latency positions = summarize (treeTimings.positions);
+    Latency treeCol = summarize (treeTimings.collisions);
+    Latency flatCol = summarize (flatTimings.collisions);
+    Latency interactions = summarize (treeTimings.interactions);
+    Latency compile = flatTimings.compilations.empty () ? Latency {}
+      : summarize (flatTimings.compilations);
+    std::cout << std::setw (9) << count
+	      << std::setw (11) << positions.p50 << std::setw (11) << treeCol.p50
+	      << std::setw (11) << flatCol.p50 << std::setw (11) << interactions.p50
+	      << std::setw (12) << compile.p50 << std::setw (10) << hits
+	      << std::setw (9) << mismatches << "\n";
+
+    const char * names [] = { "positions", "tree_collisions", "compiled_collisions",
+			      "interactions", "compile" };
+    const Latency * latencies [] = { &positions, &treeCol, &flatCol, &interactions, &compile };
+    json << (count == 10 ? "" : ",\n")
+	 << "    { \"objects\": " << count
+	 << ", \"compiled_objects\": " << flat.world -> getCompiledScene () -> getNumObjects ()
+	 << ", \"collisions\": " << hits;
+    for (int k = 0; k < 5; ++k) {
+      const Latency & l = *latencies [k];
+      json << ", \"" << names [k] << "_us\": { \"mean\": " << l.mean
+	   << ", \"p50\": " << l.p50 << ", \"p99\": " << l.p99 << " }";
+    }
+    json << ", \"mismatches\": " << mismatches << " }";
+
+    delete tree.world;
+    delete flat.world;
+  }
+  json << "\n  ]\n}\n";
+
+  std::ofstream file (output);
+  file << json.str ();
+  std::cout << "Results written to " << output << "\n";
+
+  if (!allOk) {
+    std::cerr << "The compiled scene changed the positions, collisions or forces\n";
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,167 @@
+// Signed distance field benchmark: does a cDistanceFieldObject answer
+// proxy queries in a time independent of the triangle count?
+//
+// Spheres tessellated from 1k to --max-triangles triangles are baked
+// into fields of the same cell size, and queried with the same
+// proxy-like segments as the padded AABB tree of the mesh (crossing or
+// grazing the surface). The bake time, the time to save and load the
+// field from --cache-dir, the memory, the query latency distribution
+// and the difference between the contacts found by the two detectors
+// are printed and written to a JSON file. Exits with an error if the
+// contacts differ by more than a cell on average.
+//
+// Usage: benchmark_sdf [--max-triangles N] [--cell-size H] [--queries N]
+//                      [--radius R] [--cache-dir dir] [--output file.json]
+
+#include "benchmark_common.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+int main (int argc, char * argv []) {
+  unsigned int maxTriangles = 256000;
+  double cellSize = 0.01;
+  int queriesNum = 20000;
+  double radius = 0.005;
+  std::string cacheDir = ".";
+  std::string output = "benchmark-sdf.json";
+
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv [i];
+    bool hasValue = i + 1 < argc;
+    if (arg == "--max-triangles" && hasValue) {
+      maxTriangles = std::stoul (argv [++i]);
+    } else if (arg == "--cell-size" && hasValue) {
+      cellSize = std::stod (argv [++i]);
+    } else if (arg == "--queries" && hasValue) {
+      queriesNum = std::stoi (argv [++i]);
+    } else if (arg == "--radius" && hasValue) {
+      radius = std::stod (argv [++i]);
+    } else if (arg == "--cache-dir" && hasValue) {
+      cacheDir = argv [++i];
+    } else if (arg == "--output" && hasValue) {
+      output = argv [++i];
+    } else {
+      std::cerr << "Unknown or incomplete option " << arg << "\n"
+		<< "Options: --max-triangles --cell-size --queries --radius --cache-dir --output\n";
+      return 1;
+    }
+  }
+
+  // as `create_sdf_object`
+  const double band = radius + 4.0 * cellSize;
+  auto queries = sphereQueries (queriesNum, radius, 0.0, 42);
+
+  std::cout << std::fixed << std::setprecision (2)
+	    << std::setw (9) << "tris" << std::setw (10) << "bake ms"
+	    << std::setw (10) << "save ms" << std::setw (10) << "load ms"
+	    << std::setw (10) << "field MB" << std::setw (10) << "aabb p50"
+	    << std::setw (10) << "aabb p99" << std::setw (10) << "sdf p50"
+	    << std::setw (10) << "sdf p99" << std::setw (9) << "hits"
+	    << std::setw (9) << "differ" << std::setw (11) << "error/h\n";
+
+  bool allOk = true;
+  std::ostringstream json;
+  json << std::setprecision (10)
+       << "{\n  \"benchmark\": \"sdf\",\n  \"radius\": " << radius
+       << ",\n  \"cell_size\": " << cellSize << ",\n  \"band\": " << band
+       << ",\n  \"results\": [\n";
+  for (unsigned int size = 1000; size <= maxTriangles; size *= 4) {
+    chai3d::cMesh * mesh = sphereMesh (size);
+    unsigned int triangles = mesh -> getNumTriangles ();
+    mesh -> createAABBCollisionDetector (radius);
+
+    // bake, save, then load the cached field
+    std::string cacheFile = cacheDir + "/benchmark-sdf.bin";
+    unsigned long long hash = chai3d::cSignedDistanceField::computeHash
+      (mesh -> m_triangles, cellSize, band);
+    chai3d::cSignedDistanceFieldPtr field = chai3d::cSignedDistanceField::create ();
+    auto begin = std::chrono::steady_clock::now ();
+    field -> createFromTriangles (mesh -> m_triangles, cellSize, band);
+    double bakeMs = elapsedMs (begin);
+    begin = std::chrono::steady_clock::now ();
+    bool saved = field -> saveToFile (cacheFile, hash);
+    double saveMs = elapsedMs (begin);
+    chai3d::cSignedDistanceFieldPtr loaded = chai3d::cSignedDistanceField::create ();
+    begin = std::chrono::steady_clock::now ();
+    bool reloaded = saved && loaded -> loadFromFile (cacheFile, hash);
+    double loadMs = elapsedMs (begin);
+    std::remove (cacheFile.c_str ());
+    if (!reloaded) {
+      std::cerr << "Cannot save and load the field in " << cacheDir << "\n";
+      allOk = false;
+    }
+
+    chai3d::cDistanceFieldObject * object = new chai3d::cDistanceFieldObject ();
+    object -> setDistanceField (reloaded ? loaded : field);
+
+    std::vector<Contact> aabb, sdf;
+    Latency aabbLatency = runQueries (mesh, queries, radius, aabb);
+    Latency sdfLatency = runQueries (object, queries, radius, sdf);
+
+    // contacts found by only one detector are grazing ones, within a
+    // cell of the surface
+    int hits = 0;
+    int differ = 0;
+    double errorSum = 0.0;
+    for (size_t i = 0; i < queries.size (); ++i) {
+      hits += sdf [i].hit ? 1 : 0;
+      if (aabb [i].hit != sdf [i].hit) {
+	differ++;
+      } else if (aabb [i].hit) {
+	errorSum += chai3d::cDistance (aabb [i].position, sdf [i].position);
+      }
+    }
+    int both = std::max (1, hits - differ);
+    double error = errorSum / both / cellSize;
+    allOk = allOk && (error < 1.0) && (differ < (int) queries.size () / 20);
+
+    double fieldMB = field -> getMemorySize () / (1024.0 * 1024.0);
+    std::cout << std::setw (9) << triangles << std::setw (10) << bakeMs
+	      << std::setw (10) << saveMs << std::setw (10) << loadMs
+	      << std::setw (10) << fieldMB
+	      << std::setw (10) << aabbLatency.p50 << std::setw (10) << aabbLatency.p99
+	      << std::setw (10) << sdfLatency.p50 << std::setw (10) << sdfLatency.p99
+	      << std::setw (9) << hits << std::setw (9) << differ
+	      << std::setw (10) << error << "\n";
+
+    json << (size == 1000 ? "" : ",\n")
+	 << "    { \"triangles\": " << triangles
+	 << ", \"bake_ms\": " << bakeMs
+	 << ", \"save_ms\": " << saveMs
+	 << ", \"load_ms\": " << loadMs
+	 << ", \"field_bytes\": " << field -> getMemorySize ()
+	 << ", \"stored_bricks\": " << field -> getNumStoredBricks ()
+	 << ", \"queries\": " << queries.size ()
+	 << ", \"hits\": " << hits
+	 << ", \"aabb_us\": { \"mean\": " << aabbLatency.mean
+	 << ", \"p50\": " << aabbLatency.p50 << ", \"p99\": " << aabbLatency.p99 << " }"
+	 << ", \"sdf_us\": { \"mean\": " << sdfLatency.mean
+	 << ", \"p50\": " << sdfLatency.p50 << ", \"p99\": " << sdfLatency.p99 << " }"
+	 << ", \"differ\": " << differ
+	 << ", \"mean_error_cells\": " << error << " }";
+
+    delete object;
+    delete mesh;
+  }
+  json << "\n  ]\n}\n";
+
+  std::ofstream file (output);
+  file << json.str ();
+  std::cout << "Results written to " << output << "\n";
+
+  if (!allOk) {
+    std::cerr << "The distance field contacts differ from the mesh ones\n";
+    return 1;
+  }
+  return 0;
+}
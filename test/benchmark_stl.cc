@@ -0,0 +1,262 @@
+// STL loader benchmark: how much do welded vertices save?
+//
+// Binary STL files of a CAD-like part (a plate with a grid of fins,
+// tessellated from 10k to 2M triangles) are written to --dir, once with
+// exact coordinates and once with a small jitter on each facet corner,
+// as produced by exporters that write every facet independently. Each
+// file is loaded unwelded (epsilon < 0), welded exactly (epsilon = 0)
+// and welded with --epsilon. The load time, vertex count, vertex memory
+// and the time of the downstream steps (computeAllNormals, AABB tree)
+// are printed and written to a JSON file. Exits with an error if a
+// welded mesh does not reproduce the facets of the file.
+//
+// Usage: benchmark_stl [--max-triangles N] [--epsilon e] [--dir dir]
+//                      [--output file.json] [file.stl ...]
+
+#include "benchmark_common.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////
+// Corpus
+////////////////////////////////////////////////////////////////////////
+
+typedef std::vector<float> Facets; // 9 floats per triangle
+
+// Adds the two triangles of the quad a, b, c, d (counter-clockwise)
+void quad (Facets & f, const float * a, const float * b, const float * c, const float * d) {
+  const float * corners [6] = { a, b, c, a, c, d };
+  for (int i = 0; i < 6; ++i) {
+    f.insert (f.end (), corners [i], corners [i] + 3);
+  }
+}
+
+// Grid of n x n quads from `origin` along `u` and `v`
+void patch (Facets & f, const float * origin, const float * u, const float * v, int n) {
+  auto point = [&] (int i, int j, float * p) {
+    for (int k = 0; k < 3; ++k) {
+      p [k] = origin [k] + u [k] * i / n + v [k] * j / n;
+    }
+  };
+  for (int j = 0; j < n; ++j) {
+    for (int i = 0; i < n; ++i) {
+      float a [3], b [3], c [3], d [3];
+      point (i, j, a);
+      point (i + 1, j, b);
+      point (i + 1, j + 1, c);
+      point (i, j + 1, d);
+      quad (f, a, b, c, d);
+    }
+  }
+}
+
+// Plate with fins x fins thin fins, each face tessellated in n x n quads
+Facets finnedPlate (int fins, int n) {
+  Facets f;
+  float O [3] = { 0, 0, 0 }, X [3] = { 1, 0, 0 }, Y [3] = { 0, 1, 0 };
+  float plateTop [3] = { 0, 0, 0.02f };
+  patch (f, O, Y, X, n);
+  patch (f, plateTop, X, Y, n);
+  for (int j = 0; j < fins; ++j) {
+    for (int i = 0; i < fins; ++i) {
+      float x = (i + 0.4f) / fins, y = (j + 0.4f) / fins, w = 0.2f / fins;
+      float base [3] = { x, y, 0.02f }, H [3] = { 0, 0, 0.1f };
+      float W [3] = { w, 0, 0 }, D [3] = { 0, w, 0 };
+      float Wn [3] = { -w, 0, 0 }, Dn [3] = { 0, -w, 0 };
+      float p1 [3] = { x + w, y, 0.02f }, p2 [3] = { x + w, y + w, 0.02f };
+      float p3 [3] = { x, y + w, 0.02f };
+      float top [3] = { x, y, 0.12f };
+      patch (f, base, W, H, n);
+      patch (f, p1, D, H, n);
+      patch (f, p2, Wn, H, n);
+      patch (f, p3, Dn, H, n);
+      patch (f, top, W, D, n);
+    }
+  }
+  return f;
+}
+
+// Moves each facet corner independently by up to `amount`
+Facets jitter (const Facets & f, float amount) {
+  Facets out (f);
+  std::mt19937 rng (7);
+  std::uniform_real_distribution<float> noise (-amount, amount);
+  for (size_t i = 0; i < out.size (); ++i) { out [i] += noise (rng); }
+  return out;
+}
+
+void writeSTL (const std::string & filename, const Facets & f) {
+  std::ofstream out (filename.c_str (), std::ios::binary);
+  char header [80] = "benchmark_stl";
+  unsigned int n = (unsigned int) (f.size () / 9);
+  out.write (header, 80);
+  out.write ((const char *) &n, 4);
+  for (unsigned int i = 0; i < n; ++i) {
+    float normal [3] = { 0, 0, 0 };
+    unsigned short attribute = 0;
+    out.write ((const char *) normal, 12);
+    out.write ((const char *) &f [9 * i], 36);
+    out.write ((const char *) &attribute, 2);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+// Measurements
+////////////////////////////////////////////////////////////////////////
+
+// Bytes used by the per-vertex arrays of a mesh
+double vertexMB (chai3d::cMesh * mesh) {
+  chai3d::cVertexArrayPtr v = mesh -> m_vertices;
+  size_t bytes = (v -> m_localPos.capacity () + v -> m_globalPos.capacity () +
+		  v -> m_normal.capacity () + v -> m_texCoord.capacity () +
+		  v -> m_tangent.capacity () + v -> m_bitangent.capacity ()) * sizeof (chai3d::cVector3d) +
+    v -> m_color.capacity () * sizeof (chai3d::cColorf) + v -> m_userData.capacity () * sizeof (int);
+  return bytes / 1e6;
+}
+
+// Every facet of the file that is not degenerate after welding must be
+// found in the mesh, in the same order, with corners within epsilon
+bool reproducesFacets (chai3d::cMesh * mesh, const std::string & filename, double epsilon) {
+  std::ifstream in (filename.c_str (), std::ios::binary);
+  in.seekg (84);
+  unsigned int t = 0;
+  float record [12];
+  unsigned short attribute;
+  while (in.read ((char *) record, 48) && in.read ((char *) &attribute, 2)) {
+    if (t >= mesh -> getNumTriangles ()) {
+      return epsilon > 0.0; // trailing facets may have collapsed
+    }
+    bool same = true;
+    for (int c = 0; c < 3 && same; ++c) {
+      chai3d::cVector3d p = mesh -> m_vertices -> getLocalPos
+	(mesh -> m_triangles -> getVertexIndex (t, c));
+      for (int k = 0; k < 3; ++k) {
+	double d = std::fabs (p (k) - (double) record [3 + 3 * c + k]);
+	same = same && d <= 2.0 * std::max (epsilon, 0.0);
+      }
+    }
+    if (same) {
+      ++t;
+    } else if (epsilon <= 0.0) {
+      return false;
+    }
+  }
+  return t == mesh -> getNumTriangles ();
+}
+
+int main (int argc, char * argv []) {
+  size_t maxTriangles = 2000000;
+  double epsilon = 1e-5;
+  std::string dir = ".";
+  std::string output = "benchmark-stl.json";
+  std::vector<std::string> files;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv [i];
+    bool hasValue = i + 1 < argc;
+    if (arg == "--max-triangles" && hasValue) {
+      maxTriangles = std::stoul (argv [++i]);
+    } else if (arg == "--epsilon" && hasValue) {
+      epsilon = std::stod (argv [++i]);
+    } else if (arg == "--dir" && hasValue) {
+      dir = argv [++i];
+    } else if (arg == "--output" && hasValue) {
+      output = argv [++i];
+    } else if (arg.size () > 2 && arg.compare (0, 2, "--") == 0) {
+      std::cerr << "Unknown or incomplete option " << arg << "\n"
+		<< "Options: --max-triangles --epsilon --dir --output [file.stl ...]\n";
+      return 1;
+    } else {
+      files.push_back (arg);
+    }
+  }
+
+  // corpus: 10 x 10 fins and the plate make 502 faces of n x n quads
+  std::vector<std::string> corpus;
+  const size_t sizes [] = { 10000, 100000, 1000000, 2000000 };
+  for (size_t target : sizes) {
+    if (target > maxTriangles) { break; }
+    int n = (int) std::ceil (std::sqrt (target / (2.0 * 502.0)));
+    Facets f = finnedPlate (10, n);
+    std::ostringstream name;
+    name << dir << "/stl-" << f.size () / 9;
+    writeSTL (name.str () + ".stl", f);
+    writeSTL (name.str () + "-jitter.stl", jitter (f, 0.1f * (float) epsilon));
+    corpus.push_back (name.str () + ".stl");
+    corpus.push_back (name.str () + "-jitter.stl");
+  }
+  corpus.insert (corpus.end (), files.begin (), files.end ());
+
+  struct Mode { const char * name; double epsilon; };
+  Mode modes [] = { { "unwelded", -1.0 }, { "exact", 0.0 }, { "epsilon", epsilon } };
+
+  std::cout << std::fixed << std::setprecision (1)
+	    << std::left << std::setw (24) << "file" << std::setw (10) << "weld" << std::right
+	    << std::setw (10) << "triangles" << std::setw (10) << "vertices"
+	    << std::setw (11) << "vertex MB" << std::setw (10) << "load ms"
+	    << std::setw (12) << "normals ms" << std::setw (10) << "aabb ms" << "  result\n";
+
+  bool allOk = true;
+  std::ostringstream json;
+  json << std::setprecision (10)
+       << "{\n  \"benchmark\": \"stl\",\n  \"epsilon\": " << epsilon << ",\n  \"results\": [\n";
+  bool firstResult = true;
+  for (size_t i = 0; i < corpus.size (); ++i) {
+    const std::string & file = corpus [i];
+    std::string name = file.substr (file.find_last_of ("/\\") + 1);
+    for (const Mode & mode : modes) {
+      chai3d::g_stlLoaderWeldingEpsilon = mode.epsilon;
+      chai3d::cMultiMesh * object = new chai3d::cMultiMesh ();
+      auto begin = std::chrono::steady_clock::now ();
+      bool ok = chai3d::cLoadFileSTL (object, file);
+      double loadMs = elapsedMs (begin);
+
+      std::string result = "failed";
+      unsigned int nt = 0, nv = 0;
+      double mb = 0.0, normalsMs = 0.0, aabbMs = 0.0;
+      if (ok) {
+	chai3d::cMesh * mesh = object -> getMesh (0);
+	nt = mesh -> getNumTriangles ();
+	nv = mesh -> getNumVertices ();
+	mb = vertexMB (mesh);
+	begin = std::chrono::steady_clock::now ();
+	mesh -> computeAllNormals ();
+	normalsMs = elapsedMs (begin);
+	begin = std::chrono::steady_clock::now ();
+	mesh -> createAABBCollisionDetector (0.0);
+	aabbMs = elapsedMs (begin);
+	result = reproducesFacets (mesh, file, mode.epsilon) ? "ok" : "facets differ";
+      }
+      allOk = allOk && result == "ok";
+
+      std::cout << std::left << std::setw (24) << name << std::setw (10) << mode.name << std::right
+		<< std::setw (10) << nt << std::setw (10) << nv << std::setw (11) << mb
+		<< std::setw (10) << loadMs << std::setw (12) << normalsMs
+		<< std::setw (10) << aabbMs << "  " << result << std::endl;
+
+      json << (firstResult ? "" : ",\n")
+	   << "    { \"file\": \"" << name << "\", \"weld\": \"" << mode.name
+	   << "\", \"triangles\": " << nt << ", \"vertices\": " << nv
+	   << ", \"vertex_mb\": " << mb << ", \"load_ms\": " << loadMs
+	   << ", \"normals_ms\": " << normalsMs << ", \"aabb_ms\": " << aabbMs
+	   << ", \"ok\": " << (result == "ok" ? "true" : "false") << " }";
+      firstResult = false;
+      delete object;
+    }
+  }
+  json << "\n  ]\n}\n";
+  std::ofstream (output.c_str ()) << json.str ();
+
+  chai3d::g_stlLoaderWeldingEpsilon = 0.0;
+  return allOk ? 0 : 1;
+}
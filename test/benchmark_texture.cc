@@ -0,0 +1,190 @@
+// Haptic texture benchmark: how much faster is a precomputed haptic
+// texture field than reading the normal map image?
+//
+// For each texture size, a normal map is created from a noisy height
+// image and sampled at the same texture coordinates, along a
+// continuous stroke (as a sliding contact) and at random positions,
+// with the code the finger-proxy algorithm uses on the normal map
+// image and with the precomputed field (finest level, and blended
+// mipmap levels). The time per sample and the build time of the field
+// are printed and written to a JSON file. Exits with an error if the
+// field does not reproduce the normal map samples.
+//
+// Usage: benchmark_texture [--samples N] [--max-size N] [--output file.json]
+
+#include "benchmark_common.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+chai3d::cImagePtr heightImage (int size) {
+  chai3d::cImagePtr image = chai3d::cImage::create ();
+  image -> allocate (size, size, GL_RGB);
+  std::mt19937 rng (size);
+  std::uniform_int_distribution<int> noise (0, 40);
+  for (int y = 0; y < size; ++y) {
+    for (int x = 0; x < size; ++x) {
+      int level = 100 + (int) (60.0 * std::sin (x * 0.05) * std::cos (y * 0.07)) + noise (rng);
+      image -> setPixelColor (x, y, chai3d::cColorb (level, level, level));
+    }
+  }
+  return image;
+}
+
+// Gradient at (u, v), read from the normal map image as in
+// cAlgorithmFingerProxy::updateForce
+void sampleImage (chai3d::cImagePtr image, double u, double v, double out [3]) {
+  chai3d::cColorb color00, color01, color10, color11;
+  int w = image -> getWidth ();
+  int h = image -> getHeight ();
+  double px = (w - 1) * u;
+  double py = (h - 1) * v;
+  int pixelX0 = (int) (std::floor (px));
+  int pixelY0 = (int) (std::floor (py));
+  int pixelX1 = chai3d::cClamp (pixelX0 + 1, 0, (w - 1));
+  int pixelY1 = chai3d::cClamp (pixelY0 + 1, 0, (h - 1));
+  image -> getPixelColor (pixelX0, pixelY0, color00);
+  image -> getPixelColor (pixelX1, pixelY0, color10);
+  image -> getPixelColor (pixelX1, pixelY1, color11);
+  image -> getPixelColor (pixelX0, pixelY1, color01);
+  double x = px - std::floor (px);
+  double y = py - std::floor (py);
+  const double SCALE = (1.0 / 255.0);
+  const chai3d::cColorb * c [4] = { &color00, &color10, &color01, &color11 };
+  double weight [4] = { (1 - x) * (1 - y), x * (1 - y), (1 - x) * y, x * y };
+  out [0] = out [1] = out [2] = 0.0;
+  for (int i = 0; i < 4; ++i) {
+    out [0] += weight [i] * SCALE * (c [i] -> getR () - 128);
+    out [1] -= weight [i] * SCALE * (c [i] -> getG () - 128);
+    out [2] += weight [i] * SCALE * (c [i] -> getB () - 128);
+  }
+}
+
+int main (int argc, char * argv []) {
+  int samples = 2000000;
+  int maxSize = 4096;
+  std::string output = "benchmark-texture.json";
+
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv [i];
+    bool hasValue = i + 1 < argc;
+    if (arg == "--samples" && hasValue) {
+      samples = std::stoi (argv [++i]);
+    } else if (arg == "--max-size" && hasValue) {
+      maxSize = std::stoi (argv [++i]);
+    } else if (arg == "--output" && hasValue) {
+      output = argv [++i];
+    } else {
+      std::cerr << "Unknown or incomplete option " << arg << "\n"
+		<< "Options: --samples --max-size --output\n";
+      return 1;
+    }
+  }
+
+  std::cout << std::fixed << std::setprecision (2)
+	    << std::setw (6) << "size" << std::setw (8) << "access"
+	    << std::setw (12) << "image ns" << std::setw (12) << "field ns"
+	    << std::setw (12) << "mipmap ns" << std::setw (10) << "speedup"
+	    << std::setw (11) << "build ms" << std::setw (12) << "max error\n";
+
+  bool allOk = true;
+  std::ostringstream json;
+  json << std::setprecision (10)
+       << "{\n  \"benchmark\": \"texture\",\n  \"results\": [\n";
+  bool firstResult = true;
+  for (int size = 256; size <= maxSize; size *= 4) {
+    chai3d::cNormalMapPtr normalMap = chai3d::cNormalMap::create ();
+    chai3d::cImagePtr height = heightImage (size);
+    normalMap -> createMap (height);
+
+    auto begin = std::chrono::steady_clock::now ();
+    chai3d::cHapticTextureFieldPtr field = chai3d::cHapticTextureField::create ();
+    field -> createField (normalMap -> m_image, height, 1);
+    double buildMs = elapsedMs (begin);
+    chai3d::cHapticTextureFieldPtr mipmaps = chai3d::cHapticTextureField::create ();
+    mipmaps -> createField (normalMap -> m_image, height, 0);
+
+    for (int pattern = 0; pattern < 2; ++pattern) {
+      // texture coordinates: a stroke moving about one texel per
+      // sample, or random positions
+      std::vector<double> uv (2 * samples);
+      std::mt19937 rng (1);
+      std::uniform_real_distribution<double> unit (0.0, 1.0);
+      for (int i = 0; i < samples; ++i) {
+	if (pattern == 0) {
+	  double t = (double) i / size;
+	  uv [2 * i] = 0.5 + 0.45 * std::sin (t * 0.7);
+	  uv [2 * i + 1] = 0.5 + 0.45 * std::sin (t * 0.5 + 1.0);
+	} else {
+	  uv [2 * i] = unit (rng);
+	  uv [2 * i + 1] = unit (rng);
+	}
+      }
+
+      double sum = 0.0, maxError = 0.0;
+      double value [4], reference [3];
+
+      begin = std::chrono::steady_clock::now ();
+      for (int i = 0; i < samples; ++i) {
+	sampleImage (normalMap -> m_image, uv [2 * i], uv [2 * i + 1], reference);
+	sum += reference [0] + reference [1] + reference [2];
+      }
+      double imageNs = 1e6 * elapsedMs (begin) / samples;
+
+      begin = std::chrono::steady_clock::now ();
+      for (int i = 0; i < samples; ++i) {
+	field -> sample (uv [2 * i], uv [2 * i + 1], 0.0, value);
+	sum += value [0] + value [1] + value [2];
+      }
+      double fieldNs = 1e6 * elapsedMs (begin) / samples;
+
+      begin = std::chrono::steady_clock::now ();
+      for (int i = 0; i < samples; ++i) {
+	mipmaps -> sample (uv [2 * i], uv [2 * i + 1], (i % 7) * 0.4, value);
+	sum += value [0] + value [1] + value [2];
+      }
+      double mipmapNs = 1e6 * elapsedMs (begin) / samples;
+
+      for (int i = 0; i < samples; i += 97) {
+	sampleImage (normalMap -> m_image, uv [2 * i], uv [2 * i + 1], reference);
+	field -> sample (uv [2 * i], uv [2 * i + 1], 0.0, value);
+	for (int k = 0; k < 3; ++k) {
+	  maxError = std::max (maxError, std::fabs (value [k] - reference [k]));
+	}
+      }
+      // keeps the sampling loops from being optimized out
+      volatile double sink = sum;
+      (void) sink;
+
+      bool ok = maxError < 1e-5;
+      allOk = allOk && ok;
+
+      const char * access = pattern == 0 ? "stroke" : "random";
+      std::cout << std::setw (6) << size << std::setw (8) << access
+		<< std::setw (12) << imageNs << std::setw (12) << fieldNs
+		<< std::setw (12) << mipmapNs << std::setw (10) << imageNs / fieldNs
+		<< std::setw (11) << buildMs << std::setw (12) << std::scientific
+		<< std::setprecision (1) << maxError << std::fixed << std::setprecision (2)
+		<< (ok ? "" : "  FAILED") << std::endl;
+
+      json << (firstResult ? "" : ",\n")
+	   << "    { \"size\": " << size << ", \"access\": \"" << access
+	   << "\", \"image_ns\": " << imageNs << ", \"field_ns\": " << fieldNs
+	   << ", \"mipmap_ns\": " << mipmapNs << ", \"build_ms\": " << buildMs
+	   << ", \"max_error\": " << maxError << " }";
+      firstResult = false;
+    }
+  }
+  json << "\n  ]\n}\n";
+  std::ofstream (output.c_str ()) << json.str ();
+
+  return allOk ? 0 : 1;
+}
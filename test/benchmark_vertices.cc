@@ -0,0 +1,203 @@
+// Vertex transform benchmark: are the global positions of a mesh
+// computed at memory bandwidth?
+//
+// Meshes of 1k to --max-vertices random vertices, attached to a rotated
+// and translated parent, have their global positions computed --repeats
+// times, once with a loop over cVertexArray::computeGlobalPosition (one
+// vertex at a time) and once with cMesh::computeGlobalPositions (the
+// batch kernel of cVertexArray). The time per vertex of both, the
+// bandwidth of the kernel (a vertex is read and written, 48 bytes) and
+// the time of cMesh::scaleXYZ are printed and written to a JSON file.
+// The time to read the positions of random vertices, as collision
+// queries do, is measured with cVertexArray::getLocalPos and with the
+// public array m_localPos, to check that the accessor costs nothing in
+// double precision storage, which is the default.
+// The mesh is then switched to compact storage (single precision, then
+// quantized normals), and the memory used by its vertices, the time to
+// compute the global positions and the largest difference from the
+// double precision positions are reported as well. Exits with an error
+// if the two double precision results differ, if the two reads differ,
+// or if the compact positions are further than a micrometer from them.
+//
+// Usage: benchmark_vertices [--max-vertices N] [--repeats N]
+//                           [--output file.json]
+
+#include "../include/chai3d.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Median of the times (in ns per vertex) of `repeats` runs of `run`
+template <typename F>
+double medianTime (int repeats, unsigned int vertices, F run) {
+  std::vector<double> times;
+  for (int r = 0; r < repeats; ++r) {
+    auto start = std::chrono::steady_clock::now ();
+    run ();
+    times.push_back (std::chrono::duration<double, std::nano>
+		     (std::chrono::steady_clock::now () - start).count () / vertices);
+  }
+  std::sort (times.begin (), times.end ());
+  return times [times.size () / 2];
+}
+
+int main (int argc, char * argv []) {
+  unsigned int maxVertices = 4096000;
+  int repeats = 20;
+  std::string output = "benchmark-vertices.json";
+
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv [i];
+    bool hasValue = i + 1 < argc;
+    if (arg == "--max-vertices" && hasValue) {
+      maxVertices = std::stoul (argv [++i]);
+    } else if (arg == "--repeats" && hasValue) {
+      repeats = std::stoi (argv [++i]);
+    } else if (arg == "--output" && hasValue) {
+      output = argv [++i];
+    } else {
+      std::cerr << "Unknown or incomplete option " << arg << "\n"
+		<< "Options: --max-vertices --repeats --output\n";
+      return 1;
+    }
+  }
+
+  std::mt19937 rng (42);
+  std::uniform_real_distribution<double> coordinate (-0.1, 0.1);
+
+  std::cout << std::fixed << std::setprecision (2)
+	    << std::setw (10) << "vertices" << std::setw (12) << "loop ns/v"
+	    << std::setw (12) << "batch ns/v" << std::setw (10) << "GB/s"
+	    << std::setw (12) << "scale ns/v" << std::setw (11) << "get ns/v"
+	    << std::setw (12) << "array ns/v" << std::setw (9) << "mismatch"
+	    << std::setw (10) << "B/v" << std::setw (10) << "compact"
+	    << std::setw (10) << "quant" << std::setw (14) << "compact ns/v"
+	    << std::setw (10) << "error um\n";
+
+  bool allOk = true;
+  std::ostringstream json;
+  json << std::setprecision (10)
+       << "{\n  \"benchmark\": \"vertices\",\n  \"repeats\": " << repeats
+       << ",\n  \"results\": [\n";
+  for (unsigned int size = 1000; size <= maxVertices; size *= 4) {
+    chai3d::cGenericObject * parent = new chai3d::cGenericObject ();
+    parent -> setLocalPos (0.1, -0.2, 0.3);
+    parent -> setLocalRot (chai3d::cMatrix3d (0.3, 0.5, 0.8, chai3d::cDegToRad (37.0)));
+    chai3d::cMesh * mesh = new chai3d::cMesh ();
+    parent -> addChild (mesh);
+    mesh -> setLocalPos (0.01, 0.02, -0.03);
+    for (unsigned int i = 0; i < size; ++i) {
+      mesh -> newVertex (coordinate (rng), coordinate (rng), coordinate (rng));
+      chai3d::cVector3d normal (coordinate (rng), coordinate (rng), coordinate (rng));
+      mesh -> m_vertices -> setNormal (i, chai3d::cNormalize (normal));
+    }
+    parent -> computeGlobalPositions (true);
+
+    chai3d::cVertexArrayPtr vertices = mesh -> m_vertices;
+    const chai3d::cVector3d globalPos = mesh -> getGlobalPos ();
+    const chai3d::cMatrix3d globalRot = mesh -> getGlobalRot ();
+
+    double loopTime = medianTime (repeats, size, [&] () {
+      for (unsigned int i = 0; i < size; ++i) {
+	vertices -> computeGlobalPosition (i, globalPos, globalRot);
+      }
+    });
+    std::vector<chai3d::cVector3d> reference = vertices -> m_globalPos;
+
+    double batchTime = medianTime (repeats, size, [&] () {
+      mesh -> computeGlobalPositions (false, parent -> getGlobalPos (),
+				      parent -> getGlobalRot ());
+    });
+    int mismatch = 0;
+    for (unsigned int i = 0; i < size; ++i) {
+      if (chai3d::cDistance (reference [i], vertices -> m_globalPos [i]) != 0.0) {
+	mismatch++;
+      }
+    }
+    allOk = allOk && (mismatch == 0);
+
+    // scale up and down by powers of two, so that the mesh is unchanged
+    int scaled = 0;
+    double scaleTime = medianTime (repeats, size, [&] () {
+      double factor = (scaled++ % 2 == 0) ? 2.0 : 0.5;
+      mesh -> scaleXYZ (factor, factor, factor);
+    });
+
+    // random reads, through the accessor and through the array
+    std::uniform_int_distribution<unsigned int> pick (0, size - 1);
+    std::vector<unsigned int> reads (size);
+    for (auto & r : reads) { r = pick (rng); }
+    chai3d::cVector3d accessorSum (0.0, 0.0, 0.0);
+    double accessorTime = medianTime (repeats, size, [&] () {
+      accessorSum.zero ();
+      for (unsigned int r : reads) { accessorSum += vertices -> getLocalPos (r); }
+    });
+    chai3d::cVector3d arraySum (0.0, 0.0, 0.0);
+    double arrayTime = medianTime (repeats, size, [&] () {
+      arraySum.zero ();
+      for (unsigned int r : reads) { arraySum += vertices -> m_localPos [r]; }
+    });
+    if (chai3d::cDistance (accessorSum, arraySum) != 0.0) { mismatch++; }
+    allOk = allOk && (mismatch == 0);
+
+    // compact storage, before and after global positions are computed
+    double doubleBytes = (double) vertices -> getMemoryUsage () / size;
+    vertices -> setCompactStorage (true);
+    double compactBytes = (double) vertices -> getMemoryUsage () / size;
+    double compactTime = medianTime (repeats, size, [&] () {
+      mesh -> computeGlobalPositions (false, parent -> getGlobalPos (),
+				      parent -> getGlobalRot ());
+    });
+    double error = 0.0;
+    for (unsigned int i = 0; i < size; ++i) {
+      error = std::max (error, chai3d::cDistance (reference [i], vertices -> getGlobalPos (i)));
+    }
+    allOk = allOk && (error < 1e-6);
+    vertices -> setCompactStorage (true, true);
+    double quantizedBytes = (double) vertices -> getMemoryUsage () / size;
+
+    double bandwidth = 48.0 / batchTime;
+    std::cout << std::setw (10) << size << std::setw (12) << loopTime
+	      << std::setw (12) << batchTime << std::setw (10) << bandwidth
+	      << std::setw (12) << scaleTime << std::setw (11) << accessorTime
+	      << std::setw (12) << arrayTime << std::setw (9) << mismatch
+	      << std::setw (10) << doubleBytes << std::setw (10) << compactBytes
+	      << std::setw (10) << quantizedBytes << std::setw (14) << compactTime
+	      << std::setw (10) << 1e6 * error << "\n";
+
+    json << (size == 1000 ? "" : ",\n")
+	 << "    { \"vertices\": " << size
+	 << ", \"loop_ns_per_vertex\": " << loopTime
+	 << ", \"batch_ns_per_vertex\": " << batchTime
+	 << ", \"batch_gb_per_s\": " << bandwidth
+	 << ", \"scale_ns_per_vertex\": " << scaleTime
+	 << ", \"get_ns_per_vertex\": " << accessorTime
+	 << ", \"array_ns_per_vertex\": " << arrayTime
+	 << ", \"mismatch\": " << mismatch
+	 << ", \"bytes_per_vertex\": " << doubleBytes
+	 << ", \"compact_bytes_per_vertex\": " << compactBytes
+	 << ", \"quantized_bytes_per_vertex\": " << quantizedBytes
+	 << ", \"compact_ns_per_vertex\": " << compactTime
+	 << ", \"compact_max_error\": " << error << " }";
+
+    delete parent;
+  }
+  json << "\n  ]\n}\n";
+
+  std::ofstream file (output);
+  file << json.str ();
+  std::cout << "Results written to " << output << "\n";
+
+  if (!allOk) {
+    std::cerr << "The batch, accessor or compact positions differ from the per vertex ones\n";
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,217 @@
+// Voxel collision benchmark: how much does the distance field of a
+// cVoxelObject speed up haptic queries on large volumes?
+//
+// Synthetic volumes (a thick spherical shell, as the skull of a CT
+// scan, with small blobs scattered around it) from 64^3 to --max-size
+// voxels are queried with proxy-like segments: short segments starting
+// anywhere in the volume, with a tool radius. Every query runs without
+// and with the distance field, and the nearest collisions must be
+// identical. The build time and memory of the field, the query latency
+// distribution and the time of a surface distance lookup are printed
+// and written to a JSON file. Exits with an error if a result differs.
+//
+// Usage: benchmark_voxel [--max-size N] [--queries N] [--radius R]
+//                        [--output file.json]
+
+#include "benchmark_common.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+struct Outcome {
+  bool hit;
+  chai3d::cVector3d position;
+  chai3d::cVector3d normal;
+  int voxel [3];
+};
+
+chai3d::cMultiImagePtr syntheticVolume (int size) {
+  chai3d::cMultiImagePtr image = chai3d::cMultiImage::create ();
+  image -> allocate (size, size, size, GL_LUMINANCE);
+  unsigned char * data = image -> getData ();
+
+  // shell between 0.35 and 0.42 of the size, blobs of 0.02
+  std::mt19937 rng (size);
+  std::uniform_real_distribution<double> uniform (0.05, 0.95);
+  std::vector<chai3d::cVector3d> blobs;
+  for (int i = 0; i < 40; ++i) {
+    blobs.push_back (chai3d::cVector3d (uniform (rng), uniform (rng), uniform (rng)));
+  }
+  for (int z = 0; z < size; ++z) {
+    for (int y = 0; y < size; ++y) {
+      for (int x = 0; x < size; ++x) {
+	chai3d::cVector3d p ((x + 0.5) / size, (y + 0.5) / size, (z + 0.5) / size);
+	double r = chai3d::cDistance (p, chai3d::cVector3d (0.5, 0.5, 0.5));
+	bool occupied = (r > 0.35) && (r < 0.42);
+	for (size_t i = 0; !occupied && i < blobs.size (); ++i) {
+	  occupied = chai3d::cDistance (p, blobs [i]) < 0.02;
+	}
+	data [((size_t) z * size + y) * size + x] = occupied ? 255 : 0;
+      }
+    }
+  }
+  return image;
+}
+
+// Runs the queries, and stores the nearest collision of each one
+Latency runQueries (chai3d::cVoxelObject * object, const std::vector<Query> & queries,
+		    double radius, std::vector<Outcome> & outcomes) {
+  chai3d::cCollisionSettings settings;
+  settings.m_checkForNearestCollisionOnly = true;
+  settings.m_collisionRadius = radius;
+  chai3d::cCollisionRecorder recorder;
+
+  std::vector<double> latencies;
+  latencies.reserve (queries.size ());
+  outcomes.resize (queries.size ());
+  for (size_t i = 0; i < queries.size (); ++i) {
+    recorder.clear ();
+    auto start = std::chrono::steady_clock::now ();
+    bool hit = object -> computeCollisionDetection (queries [i].a, queries [i].b,
+						    recorder, settings);
+    latencies.push_back (elapsedUs (start));
+    Outcome & o = outcomes [i];
+    o.hit = hit;
+    o.position = recorder.m_nearestCollision.m_localPos;
+    o.normal = recorder.m_nearestCollision.m_localNormal;
+    o.voxel [0] = hit ? recorder.m_nearestCollision.m_voxelIndexX : 0;
+    o.voxel [1] = hit ? recorder.m_nearestCollision.m_voxelIndexY : 0;
+    o.voxel [2] = hit ? recorder.m_nearestCollision.m_voxelIndexZ : 0;
+  }
+  return summarize (latencies);
+}
+
+int main (int argc, char * argv []) {
+  int maxSize = 256;
+  int queriesNum = 20000;
+  double radius = 0.01;
+  std::string output = "benchmark-voxel.json";
+
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv [i];
+    bool hasValue = i + 1 < argc;
+    if (arg == "--max-size" && hasValue) {
+      maxSize = std::stoi (argv [++i]);
+    } else if (arg == "--queries" && hasValue) {
+      queriesNum = std::stoi (argv [++i]);
+    } else if (arg == "--radius" && hasValue) {
+      radius = std::stod (argv [++i]);
+    } else if (arg == "--output" && hasValue) {
+      output = argv [++i];
+    } else {
+      std::cerr << "Unknown or incomplete option " << arg << "\n"
+		<< "Options: --max-size --queries --radius --output\n";
+      return 1;
+    }
+  }
+
+  std::cout << std::fixed << std::setprecision (2)
+	    << std::setw (6) << "size" << std::setw (11) << "build ms"
+	    << std::setw (10) << "field kB" << std::setw (9) << "bricks"
+	    << std::setw (8) << "hits" << std::setw (12) << "volume p50"
+	    << std::setw (12) << "volume p99" << std::setw (11) << "field p50"
+	    << std::setw (11) << "field p99" << std::setw (10) << "speedup"
+	    << std::setw (13) << "distance ns" << std::setw (10) << "mismatch\n";
+
+  bool allOk = true;
+  std::ostringstream json;
+  json << std::setprecision (10)
+       << "{\n  \"benchmark\": \"voxel\",\n  \"radius\": " << radius
+       << ",\n  \"results\": [\n";
+  for (int size = 64; size <= maxSize; size *= 2) {
+    chai3d::cVoxelObject * object = new chai3d::cVoxelObject ();
+    chai3d::cTexture3dPtr texture = chai3d::cTexture3d::create ();
+    texture -> setImage (syntheticVolume (size));
+    object -> setTexture (texture);
+    object -> setIsosurfaceValue (0.5f);
+
+    auto queries = volumeQueries (queriesNum, 0.55, 0.02, 42 + size);
+
+    std::vector<Outcome> volume, field;
+    Latency volumeLatency = runQueries (object, queries, radius, volume);
+
+    auto begin = std::chrono::steady_clock::now ();
+    object -> buildDistanceField ();
+    double buildMs = elapsedMs (begin);
+    chai3d::cVoxelDistanceFieldPtr distanceField = object -> getDistanceField ();
+    int numBricks = distanceField -> getNumBricks (0) * distanceField -> getNumBricks (1)
+      * distanceField -> getNumBricks (2);
+    double fieldKB = numBricks * sizeof (int16_t) / 1024.0;
+
+    Latency fieldLatency = runQueries (object, queries, radius, field);
+
+    // surface distance at the start of the queries
+    double distanceSum = 0.0;
+    begin = std::chrono::steady_clock::now ();
+    for (int repeat = 0; repeat < 10; ++repeat) {
+      for (auto & q : queries) {
+	double d;
+	object -> computeSurfaceDistance (q.a, d);
+	distanceSum += d;
+      }
+    }
+    double distanceNs = std::chrono::duration<double, std::nano>
+      (std::chrono::steady_clock::now () - begin).count () / (10.0 * queries.size ());
+
+    int hits = 0;
+    int mismatches = 0;
+    for (size_t i = 0; i < queries.size (); ++i) {
+      hits += volume [i].hit ? 1 : 0;
+      bool same = (volume [i].hit == field [i].hit);
+      if (same && volume [i].hit) {
+	same = volume [i].position.equals (field [i].position, 0.0)
+	  && volume [i].normal.equals (field [i].normal, 0.0)
+	  && std::equal (volume [i].voxel, volume [i].voxel + 3, field [i].voxel);
+      }
+      mismatches += same ? 0 : 1;
+    }
+    allOk = allOk && mismatches == 0;
+
+    std::cout << std::setw (6) << size << std::setw (11) << buildMs
+	      << std::setw (10) << fieldKB << std::setw (9)
+	      << distanceField -> getNumOccupiedBricks () << std::setw (8) << hits
+	      << std::setw (12) << volumeLatency.p50 << std::setw (12) << volumeLatency.p99
+	      << std::setw (11) << fieldLatency.p50 << std::setw (11) << fieldLatency.p99
+	      << std::setw (10) << volumeLatency.mean / fieldLatency.mean
+	      << std::setw (13) << distanceNs
+	      << std::setw (9) << mismatches << "\n";
+
+    json << (size == 64 ? "" : ",\n")
+	 << "    { \"size\": " << size
+	 << ", \"build_ms\": " << buildMs
+	 << ", \"field_bytes\": " << (size_t) (numBricks * sizeof (int16_t))
+	 << ", \"bricks\": " << numBricks
+	 << ", \"occupied_bricks\": " << distanceField -> getNumOccupiedBricks ()
+	 << ", \"queries\": " << queries.size ()
+	 << ", \"hits\": " << hits
+	 << ", \"volume_us\": { \"mean\": " << volumeLatency.mean
+	 << ", \"p50\": " << volumeLatency.p50 << ", \"p99\": " << volumeLatency.p99 << " }"
+	 << ", \"field_us\": { \"mean\": " << fieldLatency.mean
+	 << ", \"p50\": " << fieldLatency.p50 << ", \"p99\": " << fieldLatency.p99 << " }"
+	 << ", \"distance_ns\": " << distanceNs
+	 << ", \"distance_sum\": " << distanceSum
+	 << ", \"mismatches\": " << mismatches << " }";
+
+    delete object;
+  }
+  json << "\n  ]\n}\n";
+
+  std::ofstream file (output);
+  file << json.str ();
+  std::cout << "Results written to " << output << "\n";
+
+  if (!allOk) {
+    std::cerr << "The distance field changed the collision results\n";
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,46 @@
+// An object created in an arena creates a collision tree and an effect
+// in its constructor: both must come from the arena of the object. An
+// object created with `new` afterwards, and its collision tree, must
+// come from the heap.
+
+#include "../include/chai3d.h"
+#include <iostream>
+
+class cBoxWithEffect : public chai3d::cMesh {
+public:
+  cBoxWithEffect () {
+    chai3d::cCreateBox (this, 0.02, 0.02, 0.02);
+    createAABBCollisionDetector (0.001);
+    createEffectSurface ();
+  }
+
+  chai3d::cGenericEffect * surface () { return m_effects [0]; }
+};
+
+int main () {
+  chai3d::cWorld * world = new chai3d::cWorld ();
+  chai3d::cArena * arena = world -> getObjectArena ();
+
+  cBoxWithEffect * box = chai3d::cArena::create<cBoxWithEffect> (arena);
+  world -> addChild (box);
+  if (box -> getArena () != arena ||
+      box -> getCollisionDetector () -> getArena () != arena ||
+      box -> surface () -> getArena () != arena) {
+    std::cerr << "Allocations of the constructor are not in the arena\n";
+    return 1;
+  }
+
+  chai3d::cMesh * mesh = new chai3d::cMesh ();
+  chai3d::cCreateBox (mesh, 0.02, 0.02, 0.02);
+  mesh -> createAABBCollisionDetector (0.001);
+  world -> addChild (mesh);
+  if (mesh -> getArena () != nullptr ||
+      mesh -> getCollisionDetector () -> getArena () != nullptr) {
+    std::cerr << "Objects created with new are in an arena\n";
+    return 1;
+  }
+
+  delete world;
+  std::cout << "ok\n";
+  return 0;
+}
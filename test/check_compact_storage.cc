@@ -0,0 +1,154 @@
+// A sphere mesh under a rotated parent is built twice, and the vertices
+// of one copy are switched to compact storage
+// (cVertexArray::setCompactStorage): single precision positions and
+// normals, then quantized normals. Positions, global positions and
+// normals must stay within the precision of the storage, texture
+// coordinates and colors must be kept, and segments must hit the same
+// triangles at the same points, up to single precision. Vertices moved
+// in compact storage, and the storage switched back to double precision,
+// must keep their positions.
+
+#include "../include/chai3d.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+struct Scene {
+  chai3d::cWorld * world;
+  chai3d::cMesh * mesh;
+};
+
+Scene buildScene () {
+  Scene scene;
+  scene.world = new chai3d::cWorld ();
+  chai3d::cGenericObject * parent = new chai3d::cGenericObject ();
+  parent -> setLocalPos (0.3, -0.1, 0.2);
+  parent -> setLocalRot (chai3d::cMatrix3d (1.0, 2.0, 0.5, 0.7));
+  scene.world -> addChild (parent);
+  scene.mesh = new chai3d::cMesh ();
+  chai3d::cCreateSphere (scene.mesh, 0.1, 24, 16, chai3d::cVector3d (0.01, 0.02, 0.03));
+  scene.mesh -> computeBoundaryBox (true);
+  scene.mesh -> createAABBCollisionDetector (0.0);
+  parent -> addChild (scene.mesh);
+  scene.world -> computeGlobalPositions (false);
+  return scene;
+}
+
+// Largest difference between the vertices of two meshes
+struct Errors {
+  double localPos;
+  double globalPos;
+  double normal;
+  double texCoord;
+  double color;
+};
+
+Errors compare (chai3d::cMesh * a, chai3d::cMesh * b) {
+  Errors errors = { 0.0, 0.0, 0.0, 0.0, 0.0 };
+  chai3d::cVertexArrayPtr va = a -> m_vertices;
+  chai3d::cVertexArrayPtr vb = b -> m_vertices;
+  for (unsigned int i = 0; i < va -> getNumElements (); ++i) {
+    errors.localPos = std::max (errors.localPos,
+				chai3d::cDistance (va -> getLocalPos (i), vb -> getLocalPos (i)));
+    errors.globalPos = std::max (errors.globalPos,
+				 chai3d::cDistance (va -> getGlobalPos (i), vb -> getGlobalPos (i)));
+    errors.normal = std::max (errors.normal,
+			      chai3d::cDistance (va -> getNormal (i), vb -> getNormal (i)));
+    errors.texCoord = std::max (errors.texCoord,
+				chai3d::cDistance (va -> getTexCoord (i), vb -> getTexCoord (i)));
+    chai3d::cColorf ca = va -> getColor (i);
+    chai3d::cColorf cb = vb -> getColor (i);
+    errors.color = std::max (errors.color, (double) (std::abs (ca.getR () - cb.getR ())
+						   + std::abs (ca.getG () - cb.getG ())
+						   + std::abs (ca.getB () - cb.getB ())
+						   + std::abs (ca.getA () - cb.getA ())));
+  }
+  return errors;
+}
+
+// Collisions of segments through the sphere, from all directions
+bool sameCollisions (Scene & a, Scene & b, double tolerance) {
+  chai3d::cCollisionSettings settings;
+  settings.m_checkForNearestCollisionOnly = false;
+  chai3d::cVector3d center = a.mesh -> getGlobalPos ();
+  int hits = 0;
+  for (int k = 0; k < 200; ++k) {
+    chai3d::cVector3d direction (cos (0.37 * k) * sin (0.11 * k + 0.2),
+				 sin (0.37 * k) * sin (0.11 * k + 0.2),
+				 cos (0.11 * k + 0.2));
+    chai3d::cVector3d offset (0.05 * sin (0.23 * k), 0.05 * cos (0.31 * k), 0.0);
+    chai3d::cVector3d from = center + offset + 0.3 * direction;
+    chai3d::cVector3d to = center + offset - 0.3 * direction;
+    chai3d::cCollisionRecorder ra, rb;
+    a.world -> computeCollisionDetection (from, to, ra, settings);
+    b.world -> computeCollisionDetection (from, to, rb, settings);
+    if (ra.m_collisions.size () != rb.m_collisions.size ()) { return false; }
+    for (size_t i = 0; i < ra.m_collisions.size (); ++i) {
+      const chai3d::cCollisionEvent & ea = ra.m_collisions [i];
+      const chai3d::cCollisionEvent & eb = rb.m_collisions [i];
+      if (ea.m_index != eb.m_index
+	  || chai3d::cDistance (ea.m_globalPos, eb.m_globalPos) > tolerance) {
+	return false;
+      }
+    }
+    hits += (int) ra.m_collisions.size ();
+  }
+  return hits >= 100;
+}
+
+bool check (const char * step, const Errors & errors, double position, double normal) {
+  if (errors.localPos > position || errors.globalPos > position || errors.normal > normal
+      || errors.texCoord != 0.0 || errors.color != 0.0) {
+    std::cerr << step << ": errors " << errors.localPos << " (local), "
+	      << errors.globalPos << " (global), " << errors.normal << " (normals), "
+	      << errors.texCoord << " (texture coordinates), " << errors.color << " (colors)\n";
+    return false;
+  }
+  return true;
+}
+
+int main () {
+  Scene reference = buildScene ();
+  Scene compact = buildScene ();
+  chai3d::cVertexArrayPtr vertices = compact.mesh -> m_vertices;
+  size_t doubleBytes = vertices -> getMemoryUsage ();
+
+  // single precision: a few ulps of the coordinates (about 0.4 m)
+  vertices -> setCompactStorage (true);
+  compact.world -> computeGlobalPositions (false);
+  if (!check ("Compact storage", compare (reference.mesh, compact.mesh), 1e-7, 1e-6)) { return 1; }
+  if (!sameCollisions (reference, compact, 1e-6)) {
+    std::cerr << "Compact storage: the segments hit other triangles\n";
+    return 1;
+  }
+
+  // 16 bit normals
+  vertices -> setCompactStorage (true, true);
+  compact.world -> computeGlobalPositions (false);
+  if (!check ("Quantized normals", compare (reference.mesh, compact.mesh), 1e-7, 1e-4)) { return 1; }
+  if (vertices -> getMemoryUsage () >= doubleBytes) {
+    std::cerr << "Compact storage uses " << vertices -> getMemoryUsage () << " bytes, "
+	      << doubleBytes << " in double precision\n";
+    return 1;
+  }
+
+  // vertices moved in compact storage
+  chai3d::cVector3d shift (0.001, -0.002, 0.003);
+  for (unsigned int i = 0; i < vertices -> getNumElements (); i += 3) {
+    reference.mesh -> m_vertices -> setLocalPos (i, reference.mesh -> m_vertices -> getLocalPos (i) + shift);
+    vertices -> setLocalPos (i, vertices -> getLocalPos (i) + shift);
+  }
+  reference.world -> computeGlobalPositions (false);
+  compact.world -> computeGlobalPositions (false);
+  if (!check ("Moved vertices", compare (reference.mesh, compact.mesh), 1e-7, 1e-4)) { return 1; }
+
+  // back to double precision
+  vertices -> setCompactStorage (false);
+  compact.world -> computeGlobalPositions (false);
+  if (!check ("Double storage", compare (reference.mesh, compact.mesh), 1e-7, 1e-4)) { return 1; }
+
+  delete reference.world;
+  delete compact.world;
+  std::cout << "ok\n";
+  return 0;
+}
@@ -0,0 +1,142 @@
+// Spheres, boxes, meshes and cylinders (which the compiled scene leaves
+// to their own methods) in nested, rotated groups are built twice, and
+// the scene graph of one world is compiled (cWorld::compileScene).
+// Segments through the objects must hit the same objects at the same
+// points in both worlds, also after objects move to other groups, which
+// compiles the scene again, and while a group is a ghost.
+
+#include "../include/chai3d.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+struct Scene {
+  chai3d::cWorld * world;
+  std::vector<chai3d::cGenericObject *> groups;
+  std::vector<chai3d::cGenericObject *> objects;
+};
+
+Scene buildScene () {
+  Scene scene;
+  scene.world = new chai3d::cWorld ();
+  chai3d::cGenericObject * parent = new chai3d::cGenericObject ();
+  parent -> setLocalPos (0.02, 0.0, -0.01);
+  scene.world -> addChild (parent);
+  for (int g = 0; g < 4; ++g) {
+    chai3d::cGenericObject * group = new chai3d::cGenericObject ();
+    group -> setLocalPos (0.05 * g, 0.01 * (g % 2), 0.0);
+    group -> setLocalRot (chai3d::cMatrix3d (0.0, 0.0, 1.0, 0.4 * g));
+    parent -> addChild (group);
+    scene.groups.push_back (group);
+  }
+  for (int i = 0; i < 16; ++i) {
+    chai3d::cGenericObject * object;
+    switch (i % 4) {
+    case 0:
+      object = new chai3d::cShapeSphere (0.01);
+      break;
+    case 1:
+      object = new chai3d::cShapeBox (0.02, 0.01, 0.015);
+      break;
+    case 2: {
+      chai3d::cMesh * mesh = new chai3d::cMesh ();
+      chai3d::cCreateBox (mesh, 0.02, 0.02, 0.01);
+      mesh -> computeBoundaryBox (true);
+      mesh -> createAABBCollisionDetector (0.001);
+      object = mesh;
+      break;
+    }
+    default:
+      object = new chai3d::cShapeCylinder (0.01, 0.01, 0.02);
+      break;
+    }
+    object -> setLocalPos (0.012 * (i / 4) - 0.02, 0.003 * (i % 3), 0.0);
+    object -> setLocalRot (chai3d::cMatrix3d (1.0, 0.0, 0.0, 0.3 * i));
+    scene.groups [i % 4] -> addChild (object);
+    scene.objects.push_back (object);
+  }
+  scene.world -> computeGlobalPositions (false);
+  return scene;
+}
+
+int indexOf (const Scene & scene, const chai3d::cGenericObject * object) {
+  auto it = std::find (scene.objects.begin (), scene.objects.end (), object);
+  return it == scene.objects.end () ? -1 : (int) (it - scene.objects.begin ());
+}
+
+bool sameCollision (const Scene & a, const chai3d::cCollisionEvent & ea,
+		    const Scene & b, const chai3d::cCollisionEvent & eb) {
+  return indexOf (a, ea.m_object) == indexOf (b, eb.m_object)
+    && chai3d::cDistance (ea.m_localPos, eb.m_localPos) <= 1e-12
+    && chai3d::cDistance (ea.m_globalPos, eb.m_globalPos) <= 1e-12;
+}
+
+// Moves an object to another group, in both scenes
+void moveObject (Scene & scene, int object, int group) {
+  chai3d::cGenericObject * o = scene.objects [object];
+  o -> removeFromGraph ();
+  scene.groups [group] -> addChild (o);
+  scene.world -> computeGlobalPositions (false);
+}
+
+int main () {
+  Scene tree = buildScene ();
+  Scene flat = buildScene ();
+  flat.world -> compileScene ();
+
+  chai3d::cCollisionSettings settings;
+  settings.m_checkForNearestCollisionOnly = false;
+  settings.m_collisionRadius = 0.001;
+  chai3d::cCollisionRecorder treeCollisions, flatCollisions;
+  long hits = 0;
+  for (int t = 0; t < 600; ++t) {
+    if (t % 100 == 50) {
+      moveObject (tree, (7 * t) % 16, (t / 100) % 4);
+      moveObject (flat, (7 * t) % 16, (t / 100) % 4);
+    }
+    bool ghost = (t >= 300) && (t < 400);
+    tree.groups [1] -> setGhostEnabled (ghost);
+    flat.groups [1] -> setGhostEnabled (ghost);
+
+    // each segment crosses an object, and often its neighbours
+    chai3d::cVector3d center = tree.objects [t % 16] -> getGlobalPos ();
+    chai3d::cVector3d offset (0.02, 0.01 * sin (0.3 * t), 0.005 * cos (0.7 * t));
+    chai3d::cVector3d from = center - offset;
+    chai3d::cVector3d to = center + offset;
+
+    treeCollisions.clear ();
+    flatCollisions.clear ();
+    bool treeHit = tree.world -> computeCollisionDetection (from, to, treeCollisions, settings);
+    bool flatHit = flat.world -> computeCollisionDetection (from, to, flatCollisions, settings);
+
+    bool same = (treeHit == flatHit)
+      && treeCollisions.m_collisions.size () == flatCollisions.m_collisions.size ();
+    for (size_t i = 0; same && i < treeCollisions.m_collisions.size (); ++i) {
+      same = sameCollision (tree, treeCollisions.m_collisions [i],
+			    flat, flatCollisions.m_collisions [i]);
+    }
+    if (!same) {
+      std::cerr << "Tick " << t << ": " << flatCollisions.m_collisions.size ()
+		<< " collisions in the compiled scene, " << treeCollisions.m_collisions.size ()
+		<< " in the scene graph\n";
+      return 1;
+    }
+    hits += treeCollisions.m_collisions.size ();
+  }
+
+  // the segments must hit objects, and the edits compile the scene again
+  if (hits < 100) {
+    std::cerr << "The segments hit " << hits << " objects only\n";
+    return 1;
+  }
+  if (flat.world -> getCompiledScene () -> getNumObjects () != 22) {
+    std::cerr << "The compiled scene has " << flat.world -> getCompiledScene () -> getNumObjects ()
+	      << " objects instead of 22\n";
+    return 1;
+  }
+  delete tree.world;
+  delete flat.world;
+  std::cout << "ok\n";
+  return 0;
+}
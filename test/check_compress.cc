@@ -0,0 +1,159 @@
+// Triangles of a sphere mesh are removed and replaced by triangles on
+// new vertices, then one side is cut off, in double precision and in
+// compact storage, and the mesh is compressed (cMesh::compress). The remaining triangles must
+// keep their order and the position, normal, texture coordinate and
+// color of their vertices; no vertex may be left unused; segments must
+// hit the same points; and a new triangle must be added after the last
+// one.
+
+#include "../include/chai3d.h"
+#include <cmath>
+#include <iostream>
+#include <set>
+#include <vector>
+
+struct Corner {
+  chai3d::cVector3d pos;
+  chai3d::cVector3d normal;
+  chai3d::cVector3d texCoord;
+  chai3d::cColorf color;
+};
+
+// Vertices of the allocated triangles, in order
+std::vector<Corner> corners (chai3d::cMesh * mesh) {
+  std::vector<Corner> result;
+  chai3d::cVertexArrayPtr vertices = mesh -> m_vertices;
+  for (unsigned int t = 0; t < mesh -> m_triangles -> getNumElements (); ++t) {
+    if (!mesh -> m_triangles -> getAllocated (t)) { continue; }
+    for (int v = 0; v < 3; ++v) {
+      unsigned int i = mesh -> m_triangles -> getVertexIndex (t, v);
+      result.push_back (Corner { vertices -> getLocalPos (i), vertices -> getNormal (i),
+				 vertices -> getTexCoord (i), vertices -> getColor (i) });
+    }
+  }
+  return result;
+}
+
+bool sameCorner (const Corner & a, const Corner & b) {
+  return chai3d::cDistance (a.pos, b.pos) == 0.0
+    && chai3d::cDistance (a.normal, b.normal) == 0.0
+    && chai3d::cDistance (a.texCoord, b.texCoord) == 0.0
+    && a.color.getR () == b.color.getR () && a.color.getG () == b.color.getG ()
+    && a.color.getB () == b.color.getB () && a.color.getA () == b.color.getA ();
+}
+
+// Nearest hits of segments through the mesh
+std::vector<chai3d::cVector3d> hits (chai3d::cMesh * mesh) {
+  chai3d::cCollisionSettings settings;
+  std::vector<chai3d::cVector3d> result;
+  for (int k = 0; k < 200; ++k) {
+    chai3d::cVector3d direction (cos (0.37 * k) * sin (0.11 * k + 0.2),
+				 sin (0.37 * k) * sin (0.11 * k + 0.2),
+				 cos (0.11 * k + 0.2));
+    chai3d::cVector3d from = 0.3 * direction;
+    chai3d::cVector3d to = -0.3 * direction;
+    chai3d::cCollisionRecorder recorder;
+    bool hit = mesh -> getCollisionDetector () ->
+      computeCollision (mesh, from, to, recorder, settings);
+    result.push_back (hit ? recorder.m_nearestCollision.m_localPos : chai3d::cVector3d (9, 9, 9));
+  }
+  return result;
+}
+
+bool check (bool compactStorage) {
+  const char * storage = compactStorage ? "Compact storage" : "Double storage";
+  chai3d::cMesh * mesh = new chai3d::cMesh ();
+  chai3d::cCreateSphere (mesh, 0.1, 24, 16);
+  chai3d::cVertexArrayPtr vertices = mesh -> m_vertices;
+  vertices -> setCompactStorage (compactStorage);
+  for (unsigned int i = 0; i < vertices -> getNumElements (); ++i) {
+    vertices -> setTexCoord (i, 0.001 * i, 0.5, 0.0);
+    vertices -> setColor (i, chai3d::cColorf (0.001f * i, 0.5f, 0.25f, 1.0f));
+  }
+
+  // remove every third triangle, and replace half of them inside
+  unsigned int numTriangles = mesh -> m_triangles -> getNumElements ();
+  for (unsigned int t = 0; t < numTriangles; t += 3) {
+    chai3d::cVector3d p [3];
+    for (int v = 0; v < 3; ++v) {
+      p [v] = vertices -> getLocalPos (mesh -> m_triangles -> getVertexIndex (t, v));
+    }
+    mesh -> removeTriangle (t);
+    if (t % 2 == 0) {
+      mesh -> newTriangle (0.98 * p [0], 0.98 * p [1], 0.98 * p [2]);
+    }
+  }
+
+  // cut the side x > 0.05, whose vertices are left unused
+  for (unsigned int t = 0; t < mesh -> m_triangles -> getNumElements (); ++t) {
+    if (!mesh -> m_triangles -> getAllocated (t)) { continue; }
+    double x = 0.0;
+    for (int v = 0; v < 3; ++v) {
+      x += vertices -> getLocalPos (mesh -> m_triangles -> getVertexIndex (t, v)).x () / 3.0;
+    }
+    if (x > 0.05) { mesh -> removeTriangle (t); }
+  }
+  mesh -> computeAllNormals ();
+  mesh -> computeBoundaryBox (true);
+  mesh -> createAABBCollisionDetector (0.0);
+
+  std::vector<Corner> before = corners (mesh);
+  std::vector<chai3d::cVector3d> hitsBefore = hits (mesh);
+  unsigned int verticesBefore = vertices -> getNumElements ();
+
+  mesh -> compress ();
+
+  std::vector<Corner> after = corners (mesh);
+  bool same = before.size () == after.size ()
+    && mesh -> m_triangles -> getNumElements () * 3 == after.size ();
+  for (size_t i = 0; same && i < before.size (); ++i) {
+    same = sameCorner (before [i], after [i]);
+  }
+  if (!same) {
+    std::cerr << storage << ": the triangles changed\n";
+    return false;
+  }
+
+  std::set<unsigned int> used;
+  for (unsigned int t = 0; t < mesh -> m_triangles -> getNumElements (); ++t) {
+    for (int v = 0; v < 3; ++v) { used.insert (mesh -> m_triangles -> getVertexIndex (t, v)); }
+  }
+  if (used.size () != vertices -> getNumElements () || used.size () >= verticesBefore) {
+    std::cerr << storage << ": " << vertices -> getNumElements () << " vertices for "
+	      << used.size () << " used, " << verticesBefore << " before\n";
+    return false;
+  }
+
+  std::vector<chai3d::cVector3d> hitsAfter = hits (mesh);
+  int numHits = 0;
+  for (size_t k = 0; k < hitsBefore.size (); ++k) {
+    if (chai3d::cDistance (hitsBefore [k], hitsAfter [k]) != 0.0) {
+      std::cerr << storage << ": segment " << k << " hits " << hitsAfter [k]
+		<< " instead of " << hitsBefore [k] << "\n";
+      return false;
+    }
+    numHits += hitsBefore [k].x () < 9.0 ? 1 : 0;
+  }
+  if (numHits < 100) {
+    std::cerr << storage << ": " << numHits << " segments hit the mesh\n";
+    return false;
+  }
+
+  unsigned int last = mesh -> m_triangles -> getNumElements ();
+  unsigned int added = mesh -> newTriangle (chai3d::cVector3d (0, 0, 0), chai3d::cVector3d (1, 0, 0),
+					    chai3d::cVector3d (0, 1, 0));
+  chai3d::cVector3d corner = vertices -> getLocalPos (mesh -> m_triangles -> getVertexIndex (added, 1));
+  if (added != last || chai3d::cDistance (corner, chai3d::cVector3d (1, 0, 0)) != 0.0) {
+    std::cerr << storage << ": new triangle " << added << " instead of " << last << "\n";
+    return false;
+  }
+
+  delete mesh;
+  return true;
+}
+
+int main () {
+  if (!check (false) || !check (true)) { return 1; }
+  std::cout << "ok\n";
+  return 0;
+}
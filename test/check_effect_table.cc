@@ -0,0 +1,113 @@
+// Spheres with surface, viscosity and magnet effects, under a rotated
+// group, are compiled into an effect table (cWorld::compileEffects) in
+// one world and evaluated one object at a time in another. A tool that
+// sweeps through all of them must feel the same force in both worlds,
+// up to rounding, on every tick, and every sphere must report the same
+// interaction forces.
+
+#include "../include/chai3d.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+struct Scene {
+  chai3d::cWorld * world;
+  std::vector<chai3d::cShapeSphere *> spheres;
+};
+
+Scene buildScene () {
+  Scene scene;
+  scene.world = new chai3d::cWorld ();
+  chai3d::cGenericObject * group = new chai3d::cGenericObject ();
+  group -> setLocalPos (0.1, -0.02, 0.03);
+  group -> setLocalRot (chai3d::cMatrix3d (0.0, 0.0, 1.0, 0.3));
+  scene.world -> addChild (group);
+  for (int i = 0; i < 12; ++i) {
+    chai3d::cShapeSphere * sphere = new chai3d::cShapeSphere (0.01 + 0.001 * (i % 4));
+    sphere -> setLocalPos (0.015 * i, 0.002 * (i % 3), 0.0);
+    sphere -> m_material -> setStiffness (500.0 + 10.0 * i);
+    sphere -> m_material -> setViscosity (2.0 + i);
+    sphere -> m_material -> setMagnetMaxForce (2.0);
+    sphere -> m_material -> setMagnetMaxDistance (0.01);
+    sphere -> createEffectSurface ();
+    switch (i % 3) {
+    case 0: sphere -> createEffectMagnetic (); break;
+    case 1: sphere -> createEffectViscosity (); break;
+    default: break;
+    }
+    group -> addChild (sphere);
+    scene.spheres.push_back (sphere);
+  }
+  scene.world -> computeGlobalPositions (false);
+  return scene;
+}
+
+// Interaction forces by sphere: compiled effects are reported after
+// the other ones, so the events are compared in the order of the spheres
+std::vector<std::pair<int, chai3d::cVector3d>> events (const Scene & scene,
+						       const chai3d::cInteractionRecorder & recorder) {
+  std::vector<std::pair<int, chai3d::cVector3d>> result;
+  for (auto & interaction : recorder.m_interactions) {
+    int index = (int) (std::find (scene.spheres.begin (), scene.spheres.end (),
+				  interaction.m_object) - scene.spheres.begin ());
+    result.push_back (std::make_pair (index, interaction.m_localForce));
+  }
+  std::stable_sort (result.begin (), result.end (),
+		    [] (const std::pair<int, chai3d::cVector3d> & a,
+			const std::pair<int, chai3d::cVector3d> & b) { return a.first < b.first; });
+  return result;
+}
+
+bool sameForce (const chai3d::cVector3d & a, const chai3d::cVector3d & b) {
+  return chai3d::cDistance (a, b) <= 1e-9 * (1.0 + a.length ());
+}
+
+int main () {
+  Scene objects = buildScene ();
+  Scene table = buildScene ();
+  table.world -> compileEffects ();
+  if (table.world -> getCompiledEffects () -> getNumObjects () != 12) {
+    std::cerr << "The spheres were not compiled into the effect table\n";
+    return 1;
+  }
+
+  // the tool sweeps along the spheres, in and out of their surfaces
+  chai3d::cInteractionRecorder objectEvents, tableEvents;
+  int touching = 0;
+  for (int t = 0; t < 400; ++t) {
+    chai3d::cVector3d tool (0.09 + 0.0005 * t, -0.02 + 0.006 * sin (0.1 * t), 0.03);
+    chai3d::cVector3d velocity (0.5, 0.6 * cos (0.1 * t), 0.0);
+
+    objects.world -> computeGlobalPositions (true);
+    table.world -> computeGlobalPositions (true);
+    objectEvents.clear ();
+    tableEvents.clear ();
+    chai3d::cVector3d objectForce = objects.world -> computeInteractions (tool, velocity, 0, objectEvents);
+    chai3d::cVector3d tableForce = table.world -> computeInteractions (tool, velocity, 0, tableEvents);
+
+    std::vector<std::pair<int, chai3d::cVector3d>> a = events (objects, objectEvents);
+    std::vector<std::pair<int, chai3d::cVector3d>> b = events (table, tableEvents);
+    bool same = sameForce (objectForce, tableForce) && a.size () == b.size ();
+    for (size_t i = 0; same && i < a.size (); ++i) {
+      same = a [i].first == b [i].first && sameForce (a [i].second, b [i].second);
+    }
+    if (!same) {
+      std::cerr << "Tick " << t << ": force " << tableForce << " from the effect table, "
+		<< objectForce << " from the objects\n";
+      return 1;
+    }
+    touching += objectForce.length () > 0.0 ? 1 : 0;
+  }
+
+  // the sweep must exercise the effects
+  if (touching < 100) {
+    std::cerr << "The tool touched the spheres on " << touching << " ticks only\n";
+    return 1;
+  }
+  delete objects.world;
+  delete table.world;
+  std::cout << "ok\n";
+  return 0;
+}
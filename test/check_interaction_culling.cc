@@ -0,0 +1,52 @@
+// Two tools (force algorithms 0 and 1, as the two points of a gripper)
+// interact with a stick-slip sphere that is skipped when they are away
+// from it. Tool 1 leaves the sphere on a tick where tool 0 is also away
+// from it: the sphere must still see tool 1 leave, otherwise its stick
+// position stays stale and pulls tool 1 back when it enters again.
+
+#include "../include/chai3d.h"
+#include <iostream>
+
+const unsigned int gripperA = 0;
+const unsigned int gripperB = 1;
+
+chai3d::cVector3d tick (chai3d::cWorld & world,
+			const chai3d::cVector3d & toolA,
+			const chai3d::cVector3d & toolB) {
+  chai3d::cInteractionRecorder recorder;
+  chai3d::cVector3d still (0.0, 0.0, 0.0);
+  world.computeGlobalPositions (true);
+  world.computeInteractions (toolA, still, gripperA, recorder);
+  recorder.clear ();
+  return world.computeInteractions (toolB, still, gripperB, recorder);
+}
+
+int main () {
+  chai3d::cWorld world;
+  chai3d::cShapeSphere * sphere = new chai3d::cShapeSphere (0.1);
+  sphere -> setLocalPos (0.5, 0.0, 0.0);
+  sphere -> deleteEffectSurface ();
+  sphere -> m_material -> setStickSlipStiffness (1000.0);
+  sphere -> m_material -> setStickSlipForceMax (100.0);
+  sphere -> createEffectStickSlip ();
+  world.addChild (sphere);
+
+  chai3d::cVector3d away (-0.5, 0.0, 0.0);
+  chai3d::cVector3d firstEntry (0.5, 0.0, 0.05);
+  chai3d::cVector3d secondEntry (0.5, 0.0, -0.05);
+
+  // tool 1 sticks at its first entry point, then leaves
+  tick (world, away, firstEntry);
+  tick (world, away, away);
+  tick (world, away, away);
+
+  // entering again, tool 1 sticks where it is and feels no force
+  chai3d::cVector3d force = tick (world, away, secondEntry);
+  if (force.length () > 1e-9) {
+    std::cerr << "Stale stick-slip state for the second tool, force "
+	      << force << "\n";
+    return 1;
+  }
+  std::cout << "ok\n";
+  return 0;
+}
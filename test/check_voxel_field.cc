@@ -0,0 +1,180 @@
+// A small volume (a spherical shell with blobs around it) is shared by
+// two voxel objects, and the distance field of one of them is built
+// (cVoxelObject::buildDistanceField). Short segments, with and without
+// a tool radius, must find identical nearest collisions in both. The
+// distance of the field must be a lower bound of the distance to the
+// occupied voxels. After the image is modified the field is no longer
+// used, and the queries must follow the new image, then the rebuilt
+// field.
+
+#include "../include/chai3d.h"
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+const int size = 64;
+
+struct Outcome {
+  bool hit;
+  chai3d::cVector3d position;
+  chai3d::cVector3d normal;
+  int voxel [3];
+};
+
+chai3d::cMultiImagePtr volume () {
+  chai3d::cMultiImagePtr image = chai3d::cMultiImage::create ();
+  image -> allocate (size, size, size, GL_LUMINANCE);
+  unsigned char * data = image -> getData ();
+  std::vector<chai3d::cVector3d> blobs;
+  for (int i = 0; i < 8; ++i) {
+    blobs.push_back (chai3d::cVector3d (0.5 + 0.45 * cos (1.3 * i), 0.5 + 0.45 * sin (1.3 * i),
+					0.1 + 0.1 * i));
+  }
+  for (int z = 0; z < size; ++z) {
+    for (int y = 0; y < size; ++y) {
+      for (int x = 0; x < size; ++x) {
+	chai3d::cVector3d p ((x + 0.5) / size, (y + 0.5) / size, (z + 0.5) / size);
+	double r = chai3d::cDistance (p, chai3d::cVector3d (0.5, 0.5, 0.5));
+	bool occupied = (r > 0.3) && (r < 0.38);
+	for (size_t i = 0; !occupied && i < blobs.size (); ++i) {
+	  occupied = chai3d::cDistance (p, blobs [i]) < 0.05;
+	}
+	data [((size_t) z * size + y) * size + x] = occupied ? 255 : 0;
+      }
+    }
+  }
+  return image;
+}
+
+std::vector<Outcome> query (chai3d::cVoxelObject * object, double radius) {
+  std::mt19937 rng (7);
+  std::uniform_real_distribution<double> position (-0.55, 0.55);
+  std::uniform_real_distribution<double> length (0.0, 0.1);
+  std::normal_distribution<double> direction (0.0, 1.0);
+  chai3d::cCollisionSettings settings;
+  settings.m_collisionRadius = radius;
+  std::vector<Outcome> outcomes;
+  for (int i = 0; i < 3000; ++i) {
+    chai3d::cVector3d a (position (rng), position (rng), position (rng));
+    chai3d::cVector3d d (direction (rng), direction (rng), direction (rng));
+    chai3d::cVector3d b = a + (length (rng) / std::max (1e-9, d.length ())) * d;
+    chai3d::cCollisionRecorder recorder;
+    Outcome o;
+    o.hit = object -> computeCollisionDetection (a, b, recorder, settings);
+    o.position = recorder.m_nearestCollision.m_localPos;
+    o.normal = recorder.m_nearestCollision.m_localNormal;
+    o.voxel [0] = o.hit ? recorder.m_nearestCollision.m_voxelIndexX : 0;
+    o.voxel [1] = o.hit ? recorder.m_nearestCollision.m_voxelIndexY : 0;
+    o.voxel [2] = o.hit ? recorder.m_nearestCollision.m_voxelIndexZ : 0;
+    outcomes.push_back (o);
+  }
+  return outcomes;
+}
+
+// Compares the queries of the objects with and without a distance field
+bool sameQueries (const char * step, chai3d::cVoxelObject * field, chai3d::cVoxelObject * plain) {
+  for (double radius : { 0.0, 0.02 }) {
+    std::vector<Outcome> volume = query (plain, radius);
+    std::vector<Outcome> withField = query (field, radius);
+    int hits = 0;
+    for (size_t i = 0; i < volume.size (); ++i) {
+      const Outcome & a = volume [i];
+      const Outcome & b = withField [i];
+      bool same = a.hit == b.hit;
+      if (same && a.hit) {
+	same = a.position.equals (b.position, 0.0) && a.normal.equals (b.normal, 0.0)
+	  && a.voxel [0] == b.voxel [0] && a.voxel [1] == b.voxel [1] && a.voxel [2] == b.voxel [2];
+      }
+      if (!same) {
+	std::cerr << step << ": query " << i << " with radius " << radius << " differs\n";
+	return false;
+      }
+      hits += a.hit ? 1 : 0;
+    }
+    if (hits < 300) {
+      std::cerr << step << ": only " << hits << " queries hit the volume\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+// Distance from a point to the cells of the occupied voxels
+double occupiedDistance (const unsigned char * data, const chai3d::cVector3d & p) {
+  double voxel = 1.0 / size;
+  double nearest = 1e9;
+  for (int z = 0; z < size; ++z) {
+    for (int y = 0; y < size; ++y) {
+      for (int x = 0; x < size; ++x) {
+	if (data [((size_t) z * size + y) * size + x] < 128) { continue; }
+	chai3d::cVector3d lower (-0.5 + x * voxel, -0.5 + y * voxel, -0.5 + z * voxel);
+	chai3d::cVector3d d;
+	for (int k = 0; k < 3; ++k) {
+	  d (k) = std::max (0.0, std::max (lower (k) - p (k), p (k) - lower (k) - voxel));
+	}
+	nearest = std::min (nearest, d.length ());
+      }
+    }
+  }
+  return nearest;
+}
+
+int main () {
+  chai3d::cTexture3dPtr texture = chai3d::cTexture3d::create ();
+  chai3d::cMultiImagePtr image = volume ();
+  texture -> setImage (image);
+  chai3d::cVoxelObject * object = new chai3d::cVoxelObject ();
+  chai3d::cVoxelObject * plain = new chai3d::cVoxelObject ();
+  object -> setTexture (texture);
+  object -> setIsosurfaceValue (0.5f);
+  plain -> setTexture (texture);
+  plain -> setIsosurfaceValue (0.5f);
+  object -> buildDistanceField ();
+  if (!object -> isDistanceFieldValid ()) {
+    std::cerr << "The distance field was not built\n";
+    return 1;
+  }
+  if (!sameQueries ("Distance field", object, plain)) { return 1; }
+
+  // lower bound of the distance to the occupied voxels
+  std::mt19937 rng (11);
+  std::uniform_real_distribution<double> position (-0.5, 0.5);
+  int positive = 0;
+  for (int i = 0; i < 300; ++i) {
+    chai3d::cVector3d p (position (rng), position (rng), position (rng));
+    double distance;
+    object -> computeSurfaceDistance (p, distance);
+    if (distance > occupiedDistance (image -> getData (), p) + 1e-12) {
+      std::cerr << "The field gives " << distance << " at " << p << ", the voxels are "
+		<< occupiedDistance (image -> getData (), p) << " away\n";
+      return 1;
+    }
+    positive += distance > 0.0 ? 1 : 0;
+  }
+  if (positive < 30) {
+    std::cerr << "The field gives a positive distance at " << positive << " points only\n";
+    return 1;
+  }
+
+  // a new blob, where the field says space is empty
+  unsigned char * data = image -> getData ();
+  for (int z = 28; z < 36; ++z) {
+    for (int y = 28; y < 36; ++y) {
+      for (int x = 28; x < 36; ++x) { data [((size_t) z * size + y) * size + x] = 255; }
+    }
+  }
+  image -> markAsModified ();
+  if (object -> isDistanceFieldValid ()) {
+    std::cerr << "The distance field is still used after the image changed\n";
+    return 1;
+  }
+  if (!sameQueries ("Modified image", object, plain)) { return 1; }
+  object -> buildDistanceField ();
+  if (!sameQueries ("Rebuilt field", object, plain)) { return 1; }
+
+  delete object;
+  delete plain;
+  std::cout << "ok\n";
+  return 0;
+}